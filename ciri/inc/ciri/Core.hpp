@@ -4,12 +4,20 @@
 #include <memory>
 #include <ciri/core/ErrorCodes.hpp>
 #include <ciri/core/File.hpp>
+#include <ciri/core/FileData.hpp>
+#include <ciri/core/FileSystem.hpp>
+#include <ciri/core/FramePacer.hpp>
 #include <ciri/core/ITimer.hpp>
+#include <ciri/core/JobSystem.hpp>
 #include <ciri/core/Leb128.hpp>
 #include <ciri/core/Log.hpp>
+#include <ciri/core/MappedFile.hpp>
+#include <ciri/core/PackArchive.hpp>
 #include <ciri/core/PNG.hpp>
+#include <ciri/core/Profiler.hpp>
 #include <ciri/core/StrUtil.hpp>
 #include <ciri/core/TGA.hpp>
+#include <ciri/core/Timer.hpp>
 #include <ciri/core/window/IWindow.hpp>
 #include <ciri/core/window/WindowEvent.hpp>
 #include <ciri/core/input/IInput.hpp>
@@ -19,8 +27,7 @@
 namespace ciri {
 
 /**
- * Creates a new timer.
- * Note that this function is implemented in platform-specific code.
+ * Creates a new timer over the steady clock; see Timer.
  * @returns Pointer to a new timer.
  */
 std::shared_ptr<ITimer> createTimer();
@@ -2,12 +2,18 @@
 #define __ciri_game_Game__
 
 #include <ciri/game/App.hpp>
+#include <ciri/game/RenderSnapshot.hpp>
 #include <ciri/game/SpriteBatch.hpp>
 #include <ciri/game/SpriteBatchItem.hpp>
 #include <ciri/game/SpriteVertex.hpp>
 #include <ciri/game/ISpriteFont.hpp>
 #include <ciri/game/SpriteFontGlyph.hpp>
 #include <ciri/game/FreeTypeSpriteFont.hpp>
+#include <ciri/game/ProfilerOverlay.hpp>
+#include <ciri/game/particles/ParticlePool.hpp>
+#include <ciri/game/particles/ParticleEmitter.hpp>
+#include <ciri/game/particles/ParticleSystem.hpp>
+#include <ciri/game/collision/SpatialHash2D.hpp>
 #include <ciri/game/screens/Screen.hpp>
 #include <ciri/game/screens/ScreenState.hpp>
 #include <ciri/game/screens/ScreenManager.hpp>
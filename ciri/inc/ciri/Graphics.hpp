@@ -5,18 +5,25 @@
 #include <ciri/graphics/BlendColorMask.hpp>
 #include <ciri/graphics/BlendFunction.hpp>
 #include <ciri/graphics/BlendMode.hpp>
+#include <ciri/graphics/BoundingBox.hpp>
+#include <ciri/graphics/BoundingFrustum.hpp>
 #include <ciri/graphics/Camera.hpp>
 #include <ciri/graphics/ClearFlags.hpp>
 #include <ciri/graphics/CompareFunction.hpp>
 #include <ciri/graphics/CullMode.hpp>
 #include <ciri/graphics/FillMode.hpp>
 #include <ciri/graphics/FPSCamera.hpp>
+#include <ciri/graphics/FrustumCuller.hpp>
+#include <ciri/graphics/GpuProfileScope.hpp>
 #include <ciri/graphics/GraphicsApiType.hpp>
 #include <ciri/graphics/IBlendState.hpp>
+#include <ciri/graphics/ICommandList.hpp>
 #include <ciri/graphics/IConstantBuffer.hpp>
 #include <ciri/graphics/IDepthStencilState.hpp>
 #include <ciri/graphics/IGraphicsDevice.hpp>
 #include <ciri/graphics/IIndexBuffer.hpp>
+#include <ciri/graphics/IndexFormat.hpp>
+#include <ciri/graphics/IPipelineState.hpp>
 #include <ciri/graphics/IRasterizerState.hpp>
 #include <ciri/graphics/IRenderTarget2D.hpp>
 #include <ciri/graphics/ISamplerState.hpp>
@@ -25,16 +32,21 @@
 #include <ciri/graphics/ITexture3D.hpp>
 #include <ciri/graphics/ITextureCube.hpp>
 #include <ciri/graphics/IVertexBuffer.hpp>
+#include <ciri/graphics/LightClusters.hpp>
 #include <ciri/graphics/MayaCamera.hpp>
 #include <ciri/graphics/ObjModel.hpp>
+#include <ciri/graphics/PixelConversion.hpp>
 #include <ciri/graphics/Plane.hpp>
 #include <ciri/graphics/PrimitiveTopology.hpp>
+#include <ciri/graphics/RenderGraph.hpp>
 #include <ciri/graphics/SamplerFilter.hpp>
 #include <ciri/graphics/SamplerWrap.hpp>
+#include <ciri/graphics/ShaderCache.hpp>
 #include <ciri/graphics/ShaderStage.hpp>
 #include <ciri/graphics/StencilOperation.hpp>
 #include <ciri/graphics/TextureFlags.hpp>
 #include <ciri/graphics/TextureFormat.hpp>
+#include <ciri/graphics/TextureReadback.hpp>
 #include <ciri/graphics/VertexDeclaration.hpp>
 #include <ciri/graphics/VertexElement.hpp>
 #include <ciri/graphics/VertexFormat.hpp>
@@ -0,0 +1,75 @@
+#ifndef __ciri_core_FileData__
+#define __ciri_core_FileData__
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace ciri {
+
+/**
+ * Read-only bytes of a whole file, as FileSystem hands them out.  They are either a span of a mapped pack, which costs no copy, or a buffer
+ * of their own for loose files and compressed entries.  Copies share the bytes, and keep whatever they live in alive.
+ */
+class FileData {
+public:
+	FileData();
+
+	/**
+		* Takes over a buffer.
+		*/
+	FileData( std::vector<unsigned char>&& buffer );
+
+	/**
+		* Refers to bytes owned by something else, which is kept alive for as long as any copy refers to them.
+		*/
+	FileData( const std::shared_ptr<const void>& owner, const unsigned char* data, size_t size );
+
+	/**
+		* Gets whether there are bytes; false for files that could not be read.  An empty file is valid.
+		*/
+	bool isValid() const;
+
+	const unsigned char* getData() const;
+	size_t getSize() const;
+
+	/**
+		* Copies the bytes into a string, for text files.
+		*/
+	std::string toString() const;
+
+private:
+	std::shared_ptr<const void> _owner;
+	const unsigned char* _data;
+	size_t _size;
+};
+
+/**
+ * Stream buffer over a span of memory, so that std::istream parsing reads it in place.
+ */
+class SpanStreamBuffer : public std::streambuf {
+public:
+	SpanStreamBuffer( const unsigned char* data, size_t size );
+
+protected:
+	virtual pos_type seekoff( off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which ) override;
+	virtual pos_type seekpos( pos_type position, std::ios_base::openmode which ) override;
+};
+
+/**
+ * Input stream over FileData, for loaders written against std::istream.
+ */
+class FileDataStream : public std::istream {
+public:
+	FileDataStream( const FileData& data );
+
+private:
+	FileData _data;
+	SpanStreamBuffer _buffer;
+};
+
+}
+
+#endif
\ No newline at end of file
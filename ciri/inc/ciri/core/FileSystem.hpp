@@ -0,0 +1,67 @@
+#ifndef __ciri_core_FileSystem__
+#define __ciri_core_FileSystem__
+
+#include <memory>
+#include "FileData.hpp"
+#include "PackArchive.hpp"
+
+namespace ciri {
+
+/**
+ * Where loaders read files from.  A path is looked up in the mounted pack archives, the last mounted first, and only read from disk as a
+ * loose file if no archive has it; with nothing mounted, every read is a loose file.  Safe to use from any thread.
+ */
+class FileSystem {
+public:
+	struct Stats {
+		long long looseFiles;  /**< Read from disk on their own. */
+		long long packedFiles; /**< Read out of an archive. */
+		long long mappedFiles; /**< Of those read out of an archive, handed out without a copy. */
+		long long bytes;
+
+		Stats()
+			: looseFiles(0), packedFiles(0), mappedFiles(0), bytes(0) {
+		}
+	};
+
+public:
+	/**
+		* Mounts a pack archive over what is already mounted.
+		* @param file Archive to mount.
+		* @returns True on success; false if it could not be opened.
+		*/
+	static bool mount( const char* file );
+
+	/**
+		* Unmounts the archive mounted from a file.  Files already read out of it stay valid.
+		* @returns True if it was mounted.
+		*/
+	static bool unmount( const char* file );
+
+	/**
+		* Unmounts every archive.  Files already read out of them stay valid.
+		*/
+	static void unmountAll();
+
+	/**
+		* Reads a whole file.
+		* @param path Path of the file; either slash works.
+		* @returns The bytes, or invalid FileData if no archive has it and it cannot be read from disk.
+		*/
+	static FileData read( const char* path );
+
+	/**
+		* Gets whether a file can be read, without reading it.
+		*/
+	static bool exists( const char* path );
+
+	/**
+		* Gets what has been read since the last reset.
+		*/
+	static Stats getStats();
+	static void resetStats();
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef __ciri_core_FramePacer__
+#define __ciri_core_FramePacer__
+
+namespace ciri {
+
+/**
+ * Holds frames to a target rate by waiting out what is left of each frame's period.
+ * Sleeping alone wakes late by up to a scheduler tick, and spinning alone burns a core, so it sleeps until a margin before the deadline and
+ * spins the rest.  The margin follows how late sleeps actually wake: it jumps up on a late wake and creeps back down while they are on time.
+ * Deadlines are a fixed period apart rather than a period after each wait ends, so waking a little late does not push every later frame back.
+ * A frame that overruns by more than a whole period moves the schedule to now instead of running frames back to back to catch up.
+ */
+class FramePacer {
+public:
+	struct Stats {
+		int frames;              /**< Waits since the last reset. */
+		int missed;              /**< Frames that were already past their deadline. */
+		long long lateNanosecs;  /**< Summed over every frame, of how long after its deadline it was let go. */
+		long long maxLateNanosecs;
+		long long sleepNanosecs; /**< Spent sleeping. */
+		long long spinNanosecs;  /**< Spent spinning. */
+
+		Stats()
+			: frames(0), missed(0), lateNanosecs(0), maxLateNanosecs(0), sleepNanosecs(0), spinNanosecs(0) {
+		}
+	};
+
+public:
+	FramePacer();
+	~FramePacer();
+
+	/**
+		* Sets the rate to hold frames to and resets the schedule.
+		* @param framesPerSecond Frames per second.  0 or less leaves frames unpaced, and wait returns at once.
+		*/
+	void setTargetRate( double framesPerSecond );
+
+	double getTargetRate() const;
+
+	/**
+		* Starts the schedule over, with the next frame due a period from the next wait, and clears the stats.
+		*/
+	void reset();
+
+	/**
+		* Waits until the next frame is due.
+		* @returns Nanoseconds spent waiting.
+		*/
+	long long wait();
+
+	const Stats& getStats() const;
+
+	/**
+		* Gets how long before a deadline sleeping stops and spinning takes over.
+		*/
+	long long getSpinMarginNanosecs() const;
+
+private:
+	double _targetRate;
+	long long _period;       /**< Nanoseconds; 0 when unpaced. */
+	long long _nextDeadline; /**< In Timer::now's nanoseconds; 0 until the first wait. */
+	long long _spinMargin;
+	Stats _stats;
+};
+
+}
+
+#endif
\ No newline at end of file
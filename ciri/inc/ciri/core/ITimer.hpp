@@ -32,6 +32,13 @@ public:
 		*/
 	virtual void restart()=0;
 
+	/**
+		* Gets the elapsed time since start in nanoseconds.
+		* Whole ticks are counted from the start, so differences of two readings are exact however long the timer has run.
+		* @return Time elapsed in nanoseconds.
+		*/
+	virtual long long getElapsedNanosecs()=0;
+
 	/**
 		* Gets the elapsed time since start in microseconds.
 		* @return Time elapsed in microseconds.
@@ -0,0 +1,129 @@
+#ifndef __ciri_core_JobSystem__
+#define __ciri_core_JobSystem__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "WorkStealingDeque.hpp"
+
+namespace ciri {
+
+struct Job;
+
+/**
+ * Counts jobs that have been run but not finished, so that they can be waited on or be a dependency of other jobs.
+ * A counter can be reused once it is done.  It must not be destroyed while jobs still count on it; JobSystem::wait makes sure of that.
+ */
+class JobCounter {
+public:
+	JobCounter();
+
+	JobCounter( const JobCounter& ) = delete;
+	JobCounter& operator=( const JobCounter& ) = delete;
+
+	/**
+	 * Gets whether every job counting on the counter has finished.
+	 */
+	bool isDone() const;
+
+	int getPending() const;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<int> _pending;
+	std::atomic<int> _finishing; /**< Threads between finishing a job and being done with the counter. */
+	std::mutex _mutex;           /**< Guards _waiting. */
+	Job* _waiting;               /**< Jobs that run once the counter is done. */
+};
+
+/**
+ * Runs jobs on a worker per core.  Each worker, and the thread that created the system, has a WorkStealingDeque it pushes the jobs it runs to;
+ * a thread that runs out of work steals from the others.  Jobs run from other threads go through a shared queue instead.
+ * Waiting on a counter runs other jobs until it is done rather than blocking, so jobs may run and wait on jobs of their own.
+ * Idle workers spin briefly, then sleep until more jobs are run.
+ * With one thread, nothing is created and every job runs on the spot, in order.
+ */
+class JobSystem {
+public:
+	typedef std::function<void()> JobFunction;
+	typedef std::function<void( int begin, int end )> RangeFunction;
+
+public:
+	JobSystem();
+	~JobSystem();
+
+	/**
+	 * Starts the workers.  The calling thread counts as one of the threads.
+	 * @param threadCount Threads that run jobs, including the calling thread.  0 uses one per hardware thread.
+	 * @returns True on success; false if already created.
+	 */
+	bool create( int threadCount=0 );
+
+	/**
+	 * Stops the workers.  Every job must have been waited on first.
+	 */
+	void destroy();
+
+	/**
+	 * Gets the threads that run jobs, including the one that created the system.
+	 */
+	int getThreadCount() const;
+
+	/**
+	 * Runs a job.
+	 * @param function Work of the job.
+	 * @param counter  Optional counter the job counts on until it has finished.
+	 * @param after    Optional counter that must be done before the job starts.
+	 */
+	void run( const JobFunction& function, JobCounter* counter=nullptr, JobCounter* after=nullptr );
+
+	/**
+	 * Runs other jobs on the calling thread until the counter is done.
+	 */
+	void wait( JobCounter& counter );
+
+	/**
+	 * Calls body over [begin, end) in ranges of at most grain, spread over every thread, and returns once they have all finished.
+	 * Ranges are split in halves as they are taken, so a thread that steals takes half of what is left rather than one range.
+	 * @param grain Largest range body is called with.  0 or less picks one that gives each thread about eight ranges.
+	 */
+	void parallelFor( int begin, int end, int grain, const RangeFunction& body );
+
+	/**
+	 * Gets how many jobs have been taken from another thread's deque since creation.
+	 */
+	long long getStealCount() const;
+
+private:
+	void workerMain( int index );
+	void push( Job* job );
+	Job* findJob( int index );
+	void execute( Job* job );
+	void runRange( const RangeFunction* body, int begin, int end, int grain, JobCounter* counter );
+	void finish( JobCounter* counter );
+	void wake();
+
+private:
+	int _threadCount;
+	std::vector<std::thread> _workers;
+	std::vector<std::unique_ptr<WorkStealingDeque<Job>>> _deques; /**< Per thread; the creating thread's is first. */
+	std::mutex _sharedMutex;                                     /**< Guards _shared. */
+	std::deque<Job*> _shared;                                    /**< Jobs run from threads without a deque. */
+	std::atomic<int> _sharedCount;
+	std::mutex _sleepMutex;
+	std::condition_variable _sleepCondition;
+	std::atomic<int> _sleeping;
+	std::atomic<unsigned int> _epoch;                            /**< Bumped whenever a job is pushed, so that a worker going to sleep can tell it missed one. */
+	std::atomic<bool> _stopping;
+	std::atomic<long long> _steals;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef __ciri_core_Leb128__
 #define __ciri_core_Leb128__
 
-#include <fstream>
+#include <istream>
 
 namespace ciri { namespace leb128 {
 
@@ -11,7 +11,7 @@ namespace ciri { namespace leb128 {
 	*
 	* http://en.wikipedia.org/wiki/LEB128
 	*/
-	static int decodeStream( std::ifstream& data, int* outSize=nullptr ) {
+	static int decodeStream( std::istream& data, int* outSize=nullptr ) {
 		int result = 0;
 		int shift = 0;
 		int size = 0;
@@ -1,89 +1,280 @@
 #ifndef __ciri_core_Log__
 #define __ciri_core_Log__
 
-#include <unordered_map>
+#include <atomic>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include "File.hpp"
 
 namespace ciri {
 
+/**
+ * Appends format up to its next {} and returns what follows the {}; if there is none, appends the rest and returns nullptr.
+ */
+const char* appendLogFormat( const char* format, std::string& out );
+void appendLogValue( std::string& out, bool value );
+void appendLogValue( std::string& out, char value );
+void appendLogValue( std::string& out, long long value );
+void appendLogValue( std::string& out, unsigned long long value );
+void appendLogValue( std::string& out, double value );
+void appendLogValue( std::string& out, const char* str, unsigned int length );
+
+/**
+ * Copies one argument of a formatted message into a log record as it is, and reads it back on the writer thread to turn it into text.
+ * Only the types specialized below can be logged.
+ */
+template<typename T, typename Enable=void>
+struct LogArgument;
+
+template<typename T>
+struct LogArgument<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+	// widest type of the same kind, so that one overload of appendLogValue covers each
+	typedef typename std::conditional<std::is_same<T, bool>::value || std::is_same<T, char>::value, T,
+		typename std::conditional<std::is_floating_point<T>::value, double,
+		typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type>::type Wide;
+
+	static size_t size( T ) {
+		return sizeof(T);
+	}
+
+	static char* encode( char* dst, T value ) {
+		memcpy(dst, &value, sizeof(T));
+		return dst + sizeof(T);
+	}
+
+	static const char* decode( const char* src, std::string* out ) {
+		if( out != nullptr ) {
+			T value;
+			memcpy(&value, src, sizeof(T));
+			appendLogValue(*out, static_cast<Wide>(value));
+		}
+		return src + sizeof(T);
+	}
+};
+
+/**
+ * Strings are copied, up to MAX_LENGTH bytes, since the caller's may be gone by the time the writer gets to them.
+ */
+template<>
+struct LogArgument<const char*> {
+	static const unsigned int MAX_LENGTH = 16 * 1024;
+
+	static size_t size( const char* str ) {
+		return sizeof(unsigned int) + length(str);
+	}
+
+	static char* encode( char* dst, const char* str ) {
+		return encode(dst, str, length(str));
+	}
+
+	static char* encode( char* dst, const char* str, unsigned int length ) {
+		memcpy(dst, &length, sizeof(length));
+		if( length > 0 ) {
+			memcpy(dst + sizeof(length), str, length);
+		}
+		return dst + sizeof(length) + length;
+	}
+
+	static const char* decode( const char* src, std::string* out ) {
+		unsigned int length;
+		memcpy(&length, src, sizeof(length));
+		if( out != nullptr ) {
+			appendLogValue(*out, src + sizeof(length), length);
+		}
+		return src + sizeof(length) + length;
+	}
+
+	static unsigned int length( const char* str ) {
+		if( nullptr == str ) {
+			return 0;
+		}
+		const size_t length = strlen(str);
+		return static_cast<unsigned int>((length < MAX_LENGTH) ? length : MAX_LENGTH);
+	}
+};
+
+template<>
+struct LogArgument<char*> : LogArgument<const char*> {
+};
+
+template<>
+struct LogArgument<std::string> : LogArgument<const char*> {
+	static size_t size( const std::string& str ) {
+		return sizeof(unsigned int) + length(str);
+	}
+
+	static char* encode( char* dst, const std::string& str ) {
+		return LogArgument<const char*>::encode(dst, str.data(), length(str));
+	}
+
+	static unsigned int length( const std::string& str ) {
+		return static_cast<unsigned int>((str.size() < MAX_LENGTH) ? str.size() : MAX_LENGTH);
+	}
+};
+
+inline size_t logArgumentsSize() {
+	return 0;
+}
+
+template<typename T, typename... Rest>
+size_t logArgumentsSize( const T& first, const Rest&... rest ) {
+	return LogArgument<typename std::decay<T>::type>::size(first) + logArgumentsSize(rest...);
+}
+
+inline void encodeLogArguments( char* ) {
+}
+
+template<typename T, typename... Rest>
+void encodeLogArguments( char* dst, const T& first, const Rest&... rest ) {
+	encodeLogArguments(LogArgument<typename std::decay<T>::type>::encode(dst, first), rest...);
+}
+
+/**
+ * Formats a record's arguments into out, each one in place of the next {} in format.  Arguments past the last {} are left out.
+ */
+template<typename... Args>
+void decodeLogArguments( const char* format, const char* data, std::string& out ) {
+	int expand[] = { 0, (format = (format != nullptr) ? appendLogFormat(format, out) : nullptr, data = LogArgument<Args>::decode(data, (format != nullptr) ? &out : nullptr), 0)... };
+	(void)expand;
+	if( format != nullptr ) {
+		out += format;
+	}
+}
+
+/**
+ * Log messages are written out on a thread of their own.  Logging copies the message and its arguments into a ring of the calling thread's,
+ * and a writer thread shared by every log formats them, timestamps included, and writes each log's messages out in one call per batch.
+ * Messages from one thread come out in order; messages from different threads are only in order to within one batch.
+ * What happens when a thread logs faster than the writer keeps up is set with Logs::setOverflow.
+ */
 class Log {
+public:
+	enum Level {
+		Message,
+		Info,
+		Warning,
+		Error
+	};
+
+	typedef void (*DecodeFunction)( const char* format, const char* data, std::string& out );
+
 public:
 	Log();
 	~Log();
 
+	Log( const Log& ) = delete;
+	Log& operator=( const Log& ) = delete;
 
 	/**
-		* Writes a message to the log.
-		* 
-		* @param msg Message to write.
-		*/
+	 * Writes a message to the log, formatted on the writer thread.  Each argument replaces the next {} in format.
+	 * Arguments can be any integer or floating point type, bool, char, C strings or std::string; strings are copied.
+	 * 
+	 * @param level  Prefix of the message; Message has none.
+	 * @param format Format of the message.  Only the pointer is kept, so it must outlive the log; a string literal does.
+	 * @param args   Arguments of the message.
+	 */
+	template<typename... Args>
+	void printFormatted( Level level, const char* format, const Args&... args ) {
+		char* data = beginRecord(level, format, &decodeLogArguments<typename std::decay<Args>::type...>, logArgumentsSize(args...));
+		if( data != nullptr ) {
+			encodeLogArguments(data, args...);
+			endRecord(level);
+		}
+	}
+
+
+	/**
+	 * Writes a message to the log.
+	 * 
+	 * @param msg Message to write.
+	 */
 	void print( const std::string& msg );
 
 	/**
-		* Writes a message to the log, prefixed with [INFO]. 
-		* 
-		* @param msg Message to write.
-		*/
+	 * Writes a message to the log, prefixed with [INFO]. 
+	 * 
+	 * @param msg Message to write.
+	 */
 	void printInfo( const std::string& msg );
 
 	/**
-		* Writes a message to the log, prefixed with [WARNING].
-		* 
-		* @param msg Message to write.
-		*/
+	 * Writes a message to the log, prefixed with [WARNING].
+	 * 
+	 * @param msg Message to write.
+	 */
 	void printWarning( const std::string& msg );
 
 	/**
-		* Writes a message to the log, prefixed with [ERROR].
-		* 
-		* @param msg Mesage to write.
-		*/
+	 * Writes a message to the log, prefixed with [ERROR].
+	 * 
+	 * @param msg Mesage to write.
+	 */
 	void printError( const std::string& msg );
 
 	/**
-		* Sets the output file of the log.
-		* If the file already exists, it will be replaced; otherwise, it will be created.
-		* 
-		* @param file File to use for log output.
-		* @return Success of opening the specified file for writing.
-		*/
+	 * Sets the output file of the log.
+	 * If the file already exists, it will be replaced; otherwise, it will be created.
+	 * 
+	 * @param file File to use for log output.
+	 * @return Success of opening the specified file for writing.
+	 */
 	bool setFile( const char* file );
 
 	/**
-		* Closes the file handle.
-		*/
+	 * Closes the file handle.
+	 */
 	void closeFile();
 
 	/**
-		* Sets whether to append a new line a the end of messages.
-		* 
-		* @param val If true, a new line '\n' will be appended to all messages.
-		*/
+	 * Sets whether to append a new line a the end of messages.
+	 * 
+	 * @param val If true, a new line '\n' will be appended to all messages.
+	 */
 	void setAppendNewLine( bool val );
 
 	/**
-		* Sets whether to prefix all messages with a timestamp.
-		* 
-		* @param val If true, a timestamp will be prefixed to all messages.
-		*/
+	 * Sets whether to prefix all messages with a timestamp.
+	 * 
+	 * @param val If true, a timestamp will be prefixed to all messages.
+	 */
 	void setPrefixTimestamp( bool val );
 
 	/**
-		* Sets whether to additionally log to standard output.
-		* 
-		* @param val If true, output will be sent to standard output in addition to the file.
-		*/
+	 * Sets whether to additionally log to standard output.
+	 * 
+	 * @param val If true, output will be sent to standard output in addition to the file.
+	 */
 	void setLogToStd( bool val );
 
 private:
-	std::string generateTimestampString() const;
+	friend class LogWriter;
+
+	/**
+	 * Starts a record in the calling thread's ring.
+	 * @returns Where to encode the arguments, or nullptr if the message was dropped.
+	 */
+	char* beginRecord( Level level, const char* format, DecodeFunction decode, size_t size );
+	void endRecord( Level level );
+
+	/**
+	 * Appends a formatted message, with its timestamp, prefix and new line, to text.
+	 */
+	void formatRecord( Level level, long long timestamp, const char* format, DecodeFunction decode, const char* data, std::string& text, long long& cachedSecond, std::string& cachedTimestamp ) const;
+
+	/**
+	 * Writes formatted messages to the file and standard output.
+	 */
+	void writeOut( const std::string& text );
 
 private:
 	File _file;
-	bool _appendNewLine;
-	bool _prefixTimestamp;
-	bool _logToStd;
+	std::mutex _fileMutex; /**< Guards _file, which the writer thread writes to. */
+	std::atomic<bool> _appendNewLine;
+	std::atomic<bool> _prefixTimestamp;
+	std::atomic<bool> _logToStd;
+	std::atomic<long long> _dropped; /**< Messages dropped since the writer last reported it. */
 };
 
 class Logs {
@@ -94,10 +285,35 @@ public:
 		Custom
 	};
 
+	/**
+	 * What a thread does when its ring has no room for a message.
+	 */
+	enum Overflow {
+		Drop, /**< Drops the message; the log says how many were dropped when it next writes. */
+		Block /**< Wakes the writer and waits for room.  Logging never loses messages, but can stall for as long as writing out takes. */
+	};
+
 	static Log& get( Channel channel );
 
-private:
-	static std::unordered_map<Channel, Log> _logs;
+	/**
+	 * Blocks until every message logged before the call, from any thread, has been written out.
+	 */
+	static void flush();
+
+	/**
+	 * Sets what threads do when their ring fills up; Drop to begin with.
+	 */
+	static void setOverflow( Overflow overflow );
+
+	/**
+	 * Sets the bytes of ring each thread gets the first time it logs; 256 KB to begin with.  Threads that have already logged keep theirs.
+	 */
+	static void setRingSize( size_t bytes );
+
+	/**
+	 * Gets how many messages have been dropped, in total, because a ring was full or a message would never fit in one.
+	 */
+	static long long getDroppedCount();
 };
 
 }
@@ -0,0 +1,152 @@
+#ifndef __ciri_core_LogRing__
+#define __ciri_core_LogRing__
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace ciri {
+
+/**
+ * Single producer, single consumer ring of variable sized records, for handing log messages from the thread that logs them to the thread that
+ * writes them out.  Each record is an eight byte length word and its bytes, rounded up to eight bytes, and never wraps; a record that does not fit before
+ * the end pads out the rest of the ring and starts again at the front.  Each side keeps its own copy of the other side's position and only
+ * reloads it when that copy says the ring is full or empty, so most calls do not touch the other side's cache line.
+ */
+class LogRing {
+public:
+	/**
+	 * @param capacity Bytes of the ring, rounded up to a power of two.
+	 */
+	LogRing( size_t capacity )
+		: _head(0), _reserved(0), _cachedTail(0), _tail(0), _cachedHead(0) {
+		size_t size = 64;
+		while( size < capacity ) {
+			size *= 2;
+		}
+		_buffer.reset(new char[size]);
+		_mask = size - 1;
+	}
+
+	size_t getCapacity() const {
+		return _mask + 1;
+	}
+
+	/**
+	 * Gets whether a record of the given size can ever fit.  Anything up to half the ring does, however the padding falls.
+	 */
+	bool fits( size_t size ) const {
+		return recordSize(size) <= getCapacity() / 2;
+	}
+
+	/**
+	 * Makes room for a record at the head.  Producer only.
+	 * @returns Where to write the record's bytes, eight byte aligned, or nullptr if the ring is too full.  Nothing is seen until commit.
+	 */
+	char* reserve( size_t size ) {
+		const size_t need = recordSize(size);
+		size_t head = _head.load(std::memory_order_relaxed);
+		const size_t toEnd = getCapacity() - (head & _mask);
+		const size_t total = (toEnd < need) ? (toEnd + need) : need;
+		if( head + total - _cachedTail > getCapacity() ) {
+			_cachedTail = _tail.load(std::memory_order_acquire);
+			if( head + total - _cachedTail > getCapacity() ) {
+				return nullptr;
+			}
+		}
+		if( toEnd < need ) {
+			writeWord(head, toEnd | PADDING);
+			head += toEnd;
+		}
+		writeWord(head, need);
+		_reserved = head + need;
+		return &_buffer[(head & _mask) + sizeof(Word)];
+	}
+
+	/**
+	 * Publishes the record last reserved.  Producer only.
+	 */
+	void commit() {
+		_head.store(_reserved, std::memory_order_release);
+	}
+
+	/**
+	 * Gets the bytes in use as the producer last saw them; never less than the truth.  Producer only.
+	 */
+	size_t getUsed() const {
+		return _head.load(std::memory_order_relaxed) - _cachedTail;
+	}
+
+	/**
+	 * Gets the oldest record.  Consumer only.
+	 * @returns Its bytes, or nullptr if the ring is empty.
+	 */
+	const char* front() {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		while( true ) {
+			if( tail == _cachedHead ) {
+				_cachedHead = _head.load(std::memory_order_acquire);
+				if( tail == _cachedHead ) {
+					return nullptr;
+				}
+			}
+			const Word word = readWord(tail);
+			if( 0 == (word & PADDING) ) {
+				return &_buffer[(tail & _mask) + sizeof(Word)];
+			}
+			tail += static_cast<size_t>(word & ~PADDING);
+			_tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	/**
+	 * Removes the record front returned.  Consumer only.
+	 */
+	void pop() {
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		_tail.store(tail + static_cast<size_t>(readWord(tail)), std::memory_order_release);
+	}
+
+	/**
+	 * Gets whether the ring looked empty; only a hint while the producer runs.
+	 */
+	bool isEmpty() const {
+		return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+	}
+
+private:
+	// eight bytes whatever size_t is, so that records stay eight byte aligned on 32 bit builds too
+	typedef unsigned long long Word;
+
+	static const Word PADDING = 1ULL << 63;
+
+	static size_t recordSize( size_t size ) {
+		return sizeof(Word) + ((size + 7) & ~static_cast<size_t>(7));
+	}
+
+	void writeWord( size_t position, Word word ) {
+		memcpy(&_buffer[position & _mask], &word, sizeof(word));
+	}
+
+	Word readWord( size_t position ) const {
+		Word word;
+		memcpy(&word, &_buffer[position & _mask], sizeof(word));
+		return word;
+	}
+
+private:
+	std::unique_ptr<char[]> _buffer;
+	size_t _mask;
+	// producer's side
+	std::atomic<size_t> _head;
+	size_t _reserved;
+	size_t _cachedTail;
+	char _padding[64];
+	// consumer's side
+	std::atomic<size_t> _tail;
+	size_t _cachedHead;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef __ciri_core_MappedFile__
+#define __ciri_core_MappedFile__
+
+#include <cstddef>
+
+namespace ciri {
+
+/**
+ * A whole file mapped read-only into memory.  Pages are read in by the OS as they are first touched, and stay shared with its file cache,
+ * so nothing is copied; pointers into the mapping are good until it is closed.
+ */
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	/**
+		* Maps a file.
+		* @param file File to map.
+		* @returns True on success; false if it could not be opened or mapped, or is already open.
+		*/
+	bool open( const char* file );
+
+	/**
+		* Unmaps the file.
+		*/
+	void close();
+
+	bool isOpen() const;
+	const unsigned char* getData() const;
+	size_t getSize() const;
+
+private:
+	const unsigned char* _data;
+	size_t _size;
+	void* _fileHandle;    /**< Windows only. */
+	void* _mappingHandle; /**< Windows only. */
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef __ciri_core_PackArchive__
+#define __ciri_core_PackArchive__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileData.hpp"
+#include "MappedFile.hpp"
+
+namespace ciri {
+
+struct PackEntry;
+
+/**
+ * Read-only archive of many files in one, mapped into memory as a whole, so that loading hundreds of assets costs one open instead of
+ * an open, a few reads and a close each.
+ * Layout: a header, then the entries' bytes, then a table of contents sorted by name, then the names.  Looking a file up is a binary search.
+ * Each entry is either compressed with zlib, and inflated into a buffer of its own when read, or stored as is at a 4 KB aligned offset,
+ * in which case reading it hands out a span of the mapping with nothing copied.  Names use forward slashes.
+ */
+class PackArchive {
+public:
+	struct BuildStats {
+		int files;
+		int compressed;
+		unsigned long long bytes;       /**< Of the files as they were. */
+		unsigned long long packedBytes; /**< Of the archive. */
+
+		BuildStats()
+			: files(0), compressed(0), bytes(0), packedBytes(0) {
+		}
+	};
+
+public:
+	PackArchive();
+	~PackArchive();
+
+	PackArchive( const PackArchive& ) = delete;
+	PackArchive& operator=( const PackArchive& ) = delete;
+
+	/**
+		* Maps an archive and checks its table of contents.
+		* @param file Archive to open.
+		* @returns True on success; false if it could not be mapped or is not a valid archive.
+		*/
+	bool open( const char* file );
+
+	void close();
+
+	bool isOpen() const;
+
+	/**
+		* Gets whether the archive has a file.
+		* @param name Name as it was packed, with forward slashes.
+		*/
+	bool contains( const std::string& name ) const;
+
+	/**
+		* Reads a file out of the archive.  The bytes of stored files point into the mapping and keep it alive.
+		* @param name Name as it was packed, with forward slashes.
+		* @param mapped Optional; set to whether the bytes point into the mapping rather than a buffer of their own.
+		* @returns The bytes, or invalid FileData if there is no such file or it failed to inflate.
+		*/
+	FileData read( const std::string& name, bool* mapped=nullptr ) const;
+
+	int getEntryCount() const;
+	std::string getEntryName( int index ) const;
+
+	/**
+		* Packs every file under a directory into an archive.  Files are named by their path from the working directory, so that loaders
+		* asking for "data/x.obj" find what was packed from "data".
+		* @param directory Directory to pack.
+		* @param file      Archive to write.
+		* @param level     zlib compression level; 0 stores every file, so that all of them can be read without a copy.
+		*                  Files that would not shrink by an eighth are stored either way.
+		* @param stats     Optional; receives what was packed.
+		* @returns True on success.
+		*/
+	static bool build( const char* directory, const char* file, int level=6, BuildStats* stats=nullptr );
+
+	/**
+		* Turns a path into the form archives name files by: forward slashes, and no leading "./".
+		*/
+	static std::string normalizePath( const char* path );
+
+private:
+	int find( const std::string& name ) const;
+
+private:
+	std::shared_ptr<MappedFile> _file;
+	const PackEntry* _entries;
+	const char* _names;
+	int _entryCount;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,177 @@
+#ifndef __ciri_core_Profiler__
+#define __ciri_core_Profiler__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace ciri {
+
+/**
+ * One timed scope as captured, in nanoseconds of Profiler::now.
+ */
+struct ProfileEvent {
+	const char* name; /**< Must outlive the profiler; scopes are named with string literals. */
+	long long start;
+	long long end;
+	int depth;        /**< Nesting depth within its thread (or within the gpu's scopes), starting at 0. */
+	int thread;       /**< Index of the capturing thread, or Profiler::GPU_THREAD. */
+};
+
+/**
+ * A scope aggregated across frames by where it sits in the tree of scopes.
+ * Times are summed per frame over every call, then min, avg and max are taken over the last Profiler::HISTORY frames the scope ran in.
+ */
+struct ProfileNode {
+	std::string name;
+	int parent;       /**< Index of the parent node, or -1 for a thread's root. */
+	int depth;
+	int thread;
+	int calls;        /**< Calls in the last frame it ran. */
+	double lastMs;
+	double minMs;
+	double avgMs;
+	double maxMs;
+	int lastFrame;    /**< Frame index it last ran in. */
+
+	ProfileNode();
+};
+
+/**
+ * Hierarchical cpu scopes and gpu timestamps gathered into per-frame trees.
+ * Each thread writes finished scopes into a ring of its own without locking; endFrame drains every ring on the calling thread.
+ * GPU scopes are timed by the graphics device with timestamp queries and reported a few frames late through addGpuEvents.
+ * While disabled, a scope costs one relaxed atomic load.  Define CIRI_PROFILER_DISABLED to compile the scope macros out entirely.
+ * Everything other than scopes and addGpuEvents must be called from the thread that runs the frame loop.
+ */
+class Profiler {
+public:
+	static const int GPU_THREAD = -1;
+	static const int HISTORY = 120;          /**< Frames that min, avg and max are taken over. */
+	static const int MAX_DEPTH = 32;         /**< Deeper scopes are not recorded. */
+	static const int RING_CAPACITY = 4096;   /**< Finished scopes each thread can hold between two endFrames; more are dropped. */
+
+public:
+	static bool isEnabled() {
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+		* Enables or disables capturing.  Scopes open when disabling still record when they close.
+		*/
+	static void setEnabled( bool enabled );
+
+	/**
+		* Names the calling thread in the overlay and in traces.  Threads that have exited give their index to the next new thread.
+		* @param name Name of the thread; copied.
+		*/
+	static void setThreadName( const char* name );
+
+	/**
+		* Gets the name of a thread as set by setThreadName; "GPU" for GPU_THREAD and "thread N" for threads never named.
+		*/
+	static std::string getThreadName( int thread );
+
+	/**
+		* Gets the current time in nanoseconds from a steady clock.
+		*/
+	static long long now();
+
+	/**
+		* Opens and closes a scope on the calling thread.  Use ProfileScope or CIRI_PROFILE_SCOPE rather than calling these directly.
+		*/
+	static void beginScope( const char* name );
+	static void endScope();
+
+	/**
+		* Marks the start of a frame.
+		*/
+	static void beginFrame();
+
+	/**
+		* Drains every thread's ring into the frame's tree and updates the nodes' statistics.
+		*/
+	static void endFrame();
+
+	/**
+		* Adds resolved gpu scopes to the current frame.  Called by the graphics devices; times must already be in the clock of now.
+		*/
+	static void addGpuEvents( const ProfileEvent* events, int count );
+
+	/**
+		* Gets the aggregated tree; parents always come before their children.
+		*/
+	static const std::vector<ProfileNode>& getNodes();
+
+	/**
+		* Gets the number of scopes dropped because a thread's ring was full or too deep.
+		*/
+	static long long getDroppedCount();
+
+	/**
+		* Gets the number of frames ended since the last reset.
+		*/
+	static int getFrameIndex();
+
+	/**
+		* Forgets every node, captured frame, and statistic.
+		*/
+	static void reset();
+
+	/**
+		* Sets how many of the most recent frames' scopes are kept for writeChromeTrace.  0 (the default) keeps none.
+		*/
+	static void setTraceFrames( int frames );
+
+	/**
+		* Writes the kept frames in the Chrome trace event format, for chrome://tracing or Perfetto.
+		* @param file File to write to.
+		* @returns True if written; false otherwise.
+		*/
+	static bool writeChromeTrace( const char* file );
+
+private:
+	static std::atomic<bool> _enabled;
+};
+
+/**
+ * Times the enclosing block while the profiler is enabled.
+ */
+class ProfileScope {
+public:
+	explicit ProfileScope( const char* name )
+		: _active(Profiler::isEnabled()) {
+		if( _active ) {
+			Profiler::beginScope(name);
+		}
+	}
+
+	~ProfileScope() {
+		if( _active ) {
+			Profiler::endScope();
+		}
+	}
+
+private:
+	ProfileScope( const ProfileScope& );
+	ProfileScope& operator=( const ProfileScope& );
+
+private:
+	bool _active;
+};
+
+}
+
+#define CIRI_PROFILE_CONCAT_INNER(a, b) a##b
+#define CIRI_PROFILE_CONCAT(a, b) CIRI_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef CIRI_PROFILER_DISABLED
+	#define CIRI_PROFILE_SCOPE(name)
+#else
+	/**
+	 * Times the rest of the enclosing block as a cpu scope.  The name must be a string literal or otherwise outlive the profiler.
+	 */
+	#define CIRI_PROFILE_SCOPE(name) ::ciri::ProfileScope CIRI_PROFILE_CONCAT(ciriProfileScope, __LINE__)(name)
+#endif
+
+#endif
\ No newline at end of file
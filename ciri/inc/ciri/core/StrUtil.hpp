@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <codecvt>
+#include <locale>
 
 namespace ciri { namespace strutil {
 
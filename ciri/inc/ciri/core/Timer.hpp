@@ -2,10 +2,13 @@
 #define __ciri_core_Timer__
 
 #include <ciri/core/ITimer.hpp>
-#include <Windows.h>
 
 namespace ciri {
 
+/**
+ * Timer over std::chrono::steady_clock, which is monotonic on every platform: QueryPerformanceCounter on Windows and
+ * clock_gettime(CLOCK_MONOTONIC) elsewhere.
+ */
 class Timer : public ITimer {
 public:
 	Timer();
@@ -15,14 +18,19 @@ public:
 	virtual void pause() override;
 	virtual void stop() override;
 	virtual void restart() override;
+	virtual long long getElapsedNanosecs() override;
 	virtual double getElapsedMicrosecs() override;
 	virtual double getElapsedMillisecs() override;
 	virtual double getElapsedSecs() override;
 
+	/**
+		* Gets the steady clock's current time in nanoseconds from an arbitrary but fixed point.
+		*/
+	static long long now();
+
 private:
-	LARGE_INTEGER _frequency;
-	LARGE_INTEGER _startCount;
-	LARGE_INTEGER _endCount;
+	long long _startTicks;
+	long long _endTicks;
 	bool _isPaused;
 };
 
@@ -0,0 +1,131 @@
+#ifndef __ciri_core_WorkStealingDeque__
+#define __ciri_core_WorkStealingDeque__
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace ciri {
+
+/**
+ * Chase-Lev work-stealing deque of pointers.
+ * The owning thread pushes and takes at the bottom without locking; any other thread steals from the top, racing the owner only for the last item.
+ * The ring doubles when full.  Rings it outgrew are kept until the deque is destroyed, since a thief may still be reading one.
+ * Follows Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models", with its two fences folded into
+ * seq_cst operations on top and bottom; those cost the same on x86, and thread sanitizers understand them where they do not understand fences.
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+	WorkStealingDeque( int capacity=256 )
+		: _top(0), _bottom(0) {
+		int size = 1;
+		while( size < capacity ) {
+			size *= 2;
+		}
+		_rings.push_back(std::unique_ptr<Ring>(new Ring(size)));
+		_ring.store(_rings.back().get(), std::memory_order_relaxed);
+	}
+
+	/**
+	 * Adds an item at the bottom.  Owning thread only.
+	 */
+	void push( T* item ) {
+		const long long bottom = _bottom.load(std::memory_order_relaxed);
+		const long long top = _top.load(std::memory_order_acquire);
+		Ring* ring = _ring.load(std::memory_order_relaxed);
+		if( bottom - top > ring->mask ) {
+			ring = grow(ring, top, bottom);
+		}
+		ring->put(bottom, item);
+		// release rather than a fence and a relaxed store; it is what publishes the item to thieves
+		_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Removes the item at the bottom, the one pushed last.  Owning thread only.
+	 * @returns The item, or nullptr if the deque is empty.
+	 */
+	T* take() {
+		const long long bottom = _bottom.load(std::memory_order_relaxed) - 1;
+		Ring* ring = _ring.load(std::memory_order_relaxed);
+		_bottom.store(bottom, std::memory_order_seq_cst);
+		long long top = _top.load(std::memory_order_seq_cst);
+		if( top > bottom ) {
+			_bottom.store(bottom + 1, std::memory_order_release);
+			return nullptr;
+		}
+		T* item = ring->get(bottom);
+		if( top == bottom ) {
+			// last item; whoever moves top first gets it
+			if( !_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) ) {
+				item = nullptr;
+			}
+			_bottom.store(bottom + 1, std::memory_order_release);
+		}
+		return item;
+	}
+
+	/**
+	 * Removes the item at the top, the oldest.  Any thread.
+	 * @returns The item, or nullptr if the deque is empty or another thread got there first.
+	 */
+	T* steal() {
+		long long top = _top.load(std::memory_order_seq_cst);
+		const long long bottom = _bottom.load(std::memory_order_seq_cst);
+		if( top >= bottom ) {
+			return nullptr;
+		}
+		Ring* ring = _ring.load(std::memory_order_acquire);
+		T* item = ring->get(top);
+		if( !_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) ) {
+			return nullptr;
+		}
+		return item;
+	}
+
+	/**
+	 * Gets whether the deque looked empty; only a hint while other threads use it.
+	 */
+	bool isEmpty() const {
+		return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Ring {
+		long long mask;
+		std::unique_ptr<std::atomic<T*>[]> items;
+
+		Ring( int size )
+			: mask(size - 1), items(new std::atomic<T*>[size]) {
+		}
+
+		void put( long long index, T* item ) {
+			items[index & mask].store(item, std::memory_order_relaxed);
+		}
+
+		T* get( long long index ) const {
+			return items[index & mask].load(std::memory_order_relaxed);
+		}
+	};
+
+	Ring* grow( Ring* ring, long long top, long long bottom ) {
+		std::unique_ptr<Ring> bigger(new Ring(static_cast<int>((ring->mask + 1) * 2)));
+		for( long long i = top; i < bottom; ++i ) {
+			bigger->put(i, ring->get(i));
+		}
+		_rings.push_back(std::move(bigger));
+		_ring.store(_rings.back().get(), std::memory_order_release);
+		return _rings.back().get();
+	}
+
+private:
+	std::atomic<long long> _top;
+	std::atomic<long long> _bottom;
+	std::atomic<Ring*> _ring;
+	std::vector<std::unique_ptr<Ring>> _rings; /**< Owning thread only. */
+};
+
+}
+
+#endif
\ No newline at end of file
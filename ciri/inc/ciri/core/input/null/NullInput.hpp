@@ -0,0 +1,36 @@
+#ifndef __ciri_core_NullInput__
+#define __ciri_core_NullInput__
+
+#include <ciri/core/input/IInput.hpp>
+
+namespace ciri {
+
+/**
+ * Input with no devices attached.
+ * Every key and button is always up and the mouse never moves; used to run apps headless.
+ */
+class NullInput : public IInput {
+public:
+	NullInput();
+	virtual ~NullInput();
+
+	virtual bool create( std::shared_ptr<IWindow> window ) override;
+	virtual bool poll() override;
+	virtual bool update() override;
+	virtual bool isKeyDown( Key key ) const override;
+	virtual bool isKeyUp( Key key ) const override;
+	virtual bool wasKeyDown( Key key ) const override;
+	virtual bool wasKeyUp( Key key ) const override;
+	virtual bool isMouseButtonDown( MouseButton button ) const override;
+	virtual bool isMouseButtonUp( MouseButton button ) const override;
+	virtual bool wasMouseButtonDown( MouseButton button ) const override;
+	virtual bool wasMouseButtonUp( MouseButton button ) const override;
+	virtual int mouseX() const override;
+	virtual int mouseY() const override;
+	virtual int lastMouseX() const override;
+	virtual int lastMouseY() const override;
+};
+
+}
+
+#endif
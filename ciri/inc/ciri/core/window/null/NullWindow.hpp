@@ -0,0 +1,38 @@
+#ifndef __ciri_core_NullWindow__
+#define __ciri_core_NullWindow__
+
+#include <string>
+#include <ciri/core/window/IWindow.hpp>
+
+namespace ciri {
+
+/**
+ * Window that is never displayed.
+ * Keeps a fixed size, always reports focus, and never produces events; used to run apps headless.
+ */
+class NullWindow : public IWindow {
+public:
+	NullWindow();
+	virtual ~NullWindow();
+
+	virtual bool create( int width, int height ) override;
+	virtual bool isOpen() const override;
+	virtual bool pollEvent( WindowEvent& evt ) override;
+	virtual void close() override;
+	virtual void setWindowText( const char* str ) override;
+	virtual int getWidth() const override;
+	virtual int getHeight() const override;
+	virtual bool hasFocus() const override;
+	virtual void* getNativeHandle() const override;
+	virtual void setCursorVisible( bool visible ) override;
+
+private:
+	bool _isOpen;
+	int _width;
+	int _height;
+	std::string _text;
+};
+
+}
+
+#endif
@@ -1,21 +1,47 @@
 #ifndef __ciri_game_App__
 #define __ciri_game_App__
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <ciri/Core.hpp>
 #include <ciri/Graphics.hpp>
+#include "RenderSnapshot.hpp"
 
 namespace ciri {
 
+class GraphicsCommandStream;
+
 struct AppConfig {
 	std::string title;
 	int width;
 	int height;
+	int constantRingSize; /**< Bytes of constant updates suballocated per frame; see IGraphicsDevice::setConstantRingSize.  0 disables the ring. */
+	bool profile; /**< Enables the Profiler when the loop starts.  It can also be toggled at any time with Profiler::setEnabled. */
+	std::string shaderCacheDirectory; /**< Where compiled shaders are kept between runs; see IGraphicsDevice::setShaderCacheDirectory.  Empty disables the cache. */
+	int frameLimit; /**< Stops run after this many frames, or never if negative; runHeadless takes its own count. */
+	bool pipelined; /**< Simulates each frame on a thread of its own while the main thread draws the frame before it; see App::drawSnapshot.  The last frame is drawn after the loop ends. */
+	int jobThreads; /**< Threads of the job system, counting the main thread.  0 uses one per hardware thread; 1 runs every job on the main thread as it is submitted. */
+	double targetFrameRate; /**< Frames per second the loop is held to with a FramePacer, on top of any vsync.  0 leaves it unpaced. */
+	int maxFixedSteps; /**< Most onFixedUpdate calls in one frame.  Time beyond that is dropped so a slow frame cannot make the next slower still.  0 never drops. */
+	double benchmarkDelta; /**< Seconds every frame advances by in place of the timer, so benchmark runs simulate the same frames however fast they draw.  0 uses the timer, or steps 1/60s in runHeadless. */
+	std::string packFile; /**< Pack archive mounted while the app runs, so that content loads out of it ahead of loose files; see FileSystem.  Empty mounts nothing. */
 	AppConfig() {
 		title = "ciri";
 		width = 1280;
 		height = 720;
+		constantRingSize = 1024 * 1024;
+		profile = false;
+		shaderCacheDirectory = "shadercache";
+		frameLimit = -1;
+		pipelined = false;
+		jobThreads = 0;
+		targetFrameRate = 0.0;
+		maxFixedSteps = 5;
+		benchmarkDelta = 0.0;
+		packFile = "";
 	}
 };
 
@@ -27,6 +53,49 @@ public:
 public:
 	bool run();
 
+	/**
+	 * Runs the app without a window or GPU for a fixed number of frames.
+	 * Uses a NullWindow, NullInput, and NullGraphicsDevice, steps time by a fixed 1/60s per frame, and has no game timer.
+	 * @param frameCount Number of frames to run before stopping; the app can still gtfo earlier.
+	 * @param recorded   Optional stream to receive everything the device recorded before it was destroyed.
+	 * @returns True on success; false otherwise.
+	 */
+	bool runHeadless( int frameCount, GraphicsCommandStream* recorded=nullptr );
+
+	/**
+	 * Gets the config, which can be changed before calling run or runHeadless.
+	 */
+	AppConfig& getConfig();
+
+	/**
+	 * Gets the seconds from initializing until the first frame had been drawn, from the last run or runHeadless.
+	 * This covers loading content and any shaders the first frame had to wait on; shaders still compiling that it skipped are not included.
+	 */
+	double getStartupSeconds() const;
+
+	/**
+	 * Gets the snapshot that onUpdate and onFixedUpdate write the frame into.  It is cleared before each onUpdate.
+	 */
+	RenderSnapshot& updateSnapshot();
+
+	/**
+	 * Gets the snapshot that onDraw draws.  Normally this is the frame that was just simulated.
+	 * When pipelined, onUpdate and onFixedUpdate run on another thread at the same time as onDraw, and this is the frame simulated one before;
+	 * onDraw must then take everything it draws from here, and must not touch what the simulation changes.  Window events and input are
+	 * only handled while the simulation is between frames, so onEvent and the input are safe to use from either.
+	 */
+	const RenderSnapshot& drawSnapshot() const;
+
+	/**
+	 * Gets the pacer that holds the loop to AppConfig::targetFrameRate, and its stats from the last run.
+	 */
+	const FramePacer& framePacer() const;
+
+	/**
+	 * Gets how many fixed updates AppConfig::maxFixedSteps has dropped in the last run.
+	 */
+	int getDroppedFixedSteps() const;
+
 protected:
 	virtual void onInitialize();
 	virtual void onLoadContent();
@@ -37,12 +106,28 @@ protected:
 	virtual void onUnloadContent();
 	void gtfo();
 
+private:
+	void runLoop( int maxFrames );
+	void simulate( double deltaTime );
+	void draw();
+	void startSimulationThread();
+	void stopSimulationThread();
+	void simulationMain();
+	void mountContent();
+	void cleanup();
+
 protected:
 	std::shared_ptr<ciri::IWindow> window() const;
 	std::shared_ptr<ciri::IInput> input() const;
 	std::shared_ptr<ciri::IGraphicsDevice> graphicsDevice() const;
 	std::shared_ptr<ciri::ITimer> gameTimer() const;
 
+	/**
+	 * Gets the job system, which onUpdate and onFixedUpdate can spread work over.  It is created on the main thread before onInitialize
+	 * and destroyed after onUnloadContent, so jobs waited on there run on the main thread and every worker.
+	 */
+	std::shared_ptr<ciri::JobSystem> jobSystem() const;
+
 protected:
 	AppConfig _config;
 
@@ -50,10 +135,31 @@ private:
 	bool _isRunning;
 	bool _isInitialized;
 	bool _shouldGtfo;
+	long long _startTime;
+	double _startupSeconds;
 	std::shared_ptr<ciri::IWindow> _window;
 	std::shared_ptr<ciri::IInput> _input;
 	std::shared_ptr<ciri::IGraphicsDevice> _graphicsDevice;
 	std::shared_ptr<ciri::ITimer> _gameTimer;
+	std::shared_ptr<ciri::JobSystem> _jobSystem;
+	FramePacer _framePacer;
+	std::string _mountedPack;
+
+	// frame state; only the simulation touches it while a frame is being simulated
+	int _frame;
+	double _elapsedTime;
+	double _lag;
+	int _droppedFixedSteps;
+	RenderSnapshot _snapshots[2];
+	int _updateSnapshot; /**< Index of the snapshot being simulated into; the other is drawn. */
+
+	// pipelined handoff
+	std::thread _simulationThread;
+	std::mutex _simulationMutex;
+	std::condition_variable _simulationCondition;
+	bool _simulationPending; /**< A frame has been handed to the simulation thread and it has not finished. */
+	bool _simulationStopping;
+	double _simulationDelta;
 };
 
 }
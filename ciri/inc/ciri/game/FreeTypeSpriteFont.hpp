@@ -2,6 +2,7 @@
 #define __ciri_game_FreeTypeSpriteFont__
 
 #include "ISpriteFont.hpp"
+#include <ciri/core/FileData.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -31,6 +32,7 @@ namespace ciri {
 		std::shared_ptr<IGraphicsDevice> _device;
 		FT_Library _ftLibrary;
 		FT_Face _ftFace;
+		FileData _fontData; /**< FreeType reads the face out of these bytes for as long as it is loaded. */
 		bool _fontLoaded;
 		int _size;
 		int _lineSpacing;
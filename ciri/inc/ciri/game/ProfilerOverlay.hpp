@@ -0,0 +1,64 @@
+#ifndef __ciri_game_ProfilerOverlay__
+#define __ciri_game_ProfilerOverlay__
+
+#include <memory>
+#include <vector>
+#include <cc/Vec2.hpp>
+#include <ciri/core/Profiler.hpp>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+#include "ISpriteFont.hpp"
+#include "SpriteBatch.hpp"
+
+namespace ciri {
+
+/**
+ * Draws the Profiler's tree with a SpriteBatch: one block per thread (and one for the gpu), each scope indented under its parent
+ * with its last, average, minimum and maximum milliseconds, its calls in the last frame, and a bar of its average against the frame budget.
+ */
+class ProfilerOverlay {
+public:
+	static const int STALE_FRAMES = 60; /**< Scopes that have not run for this many frames are hidden. */
+
+public:
+	ProfilerOverlay();
+	~ProfilerOverlay();
+
+	/**
+		* Creates the texture the bars are drawn with.
+		* @param device Device to create the texture with.
+		* @param font   Font to draw text with.
+		* @returns True on success; false otherwise.
+		*/
+	bool create( const std::shared_ptr<IGraphicsDevice>& device, const std::shared_ptr<ISpriteFont>& font );
+
+	/**
+		* Releases the texture and font.
+		*/
+	void clean();
+
+	/**
+		* Sets the time a full width bar stands for.  Defaults to 60hz.
+		*/
+	void setBudget( double ms );
+
+	/**
+		* Draws the overlay.  Must be called between begin and end of the given SpriteBatch.
+		* @param spritebatch Batch to draw with.
+		* @param position    Top left corner in pixels.
+		*/
+	void draw( SpriteBatch& spritebatch, const cc::Vec2f& position );
+
+private:
+	void drawNode( SpriteBatch& spritebatch, int index, float x, float* y );
+
+private:
+	std::shared_ptr<ISpriteFont> _font;
+	std::shared_ptr<ITexture2D> _pixel;
+	double _budgetMs;
+	std::vector<std::vector<int>> _children; /**< Per node, the nodes under it; rebuilt every draw. */
+	std::vector<int> _roots;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef __ciri_game_RenderSnapshot__
+#define __ciri_game_RenderSnapshot__
+
+#include <memory>
+#include <vector>
+#include <cc/Vec2.hpp>
+#include <cc/Vec3.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Mat4.hpp>
+#include <ciri/graphics/ITexture2D.hpp>
+
+namespace ciri {
+
+/**
+ * A sprite as SpriteBatch::draw takes it.
+ */
+struct SnapshotSprite {
+	std::shared_ptr<ITexture2D> texture;
+	cc::Vec2f position;
+	float rotation;
+	cc::Vec2f origin;
+	cc::Vec2f scale;
+	float depth;
+	cc::Vec4f color;
+
+	SnapshotSprite()
+		: texture(nullptr), position(0.0f, 0.0f), rotation(0.0f), origin(0.0f, 0.0f), scale(1.0f, 1.0f), depth(0.0f), color(1.0f, 1.0f, 1.0f, 1.0f) {
+	}
+};
+
+struct SnapshotLight {
+	enum class Type {
+		Directional,
+		Point,
+		Spot
+	};
+
+	Type type;
+	cc::Vec3f position;
+	cc::Vec3f direction;
+	cc::Vec3f color;
+	float intensity;
+	float range;
+	float innerAngle; /**< Of spot lights, in degrees. */
+	float outerAngle; /**< Of spot lights, in degrees. */
+
+	SnapshotLight()
+		: type(Type::Point), position(0.0f, 0.0f, 0.0f), direction(0.0f, -1.0f, 0.0f), color(1.0f, 1.0f, 1.0f), intensity(1.0f), range(10.0f), innerAngle(0.0f), outerAngle(0.0f) {
+	}
+};
+
+/**
+ * Everything a frame draws, written by the simulation and read by drawing.  App keeps two, so that in pipelined mode one can be drawn while
+ * the next frame is simulated into the other.  What each transform belongs to is up to the game; the snapshot only carries them across.
+ */
+struct RenderSnapshot {
+	int frame;                         /**< Index of the frame that was simulated into the snapshot. */
+	double elapsedTime;                /**< Seconds simulated, as passed to onUpdate. */
+	double alpha;                      /**< How far the frame is between the last fixed update and the next, from 0 to 1, for interpolating fixed update state. */
+	cc::Mat4f view;
+	cc::Mat4f projection;
+	cc::Vec3f cameraPosition;
+	std::vector<cc::Mat4f> transforms;
+	std::vector<SnapshotSprite> sprites;
+	std::vector<SnapshotLight> lights;
+
+	RenderSnapshot()
+		: frame(0), elapsedTime(0.0), alpha(0.0), view(1.0f), projection(1.0f), cameraPosition(0.0f, 0.0f, 0.0f) {
+	}
+
+	/**
+	 * Empties the lists but keeps their storage, so that filling them again every frame does not allocate.
+	 */
+	void clear() {
+		transforms.clear();
+		sprites.clear();
+		lights.clear();
+	}
+};
+
+}
+
+#endif
\ No newline at end of file
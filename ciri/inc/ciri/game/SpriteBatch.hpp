@@ -15,8 +15,7 @@
 
 namespace ciri {
 
-_declspec(align(16))
-struct SpriteConstants {
+struct alignas(16) SpriteConstants {
 	cc::Mat4f projection;
 };
 
@@ -34,10 +33,18 @@ public:
 
 	/**
 	 * Create and initialize the SpriteBatch.
-	 * @param device IGraphicsDevice for initialization of GPU resources.
+	 * @param device  IGraphicsDevice for initialization of GPU resources.
+	 * @param compact Upload CompactSpriteVertex instead of SpriteVertex.  Custom shaders must then use the compact input elements.
 	 * @returns True if created; false otherwise.
 	 */
-	bool create( const std::shared_ptr<ciri::IGraphicsDevice>& device );
+	bool create( const std::shared_ptr<ciri::IGraphicsDevice>& device, bool compact=false );
+
+	/**
+	 * Adds the input elements matching the sprite vertex layout to a shader, e.g. for custom sprite shaders.
+	 * @param shader  Shader to add the elements to, before it is loaded.
+	 * @param compact True for CompactSpriteVertex; false for SpriteVertex.
+	 */
+	static void addInputElements( const std::shared_ptr<ciri::IShader>& shader, bool compact );
 
 	/**
 	 * Prepare the SpriteBatch for drawing.  This must be called every frame before drawing anything, and must be accompanied by an end() call.
@@ -106,6 +113,17 @@ public:
 	 * @param depth    Depth for sorting.
 	 */
 	void drawString( const std::shared_ptr<ISpriteFont>& font, const std::string& text, const cc::Vec2f& position, const cc::Vec4f& color, float scale, float rotation, float depth );
+
+	/**
+	 * Reserves space for a block of quads that the caller writes directly, bypassing per-sprite batch items.
+	 * Each quad is two triangles of three vertices: {topLeft, bottomRight, bottomLeft} then {topLeft, topRight, bottomRight}.
+	 * The block is sorted as a single unit using the given depth.
+	 * @param texture   Texture shared by every quad in the block.
+	 * @param quadCount Number of quads to reserve.
+	 * @param depth     Depth used for sorting of the block.
+	 * @returns Pointer to quadCount*6 vertices to be written, valid until the next reserveQuads() or end() call; or null upon error.
+	 */
+	SpriteVertex* reserveQuads( const std::shared_ptr<ciri::ITexture2D>& texture, int quadCount, float depth );
 	
 	/**
 	 * End the SpriteBatch.  This draws everything.  This must be accompanied by a preceding begin() call.
@@ -121,7 +139,8 @@ public:
 private:
 	bool configure();
 	std::shared_ptr<SpriteBatchItem> createBatchItem();
-	void ensureArrayCapacity( int size );
+	void ensureArrayCapacity( int vertexCount );
+	void packCompact();
 	void flush( int start, int end, const std::shared_ptr<ciri::ITexture2D>& texture );
 
 private:
@@ -148,6 +167,14 @@ private:
 	SpriteVertex* _vertexArray;
 	int _vertexArraySize;
 
+	std::vector<SpriteVertex> _rawVertexArray; // vertices written directly through reserveQuads
+	int _rawVertexCount;
+
+	bool _compact;
+	std::vector<CompactSpriteVertex> _compactArray; // packed copy of _vertexArray when compact
+	std::vector<float> _texcoordScratch;
+	std::vector<unsigned short> _halfScratch;
+
 	SpriteSortMode _sortMode;
 };
 
@@ -14,8 +14,18 @@ struct SpriteBatchItem {
 	SpriteVertex bottomRight;
 	std::shared_ptr<ciri::ITexture2D> texture;
 	float depth;
+	int quadCount; /**< 0 for a single sprite using the corners above; otherwise the number of prebuilt quads in the raw vertex array. */
+	int rawOffset; /**< First vertex of the prebuilt quads in the raw vertex array. */
+
+	SpriteBatchItem()
+		: texture(nullptr), depth(0.0f), quadCount(0), rawOffset(0) {
+	}
 
 	void set( float x, float y, float dx, float dy, float w, float h, float sinAngle, float cosAngle, float depth, const cc::Vec4f& color ) {
+		this->depth = depth;
+		quadCount = 0;
+		rawOffset = 0;
+
 		topLeft.position     = cc::Vec3f(x+dx*cosAngle-(dy+h)*sinAngle,     y+dx*sinAngle+(dy+h)*cosAngle,     depth);
 		topRight.position    = cc::Vec3f(x+(dx+w)*cosAngle-(dy+h)*sinAngle, y+(dx+w)*sinAngle+(dy+h)*cosAngle, depth);
 		bottomLeft.position  = cc::Vec3f(x+dx*cosAngle-dy*sinAngle,         y+dx*sinAngle+dy*cosAngle,         depth);
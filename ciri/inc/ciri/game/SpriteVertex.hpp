@@ -25,6 +25,15 @@ struct SpriteVertex {
 	}
 };
 
+/**
+ * 20 byte version of SpriteVertex uploaded by a compact SpriteBatch.  Texcoords are Half2 and color is UNorm8x4; both read as floats in shaders.
+ */
+struct CompactSpriteVertex {
+	cc::Vec3f position;
+	unsigned short texcoord[2];
+	unsigned int color;
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef __ciri_game_SpatialHash2D__
+#define __ciri_game_SpatialHash2D__
+
+#include <vector>
+#include <cc/Vec2.hpp>
+
+namespace ciri {
+
+class SpatialHash2D;
+
+struct SpatialHashPair {
+	int a; /**< User data of the object from the first layer mask. */
+	int b; /**< User data of the object from the second layer mask. */
+};
+
+/**
+ * Iterates objects overlapping a circle or box without allocating.
+ * Usage: for( auto query = hash.queryRadius(...); query.next(); ) { query.userData(); }
+ */
+class SpatialHashQuery {
+	friend class SpatialHash2D;
+
+public:
+	/**
+	 * Advances to the next overlapping object.
+	 * @returns False once all objects have been visited.
+	 */
+	bool next();
+
+	/**
+	 * Gets the handle of the current object.
+	 */
+	int handle() const;
+
+	/**
+	 * Gets the user data of the current object.
+	 */
+	int userData() const;
+
+private:
+	SpatialHashQuery( const SpatialHash2D* hash, const cc::Vec2f& min, const cc::Vec2f& max, const cc::Vec2f& center, float radius, bool isCircle, unsigned int layerMask );
+	bool overlaps( int proxy ) const;
+
+private:
+	const SpatialHash2D* _hash;
+	cc::Vec2f _min;
+	cc::Vec2f _max;
+	cc::Vec2f _center;
+	float _radius;
+	bool _isCircle;
+	unsigned int _layerMask;
+	int _minCellX, _minCellY, _maxCellX, _maxCellY;
+	int _cellX, _cellY;
+	int _current;
+};
+
+/**
+ * Uniform-grid broadphase for circles in 2D.
+ * Objects are bucketed by the cell containing their center, so inserting, moving within a cell and removing are O(1).
+ * Queries widen their search by the largest inserted radius so that objects straddling cell borders are still found.
+ * For best results, the cell size should be around twice the typical object radius.
+ */
+class SpatialHash2D {
+	friend class SpatialHashQuery;
+
+public:
+	SpatialHash2D();
+	~SpatialHash2D();
+
+	/**
+	 * Configures the grid.  Any existing objects are discarded.
+	 * @param cellSize    Width and height of a cell in world units.
+	 * @param bucketCount Number of hash buckets; rounded up to a power of two.
+	 * @returns True if created; false otherwise.
+	 */
+	bool create( float cellSize, int bucketCount );
+
+	/**
+	 * Removes all objects.
+	 */
+	void clear();
+
+	/**
+	 * Inserts a new object.
+	 * @param position  Center of the object.
+	 * @param radius    Collision radius of the object.
+	 * @param userData  Arbitrary value returned by queries (e.g. an index into an entity array).
+	 * @param layerMask Bitfield of layers the object belongs to.
+	 * @returns Handle used to move or remove the object.
+	 */
+	int insert( const cc::Vec2f& position, float radius, int userData, unsigned int layerMask );
+
+	/**
+	 * Moves an existing object.
+	 * @param handle   Handle returned by insert.
+	 * @param position New center of the object.
+	 */
+	void move( int handle, const cc::Vec2f& position );
+
+	/**
+	 * Removes an existing object.  The handle may be reused by later inserts.
+	 * @param handle Handle returned by insert.
+	 */
+	void remove( int handle );
+
+	/**
+	 * Finds all objects overlapping a circle.
+	 * @param center    Center of the circle.
+	 * @param radius    Radius of the circle.
+	 * @param layerMask Only objects sharing at least one layer are returned.
+	 */
+	SpatialHashQuery queryRadius( const cc::Vec2f& center, float radius, unsigned int layerMask ) const;
+
+	/**
+	 * Finds all objects overlapping an axis-aligned box.
+	 * @param min       Minimum corner of the box.
+	 * @param max       Maximum corner of the box.
+	 * @param layerMask Only objects sharing at least one layer are returned.
+	 */
+	SpatialHashQuery queryAABB( const cc::Vec2f& min, const cc::Vec2f& max, unsigned int layerMask ) const;
+
+	/**
+	 * Finds every overlapping pair between objects of two layer masks.
+	 * If an object belongs to both masks, it is never paired with itself and each pair is reported once.
+	 * @param layerMaskA First layer mask; reported in SpatialHashPair::a.
+	 * @param layerMaskB Second layer mask; reported in SpatialHashPair::b.
+	 * @param pairs      Output pairs.  The vector is cleared first and its capacity reused.
+	 * @returns Number of pairs found.
+	 */
+	int findPairs( unsigned int layerMaskA, unsigned int layerMaskB, std::vector<SpatialHashPair>& pairs ) const;
+
+	int getCount() const;
+	float getCellSize() const;
+
+private:
+	struct Proxy {
+		cc::Vec2f position;
+		float radius;
+		int userData;
+		unsigned int layerMask; /**< 0 marks a free proxy. */
+		int cellX;
+		int cellY;
+		int bucket;
+		int prev; /**< Previous proxy in the same bucket, or -1. */
+		int next; /**< Next proxy in the same bucket, or next free proxy when unused. */
+	};
+
+	int cellCoord( float value ) const;
+	int bucketIndex( int cellX, int cellY ) const;
+	void link( int proxy );
+	void unlink( int proxy );
+
+private:
+	float _cellSize;
+	float _invCellSize;
+	std::vector<int> _buckets; // head proxy of each bucket, or -1
+	std::vector<Proxy> _proxies;
+	int _freeList;
+	int _count;
+	float _maxRadius; // largest radius ever inserted; widens queries
+};
+
+}
+
+#endif
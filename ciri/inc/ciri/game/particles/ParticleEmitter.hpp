@@ -0,0 +1,129 @@
+#ifndef __ciri_game_ParticleEmitter__
+#define __ciri_game_ParticleEmitter__
+
+#include <vector>
+#include <cc/Vec2.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Random.hpp>
+#include "ParticlePool.hpp"
+
+namespace ciri {
+
+enum class ParticleSpawnShape {
+	Point,  /**< All particles spawn at the emitter position. */
+	Circle, /**< Particles spawn uniformly within a circle of radius extents.x. */
+	Rect    /**< Particles spawn uniformly within a rectangle of half-size extents. */
+};
+
+struct ParticleSpawnModule {
+	ParticleSpawnShape shape;
+	cc::Vec2f extents;
+
+	ParticleSpawnModule()
+		: shape(ParticleSpawnShape::Point), extents(0.0f, 0.0f) {
+	}
+};
+
+struct ParticleLifetimeModule {
+	float minLifetime; /**< Minimum lifetime in seconds. */
+	float maxLifetime; /**< Maximum lifetime in seconds. */
+
+	ParticleLifetimeModule()
+		: minLifetime(1.0f), maxLifetime(1.0f) {
+	}
+};
+
+struct ParticleVelocityModule {
+	cc::Vec2f direction; /**< Base direction of emission.  Need not be normalized; a zero vector means random. */
+	float spread;        /**< Random angular offset in radians applied in both directions around the base direction. */
+	float minSpeed;      /**< Minimum speed in units per second. */
+	float maxSpeed;      /**< Maximum speed in units per second. */
+	bool alignToVelocity; /**< If true, particles are oriented along their velocity. */
+
+	ParticleVelocityModule()
+		: direction(0.0f, 0.0f), spread(0.0f), minSpeed(0.0f), maxSpeed(0.0f), alignToVelocity(true) {
+	}
+};
+
+struct ParticleSizeModule {
+	float minSize; /**< Minimum uniform scale. */
+	float maxSize; /**< Maximum uniform scale. */
+
+	ParticleSizeModule()
+		: minSize(1.0f), maxSize(1.0f) {
+	}
+};
+
+/**
+ * Piecewise-linear color over normalized particle age [0, 1].
+ * Keys are baked into a fixed-size lookup table so evaluation is a single indexed load.
+ */
+class ParticleColorCurve {
+public:
+	static const int LUT_SIZE = 256;
+
+public:
+	ParticleColorCurve();
+
+	/**
+	 * Adds a key to the curve.  Keys may be added in any order.
+	 * @param time  Normalized age in [0, 1].
+	 * @param color Color at the given time.
+	 */
+	void addKey( float time, const cc::Vec4f& color );
+
+	/**
+	 * Removes all keys.  An empty curve evaluates to opaque white.
+	 */
+	void clearKeys();
+
+	/**
+	 * Gets the baked color for a normalized age.
+	 * @param t Normalized age in [0, 1].
+	 */
+	const cc::Vec4f& evaluate( float t ) const;
+
+private:
+	void bake();
+
+private:
+	struct Key {
+		float time;
+		cc::Vec4f color;
+	};
+	std::vector<Key> _keys;
+	cc::Vec4f _lut[LUT_SIZE];
+};
+
+/**
+ * Configuration of how new particles are initialized.
+ * Modules are plain data so that emitters can be copied and tweaked freely.
+ */
+class ParticleEmitter {
+public:
+	ParticleEmitter();
+	~ParticleEmitter();
+
+	/**
+	 * Spawns up to count particles into the pool.
+	 * @param pool  Pool to spawn into.
+	 * @param count Number of particles to spawn.
+	 * @returns Number of particles actually spawned, which is less than count if the pool fills up.
+	 */
+	int emit( ParticlePool& pool, int count );
+
+public:
+	cc::Vec2f position;
+	ParticleSpawnModule spawn;
+	ParticleLifetimeModule lifetime;
+	ParticleVelocityModule velocity;
+	ParticleSizeModule size;
+	ParticleColorCurve colorOverLife;
+
+private:
+	cc::math::Random<float, int> _random;
+};
+
+}
+
+#endif
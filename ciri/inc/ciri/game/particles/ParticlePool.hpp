@@ -0,0 +1,70 @@
+#ifndef __ciri_game_ParticlePool__
+#define __ciri_game_ParticlePool__
+
+namespace ciri {
+
+/**
+ * Fixed-capacity structure-of-arrays storage for particles.
+ * Live particles are always packed into [0, count) so that updates and drawing never touch dead slots.
+ * Spawning appends to the end and killing swaps the last live particle into the freed slot, both in O(1).
+ */
+class ParticlePool {
+public:
+	ParticlePool();
+	~ParticlePool();
+
+	/**
+	 * Allocates storage for a fixed number of particles.  Any existing particles are discarded.
+	 * @param capacity Maximum number of live particles.
+	 * @returns True if allocated; false otherwise.
+	 */
+	bool create( int capacity );
+
+	/**
+	 * Frees all allocated storage.
+	 */
+	void destroy();
+
+	/**
+	 * Claims the next free slot.
+	 * @returns Index of the new particle, or -1 if the pool is full.
+	 */
+	int spawn();
+
+	/**
+	 * Kills a live particle by moving the last live particle into its slot.
+	 * Note that this invalidates the index of the previously last particle.
+	 * @param index Index of the live particle to kill.
+	 */
+	void kill( int index );
+
+	/**
+	 * Kills all particles.
+	 */
+	void clear();
+
+	int getCount() const;
+	int getCapacity() const;
+	bool isFull() const;
+
+public:
+	// all arrays are 16-byte aligned and padded to a multiple of 4 elements for SIMD access
+	float* posX;
+	float* posY;
+	float* velX;
+	float* velY;
+	float* age;         /**< Time since spawn in seconds. */
+	float* invLifetime; /**< Reciprocal of the total lifetime; age*invLifetime is the normalized age. */
+	float* rotSin;      /**< Sine of the orientation. */
+	float* rotCos;      /**< Cosine of the orientation. */
+	float* size;        /**< Uniform scale. */
+
+private:
+	float* _block;
+	int _count;
+	int _capacity;
+};
+
+}
+
+#endif
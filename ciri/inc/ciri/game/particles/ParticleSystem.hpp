@@ -0,0 +1,97 @@
+#ifndef __ciri_game_ParticleSystem__
+#define __ciri_game_ParticleSystem__
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <ciri/Graphics.hpp>
+#include "ParticlePool.hpp"
+#include "ParticleEmitter.hpp"
+#include "../SpriteVertex.hpp"
+
+namespace ciri {
+
+class JobSystem;
+class SpriteBatch;
+
+class ParticleSystem {
+public:
+	ParticleSystem();
+	~ParticleSystem();
+
+	/**
+	 * Allocates the particle pool.
+	 * @param capacity Maximum number of live particles.
+	 * @returns True if created; false otherwise.
+	 */
+	bool create( int capacity );
+
+	/**
+	 * Frees the particle pool and releases the texture.
+	 */
+	void clean();
+
+	/**
+	 * Spawns new particles using the emitter's configuration.
+	 * @param count Number of particles to spawn.
+	 * @returns Number of particles actually spawned.
+	 */
+	int emitParticles( int count );
+
+	/**
+	 * Integrates all live particles and kills expired ones.
+	 * Large pools are split into chunks and updated across the job system's threads.
+	 * @param deltaTime Time step in seconds.
+	 */
+	void update( float deltaTime );
+
+	/**
+	 * Writes all live particles into the SpriteBatch as a single block.  Must be called between begin() and end().
+	 * @param spritebatch SpriteBatch to draw into.
+	 * @param depth       Depth of the block for sorting.
+	 */
+	void draw( SpriteBatch& spritebatch, float depth );
+
+	/**
+	 * Kills all live particles.
+	 */
+	void clear();
+
+	void setTexture( const std::shared_ptr<ITexture2D>& texture );
+	const std::shared_ptr<ITexture2D>& getTexture() const;
+
+	/**
+	 * Sets the minimum number of particles processed per chunk.  Pools smaller than this are updated on the calling thread.
+	 * @param grainSize Particles per chunk; clamped to at least 64.
+	 */
+	void setGrainSize( int grainSize );
+
+	/**
+	 * Sets the job system that update and draw spread their chunks over.  Without one, every chunk runs on the calling thread.
+	 */
+	void setJobSystem( const std::shared_ptr<JobSystem>& jobs );
+
+	int getCount() const;
+	int getCapacity() const;
+	ParticleEmitter& getEmitter();
+	const ParticlePool& getPool() const;
+
+private:
+	int computeChunkCount( int count ) const;
+	void forEachChunk( int chunkCount, const std::function<void( int chunk )>& chunkFunction );
+	void updateRange( int start, int end, float deltaTime, int* deadOut, int& deadCount );
+	void writeRange( int start, int end, SpriteVertex* vertices, float depth ) const;
+
+private:
+	ParticlePool _pool;
+	ParticleEmitter _emitter;
+	std::shared_ptr<ITexture2D> _texture;
+	int _grainSize;
+	std::shared_ptr<JobSystem> _jobs;
+	int* _deadIndices; // particles that died during update, written per chunk at the chunk's start offset
+	std::vector<int> _deadCounts; // number of dead indices per chunk
+};
+
+}
+
+#endif
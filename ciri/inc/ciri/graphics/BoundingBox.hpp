@@ -0,0 +1,37 @@
+#ifndef __ciri_graphics_BoundingBox__
+#define __ciri_graphics_BoundingBox__
+
+#include <vector>
+#include <cc/Vec3.hpp>
+#include <cc/Mat4.hpp>
+
+namespace ciri {
+
+class BoundingBox {
+public:
+	BoundingBox();
+	BoundingBox( const cc::Vec3f& min, const cc::Vec3f& max );
+
+	/**
+	 * Creates the smallest box containing all points.
+	 * @param points Points to enclose.  If empty, a zero size box at the origin is returned.
+	 */
+	static BoundingBox createFromPoints( const std::vector<cc::Vec3f>& points );
+
+	cc::Vec3f center() const;
+	cc::Vec3f extents() const; /**< Half of the size along each axis. */
+
+	/**
+	 * Creates the axis-aligned box enclosing this box after being transformed.
+	 * @param matrix Transform, e.g. a world matrix.
+	 */
+	BoundingBox transformed( const cc::Mat4f& matrix ) const;
+
+public:
+	cc::Vec3f Min;
+	cc::Vec3f Max;
+};
+
+}
+
+#endif
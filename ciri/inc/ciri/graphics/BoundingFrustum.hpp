@@ -0,0 +1,60 @@
+#ifndef __ciri_graphics_BoundingFrustum__
+#define __ciri_graphics_BoundingFrustum__
+
+#include <array>
+#include <cc/Mat4.hpp>
+#include <cc/Vec3.hpp>
+#include <ciri/graphics/Plane.hpp>
+
+namespace ciri {
+
+/**
+ * Six inward-facing planes and eight corners of a view volume.
+ * Plane order is left, right, bottom, top, near, far.
+ */
+class BoundingFrustum {
+public:
+	enum PlaneIndex {
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		PlaneCount
+	};
+
+public:
+	BoundingFrustum();
+	/**
+	 * Extracts the frustum from a combined matrix.
+	 * @param viewProj Matrix transforming world points to clip space (clip = viewProj * point).
+	 */
+	BoundingFrustum( const cc::Mat4f& viewProj );
+	/**
+	 * Builds the frustum from perspective camera parameters.
+	 * @param angle Vertical field of view in degrees.
+	 * @param ratio Aspect ratio (width / height).
+	 * @param nearD Near plane distance.
+	 * @param farD  Far plane distance.
+	 * @param p     Eye position.
+	 * @param l     Point being looked at.
+	 * @param u     Up vector.
+	 */
+	BoundingFrustum( float angle, float ratio, float nearD, float farD, const cc::Vec3f& p, const cc::Vec3f& l, const cc::Vec3f& u );
+
+	const std::array<cc::Vec3f, 8>& corners() const;
+	const std::array<Plane, 6>& planes() const;
+
+private:
+	void createCorners();
+	static cc::Vec3f intersectionPoint( const Plane& p1, const Plane& p2, const Plane& p3 );
+
+private:
+	std::array<cc::Vec3f, 8> _corners;
+	std::array<Plane, 6> _planes;
+};
+
+}
+
+#endif
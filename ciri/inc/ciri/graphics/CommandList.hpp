@@ -0,0 +1,98 @@
+#ifndef __ciri_graphics_CommandList__
+#define __ciri_graphics_CommandList__
+
+#include <vector>
+#include "ICommandList.hpp"
+
+namespace ciri {
+
+class IGraphicsDevice;
+
+/**
+ * Command list shared by every backend.
+ * Commands are fixed-size records; constant payloads and render target arrays live in a per-list linear arena,
+ * and referenced objects in a per-list table.  reset() rewinds all three without freeing, so a list recorded every frame stops allocating.
+ */
+class CommandList : public ICommandList {
+public:
+	CommandList();
+	virtual ~CommandList();
+
+	virtual void reset() override;
+	virtual int getCommandCount() const override;
+
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state ) override;
+	virtual void applyShader( const std::shared_ptr<IShader>& shader ) override;
+	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) override;
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) override;
+	virtual void setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) override;
+	virtual void setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) override;
+	virtual void setBlendState( const std::shared_ptr<IBlendState>& state ) override;
+	virtual void setRasterizerState( const std::shared_ptr<IRasterizerState>& state ) override;
+	virtual void setDepthStencilState( const std::shared_ptr<IDepthStencilState>& state ) override;
+	virtual void setConstants( const std::shared_ptr<IConstantBuffer>& buffer, int dataSize, const void* data ) override;
+	virtual void drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) override;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) override;
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) override;
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) override;
+	virtual void setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) override;
+	virtual void restoreDefaultRenderTargets() override;
+	virtual void setViewport( const Viewport& vp ) override;
+	virtual void setClearColor( float r, float g, float b, float a ) override;
+	virtual void clear( int flags ) override;
+
+	/**
+		* Issues every recorded command to a device, in recording order.  Must be called on the device's thread.
+		* @param device Device to issue commands to.
+		*/
+	void execute( IGraphicsDevice* device ) const;
+
+private:
+	enum class Type {
+		ApplyPipelineState,
+		ApplyShader,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetTexture2D,
+		SetTexture3D,
+		SetTextureCube,
+		SetSamplerState,
+		SetBlendState,
+		SetRasterizerState,
+		SetDepthStencilState,
+		SetConstants,
+		DrawArrays,
+		DrawIndexed,
+		SetRenderTargets,
+		RestoreRenderTargets,
+		SetViewport,
+		SetClearColor,
+		Clear,
+		SetVertexBuffers,
+		DrawInstanced,
+		DrawIndexedInstanced
+	};
+
+	struct Command {
+		Type type;
+		int object;   /**< Index into the object table, or -1 for none. */
+		int args[4];  /**< Command specific; payload commands store the arena offset and size in the first two. */
+	};
+
+	void record( Type type, int object, int a0=0, int a1=0, int a2=0, int a3=0 );
+	int addObject( const std::shared_ptr<void>& object );
+	int allocate( int bytes );
+
+private:
+	std::vector<Command> _commands;
+	std::vector<std::shared_ptr<void>> _objects;
+	std::vector<unsigned char> _arena;
+	int _arenaUsed;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef __ciri_graphics_FrustumCuller__
+#define __ciri_graphics_FrustumCuller__
+
+#include <vector>
+#include <cc/Vec3.hpp>
+#include <ciri/graphics/BoundingBox.hpp>
+#include <ciri/graphics/BoundingFrustum.hpp>
+
+namespace ciri {
+
+/**
+ * Axis-aligned boxes stored as separate center and extent streams for batch culling.
+ * Streams are padded to a multiple of four so the culler can always read whole groups.
+ */
+class BoundingBoxArray {
+	friend class FrustumCuller;
+
+public:
+	BoundingBoxArray();
+
+	void reserve( int count );
+	void clear();
+
+	/**
+	 * Appends a box.
+	 * @returns Index of the new box; this is the index reported by the culler.
+	 */
+	int add( const BoundingBox& box );
+	void set( int index, const BoundingBox& box );
+	int size() const;
+
+private:
+	void resizeStreams( int count );
+
+private:
+	int _count;
+	std::vector<float> _centerX;
+	std::vector<float> _centerY;
+	std::vector<float> _centerZ;
+	std::vector<float> _extentX;
+	std::vector<float> _extentY;
+	std::vector<float> _extentZ;
+};
+
+/**
+ * Spheres stored as separate center and radius streams for batch culling.
+ */
+class BoundingSphereArray {
+	friend class FrustumCuller;
+
+public:
+	BoundingSphereArray();
+
+	void reserve( int count );
+	void clear();
+
+	/**
+	 * Appends a sphere.
+	 * @returns Index of the new sphere; this is the index reported by the culler.
+	 */
+	int add( const cc::Vec3f& center, float radius );
+	void set( int index, const cc::Vec3f& center, float radius );
+	int size() const;
+
+private:
+	void resizeStreams( int count );
+
+private:
+	int _count;
+	std::vector<float> _centerX;
+	std::vector<float> _centerY;
+	std::vector<float> _centerZ;
+	std::vector<float> _radius;
+};
+
+/**
+ * Tests batches of boxes or spheres against a frustum four at a time using SSE.
+ * Each group of four remembers the plane that last rejected it and tests that plane first on the next call,
+ * so objects that stay off to one side are usually rejected after a single plane test.
+ * Groups stop testing planes as soon as every lane has been rejected.
+ * Results are conservative: objects straddling a frustum corner may be reported visible.
+ */
+class FrustumCuller {
+public:
+	FrustumCuller();
+
+	/**
+	 * Sets the frustum to test against.
+	 */
+	void setFrustum( const BoundingFrustum& frustum );
+
+	/**
+	 * Finds the boxes intersecting or inside the frustum.
+	 * @param boxes   Boxes to test.
+	 * @param visible Replaced with the ascending indices of visible boxes.
+	 * @returns Number of visible boxes.
+	 */
+	int cull( const BoundingBoxArray& boxes, std::vector<int>& visible );
+
+	/**
+	 * Finds the spheres intersecting or inside the frustum.
+	 * @param spheres Spheres to test.
+	 * @param visible Replaced with the ascending indices of visible spheres.
+	 * @returns Number of visible spheres.
+	 */
+	int cull( const BoundingSphereArray& spheres, std::vector<int>& visible );
+
+private:
+	float _normalX[BoundingFrustum::PlaneCount];
+	float _normalY[BoundingFrustum::PlaneCount];
+	float _normalZ[BoundingFrustum::PlaneCount];
+	float _d[BoundingFrustum::PlaneCount];
+	std::vector<unsigned char> _boxPlaneHints; /**< Last rejecting plane per group of four boxes. */
+	std::vector<unsigned char> _spherePlaneHints; /**< Last rejecting plane per group of four spheres. */
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __ciri_graphics_GpuProfileScope__
+#define __ciri_graphics_GpuProfileScope__
+
+#include <ciri/core/Profiler.hpp>
+#include "IGraphicsDevice.hpp"
+
+namespace ciri {
+
+/**
+ * Times the gpu work issued within the enclosing block while the profiler is enabled.
+ */
+class GpuProfileScope {
+public:
+	GpuProfileScope( IGraphicsDevice* device, const char* name )
+		: _device(Profiler::isEnabled() ? device : nullptr) {
+		if( _device != nullptr ) {
+			_device->beginGpuScope(name);
+		}
+	}
+
+	~GpuProfileScope() {
+		if( _device != nullptr ) {
+			_device->endGpuScope();
+		}
+	}
+
+private:
+	GpuProfileScope( const GpuProfileScope& );
+	GpuProfileScope& operator=( const GpuProfileScope& );
+
+private:
+	IGraphicsDevice* _device;
+};
+
+}
+
+#ifdef CIRI_PROFILER_DISABLED
+	#define CIRI_PROFILE_GPU(device, name)
+#else
+	/**
+	 * Times the gpu work issued in the rest of the enclosing block.  The name must be a string literal or otherwise outlive the profiler.
+	 */
+	#define CIRI_PROFILE_GPU(device, name) ::ciri::GpuProfileScope CIRI_PROFILE_CONCAT(ciriGpuProfileScope, __LINE__)(device, name)
+#endif
+
+#endif
\ No newline at end of file
@@ -5,7 +5,8 @@ namespace ciri {
 
 enum class GraphicsApiType {
 	OpenGL,
-	DirectX11
+	DirectX11,
+	Null
 };
 
 }
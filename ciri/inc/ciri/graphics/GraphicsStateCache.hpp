@@ -0,0 +1,152 @@
+#ifndef __ciri_graphics_GraphicsStateCache__
+#define __ciri_graphics_GraphicsStateCache__
+
+#include <memory>
+#include <cstdint>
+
+namespace ciri {
+
+/**
+ * Shadow copy of what a graphics device last bound, used to drop redundant API calls.
+ * Each bind is identified by the owning object and its API handle; a bind is redundant only if both match what is bound,
+ * so objects that were freed or recreated in place (e.g. resized textures) are never mistaken for the bound one.
+ * Devices must invalidate whatever the API may have changed behind the cache's back.
+ */
+class GraphicsStateCache {
+public:
+	static const int MAX_TABLES = 3;  /**< Independent texture/sampler tables; D3D uses one per stage, GL one per texture target. */
+	static const int MAX_SLOTS = 16;  /**< Slots per table that are tracked; binds to higher slots always go through. */
+
+public:
+	GraphicsStateCache();
+	~GraphicsStateCache();
+
+	/**
+		* Forgets everything so the next bind of every kind goes through.
+		*/
+	void invalidate();
+
+	/**
+		* Forgets the bound vertex buffer.  Needed when the input layout depends on the active shader.
+		*/
+	void invalidateVertexBuffer();
+
+	/**
+		* Forgets all bound textures.
+		*/
+	void invalidateTextures();
+
+	/**
+		* Each bind function records the bind and returns true if the API call must be made,
+		* or counts it as redundant and returns false if exactly the same thing is already bound.
+		*/
+	template<typename T> bool bindShader( const std::shared_ptr<T>& shader, uintptr_t handle ) { return bind(_shader, shader, handle); }
+	template<typename T> bool bindVertexBuffer( const std::shared_ptr<T>& buffer, uintptr_t handle ) { return bind(_vertexBuffer, buffer, handle); }
+	template<typename T> bool bindIndexBuffer( const std::shared_ptr<T>& buffer, uintptr_t handle ) { return bind(_indexBuffer, buffer, handle); }
+	template<typename T> bool bindBlendState( const std::shared_ptr<T>& state, uintptr_t handle ) { return bind(_blendState, state, handle); }
+	template<typename T> bool bindRasterizerState( const std::shared_ptr<T>& state, uintptr_t handle ) { return bind(_rasterizerState, state, handle); }
+	template<typename T> bool bindDepthStencilState( const std::shared_ptr<T>& state, uintptr_t handle ) { return bind(_depthStencilState, state, handle); }
+	template<typename T> bool bindTexture( int table, int slot, const std::shared_ptr<T>& texture, uintptr_t handle );
+	template<typename T> bool bindSampler( int table, int slot, const std::shared_ptr<T>& sampler, uintptr_t handle );
+
+	/**
+		* Counts vertex attributes the device had to specify, e.g. when GL builds a vertex array.
+		*/
+	void countVertexAttributeSetups( int count );
+
+	/**
+		* Counts a vertex input (vertex array or input layout and buffers) the device actually bound.
+		*/
+	void countVertexInputBind();
+
+	/**
+		* Ends the current frame, making its counts available and resetting them for the next one.
+		*/
+	void endFrame();
+
+	/**
+		* Gets the number of binds dropped as redundant during the last ended frame.
+		*/
+	int getRedundantCallCount() const;
+
+	/**
+		* Gets the number of binds that changed state during the last ended frame.
+		*/
+	int getStateChangeCount() const;
+
+	/**
+		* Gets the number of vertex attributes specified during the last ended frame.
+		*/
+	int getVertexAttributeSetupCount() const;
+
+	/**
+		* Gets the number of vertex inputs bound during the last ended frame.
+		*/
+	int getVertexInputBindCount() const;
+
+private:
+	struct Binding {
+		std::weak_ptr<void> object;
+		uintptr_t handle;
+		bool isKnown;
+
+		Binding();
+		void reset();
+	};
+
+	template<typename T> bool bind( Binding& binding, const std::shared_ptr<T>& object, uintptr_t handle );
+
+private:
+	Binding _shader;
+	Binding _vertexBuffer;
+	Binding _indexBuffer;
+	Binding _blendState;
+	Binding _rasterizerState;
+	Binding _depthStencilState;
+	Binding _textures[MAX_TABLES][MAX_SLOTS];
+	Binding _samplers[MAX_TABLES][MAX_SLOTS];
+	//
+	int _redundantCalls;
+	int _stateChanges;
+	int _lastRedundantCalls;
+	int _lastStateChanges;
+	int _vertexAttributeSetups;
+	int _vertexInputBinds;
+	int _lastVertexAttributeSetups;
+	int _lastVertexInputBinds;
+};
+
+template<typename T>
+bool GraphicsStateCache::bindTexture( int table, int slot, const std::shared_ptr<T>& texture, uintptr_t handle ) {
+	if( table < 0 || table >= MAX_TABLES || slot < 0 || slot >= MAX_SLOTS ) {
+		return true;
+	}
+	return bind(_textures[table][slot], texture, handle);
+}
+
+template<typename T>
+bool GraphicsStateCache::bindSampler( int table, int slot, const std::shared_ptr<T>& sampler, uintptr_t handle ) {
+	if( table < 0 || table >= MAX_TABLES || slot < 0 || slot >= MAX_SLOTS ) {
+		return true;
+	}
+	return bind(_samplers[table][slot], sampler, handle);
+}
+
+template<typename T>
+bool GraphicsStateCache::bind( Binding& binding, const std::shared_ptr<T>& object, uintptr_t handle ) {
+	// owner comparison keeps working after the bound object has expired, unlike comparing raw pointers
+	const bool isSameObject = !binding.object.owner_before(object) && !object.owner_before(binding.object);
+	if( binding.isKnown && isSameObject && binding.handle == handle ) {
+		_redundantCalls += 1;
+		return false;
+	}
+	binding.object = object;
+	binding.handle = handle;
+	binding.isKnown = true;
+	_stateChanges += 1;
+	return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __ciri_graphics_ICommandList__
+#define __ciri_graphics_ICommandList__
+
+#include <memory>
+#include "Viewport.hpp"
+#include "IShader.hpp"
+#include "IVertexBuffer.hpp"
+#include "IIndexBuffer.hpp"
+#include "IConstantBuffer.hpp"
+#include "ITexture2D.hpp"
+#include "ITexture3D.hpp"
+#include "ITextureCube.hpp"
+#include "ISamplerState.hpp"
+#include "IRenderTarget2D.hpp"
+#include "IRasterizerState.hpp"
+#include "IDepthStencilState.hpp"
+#include "IBlendState.hpp"
+#include "IPipelineState.hpp"
+#include "ShaderStage.hpp"
+#include "PrimitiveTopology.hpp"
+
+namespace ciri {
+
+/**
+ * A list of graphics commands recorded now and executed on the device later.
+ * Recording touches only the list itself, so separate lists may be recorded on separate threads at the same time.
+ * Lists are executed on the device's thread with IGraphicsDevice::executeCommandLists, in the order given.
+ * Everything a list references is kept alive until the list is reset, except render targets, which the caller must keep alive.
+ */
+class ICommandList {
+protected:
+	ICommandList() {
+	}
+
+public:
+	virtual ~ICommandList() {
+	}
+
+	/**
+		* Removes all recorded commands and releases referenced objects.  Allocated memory is kept for the next recording.
+		*/
+	virtual void reset()=0;
+
+	/**
+		* Gets the number of recorded commands.
+		*/
+	virtual int getCommandCount() const=0;
+
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state )=0;
+	virtual void applyShader( const std::shared_ptr<IShader>& shader )=0;
+	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer )=0;
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers )=0;
+	virtual void setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer )=0;
+	virtual void setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage )=0;
+	virtual void setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage )=0;
+	virtual void setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage )=0;
+	virtual void setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage )=0;
+	virtual void setBlendState( const std::shared_ptr<IBlendState>& state )=0;
+	virtual void setRasterizerState( const std::shared_ptr<IRasterizerState>& state )=0;
+	virtual void setDepthStencilState( const std::shared_ptr<IDepthStencilState>& state )=0;
+
+	/**
+		* Records a constant buffer update.  The data is copied into the list, so the source may be reused immediately.
+		* @param buffer   Constant buffer to update when the list is executed.
+		* @param dataSize Size of the data in bytes.
+		* @param data     Data to copy.
+		*/
+	virtual void setConstants( const std::shared_ptr<IConstantBuffer>& buffer, int dataSize, const void* data )=0;
+
+	virtual void drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex )=0;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex=0, int baseVertex=0 )=0;
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex )=0;
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount )=0;
+
+	virtual void setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets )=0;
+	virtual void restoreDefaultRenderTargets()=0;
+	virtual void setViewport( const Viewport& vp )=0;
+	virtual void setClearColor( float r, float g, float b, float a )=0;
+	virtual void clear( int flags )=0;
+};
+
+}
+
+#endif
\ No newline at end of file
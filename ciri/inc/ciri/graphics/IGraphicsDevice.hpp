@@ -16,6 +16,8 @@
 #include "IRasterizerState.hpp"
 #include "IDepthStencilState.hpp"
 #include "IBlendState.hpp"
+#include "IPipelineState.hpp"
+#include "ICommandList.hpp"
 #include "ShaderStage.hpp"
 #include "PrimitiveTopology.hpp"
 #include "GraphicsApiType.hpp"
@@ -87,6 +89,22 @@ public:
 		*/
 	virtual std::shared_ptr<IConstantBuffer> createConstantBuffer()=0;
 
+	/**
+		* Sets the size of the per-frame constant ring.  Updates to constant buffers are suballocated from the ring and bound by offset rather than
+		* updating each buffer in place.  Updates that do not fit in the current frame's part of the ring fall back to the buffer's own storage.
+		* Backends that lack the required support (persistent mapping on GL; D3D11.1 constant buffer offsets on DX) ignore this and always use the fallback.
+		* @param bytesPerFrame Bytes of constants that can be written per frame, or 0 to disable the ring.
+		*/
+	virtual void setConstantRingSize( int bytesPerFrame )=0;
+
+	/**
+		* Sets the directory compiled shaders are kept in between runs.  Shaders loaded afterwards reuse a matching binary instead of compiling.
+		* Entries are keyed on the shader sources and the driver, so edited shaders and driver updates simply miss.  The null device has nothing to cache and ignores this.
+		* @param directory Directory to use, created if it does not exist, or nullptr to disable the cache.
+		* @returns True if the cache is in use; false if disabled or the directory could not be created.
+		*/
+	virtual bool setShaderCacheDirectory( const char* directory )=0;
+
 	/**
 		* Creates a new 2d texture optionally initialized with data.
 		* @param width  Width of the texture in pixels.
@@ -136,8 +154,8 @@ public:
 		* Creates a new 2d render target.
 		* @param width       Width of the render target in pixels.
 		* @param height      Height of the render target in pixels.
-		* @param format      Format of the render target.
-		* @param depthFormat Format of the optional depth-stencil buffer.
+		* @param format      Format of the render target, or TextureFormat::None for a depth-only target (gl and null only).
+		* @param depthFormat Format of the optional depth-stencil buffer.  Required for depth-only targets.
 		* @returns A pointer to a new IRenderTarget2D, or nullptr upon error.
 		*/
 	virtual std::shared_ptr<IRenderTarget2D> createRenderTarget2D( int width, int height, TextureFormat::Format format, DepthStencilFormat depthFormat )=0;
@@ -163,6 +181,45 @@ public:
 		*/
 	virtual std::shared_ptr<IBlendState> createBlendState( const BlendDesc& desc )=0;
 
+	/**
+		* Creates a pipeline state.  Pipelines with equal descriptions are shared, so this is cheap to call with a description that already exists.
+		* @param desc Descriptor used to configure the pipeline.
+		* @returns A pointer to an IPipelineState, or nullptr if the shader is missing or invalid or a state could not be created.
+		*/
+	virtual std::shared_ptr<IPipelineState> createPipelineState( const PipelineDesc& desc )=0;
+
+	/**
+		* Makes the given pipeline's shader, blend, rasterizer, and depth-stencil state active.
+		* Only the parts that differ from what is currently bound reach the API.
+		* @param state Pipeline state to apply.
+		*/
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state )=0;
+
+	/**
+		* Creates a command list that can be recorded on any thread.
+		* @returns A pointer to a new ICommandList, or nullptr upon error.
+		*/
+	virtual std::shared_ptr<ICommandList> createCommandList()=0;
+
+	/**
+		* Executes command lists in the given order.  Must be called on the thread that owns the device, after recording into the lists has finished.
+		* @param lists Array of pointers to ICommandList.
+		* @param count Number of lists in the array.
+		*/
+	virtual void executeCommandLists( ICommandList** lists, int count )=0;
+
+	/**
+		* Opens a gpu scope timed with timestamp queries.  Results are resolved a few frames later without stalling and reported to the Profiler.
+		* Does nothing while the profiler is disabled.  Use GpuProfileScope or CIRI_PROFILE_GPU rather than calling this directly.
+		* @param name Name of the scope; must be a string literal or otherwise outlive the profiler.
+		*/
+	virtual void beginGpuScope( const char* name )=0;
+
+	/**
+		* Closes the most recently opened gpu scope.
+		*/
+	virtual void endGpuScope()=0;
+
 	/**
 		* Makes the given shader active.
 		* @param shader Shader to make active.
@@ -175,6 +232,15 @@ public:
 		*/
 	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer )=0;
 
+	/**
+		* Makes the given vertex buffers active, one per vertex stream starting at slot 0.
+		* Slot 0 behaves as setVertexBuffer; the remaining slots feed elements declared with a matching slot, e.g. per-instance data.
+		* Slots past numBuffers are unbound.
+		* @param buffers    Array of vertex buffers.
+		* @param numBuffers Number of vertex buffers, up to VertexDeclaration::MAX_STREAMS.
+		*/
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers )=0;
+
 	/**
 		* Makes the given index buffer active.
 		* @param buffer Index buffer to make active.
@@ -232,8 +298,27 @@ public:
 		* Draws indexed primitives from the currently bound vertex and index buffer.
 		* @param topology   Topology to draw with.
 		* @param indexCount Number of indices to draw.
+		* @param startIndex First index to read from the bound index buffer.
+		* @param baseVertex Value added to each index before reading from the vertex buffer; lets many meshes share one buffer with their own local indices.
 		*/
-	virtual void drawIndexed( PrimitiveTopology topology, int indexCount )=0;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex=0, int baseVertex=0 )=0;
+
+	/**
+		* Draws several instances of primitives from the currently bound vertex buffers.
+		* @param topology      Topology to draw with.
+		* @param vertexCount   Number of vertices to draw per instance.
+		* @param instanceCount Number of instances to draw.
+		* @param startIndex    Offset into the bound vertex buffer of which to start.
+		*/
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex )=0;
+
+	/**
+		* Draws several instances of indexed primitives from the currently bound vertex buffers and index buffer.
+		* @param topology      Topology to draw with.
+		* @param indexCount    Number of indices to draw per instance.
+		* @param instanceCount Number of instances to draw.
+		*/
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount )=0;
 
 	/**
 		* Sets active render targets.
@@ -343,6 +428,27 @@ public:
 		*/
 	virtual GraphicsApiType getApiType() const=0;
 
+	/**
+		* Gets the number of binds during the last presented frame that were dropped because the same thing was already bound.
+		*/
+	virtual int getRedundantCallCount() const=0;
+
+	/**
+		* Gets the number of binds during the last presented frame that actually changed device state.
+		*/
+	virtual int getStateChangeCount() const=0;
+
+	/**
+		* Gets the number of vertex attributes specified during the last presented frame.
+		* On GL each is a glVertexAttribPointer call made while building a vertex array; D3D input layouts are built with their shader, so it stays 0.
+		*/
+	virtual int getVertexAttributeSetupCount() const=0;
+
+	/**
+		* Gets the number of vertex inputs bound during the last presented frame; a glBindVertexArray on GL, or vertex buffers and input layout on D3D.
+		*/
+	virtual int getVertexInputBindCount() const=0;
+
 	/**
 		* Restores all default states for the device.
 		* @returns ErrorCode indicating success or failure.
@@ -2,6 +2,7 @@
 #define __ciri_graphics_IIndexBuffer__
 
 #include <ciri/core/ErrorCodes.hpp>
+#include "IndexFormat.hpp"
 
 namespace ciri {
 
@@ -16,6 +17,7 @@ public:
 
 	/**
 		* Sets or updates the contents of the index buffer.
+		* Indices are stored as 16-bit when every index fits, otherwise as 32-bit.  The format is fixed once the buffer is created.
 		* @param indices    Pointer to index array.
 		* @param indexCount Total number of indices in the array.
 		* @param dynamic    True if the buffer is dynamic; i.e. will be updated.
@@ -33,6 +35,12 @@ public:
 		* @return Index count provided when data was set.
 		*/
 	virtual int getIndexCount() const=0;
+
+	/**
+		* Gets the format the indices are stored in.
+		* @return Index format chosen when data was first set.
+		*/
+	virtual IndexFormat::Format getFormat() const=0;
 };
 
 }
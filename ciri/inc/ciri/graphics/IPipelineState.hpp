@@ -0,0 +1,53 @@
+#ifndef __ciri_graphics_IPipelineState__
+#define __ciri_graphics_IPipelineState__
+
+#include <cstddef>
+#include <memory>
+#include "IShader.hpp"
+#include "IBlendState.hpp"
+#include "IRasterizerState.hpp"
+#include "IDepthStencilState.hpp"
+#include "PrimitiveTopology.hpp"
+
+namespace ciri {
+
+struct PipelineDesc {
+	std::shared_ptr<IShader> shader; /**< Shader to apply.  Its vertex declaration is the pipeline's input layout. */
+	BlendDesc blend;                 /**< Blend state. */
+	RasterizerDesc rasterizer;       /**< Rasterizer state. */
+	DepthStencilDesc depthStencil;   /**< Depth and stencil state. */
+	PrimitiveTopology topology;      /**< Topology that draws using this pipeline are expected to use. */
+
+	PipelineDesc()
+		: shader(nullptr), topology(PrimitiveTopology::TriangleList) {
+	}
+};
+
+class IPipelineState {
+protected:
+	IPipelineState() {
+	}
+
+public:
+	virtual ~IPipelineState() {
+	}
+
+	/**
+		* Gets the description the pipeline was created from.
+		*/
+	virtual const PipelineDesc& getDesc() const=0;
+
+	/**
+		* Gets a hash of the description.  Equal descriptions have equal hashes, so this doubles as a sort key for draws.
+		*/
+	virtual size_t getHash() const=0;
+
+	/**
+		* Gets the topology draws using this pipeline are expected to use.
+		*/
+	virtual PrimitiveTopology getTopology() const=0;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define __ciri_graphics_IRenderTarget2D__
 
 #include <memory>
+#include <future>
+#include "TextureReadback.hpp"
 
 namespace ciri {
 
@@ -23,7 +25,7 @@ public:
 
 	/**
 		* Gets the associated underlying 2D texture of the render target.
-		* @return Pointer to the actual ITexture2D that the render target is representing.
+		* @return Pointer to the actual ITexture2D that the render target is representing, or nullptr for a depth-only target.
 		*/
 	virtual std::shared_ptr<ITexture2D> getTexture() const=0;
 
@@ -32,6 +34,11 @@ public:
 	 * @return Pointer to the depth ITexture2D, if it exists.
 	 */
 	virtual std::shared_ptr<ITexture2D> getDepth() const=0;
+
+	/**
+		* Reads the render target's color texture back asynchronously.  See ITexture2D::readAsync.
+		*/
+	virtual std::future<TextureReadback> readAsync()=0;
 };
 
 }
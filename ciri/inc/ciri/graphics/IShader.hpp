@@ -2,6 +2,8 @@
 #define __ciri_graphics_IShader__
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <ciri/core/ErrorCodes.hpp>
 #include "VertexElement.hpp"
 
@@ -37,7 +39,7 @@ public:
 	virtual void addInputElement( const VertexElement& element )=0;
 
 	/**
-		* Builds the shader from existing files.  Both the vertex shader and pixel shader must be valid, but the geometry shader is optional.
+		* Builds the shader from existing files.  See loadFromMemory.  Both the vertex shader and pixel shader must be valid, but the geometry shader is optional.
 		* @param vs Vertex shader file.  This must not be null.
 		* @param gs Geometry shader file.  This can optionally be null.
 		* @param ps Pixel shader file.  This must not be null.
@@ -47,6 +49,7 @@ public:
 
 	/**
 		* Builds the shader from memory.  Both the vertex shader and pixel shader must be valid, but the geometry shader is optional.
+		* Compiled binaries are reused from the device's shader cache when possible; otherwise compiling may continue after this returns (see isPending).
 		* @param vs Vertex shader string.  This must not be null.
 		* @param gs Geometry shader string.  This can optionally be null.
 		* @param ps Pixel shader string.  This must not be null.
@@ -78,9 +81,25 @@ public:
 	/**
 		* Checks if the shader is valid.
 		* A shader is considered valid if it has both a compiled vertex and pixel shader.
+		* Never blocks; a shader still compiling in the background is not yet valid.
 		* @return True if valid.
 		*/
 	virtual bool isValid() const=0;
+
+	/**
+		* Checks if the shader is still compiling in the background.
+		* Loads that miss the shader cache may return before compiling has finished; errors from compiling are only reported once it has.
+		* Constants added in the meantime are attached when it finishes.
+		* @returns True while compiling; false once finished, whether or not it succeeded.
+		*/
+	virtual bool isPending() const=0;
+
+	/**
+		* Blocks until any background compile has finished, then attaches constants added while it was pending.
+		* The device calls this when a shader is applied, so most code never needs to.
+		* @returns ErrorCode of the first error, or CIRI_SHADER_INVALID if nothing was loaded.
+		*/
+	virtual ErrorCode wait()=0;
 };
 
 }
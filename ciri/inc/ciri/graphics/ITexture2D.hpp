@@ -1,15 +1,17 @@
 #ifndef __ciri_graphics_ITexture2D__
 #define __ciri_graphics_ITexture2D__
 
+#include <future>
 #include <ciri/core/ErrorCodes.hpp>
 #include "TextureFlags.hpp"
 #include "TextureFormat.hpp"
+#include "TextureReadback.hpp"
 
 namespace ciri {
 
 class ITexture2D {
 protected:
-	ITexture2D( int flags ) {
+	ITexture2D( int ) {
 	}
 
 public:
@@ -64,6 +66,14 @@ public:
 		* @returns ErrorCode indicating success or failure.
 		*/
 	virtual ErrorCode writeToDDS( const char* file )=0;
+
+	/**
+		* Copies the texture's contents back to the cpu without stalling the pipeline.
+		* The copy is issued now and picked up by present once the gpu has finished it, usually a frame or two later; conversion to 8 bit RGBA runs on a worker thread.
+		* Poll the future (wait_for with a zero timeout) from the render thread; blocking on it there before presenting never completes.
+		* @returns Future receiving the pixels, or an error if the format cannot be read back.
+		*/
+	virtual std::future<TextureReadback> readAsync()=0;
 };
 
 }
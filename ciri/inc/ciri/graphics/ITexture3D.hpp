@@ -9,7 +9,7 @@ namespace ciri {
 
 class ITexture3D {
 protected:
-	ITexture3D( int flags ) {
+	ITexture3D( int ) {
 	}
 
 public:
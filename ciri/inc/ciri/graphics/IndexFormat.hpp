@@ -0,0 +1,52 @@
+#ifndef __ciri_graphics_IndexFormat__
+#define __ciri_graphics_IndexFormat__
+
+namespace ciri {
+
+struct IndexFormat {
+	/**
+		* Storage format of index buffer data.
+		*/
+	enum Format {
+		UInt16, /**< 16-bit unsigned integer; addresses up to 65536 vertices. */
+		UInt32  /**< 32-bit unsigned integer. */
+	};
+
+	/**
+		* Picks the smallest format able to address a number of vertices.
+		* @param vertexCount Number of vertices the indices refer to.
+		* @return Smallest format that fits.
+		*/
+	static Format fromVertexCount( int vertexCount ) {
+		return (vertexCount <= 65536) ? UInt16 : UInt32;
+	}
+
+	/**
+		* Picks the smallest format able to hold every index in an array.
+		* @param indices    Index array.
+		* @param indexCount Number of indices in the array.
+		* @return Smallest format that fits.
+		*/
+	static Format fromIndices( const int* indices, int indexCount ) {
+		int maxIndex = 0;
+		for( int i = 0; i < indexCount; ++i ) {
+			if( indices[i] > maxIndex ) {
+				maxIndex = indices[i];
+			}
+		}
+		return fromVertexCount(maxIndex + 1);
+	}
+
+	/**
+		* Gets the number of bytes per index in a given format.
+		* @param format Format to parse.
+		* @return Number of bytes per index.
+		*/
+	static int bytesPerIndex( Format format ) {
+		return (UInt16 == format) ? 2 : 4;
+	}
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,206 @@
+#ifndef __ciri_graphics_LightClusters__
+#define __ciri_graphics_LightClusters__
+
+#include <memory>
+#include <vector>
+#include <cc/Vec3.hpp>
+#include <cc/Mat4.hpp>
+#include <ciri/core/ErrorCodes.hpp>
+#include "ITexture2D.hpp"
+
+namespace ciri {
+
+class IGraphicsDevice;
+class JobSystem;
+
+/**
+ * Bins point and spot lights into clusters that divide the view volume into tiles across the screen and exponential slices in depth.
+ * Each cluster gets a compact list of the lights that can reach it, so a single shading pass loops over only those instead of every light.
+ * Lights are tested four at a time with SSE, first against a whole slice, then against each row of the slice, then against each cluster of the row;
+ * slices are handed out to the job system's threads as they finish their last one.  Point lights are spheres tested against each cluster's box, and spot lights
+ * must also pass a cone test against the cluster's bounding sphere.
+ * Results are conservative: a light may be listed in a cluster it only nearly reaches, but is never left out of one it reaches.
+ */
+class LightClusters {
+public:
+	static const int INDEX_TEXTURE_WIDTH = 1024; /**< Texels per row of the index texture. */
+
+public:
+	LightClusters();
+	~LightClusters();
+
+	/**
+		* @param tilesX Clusters across the screen.
+		* @param tilesY Clusters down the screen.
+		* @param slices Clusters in depth.
+		* @returns True on success; false if any count is not positive.
+		*/
+	bool create( int tilesX, int tilesY, int slices );
+	void destroy();
+
+	/**
+		* Sets the view volume that is divided.  Must be called before building and again whenever the projection changes.
+		* @param fov       Vertical field of view in degrees.
+		* @param aspect    Aspect ratio (width / height).
+		* @param nearPlane Depth of the first slice's near side.
+		* @param farPlane  Depth of the last slice's far side.
+		*/
+	void setProjection( float fov, float aspect, float nearPlane, float farPlane );
+
+	/**
+		* Sets the job system the slices are built on.  Without one, or with null, build runs on the calling thread.
+		*/
+	void setJobSystem( const std::shared_ptr<JobSystem>& jobs );
+
+	void clearLights();
+
+	/**
+		* Adds a point light in world space.
+		* @returns Index of the light; this is the index listed in the clusters.
+		*/
+	int addPointLight( const cc::Vec3f& position, float range );
+
+	/**
+		* Adds a spot light in world space.  Cones of 90 degrees or wider are binned as point lights.
+		* @param direction  Direction the light points.
+		* @param outerAngle Angle between the direction and the edge of the cone, in degrees.
+		* @returns Index of the light; this is the index listed in the clusters.
+		*/
+	int addSpotLight( const cc::Vec3f& position, const cc::Vec3f& direction, float range, float outerAngle );
+
+	int getLightCount() const;
+
+	/**
+		* Bins every light.  Lights wholly outside the view volume are dropped first, and are in no cluster.
+		* @param view Matrix transforming world points to view space, looking down -z.
+		*/
+	void build( const cc::Mat4f& view );
+
+	/**
+		* Bins every light by testing every cluster against every light in the view volume one at a time, on the calling thread.
+		* Gives the same lists as build, in the same order, and is only meant for checking it.
+		*/
+	void buildReference( const cc::Mat4f& view );
+
+	int getTilesX() const;
+	int getTilesY() const;
+	int getSlices() const;
+	int getClusterCount() const;
+	int getClusterIndex( int x, int y, int slice ) const;
+
+	/**
+		* Gets the slice a view space depth falls in, clamped to the slices.
+		*/
+	int getSlice( float depth ) const;
+
+	/**
+		* Gets the terms that give a depth's slice as floor(log(depth) * scale + bias), for shaders.
+		*/
+	float getSliceScale() const;
+	float getSliceBias() const;
+
+	/**
+		* Gets where a cluster's list starts in the light indices.
+		*/
+	int getClusterOffset( int cluster ) const;
+	int getClusterLightCount( int cluster ) const;
+
+	/**
+		* Gets the lists of every cluster, one after another in cluster order.
+		*/
+	const std::vector<int>& getLightIndices() const;
+
+	/**
+		* Copies the last build to the grid and index textures, creating them or growing the index texture as needed.
+		* The grid texture is RGBA32_Float, tilesX wide and tilesY*slices high, with the offset and count of a cluster in red and green.
+		* The index texture is R32_FLOAT, INDEX_TEXTURE_WIDTH wide, holding the light indices in order.  Both hold whole numbers as floats,
+		* because gl treats R32_UINT textures as normalized.
+		*/
+	ErrorCode upload( const std::shared_ptr<IGraphicsDevice>& device );
+	const std::shared_ptr<ITexture2D>& getGridTexture() const;
+	const std::shared_ptr<ITexture2D>& getIndexTexture() const;
+
+private:
+	/**
+	 * View space lights, as separate streams padded to a multiple of four.
+	 */
+	struct LightBatch {
+		int count;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> range;
+		std::vector<float> dirX;
+		std::vector<float> dirY;
+		std::vector<float> dirZ;
+		std::vector<float> cosAngle;
+		std::vector<float> sinAngle;
+		std::vector<float> spot; /**< 1 for spot lights, 0 for point lights. */
+		std::vector<int> index;  /**< Index the light was added with. */
+
+		LightBatch();
+		void resize( int newCount );
+	};
+
+	/**
+	 * Axis-aligned boxes as separate streams.
+	 */
+	struct BoxArray {
+		std::vector<float> minX;
+		std::vector<float> minY;
+		std::vector<float> minZ;
+		std::vector<float> maxX;
+		std::vector<float> maxY;
+		std::vector<float> maxZ;
+
+		void resize( int count );
+	};
+
+	void computeClusterBounds();
+	void transformLights( const cc::Mat4f& view );
+	void buildSlice( int slice, LightBatch& sliceLights, LightBatch& rowLights );
+
+private:
+	int _tilesX;
+	int _tilesY;
+	int _slices;
+	float _fov;
+	float _aspect;
+	float _nearPlane;
+	float _farPlane;
+	float _sliceScale;
+	float _sliceBias;
+	std::shared_ptr<JobSystem> _jobs;
+
+	// world space lights
+	std::vector<cc::Vec3f> _positions;
+	std::vector<cc::Vec3f> _directions;
+	std::vector<float> _ranges;
+	std::vector<float> _cosAngles; /**< Of the outer angle; 0 for point lights. */
+	std::vector<float> _sinAngles; /**< Of the outer angle; 0 for point lights. */
+
+	LightBatch _viewLights;
+	BoxArray _clusterBoxes;
+	std::vector<float> _clusterSphereX; /**< Bounding sphere of each cluster's box, for cone tests. */
+	std::vector<float> _clusterSphereY;
+	std::vector<float> _clusterSphereZ;
+	std::vector<float> _clusterSphereR;
+	BoxArray _sliceBoxes;
+	BoxArray _rowBoxes;                 /**< Per slice and row. */
+	std::vector<LightBatch> _scratch;   /**< Slice and row lights of each worker. */
+	std::vector<std::vector<int>> _sliceIndices;
+	std::vector<int> _sliceIndexCounts;
+
+	std::vector<int> _clusterOffsets;
+	std::vector<int> _clusterCounts;
+	std::vector<int> _lightIndices;
+
+	std::vector<float> _gridData;
+	std::vector<float> _indexData;
+	std::shared_ptr<ITexture2D> _gridTexture;
+	std::shared_ptr<ITexture2D> _indexTexture;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef __ciri_graphics_PipelineState__
+#define __ciri_graphics_PipelineState__
+
+#include "IPipelineState.hpp"
+
+namespace ciri {
+
+/**
+ * Pipeline state shared by every backend.
+ * The blend, rasterizer, and depth-stencil parts are the backend's own state objects, translated once when the pipeline is created.
+ */
+class PipelineState : public IPipelineState {
+public:
+	PipelineState( const PipelineDesc& desc, size_t hash, const std::shared_ptr<IBlendState>& blend, const std::shared_ptr<IRasterizerState>& rasterizer, const std::shared_ptr<IDepthStencilState>& depthStencil );
+	virtual ~PipelineState();
+
+	virtual const PipelineDesc& getDesc() const override;
+	virtual size_t getHash() const override;
+	virtual PrimitiveTopology getTopology() const override;
+
+	const std::shared_ptr<IShader>& getShader() const;
+	const std::shared_ptr<IBlendState>& getBlendState() const;
+	const std::shared_ptr<IRasterizerState>& getRasterizerState() const;
+	const std::shared_ptr<IDepthStencilState>& getDepthStencilState() const;
+
+private:
+	PipelineDesc _desc;
+	size_t _hash;
+	std::shared_ptr<IBlendState> _blendState;
+	std::shared_ptr<IRasterizerState> _rasterizerState;
+	std::shared_ptr<IDepthStencilState> _depthStencilState;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef __ciri_graphics_PipelineStateCache__
+#define __ciri_graphics_PipelineStateCache__
+
+#include <memory>
+#include <unordered_map>
+#include "PipelineState.hpp"
+
+namespace ciri {
+
+class IGraphicsDevice;
+
+/**
+ * Creates and deduplicates pipeline states for a device.
+ * Equal descriptions return the same pipeline for as long as it is referenced, and pipelines with equal parts share the underlying state objects.
+ */
+class PipelineStateCache {
+public:
+	PipelineStateCache();
+	~PipelineStateCache();
+
+	/**
+		* Gets the pipeline for a description, validating it and creating its state objects through the device if it is new.
+		* @param device Device to create state objects with.
+		* @param desc Description of the pipeline.
+		* @returns Pipeline state, or nullptr if the shader is missing or invalid or a state object could not be created.
+		*/
+	std::shared_ptr<IPipelineState> create( IGraphicsDevice* device, const PipelineDesc& desc );
+
+	/**
+		* Forgets all pipelines and state objects.  Pipelines still referenced elsewhere remain usable.
+		*/
+	void clear();
+
+	/**
+		* Gets the number of live pipelines.
+		*/
+	int getCount() const;
+
+	static size_t hash( const BlendDesc& desc );
+	static size_t hash( const RasterizerDesc& desc );
+	static size_t hash( const DepthStencilDesc& desc );
+	static size_t hash( const PipelineDesc& desc );
+
+private:
+	std::shared_ptr<IBlendState> getBlendState( IGraphicsDevice* device, const BlendDesc& desc, size_t descHash );
+	std::shared_ptr<IRasterizerState> getRasterizerState( IGraphicsDevice* device, const RasterizerDesc& desc, size_t descHash );
+	std::shared_ptr<IDepthStencilState> getDepthStencilState( IGraphicsDevice* device, const DepthStencilDesc& desc, size_t descHash );
+
+private:
+	std::unordered_multimap<size_t, std::weak_ptr<PipelineState>> _pipelines;
+	std::unordered_multimap<size_t, std::pair<BlendDesc, std::weak_ptr<IBlendState>>> _blendStates;
+	std::unordered_multimap<size_t, std::pair<RasterizerDesc, std::weak_ptr<IRasterizerState>>> _rasterizerStates;
+	std::unordered_multimap<size_t, std::pair<DepthStencilDesc, std::weak_ptr<IDepthStencilState>>> _depthStencilStates;
+};
+
+}
+
+#endif
\ No newline at end of file
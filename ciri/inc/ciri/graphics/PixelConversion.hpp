@@ -0,0 +1,43 @@
+#ifndef __ciri_graphics_PixelConversion__
+#define __ciri_graphics_PixelConversion__
+
+namespace ciri {
+
+/**
+ * Conversion of texels read back from the gpu into 8 bit RGBA.
+ * Conversions process four texels at a time with SSE2; counts need not be a multiple of four.
+ */
+struct PixelConversion {
+	/**
+		* Layout of the texels as copied back from the gpu.
+		*/
+	enum Source {
+		RGBA8,   /**< Four 8 bit channels; copied as is. */
+		RGBA32F, /**< Four floats in [0, 1]; clamped. */
+		R32F,    /**< One float in [0, 1] replicated into gray; also used for floating point depth. */
+		UInt32   /**< One 32 bit integer; the byte at a given shift is replicated into gray.  Depth read as GL_UNSIGNED_INT keeps its top byte at 24. */
+	};
+
+	/**
+		* Gets the size in bytes of one texel of a source layout.
+		*/
+	static int bytesPerTexel( Source source );
+
+	/**
+		* Converts texels of any source layout to 8 bit RGBA.
+		* @param source Layout of the texels.
+		* @param shift  Bit offset of the byte to keep for UInt32; ignored otherwise.
+		* @param src    Texels to convert.
+		* @param dst    Receives count * 4 bytes.
+		* @param count  Number of texels.
+		*/
+	static void toRGBA8( Source source, int shift, const void* src, unsigned char* dst, int count );
+
+	static void rgba32fToRGBA8( const float* src, unsigned char* dst, int count );
+	static void r32fToRGBA8( const float* src, unsigned char* dst, int count );
+	static void uint32ToRGBA8( const unsigned int* src, unsigned char* dst, int count, int shift );
+};
+
+}
+
+#endif
\ No newline at end of file
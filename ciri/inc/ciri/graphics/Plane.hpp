@@ -8,6 +8,7 @@ namespace ciri {
 
 class Plane {
 public:
+	Plane();
 	Plane( const cc::Vec4f& val );
 	Plane( const cc::Vec3f& normal, float d );
 	Plane( const cc::Vec3f& a, const cc::Vec3f& b, const cc::Vec3f& c );
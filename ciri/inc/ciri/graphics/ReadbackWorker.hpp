@@ -0,0 +1,75 @@
+#ifndef __ciri_graphics_ReadbackWorker__
+#define __ciri_graphics_ReadbackWorker__
+
+#include <vector>
+#include <deque>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "PixelConversion.hpp"
+#include "TextureReadback.hpp"
+
+namespace ciri {
+
+/**
+ * A readback waiting on the gpu, then on conversion.
+ * The backends fill in everything but data when issuing the copy, and data once the copy has been mapped.
+ */
+struct ReadbackJob {
+	PixelConversion::Source source;
+	int shift;        /**< See PixelConversion::toRGBA8. */
+	int width;
+	int height;
+	int rowPitch;     /**< Bytes between rows of data. */
+	bool flip;        /**< True if data's rows are top to bottom and must be reversed. */
+	std::vector<unsigned char> data;
+	std::promise<TextureReadback> promise;
+
+	ReadbackJob();
+};
+
+/**
+ * Converts mapped readbacks to 8 bit RGBA on a thread of its own and resolves their futures, keeping the conversion off the render thread.
+ * The thread is started by the first submit.
+ */
+class ReadbackWorker {
+public:
+	ReadbackWorker();
+	~ReadbackWorker();
+
+	/**
+		* Queues a job whose data has been copied back.
+		*/
+	void submit( ReadbackJob&& job );
+
+	/**
+		* Converts everything queued and stops the thread.  Submitting again restarts it.
+		*/
+	void stop();
+
+	/**
+		* Creates a future that is already resolved with an error, for readbacks that could not be issued.
+		*/
+	static std::future<TextureReadback> makeFailed( ErrorCode error );
+
+	/**
+		* Resolves a job with an error, for readbacks that were issued but never completed.
+		*/
+	static void fail( ReadbackJob& job, ErrorCode error );
+
+private:
+	void run();
+	static void convert( ReadbackJob& job );
+
+private:
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::deque<ReadbackJob> _jobs;
+	bool _stopping;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+#ifndef __ciri_graphics_RenderGraph__
+#define __ciri_graphics_RenderGraph__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "IRenderTarget2D.hpp"
+#include "TextureFormat.hpp"
+#include "DepthStencilFormat.hpp"
+#include <ciri/core/ErrorCodes.hpp>
+
+namespace ciri {
+
+class IGraphicsDevice;
+
+/**
+ * Description of a render target the graph owns.  Targets with equal descriptions can share memory.
+ */
+struct RenderGraphTargetDesc {
+	int width;
+	int height;
+	TextureFormat::Format format;
+	DepthStencilFormat depthFormat;
+
+	RenderGraphTargetDesc();
+	RenderGraphTargetDesc( int targetWidth, int targetHeight, TextureFormat::Format targetFormat, DepthStencilFormat targetDepthFormat=DepthStencilFormat::None );
+
+	bool operator==( const RenderGraphTargetDesc& rhs ) const;
+	bool operator!=( const RenderGraphTargetDesc& rhs ) const;
+};
+
+/**
+ * Runs a frame as a list of passes that declare which render targets they read and write.
+ * Each frame the passes and targets are declared again after reset, then compile culls passes whose output nothing uses,
+ * works out when each target is first and last used, and maps targets onto a pool of real render targets so that targets whose
+ * lifetimes do not overlap share one.  The pool persists between frames, so a graph that does not change creates nothing after its first frame.
+ * Passes run in the order they were added.  A pass that writes a target an earlier pass wrote adds to it (by blending or otherwise) rather than replacing it.
+ * Execute binds each pass's written targets in the order they were declared, skipping the bind when the previous pass wrote the same targets.
+ */
+class RenderGraph {
+public:
+	typedef std::function<void( const RenderGraph& graph )> PassFunc;
+
+	static const int INVALID_HANDLE = -1;
+	static const int MAX_PASS_TARGETS = 8;      /**< Matches the gl and dx limit on simultaneous render targets. */
+	static const int RELEASE_AFTER_FRAMES = 3;  /**< Pooled targets not used by this many compiles in a row are released. */
+
+public:
+	RenderGraph();
+	~RenderGraph();
+
+	/**
+		* Sets the device targets are created with and passes are run on.
+		* @returns True on success; false if the device is null.
+		*/
+	bool create( const std::shared_ptr<IGraphicsDevice>& device );
+
+	/**
+		* Clears the frame and releases every pooled target.
+		*/
+	void destroy();
+
+	/**
+		* Clears the passes and targets of the last frame.  Pooled targets are kept.
+		*/
+	void reset();
+
+	/**
+		* Declares a target owned by the graph.  It only exists for the frame and its contents are undefined until a pass writes it.
+		* @returns Handle of the target.
+		*/
+	int createTarget( const char* name, const RenderGraphTargetDesc& desc );
+
+	/**
+		* Declares a target that lives outside of the graph.  Passes that write imported targets are never culled.
+		* @param name   Name for debugging.
+		* @param target Target to use, or nullptr for the default render targets.
+		* @returns Handle of the target.
+		*/
+	int importTarget( const char* name, const std::shared_ptr<IRenderTarget2D>& target );
+
+	/**
+		* Adds a pass.
+		* @param name    Name for debugging.
+		* @param execute Function to run with the pass's targets bound.
+		* @returns Handle of the pass.
+		*/
+	int addPass( const char* name, const PassFunc& execute );
+
+	/**
+		* Declares that a pass samples a target.
+		*/
+	void read( int pass, int target );
+
+	/**
+		* Declares that a pass renders to a target.  Targets are bound in the order they are declared.
+		*/
+	void write( int pass, int target );
+
+	/**
+		* Keeps a pass even if nothing reads what it writes, for passes with effects outside of the graph.
+		*/
+	void setSideEffects( int pass );
+
+	/**
+		* Culls passes, computes lifetimes, and assigns pooled targets, creating any that are missing.
+		* @returns CIRI_OK on success; CIRI_INVALID_ARGUMENT if a pass reads a target no earlier pass wrote, writes too many targets,
+		*          or writes targets of different sizes, or mixes the default render targets with others; CIRI_UNKNOWN_ERROR if a target could not be created.
+		*/
+	ErrorCode compile();
+
+	/**
+		* Runs the passes that were not culled.  Must follow a successful compile.
+		* The targets of the last pass that wrote any remain bound.
+		*/
+	void execute();
+
+	/**
+		* Gets the real render target behind a handle.  Valid from compile until the next reset; nullptr for the default render targets and culled targets.
+		*/
+	std::shared_ptr<IRenderTarget2D> getTarget( int target ) const;
+
+	/**
+		* Gets the name of a pass or target, for debugging.
+		*/
+	const char* getPassName( int pass ) const;
+	const char* getTargetName( int target ) const;
+
+	/**
+		* Gets the number of passes added this frame.
+		*/
+	int getPassCount() const;
+
+	/**
+		* Gets the number of passes the last compile culled.
+		*/
+	int getCulledPassCount() const;
+
+	/**
+		* Gets the number of real render targets in the pool.
+		*/
+	int getPooledTargetCount() const;
+
+	/**
+		* Gets the number of times the last execute changed the bound render targets.
+		*/
+	int getTargetSwitchCount() const;
+
+private:
+	struct Target {
+		std::string name;
+		RenderGraphTargetDesc desc;
+		bool imported;
+		std::shared_ptr<IRenderTarget2D> importedTarget;
+		int readers;   // passes that read it and were not culled
+		int firstPass; // first and last pass that use it, or -1 if unused
+		int lastPass;
+		int pooled;    // index into _pool, or -1
+	};
+
+	struct Pass {
+		std::string name;
+		PassFunc execute;
+		std::vector<int> reads;
+		std::vector<int> writes;
+		bool sideEffects;
+		bool culled;
+		int references; // targets it writes that are still used
+	};
+
+	struct PooledTarget {
+		RenderGraphTargetDesc desc;
+		std::shared_ptr<IRenderTarget2D> target;
+		int unusedFrames;
+		bool inUse;
+	};
+
+	ErrorCode validate() const;
+	void cull();
+	void computeLifetimes();
+	ErrorCode assignPooledTargets();
+	int acquirePooledTarget( const RenderGraphTargetDesc& desc );
+	void getTargetSize( int target, int* outWidth, int* outHeight ) const;
+	bool isValidPass( int pass ) const;
+	bool isValidTarget( int target ) const;
+
+private:
+	std::shared_ptr<IGraphicsDevice> _device;
+	std::vector<Target> _targets;
+	std::vector<Pass> _passes;
+	std::vector<PooledTarget> _pool;
+	bool _compiled;
+	int _culledPasses;
+	int _targetSwitches;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef __ciri_graphics_ShaderCache__
+#define __ciri_graphics_ShaderCache__
+
+#include <string>
+#include <vector>
+
+namespace ciri {
+
+/**
+ * Stores compiled shader binaries on disk so later runs can skip compiling.
+ * Each entry is one file named by its key, with a header holding the key, size, and a checksum so stale, truncated, or foreign files are ignored.
+ * Keys cover the full source text of every stage, the backend's own flags, and the driver string, so any change to any of them misses.
+ * Files pulled in by a shader's #include are not part of the key.
+ * Not thread safe; it is used from the thread that owns the device.
+ */
+class ShaderCache {
+public:
+	static const unsigned int VERSION = 1; /**< Bump to invalidate every existing entry. */
+
+public:
+	ShaderCache();
+	~ShaderCache();
+
+	/**
+		* Sets the directory entries are read from and written to, creating it if it does not exist.
+		* @param directory Directory to use, or nullptr or an empty string to disable the cache.
+		* @returns True if the cache is usable; false if it was disabled or the directory could not be created.
+		*/
+	bool setDirectory( const char* directory );
+
+	/**
+		* Gets the cache directory, or an empty string if disabled.
+		*/
+	const std::string& getDirectory() const;
+
+	/**
+		* Checks if a directory has been set.
+		*/
+	bool isEnabled() const;
+
+	/**
+		* Sets the string identifying the driver and compiler.  Binaries from one driver are not valid for another, so it is part of every key.
+		*/
+	void setDriver( const std::string& driver );
+
+	/**
+		* Builds the key for a set of sources.
+		* @param vs    Vertex shader source.
+		* @param gs    Geometry shader source, or nullptr.
+		* @param ps    Pixel shader source.
+		* @param flags Backend specific compile flags.
+		* @returns The key.
+		*/
+	unsigned long long makeKey( const char* vs, const char* gs, const char* ps, unsigned int flags ) const;
+
+	/**
+		* Reads an entry.
+		* @param key     Key of the entry.
+		* @param outData Receives the stored bytes.
+		* @returns True if a valid entry was found; false otherwise.
+		*/
+	bool load( unsigned long long key, std::vector<char>& outData ) const;
+
+	/**
+		* Writes an entry, replacing any existing one.
+		* @returns True on success; false if disabled or the write failed.
+		*/
+	bool store( unsigned long long key, const void* data, size_t size ) const;
+
+	/**
+		* Deletes an entry; used when the driver rejects a stored binary.
+		*/
+	void remove( unsigned long long key ) const;
+
+private:
+	std::string getPath( unsigned long long key ) const;
+
+private:
+	std::string _directory;
+	std::string _driver;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef __ciri_graphics_TextureReadback__
+#define __ciri_graphics_TextureReadback__
+
+#include <vector>
+#include <ciri/core/ErrorCodes.hpp>
+
+namespace ciri {
+
+/**
+ * Result of an asynchronous texture readback.
+ * Pixels are always 8 bit RGBA with rows ordered bottom to top (as GL and TGA store them) regardless of the texture's format or the api.
+ * Depth and single channel formats are replicated into gray with an alpha of 255.
+ */
+struct TextureReadback {
+	ErrorCode error;
+	int width;
+	int height;
+	std::vector<unsigned char> pixels; /**< width * height * 4 bytes when error is CIRI_OK; empty otherwise. */
+
+	TextureReadback();
+
+	/**
+		* Writes the pixels to a 32 bit TGA file.
+		* @param file TGA file to write to.
+		* @returns ErrorCode indicating success or failure.
+		*/
+	ErrorCode writeToTGA( const char* file ) const;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -1,37 +1,69 @@
 #ifndef __ciri_graphics_VertexDeclaration__
 #define __ciri_graphics_VertexDeclaration__
 
+#include <cstddef>
 #include <vector>
 #include "VertexElement.hpp"
 
 namespace ciri {
 
 class VertexDeclaration {
+public:
+	static const int MAX_STREAMS = 4; /**< Vertex buffer slots an element can be read from. */
+
 public:
 	VertexDeclaration();
 	virtual ~VertexDeclaration();
 
 	/**
-		* Adds a new VertexElement to the declaration.
+		* Adds a new VertexElement to the declaration.  Elements with a slot outside of 0..MAX_STREAMS-1 are ignored.
 		* @param element Element to add.
 		*/
 	void add( const VertexElement& element );
 
 	/**
-		* Gets the total stride of the vertex declaration.
-		* @return Stride of all elements within the declaration.
+		* Gets the stride of the first vertex stream.
+		* @return Stride of all elements within stream 0.
 		*/
 	int getStride() const;
 
+	/**
+		* Gets the stride of a vertex stream.
+		* @param slot Vertex buffer slot.
+		* @return Stride of all elements within the stream, or 0 if the slot is unused.
+		*/
+	int getStride( int slot ) const;
+
+	/**
+		* Gets the byte offset of an element within its stream.
+		* @param index Index of the element.
+		* @return Offset of the element.
+		*/
+	int getOffset( int index ) const;
+
+	/**
+		* Gets the number of vertex streams used, i.e. one more than the highest slot of any element.
+		*/
+	int getStreamCount() const;
+
 	/**
 		* Gets a vector of all VertexElements that make up this declaration.
 		* @return Vector of VertexElements.
 		*/
 	const std::vector<VertexElement>& getElements() const;
 
+	/**
+		* Gets a hash of the declaration's elements.  Declarations with the same elements in the same order have the same hash.
+		* @return Hash of the declaration.
+		*/
+	size_t getHash() const;
+
 protected:
 	std::vector<VertexElement> _elements;
-	int _stride;
+	std::vector<int> _offsets;
+	int _strides[MAX_STREAMS];
+	int _streamCount;
+	size_t _hash;
 };
 
 }
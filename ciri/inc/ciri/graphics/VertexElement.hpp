@@ -10,6 +10,13 @@ class VertexElement {
 public:
 	VertexElement();
 	VertexElement( VertexFormat format, VertexUsage usage, int usageIndex );
+
+	/**
+		* Creates an element read from a given vertex stream.
+		* @param slot             Vertex buffer slot the element is read from.
+		* @param instanceStepRate 0 to advance per vertex, otherwise the number of instances drawn before advancing.
+		*/
+	VertexElement( VertexFormat format, VertexUsage usage, int usageIndex, int slot, int instanceStepRate );
 	~VertexElement();
 
 	/**
@@ -42,10 +49,24 @@ public:
 		*/
 	int getMultiplicity() const;
 
+	/**
+		* Gets the vertex buffer slot the element is read from.
+		* @return Vertex buffer slot.
+		*/
+	int getSlot() const;
+
+	/**
+		* Gets how often the element advances.  0 means per vertex; n means once every n instances.
+		* @return Instance step rate.
+		*/
+	int getInstanceStepRate() const;
+
 private:
 	VertexFormat _format;
 	VertexUsage _usage;
 	int _usageIndex;
+	int _slot;
+	int _instanceStepRate;
 };
 
 }
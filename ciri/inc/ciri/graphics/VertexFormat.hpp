@@ -10,7 +10,13 @@ enum class VertexFormat {
 	Float,  /**< Single 32 bit float. */
 	Float2, /**< Two 32 bit floats. */
 	Float3, /**< Three 32 bit floats. */
-	Float4  /**< Four 32 bit floats. */
+	Float4,       /**< Four 32 bit floats. */
+	Half2,        /**< Two 16 bit floats; read as float2. */
+	Half4,        /**< Four 16 bit floats; read as float4. */
+	UNorm8x4,     /**< Four 8 bit unsigned normalized integers; read as float4 in [0, 1]. */
+	SNorm16x2,    /**< Two 16 bit signed normalized integers; read as float2 in [-1, 1]. */
+	SNorm16x4,    /**< Four 16 bit signed normalized integers; read as float4 in [-1, 1]. */
+	UNorm10_10_10_2 /**< Three 10 bit and one 2 bit unsigned normalized integers packed into 32 bits; read as float4 in [0, 1]. */
 };
 
 }
@@ -0,0 +1,73 @@
+#ifndef __ciri_graphics_VertexPacking__
+#define __ciri_graphics_VertexPacking__
+
+#include <cc/Vec2.hpp>
+#include <cc/Vec3.hpp>
+#include <cc/Vec4.hpp>
+
+namespace ciri {
+
+/**
+ * CPU side conversion of float vertex data into the compact VertexFormats.
+ * The array versions process four values at a time with SSE2; counts need not be a multiple of four.
+ */
+struct VertexPacking {
+	/**
+		* Converts a float to a 16 bit float, rounding to nearest even.  Out of range values become infinity.
+		*/
+	static unsigned short floatToHalf( float value );
+
+	/**
+		* Converts a 16 bit float back to a float.
+		*/
+	static float halfToFloat( unsigned short value );
+
+	/**
+		* Converts an array of floats to 16 bit floats.  Matches floatToHalf exactly.
+		* @param src   Floats to convert.
+		* @param dst   Receives count 16 bit floats.
+		* @param count Number of values.
+		*/
+	static void floatToHalf( const float* src, unsigned short* dst, int count );
+
+	/**
+		* Converts an array of floats in [-1, 1] to 16 bit signed normalized integers.  Values are clamped.
+		* @param src   Floats to convert.
+		* @param dst   Receives count integers.
+		* @param count Number of values.
+		*/
+	static void floatToSNorm16( const float* src, short* dst, int count );
+
+	/**
+		* Converts a 16 bit signed normalized integer back to a float, following the D3D and GL 4.2 rules.
+		*/
+	static float snorm16ToFloat( short value );
+
+	/**
+		* Packs four floats in [0, 1] into UNorm8x4 with x in the lowest byte.  Values are clamped.
+		*/
+	static unsigned int packUNorm8x4( const cc::Vec4f& value );
+
+	/**
+		* Packs four floats in [0, 1] into UNorm10_10_10_2 with x in the lowest bits.  Values are clamped.
+		*/
+	static unsigned int packUNorm1010102( const cc::Vec4f& value );
+
+	/**
+		* Encodes a unit vector onto the octahedron, giving two values in [-1, 1] suitable for SNorm16x2.
+		* Shaders decode with:
+		*   float3 n = float3(e.xy, 1 - abs(e.x) - abs(e.y));
+		*   if( n.z < 0 ) { n.xy = (1 - abs(n.yx)) * sign(n.xy); }
+		*   n = normalize(n);
+		*/
+	static cc::Vec2f encodeOctahedral( const cc::Vec3f& normal );
+
+	/**
+		* Decodes a vector written by encodeOctahedral.
+		*/
+	static cc::Vec3f decodeOctahedral( const cc::Vec2f& encoded );
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef __ciri_graphics_GraphicsCommandStream__
+#define __ciri_graphics_GraphicsCommandStream__
+
+#include <unordered_map>
+#include <vector>
+
+namespace ciri {
+
+/**
+ * Kinds of commands recorded by the null graphics device.
+ * Values are written to disk by GraphicsCommandStream::save, so only ever append new entries.
+ */
+enum class GraphicsCommandType : int {
+	ApplyShader,          /**< args: shader id */
+	SetVertexBuffer,      /**< args: buffer id */
+	SetIndexBuffer,       /**< args: buffer id */
+	SetTexture2D,         /**< args: slot, texture id, shader stage */
+	SetTexture3D,         /**< args: slot, texture id, shader stage */
+	SetTextureCube,       /**< args: slot, texture id, shader stage */
+	SetSamplerState,      /**< args: slot, sampler id, shader stage */
+	SetBlendState,        /**< args: state id */
+	SetRasterizerState,   /**< args: state id */
+	SetDepthStencilState, /**< args: state id */
+	SetRenderTargets,     /**< args: target count, up to three target ids */
+	RestoreRenderTargets, /**< args: none */
+	SetViewport,          /**< args: x, y, width, height */
+	SetClearColor,        /**< args: r, g, b, a as float bits */
+	SetClearDepth,        /**< args: depth as float bits */
+	SetClearStencil,      /**< args: stencil */
+	Clear,                /**< args: ClearFlags */
+	DrawArrays,           /**< args: topology, vertex count, start vertex */
+	DrawIndexed,          /**< args: topology, index count, start index, base vertex */
+	UploadVertexBuffer,   /**< args: buffer id, bytes */
+	UploadIndexBuffer,    /**< args: buffer id, bytes */
+	UploadConstantBuffer, /**< args: buffer id, bytes */
+	UploadTexture,        /**< args: texture id, bytes */
+	Present,              /**< args: none */
+	SetVertexStream,      /**< args: slot, buffer id; slots other than 0 only */
+	DrawInstanced,        /**< args: topology, vertex count, instance count, start vertex */
+	DrawIndexedInstanced, /**< args: topology, index count, instance count */
+	BindConstantRange,    /**< args: buffer id, ring offset, bytes, aligned bytes; a constant update suballocated from the constant ring */
+	ReadTexture,          /**< args: texture id, bytes copied back */
+	AllocateRenderTarget, /**< args: target id, bytes of its color and depth textures; recorded again with the new size when resized */
+	ReleaseRenderTarget   /**< args: target id; recorded at the first present after the last reference went away */
+};
+
+struct GraphicsCommand {
+	GraphicsCommandType type;
+	int args[4];
+
+	GraphicsCommand();
+	GraphicsCommand( GraphicsCommandType commandType, int a0=0, int a1=0, int a2=0, int a3=0 );
+
+	bool operator==( const GraphicsCommand& rhs ) const;
+	bool operator!=( const GraphicsCommand& rhs ) const;
+};
+
+/**
+ * Totals gathered while recording a command stream.
+ */
+struct GraphicsCounters {
+	int frames;                     /**< Number of presents. */
+	int drawCalls;                  /**< Indexed and non-indexed draws, instanced or not. */
+	long long verticesSubmitted;    /**< Vertices or indices consumed by draws, counted once per instance. */
+	int stateChanges;               /**< Binds that changed the bound shader, buffer, texture, sampler or state. */
+	int redundantBinds;             /**< Binds of something that was already bound to the same slot. */
+	int renderTargetChanges;        /**< Render target sets and restores. */
+	int clears;                     /**< Calls to clear. */
+	long long vertexBytesUploaded;
+	long long indexBytesUploaded;
+	long long constantBytesUploaded;
+	int constantUpdates;            /**< Constant buffers updated in their own storage, each a rename or stall for the driver. */
+	int constantRangeBinds;         /**< Constant updates suballocated from the constant ring and bound by offset. */
+	long long constantRingBytes;    /**< Ring bytes used by suballocations, including alignment padding. */
+	long long textureBytesUploaded;
+	int readbacks;                  /**< Asynchronous texture readbacks issued. */
+	long long readbackBytes;        /**< Bytes copied back by readbacks, before conversion. */
+	long long renderTargetBytes;    /**< Bytes of render targets allocated and not yet released. */
+	long long peakRenderTargetBytes; /**< Most render target bytes allocated at once. */
+
+	GraphicsCounters();
+};
+
+/**
+ * Compact, resource-id based record of everything issued to a graphics device.
+ * Recording also tracks what is bound so that counters (including redundant binds) are available immediately.
+ * Streams can be saved and loaded to compare a frame against a known-good capture.
+ */
+class GraphicsCommandStream {
+public:
+	GraphicsCommandStream();
+	~GraphicsCommandStream();
+
+	/**
+	 * Appends a command and updates the counters.
+	 */
+	void record( const GraphicsCommand& command );
+
+	/**
+	 * Removes all commands and resets the counters and bind tracking.
+	 */
+	void clear();
+
+	const std::vector<GraphicsCommand>& getCommands() const;
+	const GraphicsCounters& getCounters() const;
+
+	/**
+	 * Sums the bytes uploaded to one buffer or texture across the stream.
+	 * @param resourceId Id of the resource as reported by the null device.
+	 */
+	long long getUploadedBytes( int resourceId ) const;
+
+	/**
+	 * Writes the commands to a binary file.
+	 * @returns True on success; false otherwise.
+	 */
+	bool save( const char* file ) const;
+
+	/**
+	 * Replaces the stream's contents with commands read from a file written by save, recomputing the counters.
+	 * @returns True on success; false otherwise.
+	 */
+	bool load( const char* file );
+
+	/**
+	 * Compares two streams command by command.
+	 * @returns Index of the first command that differs, or -1 if the streams are identical.
+	 */
+	static int findFirstDifference( const GraphicsCommandStream& lhs, const GraphicsCommandStream& rhs );
+
+private:
+	static const int MAX_SLOTS = 16;
+	static const int STAGE_COUNT = 4; // vertex, geometry, pixel, all
+	static const int MAX_STREAMS = 4; // matches VertexDeclaration::MAX_STREAMS
+
+	bool bind( int& bound, int id );
+	static int stageIndex( int stage );
+
+private:
+	std::vector<GraphicsCommand> _commands;
+	GraphicsCounters _counters;
+	// currently bound ids for redundant bind detection
+	int _shader;
+	int _vertexBuffer;
+	int _vertexStreams[MAX_STREAMS];
+	int _indexBuffer;
+	int _blendState;
+	int _rasterizerState;
+	int _depthStencilState;
+	int _textures[STAGE_COUNT][MAX_SLOTS];
+	int _samplers[STAGE_COUNT][MAX_SLOTS];
+	std::unordered_map<int, long long> _renderTargetBytes; // live render targets by id
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __ciri_graphics_NullBlendState__
+#define __ciri_graphics_NullBlendState__
+
+#include <ciri/graphics/IBlendState.hpp>
+
+namespace ciri {
+
+class NullBlendState : public IBlendState {
+public:
+	NullBlendState( int id );
+	virtual ~NullBlendState();
+
+	bool create( const BlendDesc& desc );
+	virtual void destroy() override;
+
+	const BlendDesc& getDesc() const;
+	int getId() const;
+
+private:
+	int _id;
+	BlendDesc _desc;
+};
+
+}
+
+#endif
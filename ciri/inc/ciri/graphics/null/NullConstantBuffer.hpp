@@ -0,0 +1,41 @@
+#ifndef __ciri_graphics_NullConstantBuffer__
+#define __ciri_graphics_NullConstantBuffer__
+
+#include <memory>
+#include <ciri/graphics/IConstantBuffer.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullConstantBuffer : public IConstantBuffer {
+public:
+	NullConstantBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullConstantBuffer();
+
+	virtual ErrorCode setData( int dataSize, void* data ) override;
+	virtual void destroy() override;
+
+	/**
+		* Suballocates again if the last update was in the constant ring during an earlier frame.  Called by the device before drawing.
+		*/
+	void refresh();
+
+	int getId() const;
+	int getSize() const;
+
+private:
+	void write( int dataSize );
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _size;
+	int _lastSize;
+	bool _inRing;
+	unsigned int _ringFrame;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __ciri_graphics_NullDepthStencilState__
+#define __ciri_graphics_NullDepthStencilState__
+
+#include <ciri/graphics/IDepthStencilState.hpp>
+
+namespace ciri {
+
+class NullDepthStencilState : public IDepthStencilState {
+public:
+	NullDepthStencilState( int id );
+	virtual ~NullDepthStencilState();
+
+	bool create( const DepthStencilDesc& desc );
+	virtual void destroy() override;
+
+	const DepthStencilDesc& getDesc() const;
+	int getId() const;
+
+private:
+	int _id;
+	DepthStencilDesc _desc;
+};
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef __ciri_graphics_NullGraphicsDevice__
+#define __ciri_graphics_NullGraphicsDevice__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <future>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/graphics/GraphicsStateCache.hpp>
+#include <ciri/graphics/PipelineStateCache.hpp>
+#include <ciri/graphics/CommandList.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
+#include <ciri/core/Profiler.hpp>
+#include "GraphicsCommandStream.hpp"
+#include "NullShader.hpp"
+#include "NullVertexBuffer.hpp"
+#include "NullIndexBuffer.hpp"
+
+namespace ciri {
+
+/**
+ * Graphics device that needs neither a window handle nor a GPU.
+ * Resources live only in memory and every bind, draw, clear, upload and present is recorded into a GraphicsCommandStream,
+ * which makes it possible to run a demo's drawing code headless and compare the work it issues between builds.
+ * Draws are validated like the real backends (a shader and buffers must be bound) and are dropped, not recorded, when invalid.
+ * The shader extension defaults to .glsl, which every demo ships sources for; shader files only need to exist.
+ */
+class NullGraphicsDevice : public IGraphicsDevice, public std::enable_shared_from_this<NullGraphicsDevice> {
+public:
+	NullGraphicsDevice();
+	virtual ~NullGraphicsDevice();
+
+	virtual bool create( const std::shared_ptr<IWindow>& window ) override;
+	virtual void destroy() override;
+	virtual void present() override;
+
+	virtual void setViewport( const Viewport& vp ) override;
+	virtual const Viewport& getViewport() const override;
+	virtual std::shared_ptr<IShader> createShader() override;
+	virtual std::shared_ptr<IVertexBuffer> createVertexBuffer() override;
+	virtual std::shared_ptr<IIndexBuffer> createIndexBuffer() override;
+	virtual std::shared_ptr<IConstantBuffer> createConstantBuffer() override;
+	virtual void setConstantRingSize( int bytesPerFrame ) override;
+	virtual bool setShaderCacheDirectory( const char* directory ) override;
+	virtual std::shared_ptr<ITexture2D> createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
+	virtual std::shared_ptr<ITexture3D> createTexture3D( int width, int height, int depth, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
+	virtual std::shared_ptr<ITextureCube> createTextureCube( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) override;
+	virtual std::shared_ptr<ISamplerState> createSamplerState( const SamplerDesc& desc ) override;
+	virtual std::shared_ptr<IRenderTarget2D> createRenderTarget2D( int width, int height, TextureFormat::Format format, DepthStencilFormat depthFormat ) override;
+	virtual std::shared_ptr<IRasterizerState> createRasterizerState( const RasterizerDesc& desc ) override;
+	virtual std::shared_ptr<IDepthStencilState> createDepthStencilState( const DepthStencilDesc& desc ) override;
+	virtual std::shared_ptr<IBlendState> createBlendState( const BlendDesc& desc ) override;
+	virtual std::shared_ptr<IPipelineState> createPipelineState( const PipelineDesc& desc ) override;
+	virtual std::shared_ptr<ICommandList> createCommandList() override;
+	virtual void applyShader( const std::shared_ptr<IShader>& shader ) override;
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state ) override;
+	virtual void executeCommandLists( ICommandList** lists, int count ) override;
+	virtual void beginGpuScope( const char* name ) override;
+	virtual void endGpuScope() override;
+	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) override;
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) override;
+	virtual void setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) override;
+	virtual void setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) override;
+	virtual void setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) override;
+	virtual void setBlendState( const std::shared_ptr<IBlendState>& state ) override;
+	virtual void drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) override;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) override;
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) override;
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) override;
+	virtual void setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) override;
+	virtual void restoreDefaultRenderTargets() override;
+	virtual ErrorCode resize() override;
+	virtual ErrorCode resizeTexture2D( const std::shared_ptr<ITexture2D>& texture, int width, int height ) override;
+	virtual ErrorCode resizeRenderTarget2D( const std::shared_ptr<IRenderTarget2D>& target, int width, int height ) override;
+	virtual void setClearColor( float r, float g, float b, float a ) override;
+	virtual void setClearDepth( float depth ) override;
+	virtual void setClearStencil( int stencil ) override;
+	virtual void clear( int flags ) override;
+	virtual void setRasterizerState( const std::shared_ptr<IRasterizerState>& state ) override;
+	virtual void setDepthStencilState( const std::shared_ptr<IDepthStencilState>& state ) override;
+	virtual void setShaderExt( const char* ext ) override;
+	virtual const char* getShaderExt() const override;
+	virtual std::shared_ptr<IWindow> getWindow() const override;
+	virtual const char* getGpuName() const override;
+	virtual const char* getApiInfo() const override;
+	virtual GraphicsApiType getApiType() const override;
+	virtual int getRedundantCallCount() const override;
+	virtual int getStateChangeCount() const override;
+	virtual int getVertexAttributeSetupCount() const override;
+	virtual int getVertexInputBindCount() const override;
+	virtual ErrorCode restoreDefaultStates() override;
+	virtual ErrorCode restoreDefaultBlendState() override;
+	virtual ErrorCode restoreDefaultRasterizerState() override;
+	virtual ErrorCode restoreDefaultDepthStencilState() override;
+	virtual std::shared_ptr<IBlendState> getDefaultBlendAdditive() override;
+	virtual std::shared_ptr<IBlendState> getDefaultBlendAlpha() override;
+	virtual std::shared_ptr<IBlendState> getDefaultBlendNonPremul() override;
+	virtual std::shared_ptr<IBlendState> getDefaultBlendOpaque() override;
+	virtual std::shared_ptr<IRasterizerState> getDefaultRasterNone() override;
+	virtual std::shared_ptr<IRasterizerState> getDefaultRasterClockwise() override;
+	virtual std::shared_ptr<IRasterizerState> getDefaultRasterCounterClockwise() override;
+	virtual std::shared_ptr<IDepthStencilState> getDefaultDepthStencilDefault() override;
+	virtual std::shared_ptr<IDepthStencilState> getDefaultDepthStencilDepthRead() override;
+	virtual std::shared_ptr<IDepthStencilState> getDefaultDepthStencilNone() override;
+
+
+	/**
+	 * Gets the stream that all commands are recorded into.
+	 */
+	GraphicsCommandStream& getCommandStream();
+
+	/**
+	 * Re-issues a recorded stream through this device, recording it again.
+	 * Resource ids are resolved against resources created by this device; commands that refer to resources which no longer exist bind null.
+	 * Uploads are recorded as-is since the stream does not keep the uploaded data.
+	 * @param stream Stream to replay; must not be this device's own stream.
+	 */
+	void replay( const GraphicsCommandStream& stream );
+
+	/**
+	 * Reserves space in this frame's part of the constant ring, modelling the gl and dx rings.
+	 * @param dataSize       Bytes to reserve.
+	 * @param outOffset      Receives the offset within the frame's part of the ring.
+	 * @param outAlignedSize Receives the size rounded up to CONSTANT_RING_ALIGNMENT.
+	 * @returns True if reserved; false if the ring is disabled or full for this frame.
+	 */
+	bool allocateConstants( int dataSize, int* outOffset, int* outAlignedSize );
+
+	/**
+	 * Gets a number that changes every present; ring data from an earlier frame must be suballocated again before use.
+	 */
+	unsigned int getConstantRingFrame() const;
+
+	/**
+	 * Records a texture readback and resolves it through the readback worker at the next present, as the gl and dx rings would at the earliest.
+	 * The pixels are all zero since nothing is ever drawn.
+	 * @returns Future receiving width * height zeroed RGBA pixels.
+	 */
+	std::future<TextureReadback> readTexture( int id, TextureFormat::Format format, int width, int height );
+
+	/**
+	 * Size of a pixel as counted for uploads.  Unlike TextureFormat::bytesPerPixel, every format has a size.
+	 */
+	static int bytesPerPixel( TextureFormat::Format format );
+
+private:
+	enum class ResourceKind {
+		Shader,
+		VertexBuffer,
+		IndexBuffer,
+		ConstantBuffer,
+		Texture2D,
+		Texture3D,
+		TextureCube,
+		SamplerState,
+		RenderTarget2D,
+		RasterizerState,
+		DepthStencilState,
+		BlendState
+	};
+
+	struct ResourceEntry {
+		ResourceKind kind;
+		std::weak_ptr<void> resource;
+	};
+
+	int addResource( ResourceKind kind );
+	void setResource( int id, const std::shared_ptr<void>& resource );
+	template<typename T>
+	std::shared_ptr<T> findResource( int id, ResourceKind kind ) const;
+	void record( GraphicsCommandType type, int a0=0, int a1=0, int a2=0, int a3=0 );
+	void releaseRenderTargets();
+	static int renderTargetBytes( const IRenderTarget2D& target );
+	void bindVertexStream( int slot, const std::shared_ptr<IVertexBuffer>& buffer );
+	bool hasVertexStreams() const;
+	void refreshConstants();
+	static int floatBits( float value );
+	static float bitsFloat( int bits );
+
+private:
+	bool _isValid;
+	std::shared_ptr<IWindow> _window;
+	int _defaultWidth;
+	int _defaultHeight;
+	//
+	Viewport _activeViewport;
+	//
+	std::weak_ptr<NullShader> _activeShader;
+	std::weak_ptr<NullVertexBuffer> _activeVertexBuffer;
+	std::weak_ptr<NullVertexBuffer> _activeVertexStreams[VertexDeclaration::MAX_STREAMS]; /**< Slots 1 and up; slot 0 is _activeVertexBuffer. */
+	std::weak_ptr<NullIndexBuffer> _activeIndexBuffer;
+	// only counts what a real backend would skip; every call is still recorded
+	GraphicsStateCache _stateCache;
+	PipelineStateCache _pipelineCache;
+	//
+	std::string _shaderExt;
+	//
+	GraphicsCommandStream _commandStream;
+	int _nextResourceId;
+	std::unordered_map<int, ResourceEntry> _resources;
+	std::vector<int> _renderTargetIds; /**< Live render targets, checked for release every present. */
+	//
+	static const int CONSTANT_RING_ALIGNMENT = 256; // matches dx and common gl uniform buffer offset alignment
+	int _constantRingSize;
+	int _constantRingHead;
+	unsigned int _constantRingFrame;
+	//
+	std::vector<ReadbackJob> _pendingReadbacks;
+	ReadbackWorker _readbackWorker;
+	//
+	std::vector<ProfileEvent> _gpuScopes; /**< Timed on the cpu since there is no gpu; reported at present. */
+	std::vector<int> _openGpuScopes;
+
+	// default blend states
+	std::shared_ptr<IBlendState> _defaultBlendAdditive;
+	std::shared_ptr<IBlendState> _defaultBlendAlpha;
+	std::shared_ptr<IBlendState> _defaultBlendNonPremul;
+	std::shared_ptr<IBlendState> _defaultBlendOpaque;
+	// default rasterizer states
+	std::shared_ptr<IRasterizerState> _defaultRasterNone;
+	std::shared_ptr<IRasterizerState> _defaultRasterClockwise;
+	std::shared_ptr<IRasterizerState> _defaultRasterCounterClockwise;
+	// default depth states
+	std::shared_ptr<IDepthStencilState> _defaultDepthStencilDefault;
+	std::shared_ptr<IDepthStencilState> _defaultDepthStencilDepthRead;
+	std::shared_ptr<IDepthStencilState> _defaultDepthStencilNone;
+};
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __ciri_graphics_NullIndexBuffer__
+#define __ciri_graphics_NullIndexBuffer__
+
+#include <memory>
+#include <ciri/graphics/IIndexBuffer.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullIndexBuffer : public IIndexBuffer {
+public:
+	NullIndexBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullIndexBuffer();
+
+	virtual ErrorCode set( int* indices, int indexCount, bool dynamic ) override;
+	virtual void destroy() override;
+	virtual int getIndexCount() const override;
+	virtual IndexFormat::Format getFormat() const override;
+
+	int getId() const;
+	bool isCreated() const;
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _indexCount;
+	IndexFormat::Format _format;
+	bool _isDynamic;
+	bool _isCreated;
+};
+
+}
+
+#endif
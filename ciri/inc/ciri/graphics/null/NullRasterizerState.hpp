@@ -0,0 +1,26 @@
+#ifndef __ciri_graphics_NullRasterizerState__
+#define __ciri_graphics_NullRasterizerState__
+
+#include <ciri/graphics/IRasterizerState.hpp>
+
+namespace ciri {
+
+class NullRasterizerState : public IRasterizerState {
+public:
+	NullRasterizerState( int id );
+	virtual ~NullRasterizerState();
+
+	bool create( const RasterizerDesc& desc );
+	virtual void destroy() override;
+
+	const RasterizerDesc& getDesc() const;
+	int getId() const;
+
+private:
+	int _id;
+	RasterizerDesc _desc;
+};
+
+}
+
+#endif
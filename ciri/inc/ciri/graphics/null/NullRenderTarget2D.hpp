@@ -0,0 +1,33 @@
+#ifndef __ciri_graphics_NullRenderTarget2D__
+#define __ciri_graphics_NullRenderTarget2D__
+
+#include <memory>
+#include <ciri/graphics/IRenderTarget2D.hpp>
+
+namespace ciri {
+
+class NullTexture2D;
+
+class NullRenderTarget2D : public IRenderTarget2D {
+public:
+	NullRenderTarget2D( int id );
+	virtual ~NullRenderTarget2D();
+
+	bool create( const std::shared_ptr<NullTexture2D>& texture, const std::shared_ptr<NullTexture2D>& depthTexture );
+	virtual void destroy() override;
+
+	virtual std::shared_ptr<ITexture2D> getTexture() const override;
+	virtual std::shared_ptr<ITexture2D> getDepth() const override;
+	virtual std::future<TextureReadback> readAsync() override;
+
+	int getId() const;
+
+private:
+	int _id;
+	std::shared_ptr<NullTexture2D> _texture;
+	std::shared_ptr<NullTexture2D> _depthTexture;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __ciri_graphics_NullSamplerState__
+#define __ciri_graphics_NullSamplerState__
+
+#include <ciri/graphics/ISamplerState.hpp>
+
+namespace ciri {
+
+class NullSamplerState : public ISamplerState {
+public:
+	NullSamplerState( int id );
+	virtual ~NullSamplerState();
+
+	bool create( const SamplerDesc& desc );
+	virtual void destroy() override;
+
+	const SamplerDesc& getDesc() const;
+	int getId() const;
+
+private:
+	int _id;
+	SamplerDesc _desc;
+};
+
+}
+
+#endif
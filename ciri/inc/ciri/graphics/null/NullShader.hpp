@@ -0,0 +1,49 @@
+#ifndef __ciri_graphics_NullShader__
+#define __ciri_graphics_NullShader__
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <ciri/graphics/IShader.hpp>
+#include <ciri/graphics/VertexDeclaration.hpp>
+
+namespace ciri {
+
+class NullConstantBuffer;
+
+/**
+ * Shader that validates its sources exist but compiles nothing.  It is never pending.
+ */
+class NullShader : public IShader {
+public:
+	NullShader( int id );
+	virtual ~NullShader();
+
+	virtual void addInputElement( const VertexElement& element ) override;
+	virtual ErrorCode loadFromFile( const char* vs, const char* gs, const char* ps ) override;
+	virtual ErrorCode loadFromMemory( const char* vs, const char* gs, const char* ps ) override;
+	virtual ErrorCode addConstants( const std::shared_ptr<IConstantBuffer>& buffer, const char* name, int shaderTypeFlags ) override;
+	virtual void destroy() override;
+	virtual const std::vector<ShaderError>& getErrors() const override;
+	virtual bool isValid() const override;
+	virtual bool isPending() const override;
+	virtual ErrorCode wait() override;
+
+	const VertexDeclaration& getVertexDeclaration() const;
+	int getId() const;
+	const std::vector<std::shared_ptr<NullConstantBuffer>>& getConstants() const;
+
+private:
+	void addError( ErrorCode code, const std::string& msg );
+
+private:
+	int _id;
+	bool _isValid;
+	std::vector<ShaderError> _errors;
+	VertexDeclaration _vertexDeclaration;
+	std::vector<std::shared_ptr<NullConstantBuffer>> _constantBuffers;
+};
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __ciri_graphics_NullTexture2D__
+#define __ciri_graphics_NullTexture2D__
+
+#include <memory>
+#include <ciri/graphics/ITexture2D.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullTexture2D : public ITexture2D {
+public:
+	NullTexture2D( int id, int flags, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullTexture2D();
+
+	virtual void destroy() override;
+	virtual ErrorCode setData( int xOffset, int yOffset, int width, int height, void* data, TextureFormat::Format format ) override;
+
+	virtual int getWidth() const override;
+	virtual int getHeight() const override;
+	virtual TextureFormat::Format getFormat() const override;
+
+	virtual ErrorCode writeToTGA( const char* file ) override;
+	virtual ErrorCode writeToDDS( const char* file ) override;
+	virtual std::future<TextureReadback> readAsync() override;
+
+	int getId() const;
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _flags;
+	TextureFormat::Format _format;
+	int _width;
+	int _height;
+};
+
+}
+
+#endif
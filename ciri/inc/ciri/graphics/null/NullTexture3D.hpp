@@ -0,0 +1,41 @@
+#ifndef __ciri_graphics_NullTexture3D__
+#define __ciri_graphics_NullTexture3D__
+
+#include <memory>
+#include <ciri/graphics/ITexture3D.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullTexture3D : public ITexture3D {
+public:
+	NullTexture3D( int id, int flags, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullTexture3D();
+
+	virtual void destroy() override;
+	virtual ErrorCode setData( int width, int height, int depth, void* data, TextureFormat::Format format ) override;
+
+	virtual int getWidth() const override;
+	virtual int getHeight() const override;
+	virtual int getDepth() const override;
+	virtual TextureFormat::Format getFormat() const override;
+
+	virtual ErrorCode writeToTGA( const char* file ) override;
+	virtual ErrorCode writeToDDS( const char* file ) override;
+
+	int getId() const;
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _flags;
+	TextureFormat::Format _format;
+	int _width;
+	int _height;
+	int _depth;
+};
+
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __ciri_graphics_NullTextureCube__
+#define __ciri_graphics_NullTextureCube__
+
+#include <memory>
+#include <ciri/graphics/ITextureCube.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullTextureCube : public ITextureCube {
+public:
+	NullTextureCube( int id, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullTextureCube();
+
+	virtual ErrorCode set( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) override;
+	virtual void destroy() override;
+
+	int getId() const;
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _width;
+	int _height;
+};
+
+}
+
+#endif
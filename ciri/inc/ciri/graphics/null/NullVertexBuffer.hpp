@@ -0,0 +1,35 @@
+#ifndef __ciri_graphics_NullVertexBuffer__
+#define __ciri_graphics_NullVertexBuffer__
+
+#include <memory>
+#include <ciri/graphics/IVertexBuffer.hpp>
+
+namespace ciri {
+
+class NullGraphicsDevice;
+
+class NullVertexBuffer : public IVertexBuffer {
+public:
+	NullVertexBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device );
+	virtual ~NullVertexBuffer();
+
+	virtual ErrorCode set( void* vertices, int vertexStride, int vertexCount, bool dynamic ) override;
+	virtual void destroy() override;
+	virtual int getStride() const override;
+	virtual int getVertexCount() override;
+
+	int getId() const;
+	bool isCreated() const;
+
+private:
+	std::shared_ptr<NullGraphicsDevice> _device;
+	int _id;
+	int _vertexStride;
+	int _vertexCount;
+	bool _isDynamic;
+	bool _isCreated;
+};
+
+}
+
+#endif
@@ -206,6 +206,30 @@ static DXGI_FORMAT ciriToDxVertexFormat( VertexFormat format ) {
 			return DXGI_FORMAT_R32G32B32A32_FLOAT;
 		}
 
+		case VertexFormat::Half2: {
+			return DXGI_FORMAT_R16G16_FLOAT;
+		}
+
+		case VertexFormat::Half4: {
+			return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		}
+
+		case VertexFormat::UNorm8x4: {
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+
+		case VertexFormat::SNorm16x2: {
+			return DXGI_FORMAT_R16G16_SNORM;
+		}
+
+		case VertexFormat::SNorm16x4: {
+			return DXGI_FORMAT_R16G16B16A16_SNORM;
+		}
+
+		case VertexFormat::UNorm10_10_10_2: {
+			return DXGI_FORMAT_R10G10B10A2_UNORM;
+		}
+
 		default: {
 			throw; //return DXGI_FORMAT_UNKNOWN;
 		}
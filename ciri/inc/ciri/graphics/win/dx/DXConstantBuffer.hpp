@@ -2,30 +2,54 @@
 #define __ciri_graphics_DXConstantBuffer__
 
 #include <memory>
+#include <vector>
 #include <d3d11.h>
 #include <ciri/graphics/IConstantBuffer.hpp>
 
 namespace ciri {
 
 class DXGraphicsDevice;
+class DXConstantRing;
 
 class DXConstantBuffer : public IConstantBuffer {
 public:
-	DXConstantBuffer( const std::shared_ptr<DXGraphicsDevice>& device );
+	DXConstantBuffer( const std::shared_ptr<DXGraphicsDevice>& device, const std::shared_ptr<DXConstantRing>& ring );
 	virtual ~DXConstantBuffer();
 
 	virtual ErrorCode setData( int dataSize, void* data ) override;
 	virtual void destroy() override;
 
+	/**
+		* Copies the last data set into the ring again if the ring has wrapped since it was copied.  Called by the device before drawing.
+		* @returns True if the buffer must be bound again; false otherwise.
+		*/
+	bool refresh();
+
+	/**
+		* Gets the buffer to bind; the ring's buffer when the data lives in the ring.
+		*/
 	ID3D11Buffer* getBuffer() const;
+	bool isInRing() const;
+	UINT getFirstConstant() const;
+	UINT getNumConstants() const;
 
 	void setIndex( int val );
 	int getIndex() const;
 
+private:
+	bool writeRing();
+	ErrorCode writeOwn( int dataSize, const void* data );
+
 private:
 	std::shared_ptr<DXGraphicsDevice> _device;
+	std::shared_ptr<DXConstantRing> _ring;
 	ID3D11Buffer* _buffer;
 	int _index;
+	std::vector<unsigned char> _shadow; // last data set, kept while the data lives in the ring
+	bool _inRing;
+	unsigned int _ringEpoch;
+	UINT _firstConstant;
+	UINT _numConstants;
 };
 
 }
@@ -0,0 +1,62 @@
+#ifndef __ciri_graphics_DXConstantRing__
+#define __ciri_graphics_DXConstantRing__
+
+#include <d3d11_1.h>
+
+namespace ciri {
+
+/**
+ * One large dynamic constant buffer that constant updates are suballocated from and bound by offset with the D3D11.1 *SetConstantBuffers1 calls.
+ * Suballocations map with NO_OVERWRITE; when the buffer is full it is mapped with DISCARD and starts over, which lets the driver recycle
+ * the old contents once the gpu is done with them, so no fences are needed.  Each wrap changes the epoch, after which earlier data must be allocated again.
+ * Needs a D3D11.1 runtime and driver support for constant buffer offsetting; create fails without them.
+ */
+class DXConstantRing {
+public:
+	static const int ALIGNMENT = 256; /**< Offsets and sizes are multiples of 16 constants. */
+
+public:
+	DXConstantRing();
+	~DXConstantRing();
+
+	/**
+		* Creates the ring.
+		* @param device  Device to create the buffer with.
+		* @param context Immediate context; must support ID3D11DeviceContext1.
+		* @param size    Size of the buffer in bytes; rounded up to ALIGNMENT.
+		* @returns True if created; false if unsupported or out of memory.
+		*/
+	bool create( ID3D11Device* device, ID3D11DeviceContext* context, int size );
+
+	void destroy();
+
+	/**
+		* Copies data into the ring.
+		* @param data             Data to copy.
+		* @param dataSize         Size in bytes of the data.
+		* @param outFirstConstant Receives the offset of the data in 16 byte constants.
+		* @param outNumConstants  Receives the number of constants to bind.
+		* @returns True if copied; false if the ring is not created, the data is larger than the ring, or mapping failed.
+		*/
+	bool allocate( const void* data, int dataSize, UINT* outFirstConstant, UINT* outNumConstants );
+
+	/**
+		* Gets a number that changes whenever the ring wraps.
+		*/
+	unsigned int getEpoch() const;
+
+	ID3D11Buffer* getBuffer() const;
+	ID3D11DeviceContext1* getContext1() const;
+	bool isValid() const;
+
+private:
+	ID3D11Buffer* _buffer;
+	ID3D11DeviceContext1* _context1;
+	int _size;
+	int _head;
+	unsigned int _epoch;
+};
+
+}
+
+#endif
\ No newline at end of file
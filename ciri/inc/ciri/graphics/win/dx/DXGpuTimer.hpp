@@ -0,0 +1,88 @@
+#ifndef __ciri_graphics_DXGpuTimer__
+#define __ciri_graphics_DXGpuTimer__
+
+#include <vector>
+#include <d3d11.h>
+#include <ciri/core/Profiler.hpp>
+
+namespace ciri {
+
+/**
+ * Times gpu scopes with timestamp queries inside a timestamp disjoint query per frame, and reports them to the Profiler once the results are available.
+ * Each frame's queries are kept in one of FRAME_LATENCY slots; endFrame reads the oldest slots with DONOTFLUSH and resolves those that are done.
+ * Frames whose disjoint query reports a clock change are discarded, as are slots still unresolved when they come around again.
+ * There is no way to sample the gpu clock directly, so the frame's first timestamp is placed at the cpu time it was issued; gpu scopes therefore appear
+ * slightly early relative to the cpu scopes that issued them, by however far the gpu runs behind.
+ */
+class DXGpuTimer {
+public:
+	static const int FRAME_LATENCY = 4;
+
+public:
+	DXGpuTimer();
+	~DXGpuTimer();
+
+	/**
+		* Releases every query.
+		*/
+	void destroy();
+
+	/**
+		* Opens a scope in the current frame.  Does nothing while the profiler is disabled.
+		* @param device  Device to create queries with.
+		* @param context Immediate context to issue queries on.
+		* @param name    Name of the scope.
+		*/
+	void begin( ID3D11Device* device, ID3D11DeviceContext* context, const char* name );
+
+	/**
+		* Closes the most recently opened scope.
+		*/
+	void end( ID3D11Device* device, ID3D11DeviceContext* context );
+
+	/**
+		* Moves to the next frame and reports every earlier frame whose queries have finished.  Call once per frame after presenting.
+		* Scopes still open are abandoned; scopes must not span a present.
+		*/
+	void endFrame( ID3D11DeviceContext* context );
+
+	/**
+		* Gets the number of frames dropped because their results were not ready in time or were disjoint.
+		*/
+	int getDroppedFrames() const;
+
+private:
+	struct Scope {
+		const char* name;
+		int depth;
+		ID3D11Query* beginQuery;
+		ID3D11Query* endQuery;
+	};
+
+	struct Frame {
+		std::vector<Scope> scopes;
+		ID3D11Query* disjoint;
+		ID3D11Query* anchor;  /**< Timestamp issued alongside cpuTime. */
+		long long cpuTime;
+		bool pending;
+
+		Frame();
+	};
+
+private:
+	ID3D11Query* acquireQuery( ID3D11Device* device );
+	void releaseQueries( Frame& frame );
+	bool tryResolveFrame( ID3D11DeviceContext* context, Frame& frame, bool* outDisjoint );
+
+private:
+	Frame _frames[FRAME_LATENCY];
+	int _current;
+	std::vector<int> _open; /**< Scopes open in the current frame, or -1 for those begun while disabled. */
+	std::vector<ID3D11Query*> _freeQueries;
+	std::vector<ProfileEvent> _events;
+	int _droppedFrames;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -5,11 +5,18 @@
 #include <string>
 #include <d3d11.h>
 #include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/graphics/GraphicsStateCache.hpp>
+#include <ciri/graphics/PipelineStateCache.hpp>
+#include <ciri/graphics/CommandList.hpp>
+#include <ciri/graphics/ShaderCache.hpp>
 #include "DXShader.hpp"
 #include "DXVertexBuffer.hpp"
 #include "DXIndexBuffer.hpp"
 #include "DXRasterizerState.hpp"
 #include "DXDepthStencilState.hpp"
+#include "DXConstantRing.hpp"
+#include "DXReadbackRing.hpp"
+#include "DXGpuTimer.hpp"
 
 namespace ciri {
 
@@ -28,6 +35,8 @@ public:
 	virtual std::shared_ptr<IVertexBuffer> createVertexBuffer() override;
 	virtual std::shared_ptr<IIndexBuffer> createIndexBuffer() override;
 	virtual std::shared_ptr<IConstantBuffer> createConstantBuffer() override;
+	virtual void setConstantRingSize( int bytesPerFrame ) override;
+	virtual bool setShaderCacheDirectory( const char* directory ) override;
 	virtual std::shared_ptr<ITexture2D> createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
 	virtual std::shared_ptr<ITexture3D> createTexture3D( int width, int height, int depth, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
 	virtual std::shared_ptr<ITextureCube> createTextureCube( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) override;
@@ -36,8 +45,15 @@ public:
 	virtual std::shared_ptr<IRasterizerState> createRasterizerState( const RasterizerDesc& desc ) override;
 	virtual std::shared_ptr<IDepthStencilState> createDepthStencilState( const DepthStencilDesc& desc ) override;
 	virtual std::shared_ptr<IBlendState> createBlendState( const BlendDesc& desc ) override;
+	virtual std::shared_ptr<IPipelineState> createPipelineState( const PipelineDesc& desc ) override;
+	virtual std::shared_ptr<ICommandList> createCommandList() override;
 	virtual void applyShader( const std::shared_ptr<IShader>& shader ) override;
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state ) override;
+	virtual void executeCommandLists( ICommandList** lists, int count ) override;
+	virtual void beginGpuScope( const char* name ) override;
+	virtual void endGpuScope() override;
 	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) override;
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) override;
 	virtual void setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) override;
 	virtual void setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) override;
 	virtual void setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) override;
@@ -45,7 +61,9 @@ public:
 	virtual void setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) override;
 	virtual void setBlendState( const std::shared_ptr<IBlendState>& state ) override;
 	virtual void drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) override;
-	virtual void drawIndexed( PrimitiveTopology topology, int indexCount ) override;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) override;
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) override;
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) override;
 	virtual void setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) override;
 	virtual void restoreDefaultRenderTargets() override;
 	virtual ErrorCode resize() override;
@@ -63,6 +81,10 @@ public:
 	virtual const char* getGpuName() const override;
 	virtual const char* getApiInfo() const override;
 	virtual GraphicsApiType getApiType() const override;
+	virtual int getRedundantCallCount() const override;
+	virtual int getStateChangeCount() const override;
+	virtual int getVertexAttributeSetupCount() const override;
+	virtual int getVertexInputBindCount() const override;
 	virtual ErrorCode restoreDefaultStates() override;
 	virtual ErrorCode restoreDefaultBlendState() override;
 	virtual ErrorCode restoreDefaultRasterizerState() override;
@@ -81,7 +103,26 @@ public:
 	ID3D11Device* getDevice() const;
 	ID3D11DeviceContext* getContext() const;
 
+	/**
+		* Marks the active shader's constant buffers for binding again before the next draw, e.g. because one moved within the constant ring.
+		*/
+	void invalidateConstants();
+
+	/**
+		* Gets the staging textures that texture readbacks are copied into; polled by present.
+		*/
+	DXReadbackRing& getReadbackRing();
+
+	/**
+		* Gets the cache shaders store their bytecode in.
+		*/
+	ShaderCache& getShaderCache();
+
 private:
+	void setShaderResource( int index, ID3D11ShaderResourceView** srv, const std::shared_ptr<void>& texture, ShaderStage::Stage shaderStage );
+	void prepareConstants();
+	void bindConstants( const DXShader& shader );
+	void bindConstantBuffer( ShaderStage::Stage stage, const DXConstantBuffer& buffer );
 	bool initDevice( unsigned int width, unsigned int height, HWND hwnd );
 	bool createBackbufferRtv();
 	bool createDepthStencilView();
@@ -105,14 +146,18 @@ private:
 	//
 	std::weak_ptr<DXShader> _activeShader;
 	std::weak_ptr<DXVertexBuffer> _activeVertexBuffer;
+	ID3D11Buffer* _activeVertexStreams[VertexDeclaration::MAX_STREAMS]; /**< Buffers bound to slots 1 and up; slot 0 goes through the state cache. */
 	std::weak_ptr<DXIndexBuffer> _activeIndexBuffer;
-	//
-	std::weak_ptr<DXRasterizerState> _activeRasterizerState;
-	//
-	std::weak_ptr<DXDepthStencilState> _activeDepthStencilState;
+	GraphicsStateCache _stateCache;
+	PipelineStateCache _pipelineCache;
 	ID3D11Texture2D* _depthStencil;
 	ID3D11DepthStencilView* _depthStencilView;
 	ID3D11RenderTargetView* _activeRenderTargets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+	std::shared_ptr<DXConstantRing> _constantRing; /**< Shared with every constant buffer; invalid when disabled or unsupported. */
+	bool _constantsDirty;
+	DXReadbackRing _readbackRing;
+	DXGpuTimer _gpuTimer;
+	ShaderCache _shaderCache;
 	//
 	std::string _shaderExt;
 	//
@@ -17,6 +17,7 @@ public:
 	virtual ErrorCode set( int* indices, int indexCount, bool dynamic ) override;
 	virtual void destroy() override;
 	virtual int getIndexCount() const override;
+	virtual IndexFormat::Format getFormat() const override;
 
 	ID3D11Buffer* getIndexBuffer() const;
 
@@ -24,6 +25,7 @@ private:
 	std::shared_ptr<DXGraphicsDevice> _device;
 	ID3D11Buffer* _indexBuffer;
 	int _indexCount;
+	IndexFormat::Format _format;
 };
 
 }
@@ -0,0 +1,78 @@
+#ifndef __ciri_graphics_DXReadbackRing__
+#define __ciri_graphics_DXReadbackRing__
+
+#include <vector>
+#include <future>
+#include <d3d11.h>
+#include <ciri/graphics/TextureFormat.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
+
+namespace ciri {
+
+/**
+ * Staging textures that texture readbacks are copied into without waiting on the gpu.
+ * poll maps each copy with DO_NOT_WAIT and hands the ones that are finished to the worker for conversion; the rest are tried again next frame.
+ * Staging textures are kept and reused for later reads of the same size and format.
+ */
+class DXReadbackRing {
+public:
+	DXReadbackRing();
+	~DXReadbackRing();
+
+	/**
+		* Fails every read still in flight, then releases the staging textures and stops the worker.
+		*/
+	void destroy();
+
+	/**
+		* Issues a copy of the top mip of a texture into a staging texture.
+		* @param device  Device to create staging textures with.
+		* @param context Immediate context to copy with.
+		* @param texture Texture to read.
+		* @param format  Format of the texture.
+		* @param width   Width of the texture in pixels.
+		* @param height  Height of the texture in pixels.
+		* @returns Future resolved by the worker after a later poll finds the copy finished.
+		*/
+	std::future<TextureReadback> read( ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture, TextureFormat::Format format, int width, int height );
+
+	/**
+		* Maps finished copies and queues them for conversion.  Call once per frame.
+		* @param context Immediate context the copies were issued on.
+		* @param wait    If true, waits for every copy instead of skipping unfinished ones.
+		*/
+	void poll( ID3D11DeviceContext* context, bool wait=false );
+
+	/**
+		* Gets the number of reads waiting on the gpu.
+		*/
+	int getPendingCount() const;
+
+	/**
+		* Chooses how a format is converted after being copied back.
+		* @returns False if the format cannot be read back.
+		*/
+	static bool getReadFormat( TextureFormat::Format format, PixelConversion::Source* outSource, int* outShift );
+
+private:
+	struct Slot {
+		ID3D11Texture2D* staging;
+		D3D11_TEXTURE2D_DESC desc;
+		bool busy;
+		ReadbackJob job;
+
+		Slot();
+	};
+
+private:
+	int acquireSlot( ID3D11Device* device, const D3D11_TEXTURE2D_DESC& desc );
+
+private:
+	std::vector<Slot> _slots;
+	ReadbackWorker _worker;
+	int _pending;
+};
+
+}
+
+#endif
\ No newline at end of file
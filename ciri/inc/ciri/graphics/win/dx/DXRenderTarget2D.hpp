@@ -20,6 +20,7 @@ public:
 
 	virtual std::shared_ptr<ITexture2D> getTexture() const override;
 	virtual std::shared_ptr<ITexture2D> getDepth() const override;
+	virtual std::future<TextureReadback> readAsync() override;
 
 	ID3D11RenderTargetView* getRenderTargetView() const;
 
@@ -2,6 +2,7 @@
 #define __ciri_graphics_DXShader__
 
 #include <memory>
+#include <future>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -14,6 +15,10 @@ namespace ciri {
 class DXGraphicsDevice;
 class DXConstantBuffer;
 
+/**
+ * Bytecode is first looked up in the device's shader cache.  On a miss the stages are compiled with D3DCompile on a worker thread, and the
+ * shader objects, input layout, and reflection are created on the device's thread once the shader is waited on, which is also when the bytecode is stored.
+ */
 class DXShader : public IShader {
 public:
 	DXShader( const std::shared_ptr<DXGraphicsDevice>& device );
@@ -26,6 +31,8 @@ public:
 	virtual void destroy() override;
 	virtual const std::vector<ShaderError>& getErrors() const override;
 	virtual bool isValid() const override;
+	virtual bool isPending() const override;
+	virtual ErrorCode wait() override;
 
 	ID3D11VertexShader* getVertexShader() const;
 	ID3D11GeometryShader* getGeometryShader() const;
@@ -36,13 +43,38 @@ public:
 	const std::vector<std::shared_ptr<DXConstantBuffer>>& getGeometryConstants() const;
 	const std::vector<std::shared_ptr<DXConstantBuffer>>& getPixelConstants() const;
 
+private:
+	struct CompiledStages {
+		std::vector<char> vs;
+		std::vector<char> gs; /**< Empty without a geometry shader. */
+		std::vector<char> ps;
+		std::vector<ShaderError> errors; /**< Compiler output only; the error string is prefixed on the device's thread. */
+	};
+
+	struct DeferredConstants {
+		std::shared_ptr<IConstantBuffer> buffer;
+		std::string name;
+		int shaderTypeFlags;
+	};
+
 private:
 	void addError( ErrorCode code, const std::string& msg );
 	void clearErrors();
+	static CompiledStages compileStages( const std::string& vs, const std::string& gs, const std::string& ps, UINT flags );
+	static bool compileStage( const std::string& source, const char* target, UINT flags, std::vector<char>& outBytecode, std::vector<ShaderError>& outErrors );
+	static std::vector<char> packStages( const CompiledStages& stages );
+	static bool unpackStages( const std::vector<char>& data, CompiledStages& outStages );
+	ErrorCode createStages( const CompiledStages& stages );
+	void reflectConstants( const std::vector<char>& bytecode, std::unordered_map<std::string, int>& outIndices );
+	void finish( const CompiledStages& stages );
 
 private:
 	std::shared_ptr<DXGraphicsDevice> _device;
 	//
+	unsigned long long _cacheKey;
+	std::shared_future<CompiledStages> _compile; /**< Valid from a load that missed the cache until the shader is waited on. */
+	std::vector<DeferredConstants> _deferredConstants;
+	//
 	ID3D11VertexShader* _vertexShader;
 	ID3D11GeometryShader* _geometryShader;
 	ID3D11PixelShader* _pixelShader;
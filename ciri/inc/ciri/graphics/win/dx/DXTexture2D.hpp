@@ -23,6 +23,7 @@ public:
 
 	virtual ErrorCode writeToTGA( const char* file ) override;
 	virtual ErrorCode writeToDDS( const char* file ) override;
+	virtual std::future<TextureReadback> readAsync() override;
 
 	ID3D11Texture2D* getTexture() const;
 	ID3D11ShaderResourceView* getShaderResourceView() const;
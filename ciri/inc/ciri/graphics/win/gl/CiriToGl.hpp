@@ -10,6 +10,7 @@
 #include <ciri/graphics/PrimitiveTopology.hpp>
 #include <ciri/graphics/BlendMode.hpp>
 #include <ciri/graphics/BlendFunction.hpp>
+#include <ciri/graphics/VertexFormat.hpp>
 
 namespace ciri {
 
@@ -267,6 +268,84 @@ static GLenum ciriToGlTopology( PrimitiveTopology topology ) {
 	}
 }
 
+static void ciriToGlVertexFormat( VertexFormat format, GLint* outSize, GLenum* outType, GLboolean* outNormalized ) {
+	switch( format ) {
+		case VertexFormat::Float: {
+			*outSize = 1;
+			*outType = GL_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::Float2: {
+			*outSize = 2;
+			*outType = GL_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::Float3: {
+			*outSize = 3;
+			*outType = GL_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::Float4: {
+			*outSize = 4;
+			*outType = GL_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::Half2: {
+			*outSize = 2;
+			*outType = GL_HALF_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::Half4: {
+			*outSize = 4;
+			*outType = GL_HALF_FLOAT;
+			*outNormalized = GL_FALSE;
+			break;
+		}
+
+		case VertexFormat::UNorm8x4: {
+			*outSize = 4;
+			*outType = GL_UNSIGNED_BYTE;
+			*outNormalized = GL_TRUE;
+			break;
+		}
+
+		case VertexFormat::SNorm16x2: {
+			*outSize = 2;
+			*outType = GL_SHORT;
+			*outNormalized = GL_TRUE;
+			break;
+		}
+
+		case VertexFormat::SNorm16x4: {
+			*outSize = 4;
+			*outType = GL_SHORT;
+			*outNormalized = GL_TRUE;
+			break;
+		}
+
+		case VertexFormat::UNorm10_10_10_2: {
+			*outSize = 4;
+			*outType = GL_UNSIGNED_INT_2_10_10_10_REV;
+			*outNormalized = GL_TRUE;
+			break;
+		}
+
+		default: {
+			throw;
+		}
+	}
+}
+
 static GLenum ciriToGlBlendMode( BlendMode mode, bool alpha ) {
 	switch( mode ) {
 		case BlendMode::One: {
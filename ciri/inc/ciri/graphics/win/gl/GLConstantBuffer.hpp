@@ -1,25 +1,42 @@
 #ifndef __ciri_graphics_GLConstantBuffer__
 #define __ciri_graphics_GLConstantBuffer__
 
+#include <memory>
+#include <vector>
 #include <GL/glew.h>
 #include <ciri/graphics/IConstantBuffer.hpp>
 
 namespace ciri {
 
+class GLConstantRing;
+
 class GLConstantBuffer : public IConstantBuffer {
 public:
-	GLConstantBuffer( GLuint index );
+	GLConstantBuffer( GLuint index, const std::shared_ptr<GLConstantRing>& ring );
 	virtual ~GLConstantBuffer();
 
 	virtual ErrorCode setData( int dataSize, void* data ) override;
 	virtual void destroy() override;
 
+	/**
+		* Copies the last data set into the ring again if its previous copy was from an earlier frame.  Called by the device before drawing.
+		*/
+	void refresh();
+
 	GLuint getUbo() const;
 	GLuint getIndex() const;
 
+private:
+	bool writeRing();
+	ErrorCode writeOwn( int dataSize, const void* data );
+
 private:
 	GLuint _ubo;
 	GLuint _index;
+	std::shared_ptr<GLConstantRing> _ring;
+	std::vector<unsigned char> _shadow; // last data set, kept while the data lives in the ring
+	bool _inRing;
+	unsigned int _ringFrame;
 };
 
 }
@@ -0,0 +1,70 @@
+#ifndef __ciri_graphics_GLConstantRing__
+#define __ciri_graphics_GLConstantRing__
+
+#include <GL/glew.h>
+
+namespace ciri {
+
+/**
+ * One persistently mapped uniform buffer split into per-frame segments.
+ * Constant updates are copied into the current segment and bound with glBindBufferRange, so no update waits on the driver renaming a buffer.
+ * Each segment is fenced when its frame ends and waited on before it is written again, SEGMENT_COUNT frames later.
+ * Needs ARB_buffer_storage; create fails without it and callers keep using their own buffers.
+ */
+class GLConstantRing {
+public:
+	static const int SEGMENT_COUNT = 3;
+
+public:
+	GLConstantRing();
+	~GLConstantRing();
+
+	/**
+		* Creates the ring.  Must be called with the owning context current.
+		* @param bytesPerFrame Size of each segment; rounded up to the uniform buffer offset alignment.
+		* @returns True if created; false if unsupported or out of memory.
+		*/
+	bool create( int bytesPerFrame );
+
+	/**
+		* Unmaps and deletes the ring.  Must be called with the owning context current.
+		*/
+	void destroy();
+
+	/**
+		* Copies data into the current segment.
+		* @param data      Data to copy.
+		* @param dataSize  Size in bytes of the data.
+		* @param outOffset Receives the offset of the data in the ring's buffer.
+		* @param outSize   Receives the aligned size to bind.
+		* @returns True if copied; false if the segment is full or the ring is not created.
+		*/
+	bool allocate( const void* data, int dataSize, GLintptr* outOffset, GLsizeiptr* outSize );
+
+	/**
+		* Fences the current segment and moves to the next, waiting for the GPU to finish with it first.  Call once per frame after presenting.
+		*/
+	void endFrame();
+
+	/**
+		* Gets a number that changes whenever a frame ends.  Data allocated in an earlier frame must be allocated again before use.
+		*/
+	unsigned int getFrame() const;
+
+	GLuint getUbo() const;
+	bool isValid() const;
+
+private:
+	GLuint _ubo;
+	unsigned char* _mapped;
+	int _alignment;
+	int _segmentSize;
+	int _segment;
+	int _head;
+	unsigned int _frame;
+	GLsync _fences[SEGMENT_COUNT];
+};
+
+}
+
+#endif
\ No newline at end of file
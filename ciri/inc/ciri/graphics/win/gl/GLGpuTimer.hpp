@@ -0,0 +1,85 @@
+#ifndef __ciri_graphics_GLGpuTimer__
+#define __ciri_graphics_GLGpuTimer__
+
+#include <vector>
+#include <GL/glew.h>
+#include <ciri/core/Profiler.hpp>
+
+namespace ciri {
+
+/**
+ * Times gpu scopes with GL_TIMESTAMP queries and reports them to the Profiler once the results are available.
+ * Each frame's queries are kept in one of FRAME_LATENCY slots; endFrame checks the oldest slots without blocking and resolves those that are done.
+ * A slot still unresolved when it comes around again is dropped rather than waited on.
+ * GPU times are moved onto the cpu clock by sampling GL_TIMESTAMP alongside Profiler::now at the frame's first scope.
+ */
+class GLGpuTimer {
+public:
+	static const int FRAME_LATENCY = 4;
+
+public:
+	GLGpuTimer();
+	~GLGpuTimer();
+
+	/**
+		* Deletes every query.  Must be called with the owning context current.
+		*/
+	void destroy();
+
+	/**
+		* Opens a scope in the current frame.  Does nothing while the profiler is disabled or timer queries are unsupported.
+		*/
+	void begin( const char* name );
+
+	/**
+		* Closes the most recently opened scope.
+		*/
+	void end();
+
+	/**
+		* Moves to the next frame and reports every earlier frame whose queries have finished.  Call once per frame after presenting.
+		* Scopes still open are abandoned; scopes must not span a present.
+		*/
+	void endFrame();
+
+	/**
+		* Gets the number of frames dropped because their results were not ready in time.
+		*/
+	int getDroppedFrames() const;
+
+private:
+	struct Scope {
+		const char* name;
+		int depth;
+		GLuint beginQuery;
+		GLuint endQuery;
+	};
+
+	struct Frame {
+		std::vector<Scope> scopes;
+		long long cpuTime; /**< Profiler::now when gpuTime was sampled. */
+		GLint64 gpuTime;
+		GLuint lastQuery;  /**< Most recently issued query; finishes after every other. */
+		bool pending;
+
+		Frame();
+	};
+
+private:
+	GLuint acquireQuery();
+	void releaseQueries( Frame& frame );
+	bool isFrameReady( const Frame& frame ) const;
+	void resolveFrame( Frame& frame );
+
+private:
+	Frame _frames[FRAME_LATENCY];
+	int _current;
+	std::vector<int> _open; /**< Scopes open in the current frame, or -1 for those begun while disabled. */
+	std::vector<GLuint> _freeQueries;
+	std::vector<ProfileEvent> _events;
+	int _droppedFrames;
+};
+
+}
+
+#endif
\ No newline at end of file
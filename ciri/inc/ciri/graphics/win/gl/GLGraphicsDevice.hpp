@@ -9,11 +9,19 @@
 #include <GL/GL.h>
 #include <GL/GLU.h>
 #include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/graphics/GraphicsStateCache.hpp>
+#include <ciri/graphics/PipelineStateCache.hpp>
+#include <ciri/graphics/CommandList.hpp>
+#include <ciri/graphics/ShaderCache.hpp>
 #include "GLShader.hpp"
 #include "GLVertexBuffer.hpp"
 #include "GLIndexBuffer.hpp"
 #include "GLRasterizerState.hpp"
 #include "GLDepthStencilState.hpp"
+#include "GLVertexArrayCache.hpp"
+#include "GLConstantRing.hpp"
+#include "GLReadbackRing.hpp"
+#include "GLGpuTimer.hpp"
 
 namespace ciri {
 
@@ -32,6 +40,8 @@ public:
 	virtual std::shared_ptr<IVertexBuffer> createVertexBuffer() override;
 	virtual std::shared_ptr<IIndexBuffer> createIndexBuffer() override;
 	virtual std::shared_ptr<IConstantBuffer> createConstantBuffer() override;
+	virtual void setConstantRingSize( int bytesPerFrame ) override;
+	virtual bool setShaderCacheDirectory( const char* directory ) override;
 	virtual std::shared_ptr<ITexture2D> createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
 	virtual std::shared_ptr<ITexture3D> createTexture3D( int width, int height, int depth, TextureFormat::Format format, int flags, void* pixels=nullptr ) override;
 	virtual std::shared_ptr<ITextureCube> createTextureCube( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) override;
@@ -40,8 +50,15 @@ public:
 	virtual std::shared_ptr<IRasterizerState> createRasterizerState( const RasterizerDesc& desc ) override;
 	virtual std::shared_ptr<IDepthStencilState> createDepthStencilState( const DepthStencilDesc& desc ) override;
 	virtual std::shared_ptr<IBlendState> createBlendState( const BlendDesc& desc ) override;
+	virtual std::shared_ptr<IPipelineState> createPipelineState( const PipelineDesc& desc ) override;
+	virtual std::shared_ptr<ICommandList> createCommandList() override;
 	virtual void applyShader( const std::shared_ptr<IShader>& shader ) override;
+	virtual void applyPipelineState( const std::shared_ptr<IPipelineState>& state ) override;
+	virtual void executeCommandLists( ICommandList** lists, int count ) override;
+	virtual void beginGpuScope( const char* name ) override;
+	virtual void endGpuScope() override;
 	virtual void setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) override;
+	virtual void setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) override;
 	virtual void setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) override;
 	virtual void setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) override;
 	virtual void setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) override;
@@ -49,7 +66,9 @@ public:
 	virtual void setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) override;
 	virtual void setBlendState( const std::shared_ptr<IBlendState>& state ) override;
 	virtual void drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) override;
-	virtual void drawIndexed( PrimitiveTopology topology, int indexCount ) override;
+	virtual void drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) override;
+	virtual void drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) override;
+	virtual void drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) override;
 	virtual void setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) override;
 	virtual void restoreDefaultRenderTargets() override;
 	virtual ErrorCode resize() override;
@@ -67,6 +86,10 @@ public:
 	virtual const char* getGpuName() const override;
 	virtual const char* getApiInfo() const override;
 	virtual GraphicsApiType getApiType() const override;
+	virtual int getRedundantCallCount() const override;
+	virtual int getStateChangeCount() const override;
+	virtual int getVertexAttributeSetupCount() const override;
+	virtual int getVertexInputBindCount() const override;
 	virtual ErrorCode restoreDefaultStates() override;
 	virtual ErrorCode restoreDefaultBlendState() override;
 	virtual ErrorCode restoreDefaultRasterizerState() override;
@@ -83,8 +106,12 @@ public:
 	virtual std::shared_ptr<IDepthStencilState> getDefaultDepthStencilNone() override;
 
 private:
+	bool prepareVertexArray();
+	void refreshConstants();
+	void bindVertexStream( int slot, const std::shared_ptr<IVertexBuffer>& buffer );
 	bool configureGl( HWND hwnd );
 	bool configureGlew();
+	void configureParallelShaderCompile();
 	// opengl debug messages
 	static void APIENTRY debugContextCb( GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam );
 	static void APIENTRY debugContextAmdCb( GLuint id, GLenum category, GLenum severity, GLsizei length, const GLchar* message, void* userParam );
@@ -103,17 +130,18 @@ private:
 	Viewport _activeViewport;
 	//
 	std::weak_ptr<GLShader> _activeShader;
-	std::weak_ptr<GLVertexBuffer> _activeVertexBuffer;
+	std::weak_ptr<GLVertexBuffer> _activeVertexBuffers[VertexDeclaration::MAX_STREAMS];
 	std::weak_ptr<GLIndexBuffer> _activeIndexBuffer;
+	GraphicsStateCache _stateCache;
+	PipelineStateCache _pipelineCache;
+	GLVertexArrayCache _vertexArrays;
+	bool _vertexArrayDirty;
+	size_t _activeLayout;
 	//
 	GLuint _currentFbo;
 	const static int MAX_MRTS{8};
 	GLenum _drawBuffers[MAX_MRTS];
 	//
-	std::weak_ptr<GLRasterizerState> _activeRasterizerState;
-	//
-	std::weak_ptr<GLDepthStencilState> _activeDepthStencilState;
-	//
 	std::string _shaderExt;
 	//
 	std::string _gpuName;
@@ -122,6 +150,11 @@ private:
 	GLuint _dummyVao;
 	//
 	int _constantBufferCount;
+	std::shared_ptr<GLConstantRing> _constantRing; /**< Shared with every constant buffer; invalid when disabled or unsupported. */
+	std::shared_ptr<GLReadbackRing> _readbackRing; /**< Shared with every 2d texture; polled by present. */
+	GLGpuTimer _gpuTimer;
+	std::shared_ptr<ShaderCache> _shaderCache; /**< Shared with every shader. */
+	bool _parallelShaderCompile; /**< KHR or ARB_parallel_shader_compile is supported. */
 
 	// default blend states
 	std::shared_ptr<IBlendState> _defaultBlendAdditive;
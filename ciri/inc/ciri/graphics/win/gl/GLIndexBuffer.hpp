@@ -14,12 +14,21 @@ public:
 	virtual ErrorCode set( int* indices, int indexCount, bool dynamic ) override;
 	virtual void destroy() override;
 	virtual int getIndexCount() const override;
+	virtual IndexFormat::Format getFormat() const override;
 
 	GLuint getEvbo() const;
 
+	/**
+		* Gets a number that changes every time the underlying GL object is recreated.
+		* GL recycles names, so this is what tells the device's state cache that a recreated object is no longer bound.
+		*/
+	unsigned int getRevision() const;
+
 private:
 	GLuint _evbo;
+	unsigned int _revision;
 	int _indexCount;
+	IndexFormat::Format _format;
 };
 
 }
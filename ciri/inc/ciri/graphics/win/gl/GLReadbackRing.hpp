@@ -0,0 +1,75 @@
+#ifndef __ciri_graphics_GLReadbackRing__
+#define __ciri_graphics_GLReadbackRing__
+
+#include <vector>
+#include <future>
+#include <GL/glew.h>
+#include <ciri/graphics/TextureFormat.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
+
+namespace ciri {
+
+/**
+ * Pixel pack buffers that texture readbacks are copied into without waiting on the gpu.
+ * Each read is followed by a fence; poll maps the buffers whose fences have signaled and hands their contents to the worker for conversion.
+ * Buffers are reused once mapped, so a steady stream of same sized reads (e.g. capturing every frame) allocates nothing after the first few frames.
+ */
+class GLReadbackRing {
+public:
+	GLReadbackRing();
+	~GLReadbackRing();
+
+	/**
+		* Fails every read still in flight, then deletes the buffers and stops the worker.  Must be called with the owning context current.
+		*/
+	void destroy();
+
+	/**
+		* Issues a copy of a texture into a pixel pack buffer.
+		* @param textureId Texture to read.
+		* @param format    Format of the texture.
+		* @param width     Width of the texture in pixels.
+		* @param height    Height of the texture in pixels.
+		* @returns Future resolved by the worker after a later poll finds the copy finished.
+		*/
+	std::future<TextureReadback> read( GLuint textureId, TextureFormat::Format format, int width, int height );
+
+	/**
+		* Maps finished copies and queues them for conversion without blocking.  Call once per frame.
+		*/
+	void poll();
+
+	/**
+		* Gets the number of reads waiting on the gpu.
+		*/
+	int getPendingCount() const;
+
+	/**
+		* Chooses how a format is read with glReadPixels and converted afterwards.
+		* Depth is always read as GL_UNSIGNED_INT, which gl normalizes regardless of the internal depth format.
+		*/
+	static void getReadFormat( TextureFormat::Format format, GLenum* outPixelFormat, GLenum* outPixelType, PixelConversion::Source* outSource, int* outShift );
+
+private:
+	struct Slot {
+		GLuint pbo;
+		GLsizeiptr capacity;
+		GLsync fence;
+		ReadbackJob job;
+
+		Slot();
+	};
+
+private:
+	int acquireSlot( GLsizeiptr size );
+
+private:
+	std::vector<Slot> _slots;
+	GLuint _fbo;
+	ReadbackWorker _worker;
+	int _pending;
+};
+
+}
+
+#endif
\ No newline at end of file
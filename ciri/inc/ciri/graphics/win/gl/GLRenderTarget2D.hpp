@@ -19,6 +19,7 @@ public:
 
 	virtual std::shared_ptr<ITexture2D> getTexture() const override;
 	virtual std::shared_ptr<ITexture2D> getDepth() const override;
+	virtual std::future<TextureReadback> readAsync() override;
 
 private:
 	std::shared_ptr<GLTexture2D> _texture;
@@ -7,14 +7,27 @@
 #include <GL/glew.h>
 #include <ciri/graphics/IShader.hpp>
 #include <ciri/graphics/VertexDeclaration.hpp>
+#include <ciri/graphics/ShaderCache.hpp>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+	#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+	#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace ciri {
 
 class IConstantBuffer;
+class GLConstantBuffer;
 
+/**
+ * Programs are first looked up in the shader cache as a glProgramBinary.  On a miss the stages are compiled and linked without querying any status,
+ * so drivers that compile in the background (and any that support KHR_parallel_shader_compile) can keep going while loading continues;
+ * the statuses are checked, the binary stored, and deferred constants attached once the shader is first waited on.
+ * Without parallel compile support there is no way to ask whether compiling has finished, so isValid waits for it.
+ */
 class GLShader : public IShader {
 public:
-	GLShader();
+	GLShader( const std::shared_ptr<ShaderCache>& cache, bool parallelCompile );
 	virtual ~GLShader();
 
 	virtual void addInputElement( const VertexElement& element ) override;
@@ -24,19 +37,41 @@ public:
 	virtual void destroy() override;
 	virtual const std::vector<ShaderError>& getErrors() const override;
 	virtual bool isValid() const override;
+	virtual bool isPending() const override;
+	virtual ErrorCode wait() override;
 
 	GLuint getVertexShader() const;
 	GLuint getGeometryShader() const;
 	GLuint getPixelShader() const;
 	GLuint getProgram() const;
 	const VertexDeclaration& getVertexDeclaration() const;
+	const std::vector<std::shared_ptr<GLConstantBuffer>>& getConstants() const;
 
 private:
 	void addError( ErrorCode code, const std::string& msg );
 	void clearErrors();
 	void processUniforms();
+	GLuint compileStage( GLenum type, const char* source ) const;
+	void checkStage( GLuint shader );
+	bool loadFromCache();
+	void storeInCache();
+	void finish();
+	bool isCompileFinished() const;
+
+private:
+	struct DeferredConstants {
+		std::shared_ptr<IConstantBuffer> buffer;
+		std::string name;
+		int shaderTypeFlags;
+	};
 
 private:
+	std::shared_ptr<ShaderCache> _cache;
+	bool _parallelCompile;
+	unsigned long long _cacheKey;
+	bool _pending; /**< Compiled and linked, but statuses not yet checked. */
+	std::vector<DeferredConstants> _deferredConstants;
+	//
 	GLuint _vertexShader;
 	GLuint _geometryShader;
 	GLuint _pixelShader;
@@ -45,6 +80,8 @@ private:
 	std::vector<ShaderError> _errors;
 	//
 	VertexDeclaration _vertexDeclaration;
+	//
+	std::vector<std::shared_ptr<GLConstantBuffer>> _constantBuffers;
 };
 
 }
@@ -1,14 +1,17 @@
 #ifndef __ciri_graphics_GLTexture2D__
 #define __ciri_graphics_GLTexture2D__
 
+#include <memory>
 #include <GL/glew.h>
 #include <ciri/graphics/ITexture2D.hpp>
 
 namespace ciri {
 
+class GLReadbackRing;
+
 class GLTexture2D : public ITexture2D {
 public:
-	GLTexture2D( int flags );
+	GLTexture2D( int flags, const std::shared_ptr<GLReadbackRing>& readback );
 	virtual ~GLTexture2D();
 
 	virtual void destroy() override;
@@ -20,13 +23,22 @@ public:
 
 	virtual ErrorCode writeToTGA( const char* file ) override;
 	virtual ErrorCode writeToDDS( const char* file ) override;
+	virtual std::future<TextureReadback> readAsync() override;
 
 	GLuint getTextureId() const;
 
+	/**
+		* Gets a number that changes every time the underlying GL object is recreated.
+		* GL recycles names, so this is what tells the device's state cache that a recreated object is no longer bound.
+		*/
+	unsigned int getRevision() const;
+
 private:
+	std::shared_ptr<GLReadbackRing> _readback;
 	int _flags;
 	TextureFormat::Format _format;
 	GLuint _textureId;
+	unsigned int _revision;
 	GLint _internalFormat;
 	GLenum _pixelFormat;
 	GLenum _pixelType;
@@ -24,10 +24,17 @@ public:
 
 	GLuint getTextureId() const;
 
+	/**
+		* Gets a number that changes every time the underlying GL object is recreated.
+		* GL recycles names, so this is what tells the device's state cache that a recreated object is no longer bound.
+		*/
+	unsigned int getRevision() const;
+
 private:
 	int _flags;
 	TextureFormat::Format _format;
 	GLuint _textureId;
+	unsigned int _revision;
 	GLint _internalFormat;
 	GLenum _pixelFormat;
 	GLenum _pixelType;
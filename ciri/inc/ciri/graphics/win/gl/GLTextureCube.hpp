@@ -16,8 +16,15 @@ public:
 
 	GLuint getTextureId() const;
 
+	/**
+		* Gets a number that changes every time the underlying GL object is recreated.
+		* GL recycles names, so this is what tells the device's state cache that a recreated object is no longer bound.
+		*/
+	unsigned int getRevision() const;
+
 private:
 	GLuint _textureId;
+	unsigned int _revision;
 };
 
 }
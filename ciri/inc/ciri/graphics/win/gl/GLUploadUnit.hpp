@@ -0,0 +1,15 @@
+#ifndef __ciri_graphics_GLUploadUnit__
+#define __ciri_graphics_GLUploadUnit__
+
+namespace ciri {
+
+/**
+ * Texture unit that GL textures bind to while creating or updating their data.
+ * Keeping uploads off the units used for drawing means they never disturb the bindings GLGraphicsDevice has cached.
+ * Must be at or above GraphicsStateCache::MAX_SLOTS, as binds to it are not cached.
+ */
+static const int CIRI_GL_UPLOAD_TEXTURE_UNIT = 31;
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef __ciri_graphics_GLVertexArrayCache__
+#define __ciri_graphics_GLVertexArrayCache__
+
+#include <memory>
+#include <unordered_map>
+#include <GL/glew.h>
+#include <ciri/graphics/VertexDeclaration.hpp>
+#include <ciri/graphics/GraphicsStateCache.hpp>
+
+namespace ciri {
+
+class GLVertexBuffer;
+class GLIndexBuffer;
+
+/**
+ * Lazily built vertex array objects, one per (vertex declaration, vertex buffers, index buffer) combination.
+ * Attribute pointers are specified once when a combination is first drawn; afterwards binding the combination is a single glBindVertexArray.
+ * Entries remember which buffer objects and revisions they were built from, so a recreated or recycled buffer name is respecified rather than reused.
+ */
+class GLVertexArrayCache {
+public:
+	GLVertexArrayCache();
+	~GLVertexArrayCache();
+
+	/**
+		* Binds the vertex array for the given combination, building or rebuilding it first if needed.
+		* @param declaration   Vertex declaration of the active shader.
+		* @param vertexBuffers VertexDeclaration::MAX_STREAMS vertex buffers, one per slot, to source attributes from.  Slots the declaration does not use are ignored.
+		* @param indexBuffer   Index buffer to attach, or nullptr.
+		* @param counts        State cache that attribute setups and vertex array binds are counted in.
+		* @returns True if a vertex array is now bound; false if a vertex buffer used by the declaration is missing or has no GL object.
+		*/
+	bool bind( const VertexDeclaration& declaration, const std::shared_ptr<GLVertexBuffer>* vertexBuffers, const std::shared_ptr<GLIndexBuffer>& indexBuffer, GraphicsStateCache& counts );
+
+	/**
+		* Deletes vertex arrays whose buffers have been released.  Call once per frame.
+		*/
+	void sweep();
+
+	/**
+		* Deletes all vertex arrays.  Must be called while the owning context is still current.
+		*/
+	void clear();
+
+	/**
+		* Forgets which vertex array is bound, for when something else has bound one.
+		*/
+	void invalidateBinding();
+
+	/**
+		* Gets the number of vertex arrays currently held.
+		*/
+	int getCount() const;
+
+private:
+	struct Key {
+		size_t layout;
+		GLuint vbos[VertexDeclaration::MAX_STREAMS];
+		GLuint ibo;
+
+		bool operator==( const Key& rhs ) const;
+	};
+
+	struct KeyHash {
+		size_t operator()( const Key& key ) const;
+	};
+
+	struct Entry {
+		GLuint vao;
+		int streamCount;
+		std::weak_ptr<GLVertexBuffer> vertexBuffers[VertexDeclaration::MAX_STREAMS];
+		std::weak_ptr<GLIndexBuffer> indexBuffer;
+		unsigned int vertexRevisions[VertexDeclaration::MAX_STREAMS];
+		unsigned int indexRevision;
+	};
+
+	void specify( Entry& entry, const VertexDeclaration& declaration, const std::shared_ptr<GLVertexBuffer>* vertexBuffers, const std::shared_ptr<GLIndexBuffer>& indexBuffer, GraphicsStateCache& counts );
+	static bool isSameObject( const std::weak_ptr<void>& a, const std::shared_ptr<void>& b );
+
+private:
+	std::unordered_map<Key, Entry, KeyHash> _entries;
+	GLuint _boundVao;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -18,12 +18,19 @@ public:
 
 	GLuint getVbo() const;
 
+	/**
+		* Gets a number that changes every time the underlying GL object is recreated.
+		* GL recycles names, so this is what tells the device's state cache that a recreated object is no longer bound.
+		*/
+	unsigned int getRevision() const;
+
 private:
 	ErrorCode createBuffer( void* vertices, int vertexStride, int vertexCount, bool dynamic );
 	ErrorCode updateBuffer( void* vertices, int vertexStride, int vertexCount );
 
 private:
 	GLuint _vbo;
+	unsigned int _revision;
 	int _vertexStride;
 	int _vertexCount;
 	bool _isDynamic;
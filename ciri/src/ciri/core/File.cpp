@@ -18,11 +18,9 @@ File::~File() {
 bool File::open( const char* file, int flags ) {
 	_flags = flags;
 
-	unsigned int mode = 0;
-	if( flags & Flags::ReadOnly ) {
-		mode |= std::fstream::in;
-	} else {
-		mode |= (std::fstream::in | std::fstream::out);
+	std::ios_base::openmode mode = std::fstream::in;
+	if( !(flags & Flags::ReadOnly) ) {
+		mode |= std::fstream::out;
 		mode |= (flags & Flags::Append) ? std::fstream::app : std::fstream::trunc;
 	}
 
@@ -0,0 +1,71 @@
+#include <ciri/core/FileData.hpp>
+
+using namespace ciri;
+
+FileData::FileData()
+	: _owner(nullptr), _data(nullptr), _size(0) {
+}
+
+FileData::FileData( std::vector<unsigned char>&& buffer )
+	: FileData() {
+	const std::shared_ptr<std::vector<unsigned char>> owned = std::make_shared<std::vector<unsigned char>>(std::move(buffer));
+	_owner = owned;
+	_data = owned->data();
+	_size = owned->size();
+}
+
+FileData::FileData( const std::shared_ptr<const void>& owner, const unsigned char* data, size_t size )
+	: _owner(owner), _data(data), _size(size) {
+}
+
+bool FileData::isValid() const {
+	return _owner != nullptr;
+}
+
+const unsigned char* FileData::getData() const {
+	return _data;
+}
+
+size_t FileData::getSize() const {
+	return _size;
+}
+
+std::string FileData::toString() const {
+	return (_size > 0) ? std::string(reinterpret_cast<const char*>(_data), _size) : std::string();
+}
+
+SpanStreamBuffer::SpanStreamBuffer( const unsigned char* data, size_t size ) {
+	// streambuf never writes through the get area, so it is safe to point it at read-only memory
+	char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+	setg(begin, begin, begin + size);
+}
+
+SpanStreamBuffer::pos_type SpanStreamBuffer::seekoff( off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which ) {
+	if( !(which & std::ios_base::in) ) {
+		return pos_type(off_type(-1));
+	}
+	off_type base = 0;
+	if( std::ios_base::cur == direction ) {
+		base = gptr() - eback();
+	} else if( std::ios_base::end == direction ) {
+		base = egptr() - eback();
+	}
+	const off_type position = base + offset;
+	if( position < 0 || position > (egptr() - eback()) ) {
+		return pos_type(off_type(-1));
+	}
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+SpanStreamBuffer::pos_type SpanStreamBuffer::seekpos( pos_type position, std::ios_base::openmode which ) {
+	return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+FileDataStream::FileDataStream( const FileData& data )
+	: std::istream(nullptr), _data(data), _buffer(data.getData(), data.getSize()) {
+	rdbuf(&_buffer);
+	if( !_data.isValid() ) {
+		setstate(std::ios_base::failbit);
+	}
+}
\ No newline at end of file
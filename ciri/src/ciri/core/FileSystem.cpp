@@ -0,0 +1,168 @@
+#include <ciri/core/FileSystem.hpp>
+#include <atomic>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace ciri;
+
+namespace {
+	struct Mount {
+		std::string file;
+		std::shared_ptr<PackArchive> archive;
+	};
+
+	struct FileSystemState {
+		std::mutex mutex; // guards mounts
+		std::vector<Mount> mounts;
+		std::atomic<long long> looseFiles;
+		std::atomic<long long> packedFiles;
+		std::atomic<long long> mappedFiles;
+		std::atomic<long long> bytes;
+
+		FileSystemState()
+			: looseFiles(0), packedFiles(0), mappedFiles(0), bytes(0) {
+		}
+	};
+
+	FileSystemState& state() {
+		static FileSystemState s;
+		return s;
+	}
+
+	std::vector<std::shared_ptr<PackArchive>> mountedArchives() {
+		FileSystemState& s = state();
+		std::lock_guard<std::mutex> lock(s.mutex);
+		std::vector<std::shared_ptr<PackArchive>> archives;
+		archives.reserve(s.mounts.size());
+		for( const auto& mount : s.mounts ) {
+			archives.push_back(mount.archive);
+		}
+		return archives;
+	}
+
+	// one open, one size query and one read, where streams would seek and read in small pieces
+	bool readLooseFile( const char* path, std::vector<unsigned char>& out ) {
+		FILE* file = std::fopen(path, "rb");
+		if( nullptr == file ) {
+			return false;
+		}
+		bool success = (0 == std::fseek(file, 0, SEEK_END));
+		const long size = success ? std::ftell(file) : -1;
+		success = success && size >= 0 && 0 == std::fseek(file, 0, SEEK_SET);
+		if( success ) {
+			out.resize(static_cast<size_t>(size));
+			success = out.empty() || (std::fread(out.data(), 1, out.size(), file) == out.size());
+		}
+		std::fclose(file);
+		return success;
+	}
+}
+
+bool FileSystem::mount( const char* file ) {
+	const std::shared_ptr<PackArchive> archive = std::make_shared<PackArchive>();
+	if( !archive->open(file) ) {
+		return false;
+	}
+	Mount mount;
+	mount.file = file;
+	mount.archive = archive;
+	FileSystemState& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.mounts.push_back(mount);
+	return true;
+}
+
+bool FileSystem::unmount( const char* file ) {
+	if( nullptr == file ) {
+		return false;
+	}
+	FileSystemState& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for( auto mount = s.mounts.rbegin(); mount != s.mounts.rend(); ++mount ) {
+		if( mount->file == file ) {
+			s.mounts.erase(std::next(mount).base());
+			return true;
+		}
+	}
+	return false;
+}
+
+void FileSystem::unmountAll() {
+	FileSystemState& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.mounts.clear();
+}
+
+FileData FileSystem::read( const char* path ) {
+	if( nullptr == path ) {
+		return FileData();
+	}
+
+	FileSystemState& s = state();
+	const std::vector<std::shared_ptr<PackArchive>> archives = mountedArchives();
+	if( !archives.empty() ) {
+		const std::string name = PackArchive::normalizePath(path);
+		for( auto archive = archives.rbegin(); archive != archives.rend(); ++archive ) {
+			bool mapped = false;
+			FileData data = (*archive)->read(name, &mapped);
+			if( data.isValid() ) {
+				s.packedFiles.fetch_add(1, std::memory_order_relaxed);
+				s.mappedFiles.fetch_add(mapped ? 1 : 0, std::memory_order_relaxed);
+				s.bytes.fetch_add(static_cast<long long>(data.getSize()), std::memory_order_relaxed);
+				return data;
+			}
+		}
+	}
+
+	std::vector<unsigned char> buffer;
+	if( !readLooseFile(path, buffer) ) {
+		return FileData();
+	}
+	s.looseFiles.fetch_add(1, std::memory_order_relaxed);
+	s.bytes.fetch_add(static_cast<long long>(buffer.size()), std::memory_order_relaxed);
+	return FileData(std::move(buffer));
+}
+
+bool FileSystem::exists( const char* path ) {
+	if( nullptr == path ) {
+		return false;
+	}
+
+	const std::vector<std::shared_ptr<PackArchive>> archives = mountedArchives();
+	if( !archives.empty() ) {
+		const std::string name = PackArchive::normalizePath(path);
+		for( const auto& archive : archives ) {
+			if( archive->contains(name) ) {
+				return true;
+			}
+		}
+	}
+
+	FILE* file = std::fopen(path, "rb");
+	if( nullptr == file ) {
+		return false;
+	}
+	std::fclose(file);
+	return true;
+}
+
+FileSystem::Stats FileSystem::getStats() {
+	FileSystemState& s = state();
+	Stats stats;
+	stats.looseFiles = s.looseFiles.load(std::memory_order_relaxed);
+	stats.packedFiles = s.packedFiles.load(std::memory_order_relaxed);
+	stats.mappedFiles = s.mappedFiles.load(std::memory_order_relaxed);
+	stats.bytes = s.bytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void FileSystem::resetStats() {
+	FileSystemState& s = state();
+	s.looseFiles.store(0, std::memory_order_relaxed);
+	s.packedFiles.store(0, std::memory_order_relaxed);
+	s.mappedFiles.store(0, std::memory_order_relaxed);
+	s.bytes.store(0, std::memory_order_relaxed);
+}
\ No newline at end of file
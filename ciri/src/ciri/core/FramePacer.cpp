@@ -0,0 +1,90 @@
+#include <ciri/core/FramePacer.hpp>
+#include <ciri/core/Timer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace ciri;
+
+namespace {
+	// windows sleeps wake on a 1ms tick at best and others usually within a few hundred microseconds; start cautious and let wakes lower it
+	const long long INITIAL_SPIN_MARGIN = 2000000;
+	const long long MIN_SPIN_MARGIN = 200000;
+}
+
+FramePacer::FramePacer()
+	: _targetRate(0.0), _period(0), _nextDeadline(0), _spinMargin(INITIAL_SPIN_MARGIN) {
+}
+
+FramePacer::~FramePacer() {
+}
+
+void FramePacer::setTargetRate( double framesPerSecond ) {
+	_targetRate = (framesPerSecond > 0.0) ? framesPerSecond : 0.0;
+	_period = (_targetRate > 0.0) ? static_cast<long long>(1000000000.0 / _targetRate) : 0;
+	reset();
+}
+
+double FramePacer::getTargetRate() const {
+	return _targetRate;
+}
+
+void FramePacer::reset() {
+	_nextDeadline = 0;
+	_stats = Stats();
+}
+
+long long FramePacer::wait() {
+	if( _period <= 0 ) {
+		return 0;
+	}
+
+	const long long start = Timer::now();
+	if( 0 == _nextDeadline ) {
+		_nextDeadline = start + _period;
+		return 0;
+	}
+
+	_stats.frames += 1;
+	if( start >= _nextDeadline ) {
+		_stats.missed += 1;
+		const long long late = start - _nextDeadline;
+		_stats.lateNanosecs += late;
+		_stats.maxLateNanosecs = std::max(_stats.maxLateNanosecs, late);
+		_nextDeadline = (late > _period) ? (start + _period) : (_nextDeadline + _period);
+		return 0;
+	}
+
+	long long current = start;
+	const long long sleepFor = (_nextDeadline - current) - _spinMargin;
+	if( sleepFor > 0 ) {
+		std::this_thread::sleep_for(std::chrono::nanoseconds(sleepFor));
+		current = Timer::now();
+		_stats.sleepNanosecs += current - start;
+		// wakes later than asked come out of the margin; keep enough to cover the latest recent one
+		const long long overshoot = (current - start) - sleepFor;
+		_spinMargin = std::max(_spinMargin - (_spinMargin >> 4), overshoot + MIN_SPIN_MARGIN);
+		_spinMargin = std::min(_spinMargin, _period);
+	}
+
+	const long long spinStart = current;
+	while( current < _nextDeadline ) {
+		std::this_thread::yield();
+		current = Timer::now();
+	}
+	_stats.spinNanosecs += current - spinStart;
+
+	const long long late = current - _nextDeadline;
+	_stats.lateNanosecs += late;
+	_stats.maxLateNanosecs = std::max(_stats.maxLateNanosecs, late);
+	_nextDeadline += _period;
+	return current - start;
+}
+
+const FramePacer::Stats& FramePacer::getStats() const {
+	return _stats;
+}
+
+long long FramePacer::getSpinMarginNanosecs() const {
+	return _spinMargin;
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include <ciri/core/JobSystem.hpp>
+#include <ciri/core/Profiler.hpp>
+#include <algorithm>
+#include <string>
+
+namespace ciri {
+	struct Job {
+		JobSystem::JobFunction function;
+		const JobSystem::RangeFunction* body; // set for parallelFor's ranges instead of function
+		int begin;
+		int end;
+		int grain;
+		JobCounter* counter;
+		Job* next; // in a counter's waiting list
+
+		Job()
+			: body(nullptr), begin(0), end(0), grain(0), counter(nullptr), next(nullptr) {
+		}
+	};
+}
+
+using namespace ciri;
+
+namespace {
+	const int SPINS_BEFORE_SLEEP = 64;
+	const int RANGES_PER_THREAD = 8;
+
+	// which system's deque, if any, the current thread pushes to
+	thread_local JobSystem* t_system = nullptr;
+	thread_local int t_index = -1;
+	thread_local unsigned int t_random = 0;
+
+	// xorshift; only picks which deque to steal from first
+	unsigned int nextRandom() {
+		if( 0 == t_random ) {
+			t_random = static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+		}
+		t_random ^= t_random << 13;
+		t_random ^= t_random >> 17;
+		t_random ^= t_random << 5;
+		return t_random;
+	}
+}
+
+JobCounter::JobCounter()
+	: _pending(0), _finishing(0), _waiting(nullptr) {
+}
+
+bool JobCounter::isDone() const {
+	// _finishing goes up before _pending goes down, so seeing both at zero means no thread still holds the counter
+	return 0 == _pending.load(std::memory_order_acquire) && 0 == _finishing.load(std::memory_order_acquire);
+}
+
+int JobCounter::getPending() const {
+	return _pending.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem()
+	: _threadCount(1), _sharedCount(0), _sleeping(0), _epoch(0), _stopping(false), _steals(0) {
+}
+
+JobSystem::~JobSystem() {
+	destroy();
+}
+
+bool JobSystem::create( int threadCount ) {
+	if( !_deques.empty() ) {
+		return false;
+	}
+
+	_threadCount = (threadCount > 0) ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+	_threadCount = std::max(1, _threadCount);
+	if( 1 == _threadCount ) {
+		return true;
+	}
+
+	_stopping = false;
+	for( int i = 0; i < _threadCount; ++i ) {
+		_deques.push_back(std::unique_ptr<WorkStealingDeque<Job>>(new WorkStealingDeque<Job>()));
+	}
+	t_system = this;
+	t_index = 0;
+	_workers.reserve(_threadCount - 1);
+	for( int i = 1; i < _threadCount; ++i ) {
+		_workers.push_back(std::thread(&JobSystem::workerMain, this, i));
+	}
+	return true;
+}
+
+void JobSystem::destroy() {
+	if( !_workers.empty() ) {
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stopping = true;
+		}
+		_sleepCondition.notify_all();
+		for( auto& worker : _workers ) {
+			worker.join();
+		}
+		_workers.clear();
+	}
+	if( this == t_system ) {
+		t_system = nullptr;
+		t_index = -1;
+	}
+	_deques.clear();
+	_shared.clear();
+	_sharedCount = 0;
+	_threadCount = 1;
+}
+
+int JobSystem::getThreadCount() const {
+	return _threadCount;
+}
+
+void JobSystem::run( const JobFunction& function, JobCounter* counter, JobCounter* after ) {
+	Job* job = new Job();
+	job->function = function;
+	job->counter = counter;
+	if( counter != nullptr ) {
+		counter->_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if( after != nullptr ) {
+		// parked jobs are pushed by whichever thread finishes the counter's last job; see finish
+		std::lock_guard<std::mutex> lock(after->_mutex);
+		if( after->_pending.load(std::memory_order_acquire) > 0 ) {
+			job->next = after->_waiting;
+			after->_waiting = job;
+			return;
+		}
+	}
+	push(job);
+}
+
+void JobSystem::wait( JobCounter& counter ) {
+	const int index = (this == t_system) ? t_index : -1;
+	while( !counter.isDone() ) {
+		Job* job = findJob(index);
+		if( job != nullptr ) {
+			execute(job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::parallelFor( int begin, int end, int grain, const RangeFunction& body ) {
+	if( end <= begin ) {
+		return;
+	}
+	if( grain <= 0 ) {
+		grain = std::max(1, (end - begin) / (_threadCount * RANGES_PER_THREAD));
+	}
+	if( _deques.empty() ) {
+		// one thread still keeps to the grain, as callers may size buffers by it
+		while( begin < end ) {
+			const int rangeEnd = ((end - begin) > grain) ? (begin + grain) : end;
+			body(begin, rangeEnd);
+			begin = rangeEnd;
+		}
+		return;
+	}
+	if( (end - begin) <= grain ) {
+		body(begin, end);
+		return;
+	}
+
+	// the whole range counts as one job, as does every half split off it
+	JobCounter counter;
+	counter._pending.store(1, std::memory_order_relaxed);
+	runRange(&body, begin, end, grain, &counter);
+	wait(counter);
+}
+
+long long JobSystem::getStealCount() const {
+	return _steals.load(std::memory_order_relaxed);
+}
+
+void JobSystem::workerMain( int index ) {
+	t_system = this;
+	t_index = index;
+	Profiler::setThreadName(("job worker " + std::to_string(index)).c_str());
+
+	int idle = 0;
+	while( !_stopping.load(std::memory_order_acquire) ) {
+		const unsigned int epoch = _epoch.load(std::memory_order_seq_cst);
+		Job* job = findJob(index);
+		if( job != nullptr ) {
+			execute(job);
+			idle = 0;
+			continue;
+		}
+		if( ++idle < SPINS_BEFORE_SLEEP ) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		// sleeping bumps _sleeping before looking at _epoch, and pushing bumps _epoch before looking at _sleeping, so one always sees the other
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleeping.fetch_add(1, std::memory_order_seq_cst);
+		_sleepCondition.wait(lock, [this, epoch]{ return _stopping.load(std::memory_order_acquire) || _epoch.load(std::memory_order_seq_cst) != epoch; });
+		_sleeping.fetch_sub(1, std::memory_order_relaxed);
+		idle = 0;
+	}
+}
+
+void JobSystem::push( Job* job ) {
+	if( _deques.empty() ) {
+		execute(job);
+		return;
+	}
+
+	if( this == t_system ) {
+		_deques[t_index]->push(job);
+	} else {
+		std::lock_guard<std::mutex> lock(_sharedMutex);
+		_shared.push_back(job);
+		_sharedCount.fetch_add(1, std::memory_order_release);
+	}
+	wake();
+}
+
+Job* JobSystem::findJob( int index ) {
+	if( index >= 0 ) {
+		Job* job = _deques[index]->take();
+		if( job != nullptr ) {
+			return job;
+		}
+	}
+
+	if( _sharedCount.load(std::memory_order_acquire) > 0 ) {
+		std::lock_guard<std::mutex> lock(_sharedMutex);
+		if( !_shared.empty() ) {
+			Job* job = _shared.front();
+			_shared.pop_front();
+			_sharedCount.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	const int count = static_cast<int>(_deques.size());
+	const int first = static_cast<int>(nextRandom() % static_cast<unsigned int>(count));
+	for( int i = 0; i < count; ++i ) {
+		const int victim = (first + i) % count;
+		if( victim == index ) {
+			continue;
+		}
+		Job* job = _deques[victim]->steal();
+		if( job != nullptr ) {
+			_steals.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::execute( Job* job ) {
+	JobCounter* counter = job->counter;
+	if( job->body != nullptr ) {
+		const RangeFunction* body = job->body;
+		const int begin = job->begin;
+		const int end = job->end;
+		const int grain = job->grain;
+		delete job;
+		runRange(body, begin, end, grain, counter);
+		return;
+	}
+	job->function();
+	delete job;
+	finish(counter);
+}
+
+void JobSystem::runRange( const RangeFunction* body, int begin, int end, int grain, JobCounter* counter ) {
+	// the upper halves go to the deque; the owner works down through the lower ones while thieves take the biggest halves left
+	while( (end - begin) > grain ) {
+		const int middle = begin + (end - begin) / 2;
+		Job* half = new Job();
+		half->body = body;
+		half->begin = middle;
+		half->end = end;
+		half->grain = grain;
+		half->counter = counter;
+		counter->_pending.fetch_add(1, std::memory_order_relaxed);
+		push(half);
+		end = middle;
+	}
+	(*body)(begin, end);
+	finish(counter);
+}
+
+void JobSystem::finish( JobCounter* counter ) {
+	if( nullptr == counter ) {
+		return;
+	}
+
+	counter->_finishing.fetch_add(1, std::memory_order_acq_rel);
+	Job* waiting = nullptr;
+	if( 1 == counter->_pending.fetch_sub(1, std::memory_order_acq_rel) ) {
+		std::lock_guard<std::mutex> lock(counter->_mutex);
+		waiting = counter->_waiting;
+		counter->_waiting = nullptr;
+	}
+	// a waiter may destroy the counter from here on
+	counter->_finishing.fetch_sub(1, std::memory_order_release);
+
+	while( waiting != nullptr ) {
+		Job* next = waiting->next;
+		waiting->next = nullptr;
+		push(waiting);
+		waiting = next;
+	}
+}
+
+void JobSystem::wake() {
+	_epoch.fetch_add(1, std::memory_order_seq_cst);
+	if( _sleeping.load(std::memory_order_seq_cst) > 0 ) {
+		// taking the lock means a worker that counted itself as sleeping is now waiting, and will get the notify
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+		_sleepCondition.notify_one();
+	}
+}
\ No newline at end of file
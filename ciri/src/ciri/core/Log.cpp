@@ -1,58 +1,293 @@
 #include <ciri/core/Log.hpp>
+#include <ciri/core/LogRing.hpp>
+#include <ciri/core/Profiler.hpp>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <ctime>
+#include <thread>
+#include <vector>
+
+namespace ciri {
+	struct LogRecord {
+		Log* log;
+		Log::DecodeFunction decode;
+		const char* format;
+		long long timestamp; // system clock nanoseconds
+		Log::Level level;
+	};
+
+	struct LogThreadRing {
+		LogRing ring;
+		std::atomic<bool> retired; // its thread has exited; reused by the next new thread once drained
+
+		LogThreadRing( size_t capacity )
+			: ring(capacity), retired(false) {
+		}
+	};
+
+	/**
+	 * Drains every thread's ring, a batch at a time, and hands each log its part of the batch to write out in one go.
+	 */
+	class LogWriter {
+	public:
+		LogWriter();
+		~LogWriter();
+
+		void flush();
+		void wake();
+		void drain();
+
+	public:
+		std::mutex mutex; // guards rings, flushRequests, flushed and stopping
+		std::condition_variable condition;
+		std::vector<std::shared_ptr<LogThreadRing>> rings;
+		std::atomic<bool> wakePending;
+		std::atomic<int> overflow;
+		std::atomic<size_t> ringSize;
+		std::atomic<long long> dropped;
+		long long flushRequests;
+		long long flushed;
+		bool stopping;
+
+	private:
+		void writerMain();
+
+	private:
+		std::thread _thread;
+		// only touched by the writer thread, or by the thread destroying it once the writer has stopped
+		std::vector<std::pair<Log*, std::string>> _batches;
+		long long _cachedSecond;
+		std::string _cachedTimestamp;
+	};
+}
 
 using namespace ciri;
 
-Log::Log()
-	: _appendNewLine(true), _prefixTimestamp(true), _logToStd(true) {
+namespace {
+	// how long the writer sleeps between batches unless woken; errors and rings filling past half wake it sooner
+	const int WRITE_INTERVAL_MS = 10;
+	const size_t DEFAULT_RING_SIZE = 256 * 1024;
+	const size_t MIN_RING_SIZE = 64 * 1024;
+
+	// the writer starts with the first message; once it is gone at exit, anything logged is written on the spot
+	std::atomic<bool> g_writerCreated(false);
+	std::atomic<bool> g_writerDestroyed(false);
+
+	bool writerRunning() {
+		return g_writerCreated.load(std::memory_order_acquire) && !g_writerDestroyed.load(std::memory_order_acquire);
+	}
+
+	struct ThreadState {
+		std::shared_ptr<LogThreadRing> ring;
+		std::vector<char> scratch; // a record being written on the spot, when there is no writer
+		bool onTheSpot;            // whether the record being written is in scratch rather than the ring
+
+		ThreadState()
+			: onTheSpot(false) {
+		}
+
+		~ThreadState() {
+			if( ring != nullptr ) {
+				ring->retired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local ThreadState t_thread;
+
+	LogWriter& writer() {
+		static LogWriter w;
+		return w;
+	}
+
+	LogThreadRing& threadRing( LogWriter& w ) {
+		if( nullptr == t_thread.ring ) {
+			std::lock_guard<std::mutex> lock(w.mutex);
+			// as the profiler does, take over the ring of a thread that has exited once it has been drained
+			for( unsigned int i = 0; i < w.rings.size(); ++i ) {
+				LogThreadRing& ring = *w.rings[i];
+				if( ring.retired.load(std::memory_order_acquire) && ring.ring.isEmpty() ) {
+					ring.retired.store(false, std::memory_order_relaxed);
+					t_thread.ring = w.rings[i];
+					return ring;
+				}
+			}
+			t_thread.ring = std::make_shared<LogThreadRing>(w.ringSize.load(std::memory_order_relaxed));
+			w.rings.push_back(t_thread.ring);
+		}
+		return *t_thread.ring;
+	}
 }
 
-Log::~Log() {
-	closeFile();
+LogWriter::LogWriter()
+	: wakePending(false), overflow(Logs::Drop), ringSize(DEFAULT_RING_SIZE), dropped(0), flushRequests(0), flushed(0), stopping(false), _cachedSecond(-1) {
+	_thread = std::thread(&LogWriter::writerMain, this);
+	g_writerCreated = true;
 }
 
-void Log::print( const std::string& msg ) {
-	std::string str =(_prefixTimestamp ? generateTimestampString() : "") +  msg + ((_appendNewLine) ? "\n" : "");
-	if( _logToStd ) {
-		printf("%s", str.c_str());
-	}
-	if( _file.isOpen() ) {
-		_file.write(str);
+LogWriter::~LogWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
 	}
+	condition.notify_all();
+	_thread.join();
+	g_writerDestroyed = true;
+	// whatever was logged while the writer finished its last batch
+	drain();
 }
 
-void Log::printInfo( const std::string& msg ) {
-	std::string str = (_prefixTimestamp ? generateTimestampString() : "") + "[INFO] " + msg + (_appendNewLine ? "\n" : "");
-	if( _logToStd ) {
-		printf("%s", str.c_str());
+void LogWriter::flush() {
+	std::unique_lock<std::mutex> lock(mutex);
+	const long long request = ++flushRequests;
+	condition.notify_all();
+	condition.wait(lock, [this, request]{ return flushed >= request || stopping; });
+}
+
+void LogWriter::wake() {
+	// one notify per batch at most; a wake lost to the writer just going to sleep costs it one interval
+	if( !wakePending.exchange(true, std::memory_order_acq_rel) ) {
+		condition.notify_one();
 	}
-	if( _file.isOpen() ) {
-		_file.write(str);
+}
+
+void LogWriter::writerMain() {
+	Profiler::setThreadName("log writer");
+	std::unique_lock<std::mutex> lock(mutex);
+	while( !stopping ) {
+		condition.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS), [this]{
+			return stopping || flushRequests > flushed || wakePending.load(std::memory_order_acquire);
+		});
+		wakePending.store(false, std::memory_order_release);
+		// records logged before a flush request are visible by now, since both went through the mutex
+		const long long requests = flushRequests;
+		lock.unlock();
+		drain();
+		lock.lock();
+		flushed = requests;
+		condition.notify_all();
 	}
 }
 
-void Log::printWarning( const std::string& msg ) {
-	std::string str = (_prefixTimestamp ? generateTimestampString() : "") + "[WARNING] " + msg + (_appendNewLine ? "\n" : "");
-	if( _logToStd ) {
-		printf("%s", str.c_str());
+void LogWriter::drain() {
+	std::vector<std::shared_ptr<LogThreadRing>> current;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		current = rings;
 	}
-	if( _file.isOpen() ) {
-		_file.write(str);
+
+	for( auto& threadRing : current ) {
+		LogRing& ring = threadRing->ring;
+		while( const char* bytes = ring.front() ) {
+			const LogRecord* record = reinterpret_cast<const LogRecord*>(bytes);
+			// few logs ever exist, so a linear search beats hashing; an entry of a destroyed log is only reused by a new log at its address
+			std::string* text = nullptr;
+			for( auto& batch : _batches ) {
+				if( batch.first == record->log ) {
+					text = &batch.second;
+					break;
+				}
+			}
+			if( nullptr == text ) {
+				_batches.push_back(std::make_pair(record->log, std::string()));
+				text = &_batches.back().second;
+			}
+			record->log->formatRecord(record->level, record->timestamp, record->format, record->decode, bytes + sizeof(LogRecord), *text, _cachedSecond, _cachedTimestamp);
+			ring.pop();
+		}
+	}
+
+	for( auto& batch : _batches ) {
+		if( batch.second.empty() ) {
+			continue;
+		}
+		const long long droppedCount = batch.first->_dropped.exchange(0, std::memory_order_relaxed);
+		if( droppedCount > 0 ) {
+			batch.second += "[WARNING] " + std::to_string(droppedCount) + " log messages dropped\n";
+		}
+		batch.first->writeOut(batch.second);
+		batch.second.clear();
 	}
 }
 
-void Log::printError( const std::string& msg ) {
-	std::string str = (_prefixTimestamp ? generateTimestampString() : "") + "[ERROR] " + msg + (_appendNewLine ? "\n" : "");
-	if( _logToStd ) {
-		printf("%s", str.c_str());
+const char* ciri::appendLogFormat( const char* format, std::string& out ) {
+	const char* placeholder = strstr(format, "{}");
+	if( nullptr == placeholder ) {
+		out += format;
+		return nullptr;
 	}
-	if( _file.isOpen() ) {
-		_file.write(str);
+	out.append(format, placeholder - format);
+	return placeholder + 2;
+}
+
+void ciri::appendLogValue( std::string& out, bool value ) {
+	out += value ? "true" : "false";
+}
+
+void ciri::appendLogValue( std::string& out, char value ) {
+	out += value;
+}
+
+void ciri::appendLogValue( std::string& out, long long value ) {
+	if( value < 0 ) {
+		out += '-';
+		// negated as unsigned so that the most negative value does not overflow
+		appendLogValue(out, 0ULL - static_cast<unsigned long long>(value));
+		return;
 	}
+	appendLogValue(out, static_cast<unsigned long long>(value));
+}
+
+void ciri::appendLogValue( std::string& out, unsigned long long value ) {
+	// digits written back to front; snprintf costs about a hundred nanoseconds a number, which the writer pays for every integer logged
+	char buf[20];
+	char* digit = buf + sizeof(buf);
+	do {
+		*--digit = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while( value != 0 );
+	out.append(digit, buf + sizeof(buf) - digit);
+}
+
+void ciri::appendLogValue( std::string& out, double value ) {
+	char buf[32];
+	const int length = snprintf(buf, sizeof(buf), "%g", value);
+	out.append(buf, length);
+}
+
+void ciri::appendLogValue( std::string& out, const char* str, unsigned int length ) {
+	out.append(str, length);
+}
+
+Log::Log()
+	: _appendNewLine(true), _prefixTimestamp(true), _logToStd(true), _dropped(0) {
+}
+
+Log::~Log() {
+	closeFile();
+}
+
+void Log::print( const std::string& msg ) {
+	printFormatted(Message, "{}", msg);
+}
+
+void Log::printInfo( const std::string& msg ) {
+	printFormatted(Info, "{}", msg);
+}
+
+void Log::printWarning( const std::string& msg ) {
+	printFormatted(Warning, "{}", msg);
+}
+
+void Log::printError( const std::string& msg ) {
+	printFormatted(Error, "{}", msg);
 }
 
 bool Log::setFile( const char* file ) {
+	// so that messages logged before go where they would have gone
+	Logs::flush();
+	std::lock_guard<std::mutex> lock(_fileMutex);
 	if( _file.isOpen() ) {
 		return false;
 	}
@@ -61,30 +296,153 @@ bool Log::setFile( const char* file ) {
 }
 
 void Log::closeFile() {
+	Logs::flush();
+	std::lock_guard<std::mutex> lock(_fileMutex);
 	_file.close();
 }
 
 void Log::setAppendNewLine( bool val ) {
-	_appendNewLine = val;
+	_appendNewLine.store(val, std::memory_order_relaxed);
 }
 
 void Log::setPrefixTimestamp( bool val ) {
-	_prefixTimestamp = val;
+	_prefixTimestamp.store(val, std::memory_order_relaxed);
 }
 
 void Log::setLogToStd( bool val ) {
-	_logToStd = val;
+	_logToStd.store(val, std::memory_order_relaxed);
 }
 
-std::string Log::generateTimestampString() const {
-	const auto timeNow = std::chrono::system_clock::now();
-	const std::time_t timeT = std::chrono::system_clock::to_time_t(timeNow);
-	char buf[100];
-	std::strftime(buf, sizeof(buf), "%c: ", std::localtime(&timeT));
-	return buf;
+char* Log::beginRecord( Level level, const char* format, DecodeFunction decode, size_t size ) {
+	const long long timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	const size_t recordSize = sizeof(LogRecord) + size;
+	char* bytes = nullptr;
+	t_thread.onTheSpot = g_writerDestroyed.load(std::memory_order_acquire);
+	if( t_thread.onTheSpot ) {
+		t_thread.scratch.resize(recordSize);
+		bytes = t_thread.scratch.data();
+	} else {
+		LogWriter& w = writer();
+		LogRing& ring = threadRing(w).ring;
+		if( !ring.fits(recordSize) ) {
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			w.dropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		bytes = ring.reserve(recordSize);
+		if( nullptr == bytes ) {
+			if( Logs::Drop == w.overflow.load(std::memory_order_relaxed) ) {
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				w.dropped.fetch_add(1, std::memory_order_relaxed);
+				w.wake();
+				return nullptr;
+			}
+			do {
+				w.wake();
+				std::this_thread::yield();
+				bytes = ring.reserve(recordSize);
+			} while( nullptr == bytes );
+		}
+	}
+
+	LogRecord* record = reinterpret_cast<LogRecord*>(bytes);
+	record->log = this;
+	record->decode = decode;
+	record->format = format;
+	record->timestamp = timestamp;
+	record->level = level;
+	return bytes + sizeof(LogRecord);
+}
+
+void Log::endRecord( Level level ) {
+	if( t_thread.onTheSpot ) {
+		const LogRecord* record = reinterpret_cast<const LogRecord*>(t_thread.scratch.data());
+		std::string text;
+		long long cachedSecond = -1;
+		std::string cachedTimestamp;
+		formatRecord(level, record->timestamp, record->format, record->decode, t_thread.scratch.data() + sizeof(LogRecord), text, cachedSecond, cachedTimestamp);
+		writeOut(text);
+		return;
+	}
+
+	LogRing& ring = t_thread.ring->ring;
+	ring.commit();
+	if( Error == level || ring.getUsed() > ring.getCapacity() / 2 ) {
+		writer().wake();
+	}
+}
+
+void Log::formatRecord( Level level, long long timestamp, const char* format, DecodeFunction decode, const char* data, std::string& text, long long& cachedSecond, std::string& cachedTimestamp ) const {
+	if( _prefixTimestamp.load(std::memory_order_relaxed) ) {
+		// the timestamp only shows seconds, so it is formatted once a second rather than once a message
+		const long long second = timestamp / 1000000000;
+		if( second != cachedSecond ) {
+			const std::time_t timeT = static_cast<std::time_t>(second);
+			char buf[100];
+			std::strftime(buf, sizeof(buf), "%c: ", std::localtime(&timeT));
+			cachedTimestamp = buf;
+			cachedSecond = second;
+		}
+		text += cachedTimestamp;
+	}
+	switch( level ) {
+		case Info: {
+			text += "[INFO] ";
+			break;
+		}
+		case Warning: {
+			text += "[WARNING] ";
+			break;
+		}
+		case Error: {
+			text += "[ERROR] ";
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+	decode(format, data, text);
+	if( _appendNewLine.load(std::memory_order_relaxed) ) {
+		text += '\n';
+	}
+}
+
+void Log::writeOut( const std::string& text ) {
+	if( _logToStd.load(std::memory_order_relaxed) ) {
+		fwrite(text.data(), 1, text.size(), stdout);
+		fflush(stdout);
+	}
+	std::lock_guard<std::mutex> lock(_fileMutex);
+	if( _file.isOpen() ) {
+		_file.write(text);
+	}
 }
 
-std::unordered_map<Logs::Channel, Log> Logs::_logs;
 Log& Logs::get( Logs::Channel channel ) {
-	return Logs::_logs[channel];
+	// an array rather than a map, so that threads looking up channels never race a map insertion
+	static Log logs[Custom + 1];
+	return logs[channel];
+}
+
+void Logs::flush() {
+	if( writerRunning() ) {
+		writer().flush();
+	}
+}
+
+void Logs::setOverflow( Overflow overflow ) {
+	if( !g_writerDestroyed ) {
+		writer().overflow.store(overflow, std::memory_order_relaxed);
+	}
+}
+
+void Logs::setRingSize( size_t bytes ) {
+	if( !g_writerDestroyed ) {
+		writer().ringSize.store((bytes > MIN_RING_SIZE) ? bytes : MIN_RING_SIZE, std::memory_order_relaxed);
+	}
+}
+
+long long Logs::getDroppedCount() {
+	return writerRunning() ? writer().dropped.load(std::memory_order_relaxed) : 0;
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <ciri/core/MappedFile.hpp>
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace ciri;
+
+MappedFile::MappedFile()
+	: _data(nullptr), _size(0), _fileHandle(nullptr), _mappingHandle(nullptr) {
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open( const char* file ) {
+	if( isOpen() || nullptr == file ) {
+		return false;
+	}
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if( INVALID_HANDLE_VALUE == fileHandle ) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx(fileHandle, &size) || 0 == size.QuadPart ) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if( nullptr == mappingHandle ) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+	void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if( nullptr == view ) {
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+	_fileHandle = fileHandle;
+	_mappingHandle = mappingHandle;
+	_data = static_cast<const unsigned char*>(view);
+	_size = static_cast<size_t>(size.QuadPart);
+#else
+	const int fd = ::open(file, O_RDONLY);
+	if( fd < 0 ) {
+		return false;
+	}
+	struct stat info;
+	if( fstat(fd, &info) != 0 || 0 == info.st_size ) {
+		::close(fd);
+		return false;
+	}
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps the file alive on its own
+	::close(fd);
+	if( MAP_FAILED == view ) {
+		return false;
+	}
+	_data = static_cast<const unsigned char*>(view);
+	_size = static_cast<size_t>(info.st_size);
+#endif
+	return true;
+}
+
+void MappedFile::close() {
+	if( !isOpen() ) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(_data);
+	CloseHandle(static_cast<HANDLE>(_mappingHandle));
+	CloseHandle(static_cast<HANDLE>(_fileHandle));
+	_mappingHandle = nullptr;
+	_fileHandle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return _data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const {
+	return _data;
+}
+
+size_t MappedFile::getSize() const {
+	return _size;
+}
\ No newline at end of file
@@ -1,9 +1,29 @@
 #include <ciri/core/PNG.hpp>
+#include <ciri/core/FileSystem.hpp>
+#include <cstring>
 #include <iostream>
 #include <png.h>
 
 using namespace ciri;
 
+namespace {
+	struct PngSource {
+		const unsigned char* data;
+		size_t size;
+		size_t position;
+	};
+
+	// libpng reads through this rather than a FILE, so that images come out of pack archives too
+	void readPngData( png_structp png_ptr, png_bytep out, png_size_t count ) {
+		PngSource* source = static_cast<PngSource*>(png_get_io_ptr(png_ptr));
+		if( count > source->size - source->position ) {
+			png_error(png_ptr, "read past the end of the data");
+		}
+		memcpy(out, source->data + source->position, count);
+		source->position += count;
+	}
+}
+
 PNG::PNG()
 	: _pixels(nullptr), _width(0), _height(0), _bitsPerChannel(0), _bytesPerChannel(0), _channelsPerPixel(0) {
 }
@@ -18,26 +38,25 @@ bool PNG::loadFromFile( const char* file, bool forceRGBA ) {
 	}
 
 	// load texture file into memory
-	FILE* fp = nullptr;
-	fp = std::fopen(file, "rb");
-	if( nullptr == fp ) {
+	const FileData data = FileSystem::read(file);
+	if( !data.isValid() ) {
 		return false;
 	}
 
 	// read a few bytes of the header to confirm this is a png.
 	// the more bytes read, the more accurate the guess.
 	const unsigned int HEADER_SIZE = 8;
-	png_byte header[HEADER_SIZE];
-	fread(header, 1, HEADER_SIZE, fp);
-	if( png_sig_cmp(header, 0, HEADER_SIZE) != 0 ) {
-		fclose(fp);
+	if( data.getSize() < HEADER_SIZE || png_sig_cmp(const_cast<png_bytep>(data.getData()), 0, HEADER_SIZE) != 0 ) {
 		return false;
 	}
+	PngSource source;
+	source.data = data.getData();
+	source.size = data.getSize();
+	source.position = HEADER_SIZE;
 
 	// read png struct
 	png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
 	if( nullptr == png_ptr ) {
-		fclose(fp);
 		return false;
 	}
 
@@ -45,19 +64,17 @@ bool PNG::loadFromFile( const char* file, bool forceRGBA ) {
 	png_infop info_ptr = png_create_info_struct(png_ptr);
 	if( nullptr == info_ptr ) {
 		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-		fclose(fp);
 		return false;
 	}
 
 	// set jmp
 	if( setjmp(png_jmpbuf(png_ptr)) ) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-		fclose(fp);
 		return false;
 	}
 
 	// read png
-	png_init_io(png_ptr, fp);
+	png_set_read_fn(png_ptr, &source, readPngData);
 	png_set_sig_bytes(png_ptr, HEADER_SIZE);
 	png_read_png(png_ptr, info_ptr, PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND | PNG_TRANSFORM_SWAP_ENDIAN, nullptr);
 		
@@ -77,7 +94,6 @@ bool PNG::loadFromFile( const char* file, bool forceRGBA ) {
 		memcpy(pixelsPtr + y * png_get_rowbytes(png_ptr, info_ptr), rowPtrs[_height-y-1], png_get_rowbytes(png_ptr, info_ptr));
 	}
 	png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-	fclose(fp);
 
 	// if rgba was requested but the image is rgb, create a new buffer with an A channel and delete the old one.
 	if( forceRGBA && _channelsPerPixel != 4 ) {
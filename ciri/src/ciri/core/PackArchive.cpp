@@ -0,0 +1,338 @@
+#include <ciri/core/PackArchive.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <dirent.h>
+	#include <sys/stat.h>
+#endif
+
+namespace ciri {
+	struct PackEntry {
+		unsigned long long offset;
+		unsigned long long storedSize;
+		unsigned long long size;
+		unsigned int nameOffset;
+		unsigned int nameLength;
+		unsigned int flags;
+		unsigned int reserved;
+	};
+}
+
+using namespace ciri;
+
+namespace {
+	const char PACK_MAGIC[4] = {'C', 'P', 'A', 'K'};
+	const unsigned int PACK_VERSION = 1;
+	const unsigned long long STORED_ALIGNMENT = 4096;
+	const unsigned int ENTRY_COMPRESSED = 1;
+
+	struct PackHeader {
+		char magic[4];
+		unsigned int version;
+		unsigned int entryCount;
+		unsigned int namesSize;
+		unsigned long long tocOffset;
+	};
+
+	void listFiles( const std::string& directory, std::vector<std::string>& out ) {
+	#ifdef _WIN32
+		WIN32_FIND_DATAA found;
+		HANDLE handle = FindFirstFileA((directory + "/*").c_str(), &found);
+		if( INVALID_HANDLE_VALUE == handle ) {
+			return;
+		}
+		do {
+			const std::string name = found.cFileName;
+			if( "." == name || ".." == name ) {
+				continue;
+			}
+			if( found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) {
+				listFiles(directory + "/" + name, out);
+			} else {
+				out.push_back(directory + "/" + name);
+			}
+		} while( FindNextFileA(handle, &found) );
+		FindClose(handle);
+	#else
+		DIR* dir = opendir(directory.c_str());
+		if( nullptr == dir ) {
+			return;
+		}
+		while( const dirent* found = readdir(dir) ) {
+			const std::string name = found->d_name;
+			if( "." == name || ".." == name ) {
+				continue;
+			}
+			const std::string path = directory + "/" + name;
+			struct stat info;
+			if( stat(path.c_str(), &info) != 0 ) {
+				continue;
+			}
+			if( S_ISDIR(info.st_mode) ) {
+				listFiles(path, out);
+			} else if( S_ISREG(info.st_mode) ) {
+				out.push_back(path);
+			}
+		}
+		closedir(dir);
+	#endif
+	}
+
+	bool readWholeFile( const std::string& file, std::vector<unsigned char>& out ) {
+		std::ifstream stream(file.c_str(), std::ios::binary | std::ios::ate);
+		if( !stream.is_open() ) {
+			return false;
+		}
+		out.resize(static_cast<size_t>(stream.tellg()));
+		stream.seekg(0);
+		return out.empty() || static_cast<bool>(stream.read(reinterpret_cast<char*>(out.data()), out.size()));
+	}
+
+	void padTo( std::ofstream& stream, unsigned long long& offset, unsigned long long alignment ) {
+		static const char zeros[4096] = {0};
+		const unsigned long long padding = (alignment - (offset % alignment)) % alignment;
+		stream.write(zeros, static_cast<std::streamsize>(padding));
+		offset += padding;
+	}
+}
+
+PackArchive::PackArchive()
+	: _file(nullptr), _entries(nullptr), _names(nullptr), _entryCount(0) {
+}
+
+PackArchive::~PackArchive() {
+	close();
+}
+
+bool PackArchive::open( const char* file ) {
+	if( isOpen() ) {
+		return false;
+	}
+
+	const std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+	if( !mapped->open(file) ) {
+		return false;
+	}
+	const unsigned char* data = mapped->getData();
+	const size_t size = mapped->getSize();
+
+	// check everything up front, so that lookups can trust the table of contents
+	if( size < sizeof(PackHeader) ) {
+		return false;
+	}
+	PackHeader header;
+	memcpy(&header, data, sizeof(header));
+	if( memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION ) {
+		return false;
+	}
+	const unsigned long long tocSize = static_cast<unsigned long long>(header.entryCount) * sizeof(PackEntry);
+	// bounds are checked by subtracting from what is left, so crafted sizes can't wrap around them
+	if( header.tocOffset % alignof(PackEntry) != 0 || header.tocOffset > size || tocSize > size - header.tocOffset || header.namesSize > size - header.tocOffset - tocSize ) {
+		return false;
+	}
+	const PackEntry* entries = reinterpret_cast<const PackEntry*>(data + header.tocOffset);
+	for( unsigned int i = 0; i < header.entryCount; ++i ) {
+		const PackEntry& entry = entries[i];
+		if( entry.offset > header.tocOffset || entry.storedSize > header.tocOffset - entry.offset || static_cast<unsigned long long>(entry.nameOffset) + entry.nameLength > header.namesSize ) {
+			return false;
+		}
+		// uncompressed entries are read straight from the mapping, so they must hold exactly their size
+		if( 0 == (entry.flags & ENTRY_COMPRESSED) && entry.storedSize != entry.size ) {
+			return false;
+		}
+	}
+
+	_file = mapped;
+	_entries = entries;
+	_names = reinterpret_cast<const char*>(data + header.tocOffset + tocSize);
+	_entryCount = static_cast<int>(header.entryCount);
+	return true;
+}
+
+void PackArchive::close() {
+	// files read out of the archive keep the mapping alive for as long as they need it
+	_file = nullptr;
+	_entries = nullptr;
+	_names = nullptr;
+	_entryCount = 0;
+}
+
+bool PackArchive::isOpen() const {
+	return _file != nullptr;
+}
+
+bool PackArchive::contains( const std::string& name ) const {
+	return find(name) >= 0;
+}
+
+FileData PackArchive::read( const std::string& name, bool* mapped ) const {
+	if( mapped != nullptr ) {
+		*mapped = false;
+	}
+	const int index = find(name);
+	if( index < 0 ) {
+		return FileData();
+	}
+
+	const PackEntry& entry = _entries[index];
+	const unsigned char* bytes = _file->getData() + entry.offset;
+	if( 0 == (entry.flags & ENTRY_COMPRESSED) ) {
+		if( mapped != nullptr ) {
+			*mapped = true;
+		}
+		return FileData(_file, bytes, static_cast<size_t>(entry.size));
+	}
+
+	std::vector<unsigned char> buffer(static_cast<size_t>(entry.size));
+	uLongf size = static_cast<uLongf>(entry.size);
+	if( uncompress(buffer.data(), &size, bytes, static_cast<uLong>(entry.storedSize)) != Z_OK || size != entry.size ) {
+		return FileData();
+	}
+	return FileData(std::move(buffer));
+}
+
+int PackArchive::getEntryCount() const {
+	return _entryCount;
+}
+
+std::string PackArchive::getEntryName( int index ) const {
+	if( index < 0 || index >= _entryCount ) {
+		return "";
+	}
+	return std::string(_names + _entries[index].nameOffset, _entries[index].nameLength);
+}
+
+bool PackArchive::build( const char* directory, const char* file, int level, BuildStats* stats ) {
+	if( nullptr == directory || nullptr == file ) {
+		return false;
+	}
+
+	std::string root = normalizePath(directory);
+	while( root.size() > 1 && '/' == root.back() ) {
+		root.pop_back();
+	}
+	std::vector<std::string> files;
+	listFiles(root, files);
+	for( auto& name : files ) {
+		name = normalizePath(name.c_str());
+	}
+	// the table of contents is searched by name, so entries go in sorted
+	std::sort(files.begin(), files.end());
+
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	if( !stream.is_open() ) {
+		return false;
+	}
+
+	PackHeader header;
+	memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.version = PACK_VERSION;
+	header.entryCount = static_cast<unsigned int>(files.size());
+	header.namesSize = 0;
+	header.tocOffset = 0;
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	unsigned long long offset = sizeof(header);
+
+	BuildStats built;
+	std::vector<PackEntry> entries;
+	std::string names;
+	std::vector<unsigned char> contents;
+	std::vector<unsigned char> compressed;
+	for( const auto& name : files ) {
+		if( !readWholeFile(name, contents) ) {
+			return false;
+		}
+
+		PackEntry entry;
+		entry.size = contents.size();
+		entry.nameOffset = static_cast<unsigned int>(names.size());
+		entry.nameLength = static_cast<unsigned int>(name.size());
+		entry.flags = 0;
+		entry.reserved = 0;
+		names += name;
+
+		bool compress = false;
+		uLongf compressedSize = 0;
+		if( level > 0 && !contents.empty() ) {
+			compressed.resize(compressBound(static_cast<uLong>(contents.size())));
+			compressedSize = static_cast<uLongf>(compressed.size());
+			compress = (Z_OK == compress2(compressed.data(), &compressedSize, contents.data(), static_cast<uLong>(contents.size()), std::min(level, 9)))
+				&& compressedSize < contents.size() - contents.size() / 8;
+		}
+		if( compress ) {
+			entry.flags = ENTRY_COMPRESSED;
+			entry.offset = offset;
+			entry.storedSize = compressedSize;
+			stream.write(reinterpret_cast<const char*>(compressed.data()), compressedSize);
+			built.compressed += 1;
+		} else {
+			// aligned to a page, so the span handed out starts on a page of its own
+			padTo(stream, offset, STORED_ALIGNMENT);
+			entry.offset = offset;
+			entry.storedSize = contents.size();
+			stream.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+		}
+		offset += entry.storedSize;
+		entries.push_back(entry);
+		built.files += 1;
+		built.bytes += entry.size;
+	}
+
+	padTo(stream, offset, alignof(PackEntry));
+	header.tocOffset = offset;
+	header.namesSize = static_cast<unsigned int>(names.size());
+	if( !entries.empty() ) {
+		stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+	}
+	stream.write(names.data(), names.size());
+	built.packedBytes = offset + entries.size() * sizeof(PackEntry) + names.size();
+	stream.seekp(0);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if( !stream.good() ) {
+		return false;
+	}
+
+	if( stats != nullptr ) {
+		*stats = built;
+	}
+	return true;
+}
+
+std::string PackArchive::normalizePath( const char* path ) {
+	std::string normalized = (nullptr == path) ? "" : path;
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	while( 0 == normalized.compare(0, 2, "./") ) {
+		normalized.erase(0, 2);
+	}
+	return normalized;
+}
+
+int PackArchive::find( const std::string& name ) const {
+	int low = 0;
+	int high = _entryCount - 1;
+	while( low <= high ) {
+		const int middle = low + (high - low) / 2;
+		const PackEntry& entry = _entries[middle];
+		// compare as std::string::compare would, so that the order matches the sort the archive was built with
+		const size_t length = std::min(static_cast<size_t>(entry.nameLength), name.size());
+		int order = memcmp(_names + entry.nameOffset, name.data(), length);
+		if( 0 == order ) {
+			order = (entry.nameLength < name.size()) ? -1 : ((entry.nameLength > name.size()) ? 1 : 0);
+		}
+		if( 0 == order ) {
+			return middle;
+		}
+		if( order < 0 ) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return -1;
+}
\ No newline at end of file
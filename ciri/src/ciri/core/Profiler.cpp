@@ -0,0 +1,431 @@
+#include <ciri/core/Profiler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace ciri;
+
+std::atomic<bool> Profiler::_enabled(false);
+
+namespace {
+	// single producer (the owning thread), single consumer (endFrame)
+	struct ThreadRing {
+		ProfileEvent events[Profiler::RING_CAPACITY];
+		std::atomic<unsigned int> head;
+		std::atomic<unsigned int> tail;
+		std::atomic<bool> retired; // its thread has exited; reused by the next new thread once drained
+		int index;
+		std::string name;
+
+		ThreadRing( int threadIndex )
+			: head(0), tail(0), retired(false), index(threadIndex) {
+		}
+	};
+
+	// open scopes of one thread; only ever touched by that thread
+	struct ThreadState {
+		std::shared_ptr<ThreadRing> ring;
+		const char* names[Profiler::MAX_DEPTH];
+		long long starts[Profiler::MAX_DEPTH];
+		int depth;
+
+		ThreadState()
+			: depth(0) {
+		}
+
+		~ThreadState() {
+			if( ring != nullptr ) {
+				ring->retired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	// scopes are named with literals, so the same pointer nearly always means the same node; only a miss builds the string key
+	struct EventKey {
+		const char* name;
+		int thread;
+		int parent;
+
+		bool operator==( const EventKey& rhs ) const {
+			return name == rhs.name && thread == rhs.thread && parent == rhs.parent;
+		}
+	};
+
+	struct EventKeyHash {
+		size_t operator()( const EventKey& key ) const {
+			size_t hash = std::hash<const void*>()(key.name);
+			hash ^= std::hash<int>()(key.thread) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			hash ^= std::hash<int>()(key.parent) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			return hash;
+		}
+	};
+
+	struct ProfilerState {
+		std::mutex mutex; // guards rings and gpuEvents
+		std::vector<std::shared_ptr<ThreadRing>> rings;
+		std::vector<ProfileEvent> gpuEvents;
+		std::atomic<long long> dropped;
+		// only touched by the frame loop's thread
+		std::vector<ProfileNode> nodes;
+		std::vector<std::vector<double>> history;
+		std::unordered_map<std::string, int> lookup;
+		std::unordered_map<EventKey, int, EventKeyHash> pointerLookup;
+		std::vector<ProfileEvent> frameEvents;
+		std::vector<double> frameMs;
+		std::vector<int> frameCalls;
+		std::deque<std::vector<ProfileEvent>> traces;
+		int traceFrames;
+		int frameIndex;
+		bool frameScopeOpen;
+
+		ProfilerState()
+			: dropped(0), traceFrames(0), frameIndex(0), frameScopeOpen(false) {
+		}
+	};
+
+	ProfilerState& state() {
+		static ProfilerState s;
+		return s;
+	}
+
+	thread_local ThreadState t_thread;
+
+	ThreadRing& threadRing() {
+		if( nullptr == t_thread.ring ) {
+			ProfilerState& s = state();
+			std::lock_guard<std::mutex> lock(s.mutex);
+			// short lived threads would otherwise each leave a ring behind; take over one whose thread has exited and been drained
+			for( unsigned int i = 0; i < s.rings.size(); ++i ) {
+				ThreadRing& ring = *s.rings[i];
+				if( ring.retired.load(std::memory_order_acquire) && ring.head.load(std::memory_order_relaxed) == ring.tail.load(std::memory_order_relaxed) ) {
+					ring.retired.store(false, std::memory_order_relaxed);
+					ring.name.clear();
+					t_thread.ring = s.rings[i];
+					return ring;
+				}
+			}
+			t_thread.ring = std::make_shared<ThreadRing>(static_cast<int>(s.rings.size()));
+			s.rings.push_back(t_thread.ring);
+		}
+		return *t_thread.ring;
+	}
+
+	bool eventLess( const ProfileEvent& lhs, const ProfileEvent& rhs ) {
+		if( lhs.thread != rhs.thread ) {
+			return lhs.thread < rhs.thread;
+		}
+		if( lhs.start != rhs.start ) {
+			return lhs.start < rhs.start;
+		}
+		return lhs.depth < rhs.depth;
+	}
+
+	void writeJsonString( std::ofstream& out, const std::string& str ) {
+		out << '"';
+		for( unsigned int i = 0; i < str.size(); ++i ) {
+			const char c = str[i];
+			if( '"' == c || '\\' == c ) {
+				out << '\\' << c;
+			} else if( static_cast<unsigned char>(c) < 0x20 ) {
+				out << ' ';
+			} else {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+}
+
+ProfileNode::ProfileNode()
+	: parent(-1), depth(0), thread(0), calls(0), lastMs(0.0), minMs(0.0), avgMs(0.0), maxMs(0.0), lastFrame(-1) {
+}
+
+void Profiler::setEnabled( bool enabled ) {
+	_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName( const char* name ) {
+	ThreadRing& ring = threadRing();
+	std::lock_guard<std::mutex> lock(state().mutex);
+	ring.name = (nullptr == name) ? "" : name;
+}
+
+std::string Profiler::getThreadName( int thread ) {
+	if( GPU_THREAD == thread ) {
+		return "GPU";
+	}
+
+	ProfilerState& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	if( thread >= 0 && thread < static_cast<int>(s.rings.size()) && !s.rings[thread]->name.empty() ) {
+		return s.rings[thread]->name;
+	}
+	return "thread " + std::to_string(thread);
+}
+
+long long Profiler::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::beginScope( const char* name ) {
+	ThreadState& ts = t_thread;
+	threadRing();
+	if( ts.depth < MAX_DEPTH ) {
+		ts.names[ts.depth] = name;
+		ts.starts[ts.depth] = now();
+	} else {
+		state().dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+	ts.depth += 1;
+}
+
+void Profiler::endScope() {
+	ThreadState& ts = t_thread;
+	if( ts.depth <= 0 ) {
+		return;
+	}
+	ts.depth -= 1;
+	if( ts.depth >= MAX_DEPTH ) {
+		return;
+	}
+
+	ThreadRing& ring = *ts.ring;
+	const unsigned int head = ring.head.load(std::memory_order_relaxed);
+	if( head - ring.tail.load(std::memory_order_acquire) >= static_cast<unsigned int>(RING_CAPACITY) ) {
+		state().dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ProfileEvent& evt = ring.events[head % RING_CAPACITY];
+	evt.name = ts.names[ts.depth];
+	evt.start = ts.starts[ts.depth];
+	evt.end = now();
+	evt.depth = ts.depth;
+	evt.thread = ring.index;
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::beginFrame() {
+	ProfilerState& s = state();
+	s.frameScopeOpen = isEnabled();
+	if( s.frameScopeOpen ) {
+		beginScope("Frame");
+	}
+}
+
+void Profiler::endFrame() {
+	ProfilerState& s = state();
+	if( s.frameScopeOpen ) {
+		endScope();
+		s.frameScopeOpen = false;
+	}
+
+	// drain every ring, and whatever the gpu resolved since the last frame
+	std::vector<std::shared_ptr<ThreadRing>> rings;
+	s.frameEvents.clear();
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		rings = s.rings;
+		s.frameEvents.swap(s.gpuEvents);
+	}
+	for( unsigned int i = 0; i < rings.size(); ++i ) {
+		ThreadRing& ring = *rings[i];
+		const unsigned int head = ring.head.load(std::memory_order_acquire);
+		unsigned int tail = ring.tail.load(std::memory_order_relaxed);
+		for( ; tail != head; ++tail ) {
+			s.frameEvents.push_back(ring.events[tail % RING_CAPACITY]);
+		}
+		ring.tail.store(tail, std::memory_order_release);
+	}
+
+	if( s.frameEvents.empty() ) {
+		s.frameIndex += 1;
+		return;
+	}
+
+	// scopes are written when they close, so children come before parents; order by start to rebuild the nesting
+	std::sort(s.frameEvents.begin(), s.frameEvents.end(), eventLess);
+
+	std::fill(s.frameMs.begin(), s.frameMs.end(), 0.0);
+	std::fill(s.frameCalls.begin(), s.frameCalls.end(), 0);
+	int stack[MAX_DEPTH]; // node of the open scope at each depth of the current thread
+	for( unsigned int i = 0; i < s.frameEvents.size(); ++i ) {
+		const ProfileEvent& evt = s.frameEvents[i];
+		if( 0 == i || evt.thread != s.frameEvents[i - 1].thread ) {
+			std::fill(stack, stack + MAX_DEPTH, -1);
+		}
+
+		// a parent dropped from a full ring leaves a gap; attach to the nearest ancestor still known
+		int parent = -1;
+		for( int d = evt.depth - 1; d >= 0; --d ) {
+			if( stack[d] != -1 ) {
+				parent = stack[d];
+				break;
+			}
+		}
+
+		const EventKey pointerKey = {evt.name, evt.thread, parent};
+		int index = -1;
+		const auto pointerFound = s.pointerLookup.find(pointerKey);
+		if( pointerFound != s.pointerLookup.end() ) {
+			index = pointerFound->second;
+		} else {
+			const std::string key = std::to_string(evt.thread) + ":" + std::to_string(parent) + ":" + evt.name;
+			const auto found = s.lookup.find(key);
+			if( found != s.lookup.end() ) {
+				index = found->second;
+			} else {
+				index = static_cast<int>(s.nodes.size());
+				ProfileNode node;
+				node.name = evt.name;
+				node.parent = parent;
+				node.depth = (-1 == parent) ? 0 : s.nodes[parent].depth + 1;
+				node.thread = evt.thread;
+				s.nodes.push_back(node);
+				s.history.push_back(std::vector<double>());
+				s.frameMs.push_back(0.0);
+				s.frameCalls.push_back(0);
+				s.lookup[key] = index;
+			}
+			s.pointerLookup[pointerKey] = index;
+		}
+
+		stack[evt.depth] = index;
+		for( int d = evt.depth + 1; d < MAX_DEPTH; ++d ) {
+			stack[d] = -1;
+		}
+		s.frameMs[index] += static_cast<double>(evt.end - evt.start) * 0.000001;
+		s.frameCalls[index] += 1;
+	}
+
+	for( unsigned int i = 0; i < s.nodes.size(); ++i ) {
+		if( 0 == s.frameCalls[i] ) {
+			continue;
+		}
+		ProfileNode& node = s.nodes[i];
+		node.calls = s.frameCalls[i];
+		node.lastMs = s.frameMs[i];
+		node.lastFrame = s.frameIndex;
+
+		std::vector<double>& history = s.history[i];
+		if( history.size() >= static_cast<unsigned int>(HISTORY) ) {
+			history.erase(history.begin());
+		}
+		history.push_back(node.lastMs);
+		node.minMs = *std::min_element(history.begin(), history.end());
+		node.maxMs = *std::max_element(history.begin(), history.end());
+		double total = 0.0;
+		for( unsigned int j = 0; j < history.size(); ++j ) {
+			total += history[j];
+		}
+		node.avgMs = total / static_cast<double>(history.size());
+	}
+
+	if( s.traceFrames > 0 ) {
+		s.traces.push_back(s.frameEvents);
+		while( static_cast<int>(s.traces.size()) > s.traceFrames ) {
+			s.traces.pop_front();
+		}
+	}
+
+	s.frameIndex += 1;
+}
+
+void Profiler::addGpuEvents( const ProfileEvent* events, int count ) {
+	if( nullptr == events || count <= 0 ) {
+		return;
+	}
+
+	ProfilerState& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for( int i = 0; i < count; ++i ) {
+		if( events[i].depth < 0 || events[i].depth >= MAX_DEPTH ) {
+			continue;
+		}
+		s.gpuEvents.push_back(events[i]);
+		s.gpuEvents.back().thread = GPU_THREAD;
+	}
+}
+
+const std::vector<ProfileNode>& Profiler::getNodes() {
+	return state().nodes;
+}
+
+long long Profiler::getDroppedCount() {
+	return state().dropped.load(std::memory_order_relaxed);
+}
+
+int Profiler::getFrameIndex() {
+	return state().frameIndex;
+}
+
+void Profiler::reset() {
+	ProfilerState& s = state();
+	s.nodes.clear();
+	s.history.clear();
+	s.lookup.clear();
+	s.pointerLookup.clear();
+	s.frameMs.clear();
+	s.frameCalls.clear();
+	s.traces.clear();
+	s.frameIndex = 0;
+	s.dropped.store(0, std::memory_order_relaxed);
+}
+
+void Profiler::setTraceFrames( int frames ) {
+	ProfilerState& s = state();
+	s.traceFrames = (frames > 0) ? frames : 0;
+	while( static_cast<int>(s.traces.size()) > s.traceFrames ) {
+		s.traces.pop_front();
+	}
+}
+
+bool Profiler::writeChromeTrace( const char* file ) {
+	if( nullptr == file ) {
+		return false;
+	}
+	std::ofstream out(file);
+	if( !out.is_open() ) {
+		return false;
+	}
+
+	ProfilerState& s = state();
+	long long origin = 0;
+	bool hasOrigin = false;
+	int maxThread = GPU_THREAD;
+	for( const auto& frame : s.traces ) {
+		for( const auto& evt : frame ) {
+			if( !hasOrigin || evt.start < origin ) {
+				origin = evt.start;
+				hasOrigin = true;
+			}
+			maxThread = std::max(maxThread, evt.thread);
+		}
+	}
+
+	// tid 0 is the gpu so that threads keep their order below it
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+	for( int thread = GPU_THREAD; thread <= maxThread; ++thread ) {
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (thread + 1) << ",\"args\":{\"name\":";
+		writeJsonString(out, getThreadName(thread));
+		out << "}}";
+		first = false;
+	}
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	for( const auto& frame : s.traces ) {
+		for( const auto& evt : frame ) {
+			out << ",\n{\"name\":";
+			writeJsonString(out, evt.name);
+			out << ",\"cat\":\"" << ((GPU_THREAD == evt.thread) ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (evt.thread + 1);
+			out << ",\"ts\":" << static_cast<double>(evt.start - origin) * 0.001 << ",\"dur\":" << static_cast<double>(evt.end - evt.start) * 0.001 << "}";
+		}
+	}
+	out << "\n]}\n";
+	return out.good();
+}
\ No newline at end of file
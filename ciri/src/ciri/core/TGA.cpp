@@ -1,4 +1,6 @@
 #include <ciri/core/TGA.hpp>
+#include <ciri/core/FileSystem.hpp>
+#include <cstring>
 #include <fstream>
 
 using namespace ciri;
@@ -12,8 +14,8 @@ TGA::~TGA() {
 }
 
 bool TGA::loadFromFile( const char* file, bool forceRGBA ) {
-	std::ifstream in(file, std::ios::binary);
-	if( !in.is_open() ) {
+	FileDataStream in(FileSystem::read(file));
+	if( !in ) {
 		return false;
 	}
 
@@ -91,8 +93,6 @@ bool TGA::loadFromFile( const char* file, bool forceRGBA ) {
 		return false;
 	}
 
-	in.close();
-
 	// if rgba was requested but the image is rgb, create a new buffer with an A channel and delete the old one.
 	// can't do this normally as the data is read in one big chunk.
 	if( forceRGBA && _format != RGBA ) {
@@ -0,0 +1,63 @@
+#include <ciri/core/Timer.hpp>
+#include <chrono>
+#include <memory>
+
+using namespace ciri;
+
+	Timer::Timer()
+		: ITimer() {
+		stop();
+	}
+
+	Timer::~Timer() {
+	}
+
+	void Timer::start() {
+		_isPaused = false;
+		_startTicks = now();
+	}
+	
+	void Timer::pause() {
+		_isPaused = true;
+		_endTicks = now();
+	}
+	
+	void Timer::stop() {
+		_startTicks = 0;
+		_endTicks = 0;
+		_isPaused = true;
+	}
+	
+	void Timer::restart() {
+		stop();
+		start();
+	}
+
+	long long Timer::getElapsedNanosecs() {
+		if( !_isPaused ) {
+			_endTicks = now();
+		}
+		return _endTicks - _startTicks;
+	}
+	
+	double Timer::getElapsedMicrosecs() {
+		return static_cast<double>(getElapsedNanosecs()) * 0.001;
+	}
+	
+	double Timer::getElapsedMillisecs() {
+		return static_cast<double>(getElapsedNanosecs()) * 0.000001;
+	}
+	
+	double Timer::getElapsedSecs() {
+		return static_cast<double>(getElapsedNanosecs()) * 0.000000001;
+	}
+
+	long long Timer::now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	namespace ciri {
+	std::shared_ptr<ITimer> createTimer() {
+		return std::shared_ptr<ITimer>(new Timer());
+	}
+	}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <ciri/core/input/null/NullInput.hpp>
+
+using namespace ciri;
+
+NullInput::NullInput()
+	: IInput() {
+}
+
+NullInput::~NullInput() {
+}
+
+bool NullInput::create( std::shared_ptr<IWindow> window ) {
+	return (window != nullptr);
+}
+
+bool NullInput::poll() {
+	return true;
+}
+
+bool NullInput::update() {
+	return true;
+}
+
+bool NullInput::isKeyDown( Key ) const {
+	return false;
+}
+
+bool NullInput::isKeyUp( Key ) const {
+	return true;
+}
+
+bool NullInput::wasKeyDown( Key ) const {
+	return false;
+}
+
+bool NullInput::wasKeyUp( Key ) const {
+	return true;
+}
+
+bool NullInput::isMouseButtonDown( MouseButton ) const {
+	return false;
+}
+
+bool NullInput::isMouseButtonUp( MouseButton ) const {
+	return true;
+}
+
+bool NullInput::wasMouseButtonDown( MouseButton ) const {
+	return false;
+}
+
+bool NullInput::wasMouseButtonUp( MouseButton ) const {
+	return true;
+}
+
+int NullInput::mouseX() const {
+	return 0;
+}
+
+int NullInput::mouseY() const {
+	return 0;
+}
+
+int NullInput::lastMouseX() const {
+	return 0;
+}
+
+int NullInput::lastMouseY() const {
+	return 0;
+}
+
+
+#ifndef _WIN32
+// without a Win32 window there is nothing to read input from, so the null input is the platform's input
+namespace ciri {
+std::shared_ptr<IInput> createInput() {
+	return std::shared_ptr<IInput>(new NullInput());
+}
+}
+#endif
\ No newline at end of file
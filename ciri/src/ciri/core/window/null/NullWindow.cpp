@@ -0,0 +1,67 @@
+#include <ciri/core/window/null/NullWindow.hpp>
+#include <memory>
+
+using namespace ciri;
+
+NullWindow::NullWindow()
+	: IWindow(), _isOpen(false), _width(0), _height(0) {
+}
+
+NullWindow::~NullWindow() {
+}
+
+bool NullWindow::create( int width, int height ) {
+	if( _isOpen || width <= 0 || height <= 0 ) {
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+	_isOpen = true;
+	return true;
+}
+
+bool NullWindow::isOpen() const {
+	return _isOpen;
+}
+
+bool NullWindow::pollEvent( WindowEvent& ) {
+	return false;
+}
+
+void NullWindow::close() {
+	_isOpen = false;
+}
+
+void NullWindow::setWindowText( const char* str ) {
+	_text = (str != nullptr) ? str : "";
+}
+
+int NullWindow::getWidth() const {
+	return _width;
+}
+
+int NullWindow::getHeight() const {
+	return _height;
+}
+
+bool NullWindow::hasFocus() const {
+	return _isOpen;
+}
+
+void* NullWindow::getNativeHandle() const {
+	return nullptr;
+}
+
+void NullWindow::setCursorVisible( bool ) {
+}
+
+
+#ifndef _WIN32
+// without a Win32 window there is nothing to show, so the null window is the platform's window
+namespace ciri {
+std::shared_ptr<IWindow> createWindow() {
+	return std::shared_ptr<IWindow>(new NullWindow());
+}
+}
+#endif
\ No newline at end of file
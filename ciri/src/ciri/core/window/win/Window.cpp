@@ -110,7 +110,8 @@ bool Window::createWindow( int width, int height ) {
 	wc.hbrBackground = (HBRUSH)(COLOR_WINDOW+1);
 	wc.lpszMenuName = NULL;
 	wc.lpszClassName = "CIRI";
-	if( !RegisterClassEx(&wc) ) {
+	// an earlier window in this process may have registered it already
+	if( !RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS ) {
 		return false;
 	}
 
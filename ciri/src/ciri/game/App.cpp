@@ -1,10 +1,19 @@
 #include <ciri/game/App.hpp>
+#include <ciri/core/window/null/NullWindow.hpp>
+#include <ciri/core/input/null/NullInput.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+#include <cmath>
 
 using namespace ciri;
 
+namespace {
+	const double MS_PER_UPDATE = 1.0 / 60.0;
+}
+
 App::App()
-	: _isRunning(false), _isInitialized(false), _shouldGtfo(false), _window(nullptr), _input(nullptr),
-		_graphicsDevice(nullptr), _gameTimer(nullptr) {
+	: _isRunning(false), _isInitialized(false), _shouldGtfo(false), _startTime(0), _startupSeconds(0.0), _window(nullptr), _input(nullptr),
+		_graphicsDevice(nullptr), _gameTimer(nullptr), _jobSystem(nullptr), _frame(0), _elapsedTime(0.0), _lag(0.0),
+		_droppedFixedSteps(0), _updateSnapshot(0), _simulationPending(false), _simulationStopping(false), _simulationDelta(0.0) {
 }
 
 App::~App() {
@@ -44,62 +53,299 @@ bool App::run() {
 		printf("ciri error: Failed to run because graphics device creation failed.\n");
 		return false;
 	}
+	_graphicsDevice->setConstantRingSize(_config.constantRingSize);
+	if( !_config.shaderCacheDirectory.empty() && !_graphicsDevice->setShaderCacheDirectory(_config.shaderCacheDirectory.c_str()) ) {
+		printf("ciri warning: Failed to use shader cache directory %s.\n", _config.shaderCacheDirectory.c_str());
+	}
 
 	// create game timer
 	_gameTimer = ciri::createTimer();
 
+	// create job system; its workers start now so that loading content can use them too
+	_jobSystem = std::make_shared<JobSystem>();
+	_jobSystem->create(_config.jobThreads);
+
+	mountContent();
+
+	_startTime = Profiler::now();
 	onInitialize();
 	onLoadContent();
 
 	// start game timer
 	_gameTimer->start();
 
-	const double MS_PER_UPDATE = 1.0 / 60.0;
-	double elapsedTime = 0.0;
-	double lastTime = 0.0;
-	double lag = 0.0;
+	runLoop(_config.frameLimit);
+
+	onUnloadContent();
+	cleanup();
+
+	return true;
+}
+
+bool App::runHeadless( int frameCount, GraphicsCommandStream* recorded ) {
+	if( _isRunning ) {
+		printf("ciri error: Failed to run because already running.\n");
+		return false;
+	}
+
+	if( _isInitialized ) {
+		printf("ciri error: Failed to run because already initialized.\n");
+		return false;
+	}
+
+	_window = std::make_shared<NullWindow>();
+	if( !_window->create(_config.width, _config.height) ) {
+		printf("ciri error: Failed to run because window creation failed.\n");
+		return false;
+	}
+	_window->setWindowText(_config.title.c_str());
+
+	_input = std::make_shared<NullInput>();
+	if( !_input->create(_window) ) {
+		printf("ciri error: Failed to run because input creation failed.\n");
+		return false;
+	}
+
+	const std::shared_ptr<NullGraphicsDevice> device = std::make_shared<NullGraphicsDevice>();
+	_graphicsDevice = device;
+	if( !_graphicsDevice->create(_window) ) {
+		printf("ciri error: Failed to run because graphics device creation failed.\n");
+		return false;
+	}
+	_graphicsDevice->setConstantRingSize(_config.constantRingSize);
+
+	// no timer; time advances by a fixed step per frame so runs are deterministic
+	_gameTimer = nullptr;
+
+	_jobSystem = std::make_shared<JobSystem>();
+	_jobSystem->create(_config.jobThreads);
+
+	mountContent();
+
+	_startTime = Profiler::now();
+	onInitialize();
+	onLoadContent();
+
+	runLoop(frameCount);
+
+	onUnloadContent();
+
+	// copy out before the device is destroyed
+	if( recorded != nullptr ) {
+		*recorded = device->getCommandStream();
+	}
+
+	cleanup();
+
+	return true;
+}
+
+AppConfig& App::getConfig() {
+	return _config;
+}
+
+double App::getStartupSeconds() const {
+	return _startupSeconds;
+}
+
+RenderSnapshot& App::updateSnapshot() {
+	return _snapshots[_updateSnapshot];
+}
+
+const RenderSnapshot& App::drawSnapshot() const {
+	return _snapshots[_updateSnapshot ^ 1];
+}
+
+const FramePacer& App::framePacer() const {
+	return _framePacer;
+}
+
+int App::getDroppedFixedSteps() const {
+	return _droppedFixedSteps;
+}
+
+void App::runLoop( int maxFrames ) {
+	long long lastTime = 0;
+	_frame = 0;
+	_elapsedTime = 0.0;
+	_lag = 0.0;
+	_droppedFixedSteps = 0;
+	_updateSnapshot = 0;
+	_snapshots[0] = RenderSnapshot();
+	_snapshots[1] = RenderSnapshot();
 	_isRunning = true;
-	while( _isRunning && !_shouldGtfo ) {
+	Profiler::setThreadName("main");
+	if( _config.profile ) {
+		Profiler::setEnabled(true);
+	}
+	if( _config.pipelined ) {
+		startSimulationThread();
+	}
+	_framePacer.setTargetRate(_config.targetFrameRate);
+	while( _isRunning && !_shouldGtfo && (maxFrames < 0 || _frame < maxFrames) ) {
+		// outside of the profiled frame, so that frame times show the work rather than the wait
+		_framePacer.wait();
+		Profiler::beginFrame();
+
 		ciri::WindowEvent evt;
 		while( _window->pollEvent(evt) ) {
 			onEvent(evt);
 		}
 
-		const double currTime = _gameTimer->getElapsedMicrosecs();
-		const double deltaTime = (currTime - lastTime) * 0.000001;
-		lastTime = currTime;
-		elapsedTime += deltaTime;
-		lag += deltaTime;
+		// whole nanoseconds between readings, so no time is lost to rounding however long the app runs
+		double deltaTime = MS_PER_UPDATE;
+		if( _config.benchmarkDelta > 0.0 ) {
+			deltaTime = _config.benchmarkDelta;
+		} else if( _gameTimer != nullptr ) {
+			const long long currTime = _gameTimer->getElapsedNanosecs();
+			deltaTime = static_cast<double>(currTime - lastTime) * 0.000000001;
+			lastTime = currTime;
+		}
 
 		if( !_input->poll() ) {
 			printf("ciri warning: Failed to poll input.\n");
 		}
 
-		onUpdate(deltaTime, elapsedTime);
-
-		while( lag >= MS_PER_UPDATE ) {
-			onFixedUpdate(MS_PER_UPDATE, elapsedTime);
-			lag -= MS_PER_UPDATE;
+		if( _config.pipelined ) {
+			// hand this frame to the simulation and draw the last one meanwhile; waiting for it here keeps drawing at most one frame behind
+			{
+				std::lock_guard<std::mutex> lock(_simulationMutex);
+				_simulationDelta = deltaTime;
+				_simulationPending = true;
+			}
+			_simulationCondition.notify_all();
+			if( _frame > 0 ) {
+				draw();
+			}
+			{
+				CIRI_PROFILE_SCOPE("Wait for simulation");
+				std::unique_lock<std::mutex> lock(_simulationMutex);
+				_simulationCondition.wait(lock, [this]{ return !_simulationPending; });
+			}
+		} else {
+			simulate(deltaTime);
 		}
 
 		if( !_input->update() ) {
 			printf("ciri warning: Failed to update input.\n");
 		}
 
-		onDraw();
+		_updateSnapshot ^= 1;
+		if( !_config.pipelined ) {
+			draw();
+		}
+
+		Profiler::endFrame();
+		if( 0 == _frame ) {
+			_startupSeconds = static_cast<double>(Profiler::now() - _startTime) * 0.000000001;
+		}
+		_frame += 1;
 	}
+	if( _config.pipelined ) {
+		stopSimulationThread();
+		// the frame simulated last is still waiting to be drawn; draw it so both loops draw every frame they simulate
+		if( _frame > 0 ) {
+			Profiler::beginFrame();
+			draw();
+			Profiler::endFrame();
+		}
+	}
+	_isRunning = false;
+}
 
-	onUnloadContent();
+void App::simulate( double deltaTime ) {
+	RenderSnapshot& snapshot = _snapshots[_updateSnapshot];
+	snapshot.clear();
+	_elapsedTime += deltaTime;
+	_lag += deltaTime;
+
+	{
+		CIRI_PROFILE_SCOPE("Update");
+		onUpdate(deltaTime, _elapsedTime);
+	}
 
-	// clean resources
+	int steps = 0;
+	while( _lag >= MS_PER_UPDATE ) {
+		if( _config.maxFixedSteps > 0 && steps == _config.maxFixedSteps ) {
+			// too far behind to catch up; running the rest would only make the next frame later, so let the simulation fall behind wall time
+			const double remainder = std::fmod(_lag, MS_PER_UPDATE);
+			_droppedFixedSteps += static_cast<int>((_lag - remainder) / MS_PER_UPDATE + 0.5);
+			_lag = remainder;
+			break;
+		}
+		CIRI_PROFILE_SCOPE("FixedUpdate");
+		onFixedUpdate(MS_PER_UPDATE, _elapsedTime);
+		_lag -= MS_PER_UPDATE;
+		steps += 1;
+	}
+
+	snapshot.frame = _frame;
+	snapshot.elapsedTime = _elapsedTime;
+	snapshot.alpha = _lag / MS_PER_UPDATE;
+}
+
+void App::draw() {
+	CIRI_PROFILE_SCOPE("Draw");
+	onDraw();
+}
+
+void App::startSimulationThread() {
+	_simulationPending = false;
+	_simulationStopping = false;
+	_simulationThread = std::thread(&App::simulationMain, this);
+}
+
+void App::stopSimulationThread() {
+	{
+		std::lock_guard<std::mutex> lock(_simulationMutex);
+		_simulationStopping = true;
+	}
+	_simulationCondition.notify_all();
+	_simulationThread.join();
+}
+
+void App::simulationMain() {
+	Profiler::setThreadName("simulation");
+	std::unique_lock<std::mutex> lock(_simulationMutex);
+	while( true ) {
+		_simulationCondition.wait(lock, [this]{ return _simulationPending || _simulationStopping; });
+		if( !_simulationPending ) {
+			return;
+		}
+		const double deltaTime = _simulationDelta;
+		lock.unlock();
+		simulate(deltaTime);
+		lock.lock();
+		_simulationPending = false;
+		_simulationCondition.notify_all();
+	}
+}
+
+void App::mountContent() {
+	_mountedPack.clear();
+	if( _config.packFile.empty() ) {
+		return;
+	}
+	if( !FileSystem::mount(_config.packFile.c_str()) ) {
+		printf("ciri warning: Failed to mount pack file %s; loading loose files instead.\n", _config.packFile.c_str());
+		return;
+	}
+	_mountedPack = _config.packFile;
+}
+
+void App::cleanup() {
+	if( !_mountedPack.empty() ) {
+		FileSystem::unmount(_mountedPack.c_str());
+		_mountedPack.clear();
+	}
+	_jobSystem->destroy();
+	_jobSystem = nullptr;
 	_input = nullptr;
 	_gameTimer = nullptr;
 	_graphicsDevice->destroy();
 	_graphicsDevice = nullptr;
 	_window->close();
 	_window = nullptr;
-
-	return true;
 }
 
 void App::onInitialize() {
@@ -146,4 +392,8 @@ std::shared_ptr<ciri::IGraphicsDevice> App::graphicsDevice() const {
 
 std::shared_ptr<ciri::ITimer> App::gameTimer() const {
 	return _gameTimer;
+}
+
+std::shared_ptr<ciri::JobSystem> App::jobSystem() const {
+	return _jobSystem;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <ciri/game/FreeTypeSpriteFont.hpp>
 #include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/core/FileSystem.hpp>
 
 using namespace ciri;
 
@@ -25,7 +26,9 @@ ErrorCode FreeTypeSpriteFont::loadFromFile( const char* file ) {
 		return ErrorCode::CIRI_UNKNOWN_ERROR; // todo: failed to load font library
 	}
 
-	if( FT_New_Face(_ftLibrary, file, 0, &_ftFace) != FT_Err_Ok ) {
+	// read through the file system so that fonts can come out of pack archives
+	_fontData = FileSystem::read(file);
+	if( !_fontData.isValid() || FT_New_Memory_Face(_ftLibrary, _fontData.getData(), static_cast<FT_Long>(_fontData.getSize()), 0, &_ftFace) != FT_Err_Ok ) {
 		return ErrorCode::CIRI_UNKNOWN_ERROR; // todo: failed to load font file
 	}
 
@@ -0,0 +1,122 @@
+#include <ciri/game/ProfilerOverlay.hpp>
+#include <algorithm>
+#include <cstdio>
+
+using namespace ciri;
+
+static const cc::Vec4f HEADER_COLOR(1.0f, 0.85f, 0.3f, 1.0f);
+static const cc::Vec4f TEXT_COLOR(1.0f, 1.0f, 1.0f, 1.0f);
+static const cc::Vec4f CPU_BAR_COLOR(0.2f, 0.6f, 1.0f, 0.5f);
+static const cc::Vec4f GPU_BAR_COLOR(0.3f, 0.9f, 0.3f, 0.5f);
+
+ProfilerOverlay::ProfilerOverlay()
+	: _budgetMs(1000.0 / 60.0) {
+}
+
+ProfilerOverlay::~ProfilerOverlay() {
+	clean();
+}
+
+bool ProfilerOverlay::create( const std::shared_ptr<IGraphicsDevice>& device, const std::shared_ptr<ISpriteFont>& font ) {
+	if( nullptr == device || nullptr == font ) {
+		return false;
+	}
+
+	unsigned char white[4] = {255, 255, 255, 255};
+	_pixel = device->createTexture2D(1, 1, TextureFormat::RGBA32_UINT, 0, white);
+	if( nullptr == _pixel ) {
+		return false;
+	}
+	_font = font;
+	return true;
+}
+
+void ProfilerOverlay::clean() {
+	_pixel = nullptr;
+	_font = nullptr;
+}
+
+void ProfilerOverlay::setBudget( double ms ) {
+	_budgetMs = (ms > 0.0) ? ms : (1000.0 / 60.0);
+}
+
+void ProfilerOverlay::draw( SpriteBatch& spritebatch, const cc::Vec2f& position ) {
+	if( nullptr == _font || nullptr == _pixel ) {
+		return;
+	}
+
+	const std::vector<ProfileNode>& nodes = Profiler::getNodes();
+	const int oldestFrame = Profiler::getFrameIndex() - STALE_FRAMES;
+
+	// nodes only know their parent, so gather each one's children; parents come first, so a hidden parent hides its subtree
+	_children.resize(nodes.size());
+	for( unsigned int i = 0; i < _children.size(); ++i ) {
+		_children[i].clear();
+	}
+	_roots.clear();
+	std::vector<bool> visible(nodes.size(), false);
+	for( unsigned int i = 0; i < nodes.size(); ++i ) {
+		const ProfileNode& node = nodes[i];
+		if( node.lastFrame < oldestFrame ) {
+			continue;
+		}
+		if( -1 == node.parent ) {
+			visible[i] = true;
+			_roots.push_back(static_cast<int>(i));
+		} else if( visible[node.parent] ) {
+			visible[i] = true;
+			_children[node.parent].push_back(static_cast<int>(i));
+		}
+	}
+
+	// cpu threads in order, then the gpu
+	std::stable_sort(_roots.begin(), _roots.end(), [&nodes]( int lhs, int rhs ) {
+		const unsigned int lhsThread = static_cast<unsigned int>(nodes[lhs].thread);
+		const unsigned int rhsThread = static_cast<unsigned int>(nodes[rhs].thread);
+		return lhsThread < rhsThread;
+	});
+
+	float y = position.y;
+	int thread = 0;
+	for( unsigned int i = 0; i < _roots.size(); ++i ) {
+		const ProfileNode& root = nodes[_roots[i]];
+		if( 0 == i || root.thread != thread ) {
+			thread = root.thread;
+			spritebatch.drawString(_font, Profiler::getThreadName(thread), cc::Vec2f(position.x, y), HEADER_COLOR, 1.0f, 0.0f, 1.0f);
+			y += static_cast<float>(_font->getLineSpacing());
+		}
+		drawNode(spritebatch, _roots[i], position.x, &y);
+	}
+
+	if( Profiler::getDroppedCount() > 0 ) {
+		char text[64];
+		snprintf(text, sizeof(text), "dropped %lld", Profiler::getDroppedCount());
+		spritebatch.drawString(_font, text, cc::Vec2f(position.x, y), HEADER_COLOR, 1.0f, 0.0f, 1.0f);
+	}
+}
+
+void ProfilerOverlay::drawNode( SpriteBatch& spritebatch, int index, float x, float* y ) {
+	const ProfileNode& node = Profiler::getNodes()[index];
+	const float lineHeight = static_cast<float>(_font->getLineSpacing());
+	const float indent = static_cast<float>(_font->getSize());
+	const float nameWidth = static_cast<float>(_font->getSize()) * 12.0f;
+
+	// bar first so the text is drawn over it
+	const double fraction = std::min(node.avgMs / _budgetMs, 1.0);
+	const float barWidth = nameWidth * static_cast<float>(fraction);
+	if( barWidth > 0.0f ) {
+		const cc::Vec4f& barColor = (Profiler::GPU_THREAD == node.thread) ? GPU_BAR_COLOR : CPU_BAR_COLOR;
+		spritebatch.draw(_pixel, cc::Vec2f(x, *y), 0.0f, cc::Vec2f(0.0f, 0.0f), cc::Vec2f(barWidth, lineHeight * 0.8f), 1.0f, barColor);
+	}
+
+	char stats[128];
+	snprintf(stats, sizeof(stats), "%6.2f  avg %6.2f  min %6.2f  max %6.2f  x%d", node.lastMs, node.avgMs, node.minMs, node.maxMs, node.calls);
+	spritebatch.drawString(_font, node.name, cc::Vec2f(x + indent * static_cast<float>(node.depth + 1), *y), TEXT_COLOR, 1.0f, 0.0f, 1.0f);
+	spritebatch.drawString(_font, stats, cc::Vec2f(x + nameWidth + indent, *y), TEXT_COLOR, 1.0f, 0.0f, 1.0f);
+	*y += lineHeight;
+
+	const std::vector<int>& children = _children[index];
+	for( unsigned int i = 0; i < children.size(); ++i ) {
+		drawNode(spritebatch, children[i], x, y);
+	}
+}
\ No newline at end of file
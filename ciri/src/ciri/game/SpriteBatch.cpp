@@ -1,10 +1,13 @@
 #include <ciri/game/SpriteBatch.hpp>
 #include <cc/MatrixFunc.hpp>
+#include <ciri/graphics/VertexPacking.hpp>
+#include <ciri/core/Profiler.hpp>
+#include <cstring>
 
 using namespace ciri;
 
 SpriteBatch::SpriteBatch()
-	: _beginCalled(false), _sortMode(SpriteSortMode::Deferred), _vertexArray(nullptr), _vertexArraySize(0) {
+	: _beginCalled(false), _sortMode(SpriteSortMode::Deferred), _vertexArray(nullptr), _vertexArraySize(0), _rawVertexCount(0), _compact(false) {
 }
 
 SpriteBatch::~SpriteBatch() {
@@ -14,17 +17,16 @@ SpriteBatch::~SpriteBatch() {
 	}
 }
 
-bool SpriteBatch::create( const std::shared_ptr<ciri::IGraphicsDevice>& device ) {
+bool SpriteBatch::create( const std::shared_ptr<ciri::IGraphicsDevice>& device, bool compact ) {
 	// store gfx device
 	_device = device;
+	_compact = compact;
 
 	_spritesBuffer = device->createVertexBuffer();
 
 	// load and configure shader and constants
 	_defaultShader = device->createShader();
-	_defaultShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
-	_defaultShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float2, ciri::VertexUsage::Texcoord, 0));
-	_defaultShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float4, ciri::VertexUsage::Color, 0));
+	addInputElements(_defaultShader, _compact);
 	const std::string shaderExt = device->getShaderExt();
 	const std::string vsFile = ("data/shaders/SpriteBatch_vs" + shaderExt);
 	//const std::string gsFile = ("data/shaders/SpriteBatch_gs" + shaderExt);
@@ -49,6 +51,13 @@ bool SpriteBatch::create( const std::shared_ptr<ciri::IGraphicsDevice>& device )
 	return true;
 }
 
+void SpriteBatch::addInputElements( const std::shared_ptr<ciri::IShader>& shader, bool compact ) {
+	// compact formats are expanded to floats by the input assembler, so the same shader source reads either layout
+	shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
+	shader->addInputElement(ciri::VertexElement(compact ? ciri::VertexFormat::Half2 : ciri::VertexFormat::Float2, ciri::VertexUsage::Texcoord, 0));
+	shader->addInputElement(ciri::VertexElement(compact ? ciri::VertexFormat::UNorm8x4 : ciri::VertexFormat::Float4, ciri::VertexUsage::Color, 0));
+}
+
 bool SpriteBatch::begin( const std::shared_ptr<ciri::IBlendState>& blendState, const std::shared_ptr<ciri::ISamplerState>& samplerState, const std::shared_ptr<ciri::IDepthStencilState>& depthStencilState, const std::shared_ptr<ciri::IRasterizerState>& rasterizerState, SpriteSortMode sortMode, const std::shared_ptr<ciri::IShader>& shader ) {
 	// check for bad inputs (shader is optional and will be set to a default one if it is null, so don't check it)
 	if( nullptr == blendState || nullptr == samplerState || nullptr == depthStencilState || nullptr == rasterizerState ) {
@@ -58,8 +67,8 @@ bool SpriteBatch::begin( const std::shared_ptr<ciri::IBlendState>& blendState, c
 	// save custom shader if provided
 	_shader = (shader != nullptr) ? shader : _defaultShader;
 
-	// must have a valid shader set
-	if( !_shader->isValid() ) {
+	// must have a valid shader set; one still compiling is finished when end applies it
+	if( !_shader->isValid() && !_shader->isPending() ) {
 		return false;
 	}
 
@@ -176,7 +185,31 @@ void SpriteBatch::drawString( const std::shared_ptr<ISpriteFont>& font, const st
 	}
 }
 
+SpriteVertex* SpriteBatch::reserveQuads( const std::shared_ptr<ciri::ITexture2D>& texture, int quadCount, float depth ) {
+	if( nullptr == texture || quadCount <= 0 ) {
+		return nullptr;
+	}
+
+	const int vertexCount = quadCount * 6;
+	const int requiredSize = _rawVertexCount + vertexCount;
+	if( static_cast<int>(_rawVertexArray.size()) < requiredSize ) {
+		_rawVertexArray.resize(requiredSize);
+	}
+
+	const auto item = createBatchItem();
+	item->texture = texture;
+	item->depth = depth;
+	item->quadCount = quadCount;
+	item->rawOffset = _rawVertexCount;
+
+	SpriteVertex* vertices = &_rawVertexArray[_rawVertexCount];
+	_rawVertexCount += vertexCount;
+	return vertices;
+}
+
 bool SpriteBatch::end() {
+	CIRI_PROFILE_SCOPE("SpriteBatch::end");
+
 	// cannot end without begin
 	if( false == _beginCalled ) {
 		return false;
@@ -192,7 +225,14 @@ bool SpriteBatch::end() {
 
 	const int batchCount = static_cast<int>(_batchItemList.size());
 
-	ensureArrayCapacity(batchCount);
+	// single sprites take 6 vertices; raw blocks take 6 per quad
+	int vertexCount = 0;
+	for( int i = 0; i < batchCount; ++i ) {
+		const int quads = _batchItemList[i]->quadCount;
+		vertexCount += (quads > 0) ? quads * 6 : 6;
+	}
+
+	ensureArrayCapacity(vertexCount);
 
 	// sort array
 	switch( _sortMode ) {
@@ -226,6 +266,12 @@ bool SpriteBatch::end() {
 	int batchIndex = 0;
 	for( int i = 0; i < batchCount; ++i ) {
 		const auto& item = _batchItemList[i];
+		if( item->quadCount > 0 ) {
+			const int count = item->quadCount * 6;
+			memcpy(&_vertexArray[batchIndex], &_rawVertexArray[item->rawOffset], sizeof(SpriteVertex) * count);
+			batchIndex += count;
+			continue;
+		}
 		_vertexArray[batchIndex++] = item->topLeft;     // t0
 		_vertexArray[batchIndex++] = item->bottomRight; // t0
 		_vertexArray[batchIndex++] = item->bottomLeft;  // t0
@@ -252,18 +298,22 @@ bool SpriteBatch::end() {
 			boundTexture = item->texture;
 
 			// reset start index
-			startIndex = i * 6;
+			startIndex = endIndex;
 		}
 
 		// update end index
-		endIndex += 1 * 6;
+		endIndex += (item->quadCount > 0) ? item->quadCount * 6 : 6;
 
 		item->texture = nullptr;
+		item->quadCount = 0;
 		_freeBatchItemQueue.push(item);
 	}
 	// draw remaining items
 	flush(startIndex, endIndex, boundTexture);
 
+	// discard raw vertices
+	_rawVertexCount = 0;
+
 	// discard batched items
 	_batchItemList.clear();
 
@@ -302,7 +352,12 @@ bool SpriteBatch::configure() {
 	}
 
 	// update vertex buffer
-	if( ciri::failed(_spritesBuffer->set(_vertexArray, sizeof(SpriteVertex), _vertexArraySize, true)) ) {
+	if( _compact ) {
+		packCompact();
+		if( ciri::failed(_spritesBuffer->set(_compactArray.data(), sizeof(CompactSpriteVertex), _vertexArraySize, true)) ) {
+			return false;
+		}
+	} else if( ciri::failed(_spritesBuffer->set(_vertexArray, sizeof(SpriteVertex), _vertexArraySize, true)) ) {
 		return false;
 	}
 
@@ -327,8 +382,8 @@ std::shared_ptr<SpriteBatchItem> SpriteBatch::createBatchItem() {
 	return item;
 }
 
-void SpriteBatch::ensureArrayCapacity( int size ) {
-	const int requiredSize = size * 6;
+void SpriteBatch::ensureArrayCapacity( int vertexCount ) {
+	const int requiredSize = vertexCount;
 	if( _vertexArraySize < requiredSize ) {
 		SpriteVertex* newArray = new SpriteVertex[requiredSize];
 		memcpy(newArray, _vertexArray, sizeof(SpriteVertex) * _vertexArraySize);
@@ -338,6 +393,30 @@ void SpriteBatch::ensureArrayCapacity( int size ) {
 	}
 }
 
+void SpriteBatch::packCompact() {
+	const int count = _vertexArraySize;
+	if( static_cast<int>(_compactArray.size()) < count ) {
+		_compactArray.resize(count);
+		_texcoordScratch.resize(count * 2);
+		_halfScratch.resize(count * 2);
+	}
+
+	// texcoords are gathered so the half conversion runs four at a time
+	for( int i = 0; i < count; ++i ) {
+		_texcoordScratch[i*2+0] = _vertexArray[i].texcoord.x;
+		_texcoordScratch[i*2+1] = _vertexArray[i].texcoord.y;
+	}
+	ciri::VertexPacking::floatToHalf(_texcoordScratch.data(), _halfScratch.data(), count * 2);
+
+	for( int i = 0; i < count; ++i ) {
+		CompactSpriteVertex& cv = _compactArray[i];
+		cv.position = _vertexArray[i].position;
+		cv.texcoord[0] = _halfScratch[i*2+0];
+		cv.texcoord[1] = _halfScratch[i*2+1];
+		cv.color = ciri::VertexPacking::packUNorm8x4(_vertexArray[i].color);
+	}
+}
+
 void SpriteBatch::flush( int start, int end, const std::shared_ptr<ciri::ITexture2D>& texture ) {
 	if( start == end ) {
 		return;
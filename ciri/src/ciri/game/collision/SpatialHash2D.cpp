@@ -0,0 +1,263 @@
+#include <ciri/game/collision/SpatialHash2D.hpp>
+#include <cmath>
+#include <algorithm>
+
+using namespace ciri;
+
+// SpatialHashQuery
+
+SpatialHashQuery::SpatialHashQuery( const SpatialHash2D* hash, const cc::Vec2f& min, const cc::Vec2f& max, const cc::Vec2f& center, float radius, bool isCircle, unsigned int layerMask )
+	: _hash(hash), _min(min), _max(max), _center(center), _radius(radius), _isCircle(isCircle), _layerMask(layerMask), _current(-1) {
+	if( nullptr == _hash || _hash->_buckets.empty() || 0 == _hash->_count || 0 == _layerMask ) {
+		_hash = nullptr;
+		return;
+	}
+
+	// widen by the largest object radius since objects are bucketed by their center only
+	const float widen = _hash->_maxRadius;
+	_minCellX = _hash->cellCoord(_min.x - widen);
+	_minCellY = _hash->cellCoord(_min.y - widen);
+	_maxCellX = _hash->cellCoord(_max.x + widen);
+	_maxCellY = _hash->cellCoord(_max.y + widen);
+	_cellX = _minCellX;
+	_cellY = _minCellY;
+	_current = -2; // head of the first cell has not been visited yet
+}
+
+bool SpatialHashQuery::next() {
+	if( nullptr == _hash ) {
+		return false;
+	}
+
+	const std::vector<SpatialHash2D::Proxy>& proxies = _hash->_proxies;
+
+	int proxy = (-2 == _current) ? _hash->_buckets[_hash->bucketIndex(_cellX, _cellY)] : proxies[_current].next;
+	while( true ) {
+		while( proxy != -1 ) {
+			const SpatialHash2D::Proxy& p = proxies[proxy];
+			// buckets are shared by every cell hashing to them, so skip objects from other cells
+			if( p.cellX == _cellX && p.cellY == _cellY && (p.layerMask & _layerMask) && overlaps(proxy) ) {
+				_current = proxy;
+				return true;
+			}
+			proxy = p.next;
+		}
+
+		if( ++_cellX > _maxCellX ) {
+			_cellX = _minCellX;
+			if( ++_cellY > _maxCellY ) {
+				_hash = nullptr;
+				_current = -1;
+				return false;
+			}
+		}
+		proxy = _hash->_buckets[_hash->bucketIndex(_cellX, _cellY)];
+	}
+}
+
+int SpatialHashQuery::handle() const {
+	return _current;
+}
+
+int SpatialHashQuery::userData() const {
+	return _hash->_proxies[_current].userData;
+}
+
+bool SpatialHashQuery::overlaps( int proxy ) const {
+	const SpatialHash2D::Proxy& p = _hash->_proxies[proxy];
+	if( _isCircle ) {
+		const float dx = p.position.x - _center.x;
+		const float dy = p.position.y - _center.y;
+		const float r = p.radius + _radius;
+		return (dx*dx + dy*dy) <= (r*r);
+	}
+
+	// closest point on the box to the circle's center
+	const float cx = (p.position.x < _min.x) ? _min.x : ((p.position.x > _max.x) ? _max.x : p.position.x);
+	const float cy = (p.position.y < _min.y) ? _min.y : ((p.position.y > _max.y) ? _max.y : p.position.y);
+	const float dx = p.position.x - cx;
+	const float dy = p.position.y - cy;
+	return (dx*dx + dy*dy) <= (p.radius * p.radius);
+}
+
+// SpatialHash2D
+
+SpatialHash2D::SpatialHash2D()
+	: _cellSize(0.0f), _invCellSize(0.0f), _freeList(-1), _count(0), _maxRadius(0.0f) {
+}
+
+SpatialHash2D::~SpatialHash2D() {
+}
+
+bool SpatialHash2D::create( float cellSize, int bucketCount ) {
+	if( cellSize <= 0.0f || bucketCount <= 0 ) {
+		return false;
+	}
+
+	int size = 1;
+	while( size < bucketCount ) {
+		size <<= 1;
+	}
+
+	_cellSize = cellSize;
+	_invCellSize = 1.0f / cellSize;
+	_buckets.assign(size, -1);
+	_proxies.clear();
+	_freeList = -1;
+	_count = 0;
+	_maxRadius = 0.0f;
+	return true;
+}
+
+void SpatialHash2D::clear() {
+	std::fill(_buckets.begin(), _buckets.end(), -1);
+	_proxies.clear();
+	_freeList = -1;
+	_count = 0;
+	_maxRadius = 0.0f;
+}
+
+int SpatialHash2D::insert( const cc::Vec2f& position, float radius, int userData, unsigned int layerMask ) {
+	if( _buckets.empty() || 0 == layerMask ) {
+		return -1;
+	}
+
+	int handle;
+	if( _freeList != -1 ) {
+		handle = _freeList;
+		_freeList = _proxies[handle].next;
+	} else {
+		handle = static_cast<int>(_proxies.size());
+		_proxies.push_back(Proxy());
+	}
+
+	Proxy& p = _proxies[handle];
+	p.position = position;
+	p.radius = radius;
+	p.userData = userData;
+	p.layerMask = layerMask;
+	p.cellX = cellCoord(position.x);
+	p.cellY = cellCoord(position.y);
+	link(handle);
+
+	if( radius > _maxRadius ) {
+		_maxRadius = radius;
+	}
+	++_count;
+	return handle;
+}
+
+void SpatialHash2D::move( int handle, const cc::Vec2f& position ) {
+	if( handle < 0 || handle >= static_cast<int>(_proxies.size()) || 0 == _proxies[handle].layerMask ) {
+		return;
+	}
+
+	Proxy& p = _proxies[handle];
+	p.position = position;
+
+	const int cellX = cellCoord(position.x);
+	const int cellY = cellCoord(position.y);
+	if( cellX == p.cellX && cellY == p.cellY ) {
+		return;
+	}
+
+	unlink(handle);
+	p.cellX = cellX;
+	p.cellY = cellY;
+	link(handle);
+}
+
+void SpatialHash2D::remove( int handle ) {
+	if( handle < 0 || handle >= static_cast<int>(_proxies.size()) || 0 == _proxies[handle].layerMask ) {
+		return;
+	}
+
+	unlink(handle);
+	Proxy& p = _proxies[handle];
+	p.layerMask = 0;
+	p.next = _freeList;
+	_freeList = handle;
+	--_count;
+}
+
+SpatialHashQuery SpatialHash2D::queryRadius( const cc::Vec2f& center, float radius, unsigned int layerMask ) const {
+	const cc::Vec2f min(center.x - radius, center.y - radius);
+	const cc::Vec2f max(center.x + radius, center.y + radius);
+	return SpatialHashQuery(this, min, max, center, radius, true, layerMask);
+}
+
+SpatialHashQuery SpatialHash2D::queryAABB( const cc::Vec2f& min, const cc::Vec2f& max, unsigned int layerMask ) const {
+	return SpatialHashQuery(this, min, max, cc::Vec2f(0.0f, 0.0f), 0.0f, false, layerMask);
+}
+
+int SpatialHash2D::findPairs( unsigned int layerMaskA, unsigned int layerMaskB, std::vector<SpatialHashPair>& pairs ) const {
+	pairs.clear();
+
+	const int proxyCount = static_cast<int>(_proxies.size());
+	for( int i = 0; i < proxyCount; ++i ) {
+		const Proxy& a = _proxies[i];
+		if( 0 == (a.layerMask & layerMaskA) ) {
+			continue; // also skips free proxies
+		}
+		const bool aInB = (a.layerMask & layerMaskB) != 0;
+
+		for( SpatialHashQuery query = queryRadius(a.position, a.radius, layerMaskB); query.next(); ) {
+			const int j = query.handle();
+			if( j == i ) {
+				continue;
+			}
+			// when both objects are in both masks, the pair is visited from each side; keep one
+			if( aInB && (_proxies[j].layerMask & layerMaskA) && j < i ) {
+				continue;
+			}
+			SpatialHashPair pair;
+			pair.a = a.userData;
+			pair.b = _proxies[j].userData;
+			pairs.push_back(pair);
+		}
+	}
+
+	return static_cast<int>(pairs.size());
+}
+
+int SpatialHash2D::getCount() const {
+	return _count;
+}
+
+float SpatialHash2D::getCellSize() const {
+	return _cellSize;
+}
+
+int SpatialHash2D::cellCoord( float value ) const {
+	return static_cast<int>(std::floor(value * _invCellSize));
+}
+
+int SpatialHash2D::bucketIndex( int cellX, int cellY ) const {
+	const unsigned int h = (static_cast<unsigned int>(cellX) * 73856093u) ^ (static_cast<unsigned int>(cellY) * 19349663u);
+	return static_cast<int>(h & static_cast<unsigned int>(_buckets.size() - 1));
+}
+
+void SpatialHash2D::link( int proxy ) {
+	Proxy& p = _proxies[proxy];
+	p.bucket = bucketIndex(p.cellX, p.cellY);
+	p.prev = -1;
+	p.next = _buckets[p.bucket];
+	if( p.next != -1 ) {
+		_proxies[p.next].prev = proxy;
+	}
+	_buckets[p.bucket] = proxy;
+}
+
+void SpatialHash2D::unlink( int proxy ) {
+	Proxy& p = _proxies[proxy];
+	if( p.prev != -1 ) {
+		_proxies[p.prev].next = p.next;
+	} else {
+		_buckets[p.bucket] = p.next;
+	}
+	if( p.next != -1 ) {
+		_proxies[p.next].prev = p.prev;
+	}
+	p.prev = -1;
+	p.next = -1;
+}
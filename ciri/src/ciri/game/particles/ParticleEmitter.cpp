@@ -0,0 +1,127 @@
+#include <ciri/game/particles/ParticleEmitter.hpp>
+#include <algorithm>
+#include <cc/Common.hpp>
+
+using namespace ciri;
+
+ParticleColorCurve::ParticleColorCurve() {
+	bake();
+}
+
+void ParticleColorCurve::addKey( float time, const cc::Vec4f& color ) {
+	Key key;
+	key.time = cc::math::clamp(time, 0.0f, 1.0f);
+	key.color = color;
+	_keys.push_back(key);
+	std::stable_sort(_keys.begin(), _keys.end(), [](const Key& lhs, const Key& rhs){
+		return lhs.time < rhs.time;
+	});
+	bake();
+}
+
+void ParticleColorCurve::clearKeys() {
+	_keys.clear();
+	bake();
+}
+
+const cc::Vec4f& ParticleColorCurve::evaluate( float t ) const {
+	int idx = static_cast<int>(t * static_cast<float>(LUT_SIZE - 1) + 0.5f);
+	idx = (idx < 0) ? 0 : ((idx >= LUT_SIZE) ? LUT_SIZE - 1 : idx);
+	return _lut[idx];
+}
+
+void ParticleColorCurve::bake() {
+	if( _keys.empty() ) {
+		for( int i = 0; i < LUT_SIZE; ++i ) {
+			_lut[i] = cc::Vec4f(1.0f);
+		}
+		return;
+	}
+
+	unsigned int next = 0;
+	for( int i = 0; i < LUT_SIZE; ++i ) {
+		const float t = static_cast<float>(i) / static_cast<float>(LUT_SIZE - 1);
+		while( next < _keys.size() && _keys[next].time < t ) {
+			++next;
+		}
+
+		if( 0 == next ) {
+			_lut[i] = _keys.front().color;
+		} else if( next >= _keys.size() ) {
+			_lut[i] = _keys.back().color;
+		} else {
+			const Key& a = _keys[next-1];
+			const Key& b = _keys[next];
+			const float range = b.time - a.time;
+			const float s = (range > 0.0f) ? (t - a.time) / range : 1.0f;
+			_lut[i] = a.color + (b.color - a.color) * s;
+		}
+	}
+}
+
+ParticleEmitter::ParticleEmitter()
+	: position(0.0f, 0.0f) {
+}
+
+ParticleEmitter::~ParticleEmitter() {
+}
+
+int ParticleEmitter::emit( ParticlePool& pool, int count ) {
+	const float PI = static_cast<float>(cc::math::PI);
+
+	int emitted = 0;
+	for( ; emitted < count; ++emitted ) {
+		const int idx = pool.spawn();
+		if( -1 == idx ) {
+			break;
+		}
+
+		// spawn shape
+		cc::Vec2f pos = position;
+		switch( spawn.shape ) {
+			case ParticleSpawnShape::Circle: {
+				const float angle = _random.nextReal(-PI, PI);
+				const float radius = spawn.extents.x * sqrtf(_random.nextReal(0.0f, 1.0f));
+				pos.x += cosf(angle) * radius;
+				pos.y += sinf(angle) * radius;
+				break;
+			}
+
+			case ParticleSpawnShape::Rect: {
+				pos.x += _random.nextReal(-spawn.extents.x, spawn.extents.x);
+				pos.y += _random.nextReal(-spawn.extents.y, spawn.extents.y);
+				break;
+			}
+
+			default: {
+				break;
+			}
+		}
+		pool.posX[idx] = pos.x;
+		pool.posY[idx] = pos.y;
+
+		// lifetime
+		const float life = _random.nextReal(lifetime.minLifetime, lifetime.maxLifetime);
+		pool.age[idx] = 0.0f;
+		pool.invLifetime[idx] = (life > 0.0f) ? (1.0f / life) : 1.0e30f;
+
+		// velocity (http://www.playchilla.com/random-direction-in-2d)
+		float angle = (velocity.direction.sqrMagnitude() > 0.0f) ? atan2f(velocity.direction.y, velocity.direction.x) : _random.nextReal(-PI, PI);
+		if( velocity.spread > 0.0f ) {
+			angle += _random.nextReal(-velocity.spread, velocity.spread);
+		}
+		const float speed = _random.nextReal(velocity.minSpeed, velocity.maxSpeed);
+		const float dirX = cosf(angle);
+		const float dirY = sinf(angle);
+		pool.velX[idx] = dirX * speed;
+		pool.velY[idx] = dirY * speed;
+
+		// orientation
+		pool.rotSin[idx] = velocity.alignToVelocity ? dirY : 0.0f;
+		pool.rotCos[idx] = velocity.alignToVelocity ? dirX : 1.0f;
+
+		// size
+		pool.size[idx] = _random.nextReal(size.minSize, size.maxSize);
+	}
+	return emitted;
+}
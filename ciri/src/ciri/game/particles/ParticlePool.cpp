@@ -0,0 +1,101 @@
+#include <ciri/game/particles/ParticlePool.hpp>
+#include <xmmintrin.h>
+
+using namespace ciri;
+
+static const int NUM_STREAMS = 9;
+
+ParticlePool::ParticlePool()
+	: posX(nullptr), posY(nullptr), velX(nullptr), velY(nullptr), age(nullptr), invLifetime(nullptr), rotSin(nullptr), rotCos(nullptr), size(nullptr),
+		_block(nullptr), _count(0), _capacity(0) {
+}
+
+ParticlePool::~ParticlePool() {
+	destroy();
+}
+
+bool ParticlePool::create( int capacity ) {
+	destroy();
+
+	if( capacity <= 0 ) {
+		return false;
+	}
+
+	// round up to a multiple of 4 so that every stream can be processed 4 at a time
+	const int padded = (capacity + 3) & ~3;
+
+	// one allocation shared by all streams
+	_block = static_cast<float*>(_mm_malloc(sizeof(float) * padded * NUM_STREAMS, 16));
+	if( nullptr == _block ) {
+		return false;
+	}
+
+	float* stream = _block;
+	posX = stream;        stream += padded;
+	posY = stream;        stream += padded;
+	velX = stream;        stream += padded;
+	velY = stream;        stream += padded;
+	age = stream;         stream += padded;
+	invLifetime = stream; stream += padded;
+	rotSin = stream;      stream += padded;
+	rotCos = stream;      stream += padded;
+	size = stream;
+
+	_capacity = capacity;
+	_count = 0;
+	return true;
+}
+
+void ParticlePool::destroy() {
+	if( _block != nullptr ) {
+		_mm_free(_block);
+		_block = nullptr;
+	}
+	posX = posY = velX = velY = age = invLifetime = rotSin = rotCos = size = nullptr;
+	_count = 0;
+	_capacity = 0;
+}
+
+int ParticlePool::spawn() {
+	if( _count >= _capacity ) {
+		return -1;
+	}
+	return _count++;
+}
+
+void ParticlePool::kill( int index ) {
+	if( index < 0 || index >= _count ) {
+		return;
+	}
+
+	const int last = --_count;
+	if( index == last ) {
+		return;
+	}
+
+	posX[index] = posX[last];
+	posY[index] = posY[last];
+	velX[index] = velX[last];
+	velY[index] = velY[last];
+	age[index] = age[last];
+	invLifetime[index] = invLifetime[last];
+	rotSin[index] = rotSin[last];
+	rotCos[index] = rotCos[last];
+	size[index] = size[last];
+}
+
+void ParticlePool::clear() {
+	_count = 0;
+}
+
+int ParticlePool::getCount() const {
+	return _count;
+}
+
+int ParticlePool::getCapacity() const {
+	return _capacity;
+}
+
+bool ParticlePool::isFull() const {
+	return _count >= _capacity;
+}
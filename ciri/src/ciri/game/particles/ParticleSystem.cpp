@@ -0,0 +1,237 @@
+#include <ciri/game/particles/ParticleSystem.hpp>
+#include <ciri/game/SpriteBatch.hpp>
+#include <ciri/core/JobSystem.hpp>
+#include <xmmintrin.h>
+
+using namespace ciri;
+
+static const int MIN_GRAIN_SIZE = 64;
+
+ParticleSystem::ParticleSystem()
+	: _texture(nullptr), _grainSize(16384), _jobs(nullptr), _deadIndices(nullptr) {
+}
+
+ParticleSystem::~ParticleSystem() {
+	clean();
+}
+
+bool ParticleSystem::create( int capacity ) {
+	clean();
+
+	if( !_pool.create(capacity) ) {
+		return false;
+	}
+
+	_deadIndices = new int[capacity];
+	return true;
+}
+
+void ParticleSystem::clean() {
+	_pool.destroy();
+	if( _deadIndices != nullptr ) {
+		delete[] _deadIndices;
+		_deadIndices = nullptr;
+	}
+	_texture = nullptr;
+}
+
+int ParticleSystem::emitParticles( int count ) {
+	if( count <= 0 ) {
+		return 0;
+	}
+	return _emitter.emit(_pool, count);
+}
+
+void ParticleSystem::update( float deltaTime ) {
+	const int count = _pool.getCount();
+	if( 0 == count ) {
+		return;
+	}
+
+	// chunk starts are kept on 4-element boundaries so each chunk's SIMD loads stay aligned
+	const int chunkCount = computeChunkCount(count);
+	const int chunkSize = (((count + chunkCount - 1) / chunkCount) + 3) & ~3;
+	_deadCounts.assign(chunkCount, 0);
+
+	forEachChunk(chunkCount, [this, chunkSize, count, deltaTime]( int c ) {
+		const int start = c * chunkSize;
+		const int end = (start + chunkSize < count) ? start + chunkSize : count;
+		if( start < end ) {
+			updateRange(start, end, deltaTime, &_deadIndices[start], _deadCounts[c]);
+		}
+	});
+
+	// swap-remove dead particles from highest to lowest index so that the particle moved into each
+	// freed slot is always one that has already been confirmed alive
+	for( int c = chunkCount - 1; c >= 0; --c ) {
+		const int* dead = &_deadIndices[c * chunkSize];
+		for( int i = _deadCounts[c] - 1; i >= 0; --i ) {
+			_pool.kill(dead[i]);
+		}
+	}
+}
+
+void ParticleSystem::draw( SpriteBatch& spritebatch, float depth ) {
+	const int count = _pool.getCount();
+	if( nullptr == _texture || 0 == count ) {
+		return;
+	}
+
+	SpriteVertex* vertices = spritebatch.reserveQuads(_texture, count, depth);
+	if( nullptr == vertices ) {
+		return;
+	}
+
+	const int chunkCount = computeChunkCount(count);
+	const int chunkSize = (count + chunkCount - 1) / chunkCount;
+	forEachChunk(chunkCount, [this, chunkSize, count, vertices, depth]( int c ) {
+		const int start = c * chunkSize;
+		const int end = (start + chunkSize < count) ? start + chunkSize : count;
+		if( start < end ) {
+			writeRange(start, end, vertices, depth);
+		}
+	});
+}
+
+void ParticleSystem::clear() {
+	_pool.clear();
+}
+
+void ParticleSystem::setTexture( const std::shared_ptr<ITexture2D>& texture ) {
+	_texture = texture;
+}
+
+const std::shared_ptr<ITexture2D>& ParticleSystem::getTexture() const {
+	return _texture;
+}
+
+void ParticleSystem::setGrainSize( int grainSize ) {
+	_grainSize = (grainSize < MIN_GRAIN_SIZE) ? MIN_GRAIN_SIZE : grainSize;
+}
+
+void ParticleSystem::setJobSystem( const std::shared_ptr<JobSystem>& jobs ) {
+	_jobs = jobs;
+}
+
+int ParticleSystem::getCount() const {
+	return _pool.getCount();
+}
+
+int ParticleSystem::getCapacity() const {
+	return _pool.getCapacity();
+}
+
+ParticleEmitter& ParticleSystem::getEmitter() {
+	return _emitter;
+}
+
+const ParticlePool& ParticleSystem::getPool() const {
+	return _pool;
+}
+
+int ParticleSystem::computeChunkCount( int count ) const {
+	const int threads = (_jobs != nullptr) ? _jobs->getThreadCount() : 1;
+	const int byGrain = count / _grainSize;
+	if( byGrain <= 1 ) {
+		return 1;
+	}
+	return (byGrain < threads) ? byGrain : threads;
+}
+
+void ParticleSystem::forEachChunk( int chunkCount, const std::function<void( int chunk )>& chunkFunction ) {
+	if( nullptr == _jobs || 1 == chunkCount ) {
+		for( int c = 0; c < chunkCount; ++c ) {
+			chunkFunction(c);
+		}
+		return;
+	}
+	// a chunk per range, so that each thread takes whole chunks and the calling thread works through its share rather than idling
+	_jobs->parallelFor(0, chunkCount, 1, [&chunkFunction]( int begin, int end ) {
+		for( int c = begin; c < end; ++c ) {
+			chunkFunction(c);
+		}
+	});
+}
+
+void ParticleSystem::updateRange( int start, int end, float deltaTime, int* deadOut, int& deadCount ) {
+	float* posX = _pool.posX;
+	float* posY = _pool.posY;
+	const float* velX = _pool.velX;
+	const float* velY = _pool.velY;
+	float* age = _pool.age;
+	const float* invLifetime = _pool.invLifetime;
+
+	int found = 0;
+	int i = start;
+
+	// four particles at a time; start is always a multiple of 4
+	const __m128 dt = _mm_set1_ps(deltaTime);
+	const __m128 one = _mm_set1_ps(1.0f);
+	for( ; i + 4 <= end; i += 4 ) {
+		_mm_store_ps(&posX[i], _mm_add_ps(_mm_load_ps(&posX[i]), _mm_mul_ps(_mm_load_ps(&velX[i]), dt)));
+		_mm_store_ps(&posY[i], _mm_add_ps(_mm_load_ps(&posY[i]), _mm_mul_ps(_mm_load_ps(&velY[i]), dt)));
+		const __m128 newAge = _mm_add_ps(_mm_load_ps(&age[i]), dt);
+		_mm_store_ps(&age[i], newAge);
+
+		const int deadMask = _mm_movemask_ps(_mm_cmpge_ps(_mm_mul_ps(newAge, _mm_load_ps(&invLifetime[i])), one));
+		if( deadMask != 0 ) {
+			for( int b = 0; b < 4; ++b ) {
+				if( deadMask & (1 << b) ) {
+					deadOut[found++] = i + b;
+				}
+			}
+		}
+	}
+
+	// remainder
+	for( ; i < end; ++i ) {
+		posX[i] += velX[i] * deltaTime;
+		posY[i] += velY[i] * deltaTime;
+		age[i] += deltaTime;
+		if( age[i] * invLifetime[i] >= 1.0f ) {
+			deadOut[found++] = i;
+		}
+	}
+
+	deadCount = found;
+}
+
+void ParticleSystem::writeRange( int start, int end, SpriteVertex* vertices, float depth ) const {
+	const float halfWidth = static_cast<float>(_texture->getWidth()) * 0.5f;
+	const float halfHeight = static_cast<float>(_texture->getHeight()) * 0.5f;
+	const ParticleColorCurve& curve = _emitter.colorOverLife;
+
+	const cc::Vec2f TEX_TL(0.0f, 1.0f);
+	const cc::Vec2f TEX_TR(1.0f, 1.0f);
+	const cc::Vec2f TEX_BL(0.0f, 0.0f);
+	const cc::Vec2f TEX_BR(1.0f, 0.0f);
+
+	SpriteVertex* v = &vertices[start * 6];
+	for( int i = start; i < end; ++i, v += 6 ) {
+		const float x = _pool.posX[i];
+		const float y = _pool.posY[i];
+		const float s = _pool.rotSin[i];
+		const float c = _pool.rotCos[i];
+		const float hw = halfWidth * _pool.size[i];
+		const float hh = halfHeight * _pool.size[i];
+
+		// corners relative to the center, rotated (matches SpriteBatchItem::set with a centered origin)
+		const float wc = hw * c;
+		const float ws = hw * s;
+		const float hc = hh * c;
+		const float hs = hh * s;
+		const cc::Vec3f topLeft(x - wc - hs, y - ws + hc, depth);
+		const cc::Vec3f topRight(x + wc - hs, y + ws + hc, depth);
+		const cc::Vec3f bottomLeft(x - wc + hs, y - ws - hc, depth);
+		const cc::Vec3f bottomRight(x + wc + hs, y + ws - hc, depth);
+
+		const cc::Vec4f& color = curve.evaluate(_pool.age[i] * _pool.invLifetime[i]);
+
+		v[0] = SpriteVertex(topLeft, TEX_TL, color);     // t0
+		v[1] = SpriteVertex(bottomRight, TEX_BR, color); // t0
+		v[2] = SpriteVertex(bottomLeft, TEX_BL, color);  // t0
+		v[3] = SpriteVertex(topLeft, TEX_TL, color);     // t1
+		v[4] = SpriteVertex(topRight, TEX_TR, color);    // t1
+		v[5] = SpriteVertex(bottomRight, TEX_BR, color); // t1
+	}
+}
@@ -0,0 +1,55 @@
+#include <ciri/graphics/BoundingBox.hpp>
+#include <cc/Vec4.hpp>
+#include <limits>
+
+using namespace ciri;
+
+BoundingBox::BoundingBox()
+	: Min(0.0f, 0.0f, 0.0f), Max(0.0f, 0.0f, 0.0f) {
+}
+
+BoundingBox::BoundingBox( const cc::Vec3f& min, const cc::Vec3f& max )
+	: Min(min), Max(max) {
+}
+
+BoundingBox BoundingBox::createFromPoints( const std::vector<cc::Vec3f>& points ) {
+	if( points.empty() ) {
+		return BoundingBox();
+	}
+
+	cc::Vec3f min(std::numeric_limits<float>::max());
+	cc::Vec3f max(-std::numeric_limits<float>::max());
+	for( const auto& p : points ) {
+		min.x = (min.x < p.x) ? min.x : p.x;
+		min.y = (min.y < p.y) ? min.y : p.y;
+		min.z = (min.z < p.z) ? min.z : p.z;
+		max.x = (max.x > p.x) ? max.x : p.x;
+		max.y = (max.y > p.y) ? max.y : p.y;
+		max.z = (max.z > p.z) ? max.z : p.z;
+	}
+	return BoundingBox(min, max);
+}
+
+cc::Vec3f BoundingBox::center() const {
+	return (Min + Max) * 0.5f;
+}
+
+cc::Vec3f BoundingBox::extents() const {
+	return (Max - Min) * 0.5f;
+}
+
+BoundingBox BoundingBox::transformed( const cc::Mat4f& matrix ) const {
+	cc::Vec3f min(std::numeric_limits<float>::max());
+	cc::Vec3f max(-std::numeric_limits<float>::max());
+	for( int i = 0; i < 8; ++i ) {
+		const cc::Vec4f corner((i & 1) ? Max.x : Min.x, (i & 2) ? Max.y : Min.y, (i & 4) ? Max.z : Min.z, 1.0f);
+		const cc::Vec3f p = (matrix * corner).truncated();
+		min.x = (min.x < p.x) ? min.x : p.x;
+		min.y = (min.y < p.y) ? min.y : p.y;
+		min.z = (min.z < p.z) ? min.z : p.z;
+		max.x = (max.x > p.x) ? max.x : p.x;
+		max.y = (max.y > p.y) ? max.y : p.y;
+		max.z = (max.z > p.z) ? max.z : p.z;
+	}
+	return BoundingBox(min, max);
+}
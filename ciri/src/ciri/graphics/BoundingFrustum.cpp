@@ -0,0 +1,111 @@
+#include <ciri/graphics/BoundingFrustum.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Common.hpp>
+#include <cmath>
+
+using namespace ciri;
+
+namespace {
+	Plane normalizedPlane( const cc::Vec4f& vec ) {
+		const float len = sqrtf(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z);
+		const float factor = (len > 0.0f) ? (1.0f / len) : 0.0f;
+		return Plane(vec.x * factor, vec.y * factor, vec.z * factor, vec.w * factor);
+	}
+}
+
+BoundingFrustum::BoundingFrustum() {
+}
+
+BoundingFrustum::BoundingFrustum( const cc::Mat4f& viewProj ) {
+	// columns via basis vectors so that no assumption about the element accessor's order is made
+	const cc::Vec4f c0 = viewProj * cc::Vec4f(1.0f, 0.0f, 0.0f, 0.0f);
+	const cc::Vec4f c1 = viewProj * cc::Vec4f(0.0f, 1.0f, 0.0f, 0.0f);
+	const cc::Vec4f c2 = viewProj * cc::Vec4f(0.0f, 0.0f, 1.0f, 0.0f);
+	const cc::Vec4f c3 = viewProj * cc::Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+	const cc::Vec4f row0(c0.x, c1.x, c2.x, c3.x);
+	const cc::Vec4f row1(c0.y, c1.y, c2.y, c3.y);
+	const cc::Vec4f row2(c0.z, c1.z, c2.z, c3.z);
+	const cc::Vec4f row3(c0.w, c1.w, c2.w, c3.w);
+
+	// gribb & hartmann; near uses the -w<=z convention, which is conservative for 0<=z projections
+	_planes[Left]   = normalizedPlane(row3 + row0);
+	_planes[Right]  = normalizedPlane(row3 - row0);
+	_planes[Bottom] = normalizedPlane(row3 + row1);
+	_planes[Top]    = normalizedPlane(row3 - row1);
+	_planes[Near]   = normalizedPlane(row3 + row2);
+	_planes[Far]    = normalizedPlane(row3 - row2);
+
+	createCorners();
+}
+
+BoundingFrustum::BoundingFrustum( float angle, float ratio, float nearD, float farD, const cc::Vec3f& p, const cc::Vec3f& l, const cc::Vec3f& u ) {
+	const float tang = tanf(cc::math::DEG_TO_RAD * angle * 0.5f);
+	const float nh = nearD * tang;
+	const float nw = nh * ratio;
+	const float fh = farD * tang;
+	const float fw = fh * ratio;
+
+	const cc::Vec3f Z = (p - l).normalized();
+	const cc::Vec3f X = u.cross(Z).normalized();
+	const cc::Vec3f Y = Z.cross(X);
+	const cc::Vec3f nc = p - Z * nearD;
+	const cc::Vec3f fc = p - Z * farD;
+	const cc::Vec3f ntl = nc + Y * nh - X * nw;
+	const cc::Vec3f ntr = nc + Y * nh + X * nw;
+	const cc::Vec3f nbl = nc - Y * nh - X * nw;
+	const cc::Vec3f nbr = nc - Y * nh + X * nw;
+	const cc::Vec3f ftl = fc + Y * fh - X * fw;
+	const cc::Vec3f ftr = fc + Y * fh + X * fw;
+	const cc::Vec3f fbl = fc - Y * fh - X * fw;
+	const cc::Vec3f fbr = fc - Y * fh + X * fw;
+
+	// Plane(a, b, c) winds as (b-a)x(c-a); these orders give inward normals
+	_planes[Left]   = Plane(nbl, fbl, ntl);
+	_planes[Right]  = Plane(ntr, fbr, nbr);
+	_planes[Bottom] = Plane(nbr, fbr, nbl);
+	_planes[Top]    = Plane(ntl, ftl, ntr);
+	_planes[Near]   = Plane(ntr, nbr, ntl);
+	_planes[Far]    = Plane(ftl, fbl, ftr);
+
+	_corners[0] = ntl;
+	_corners[1] = ntr;
+	_corners[2] = nbl;
+	_corners[3] = nbr;
+	_corners[4] = ftl;
+	_corners[5] = ftr;
+	_corners[6] = fbl;
+	_corners[7] = fbr;
+}
+
+const std::array<cc::Vec3f, 8>& BoundingFrustum::corners() const {
+	return _corners;
+}
+
+const std::array<Plane, 6>& BoundingFrustum::planes() const {
+	return _planes;
+}
+
+void BoundingFrustum::createCorners() {
+	// same order as the perspective constructor: near tl, tr, bl, br then far
+	_corners[0] = intersectionPoint(_planes[Near], _planes[Top], _planes[Left]);
+	_corners[1] = intersectionPoint(_planes[Near], _planes[Top], _planes[Right]);
+	_corners[2] = intersectionPoint(_planes[Near], _planes[Bottom], _planes[Left]);
+	_corners[3] = intersectionPoint(_planes[Near], _planes[Bottom], _planes[Right]);
+	_corners[4] = intersectionPoint(_planes[Far], _planes[Top], _planes[Left]);
+	_corners[5] = intersectionPoint(_planes[Far], _planes[Top], _planes[Right]);
+	_corners[6] = intersectionPoint(_planes[Far], _planes[Bottom], _planes[Left]);
+	_corners[7] = intersectionPoint(_planes[Far], _planes[Bottom], _planes[Right]);
+}
+
+cc::Vec3f BoundingFrustum::intersectionPoint( const Plane& p1, const Plane& p2, const Plane& p3 ) {
+	// real-time collision detection pp. 213, with planes stored as n.x + d = 0
+	const cc::Vec3f& n1 = p1.getNormal();
+	const cc::Vec3f& n2 = p2.getNormal();
+	const cc::Vec3f& n3 = p3.getNormal();
+	const cc::Vec3f u = n2.cross(n3);
+	const float denom = n1.dot(u);
+	if( fabsf(denom) < 0.0001f ) {
+		return cc::Vec3f(0.0f, 0.0f, 0.0f); // planes don't meet in a single point
+	}
+	return (u * -p1.getD() + n1.cross(n3 * p2.getD() - n2 * p3.getD())) / denom;
+}
@@ -0,0 +1,299 @@
+#include <ciri/graphics/CommandList.hpp>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/graphics/VertexDeclaration.hpp>
+#include <cstring>
+
+using namespace ciri;
+
+// payloads are copied straight into api calls, so keep them aligned for any vector type
+static const int ARENA_ALIGNMENT = 16;
+
+struct ViewportData {
+	int x, y, width, height;
+	float minDepth, maxDepth;
+};
+
+static int floatBits( float value ) {
+	int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float bitsFloat( int bits ) {
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+CommandList::CommandList()
+	: ICommandList(), _arenaUsed(0) {
+}
+
+CommandList::~CommandList() {
+}
+
+void CommandList::reset() {
+	_commands.clear();
+	_objects.clear();
+	_arenaUsed = 0;
+}
+
+int CommandList::getCommandCount() const {
+	return static_cast<int>(_commands.size());
+}
+
+void CommandList::applyPipelineState( const std::shared_ptr<IPipelineState>& state ) {
+	record(Type::ApplyPipelineState, addObject(state));
+}
+
+void CommandList::applyShader( const std::shared_ptr<IShader>& shader ) {
+	record(Type::ApplyShader, addObject(shader));
+}
+
+void CommandList::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) {
+	record(Type::SetVertexBuffer, addObject(buffer));
+}
+
+void CommandList::setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) {
+	// one object index per slot fits exactly in the args; slots past numBuffers are unbound by the device either way
+	static_assert(VertexDeclaration::MAX_STREAMS <= 4, "vertex streams must fit in a command's args");
+	int objects[4] = {-1, -1, -1, -1};
+	for( int i = 0; i < numBuffers && i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		objects[i] = addObject(buffers[i]);
+	}
+	record(Type::SetVertexBuffers, -1, objects[0], objects[1], objects[2], objects[3]);
+}
+
+void CommandList::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) {
+	record(Type::SetIndexBuffer, addObject(buffer));
+}
+
+void CommandList::setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) {
+	record(Type::SetTexture2D, addObject(texture), index, static_cast<int>(shaderStage));
+}
+
+void CommandList::setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) {
+	record(Type::SetTexture3D, addObject(texture), index, static_cast<int>(shaderStage));
+}
+
+void CommandList::setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) {
+	record(Type::SetTextureCube, addObject(texture), index, static_cast<int>(shaderStage));
+}
+
+void CommandList::setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) {
+	record(Type::SetSamplerState, addObject(state), index, static_cast<int>(shaderStage));
+}
+
+void CommandList::setBlendState( const std::shared_ptr<IBlendState>& state ) {
+	record(Type::SetBlendState, addObject(state));
+}
+
+void CommandList::setRasterizerState( const std::shared_ptr<IRasterizerState>& state ) {
+	record(Type::SetRasterizerState, addObject(state));
+}
+
+void CommandList::setDepthStencilState( const std::shared_ptr<IDepthStencilState>& state ) {
+	record(Type::SetDepthStencilState, addObject(state));
+}
+
+void CommandList::setConstants( const std::shared_ptr<IConstantBuffer>& buffer, int dataSize, const void* data ) {
+	if( nullptr == buffer || nullptr == data || dataSize <= 0 ) {
+		return;
+	}
+	const int offset = allocate(dataSize);
+	memcpy(&_arena[offset], data, dataSize);
+	record(Type::SetConstants, addObject(buffer), offset, dataSize);
+}
+
+void CommandList::drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) {
+	record(Type::DrawArrays, -1, static_cast<int>(topology), vertexCount, startIndex);
+}
+
+void CommandList::drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) {
+	record(Type::DrawIndexed, -1, static_cast<int>(topology), indexCount, startIndex, baseVertex);
+}
+
+void CommandList::drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) {
+	record(Type::DrawInstanced, -1, static_cast<int>(topology), vertexCount, instanceCount, startIndex);
+}
+
+void CommandList::drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) {
+	record(Type::DrawIndexedInstanced, -1, static_cast<int>(topology), indexCount, instanceCount);
+}
+
+void CommandList::setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) {
+	if( nullptr == renderTargets || numRenderTargets <= 0 ) {
+		return;
+	}
+	const int bytes = static_cast<int>(sizeof(IRenderTarget2D*)) * numRenderTargets;
+	const int offset = allocate(bytes);
+	memcpy(&_arena[offset], renderTargets, bytes);
+	record(Type::SetRenderTargets, -1, offset, numRenderTargets);
+}
+
+void CommandList::restoreDefaultRenderTargets() {
+	record(Type::RestoreRenderTargets, -1);
+}
+
+void CommandList::setViewport( const Viewport& vp ) {
+	const ViewportData data = { vp.x(), vp.y(), vp.width(), vp.height(), vp.minDepth(), vp.maxDepth() };
+	const int offset = allocate(sizeof(data));
+	memcpy(&_arena[offset], &data, sizeof(data));
+	record(Type::SetViewport, -1, offset);
+}
+
+void CommandList::setClearColor( float r, float g, float b, float a ) {
+	record(Type::SetClearColor, -1, floatBits(r), floatBits(g), floatBits(b), floatBits(a));
+}
+
+void CommandList::clear( int flags ) {
+	record(Type::Clear, -1, flags);
+}
+
+void CommandList::execute( IGraphicsDevice* device ) const {
+	if( nullptr == device ) {
+		return;
+	}
+
+	for( const Command& cmd : _commands ) {
+		const std::shared_ptr<void> object = (cmd.object >= 0) ? _objects[cmd.object] : nullptr;
+		const ShaderStage::Stage stage = static_cast<ShaderStage::Stage>(cmd.args[1]);
+
+		switch( cmd.type ) {
+			case Type::ApplyPipelineState: {
+				device->applyPipelineState(std::static_pointer_cast<IPipelineState>(object));
+				break;
+			}
+			case Type::ApplyShader: {
+				device->applyShader(std::static_pointer_cast<IShader>(object));
+				break;
+			}
+			case Type::SetVertexBuffer: {
+				device->setVertexBuffer(std::static_pointer_cast<IVertexBuffer>(object));
+				break;
+			}
+			case Type::SetIndexBuffer: {
+				device->setIndexBuffer(std::static_pointer_cast<IIndexBuffer>(object));
+				break;
+			}
+			case Type::SetTexture2D: {
+				device->setTexture2D(cmd.args[0], std::static_pointer_cast<ITexture2D>(object), stage);
+				break;
+			}
+			case Type::SetTexture3D: {
+				device->setTexture3D(cmd.args[0], std::static_pointer_cast<ITexture3D>(object), stage);
+				break;
+			}
+			case Type::SetTextureCube: {
+				device->setTextureCube(cmd.args[0], std::static_pointer_cast<ITextureCube>(object), stage);
+				break;
+			}
+			case Type::SetSamplerState: {
+				device->setSamplerState(cmd.args[0], std::static_pointer_cast<ISamplerState>(object), stage);
+				break;
+			}
+			case Type::SetBlendState: {
+				device->setBlendState(std::static_pointer_cast<IBlendState>(object));
+				break;
+			}
+			case Type::SetRasterizerState: {
+				device->setRasterizerState(std::static_pointer_cast<IRasterizerState>(object));
+				break;
+			}
+			case Type::SetDepthStencilState: {
+				device->setDepthStencilState(std::static_pointer_cast<IDepthStencilState>(object));
+				break;
+			}
+			case Type::SetConstants: {
+				// setData does not modify the source, it just isn't declared const
+				std::static_pointer_cast<IConstantBuffer>(object)->setData(cmd.args[1], const_cast<unsigned char*>(&_arena[cmd.args[0]]));
+				break;
+			}
+			case Type::DrawArrays: {
+				device->drawArrays(static_cast<PrimitiveTopology>(cmd.args[0]), cmd.args[1], cmd.args[2]);
+				break;
+			}
+			case Type::DrawIndexed: {
+				device->drawIndexed(static_cast<PrimitiveTopology>(cmd.args[0]), cmd.args[1], cmd.args[2], cmd.args[3]);
+				break;
+			}
+			case Type::SetVertexBuffers: {
+				std::shared_ptr<IVertexBuffer> buffers[VertexDeclaration::MAX_STREAMS];
+				for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+					if( cmd.args[i] >= 0 ) {
+						buffers[i] = std::static_pointer_cast<IVertexBuffer>(_objects[cmd.args[i]]);
+					}
+				}
+				device->setVertexBuffers(buffers, VertexDeclaration::MAX_STREAMS);
+				break;
+			}
+			case Type::DrawInstanced: {
+				device->drawInstanced(static_cast<PrimitiveTopology>(cmd.args[0]), cmd.args[1], cmd.args[2], cmd.args[3]);
+				break;
+			}
+			case Type::DrawIndexedInstanced: {
+				device->drawIndexedInstanced(static_cast<PrimitiveTopology>(cmd.args[0]), cmd.args[1], cmd.args[2]);
+				break;
+			}
+			case Type::SetRenderTargets: {
+				IRenderTarget2D* targets[8];
+				const int count = (cmd.args[1] < 8) ? cmd.args[1] : 8;
+				memcpy(targets, &_arena[cmd.args[0]], sizeof(IRenderTarget2D*) * count);
+				device->setRenderTargets(targets, count);
+				break;
+			}
+			case Type::RestoreRenderTargets: {
+				device->restoreDefaultRenderTargets();
+				break;
+			}
+			case Type::SetViewport: {
+				ViewportData data;
+				memcpy(&data, &_arena[cmd.args[0]], sizeof(data));
+				device->setViewport(Viewport(data.x, data.y, data.width, data.height, data.minDepth, data.maxDepth));
+				break;
+			}
+			case Type::SetClearColor: {
+				device->setClearColor(bitsFloat(cmd.args[0]), bitsFloat(cmd.args[1]), bitsFloat(cmd.args[2]), bitsFloat(cmd.args[3]));
+				break;
+			}
+			case Type::Clear: {
+				device->clear(cmd.args[0]);
+				break;
+			}
+		}
+	}
+}
+
+void CommandList::record( Type type, int object, int a0, int a1, int a2, int a3 ) {
+	Command cmd;
+	cmd.type = type;
+	cmd.object = object;
+	cmd.args[0] = a0;
+	cmd.args[1] = a1;
+	cmd.args[2] = a2;
+	cmd.args[3] = a3;
+	_commands.push_back(cmd);
+}
+
+int CommandList::addObject( const std::shared_ptr<void>& object ) {
+	// null binds are meaningful (they unbind), so they are recorded without an object
+	if( nullptr == object ) {
+		return -1;
+	}
+	_objects.push_back(object);
+	return static_cast<int>(_objects.size()) - 1;
+}
+
+int CommandList::allocate( int bytes ) {
+	const int offset = (_arenaUsed + (ARENA_ALIGNMENT - 1)) & ~(ARENA_ALIGNMENT - 1);
+	_arenaUsed = offset + bytes;
+	if( _arenaUsed > static_cast<int>(_arena.size()) ) {
+		// grow geometrically so steady-state recording never reallocates
+		size_t newSize = _arena.empty() ? 4096 : _arena.size();
+		while( newSize < static_cast<size_t>(_arenaUsed) ) {
+			newSize *= 2;
+		}
+		_arena.resize(newSize);
+	}
+	return offset;
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include <ciri/graphics/FrustumCuller.hpp>
+#include <xmmintrin.h>
+
+using namespace ciri;
+
+namespace {
+	// plane test order for each hint; the hinted plane goes first, the rest keep their order
+	const unsigned char PLANE_ORDER[BoundingFrustum::PlaneCount][BoundingFrustum::PlaneCount] = {
+		{0, 1, 2, 3, 4, 5},
+		{1, 0, 2, 3, 4, 5},
+		{2, 0, 1, 3, 4, 5},
+		{3, 0, 1, 2, 4, 5},
+		{4, 0, 1, 2, 3, 5},
+		{5, 0, 1, 2, 3, 4}
+	};
+
+	int paddedCount( int count ) {
+		return (count + 3) & ~3;
+	}
+
+	int laneMask( int remaining ) {
+		return (remaining >= 4) ? 0xF : ((1 << remaining) - 1);
+	}
+
+	// writes the indices of set lanes without branching; out must have room for four entries past count
+	int appendLanes( int* out, int count, int base, int mask ) {
+		out[count] = base + 0; count += (mask >> 0) & 1;
+		out[count] = base + 1; count += (mask >> 1) & 1;
+		out[count] = base + 2; count += (mask >> 2) & 1;
+		out[count] = base + 3; count += (mask >> 3) & 1;
+		return count;
+	}
+
+	__m128 abs4( const __m128& x ) {
+		return _mm_max_ps(x, _mm_sub_ps(_mm_setzero_ps(), x));
+	}
+}
+
+BoundingBoxArray::BoundingBoxArray()
+	: _count(0) {
+}
+
+void BoundingBoxArray::reserve( int count ) {
+	const size_t padded = static_cast<size_t>(paddedCount(count));
+	_centerX.reserve(padded);
+	_centerY.reserve(padded);
+	_centerZ.reserve(padded);
+	_extentX.reserve(padded);
+	_extentY.reserve(padded);
+	_extentZ.reserve(padded);
+}
+
+void BoundingBoxArray::clear() {
+	_count = 0;
+	resizeStreams(0);
+}
+
+int BoundingBoxArray::add( const BoundingBox& box ) {
+	const int index = _count;
+	resizeStreams(_count + 1);
+	_count += 1;
+	set(index, box);
+	return index;
+}
+
+void BoundingBoxArray::set( int index, const BoundingBox& box ) {
+	if( index < 0 || index >= _count ) {
+		return;
+	}
+	const cc::Vec3f center = box.center();
+	const cc::Vec3f extents = box.extents();
+	_centerX[index] = center.x;
+	_centerY[index] = center.y;
+	_centerZ[index] = center.z;
+	_extentX[index] = extents.x;
+	_extentY[index] = extents.y;
+	_extentZ[index] = extents.z;
+}
+
+int BoundingBoxArray::size() const {
+	return _count;
+}
+
+void BoundingBoxArray::resizeStreams( int count ) {
+	const size_t padded = static_cast<size_t>(paddedCount(count));
+	_centerX.resize(padded, 0.0f);
+	_centerY.resize(padded, 0.0f);
+	_centerZ.resize(padded, 0.0f);
+	_extentX.resize(padded, 0.0f);
+	_extentY.resize(padded, 0.0f);
+	_extentZ.resize(padded, 0.0f);
+}
+
+BoundingSphereArray::BoundingSphereArray()
+	: _count(0) {
+}
+
+void BoundingSphereArray::reserve( int count ) {
+	const size_t padded = static_cast<size_t>(paddedCount(count));
+	_centerX.reserve(padded);
+	_centerY.reserve(padded);
+	_centerZ.reserve(padded);
+	_radius.reserve(padded);
+}
+
+void BoundingSphereArray::clear() {
+	_count = 0;
+	resizeStreams(0);
+}
+
+int BoundingSphereArray::add( const cc::Vec3f& center, float radius ) {
+	const int index = _count;
+	resizeStreams(_count + 1);
+	_count += 1;
+	set(index, center, radius);
+	return index;
+}
+
+void BoundingSphereArray::set( int index, const cc::Vec3f& center, float radius ) {
+	if( index < 0 || index >= _count ) {
+		return;
+	}
+	_centerX[index] = center.x;
+	_centerY[index] = center.y;
+	_centerZ[index] = center.z;
+	_radius[index] = radius;
+}
+
+int BoundingSphereArray::size() const {
+	return _count;
+}
+
+void BoundingSphereArray::resizeStreams( int count ) {
+	const size_t padded = static_cast<size_t>(paddedCount(count));
+	_centerX.resize(padded, 0.0f);
+	_centerY.resize(padded, 0.0f);
+	_centerZ.resize(padded, 0.0f);
+	_radius.resize(padded, 0.0f);
+}
+
+FrustumCuller::FrustumCuller() {
+	for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+		_normalX[i] = _normalY[i] = _normalZ[i] = 0.0f;
+		_d[i] = 0.0f;
+	}
+}
+
+void FrustumCuller::setFrustum( const BoundingFrustum& frustum ) {
+	for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+		const Plane& plane = frustum.planes()[i];
+		_normalX[i] = plane.getNormal().x;
+		_normalY[i] = plane.getNormal().y;
+		_normalZ[i] = plane.getNormal().z;
+		_d[i] = plane.getD();
+	}
+}
+
+int FrustumCuller::cull( const BoundingBoxArray& boxes, std::vector<int>& visible ) {
+	const int count = boxes.size();
+	const int groupCount = paddedCount(count) / 4;
+	if( static_cast<int>(_boxPlaneHints.size()) < groupCount ) {
+		_boxPlaneHints.resize(groupCount, 0);
+	}
+	visible.resize(groupCount * 4);
+	if( 0 == count ) {
+		return 0;
+	}
+
+	__m128 nx[BoundingFrustum::PlaneCount], ny[BoundingFrustum::PlaneCount], nz[BoundingFrustum::PlaneCount];
+	__m128 ax[BoundingFrustum::PlaneCount], ay[BoundingFrustum::PlaneCount], az[BoundingFrustum::PlaneCount];
+	__m128 d[BoundingFrustum::PlaneCount];
+	for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+		nx[i] = _mm_set1_ps(_normalX[i]);
+		ny[i] = _mm_set1_ps(_normalY[i]);
+		nz[i] = _mm_set1_ps(_normalZ[i]);
+		ax[i] = abs4(nx[i]);
+		ay[i] = abs4(ny[i]);
+		az[i] = abs4(nz[i]);
+		d[i] = _mm_set1_ps(_d[i]);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	const float* cxs = boxes._centerX.data();
+	const float* cys = boxes._centerY.data();
+	const float* czs = boxes._centerZ.data();
+	const float* exs = boxes._extentX.data();
+	const float* eys = boxes._extentY.data();
+	const float* ezs = boxes._extentZ.data();
+	int* out = visible.data();
+	int visibleCount = 0;
+	for( int group = 0; group < groupCount; ++group ) {
+		const int base = group * 4;
+		const __m128 cx = _mm_loadu_ps(cxs + base);
+		const __m128 cy = _mm_loadu_ps(cys + base);
+		const __m128 cz = _mm_loadu_ps(czs + base);
+		const __m128 ex = _mm_loadu_ps(exs + base);
+		const __m128 ey = _mm_loadu_ps(eys + base);
+		const __m128 ez = _mm_loadu_ps(ezs + base);
+
+		int inside = laneMask(count - base);
+		const unsigned char* order = PLANE_ORDER[_boxPlaneHints[group]];
+		for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+			const int p = order[i];
+			// box is outside when its center is further behind the plane than its projected radius
+			const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+			inside &= _mm_movemask_ps(_mm_cmpge_ps(_mm_add_ps(dist, radius), zero));
+			if( 0 == inside ) {
+				_boxPlaneHints[group] = static_cast<unsigned char>(p);
+				break;
+			}
+		}
+		visibleCount = appendLanes(out, visibleCount, base, inside);
+	}
+
+	visible.resize(visibleCount);
+	return visibleCount;
+}
+
+int FrustumCuller::cull( const BoundingSphereArray& spheres, std::vector<int>& visible ) {
+	const int count = spheres.size();
+	const int groupCount = paddedCount(count) / 4;
+	if( static_cast<int>(_spherePlaneHints.size()) < groupCount ) {
+		_spherePlaneHints.resize(groupCount, 0);
+	}
+	visible.resize(groupCount * 4);
+	if( 0 == count ) {
+		return 0;
+	}
+
+	__m128 nx[BoundingFrustum::PlaneCount], ny[BoundingFrustum::PlaneCount], nz[BoundingFrustum::PlaneCount];
+	__m128 d[BoundingFrustum::PlaneCount];
+	for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+		nx[i] = _mm_set1_ps(_normalX[i]);
+		ny[i] = _mm_set1_ps(_normalY[i]);
+		nz[i] = _mm_set1_ps(_normalZ[i]);
+		d[i] = _mm_set1_ps(_d[i]);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	const float* cxs = spheres._centerX.data();
+	const float* cys = spheres._centerY.data();
+	const float* czs = spheres._centerZ.data();
+	const float* rs = spheres._radius.data();
+	int* out = visible.data();
+	int visibleCount = 0;
+	for( int group = 0; group < groupCount; ++group ) {
+		const int base = group * 4;
+		const __m128 cx = _mm_loadu_ps(cxs + base);
+		const __m128 cy = _mm_loadu_ps(cys + base);
+		const __m128 cz = _mm_loadu_ps(czs + base);
+		const __m128 r = _mm_loadu_ps(rs + base);
+
+		int inside = laneMask(count - base);
+		const unsigned char* order = PLANE_ORDER[_spherePlaneHints[group]];
+		for( int i = 0; i < BoundingFrustum::PlaneCount; ++i ) {
+			const int p = order[i];
+			const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+			inside &= _mm_movemask_ps(_mm_cmpge_ps(_mm_add_ps(dist, r), zero));
+			if( 0 == inside ) {
+				_spherePlaneHints[group] = static_cast<unsigned char>(p);
+				break;
+			}
+		}
+		visibleCount = appendLanes(out, visibleCount, base, inside);
+	}
+
+	visible.resize(visibleCount);
+	return visibleCount;
+}
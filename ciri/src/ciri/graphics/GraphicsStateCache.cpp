@@ -0,0 +1,83 @@
+#include <ciri/graphics/GraphicsStateCache.hpp>
+
+using namespace ciri;
+
+GraphicsStateCache::Binding::Binding()
+	: handle(0), isKnown(false) {
+}
+
+void GraphicsStateCache::Binding::reset() {
+	object.reset();
+	handle = 0;
+	isKnown = false;
+}
+
+GraphicsStateCache::GraphicsStateCache()
+	: _redundantCalls(0), _stateChanges(0), _lastRedundantCalls(0), _lastStateChanges(0),
+		_vertexAttributeSetups(0), _vertexInputBinds(0), _lastVertexAttributeSetups(0), _lastVertexInputBinds(0) {
+}
+
+GraphicsStateCache::~GraphicsStateCache() {
+}
+
+void GraphicsStateCache::invalidate() {
+	_shader.reset();
+	_vertexBuffer.reset();
+	_indexBuffer.reset();
+	_blendState.reset();
+	_rasterizerState.reset();
+	_depthStencilState.reset();
+	invalidateTextures();
+	for( int i = 0; i < MAX_TABLES; ++i ) {
+		for( int j = 0; j < MAX_SLOTS; ++j ) {
+			_samplers[i][j].reset();
+		}
+	}
+}
+
+void GraphicsStateCache::invalidateVertexBuffer() {
+	_vertexBuffer.reset();
+}
+
+void GraphicsStateCache::invalidateTextures() {
+	for( int i = 0; i < MAX_TABLES; ++i ) {
+		for( int j = 0; j < MAX_SLOTS; ++j ) {
+			_textures[i][j].reset();
+		}
+	}
+}
+
+void GraphicsStateCache::countVertexAttributeSetups( int count ) {
+	_vertexAttributeSetups += count;
+}
+
+void GraphicsStateCache::countVertexInputBind() {
+	_vertexInputBinds += 1;
+}
+
+void GraphicsStateCache::endFrame() {
+	_lastRedundantCalls = _redundantCalls;
+	_lastStateChanges = _stateChanges;
+	_lastVertexAttributeSetups = _vertexAttributeSetups;
+	_lastVertexInputBinds = _vertexInputBinds;
+	_redundantCalls = 0;
+	_stateChanges = 0;
+	_vertexAttributeSetups = 0;
+	_vertexInputBinds = 0;
+}
+
+int GraphicsStateCache::getRedundantCallCount() const {
+	return _lastRedundantCalls;
+}
+
+int GraphicsStateCache::getStateChangeCount() const {
+	return _lastStateChanges;
+}
+
+int GraphicsStateCache::getVertexAttributeSetupCount() const {
+	return _lastVertexAttributeSetups;
+}
+
+int GraphicsStateCache::getVertexInputBindCount() const {
+	return _lastVertexInputBinds;
+}
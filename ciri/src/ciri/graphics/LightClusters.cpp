@@ -0,0 +1,589 @@
+#include <ciri/graphics/LightClusters.hpp>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+#include <ciri/core/JobSystem.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Common.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <xmmintrin.h>
+
+using namespace ciri;
+
+namespace {
+	const int MIN_LIGHTS_PER_THREAD = 64; // fewer lights than this per thread isn't worth handing out
+
+	int paddedCount( int count ) {
+		return (count + 3) & ~3;
+	}
+
+	int laneMask( int remaining ) {
+		return (remaining >= 4) ? 0xF : ((1 << remaining) - 1);
+	}
+
+	// the scalar tests below and the sse ones in buildSlice do the same operations in the same order, so both give the same answers
+
+	bool sphereTouchesBox( float x, float y, float z, float r, float minX, float minY, float minZ, float maxX, float maxY, float maxZ ) {
+		const float dx = std::max(std::max(minX - x, x - maxX), 0.0f);
+		const float dy = std::max(std::max(minY - y, y - maxY), 0.0f);
+		const float dz = std::max(std::max(minZ - z, z - maxZ), 0.0f);
+		return (dx*dx + dy*dy + dz*dz) <= (r*r);
+	}
+
+	// cone against sphere; bart wronski, "cull that cone!"
+	bool coneTouchesSphere( float x, float y, float z, float range, float dirX, float dirY, float dirZ, float cosAngle, float sinAngle, float sx, float sy, float sz, float sr ) {
+		const float vx = sx - x;
+		const float vy = sy - y;
+		const float vz = sz - z;
+		const float lenSq = vx*vx + vy*vy + vz*vz;
+		const float v1 = vx*dirX + vy*dirY + vz*dirZ;
+		const float closest = cosAngle * sqrtf(std::max(lenSq - v1*v1, 0.0f)) - v1*sinAngle;
+		return (closest <= sr) && (v1 <= (sr + range)) && (v1 >= -sr);
+	}
+
+	__m128 sphereTouchesBox4( const __m128& x, const __m128& y, const __m128& z, const __m128& r, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ ) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 bMinX = _mm_set1_ps(*minX);
+		const __m128 bMinY = _mm_set1_ps(*minY);
+		const __m128 bMinZ = _mm_set1_ps(*minZ);
+		const __m128 bMaxX = _mm_set1_ps(*maxX);
+		const __m128 bMaxY = _mm_set1_ps(*maxY);
+		const __m128 bMaxZ = _mm_set1_ps(*maxZ);
+		const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(bMinX, x), _mm_sub_ps(x, bMaxX)), zero);
+		const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(bMinY, y), _mm_sub_ps(y, bMaxY)), zero);
+		const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(bMinZ, z), _mm_sub_ps(z, bMaxZ)), zero);
+		const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		return _mm_cmple_ps(distSq, _mm_mul_ps(r, r));
+	}
+
+	/**
+	 * Appends the lanes of a batch group set in mask to another batch.  dst must have room past its count.
+	 */
+	template<typename Batch>
+	void appendLights( Batch& dst, const Batch& src, int base, int mask ) {
+		while( mask != 0 ) {
+			const int lane = (mask & 1) ? 0 : ((mask & 2) ? 1 : ((mask & 4) ? 2 : 3));
+			mask &= ~(1 << lane);
+			const int from = base + lane;
+			const int to = dst.count;
+			dst.x[to] = src.x[from];
+			dst.y[to] = src.y[from];
+			dst.z[to] = src.z[from];
+			dst.range[to] = src.range[from];
+			dst.dirX[to] = src.dirX[from];
+			dst.dirY[to] = src.dirY[from];
+			dst.dirZ[to] = src.dirZ[from];
+			dst.cosAngle[to] = src.cosAngle[from];
+			dst.sinAngle[to] = src.sinAngle[from];
+			dst.spot[to] = src.spot[from];
+			dst.index[to] = src.index[from];
+			dst.count += 1;
+		}
+	}
+}
+
+LightClusters::LightBatch::LightBatch()
+	: count(0) {
+}
+
+void LightClusters::LightBatch::resize( int newCount ) {
+	// padding lanes are masked off by every test, so what they hold does not matter
+	const size_t padded = static_cast<size_t>(paddedCount(newCount));
+	x.resize(padded, 0.0f);
+	y.resize(padded, 0.0f);
+	z.resize(padded, 0.0f);
+	range.resize(padded, 0.0f);
+	dirX.resize(padded, 0.0f);
+	dirY.resize(padded, 0.0f);
+	dirZ.resize(padded, 0.0f);
+	cosAngle.resize(padded, 0.0f);
+	sinAngle.resize(padded, 0.0f);
+	spot.resize(padded, 0.0f);
+	index.resize(padded, 0);
+	count = newCount;
+}
+
+void LightClusters::BoxArray::resize( int count ) {
+	minX.resize(count);
+	minY.resize(count);
+	minZ.resize(count);
+	maxX.resize(count);
+	maxY.resize(count);
+	maxZ.resize(count);
+}
+
+LightClusters::LightClusters()
+	: _tilesX(0), _tilesY(0), _slices(0), _fov(60.0f), _aspect(1.0f), _nearPlane(0.1f), _farPlane(1000.0f), _sliceScale(0.0f), _sliceBias(0.0f), _jobs(nullptr) {
+}
+
+LightClusters::~LightClusters() {
+	destroy();
+}
+
+bool LightClusters::create( int tilesX, int tilesY, int slices ) {
+	if( tilesX <= 0 || tilesY <= 0 || slices <= 0 ) {
+		return false;
+	}
+	_tilesX = tilesX;
+	_tilesY = tilesY;
+	_slices = slices;
+	_clusterOffsets.assign(getClusterCount(), 0);
+	_clusterCounts.assign(getClusterCount(), 0);
+	_sliceIndices.resize(slices);
+	_sliceIndexCounts.assign(slices, 0);
+	_gridTexture = nullptr;
+	computeClusterBounds();
+	return true;
+}
+
+void LightClusters::destroy() {
+	_tilesX = _tilesY = _slices = 0;
+	clearLights();
+	_clusterOffsets.clear();
+	_clusterCounts.clear();
+	_lightIndices.clear();
+	_sliceIndices.clear();
+	_sliceIndexCounts.clear();
+	_scratch.clear();
+	_gridTexture = nullptr;
+	_indexTexture = nullptr;
+}
+
+void LightClusters::setProjection( float fov, float aspect, float nearPlane, float farPlane ) {
+	// cheap enough to call every frame; the bounds are only worked out again when something changed
+	if( fov == _fov && aspect == _aspect && nearPlane == _nearPlane && farPlane == _farPlane ) {
+		return;
+	}
+	_fov = fov;
+	_aspect = aspect;
+	_nearPlane = nearPlane;
+	_farPlane = farPlane;
+	computeClusterBounds();
+}
+
+void LightClusters::setJobSystem( const std::shared_ptr<JobSystem>& jobs ) {
+	_jobs = jobs;
+}
+
+void LightClusters::clearLights() {
+	_positions.clear();
+	_directions.clear();
+	_ranges.clear();
+	_cosAngles.clear();
+	_sinAngles.clear();
+}
+
+int LightClusters::addPointLight( const cc::Vec3f& position, float range ) {
+	_positions.push_back(position);
+	_directions.push_back(cc::Vec3f(0.0f, 0.0f, -1.0f));
+	_ranges.push_back(range);
+	_cosAngles.push_back(0.0f);
+	_sinAngles.push_back(0.0f);
+	return static_cast<int>(_positions.size()) - 1;
+}
+
+int LightClusters::addSpotLight( const cc::Vec3f& position, const cc::Vec3f& direction, float range, float outerAngle ) {
+	// wide cones reach about as far as the whole sphere, and the cone test only holds below 90 degrees anyway
+	if( outerAngle <= 0.0f || outerAngle >= 90.0f ) {
+		return addPointLight(position, range);
+	}
+	// the view matrix keeps lengths, so a unit direction here is still one in view space
+	_positions.push_back(position);
+	_directions.push_back(direction.normalized());
+	_ranges.push_back(range);
+	_cosAngles.push_back(cosf(cc::math::DEG_TO_RAD * outerAngle));
+	_sinAngles.push_back(sinf(cc::math::DEG_TO_RAD * outerAngle));
+	return static_cast<int>(_positions.size()) - 1;
+}
+
+int LightClusters::getLightCount() const {
+	return static_cast<int>(_positions.size());
+}
+
+void LightClusters::build( const cc::Mat4f& view ) {
+	if( 0 == getClusterCount() ) {
+		return;
+	}
+	transformLights(view);
+
+	int threads = (_jobs != nullptr) ? _jobs->getThreadCount() : 1;
+	threads = std::min(threads, _viewLights.count / MIN_LIGHTS_PER_THREAD);
+	threads = std::max(1, std::min(threads, _slices));
+	if( static_cast<int>(_scratch.size()) < threads * 2 ) {
+		_scratch.resize(threads * 2);
+	}
+
+	// far slices are far larger and so catch far more lights than near ones; taking slices one at a time keeps the threads evenly loaded
+	std::atomic<int> nextSlice(0);
+	const auto work = [this, &nextSlice]( int worker ) {
+		for( int slice = nextSlice.fetch_add(1); slice < _slices; slice = nextSlice.fetch_add(1) ) {
+			buildSlice(slice, _scratch[worker * 2], _scratch[worker * 2 + 1]);
+		}
+	};
+	if( 1 == threads ) {
+		work(0);
+	} else {
+		// one range per worker, each with its own scratch
+		_jobs->parallelFor(0, threads, 1, [&work]( int begin, int end ) {
+			for( int worker = begin; worker < end; ++worker ) {
+				work(worker);
+			}
+		});
+	}
+
+	// stitch the slices' lists together in cluster order
+	int total = 0;
+	for( int slice = 0; slice < _slices; ++slice ) {
+		total += _sliceIndexCounts[slice];
+	}
+	_lightIndices.resize(total);
+	const int clustersPerSlice = _tilesX * _tilesY;
+	int base = 0;
+	for( int slice = 0; slice < _slices; ++slice ) {
+		const int count = _sliceIndexCounts[slice];
+		if( count > 0 ) {
+			memcpy(_lightIndices.data() + base, _sliceIndices[slice].data(), sizeof(int) * count);
+		}
+		for( int c = slice * clustersPerSlice; c < (slice + 1) * clustersPerSlice; ++c ) {
+			_clusterOffsets[c] += base;
+		}
+		base += count;
+	}
+}
+
+void LightClusters::buildReference( const cc::Mat4f& view ) {
+	if( 0 == getClusterCount() ) {
+		return;
+	}
+	transformLights(view);
+
+	_lightIndices.clear();
+	const LightBatch& lights = _viewLights;
+	for( int c = 0; c < getClusterCount(); ++c ) {
+		_clusterOffsets[c] = static_cast<int>(_lightIndices.size());
+		for( int i = 0; i < lights.count; ++i ) {
+			if( !sphereTouchesBox(lights.x[i], lights.y[i], lights.z[i], lights.range[i], _clusterBoxes.minX[c], _clusterBoxes.minY[c], _clusterBoxes.minZ[c], _clusterBoxes.maxX[c], _clusterBoxes.maxY[c], _clusterBoxes.maxZ[c]) ) {
+				continue;
+			}
+			if( lights.spot[i] != 0.0f && !coneTouchesSphere(lights.x[i], lights.y[i], lights.z[i], lights.range[i], lights.dirX[i], lights.dirY[i], lights.dirZ[i], lights.cosAngle[i], lights.sinAngle[i], _clusterSphereX[c], _clusterSphereY[c], _clusterSphereZ[c], _clusterSphereR[c]) ) {
+				continue;
+			}
+			_lightIndices.push_back(lights.index[i]);
+		}
+		_clusterCounts[c] = static_cast<int>(_lightIndices.size()) - _clusterOffsets[c];
+	}
+}
+
+int LightClusters::getTilesX() const {
+	return _tilesX;
+}
+
+int LightClusters::getTilesY() const {
+	return _tilesY;
+}
+
+int LightClusters::getSlices() const {
+	return _slices;
+}
+
+int LightClusters::getClusterCount() const {
+	return _tilesX * _tilesY * _slices;
+}
+
+int LightClusters::getClusterIndex( int x, int y, int slice ) const {
+	return x + (y + slice * _tilesY) * _tilesX;
+}
+
+int LightClusters::getSlice( float depth ) const {
+	if( depth <= _nearPlane ) {
+		return 0;
+	}
+	const int slice = static_cast<int>(floorf(logf(depth) * _sliceScale + _sliceBias));
+	return std::max(0, std::min(slice, _slices - 1));
+}
+
+float LightClusters::getSliceScale() const {
+	return _sliceScale;
+}
+
+float LightClusters::getSliceBias() const {
+	return _sliceBias;
+}
+
+int LightClusters::getClusterOffset( int cluster ) const {
+	return _clusterOffsets[cluster];
+}
+
+int LightClusters::getClusterLightCount( int cluster ) const {
+	return _clusterCounts[cluster];
+}
+
+const std::vector<int>& LightClusters::getLightIndices() const {
+	return _lightIndices;
+}
+
+ErrorCode LightClusters::upload( const std::shared_ptr<IGraphicsDevice>& device ) {
+	if( nullptr == device || 0 == getClusterCount() ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	const int clusterCount = getClusterCount();
+	_gridData.resize(clusterCount * 4);
+	for( int c = 0; c < clusterCount; ++c ) {
+		_gridData[c * 4 + 0] = static_cast<float>(_clusterOffsets[c]);
+		_gridData[c * 4 + 1] = static_cast<float>(_clusterCounts[c]);
+		_gridData[c * 4 + 2] = 0.0f;
+		_gridData[c * 4 + 3] = 0.0f;
+	}
+	if( nullptr == _gridTexture ) {
+		_gridTexture = device->createTexture2D(_tilesX, _tilesY * _slices, TextureFormat::RGBA32_Float, 0, _gridData.data());
+		if( nullptr == _gridTexture ) {
+			return ErrorCode::CIRI_UNKNOWN_ERROR;
+		}
+	} else {
+		const ErrorCode result = _gridTexture->setData(0, 0, _tilesX, _tilesY * _slices, _gridData.data(), TextureFormat::RGBA32_Float);
+		if( failed(result) ) {
+			return result;
+		}
+	}
+
+	// rows grow by doubling so that a scene whose light count wanders does not make a new texture every frame
+	const int needed = std::max(1, (static_cast<int>(_lightIndices.size()) + INDEX_TEXTURE_WIDTH - 1) / INDEX_TEXTURE_WIDTH);
+	int rows = (_indexTexture != nullptr) ? _indexTexture->getHeight() : 1;
+	while( rows < needed ) {
+		rows *= 2;
+	}
+	_indexData.assign(INDEX_TEXTURE_WIDTH * rows, 0.0f);
+	for( size_t i = 0; i < _lightIndices.size(); ++i ) {
+		_indexData[i] = static_cast<float>(_lightIndices[i]);
+	}
+	if( nullptr == _indexTexture || _indexTexture->getHeight() != rows ) {
+		_indexTexture = device->createTexture2D(INDEX_TEXTURE_WIDTH, rows, TextureFormat::R32_FLOAT, 0, _indexData.data());
+		if( nullptr == _indexTexture ) {
+			return ErrorCode::CIRI_UNKNOWN_ERROR;
+		}
+		return ErrorCode::CIRI_OK;
+	}
+	return _indexTexture->setData(0, 0, INDEX_TEXTURE_WIDTH, rows, _indexData.data(), TextureFormat::R32_FLOAT);
+}
+
+const std::shared_ptr<ITexture2D>& LightClusters::getGridTexture() const {
+	return _gridTexture;
+}
+
+const std::shared_ptr<ITexture2D>& LightClusters::getIndexTexture() const {
+	return _indexTexture;
+}
+
+void LightClusters::computeClusterBounds() {
+	if( 0 == getClusterCount() || _nearPlane <= 0.0f || _farPlane <= _nearPlane ) {
+		return;
+	}
+
+	const float depthRatio = logf(_farPlane / _nearPlane);
+	_sliceScale = static_cast<float>(_slices) / depthRatio;
+	_sliceBias = -static_cast<float>(_slices) * logf(_nearPlane) / depthRatio;
+
+	const float tanY = tanf(cc::math::DEG_TO_RAD * _fov * 0.5f);
+	const float tanX = tanY * _aspect;
+	const int clusterCount = getClusterCount();
+	_clusterBoxes.resize(clusterCount);
+	_clusterSphereX.resize(clusterCount);
+	_clusterSphereY.resize(clusterCount);
+	_clusterSphereZ.resize(clusterCount);
+	_clusterSphereR.resize(clusterCount);
+	_sliceBoxes.resize(_slices);
+	_rowBoxes.resize(_slices * _tilesY);
+
+	for( int slice = 0; slice < _slices; ++slice ) {
+		const float nearDepth = _nearPlane * powf(_farPlane / _nearPlane, static_cast<float>(slice) / static_cast<float>(_slices));
+		const float farDepth = (slice == _slices - 1) ? _farPlane : _nearPlane * powf(_farPlane / _nearPlane, static_cast<float>(slice + 1) / static_cast<float>(_slices));
+		for( int y = 0; y < _tilesY; ++y ) {
+			const float ndcY0 = -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(_tilesY);
+			const float ndcY1 = -1.0f + 2.0f * static_cast<float>(y + 1) / static_cast<float>(_tilesY);
+			for( int x = 0; x < _tilesX; ++x ) {
+				const float ndcX0 = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(_tilesX);
+				const float ndcX1 = -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(_tilesX);
+
+				// the tile's sides spread out with depth, so the box takes the extremes of both ends
+				const int c = getClusterIndex(x, y, slice);
+				_clusterBoxes.minX[c] = std::min(std::min(ndcX0 * tanX * nearDepth, ndcX0 * tanX * farDepth), std::min(ndcX1 * tanX * nearDepth, ndcX1 * tanX * farDepth));
+				_clusterBoxes.maxX[c] = std::max(std::max(ndcX0 * tanX * nearDepth, ndcX0 * tanX * farDepth), std::max(ndcX1 * tanX * nearDepth, ndcX1 * tanX * farDepth));
+				_clusterBoxes.minY[c] = std::min(std::min(ndcY0 * tanY * nearDepth, ndcY0 * tanY * farDepth), std::min(ndcY1 * tanY * nearDepth, ndcY1 * tanY * farDepth));
+				_clusterBoxes.maxY[c] = std::max(std::max(ndcY0 * tanY * nearDepth, ndcY0 * tanY * farDepth), std::max(ndcY1 * tanY * nearDepth, ndcY1 * tanY * farDepth));
+				_clusterBoxes.minZ[c] = -farDepth;
+				_clusterBoxes.maxZ[c] = -nearDepth;
+
+				const float hx = (_clusterBoxes.maxX[c] - _clusterBoxes.minX[c]) * 0.5f;
+				const float hy = (_clusterBoxes.maxY[c] - _clusterBoxes.minY[c]) * 0.5f;
+				const float hz = (_clusterBoxes.maxZ[c] - _clusterBoxes.minZ[c]) * 0.5f;
+				_clusterSphereX[c] = _clusterBoxes.minX[c] + hx;
+				_clusterSphereY[c] = _clusterBoxes.minY[c] + hy;
+				_clusterSphereZ[c] = _clusterBoxes.minZ[c] + hz;
+				_clusterSphereR[c] = sqrtf(hx*hx + hy*hy + hz*hz);
+			}
+		}
+
+		// rows and slices bound their clusters, so a light missing one misses every cluster in it
+		for( int y = 0; y < _tilesY; ++y ) {
+			const int row = slice * _tilesY + y;
+			const int first = getClusterIndex(0, y, slice);
+			_rowBoxes.minX[row] = _clusterBoxes.minX[first];
+			_rowBoxes.minY[row] = _clusterBoxes.minY[first];
+			_rowBoxes.minZ[row] = _clusterBoxes.minZ[first];
+			_rowBoxes.maxX[row] = _clusterBoxes.maxX[first];
+			_rowBoxes.maxY[row] = _clusterBoxes.maxY[first];
+			_rowBoxes.maxZ[row] = _clusterBoxes.maxZ[first];
+			for( int x = 1; x < _tilesX; ++x ) {
+				const int c = first + x;
+				_rowBoxes.minX[row] = std::min(_rowBoxes.minX[row], _clusterBoxes.minX[c]);
+				_rowBoxes.minY[row] = std::min(_rowBoxes.minY[row], _clusterBoxes.minY[c]);
+				_rowBoxes.minZ[row] = std::min(_rowBoxes.minZ[row], _clusterBoxes.minZ[c]);
+				_rowBoxes.maxX[row] = std::max(_rowBoxes.maxX[row], _clusterBoxes.maxX[c]);
+				_rowBoxes.maxY[row] = std::max(_rowBoxes.maxY[row], _clusterBoxes.maxY[c]);
+				_rowBoxes.maxZ[row] = std::max(_rowBoxes.maxZ[row], _clusterBoxes.maxZ[c]);
+			}
+		}
+		const int firstRow = slice * _tilesY;
+		_sliceBoxes.minX[slice] = _rowBoxes.minX[firstRow];
+		_sliceBoxes.minY[slice] = _rowBoxes.minY[firstRow];
+		_sliceBoxes.minZ[slice] = _rowBoxes.minZ[firstRow];
+		_sliceBoxes.maxX[slice] = _rowBoxes.maxX[firstRow];
+		_sliceBoxes.maxY[slice] = _rowBoxes.maxY[firstRow];
+		_sliceBoxes.maxZ[slice] = _rowBoxes.maxZ[firstRow];
+		for( int y = 1; y < _tilesY; ++y ) {
+			const int row = firstRow + y;
+			_sliceBoxes.minX[slice] = std::min(_sliceBoxes.minX[slice], _rowBoxes.minX[row]);
+			_sliceBoxes.minY[slice] = std::min(_sliceBoxes.minY[slice], _rowBoxes.minY[row]);
+			_sliceBoxes.minZ[slice] = std::min(_sliceBoxes.minZ[slice], _rowBoxes.minZ[row]);
+			_sliceBoxes.maxX[slice] = std::max(_sliceBoxes.maxX[slice], _rowBoxes.maxX[row]);
+			_sliceBoxes.maxY[slice] = std::max(_sliceBoxes.maxY[slice], _rowBoxes.maxY[row]);
+			_sliceBoxes.maxZ[slice] = std::max(_sliceBoxes.maxZ[slice], _rowBoxes.maxZ[row]);
+		}
+	}
+}
+
+void LightClusters::transformLights( const cc::Mat4f& view ) {
+	// side planes of the view volume, which pass through the eye, as unit normals pointing in
+	const float tanY = tanf(cc::math::DEG_TO_RAD * _fov * 0.5f);
+	const float tanX = tanY * _aspect;
+	const float invLengthX = 1.0f / sqrtf(1.0f + tanX * tanX);
+	const float invLengthY = 1.0f / sqrtf(1.0f + tanY * tanY);
+
+	const int count = getLightCount();
+	_viewLights.resize(count);
+	int visible = 0;
+	for( int i = 0; i < count; ++i ) {
+		const cc::Vec4f position = view * cc::Vec4f(_positions[i].x, _positions[i].y, _positions[i].z, 1.0f);
+		const float range = _ranges[i];
+
+		// lights wholly outside the view volume light nothing that is seen, so they never reach the slices
+		const float sideX = -tanX * position.z * invLengthX;
+		const float sideY = -tanY * position.z * invLengthY;
+		if( (position.z - range) > -_nearPlane || (position.z + range) < -_farPlane ||
+				(sideX + position.x * invLengthX) < -range || (sideX - position.x * invLengthX) < -range ||
+				(sideY + position.y * invLengthY) < -range || (sideY - position.y * invLengthY) < -range ) {
+			continue;
+		}
+
+		const int to = visible++;
+		_viewLights.x[to] = position.x;
+		_viewLights.y[to] = position.y;
+		_viewLights.z[to] = position.z;
+		_viewLights.range[to] = range;
+		_viewLights.index[to] = i;
+		if( _sinAngles[i] > 0.0f ) {
+			const cc::Vec4f direction = view * cc::Vec4f(_directions[i].x, _directions[i].y, _directions[i].z, 0.0f);
+			_viewLights.dirX[to] = direction.x;
+			_viewLights.dirY[to] = direction.y;
+			_viewLights.dirZ[to] = direction.z;
+			_viewLights.spot[to] = 1.0f;
+		} else {
+			_viewLights.dirX[to] = _viewLights.dirY[to] = _viewLights.dirZ[to] = 0.0f;
+			_viewLights.spot[to] = 0.0f;
+		}
+		_viewLights.cosAngle[to] = _cosAngles[i];
+		_viewLights.sinAngle[to] = _sinAngles[i];
+	}
+	_viewLights.count = visible;
+}
+
+void LightClusters::buildSlice( int slice, LightBatch& sliceLights, LightBatch& rowLights ) {
+	const __m128 zero = _mm_setzero_ps();
+
+	// lights touching the slice at all
+	sliceLights.resize(_viewLights.count);
+	sliceLights.count = 0;
+	for( int base = 0; base < _viewLights.count; base += 4 ) {
+		const __m128 hit = sphereTouchesBox4(_mm_loadu_ps(&_viewLights.x[base]), _mm_loadu_ps(&_viewLights.y[base]), _mm_loadu_ps(&_viewLights.z[base]), _mm_loadu_ps(&_viewLights.range[base]),
+			&_sliceBoxes.minX[slice], &_sliceBoxes.minY[slice], &_sliceBoxes.minZ[slice], &_sliceBoxes.maxX[slice], &_sliceBoxes.maxY[slice], &_sliceBoxes.maxZ[slice]);
+		appendLights(sliceLights, _viewLights, base, _mm_movemask_ps(hit) & laneMask(_viewLights.count - base));
+	}
+
+	std::vector<int>& out = _sliceIndices[slice];
+	int outCount = 0;
+	for( int y = 0; y < _tilesY; ++y ) {
+		const int row = slice * _tilesY + y;
+
+		// lights touching the row
+		rowLights.resize(sliceLights.count);
+		rowLights.count = 0;
+		for( int base = 0; base < sliceLights.count; base += 4 ) {
+			const __m128 hit = sphereTouchesBox4(_mm_loadu_ps(&sliceLights.x[base]), _mm_loadu_ps(&sliceLights.y[base]), _mm_loadu_ps(&sliceLights.z[base]), _mm_loadu_ps(&sliceLights.range[base]),
+				&_rowBoxes.minX[row], &_rowBoxes.minY[row], &_rowBoxes.minZ[row], &_rowBoxes.maxX[row], &_rowBoxes.maxY[row], &_rowBoxes.maxZ[row]);
+			appendLights(rowLights, sliceLights, base, _mm_movemask_ps(hit) & laneMask(sliceLights.count - base));
+		}
+
+		// each cluster of the row writes at most every row light, plus the four a group writes past its count
+		const size_t room = static_cast<size_t>(outCount + paddedCount(rowLights.count) * _tilesX + 4);
+		if( out.size() < room ) {
+			out.resize(std::max(room, out.size() * 2));
+		}
+
+		for( int x = 0; x < _tilesX; ++x ) {
+			const int c = getClusterIndex(x, y, slice);
+			const __m128 sx = _mm_set1_ps(_clusterSphereX[c]);
+			const __m128 sy = _mm_set1_ps(_clusterSphereY[c]);
+			const __m128 sz = _mm_set1_ps(_clusterSphereZ[c]);
+			const __m128 sr = _mm_set1_ps(_clusterSphereR[c]);
+			const __m128 negSr = _mm_sub_ps(zero, sr);
+			const int start = outCount;
+			int* dst = out.data();
+			for( int base = 0; base < rowLights.count; base += 4 ) {
+				const __m128 lx = _mm_loadu_ps(&rowLights.x[base]);
+				const __m128 ly = _mm_loadu_ps(&rowLights.y[base]);
+				const __m128 lz = _mm_loadu_ps(&rowLights.z[base]);
+				const __m128 lr = _mm_loadu_ps(&rowLights.range[base]);
+				const __m128 hit = sphereTouchesBox4(lx, ly, lz, lr, &_clusterBoxes.minX[c], &_clusterBoxes.minY[c], &_clusterBoxes.minZ[c], &_clusterBoxes.maxX[c], &_clusterBoxes.maxY[c], &_clusterBoxes.maxZ[c]);
+				int mask = _mm_movemask_ps(hit) & laneMask(rowLights.count - base);
+				if( 0 == mask ) {
+					continue;
+				}
+
+				// spot lights must also have the cluster inside their cone; point lights pass as they are
+				const __m128 spot = _mm_loadu_ps(&rowLights.spot[base]);
+				if( _mm_movemask_ps(_mm_cmpneq_ps(spot, zero)) & mask ) {
+					const __m128 vx = _mm_sub_ps(sx, lx);
+					const __m128 vy = _mm_sub_ps(sy, ly);
+					const __m128 vz = _mm_sub_ps(sz, lz);
+					const __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+					const __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&rowLights.dirX[base])), _mm_mul_ps(vy, _mm_loadu_ps(&rowLights.dirY[base]))), _mm_mul_ps(vz, _mm_loadu_ps(&rowLights.dirZ[base])));
+					const __m128 closest = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&rowLights.cosAngle[base]), _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lenSq, _mm_mul_ps(v1, v1)), zero))), _mm_mul_ps(v1, _mm_loadu_ps(&rowLights.sinAngle[base])));
+					const __m128 inCone = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(closest, sr), _mm_cmple_ps(v1, _mm_add_ps(sr, lr))), _mm_cmpge_ps(v1, negSr));
+					mask &= _mm_movemask_ps(_mm_or_ps(_mm_cmpeq_ps(spot, zero), inCone));
+				}
+
+				// writes every lane and only advances past the set ones, so there are no branches per light
+				const int* indices = &rowLights.index[base];
+				dst[outCount] = indices[0]; outCount += (mask >> 0) & 1;
+				dst[outCount] = indices[1]; outCount += (mask >> 1) & 1;
+				dst[outCount] = indices[2]; outCount += (mask >> 2) & 1;
+				dst[outCount] = indices[3]; outCount += (mask >> 3) & 1;
+			}
+			_clusterOffsets[c] = start;
+			_clusterCounts[c] = outCount - start;
+		}
+	}
+	_sliceIndexCounts[slice] = outCount;
+}
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include <ciri/graphics/ObjModel.hpp>
-#include <fstream>
 #include <cmath>
+#include <ciri/core/FileSystem.hpp>
 #include <ciri/core/StrUtil.hpp>
 
 using namespace ciri;
@@ -14,20 +14,23 @@ ObjModel::~ObjModel() {
 bool ObjModel::parse( const char* file ) {
 	reset();
 
-	std::ifstream in(file, std::ios::in);
-	if( !in.is_open() ) {
+	FileDataStream in(FileSystem::read(file));
+	if( !in ) {
 		return false;
 	}
 
 	bool success = true;
 	std::string line;
 	while( std::getline(in, line) ) {
+		// the bytes are read as they are, so windows line endings keep their carriage return
+		if( !line.empty() && '\r' == line.back() ) {
+			line.pop_back();
+		}
 		if( !parseLine(line) ) {
 			success = false;
 			break;
 		}
 	}
-	in.close();
 
 	return success;
 }
@@ -0,0 +1,38 @@
+#include <ciri/graphics/PipelineState.hpp>
+
+using namespace ciri;
+
+PipelineState::PipelineState( const PipelineDesc& desc, size_t hash, const std::shared_ptr<IBlendState>& blend, const std::shared_ptr<IRasterizerState>& rasterizer, const std::shared_ptr<IDepthStencilState>& depthStencil )
+	: IPipelineState(), _desc(desc), _hash(hash), _blendState(blend), _rasterizerState(rasterizer), _depthStencilState(depthStencil) {
+}
+
+PipelineState::~PipelineState() {
+}
+
+const PipelineDesc& PipelineState::getDesc() const {
+	return _desc;
+}
+
+size_t PipelineState::getHash() const {
+	return _hash;
+}
+
+PrimitiveTopology PipelineState::getTopology() const {
+	return _desc.topology;
+}
+
+const std::shared_ptr<IShader>& PipelineState::getShader() const {
+	return _desc.shader;
+}
+
+const std::shared_ptr<IBlendState>& PipelineState::getBlendState() const {
+	return _blendState;
+}
+
+const std::shared_ptr<IRasterizerState>& PipelineState::getRasterizerState() const {
+	return _rasterizerState;
+}
+
+const std::shared_ptr<IDepthStencilState>& PipelineState::getDepthStencilState() const {
+	return _depthStencilState;
+}
\ No newline at end of file
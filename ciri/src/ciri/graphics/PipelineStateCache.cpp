@@ -0,0 +1,211 @@
+#include <ciri/graphics/PipelineStateCache.hpp>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+#include <functional>
+
+using namespace ciri;
+
+static void combine( size_t& seed, size_t value ) {
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template<typename T>
+static void combineValue( size_t& seed, const T& value ) {
+	combine(seed, std::hash<T>()(value));
+}
+
+template<typename T>
+static void combineEnum( size_t& seed, T value ) {
+	combine(seed, static_cast<size_t>(value));
+}
+
+static bool equals( const BlendDesc& a, const BlendDesc& b ) {
+	return (a.srcColorBlend == b.srcColorBlend) && (a.dstColorBlend == b.dstColorBlend) &&
+	       (a.srcAlphaBlend == b.srcAlphaBlend) && (a.dstAlphaBlend == b.dstAlphaBlend) &&
+	       (a.blendFactor[0] == b.blendFactor[0]) && (a.blendFactor[1] == b.blendFactor[1]) &&
+	       (a.blendFactor[2] == b.blendFactor[2]) && (a.blendFactor[3] == b.blendFactor[3]) &&
+	       (a.colorFunc == b.colorFunc) && (a.alphaFunc == b.alphaFunc) && (a.colorMask == b.colorMask);
+}
+
+static bool equals( const RasterizerDesc& a, const RasterizerDesc& b ) {
+	return (a.cullMode == b.cullMode) && (a.depthBias == b.depthBias) && (a.fillMode == b.fillMode) &&
+	       (a.msaa == b.msaa) && (a.scissorTestEnable == b.scissorTestEnable) &&
+	       (a.slopeScaleDepthBias == b.slopeScaleDepthBias) && (a.depthClipEnable == b.depthClipEnable);
+}
+
+static bool equals( const DepthStencilDesc& a, const DepthStencilDesc& b ) {
+	return (a.depthEnable == b.depthEnable) && (a.depthWriteMask == b.depthWriteMask) && (a.depthFunc == b.depthFunc) &&
+	       (a.stencilEnable == b.stencilEnable) && (a.stencilReadMask == b.stencilReadMask) && (a.stencilWriteMask == b.stencilWriteMask) &&
+	       (a.frontStencilFailOp == b.frontStencilFailOp) && (a.frontStencilDepthFailOp == b.frontStencilDepthFailOp) &&
+	       (a.frontStencilPassOp == b.frontStencilPassOp) && (a.frontStencilFunc == b.frontStencilFunc) &&
+	       (a.backStencilFailOp == b.backStencilFailOp) && (a.backStencilDepthFailOp == b.backStencilDepthFailOp) &&
+	       (a.backStencilPassOp == b.backStencilPassOp) && (a.backStencilFunc == b.backStencilFunc) &&
+	       (a.twoSidedStencil == b.twoSidedStencil) && (a.stencilRef == b.stencilRef);
+}
+
+static bool equals( const PipelineDesc& a, const PipelineDesc& b ) {
+	return (a.shader == b.shader) && (a.topology == b.topology) && equals(a.blend, b.blend) && equals(a.rasterizer, b.rasterizer) && equals(a.depthStencil, b.depthStencil);
+}
+
+// finds a live entry in a bucket whose description matches, dropping expired entries along the way
+template<typename Desc, typename T>
+static std::shared_ptr<T> findState( std::unordered_multimap<size_t, std::pair<Desc, std::weak_ptr<T>>>& map, size_t descHash, const Desc& desc ) {
+	auto range = map.equal_range(descHash);
+	for( auto it = range.first; it != range.second; ) {
+		std::shared_ptr<T> state = it->second.second.lock();
+		if( nullptr == state ) {
+			it = map.erase(it);
+			continue;
+		}
+		if( equals(it->second.first, desc) ) {
+			return state;
+		}
+		++it;
+	}
+	return nullptr;
+}
+
+PipelineStateCache::PipelineStateCache() {
+}
+
+PipelineStateCache::~PipelineStateCache() {
+}
+
+std::shared_ptr<IPipelineState> PipelineStateCache::create( IGraphicsDevice* device, const PipelineDesc& desc ) {
+	// a shader still compiling is fine; it is finished when the pipeline is applied
+	if( nullptr == device || nullptr == desc.shader || (!desc.shader->isValid() && !desc.shader->isPending()) ) {
+		return nullptr;
+	}
+
+	// same description, same pipeline
+	const size_t descHash = hash(desc);
+	auto range = _pipelines.equal_range(descHash);
+	for( auto it = range.first; it != range.second; ) {
+		std::shared_ptr<PipelineState> pipeline = it->second.lock();
+		if( nullptr == pipeline ) {
+			it = _pipelines.erase(it);
+			continue;
+		}
+		if( equals(pipeline->getDesc(), desc) ) {
+			return pipeline;
+		}
+		++it;
+	}
+
+	const std::shared_ptr<IBlendState> blend = getBlendState(device, desc.blend, hash(desc.blend));
+	const std::shared_ptr<IRasterizerState> rasterizer = getRasterizerState(device, desc.rasterizer, hash(desc.rasterizer));
+	const std::shared_ptr<IDepthStencilState> depthStencil = getDepthStencilState(device, desc.depthStencil, hash(desc.depthStencil));
+	if( nullptr == blend || nullptr == rasterizer || nullptr == depthStencil ) {
+		return nullptr;
+	}
+
+	const std::shared_ptr<PipelineState> pipeline = std::make_shared<PipelineState>(desc, descHash, blend, rasterizer, depthStencil);
+	_pipelines.insert(std::make_pair(descHash, std::weak_ptr<PipelineState>(pipeline)));
+	return pipeline;
+}
+
+void PipelineStateCache::clear() {
+	_pipelines.clear();
+	_blendStates.clear();
+	_rasterizerStates.clear();
+	_depthStencilStates.clear();
+}
+
+int PipelineStateCache::getCount() const {
+	int count = 0;
+	for( const auto& entry : _pipelines ) {
+		if( !entry.second.expired() ) {
+			count += 1;
+		}
+	}
+	return count;
+}
+
+size_t PipelineStateCache::hash( const BlendDesc& desc ) {
+	size_t seed = 0;
+	combineEnum(seed, desc.srcColorBlend);
+	combineEnum(seed, desc.dstColorBlend);
+	combineEnum(seed, desc.srcAlphaBlend);
+	combineEnum(seed, desc.dstAlphaBlend);
+	for( int i = 0; i < 4; ++i ) {
+		combineValue(seed, desc.blendFactor[i]);
+	}
+	combineEnum(seed, desc.colorFunc);
+	combineEnum(seed, desc.alphaFunc);
+	combineValue(seed, desc.colorMask);
+	return seed;
+}
+
+size_t PipelineStateCache::hash( const RasterizerDesc& desc ) {
+	size_t seed = 0;
+	combineEnum(seed, desc.cullMode);
+	combineValue(seed, desc.depthBias);
+	combineEnum(seed, desc.fillMode);
+	combineValue(seed, desc.msaa);
+	combineValue(seed, desc.scissorTestEnable);
+	combineValue(seed, desc.slopeScaleDepthBias);
+	combineValue(seed, desc.depthClipEnable);
+	return seed;
+}
+
+size_t PipelineStateCache::hash( const DepthStencilDesc& desc ) {
+	size_t seed = 0;
+	combineValue(seed, desc.depthEnable);
+	combineValue(seed, desc.depthWriteMask);
+	combineEnum(seed, desc.depthFunc);
+	combineValue(seed, desc.stencilEnable);
+	combineValue(seed, desc.stencilReadMask);
+	combineValue(seed, desc.stencilWriteMask);
+	combineEnum(seed, desc.frontStencilFailOp);
+	combineEnum(seed, desc.frontStencilDepthFailOp);
+	combineEnum(seed, desc.frontStencilPassOp);
+	combineEnum(seed, desc.frontStencilFunc);
+	combineEnum(seed, desc.backStencilFailOp);
+	combineEnum(seed, desc.backStencilDepthFailOp);
+	combineEnum(seed, desc.backStencilPassOp);
+	combineEnum(seed, desc.backStencilFunc);
+	combineValue(seed, desc.twoSidedStencil);
+	combineValue(seed, desc.stencilRef);
+	return seed;
+}
+
+size_t PipelineStateCache::hash( const PipelineDesc& desc ) {
+	size_t seed = std::hash<std::shared_ptr<IShader>>()(desc.shader);
+	combine(seed, hash(desc.blend));
+	combine(seed, hash(desc.rasterizer));
+	combine(seed, hash(desc.depthStencil));
+	combineEnum(seed, desc.topology);
+	return seed;
+}
+
+std::shared_ptr<IBlendState> PipelineStateCache::getBlendState( IGraphicsDevice* device, const BlendDesc& desc, size_t descHash ) {
+	std::shared_ptr<IBlendState> state = findState(_blendStates, descHash, desc);
+	if( nullptr == state ) {
+		state = device->createBlendState(desc);
+		if( state != nullptr ) {
+			_blendStates.insert(std::make_pair(descHash, std::make_pair(desc, std::weak_ptr<IBlendState>(state))));
+		}
+	}
+	return state;
+}
+
+std::shared_ptr<IRasterizerState> PipelineStateCache::getRasterizerState( IGraphicsDevice* device, const RasterizerDesc& desc, size_t descHash ) {
+	std::shared_ptr<IRasterizerState> state = findState(_rasterizerStates, descHash, desc);
+	if( nullptr == state ) {
+		state = device->createRasterizerState(desc);
+		if( state != nullptr ) {
+			_rasterizerStates.insert(std::make_pair(descHash, std::make_pair(desc, std::weak_ptr<IRasterizerState>(state))));
+		}
+	}
+	return state;
+}
+
+std::shared_ptr<IDepthStencilState> PipelineStateCache::getDepthStencilState( IGraphicsDevice* device, const DepthStencilDesc& desc, size_t descHash ) {
+	std::shared_ptr<IDepthStencilState> state = findState(_depthStencilStates, descHash, desc);
+	if( nullptr == state ) {
+		state = device->createDepthStencilState(desc);
+		if( state != nullptr ) {
+			_depthStencilStates.insert(std::make_pair(descHash, std::make_pair(desc, std::weak_ptr<IDepthStencilState>(state))));
+		}
+	}
+	return state;
+}
\ No newline at end of file
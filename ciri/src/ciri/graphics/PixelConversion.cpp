@@ -0,0 +1,110 @@
+#include <ciri/graphics/PixelConversion.hpp>
+#include <emmintrin.h>
+#include <cstring>
+
+using namespace ciri;
+
+namespace {
+	unsigned char unormToByte( float value ) {
+		// written so that nan becomes zero, like _mm_max_ps with the value first
+		const float clamped = (value > 0.0f) ? ((value < 1.0f) ? value : 1.0f) : 0.0f;
+		return static_cast<unsigned char>(clamped * 255.0f + 0.5f);
+	}
+
+	unsigned int grayPixel( unsigned int value ) {
+		return value | (value << 8) | (value << 16) | 0xFF000000;
+	}
+
+	// four floats to four integers in [0, 255]
+	__m128i unormToInt4( const __m128& f ) {
+		const __m128 clamped = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+	}
+
+	// four integers in [0, 255] to four gray RGBA pixels
+	__m128i grayPixel4( const __m128i& value ) {
+		const __m128i rg = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+		return _mm_or_si128(_mm_or_si128(rg, _mm_slli_epi32(value, 16)), _mm_set1_epi32(0xFF000000));
+	}
+}
+
+int PixelConversion::bytesPerTexel( Source source ) {
+	switch( source ) {
+		case RGBA32F: {
+			return 16;
+		}
+
+		default: {
+			return 4;
+		}
+	}
+}
+
+void PixelConversion::toRGBA8( Source source, int shift, const void* src, unsigned char* dst, int count ) {
+	switch( source ) {
+		case RGBA8: {
+			memcpy(dst, src, count * 4);
+			break;
+		}
+
+		case RGBA32F: {
+			rgba32fToRGBA8(static_cast<const float*>(src), dst, count);
+			break;
+		}
+
+		case R32F: {
+			r32fToRGBA8(static_cast<const float*>(src), dst, count);
+			break;
+		}
+
+		case UInt32: {
+			uint32ToRGBA8(static_cast<const unsigned int*>(src), dst, count, shift);
+			break;
+		}
+	}
+}
+
+void PixelConversion::rgba32fToRGBA8( const float* src, unsigned char* dst, int count ) {
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		const float* in = src + i * 4;
+		const __m128i a = unormToInt4(_mm_loadu_ps(in));
+		const __m128i b = unormToInt4(_mm_loadu_ps(in + 4));
+		const __m128i c = unormToInt4(_mm_loadu_ps(in + 8));
+		const __m128i d = unormToInt4(_mm_loadu_ps(in + 12));
+		const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), packed);
+	}
+	for( ; i < count; ++i ) {
+		for( int c = 0; c < 4; ++c ) {
+			dst[i * 4 + c] = unormToByte(src[i * 4 + c]);
+		}
+	}
+}
+
+void PixelConversion::r32fToRGBA8( const float* src, unsigned char* dst, int count ) {
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		const __m128i gray = grayPixel4(unormToInt4(_mm_loadu_ps(src + i)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), gray);
+	}
+	for( ; i < count; ++i ) {
+		const unsigned int gray = grayPixel(unormToByte(src[i]));
+		memcpy(dst + i * 4, &gray, sizeof(gray));
+	}
+}
+
+void PixelConversion::uint32ToRGBA8( const unsigned int* src, unsigned char* dst, int count, int shift ) {
+	const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+	const __m128i byteMask = _mm_set1_epi32(0xFF);
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i gray = grayPixel4(_mm_and_si128(_mm_srl_epi32(raw, shiftCount), byteMask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), gray);
+	}
+	for( ; i < count; ++i ) {
+		const unsigned int gray = grayPixel((src[i] >> shift) & 0xFF);
+		memcpy(dst + i * 4, &gray, sizeof(gray));
+	}
+}
\ No newline at end of file
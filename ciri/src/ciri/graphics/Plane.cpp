@@ -2,6 +2,10 @@
 
 using namespace ciri;
 
+Plane::Plane()
+	: _normal(0.0f, 0.0f, 0.0f), _d(0.0f) {
+}
+
 Plane::Plane( const cc::Vec4f& val )
 	: Plane(cc::Vec3f(val.x, val.y, val.z), val.w) {
 }
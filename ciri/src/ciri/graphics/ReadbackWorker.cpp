@@ -0,0 +1,98 @@
+#include <ciri/graphics/ReadbackWorker.hpp>
+
+using namespace ciri;
+
+ReadbackJob::ReadbackJob()
+	: source(PixelConversion::RGBA8), shift(0), width(0), height(0), rowPitch(0), flip(false) {
+}
+
+ReadbackWorker::ReadbackWorker()
+	: _stopping(false) {
+}
+
+ReadbackWorker::~ReadbackWorker() {
+	stop();
+}
+
+void ReadbackWorker::submit( ReadbackJob&& job ) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.push_back(std::move(job));
+	}
+
+	if( !_thread.joinable() ) {
+		_stopping = false;
+		_thread = std::thread(&ReadbackWorker::run, this);
+	}
+	_condition.notify_one();
+}
+
+void ReadbackWorker::stop() {
+	if( !_thread.joinable() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_condition.notify_one();
+	_thread.join();
+}
+
+std::future<TextureReadback> ReadbackWorker::makeFailed( ErrorCode error ) {
+	ReadbackJob job;
+	std::future<TextureReadback> future = job.promise.get_future();
+	fail(job, error);
+	return future;
+}
+
+void ReadbackWorker::fail( ReadbackJob& job, ErrorCode error ) {
+	TextureReadback result;
+	result.error = error;
+	result.width = job.width;
+	result.height = job.height;
+	job.promise.set_value(std::move(result));
+}
+
+void ReadbackWorker::run() {
+	while( true ) {
+		ReadbackJob job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this]{ return _stopping || !_jobs.empty(); });
+			// finish what was queued before stopping so no future is left unresolved
+			if( _jobs.empty() ) {
+				return;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		convert(job);
+	}
+}
+
+void ReadbackWorker::convert( ReadbackJob& job ) {
+	const int srcRowBytes = job.width * PixelConversion::bytesPerTexel(job.source);
+	if( job.width <= 0 || job.height <= 0 || job.rowPitch < srcRowBytes || job.data.size() < static_cast<size_t>(job.rowPitch) * job.height ) {
+		fail(job, ErrorCode::CIRI_INVALID_ARGUMENT);
+		return;
+	}
+
+	TextureReadback result;
+	result.error = ErrorCode::CIRI_OK;
+	result.width = job.width;
+	result.height = job.height;
+	result.pixels.resize(static_cast<size_t>(job.width) * job.height * 4);
+
+	const int dstRowBytes = job.width * 4;
+	for( int row = 0; row < job.height; ++row ) {
+		const int srcRow = job.flip ? (job.height - 1 - row) : row;
+		PixelConversion::toRGBA8(job.source, job.shift, job.data.data() + static_cast<size_t>(srcRow) * job.rowPitch, result.pixels.data() + static_cast<size_t>(row) * dstRowBytes, job.width);
+	}
+
+	// the staging copy is no longer needed; free it before handing over the result
+	job.data.clear();
+	job.data.shrink_to_fit();
+	job.promise.set_value(std::move(result));
+}
\ No newline at end of file
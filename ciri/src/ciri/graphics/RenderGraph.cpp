@@ -0,0 +1,450 @@
+#include <ciri/graphics/RenderGraph.hpp>
+#include <ciri/graphics/IGraphicsDevice.hpp>
+
+using namespace ciri;
+
+RenderGraphTargetDesc::RenderGraphTargetDesc()
+	: width(0), height(0), format(TextureFormat::RGBA32_UINT), depthFormat(DepthStencilFormat::None) {
+}
+
+RenderGraphTargetDesc::RenderGraphTargetDesc( int targetWidth, int targetHeight, TextureFormat::Format targetFormat, DepthStencilFormat targetDepthFormat )
+	: width(targetWidth), height(targetHeight), format(targetFormat), depthFormat(targetDepthFormat) {
+}
+
+bool RenderGraphTargetDesc::operator==( const RenderGraphTargetDesc& rhs ) const {
+	return width == rhs.width && height == rhs.height && format == rhs.format && depthFormat == rhs.depthFormat;
+}
+
+bool RenderGraphTargetDesc::operator!=( const RenderGraphTargetDesc& rhs ) const {
+	return !(*this == rhs);
+}
+
+RenderGraph::RenderGraph()
+	: _compiled(false), _culledPasses(0), _targetSwitches(0) {
+}
+
+RenderGraph::~RenderGraph() {
+	destroy();
+}
+
+bool RenderGraph::create( const std::shared_ptr<IGraphicsDevice>& device ) {
+	if( nullptr == device ) {
+		return false;
+	}
+	_device = device;
+	return true;
+}
+
+void RenderGraph::destroy() {
+	reset();
+	_pool.clear();
+	_device = nullptr;
+}
+
+void RenderGraph::reset() {
+	_targets.clear();
+	_passes.clear();
+	_compiled = false;
+	_culledPasses = 0;
+}
+
+int RenderGraph::createTarget( const char* name, const RenderGraphTargetDesc& desc ) {
+	Target target;
+	target.name = (name != nullptr) ? name : "";
+	target.desc = desc;
+	target.imported = false;
+	target.readers = 0;
+	target.firstPass = -1;
+	target.lastPass = -1;
+	target.pooled = -1;
+	_targets.push_back(target);
+	_compiled = false;
+	return static_cast<int>(_targets.size()) - 1;
+}
+
+int RenderGraph::importTarget( const char* name, const std::shared_ptr<IRenderTarget2D>& target ) {
+	const int handle = createTarget(name, RenderGraphTargetDesc());
+	_targets[handle].imported = true;
+	_targets[handle].importedTarget = target;
+	return handle;
+}
+
+int RenderGraph::addPass( const char* name, const PassFunc& execute ) {
+	Pass pass;
+	pass.name = (name != nullptr) ? name : "";
+	pass.execute = execute;
+	pass.sideEffects = false;
+	pass.culled = false;
+	pass.references = 0;
+	_passes.push_back(pass);
+	_compiled = false;
+	return static_cast<int>(_passes.size()) - 1;
+}
+
+void RenderGraph::read( int pass, int target ) {
+	if( !isValidPass(pass) || !isValidTarget(target) ) {
+		return;
+	}
+	std::vector<int>& reads = _passes[pass].reads;
+	for( unsigned int i = 0; i < reads.size(); ++i ) {
+		if( reads[i] == target ) {
+			return;
+		}
+	}
+	reads.push_back(target);
+	_compiled = false;
+}
+
+void RenderGraph::write( int pass, int target ) {
+	if( !isValidPass(pass) || !isValidTarget(target) ) {
+		return;
+	}
+	std::vector<int>& writes = _passes[pass].writes;
+	for( unsigned int i = 0; i < writes.size(); ++i ) {
+		if( writes[i] == target ) {
+			return;
+		}
+	}
+	writes.push_back(target);
+	_compiled = false;
+}
+
+void RenderGraph::setSideEffects( int pass ) {
+	if( isValidPass(pass) ) {
+		_passes[pass].sideEffects = true;
+		_compiled = false;
+	}
+}
+
+ErrorCode RenderGraph::compile() {
+	_compiled = false;
+	if( nullptr == _device ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+
+	const ErrorCode status = validate();
+	if( failed(status) ) {
+		return status;
+	}
+	cull();
+	computeLifetimes();
+	const ErrorCode assigned = assignPooledTargets();
+	if( failed(assigned) ) {
+		return assigned;
+	}
+	_compiled = true;
+	return ErrorCode::CIRI_OK;
+}
+
+void RenderGraph::execute() {
+	_targetSwitches = 0;
+	if( !_compiled ) {
+		return;
+	}
+
+	// -1 until the first bind since whatever the caller left bound is unknown; 0 is the default render targets
+	IRenderTarget2D* bound[MAX_PASS_TARGETS];
+	int boundCount = -1;
+
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		const Pass& pass = _passes[i];
+		if( pass.culled ) {
+			continue;
+		}
+
+		if( !pass.writes.empty() ) {
+			IRenderTarget2D* next[MAX_PASS_TARGETS];
+			int nextCount = 0;
+			for( unsigned int w = 0; w < pass.writes.size(); ++w ) {
+				IRenderTarget2D* target = getTarget(pass.writes[w]).get();
+				if( target != nullptr ) {
+					next[nextCount] = target;
+					nextCount += 1;
+				}
+			}
+
+			bool same = (nextCount == boundCount);
+			for( int t = 0; same && t < nextCount; ++t ) {
+				same = (next[t] == bound[t]);
+			}
+			if( !same ) {
+				if( 0 == nextCount ) {
+					_device->restoreDefaultRenderTargets();
+				} else {
+					_device->setRenderTargets(next, nextCount);
+				}
+				for( int t = 0; t < nextCount; ++t ) {
+					bound[t] = next[t];
+				}
+				boundCount = nextCount;
+				_targetSwitches += 1;
+			}
+		}
+
+		if( pass.execute ) {
+			pass.execute(*this);
+		}
+	}
+}
+
+std::shared_ptr<IRenderTarget2D> RenderGraph::getTarget( int target ) const {
+	if( !isValidTarget(target) ) {
+		return nullptr;
+	}
+	const Target& entry = _targets[target];
+	if( entry.imported ) {
+		return entry.importedTarget;
+	}
+	return (entry.pooled != -1) ? _pool[entry.pooled].target : nullptr;
+}
+
+const char* RenderGraph::getPassName( int pass ) const {
+	return isValidPass(pass) ? _passes[pass].name.c_str() : "";
+}
+
+const char* RenderGraph::getTargetName( int target ) const {
+	return isValidTarget(target) ? _targets[target].name.c_str() : "";
+}
+
+int RenderGraph::getPassCount() const {
+	return static_cast<int>(_passes.size());
+}
+
+int RenderGraph::getCulledPassCount() const {
+	return _culledPasses;
+}
+
+int RenderGraph::getPooledTargetCount() const {
+	return static_cast<int>(_pool.size());
+}
+
+int RenderGraph::getTargetSwitchCount() const {
+	return _targetSwitches;
+}
+
+ErrorCode RenderGraph::validate() const {
+	std::vector<bool> written(_targets.size(), false);
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		const Pass& pass = _passes[i];
+
+		for( unsigned int r = 0; r < pass.reads.size(); ++r ) {
+			const Target& target = _targets[pass.reads[r]];
+			if( !target.imported && !written[pass.reads[r]] ) {
+				return ErrorCode::CIRI_INVALID_ARGUMENT;
+			}
+			if( target.imported && nullptr == target.importedTarget ) {
+				return ErrorCode::CIRI_INVALID_ARGUMENT; // the default render targets cannot be sampled
+			}
+		}
+
+		if( static_cast<int>(pass.writes.size()) > MAX_PASS_TARGETS ) {
+			return ErrorCode::CIRI_INVALID_ARGUMENT;
+		}
+		int width = 0;
+		int height = 0;
+		for( unsigned int w = 0; w < pass.writes.size(); ++w ) {
+			const Target& target = _targets[pass.writes[w]];
+			if( target.imported && nullptr == target.importedTarget && pass.writes.size() > 1 ) {
+				return ErrorCode::CIRI_INVALID_ARGUMENT;
+			}
+			int targetWidth = 0;
+			int targetHeight = 0;
+			getTargetSize(pass.writes[w], &targetWidth, &targetHeight);
+			if( 0 == w ) {
+				width = targetWidth;
+				height = targetHeight;
+			} else if( targetWidth != width || targetHeight != height ) {
+				return ErrorCode::CIRI_INVALID_ARGUMENT;
+			}
+			if( !target.imported && (target.desc.width <= 0 || target.desc.height <= 0) ) {
+				return ErrorCode::CIRI_INVALID_ARGUMENT;
+			}
+		}
+		for( unsigned int w = 0; w < pass.writes.size(); ++w ) {
+			written[pass.writes[w]] = true;
+		}
+	}
+	return ErrorCode::CIRI_OK;
+}
+
+void RenderGraph::cull() {
+	for( unsigned int i = 0; i < _targets.size(); ++i ) {
+		_targets[i].readers = 0;
+	}
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		Pass& pass = _passes[i];
+		pass.culled = false;
+		pass.references = static_cast<int>(pass.writes.size());
+		for( unsigned int r = 0; r < pass.reads.size(); ++r ) {
+			_targets[pass.reads[r]].readers += 1;
+		}
+	}
+
+	// passes that write nothing only stay for their side effects
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		Pass& pass = _passes[i];
+		if( pass.writes.empty() && !pass.sideEffects ) {
+			pass.culled = true;
+			for( unsigned int r = 0; r < pass.reads.size(); ++r ) {
+				_targets[pass.reads[r]].readers -= 1;
+			}
+		}
+	}
+
+	// targets nobody reads release their writers; a writer with nothing left to feed is culled and releases what it reads in turn.
+	// imported targets are read outside of the graph, so they never start this
+	std::vector<int> unread;
+	for( unsigned int i = 0; i < _targets.size(); ++i ) {
+		if( !_targets[i].imported && 0 == _targets[i].readers ) {
+			unread.push_back(static_cast<int>(i));
+		}
+	}
+	while( !unread.empty() ) {
+		const int target = unread.back();
+		unread.pop_back();
+
+		for( unsigned int i = 0; i < _passes.size(); ++i ) {
+			Pass& pass = _passes[i];
+			if( pass.culled ) {
+				continue;
+			}
+			bool writesTarget = false;
+			for( unsigned int w = 0; !writesTarget && w < pass.writes.size(); ++w ) {
+				writesTarget = (pass.writes[w] == target);
+			}
+			if( !writesTarget ) {
+				continue;
+			}
+
+			pass.references -= 1;
+			if( pass.references > 0 || pass.sideEffects ) {
+				continue;
+			}
+			pass.culled = true;
+			for( unsigned int r = 0; r < pass.reads.size(); ++r ) {
+				Target& read = _targets[pass.reads[r]];
+				read.readers -= 1;
+				if( 0 == read.readers && !read.imported ) {
+					unread.push_back(pass.reads[r]);
+				}
+			}
+		}
+	}
+
+	_culledPasses = 0;
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		if( _passes[i].culled ) {
+			_culledPasses += 1;
+		}
+	}
+}
+
+void RenderGraph::computeLifetimes() {
+	for( unsigned int i = 0; i < _targets.size(); ++i ) {
+		_targets[i].firstPass = -1;
+		_targets[i].lastPass = -1;
+		_targets[i].pooled = -1;
+	}
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		const Pass& pass = _passes[i];
+		if( pass.culled ) {
+			continue;
+		}
+		for( int list = 0; list < 2; ++list ) {
+			const std::vector<int>& targets = (0 == list) ? pass.reads : pass.writes;
+			for( unsigned int t = 0; t < targets.size(); ++t ) {
+				Target& target = _targets[targets[t]];
+				if( -1 == target.firstPass ) {
+					target.firstPass = static_cast<int>(i);
+				}
+				target.lastPass = static_cast<int>(i);
+			}
+		}
+	}
+}
+
+ErrorCode RenderGraph::assignPooledTargets() {
+	// release what has sat unused for long enough; nothing refers to pool indices between compiles
+	for( unsigned int i = 0; i < _pool.size(); ) {
+		if( _pool[i].unusedFrames >= RELEASE_AFTER_FRAMES ) {
+			_pool.erase(_pool.begin() + i);
+		} else {
+			_pool[i].unusedFrames += 1;
+			_pool[i].inUse = false;
+			++i;
+		}
+	}
+
+	// walk the passes in order, taking targets at their first use and returning them after their last, so only overlapping lifetimes need separate memory
+	for( unsigned int i = 0; i < _passes.size(); ++i ) {
+		if( _passes[i].culled ) {
+			continue;
+		}
+		const int passIndex = static_cast<int>(i);
+		for( unsigned int t = 0; t < _targets.size(); ++t ) {
+			Target& target = _targets[t];
+			if( target.imported || target.firstPass != passIndex ) {
+				continue;
+			}
+			target.pooled = acquirePooledTarget(target.desc);
+			if( -1 == target.pooled ) {
+				return ErrorCode::CIRI_UNKNOWN_ERROR;
+			}
+		}
+		for( unsigned int t = 0; t < _targets.size(); ++t ) {
+			const Target& target = _targets[t];
+			if( !target.imported && target.lastPass == passIndex && target.pooled != -1 ) {
+				_pool[target.pooled].inUse = false;
+			}
+		}
+	}
+	return ErrorCode::CIRI_OK;
+}
+
+int RenderGraph::acquirePooledTarget( const RenderGraphTargetDesc& desc ) {
+	for( unsigned int i = 0; i < _pool.size(); ++i ) {
+		PooledTarget& pooled = _pool[i];
+		if( !pooled.inUse && pooled.desc == desc ) {
+			pooled.inUse = true;
+			pooled.unusedFrames = 0;
+			return static_cast<int>(i);
+		}
+	}
+
+	PooledTarget pooled;
+	pooled.desc = desc;
+	pooled.target = _device->createRenderTarget2D(desc.width, desc.height, desc.format, desc.depthFormat);
+	if( nullptr == pooled.target ) {
+		return -1;
+	}
+	pooled.unusedFrames = 0;
+	pooled.inUse = true;
+	_pool.push_back(pooled);
+	return static_cast<int>(_pool.size()) - 1;
+}
+
+void RenderGraph::getTargetSize( int target, int* outWidth, int* outHeight ) const {
+	const Target& entry = _targets[target];
+	if( !entry.imported ) {
+		*outWidth = entry.desc.width;
+		*outHeight = entry.desc.height;
+	} else if( entry.importedTarget != nullptr && entry.importedTarget->getTexture() != nullptr ) {
+		*outWidth = entry.importedTarget->getTexture()->getWidth();
+		*outHeight = entry.importedTarget->getTexture()->getHeight();
+	} else if( entry.importedTarget != nullptr && entry.importedTarget->getDepth() != nullptr ) {
+		// depth-only
+		*outWidth = entry.importedTarget->getDepth()->getWidth();
+		*outHeight = entry.importedTarget->getDepth()->getHeight();
+	} else {
+		*outWidth = 0;
+		*outHeight = 0;
+	}
+}
+
+bool RenderGraph::isValidPass( int pass ) const {
+	return pass >= 0 && pass < static_cast<int>(_passes.size());
+}
+
+bool RenderGraph::isValidTarget( int target ) const {
+	return target >= 0 && target < static_cast<int>(_targets.size());
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <ciri/graphics/ShaderCache.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+	#include <direct.h>
+#else
+	#include <sys/stat.h>
+#endif
+
+using namespace ciri;
+
+namespace {
+	const char ENTRY_MAGIC[4] = {'C', 'S', 'H', 'C'};
+	const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+	const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+	struct EntryHeader {
+		char magic[4];
+		unsigned int version;
+		unsigned long long key;
+		unsigned long long size;
+		unsigned long long checksum;
+	};
+
+	unsigned long long fnv1a( unsigned long long hash, const void* data, size_t size ) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for( size_t i = 0; i < size; ++i ) {
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+	unsigned long long hashString( unsigned long long hash, const char* str ) {
+		// the length goes in first so that moving text between stages changes the key
+		const unsigned long long length = (str != nullptr) ? strlen(str) : ~0ULL;
+		hash = fnv1a(hash, &length, sizeof(length));
+		return (str != nullptr) ? fnv1a(hash, str, static_cast<size_t>(length)) : hash;
+	}
+
+	bool makeDirectory( const char* directory ) {
+	#ifdef _WIN32
+		const int result = _mkdir(directory);
+	#else
+		const int result = mkdir(directory, 0755);
+	#endif
+		// already being there is fine
+		return (0 == result) || (EEXIST == errno);
+	}
+}
+
+ShaderCache::ShaderCache() {
+}
+
+ShaderCache::~ShaderCache() {
+}
+
+bool ShaderCache::setDirectory( const char* directory ) {
+	_directory.clear();
+	if( nullptr == directory || '\0' == directory[0] ) {
+		return false;
+	}
+	if( !makeDirectory(directory) ) {
+		return false;
+	}
+	_directory = directory;
+	return true;
+}
+
+const std::string& ShaderCache::getDirectory() const {
+	return _directory;
+}
+
+bool ShaderCache::isEnabled() const {
+	return !_directory.empty();
+}
+
+void ShaderCache::setDriver( const std::string& driver ) {
+	_driver = driver;
+}
+
+unsigned long long ShaderCache::makeKey( const char* vs, const char* gs, const char* ps, unsigned int flags ) const {
+	const unsigned int version = VERSION;
+	unsigned long long hash = FNV_OFFSET;
+	hash = fnv1a(hash, &version, sizeof(version));
+	hash = fnv1a(hash, &flags, sizeof(flags));
+	hash = hashString(hash, _driver.c_str());
+	hash = hashString(hash, vs);
+	hash = hashString(hash, gs);
+	hash = hashString(hash, ps);
+	return hash;
+}
+
+bool ShaderCache::load( unsigned long long key, std::vector<char>& outData ) const {
+	if( !isEnabled() ) {
+		return false;
+	}
+
+	std::ifstream stream(getPath(key).c_str(), std::ios::binary);
+	if( !stream.is_open() ) {
+		return false;
+	}
+
+	EntryHeader header;
+	stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if( !stream.good() || memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0 || header.version != VERSION || header.key != key || 0 == header.size ) {
+		return false;
+	}
+
+	outData.resize(static_cast<size_t>(header.size));
+	stream.read(outData.data(), static_cast<std::streamsize>(header.size));
+	if( !stream.good() || fnv1a(FNV_OFFSET, outData.data(), outData.size()) != header.checksum ) {
+		outData.clear();
+		return false;
+	}
+	return true;
+}
+
+bool ShaderCache::store( unsigned long long key, const void* data, size_t size ) const {
+	if( !isEnabled() || nullptr == data || 0 == size ) {
+		return false;
+	}
+
+	EntryHeader header;
+	memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+	header.version = VERSION;
+	header.key = key;
+	header.size = size;
+	header.checksum = fnv1a(FNV_OFFSET, data, size);
+
+	const std::string path = getPath(key);
+	std::ofstream stream(path.c_str(), std::ios::binary | std::ios::trunc);
+	if( !stream.is_open() ) {
+		return false;
+	}
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	if( !stream.good() ) {
+		// a partial entry would fail its checksum anyway, but there is no reason to leave it around
+		stream.close();
+		std::remove(path.c_str());
+		return false;
+	}
+	return true;
+}
+
+void ShaderCache::remove( unsigned long long key ) const {
+	if( isEnabled() ) {
+		std::remove(getPath(key).c_str());
+	}
+}
+
+std::string ShaderCache::getPath( unsigned long long key ) const {
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.bin", key);
+	return _directory + name;
+}
\ No newline at end of file
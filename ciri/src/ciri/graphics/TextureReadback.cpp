@@ -0,0 +1,27 @@
+#include <ciri/graphics/TextureReadback.hpp>
+#include <ciri/core/TGA.hpp>
+
+using namespace ciri;
+
+TextureReadback::TextureReadback()
+	: error(ErrorCode::CIRI_UNKNOWN_ERROR), width(0), height(0) {
+}
+
+ErrorCode TextureReadback::writeToTGA( const char* file ) const {
+	if( nullptr == file ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+	if( failed(error) ) {
+		return error;
+	}
+	if( static_cast<int>(pixels.size()) != width * height * 4 ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	// the writer swaps red and blue in place, so give it a copy
+	std::vector<unsigned char> bgra(pixels);
+	if( !TGA::writeToFile(file, width, height, bgra.data(), TGA::RGBA, true) ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+	return ErrorCode::CIRI_OK;
+}
\ No newline at end of file
@@ -3,21 +3,55 @@
 using namespace ciri;
 
 VertexDeclaration::VertexDeclaration()
-	: _stride(0) {
+	: _streamCount(0), _hash(0) {
+	for( int i = 0; i < MAX_STREAMS; ++i ) {
+		_strides[i] = 0;
+	}
 }
 
 VertexDeclaration::~VertexDeclaration() {
 }
 
 void VertexDeclaration::add( const VertexElement& element ) {
-	_stride += element.getSize();
+	const int slot = element.getSlot();
+	if( slot < 0 || slot >= MAX_STREAMS ) {
+		return;
+	}
+
+	// elements are packed in the order they are added within their own stream
+	_offsets.push_back(_strides[slot]);
+	_strides[slot] += element.getSize();
+	if( slot >= _streamCount ) {
+		_streamCount = slot + 1;
+	}
 	_elements.push_back(element);
+
+	// fold the element into the running hash so lookups never walk the elements
+	const size_t key = (static_cast<size_t>(element.getFormat()) << 16) ^ (static_cast<size_t>(element.getUsage()) << 8) ^ static_cast<size_t>(element.getUsageIndex()) ^
+	                   (static_cast<size_t>(slot) << 24) ^ (static_cast<size_t>(element.getInstanceStepRate()) << 28);
+	_hash ^= key + 0x9e3779b9 + (_hash << 6) + (_hash >> 2);
 }
 
 int VertexDeclaration::getStride() const {
-	return _stride;
+	return _strides[0];
+}
+
+int VertexDeclaration::getStride( int slot ) const {
+	return (slot >= 0 && slot < MAX_STREAMS) ? _strides[slot] : 0;
+}
+
+int VertexDeclaration::getOffset( int index ) const {
+	return (index >= 0 && index < static_cast<int>(_offsets.size())) ? _offsets[index] : 0;
+}
+
+int VertexDeclaration::getStreamCount() const {
+	return _streamCount;
 }
 
 const std::vector<VertexElement>& VertexDeclaration::getElements() const {
 	return _elements;
+}
+
+size_t VertexDeclaration::getHash() const {
+	return _hash;
 }
\ No newline at end of file
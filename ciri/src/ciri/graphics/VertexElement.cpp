@@ -3,11 +3,15 @@
 using namespace ciri;
 
 VertexElement::VertexElement()
-	: _format(VertexFormat::Float3), _usage(VertexUsage::Position), _usageIndex(0) {
+	: _format(VertexFormat::Float3), _usage(VertexUsage::Position), _usageIndex(0), _slot(0), _instanceStepRate(0) {
 }
 
 VertexElement::VertexElement( VertexFormat format, VertexUsage usage, int usageIndex )
-	: _format(format), _usage(usage), _usageIndex(usageIndex) {
+	: _format(format), _usage(usage), _usageIndex(usageIndex), _slot(0), _instanceStepRate(0) {
+}
+
+VertexElement::VertexElement( VertexFormat format, VertexUsage usage, int usageIndex, int slot, int instanceStepRate )
+	: _format(format), _usage(usage), _usageIndex(usageIndex), _slot(slot), _instanceStepRate(instanceStepRate) {
 }
 
 VertexElement::~VertexElement() {
@@ -25,6 +29,14 @@ int VertexElement::getUsageIndex() const {
 	return _usageIndex;
 }
 
+int VertexElement::getSlot() const {
+	return _slot;
+}
+
+int VertexElement::getInstanceStepRate() const {
+	return _instanceStepRate;
+}
+
 int VertexElement::getSize() const {
 	switch( _format ) {
 		case VertexFormat::Float: {
@@ -43,6 +55,21 @@ int VertexElement::getSize() const {
 			return sizeof(float) * 4;
 		}
 
+		case VertexFormat::Half2:
+		case VertexFormat::SNorm16x2: {
+			return sizeof(short) * 2;
+		}
+
+		case VertexFormat::Half4:
+		case VertexFormat::SNorm16x4: {
+			return sizeof(short) * 4;
+		}
+
+		case VertexFormat::UNorm8x4:
+		case VertexFormat::UNorm10_10_10_2: {
+			return sizeof(unsigned int);
+		}
+
 		default: {
 			throw; // forgot to implement
 		}
@@ -63,10 +90,19 @@ int VertexElement::getMultiplicity() const {
 			return 3;
 		}
 
-		case VertexFormat::Float4: {
+		case VertexFormat::Float4:
+		case VertexFormat::Half4:
+		case VertexFormat::UNorm8x4:
+		case VertexFormat::SNorm16x4:
+		case VertexFormat::UNorm10_10_10_2: {
 			return 4;
 		}
 
+		case VertexFormat::Half2:
+		case VertexFormat::SNorm16x2: {
+			return 2;
+		}
+
 		default: {
 			throw; // forgot to implement
 		}
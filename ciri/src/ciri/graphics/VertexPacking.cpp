@@ -0,0 +1,167 @@
+#include <ciri/graphics/VertexPacking.hpp>
+#include <emmintrin.h>
+#include <cstring>
+#include <cmath>
+
+using namespace ciri;
+
+namespace {
+	// float bit patterns used by the half conversion (round to nearest even, see F. Giesen's float_to_half_fast3_rtne)
+	const unsigned int HALF_MAX_AS_FLOAT   = (127 + 16) << 23;                    // >= this rounds to infinity
+	const unsigned int HALF_MIN_NORMAL     = (127 - 14) << 23;                    // < this becomes a half subnormal
+	const unsigned int HALF_SUBNORM_MAGIC  = ((127 - 15) + (23 - 10) + 1) << 23;  // adding this float rounds the mantissa into place
+	const unsigned int HALF_NORMAL_BIAS    = 0xfff - ((127 - 15) << 23);          // rebias exponent and add rounding
+
+	unsigned int floatBits( float value ) {
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float bitsFloat( unsigned int bits ) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	float clampf( float value, float lo, float hi ) {
+		return (value < lo) ? lo : ((value > hi) ? hi : value);
+	}
+
+	float signNotZero( float value ) {
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+
+	// four floats to four halves in the low 16 bits of each lane (sign extended so they survive a signed pack)
+	__m128i floatToHalf4( const __m128& f ) {
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+		const __m128 justSign = _mm_and_ps(signMask, f);
+		const __m128 absF = _mm_xor_ps(f, justSign);
+		const __m128i absBits = _mm_castps_si128(absF);
+
+		const __m128 isNan = _mm_cmpunord_ps(absF, absF);
+		const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32(HALF_MAX_AS_FLOAT), absBits);
+		const __m128i infOrNan = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNan), _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+		// subnormal results
+		const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32(HALF_MIN_NORMAL), absBits);
+		const __m128i subnormalMagic = _mm_set1_epi32(HALF_SUBNORM_MAGIC);
+		const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+		// normal results; bias towards rounding up when the half mantissa would be odd
+		const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+		const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, _mm_set1_epi32(HALF_NORMAL_BIAS)), mantissaOdd), 13);
+
+		const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+		const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+		return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+	}
+}
+
+unsigned short VertexPacking::floatToHalf( float value ) {
+	unsigned int bits = floatBits(value);
+	const unsigned int sign = bits & 0x80000000;
+	bits ^= sign;
+
+	unsigned int half = 0;
+	if( bits >= HALF_MAX_AS_FLOAT ) {
+		half = (bits > 0x7f800000) ? 0x7e00 : 0x7c00; // nan stays nan; everything else is infinity
+	} else if( bits < HALF_MIN_NORMAL ) {
+		half = floatBits(bitsFloat(bits) + bitsFloat(HALF_SUBNORM_MAGIC)) - HALF_SUBNORM_MAGIC;
+	} else {
+		const unsigned int mantissaOdd = (bits >> 13) & 1;
+		half = (bits + HALF_NORMAL_BIAS + mantissaOdd) >> 13;
+	}
+	return static_cast<unsigned short>(half | (sign >> 16));
+}
+
+float VertexPacking::halfToFloat( unsigned short value ) {
+	const unsigned int sign = (value & 0x8000) << 16;
+	const unsigned int exponent = (value >> 10) & 0x1f;
+	const unsigned int mantissa = value & 0x3ff;
+
+	if( 0 == exponent ) {
+		// zero or subnormal: mantissa * 2^-24
+		const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		return (sign != 0) ? -magnitude : magnitude;
+	}
+	if( 0x1f == exponent ) {
+		return bitsFloat(sign | 0x7f800000 | (mantissa << 13));
+	}
+	return bitsFloat(sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13));
+}
+
+void VertexPacking::floatToHalf( const float* src, unsigned short* dst, int count ) {
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m128i lo = floatToHalf4(_mm_loadu_ps(src + i));
+		const __m128i hi = floatToHalf4(_mm_loadu_ps(src + i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	for( ; i < count; ++i ) {
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+void VertexPacking::floatToSNorm16( const float* src, short* dst, int count ) {
+	const __m128 lo = _mm_set1_ps(-1.0f);
+	const __m128 hi = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		// cvtps rounds to nearest under the default rounding mode
+		const __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale));
+		const __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+	}
+	for( ; i < count; ++i ) {
+		dst[i] = static_cast<short>(lrintf(clampf(src[i], -1.0f, 1.0f) * 32767.0f));
+	}
+}
+
+float VertexPacking::snorm16ToFloat( short value ) {
+	const float f = static_cast<float>(value) / 32767.0f;
+	return (f < -1.0f) ? -1.0f : f;
+}
+
+unsigned int VertexPacking::packUNorm8x4( const cc::Vec4f& value ) {
+	const unsigned int x = static_cast<unsigned int>(clampf(value.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const unsigned int y = static_cast<unsigned int>(clampf(value.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const unsigned int z = static_cast<unsigned int>(clampf(value.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+	const unsigned int w = static_cast<unsigned int>(clampf(value.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+	return x | (y << 8) | (z << 16) | (w << 24);
+}
+
+unsigned int VertexPacking::packUNorm1010102( const cc::Vec4f& value ) {
+	const unsigned int x = static_cast<unsigned int>(clampf(value.x, 0.0f, 1.0f) * 1023.0f + 0.5f);
+	const unsigned int y = static_cast<unsigned int>(clampf(value.y, 0.0f, 1.0f) * 1023.0f + 0.5f);
+	const unsigned int z = static_cast<unsigned int>(clampf(value.z, 0.0f, 1.0f) * 1023.0f + 0.5f);
+	const unsigned int w = static_cast<unsigned int>(clampf(value.w, 0.0f, 1.0f) * 3.0f + 0.5f);
+	return x | (y << 10) | (z << 20) | (w << 30);
+}
+
+cc::Vec2f VertexPacking::encodeOctahedral( const cc::Vec3f& normal ) {
+	const float l1 = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if( l1 <= 0.0f ) {
+		return cc::Vec2f(0.0f, 0.0f);
+	}
+	cc::Vec2f p(normal.x / l1, normal.y / l1);
+	if( normal.z < 0.0f ) {
+		// fold the lower hemisphere over the diagonals
+		const float x = (1.0f - fabsf(p.y)) * signNotZero(p.x);
+		const float y = (1.0f - fabsf(p.x)) * signNotZero(p.y);
+		p = cc::Vec2f(x, y);
+	}
+	return p;
+}
+
+cc::Vec3f VertexPacking::decodeOctahedral( const cc::Vec2f& encoded ) {
+	cc::Vec3f n(encoded.x, encoded.y, 1.0f - fabsf(encoded.x) - fabsf(encoded.y));
+	if( n.z < 0.0f ) {
+		const float x = (1.0f - fabsf(encoded.y)) * signNotZero(encoded.x);
+		const float y = (1.0f - fabsf(encoded.x)) * signNotZero(encoded.y);
+		n.x = x;
+		n.y = y;
+	}
+	return n.normalized();
+}
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include <ciri/graphics/null/GraphicsCommandStream.hpp>
+#include <ciri/graphics/ShaderStage.hpp>
+#include <fstream>
+#include <cstring>
+
+using namespace ciri;
+
+namespace {
+	const char STREAM_MAGIC[4] = {'C', 'G', 'C', 'S'};
+	const int STREAM_VERSION = 1;
+}
+
+GraphicsCommand::GraphicsCommand()
+	: type(GraphicsCommandType::Present) {
+	args[0] = args[1] = args[2] = args[3] = 0;
+}
+
+GraphicsCommand::GraphicsCommand( GraphicsCommandType commandType, int a0, int a1, int a2, int a3 )
+	: type(commandType) {
+	args[0] = a0;
+	args[1] = a1;
+	args[2] = a2;
+	args[3] = a3;
+}
+
+bool GraphicsCommand::operator==( const GraphicsCommand& rhs ) const {
+	return type == rhs.type && args[0] == rhs.args[0] && args[1] == rhs.args[1] && args[2] == rhs.args[2] && args[3] == rhs.args[3];
+}
+
+bool GraphicsCommand::operator!=( const GraphicsCommand& rhs ) const {
+	return !(*this == rhs);
+}
+
+GraphicsCounters::GraphicsCounters()
+	: frames(0), drawCalls(0), verticesSubmitted(0), stateChanges(0), redundantBinds(0), renderTargetChanges(0), clears(0),
+		vertexBytesUploaded(0), indexBytesUploaded(0), constantBytesUploaded(0), constantUpdates(0), constantRangeBinds(0), constantRingBytes(0),
+		textureBytesUploaded(0), readbacks(0), readbackBytes(0), renderTargetBytes(0), peakRenderTargetBytes(0) {
+}
+
+GraphicsCommandStream::GraphicsCommandStream() {
+	clear();
+}
+
+GraphicsCommandStream::~GraphicsCommandStream() {
+}
+
+void GraphicsCommandStream::record( const GraphicsCommand& command ) {
+	_commands.push_back(command);
+
+	const int* args = command.args;
+	switch( command.type ) {
+		case GraphicsCommandType::ApplyShader: {
+			bind(_shader, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetVertexBuffer: {
+			bind(_vertexBuffer, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetIndexBuffer: {
+			bind(_indexBuffer, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetTexture2D:
+		case GraphicsCommandType::SetTexture3D:
+		case GraphicsCommandType::SetTextureCube: {
+			if( args[0] >= 0 && args[0] < MAX_SLOTS ) {
+				bind(_textures[stageIndex(args[2])][args[0]], args[1]);
+			} else {
+				_counters.stateChanges += 1;
+			}
+			break;
+		}
+		case GraphicsCommandType::SetSamplerState: {
+			if( args[0] >= 0 && args[0] < MAX_SLOTS ) {
+				bind(_samplers[stageIndex(args[2])][args[0]], args[1]);
+			} else {
+				_counters.stateChanges += 1;
+			}
+			break;
+		}
+		case GraphicsCommandType::SetBlendState: {
+			bind(_blendState, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetRasterizerState: {
+			bind(_rasterizerState, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetDepthStencilState: {
+			bind(_depthStencilState, args[0]);
+			break;
+		}
+		case GraphicsCommandType::SetRenderTargets:
+		case GraphicsCommandType::RestoreRenderTargets: {
+			_counters.renderTargetChanges += 1;
+			break;
+		}
+		case GraphicsCommandType::Clear: {
+			_counters.clears += 1;
+			break;
+		}
+		case GraphicsCommandType::DrawArrays:
+		case GraphicsCommandType::DrawIndexed: {
+			_counters.drawCalls += 1;
+			_counters.verticesSubmitted += args[1];
+			break;
+		}
+		case GraphicsCommandType::SetVertexStream: {
+			if( args[0] > 0 && args[0] < MAX_STREAMS ) {
+				bind(_vertexStreams[args[0]], args[1]);
+			} else {
+				_counters.stateChanges += 1;
+			}
+			break;
+		}
+		case GraphicsCommandType::DrawInstanced:
+		case GraphicsCommandType::DrawIndexedInstanced: {
+			_counters.drawCalls += 1;
+			_counters.verticesSubmitted += static_cast<long long>(args[1]) * args[2];
+			break;
+		}
+		case GraphicsCommandType::UploadVertexBuffer: {
+			_counters.vertexBytesUploaded += args[1];
+			break;
+		}
+		case GraphicsCommandType::UploadIndexBuffer: {
+			_counters.indexBytesUploaded += args[1];
+			break;
+		}
+		case GraphicsCommandType::UploadConstantBuffer: {
+			_counters.constantBytesUploaded += args[1];
+			_counters.constantUpdates += 1;
+			break;
+		}
+		case GraphicsCommandType::BindConstantRange: {
+			_counters.constantBytesUploaded += args[2];
+			_counters.constantRangeBinds += 1;
+			_counters.constantRingBytes += args[3];
+			break;
+		}
+		case GraphicsCommandType::UploadTexture: {
+			_counters.textureBytesUploaded += args[1];
+			break;
+		}
+		case GraphicsCommandType::ReadTexture: {
+			_counters.readbacks += 1;
+			_counters.readbackBytes += args[1];
+			break;
+		}
+		case GraphicsCommandType::Present: {
+			_counters.frames += 1;
+			break;
+		}
+		case GraphicsCommandType::AllocateRenderTarget: {
+			// a resize replaces the old size
+			long long& bytes = _renderTargetBytes[args[0]];
+			_counters.renderTargetBytes += args[1] - bytes;
+			bytes = args[1];
+			if( _counters.renderTargetBytes > _counters.peakRenderTargetBytes ) {
+				_counters.peakRenderTargetBytes = _counters.renderTargetBytes;
+			}
+			break;
+		}
+		case GraphicsCommandType::ReleaseRenderTarget: {
+			const auto it = _renderTargetBytes.find(args[0]);
+			if( it != _renderTargetBytes.end() ) {
+				_counters.renderTargetBytes -= it->second;
+				_renderTargetBytes.erase(it);
+			}
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
+
+void GraphicsCommandStream::clear() {
+	_commands.clear();
+	_counters = GraphicsCounters();
+	_renderTargetBytes.clear();
+	_shader = _vertexBuffer = _indexBuffer = 0;
+	_blendState = _rasterizerState = _depthStencilState = 0;
+	for( int slot = 0; slot < MAX_STREAMS; ++slot ) {
+		_vertexStreams[slot] = 0;
+	}
+	for( int stage = 0; stage < STAGE_COUNT; ++stage ) {
+		for( int slot = 0; slot < MAX_SLOTS; ++slot ) {
+			_textures[stage][slot] = 0;
+			_samplers[stage][slot] = 0;
+		}
+	}
+}
+
+const std::vector<GraphicsCommand>& GraphicsCommandStream::getCommands() const {
+	return _commands;
+}
+
+const GraphicsCounters& GraphicsCommandStream::getCounters() const {
+	return _counters;
+}
+
+long long GraphicsCommandStream::getUploadedBytes( int resourceId ) const {
+	long long bytes = 0;
+	for( const auto& cmd : _commands ) {
+		switch( cmd.type ) {
+			case GraphicsCommandType::UploadVertexBuffer:
+			case GraphicsCommandType::UploadIndexBuffer:
+			case GraphicsCommandType::UploadConstantBuffer:
+			case GraphicsCommandType::UploadTexture: {
+				if( cmd.args[0] == resourceId ) {
+					bytes += cmd.args[1];
+				}
+				break;
+			}
+			case GraphicsCommandType::BindConstantRange: {
+				if( cmd.args[0] == resourceId ) {
+					bytes += cmd.args[2];
+				}
+				break;
+			}
+			default: {
+				break;
+			}
+		}
+	}
+	return bytes;
+}
+
+bool GraphicsCommandStream::save( const char* file ) const {
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	if( !stream.is_open() ) {
+		return false;
+	}
+	const int count = static_cast<int>(_commands.size());
+	stream.write(STREAM_MAGIC, sizeof(STREAM_MAGIC));
+	stream.write(reinterpret_cast<const char*>(&STREAM_VERSION), sizeof(STREAM_VERSION));
+	stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for( const auto& cmd : _commands ) {
+		const int type = static_cast<int>(cmd.type);
+		stream.write(reinterpret_cast<const char*>(&type), sizeof(type));
+		stream.write(reinterpret_cast<const char*>(cmd.args), sizeof(cmd.args));
+	}
+	return stream.good();
+}
+
+bool GraphicsCommandStream::load( const char* file ) {
+	std::ifstream stream(file, std::ios::binary);
+	if( !stream.is_open() ) {
+		return false;
+	}
+	char magic[sizeof(STREAM_MAGIC)];
+	int version = 0;
+	int count = 0;
+	stream.read(magic, sizeof(magic));
+	stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+	stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if( !stream.good() || memcmp(magic, STREAM_MAGIC, sizeof(magic)) != 0 || version != STREAM_VERSION || count < 0 ) {
+		return false;
+	}
+
+	clear();
+	_commands.reserve(count);
+	for( int i = 0; i < count; ++i ) {
+		int type = 0;
+		GraphicsCommand cmd;
+		stream.read(reinterpret_cast<char*>(&type), sizeof(type));
+		stream.read(reinterpret_cast<char*>(cmd.args), sizeof(cmd.args));
+		if( !stream.good() ) {
+			clear();
+			return false;
+		}
+		cmd.type = static_cast<GraphicsCommandType>(type);
+		record(cmd);
+	}
+	return true;
+}
+
+int GraphicsCommandStream::findFirstDifference( const GraphicsCommandStream& lhs, const GraphicsCommandStream& rhs ) {
+	const size_t common = (lhs._commands.size() < rhs._commands.size()) ? lhs._commands.size() : rhs._commands.size();
+	for( size_t i = 0; i < common; ++i ) {
+		if( lhs._commands[i] != rhs._commands[i] ) {
+			return static_cast<int>(i);
+		}
+	}
+	return (lhs._commands.size() == rhs._commands.size()) ? -1 : static_cast<int>(common);
+}
+
+bool GraphicsCommandStream::bind( int& bound, int id ) {
+	if( bound == id ) {
+		_counters.redundantBinds += 1;
+		return false;
+	}
+	bound = id;
+	_counters.stateChanges += 1;
+	return true;
+}
+
+int GraphicsCommandStream::stageIndex( int stage ) {
+	if( stage & ShaderStage::Vertex ) {
+		return 0;
+	}
+	if( stage & ShaderStage::Geometry ) {
+		return 1;
+	}
+	if( stage & ShaderStage::Pixel ) {
+		return 2;
+	}
+	return 3;
+}
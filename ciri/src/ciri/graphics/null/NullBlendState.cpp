@@ -0,0 +1,27 @@
+#include <ciri/graphics/null/NullBlendState.hpp>
+
+using namespace ciri;
+
+NullBlendState::NullBlendState( int id )
+	: IBlendState(), _id(id) {
+}
+
+NullBlendState::~NullBlendState() {
+	destroy();
+}
+
+bool NullBlendState::create( const BlendDesc& desc ) {
+	_desc = desc;
+	return true;
+}
+
+void NullBlendState::destroy() {
+}
+
+const BlendDesc& NullBlendState::getDesc() const {
+	return _desc;
+}
+
+int NullBlendState::getId() const {
+	return _id;
+}
@@ -0,0 +1,65 @@
+#include <ciri/graphics/null/NullConstantBuffer.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullConstantBuffer::NullConstantBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device )
+	: IConstantBuffer(), _device(device), _id(id), _size(0), _lastSize(0), _inRing(false), _ringFrame(0) {
+}
+
+NullConstantBuffer::~NullConstantBuffer() {
+	destroy();
+}
+
+ErrorCode NullConstantBuffer::setData( int dataSize, void* data ) {
+	if( dataSize <= 0 || nullptr == data ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	// the buffer is sized by the first upload; later uploads can't grow it
+	if( _size != 0 && dataSize > _size ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	if( 0 == _size ) {
+		_size = dataSize;
+	}
+	write(dataSize);
+	return ErrorCode::CIRI_OK;
+}
+
+void NullConstantBuffer::destroy() {
+	_size = 0;
+	_inRing = false;
+}
+
+void NullConstantBuffer::refresh() {
+	if( _inRing && _ringFrame != _device->getConstantRingFrame() ) {
+		write(_lastSize);
+	}
+}
+
+int NullConstantBuffer::getId() const {
+	return _id;
+}
+
+int NullConstantBuffer::getSize() const {
+	return _size;
+}
+
+
+void NullConstantBuffer::write( int dataSize ) {
+	_lastSize = dataSize;
+
+	// same policy as the real backends: the ring if it has room this frame, otherwise the buffer's own storage
+	int offset = 0;
+	int alignedSize = 0;
+	if( _device->allocateConstants(dataSize, &offset, &alignedSize) ) {
+		_inRing = true;
+		_ringFrame = _device->getConstantRingFrame();
+		_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::BindConstantRange, _id, offset, dataSize, alignedSize));
+		return;
+	}
+	_inRing = false;
+	_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadConstantBuffer, _id, dataSize));
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <ciri/graphics/null/NullDepthStencilState.hpp>
+
+using namespace ciri;
+
+NullDepthStencilState::NullDepthStencilState( int id )
+	: IDepthStencilState(), _id(id) {
+}
+
+NullDepthStencilState::~NullDepthStencilState() {
+	destroy();
+}
+
+bool NullDepthStencilState::create( const DepthStencilDesc& desc ) {
+	_desc = desc;
+	return true;
+}
+
+void NullDepthStencilState::destroy() {
+}
+
+const DepthStencilDesc& NullDepthStencilState::getDesc() const {
+	return _desc;
+}
+
+int NullDepthStencilState::getId() const {
+	return _id;
+}
@@ -0,0 +1,1127 @@
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+#include <ciri/core/window/IWindow.hpp>
+#include <ciri/graphics/null/NullConstantBuffer.hpp>
+#include <ciri/graphics/null/NullTexture2D.hpp>
+#include <ciri/graphics/null/NullTexture3D.hpp>
+#include <ciri/graphics/null/NullTextureCube.hpp>
+#include <ciri/graphics/null/NullSamplerState.hpp>
+#include <ciri/graphics/null/NullRenderTarget2D.hpp>
+#include <ciri/graphics/null/NullRasterizerState.hpp>
+#include <ciri/graphics/null/NullDepthStencilState.hpp>
+#include <ciri/graphics/null/NullBlendState.hpp>
+#include <cstring>
+#include <algorithm>
+
+using namespace ciri;
+
+// textures are tracked per type, matching the gl backend's bind points
+static const int TEXTURE_TABLE_2D = 0;
+static const int TEXTURE_TABLE_3D = 1;
+static const int TEXTURE_TABLE_CUBE = 2;
+
+NullGraphicsDevice::NullGraphicsDevice()
+	: IGraphicsDevice(), _isValid(false), _window(nullptr), _defaultWidth(0), _defaultHeight(0), _shaderExt(".glsl"), _nextResourceId(1),
+		_constantRingSize(0), _constantRingHead(0), _constantRingFrame(0) {
+}
+
+NullGraphicsDevice::~NullGraphicsDevice() {
+	destroy();
+}
+
+bool NullGraphicsDevice::create( const std::shared_ptr<IWindow>& window ) {
+	if( _isValid || nullptr == window ) {
+		return false;
+	}
+
+	_window = window;
+	_defaultWidth = window->getWidth();
+	_defaultHeight = window->getHeight();
+	_isValid = true;
+	_stateCache.invalidate();
+
+	// apply a fullsize viewport
+	setViewport(Viewport(0, 0, _defaultWidth, _defaultHeight, 0.0f, 1.0f));
+
+	// set default states
+	restoreDefaultStates();
+
+	return true;
+}
+
+void NullGraphicsDevice::destroy() {
+	if( !_isValid ) {
+		return;
+	}
+
+	// clean default state pointers
+	_defaultBlendAdditive = nullptr;
+	_defaultBlendAlpha = nullptr;
+	_defaultBlendNonPremul = nullptr;
+	_defaultBlendOpaque = nullptr;
+	_defaultRasterNone = nullptr;
+	_defaultRasterClockwise = nullptr;
+	_defaultRasterCounterClockwise = nullptr;
+	_defaultDepthStencilDefault = nullptr;
+	_defaultDepthStencilDepthRead = nullptr;
+	_defaultDepthStencilNone = nullptr;
+	_pipelineCache.clear();
+
+	for( unsigned int i = 0; i < _pendingReadbacks.size(); ++i ) {
+		ReadbackWorker::fail(_pendingReadbacks[i], ErrorCode::CIRI_UNKNOWN_ERROR);
+	}
+	_pendingReadbacks.clear();
+	_readbackWorker.stop();
+	_gpuScopes.clear();
+	_openGpuScopes.clear();
+
+	_resources.clear();
+	_renderTargetIds.clear();
+	_isValid = false;
+}
+
+void NullGraphicsDevice::present() {
+	if( !_isValid ) {
+		return;
+	}
+	releaseRenderTargets();
+	record(GraphicsCommandType::Present);
+	_stateCache.endFrame();
+
+	// the next frame gets the next segment of the ring
+	_constantRingHead = 0;
+	_constantRingFrame += 1;
+
+	// readbacks issued last frame are considered copied
+	for( unsigned int i = 0; i < _pendingReadbacks.size(); ++i ) {
+		ReadbackJob& job = _pendingReadbacks[i];
+		job.data.assign(static_cast<size_t>(job.rowPitch) * job.height, 0);
+		_readbackWorker.submit(std::move(job));
+	}
+	_pendingReadbacks.clear();
+
+	// scopes still open are abandoned, as the gl and dx timers do
+	_openGpuScopes.clear();
+	_gpuScopes.erase(std::remove_if(_gpuScopes.begin(), _gpuScopes.end(), []( const ProfileEvent& scope ) { return 0 == scope.end; }), _gpuScopes.end());
+	if( !_gpuScopes.empty() ) {
+		Profiler::addGpuEvents(_gpuScopes.data(), static_cast<int>(_gpuScopes.size()));
+		_gpuScopes.clear();
+	}
+}
+
+void NullGraphicsDevice::setViewport( const Viewport& vp ) {
+	record(GraphicsCommandType::SetViewport, vp.x(), vp.y(), vp.width(), vp.height());
+	_activeViewport = vp;
+}
+
+const Viewport& NullGraphicsDevice::getViewport() const {
+	return _activeViewport;
+}
+
+std::shared_ptr<IShader> NullGraphicsDevice::createShader() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::Shader);
+	std::shared_ptr<NullShader> shader = std::make_shared<NullShader>(id);
+	setResource(id, shader);
+	return shader;
+}
+
+std::shared_ptr<IVertexBuffer> NullGraphicsDevice::createVertexBuffer() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::VertexBuffer);
+	std::shared_ptr<NullVertexBuffer> buffer = std::make_shared<NullVertexBuffer>(id, shared_from_this());
+	setResource(id, buffer);
+	return buffer;
+}
+
+std::shared_ptr<IIndexBuffer> NullGraphicsDevice::createIndexBuffer() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::IndexBuffer);
+	std::shared_ptr<NullIndexBuffer> buffer = std::make_shared<NullIndexBuffer>(id, shared_from_this());
+	setResource(id, buffer);
+	return buffer;
+}
+
+std::shared_ptr<IConstantBuffer> NullGraphicsDevice::createConstantBuffer() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::ConstantBuffer);
+	std::shared_ptr<NullConstantBuffer> buffer = std::make_shared<NullConstantBuffer>(id, shared_from_this());
+	setResource(id, buffer);
+	return buffer;
+}
+
+void NullGraphicsDevice::setConstantRingSize( int bytesPerFrame ) {
+	_constantRingSize = (bytesPerFrame > 0) ? ((bytesPerFrame + CONSTANT_RING_ALIGNMENT - 1) / CONSTANT_RING_ALIGNMENT) * CONSTANT_RING_ALIGNMENT : 0;
+	_constantRingHead = 0;
+	_constantRingFrame += 1;
+}
+
+bool NullGraphicsDevice::setShaderCacheDirectory( const char* ) {
+	return false;
+}
+
+std::shared_ptr<ITexture2D> NullGraphicsDevice::createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+
+	if( width <= 0 || height <= 0 ) {
+		return nullptr;
+	}
+
+	const int id = addResource(ResourceKind::Texture2D);
+	std::shared_ptr<NullTexture2D> texture = std::make_shared<NullTexture2D>(id, flags, shared_from_this());
+	if( failed(texture->setData(0, 0, width, height, pixels, format)) ) {
+		_resources.erase(id);
+		return nullptr;
+	}
+	setResource(id, texture);
+	return texture;
+}
+
+std::shared_ptr<ITexture3D> NullGraphicsDevice::createTexture3D( int width, int height, int depth, TextureFormat::Format format, int flags, void* pixels ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+
+	if( width <= 0 || height <= 0 || depth <= 0 ) {
+		return nullptr;
+	}
+
+	const int id = addResource(ResourceKind::Texture3D);
+	std::shared_ptr<NullTexture3D> texture = std::make_shared<NullTexture3D>(id, flags, shared_from_this());
+	if( failed(texture->setData(width, height, depth, pixels, format)) ) {
+		_resources.erase(id);
+		return nullptr;
+	}
+	setResource(id, texture);
+	return texture;
+}
+
+std::shared_ptr<ITextureCube> NullGraphicsDevice::createTextureCube( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+
+	const int id = addResource(ResourceKind::TextureCube);
+	std::shared_ptr<NullTextureCube> cube = std::make_shared<NullTextureCube>(id, shared_from_this());
+	if( failed(cube->set(width, height, posx, negx, posy, negy, posz, negz)) ) {
+		_resources.erase(id);
+		return nullptr;
+	}
+	setResource(id, cube);
+	return cube;
+}
+
+std::shared_ptr<ISamplerState> NullGraphicsDevice::createSamplerState( const SamplerDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::SamplerState);
+	std::shared_ptr<NullSamplerState> sampler = std::make_shared<NullSamplerState>(id);
+	sampler->create(desc);
+	setResource(id, sampler);
+	return sampler;
+}
+
+std::shared_ptr<IRenderTarget2D> NullGraphicsDevice::createRenderTarget2D( int width, int height, TextureFormat::Format format, DepthStencilFormat depthFormat ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+
+	// depth-only targets have no color texture, but must have depth
+	if( TextureFormat::None == format && DepthStencilFormat::None == depthFormat ) {
+		return nullptr;
+	}
+
+	const std::shared_ptr<NullTexture2D> texture = (TextureFormat::None==format) ? nullptr : std::static_pointer_cast<NullTexture2D>(createTexture2D(width, height, format, TextureFlags::RenderTarget, nullptr));
+	if( nullptr == texture && format != TextureFormat::None ) {
+		return nullptr;
+	}
+	const std::shared_ptr<NullTexture2D> depthTexture = (DepthStencilFormat::None==depthFormat) ? nullptr : std::static_pointer_cast<NullTexture2D>(createTexture2D(width, height, TextureFormat::fromDepthStencilFormat(depthFormat), TextureFlags::RenderTarget, nullptr));
+
+	const int id = addResource(ResourceKind::RenderTarget2D);
+	std::shared_ptr<NullRenderTarget2D> target = std::make_shared<NullRenderTarget2D>(id);
+	if( !target->create(texture, depthTexture) ) {
+		_resources.erase(id);
+		return nullptr;
+	}
+	setResource(id, target);
+	_renderTargetIds.push_back(id);
+	record(GraphicsCommandType::AllocateRenderTarget, id, renderTargetBytes(*target));
+	return target;
+}
+
+std::shared_ptr<IRasterizerState> NullGraphicsDevice::createRasterizerState( const RasterizerDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::RasterizerState);
+	std::shared_ptr<NullRasterizerState> state = std::make_shared<NullRasterizerState>(id);
+	state->create(desc);
+	setResource(id, state);
+	return state;
+}
+
+std::shared_ptr<IDepthStencilState> NullGraphicsDevice::createDepthStencilState( const DepthStencilDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::DepthStencilState);
+	std::shared_ptr<NullDepthStencilState> state = std::make_shared<NullDepthStencilState>(id);
+	state->create(desc);
+	setResource(id, state);
+	return state;
+}
+
+std::shared_ptr<IBlendState> NullGraphicsDevice::createBlendState( const BlendDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	const int id = addResource(ResourceKind::BlendState);
+	std::shared_ptr<NullBlendState> state = std::make_shared<NullBlendState>(id);
+	state->create(desc);
+	setResource(id, state);
+	return state;
+}
+
+std::shared_ptr<IPipelineState> NullGraphicsDevice::createPipelineState( const PipelineDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return _pipelineCache.create(this, desc);
+}
+
+std::shared_ptr<ICommandList> NullGraphicsDevice::createCommandList() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return std::make_shared<CommandList>();
+}
+
+void NullGraphicsDevice::applyShader( const std::shared_ptr<IShader>& shader ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr != shader ) {
+		shader->wait();
+	}
+	if( nullptr == shader || !shader->isValid() ) {
+		_activeShader.reset();
+		_stateCache.bindShader(std::shared_ptr<IShader>(), 0);
+		record(GraphicsCommandType::ApplyShader, 0);
+		return;
+	}
+	const std::shared_ptr<NullShader> nullShader = std::static_pointer_cast<NullShader>(shader);
+	_activeShader = nullShader;
+	if( _stateCache.bindShader(nullShader, 0) ) {
+		_stateCache.invalidateVertexBuffer();
+	}
+	record(GraphicsCommandType::ApplyShader, nullShader->getId());
+}
+
+void NullGraphicsDevice::applyPipelineState( const std::shared_ptr<IPipelineState>& state ) {
+	if( !_isValid || nullptr == state ) {
+		return;
+	}
+
+	// recorded as its parts, so captures replay on devices without pipelines of the same ids
+	const std::shared_ptr<PipelineState> pipeline = std::static_pointer_cast<PipelineState>(state);
+	applyShader(pipeline->getShader());
+	setBlendState(pipeline->getBlendState());
+	setRasterizerState(pipeline->getRasterizerState());
+	setDepthStencilState(pipeline->getDepthStencilState());
+}
+
+void NullGraphicsDevice::executeCommandLists( ICommandList** lists, int count ) {
+	if( !_isValid || nullptr == lists ) {
+		return;
+	}
+
+	// lists are recorded as the individual calls, exactly as if they had been made directly
+	for( int i = 0; i < count; ++i ) {
+		if( lists[i] != nullptr ) {
+			static_cast<CommandList*>(lists[i])->execute(this);
+		}
+	}
+}
+
+void NullGraphicsDevice::beginGpuScope( const char* name ) {
+	if( !_isValid || !Profiler::isEnabled() ) {
+		_openGpuScopes.push_back(-1);
+		return;
+	}
+
+	ProfileEvent scope;
+	scope.name = name;
+	scope.start = Profiler::now();
+	scope.end = 0;
+	scope.depth = static_cast<int>(_openGpuScopes.size());
+	scope.thread = Profiler::GPU_THREAD;
+	_openGpuScopes.push_back(static_cast<int>(_gpuScopes.size()));
+	_gpuScopes.push_back(scope);
+}
+
+void NullGraphicsDevice::endGpuScope() {
+	if( _openGpuScopes.empty() ) {
+		return;
+	}
+	const int index = _openGpuScopes.back();
+	_openGpuScopes.pop_back();
+	if( index != -1 ) {
+		_gpuScopes[index].end = Profiler::now();
+	}
+}
+
+void NullGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == buffer ) {
+		_activeVertexBuffer.reset();
+		_stateCache.bindVertexBuffer(buffer, 0);
+		record(GraphicsCommandType::SetVertexBuffer, 0);
+		return;
+	}
+	const std::shared_ptr<NullVertexBuffer> nullBuffer = std::static_pointer_cast<NullVertexBuffer>(buffer);
+	if( !nullBuffer->isCreated() ) {
+		return;
+	}
+	_activeVertexBuffer = nullBuffer;
+	if( _stateCache.bindVertexBuffer(nullBuffer, 0) ) {
+		_stateCache.countVertexInputBind();
+	}
+	record(GraphicsCommandType::SetVertexBuffer, nullBuffer->getId());
+}
+
+void NullGraphicsDevice::setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( numBuffers > VertexDeclaration::MAX_STREAMS ) {
+		numBuffers = VertexDeclaration::MAX_STREAMS;
+	}
+
+	setVertexBuffer((numBuffers > 0) ? buffers[0] : nullptr);
+	for( int i = 1; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		bindVertexStream(i, (i < numBuffers) ? buffers[i] : nullptr);
+	}
+}
+
+void NullGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == buffer ) {
+		_activeIndexBuffer.reset();
+		_stateCache.bindIndexBuffer(buffer, 0);
+		record(GraphicsCommandType::SetIndexBuffer, 0);
+		return;
+	}
+	const std::shared_ptr<NullIndexBuffer> nullBuffer = std::static_pointer_cast<NullIndexBuffer>(buffer);
+	if( !nullBuffer->isCreated() ) {
+		return;
+	}
+	_activeIndexBuffer = nullBuffer;
+	_stateCache.bindIndexBuffer(nullBuffer, 0);
+	record(GraphicsCommandType::SetIndexBuffer, nullBuffer->getId());
+}
+
+void NullGraphicsDevice::setTexture2D( int index, const std::shared_ptr<ITexture2D>& texture, ShaderStage::Stage shaderStage ) {
+	if( !_isValid || index < 0 ) {
+		return;
+	}
+	const int id = (texture != nullptr) ? std::static_pointer_cast<NullTexture2D>(texture)->getId() : 0;
+	_stateCache.bindTexture(TEXTURE_TABLE_2D, index, texture, 0);
+	record(GraphicsCommandType::SetTexture2D, index, id, shaderStage);
+}
+
+void NullGraphicsDevice::setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) {
+	if( !_isValid || index < 0 ) {
+		return;
+	}
+	const int id = (texture != nullptr) ? std::static_pointer_cast<NullTexture3D>(texture)->getId() : 0;
+	_stateCache.bindTexture(TEXTURE_TABLE_3D, index, texture, 0);
+	record(GraphicsCommandType::SetTexture3D, index, id, shaderStage);
+}
+
+void NullGraphicsDevice::setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) {
+	if( !_isValid || index < 0 ) {
+		return;
+	}
+	const int id = (texture != nullptr) ? std::static_pointer_cast<NullTextureCube>(texture)->getId() : 0;
+	_stateCache.bindTexture(TEXTURE_TABLE_CUBE, index, texture, 0);
+	record(GraphicsCommandType::SetTextureCube, index, id, shaderStage);
+}
+
+void NullGraphicsDevice::setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) {
+	if( !_isValid || index < 0 ) {
+		return;
+	}
+	const int id = (state != nullptr) ? std::static_pointer_cast<NullSamplerState>(state)->getId() : 0;
+	_stateCache.bindSampler(0, index, state, 0);
+	record(GraphicsCommandType::SetSamplerState, index, id, shaderStage);
+}
+
+void NullGraphicsDevice::setBlendState( const std::shared_ptr<IBlendState>& state ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == state ) {
+		restoreDefaultBlendState();
+		return;
+	}
+	_stateCache.bindBlendState(state, 0);
+	record(GraphicsCommandType::SetBlendState, std::static_pointer_cast<NullBlendState>(state)->getId());
+}
+
+void NullGraphicsDevice::drawArrays( PrimitiveTopology topology, int vertexCount, int startIndex ) {
+	if( !_isValid ) {
+		return;
+	}
+	// same requirements as the real backends; invalid draws are dropped
+	if( _activeShader.expired() || _activeVertexBuffer.expired() || vertexCount <= 0 ) {
+		return;
+	}
+	refreshConstants();
+	record(GraphicsCommandType::DrawArrays, static_cast<int>(topology), vertexCount, startIndex);
+}
+
+void NullGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( _activeShader.expired() || _activeVertexBuffer.expired() || _activeIndexBuffer.expired() || indexCount <= 0 ) {
+		return;
+	}
+	// the range must lie within both buffers; the real apis would read garbage or fault instead
+	const int bufferIndices = _activeIndexBuffer.lock()->getIndexCount();
+	const int bufferVertices = _activeVertexBuffer.lock()->getVertexCount();
+	if( startIndex < 0 || startIndex + indexCount > bufferIndices || baseVertex < 0 || baseVertex >= bufferVertices ) {
+		return;
+	}
+	refreshConstants();
+	record(GraphicsCommandType::DrawIndexed, static_cast<int>(topology), indexCount, startIndex, baseVertex);
+}
+
+void NullGraphicsDevice::drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( _activeShader.expired() || _activeVertexBuffer.expired() || vertexCount <= 0 || instanceCount <= 0 || !hasVertexStreams() ) {
+		return;
+	}
+	refreshConstants();
+	record(GraphicsCommandType::DrawInstanced, static_cast<int>(topology), vertexCount, instanceCount, startIndex);
+}
+
+void NullGraphicsDevice::drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( _activeShader.expired() || _activeVertexBuffer.expired() || _activeIndexBuffer.expired() || indexCount <= 0 || instanceCount <= 0 || !hasVertexStreams() ) {
+		return;
+	}
+	refreshConstants();
+	record(GraphicsCommandType::DrawIndexedInstanced, static_cast<int>(topology), indexCount, instanceCount);
+}
+
+void NullGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == renderTargets || numRenderTargets <= 0 || nullptr == renderTargets[0] ) {
+		return;
+	}
+
+	// only the first three ids fit in a command; the count is always exact
+	int ids[3] = {0, 0, 0};
+	for( int i = 0; i < numRenderTargets && i < 3; ++i ) {
+		ids[i] = (renderTargets[i] != nullptr) ? static_cast<NullRenderTarget2D*>(renderTargets[i])->getId() : 0;
+	}
+	record(GraphicsCommandType::SetRenderTargets, numRenderTargets, ids[0], ids[1], ids[2]);
+
+	// viewport follows the first target, as on the real backends, without recording a separate command
+	const std::shared_ptr<ITexture2D> sizeTexture = (renderTargets[0]->getTexture() != nullptr) ? renderTargets[0]->getTexture() : renderTargets[0]->getDepth();
+	_activeViewport = Viewport(0, 0, sizeTexture->getWidth(), sizeTexture->getHeight());
+}
+
+void NullGraphicsDevice::restoreDefaultRenderTargets() {
+	if( !_isValid ) {
+		return;
+	}
+	record(GraphicsCommandType::RestoreRenderTargets);
+	_activeViewport = Viewport(0, 0, _defaultWidth, _defaultHeight);
+}
+
+ErrorCode NullGraphicsDevice::resize() {
+	if( !_isValid ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+	const int width = _window->getWidth();
+	const int height = _window->getHeight();
+	if( width == _defaultWidth && height == _defaultHeight ) {
+		return ErrorCode::CIRI_OK;
+	}
+	_defaultWidth = width;
+	_defaultHeight = height;
+	restoreDefaultRenderTargets();
+	return ErrorCode::CIRI_OK;
+}
+
+ErrorCode NullGraphicsDevice::resizeTexture2D( const std::shared_ptr<ITexture2D>& texture, int width, int height ) {
+	if( !_isValid ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+	if( width <= 0 || height <= 0 || nullptr == texture ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+	const std::shared_ptr<NullTexture2D> nullTexture = std::static_pointer_cast<NullTexture2D>(texture);
+	const TextureFormat::Format format = nullTexture->getFormat();
+	nullTexture->destroy();
+	return nullTexture->setData(0, 0, width, height, nullptr, format);
+}
+
+ErrorCode NullGraphicsDevice::resizeRenderTarget2D( const std::shared_ptr<IRenderTarget2D>& target, int width, int height ) {
+	if( !_isValid ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+	if( width <= 0 || height <= 0 || nullptr == target ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+	if( nullptr == target->getTexture() && nullptr == target->getDepth() ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	}
+	// resize in place so that ids (and therefore recorded streams) stay stable
+	ErrorCode status = ErrorCode::CIRI_OK;
+	if( target->getTexture() != nullptr ) {
+		status = resizeTexture2D(target->getTexture(), width, height);
+		if( failed(status) ) {
+			return status;
+		}
+	}
+	if( target->getDepth() != nullptr ) {
+		status = resizeTexture2D(target->getDepth(), width, height);
+	}
+	record(GraphicsCommandType::AllocateRenderTarget, static_cast<NullRenderTarget2D*>(target.get())->getId(), renderTargetBytes(*target));
+	return status;
+}
+
+void NullGraphicsDevice::setClearColor( float r, float g, float b, float a ) {
+	if( !_isValid ) {
+		return;
+	}
+	record(GraphicsCommandType::SetClearColor, floatBits(r), floatBits(g), floatBits(b), floatBits(a));
+}
+
+void NullGraphicsDevice::setClearDepth( float depth ) {
+	if( !_isValid ) {
+		return;
+	}
+	record(GraphicsCommandType::SetClearDepth, floatBits(depth));
+}
+
+void NullGraphicsDevice::setClearStencil( int stencil ) {
+	if( !_isValid ) {
+		return;
+	}
+	record(GraphicsCommandType::SetClearStencil, stencil);
+}
+
+void NullGraphicsDevice::clear( int flags ) {
+	if( !_isValid ) {
+		return;
+	}
+	record(GraphicsCommandType::Clear, flags);
+}
+
+void NullGraphicsDevice::setRasterizerState( const std::shared_ptr<IRasterizerState>& state ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == state ) {
+		restoreDefaultRasterizerState();
+		return;
+	}
+	_stateCache.bindRasterizerState(state, 0);
+	record(GraphicsCommandType::SetRasterizerState, std::static_pointer_cast<NullRasterizerState>(state)->getId());
+}
+
+void NullGraphicsDevice::setDepthStencilState( const std::shared_ptr<IDepthStencilState>& state ) {
+	if( !_isValid ) {
+		return;
+	}
+	if( nullptr == state ) {
+		restoreDefaultDepthStencilState();
+		return;
+	}
+	_stateCache.bindDepthStencilState(state, 0);
+	record(GraphicsCommandType::SetDepthStencilState, std::static_pointer_cast<NullDepthStencilState>(state)->getId());
+}
+
+void NullGraphicsDevice::setShaderExt( const char* ext ) {
+	_shaderExt = ext;
+}
+
+const char* NullGraphicsDevice::getShaderExt() const {
+	return _shaderExt.c_str();
+}
+
+std::shared_ptr<IWindow> NullGraphicsDevice::getWindow() const {
+	return _window;
+}
+
+const char* NullGraphicsDevice::getGpuName() const {
+	return "None";
+}
+
+const char* NullGraphicsDevice::getApiInfo() const {
+	return "Null (recording)";
+}
+
+GraphicsApiType NullGraphicsDevice::getApiType() const {
+	return GraphicsApiType::Null;
+}
+
+int NullGraphicsDevice::getRedundantCallCount() const {
+	return _stateCache.getRedundantCallCount();
+}
+
+int NullGraphicsDevice::getStateChangeCount() const {
+	return _stateCache.getStateChangeCount();
+}
+
+int NullGraphicsDevice::getVertexAttributeSetupCount() const {
+	return _stateCache.getVertexAttributeSetupCount();
+}
+
+int NullGraphicsDevice::getVertexInputBindCount() const {
+	return _stateCache.getVertexInputBindCount();
+}
+
+ErrorCode NullGraphicsDevice::restoreDefaultStates() {
+	ErrorCode status = restoreDefaultBlendState();
+	if( failed(status) ) {
+		return status;
+	}
+	status = restoreDefaultRasterizerState();
+	if( failed(status) ) {
+		return status;
+	}
+	status = restoreDefaultDepthStencilState();
+	if( failed(status) ) {
+		return status;
+	}
+	return ErrorCode::CIRI_OK;
+}
+
+ErrorCode NullGraphicsDevice::restoreDefaultBlendState() {
+	setBlendState(getDefaultBlendOpaque());
+	return ErrorCode::CIRI_OK;
+}
+
+ErrorCode NullGraphicsDevice::restoreDefaultRasterizerState() {
+	setRasterizerState(getDefaultRasterCounterClockwise());
+	return ErrorCode::CIRI_OK;
+}
+
+ErrorCode NullGraphicsDevice::restoreDefaultDepthStencilState() {
+	setDepthStencilState(getDefaultDepthStencilDefault());
+	return ErrorCode::CIRI_OK;
+}
+
+std::shared_ptr<IBlendState> NullGraphicsDevice::getDefaultBlendAdditive() {
+	if( nullptr == _defaultBlendAdditive ) {
+		BlendDesc desc;
+		desc.srcColorBlend = BlendMode::SourceAlpha;
+		desc.srcAlphaBlend = BlendMode::SourceAlpha;
+		desc.dstColorBlend = BlendMode::One;
+		desc.dstAlphaBlend = BlendMode::One;
+		_defaultBlendAdditive = createBlendState(desc);
+	}
+	return _defaultBlendAdditive;
+}
+
+std::shared_ptr<IBlendState> NullGraphicsDevice::getDefaultBlendAlpha() {
+	if( nullptr == _defaultBlendAlpha ) {
+		BlendDesc desc;
+		desc.srcColorBlend = BlendMode::One;
+		desc.srcAlphaBlend = BlendMode::One;
+		desc.dstColorBlend = BlendMode::InverseSourceAlpha;
+		desc.dstAlphaBlend = BlendMode::InverseSourceAlpha;
+		_defaultBlendAlpha = createBlendState(desc);
+	}
+	return _defaultBlendAlpha;
+}
+
+std::shared_ptr<IBlendState> NullGraphicsDevice::getDefaultBlendNonPremul() {
+	if( nullptr == _defaultBlendNonPremul ) {
+		BlendDesc desc;
+		desc.srcColorBlend = BlendMode::SourceAlpha;
+		desc.srcAlphaBlend = BlendMode::SourceAlpha;
+		desc.dstColorBlend = BlendMode::InverseSourceAlpha;
+		desc.dstAlphaBlend = BlendMode::InverseSourceAlpha;
+		_defaultBlendNonPremul = createBlendState(desc);
+	}
+	return _defaultBlendNonPremul;
+}
+
+std::shared_ptr<IBlendState> NullGraphicsDevice::getDefaultBlendOpaque() {
+	if( nullptr == _defaultBlendOpaque ) {
+		BlendDesc desc;
+		desc.srcColorBlend = BlendMode::One;
+		desc.srcAlphaBlend = BlendMode::One;
+		desc.dstColorBlend = BlendMode::Zero;
+		desc.dstAlphaBlend = BlendMode::Zero;
+		_defaultBlendOpaque = createBlendState(desc);
+	}
+	return _defaultBlendOpaque;
+}
+
+std::shared_ptr<IRasterizerState> NullGraphicsDevice::getDefaultRasterNone() {
+	if( nullptr == _defaultRasterNone ) {
+		RasterizerDesc desc;
+		desc.cullMode = CullMode::None;
+		_defaultRasterNone = createRasterizerState(desc);
+	}
+	return _defaultRasterNone;
+}
+
+std::shared_ptr<IRasterizerState> NullGraphicsDevice::getDefaultRasterClockwise() {
+	if( nullptr == _defaultRasterClockwise ) {
+		RasterizerDesc desc;
+		desc.cullMode = CullMode::Clockwise;
+		_defaultRasterClockwise = createRasterizerState(desc);
+	}
+	return _defaultRasterClockwise;
+}
+
+std::shared_ptr<IRasterizerState> NullGraphicsDevice::getDefaultRasterCounterClockwise() {
+	if( nullptr == _defaultRasterCounterClockwise ) {
+		RasterizerDesc desc;
+		desc.cullMode = CullMode::CounterClockwise;
+		_defaultRasterCounterClockwise = createRasterizerState(desc);
+	}
+	return _defaultRasterCounterClockwise;
+}
+
+std::shared_ptr<IDepthStencilState> NullGraphicsDevice::getDefaultDepthStencilDefault() {
+	if( nullptr == _defaultDepthStencilDefault ) {
+		DepthStencilDesc desc;
+		desc.depthEnable = true;
+		desc.depthWriteMask = true;
+		_defaultDepthStencilDefault = createDepthStencilState(desc);
+	}
+	return _defaultDepthStencilDefault;
+}
+
+std::shared_ptr<IDepthStencilState> NullGraphicsDevice::getDefaultDepthStencilDepthRead() {
+	if( nullptr == _defaultDepthStencilDepthRead ) {
+		DepthStencilDesc desc;
+		desc.depthEnable = true;
+		desc.depthWriteMask = false;
+		_defaultDepthStencilDepthRead = createDepthStencilState(desc);
+	}
+	return _defaultDepthStencilDepthRead;
+}
+
+std::shared_ptr<IDepthStencilState> NullGraphicsDevice::getDefaultDepthStencilNone() {
+	if( nullptr == _defaultDepthStencilNone ) {
+		DepthStencilDesc desc;
+		desc.depthEnable = false;
+		desc.depthWriteMask = false;
+		_defaultDepthStencilNone = createDepthStencilState(desc);
+	}
+	return _defaultDepthStencilNone;
+}
+
+void NullGraphicsDevice::bindVertexStream( int slot, const std::shared_ptr<IVertexBuffer>& buffer ) {
+	std::shared_ptr<NullVertexBuffer> nullBuffer = std::static_pointer_cast<NullVertexBuffer>(buffer);
+	if( nullBuffer != nullptr && !nullBuffer->isCreated() ) {
+		nullBuffer = nullptr;
+	}
+	// unused slots that stay unbound are not worth a command each
+	if( nullptr == nullBuffer && _activeVertexStreams[slot].expired() ) {
+		return;
+	}
+	_activeVertexStreams[slot] = nullBuffer;
+	record(GraphicsCommandType::SetVertexStream, slot, (nullBuffer != nullptr) ? nullBuffer->getId() : 0);
+}
+
+bool NullGraphicsDevice::hasVertexStreams() const {
+	// like gl, an instanced draw is dropped if the shader reads from a stream with nothing bound
+	const int streamCount = _activeShader.lock()->getVertexDeclaration().getStreamCount();
+	for( int i = 1; i < streamCount; ++i ) {
+		if( _activeVertexStreams[i].expired() ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void NullGraphicsDevice::refreshConstants() {
+	const std::vector<std::shared_ptr<NullConstantBuffer>>& constants = _activeShader.lock()->getConstants();
+	for( unsigned int i = 0; i < constants.size(); ++i ) {
+		constants[i]->refresh();
+	}
+}
+
+GraphicsCommandStream& NullGraphicsDevice::getCommandStream() {
+	return _commandStream;
+}
+
+void NullGraphicsDevice::replay( const GraphicsCommandStream& stream ) {
+	if( !_isValid || &stream == &_commandStream ) {
+		return;
+	}
+
+	for( const auto& cmd : stream.getCommands() ) {
+		const int* args = cmd.args;
+		switch( cmd.type ) {
+			case GraphicsCommandType::ApplyShader: {
+				applyShader(findResource<NullShader>(args[0], ResourceKind::Shader));
+				break;
+			}
+			case GraphicsCommandType::SetVertexBuffer: {
+				setVertexBuffer(findResource<NullVertexBuffer>(args[0], ResourceKind::VertexBuffer));
+				break;
+			}
+			case GraphicsCommandType::SetIndexBuffer: {
+				setIndexBuffer(findResource<NullIndexBuffer>(args[0], ResourceKind::IndexBuffer));
+				break;
+			}
+			case GraphicsCommandType::SetTexture2D: {
+				setTexture2D(args[0], findResource<NullTexture2D>(args[1], ResourceKind::Texture2D), static_cast<ShaderStage::Stage>(args[2]));
+				break;
+			}
+			case GraphicsCommandType::SetTexture3D: {
+				setTexture3D(args[0], findResource<NullTexture3D>(args[1], ResourceKind::Texture3D), static_cast<ShaderStage::Stage>(args[2]));
+				break;
+			}
+			case GraphicsCommandType::SetTextureCube: {
+				setTextureCube(args[0], findResource<NullTextureCube>(args[1], ResourceKind::TextureCube), static_cast<ShaderStage::Stage>(args[2]));
+				break;
+			}
+			case GraphicsCommandType::SetSamplerState: {
+				setSamplerState(args[0], findResource<NullSamplerState>(args[1], ResourceKind::SamplerState), static_cast<ShaderStage::Stage>(args[2]));
+				break;
+			}
+			case GraphicsCommandType::SetBlendState: {
+				setBlendState(findResource<NullBlendState>(args[0], ResourceKind::BlendState));
+				break;
+			}
+			case GraphicsCommandType::SetRasterizerState: {
+				setRasterizerState(findResource<NullRasterizerState>(args[0], ResourceKind::RasterizerState));
+				break;
+			}
+			case GraphicsCommandType::SetDepthStencilState: {
+				setDepthStencilState(findResource<NullDepthStencilState>(args[0], ResourceKind::DepthStencilState));
+				break;
+			}
+			case GraphicsCommandType::SetRenderTargets: {
+				std::shared_ptr<NullRenderTarget2D> targets[3];
+				IRenderTarget2D* targetPtrs[3] = {nullptr, nullptr, nullptr};
+				const int count = (args[0] < 3) ? args[0] : 3;
+				for( int i = 0; i < count; ++i ) {
+					targets[i] = findResource<NullRenderTarget2D>(args[1 + i], ResourceKind::RenderTarget2D);
+					targetPtrs[i] = targets[i].get();
+				}
+				setRenderTargets(targetPtrs, count);
+				break;
+			}
+			case GraphicsCommandType::RestoreRenderTargets: {
+				restoreDefaultRenderTargets();
+				break;
+			}
+			case GraphicsCommandType::SetViewport: {
+				setViewport(Viewport(args[0], args[1], args[2], args[3]));
+				break;
+			}
+			case GraphicsCommandType::SetClearColor: {
+				setClearColor(bitsFloat(args[0]), bitsFloat(args[1]), bitsFloat(args[2]), bitsFloat(args[3]));
+				break;
+			}
+			case GraphicsCommandType::SetClearDepth: {
+				setClearDepth(bitsFloat(args[0]));
+				break;
+			}
+			case GraphicsCommandType::SetClearStencil: {
+				setClearStencil(args[0]);
+				break;
+			}
+			case GraphicsCommandType::Clear: {
+				clear(args[0]);
+				break;
+			}
+			case GraphicsCommandType::DrawArrays: {
+				drawArrays(static_cast<PrimitiveTopology>(args[0]), args[1], args[2]);
+				break;
+			}
+			case GraphicsCommandType::DrawIndexed: {
+				drawIndexed(static_cast<PrimitiveTopology>(args[0]), args[1], args[2], args[3]);
+				break;
+			}
+			case GraphicsCommandType::Present: {
+				present();
+				break;
+			}
+			case GraphicsCommandType::SetVertexStream: {
+				if( args[0] > 0 && args[0] < VertexDeclaration::MAX_STREAMS ) {
+					bindVertexStream(args[0], findResource<NullVertexBuffer>(args[1], ResourceKind::VertexBuffer));
+				}
+				break;
+			}
+			case GraphicsCommandType::DrawInstanced: {
+				drawInstanced(static_cast<PrimitiveTopology>(args[0]), args[1], args[2], args[3]);
+				break;
+			}
+			case GraphicsCommandType::DrawIndexedInstanced: {
+				drawIndexedInstanced(static_cast<PrimitiveTopology>(args[0]), args[1], args[2]);
+				break;
+			}
+			default: {
+				// uploads carry no data to re-send, and allocations are as they were when recorded
+				_commandStream.record(cmd);
+				break;
+			}
+		}
+	}
+}
+
+bool NullGraphicsDevice::allocateConstants( int dataSize, int* outOffset, int* outAlignedSize ) {
+	const int alignedSize = ((dataSize + CONSTANT_RING_ALIGNMENT - 1) / CONSTANT_RING_ALIGNMENT) * CONSTANT_RING_ALIGNMENT;
+	if( dataSize <= 0 || _constantRingHead + alignedSize > _constantRingSize ) {
+		return false;
+	}
+	*outOffset = _constantRingHead;
+	*outAlignedSize = alignedSize;
+	_constantRingHead += alignedSize;
+	return true;
+}
+
+unsigned int NullGraphicsDevice::getConstantRingFrame() const {
+	return _constantRingFrame;
+}
+
+std::future<TextureReadback> NullGraphicsDevice::readTexture( int id, TextureFormat::Format format, int width, int height ) {
+	if( !_isValid || width <= 0 || height <= 0 ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+
+	ReadbackJob job;
+	job.width = width;
+	job.height = height;
+	if( TextureFormat::isDepth(format) ) {
+		job.source = PixelConversion::UInt32;
+		job.shift = 24;
+	} else if( TextureFormat::RGBA32_Float == format ) {
+		job.source = PixelConversion::RGBA32F;
+	} else if( TextureFormat::R32_FLOAT == format ) {
+		job.source = PixelConversion::R32F;
+	} else if( TextureFormat::R32_UINT == format ) {
+		job.source = PixelConversion::UInt32;
+	}
+	job.rowPitch = width * PixelConversion::bytesPerTexel(job.source);
+	record(GraphicsCommandType::ReadTexture, id, job.rowPitch * height);
+
+	std::future<TextureReadback> future = job.promise.get_future();
+	_pendingReadbacks.push_back(std::move(job));
+	return future;
+}
+
+int NullGraphicsDevice::bytesPerPixel( TextureFormat::Format format ) {
+	switch( format ) {
+		case TextureFormat::RGBA32_Float: {
+			return 16;
+		}
+		case TextureFormat::Depth16: {
+			return 2;
+		}
+		case TextureFormat::Depth32FStencil8: {
+			return 8;
+		}
+		default: {
+			return 4;
+		}
+	}
+}
+
+void NullGraphicsDevice::releaseRenderTargets() {
+	// a real driver frees memory once the gpu is done with it, so releases land at the end of the frame they happened in
+	for( unsigned int i = 0; i < _renderTargetIds.size(); ) {
+		const int id = _renderTargetIds[i];
+		if( _resources[id].resource.expired() ) {
+			record(GraphicsCommandType::ReleaseRenderTarget, id);
+			_renderTargetIds[i] = _renderTargetIds.back();
+			_renderTargetIds.pop_back();
+		} else {
+			++i;
+		}
+	}
+}
+
+int NullGraphicsDevice::renderTargetBytes( const IRenderTarget2D& target ) {
+	int bytes = 0;
+	const std::shared_ptr<ITexture2D> textures[2] = {target.getTexture(), target.getDepth()};
+	for( int i = 0; i < 2; ++i ) {
+		if( textures[i] != nullptr ) {
+			bytes += textures[i]->getWidth() * textures[i]->getHeight() * bytesPerPixel(textures[i]->getFormat());
+		}
+	}
+	return bytes;
+}
+
+int NullGraphicsDevice::addResource( ResourceKind kind ) {
+	const int id = _nextResourceId;
+	_nextResourceId += 1;
+	ResourceEntry entry;
+	entry.kind = kind;
+	_resources[id] = entry;
+	return id;
+}
+
+void NullGraphicsDevice::setResource( int id, const std::shared_ptr<void>& resource ) {
+	_resources[id].resource = resource;
+}
+
+template<typename T>
+std::shared_ptr<T> NullGraphicsDevice::findResource( int id, ResourceKind kind ) const {
+	const auto it = _resources.find(id);
+	if( _resources.end() == it || it->second.kind != kind ) {
+		return nullptr;
+	}
+	return std::static_pointer_cast<T>(it->second.resource.lock());
+}
+
+void NullGraphicsDevice::record( GraphicsCommandType type, int a0, int a1, int a2, int a3 ) {
+	_commandStream.record(GraphicsCommand(type, a0, a1, a2, a3));
+}
+
+int NullGraphicsDevice::floatBits( float value ) {
+	int bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+float NullGraphicsDevice::bitsFloat( int bits ) {
+	float value = 0.0f;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+
+#ifndef _WIN32
+// neither the GL nor the DX11 device builds off Win32, so the null device is the platform's device
+namespace ciri {
+std::shared_ptr<IGraphicsDevice> createGraphicsDevice() {
+	return std::shared_ptr<IGraphicsDevice>(new NullGraphicsDevice());
+}
+}
+#endif
\ No newline at end of file
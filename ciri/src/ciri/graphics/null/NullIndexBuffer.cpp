@@ -0,0 +1,56 @@
+#include <ciri/graphics/null/NullIndexBuffer.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullIndexBuffer::NullIndexBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device )
+	: IIndexBuffer(), _device(device), _id(id), _indexCount(0), _format(IndexFormat::UInt32), _isDynamic(false), _isCreated(false) {
+}
+
+NullIndexBuffer::~NullIndexBuffer() {
+	destroy();
+}
+
+ErrorCode NullIndexBuffer::set( int* indices, int indexCount, bool dynamic ) {
+	if( nullptr == indices || indexCount <= 0 ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	if( _isCreated ) {
+		if( !_isDynamic ) {
+			return ErrorCode::CIRI_STATIC_BUFFER_AS_DYNAMIC;
+		}
+		// like the real backends, updates keep the format chosen at creation
+		if( IndexFormat::UInt16 == _format && IndexFormat::UInt32 == IndexFormat::fromIndices(indices, indexCount) ) {
+			return ErrorCode::CIRI_INVALID_ARGUMENT;
+		}
+	} else {
+		_isDynamic = dynamic;
+		_format = IndexFormat::fromIndices(indices, indexCount);
+	}
+
+	_indexCount = indexCount;
+	_isCreated = true;
+	_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadIndexBuffer, _id, IndexFormat::bytesPerIndex(_format) * indexCount));
+	return ErrorCode::CIRI_OK;
+}
+
+void NullIndexBuffer::destroy() {
+	_isCreated = false;
+}
+
+int NullIndexBuffer::getIndexCount() const {
+	return _indexCount;
+}
+
+IndexFormat::Format NullIndexBuffer::getFormat() const {
+	return _format;
+}
+
+int NullIndexBuffer::getId() const {
+	return _id;
+}
+
+bool NullIndexBuffer::isCreated() const {
+	return _isCreated;
+}
@@ -0,0 +1,27 @@
+#include <ciri/graphics/null/NullRasterizerState.hpp>
+
+using namespace ciri;
+
+NullRasterizerState::NullRasterizerState( int id )
+	: IRasterizerState(), _id(id) {
+}
+
+NullRasterizerState::~NullRasterizerState() {
+	destroy();
+}
+
+bool NullRasterizerState::create( const RasterizerDesc& desc ) {
+	_desc = desc;
+	return true;
+}
+
+void NullRasterizerState::destroy() {
+}
+
+const RasterizerDesc& NullRasterizerState::getDesc() const {
+	return _desc;
+}
+
+int NullRasterizerState::getId() const {
+	return _id;
+}
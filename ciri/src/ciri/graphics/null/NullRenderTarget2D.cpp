@@ -0,0 +1,47 @@
+#include <ciri/graphics/null/NullRenderTarget2D.hpp>
+#include <ciri/graphics/null/NullTexture2D.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
+
+using namespace ciri;
+
+NullRenderTarget2D::NullRenderTarget2D( int id )
+	: IRenderTarget2D(), _id(id), _texture(nullptr), _depthTexture(nullptr) {
+}
+
+NullRenderTarget2D::~NullRenderTarget2D() {
+	destroy();
+}
+
+bool NullRenderTarget2D::create( const std::shared_ptr<NullTexture2D>& texture, const std::shared_ptr<NullTexture2D>& depthTexture ) {
+	// depth-only targets have no color texture
+	if( _texture != nullptr || _depthTexture != nullptr || (nullptr == texture && nullptr == depthTexture) ) {
+		return false;
+	}
+	_texture = texture;
+	_depthTexture = depthTexture;
+	return true;
+}
+
+void NullRenderTarget2D::destroy() {
+	_texture = nullptr;
+	_depthTexture = nullptr;
+}
+
+std::shared_ptr<ITexture2D> NullRenderTarget2D::getTexture() const {
+	return _texture;
+}
+
+std::shared_ptr<ITexture2D> NullRenderTarget2D::getDepth() const {
+	return _depthTexture;
+}
+
+std::future<TextureReadback> NullRenderTarget2D::readAsync() {
+	if( nullptr == _texture ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+	return _texture->readAsync();
+}
+
+int NullRenderTarget2D::getId() const {
+	return _id;
+}
@@ -0,0 +1,27 @@
+#include <ciri/graphics/null/NullSamplerState.hpp>
+
+using namespace ciri;
+
+NullSamplerState::NullSamplerState( int id )
+	: ISamplerState(), _id(id) {
+}
+
+NullSamplerState::~NullSamplerState() {
+	destroy();
+}
+
+bool NullSamplerState::create( const SamplerDesc& desc ) {
+	_desc = desc;
+	return true;
+}
+
+void NullSamplerState::destroy() {
+}
+
+const SamplerDesc& NullSamplerState::getDesc() const {
+	return _desc;
+}
+
+int NullSamplerState::getId() const {
+	return _id;
+}
@@ -0,0 +1,101 @@
+#include <ciri/graphics/null/NullShader.hpp>
+#include <ciri/graphics/null/NullConstantBuffer.hpp>
+#include <ciri/core/FileSystem.hpp>
+
+using namespace ciri;
+
+NullShader::NullShader( int id )
+	: IShader(), _id(id), _isValid(false) {
+}
+
+NullShader::~NullShader() {
+	destroy();
+}
+
+void NullShader::addInputElement( const VertexElement& element ) {
+	_vertexDeclaration.add(element);
+}
+
+ErrorCode NullShader::loadFromFile( const char* vs, const char* gs, const char* ps ) {
+	_errors.clear();
+
+	// must have at least VS and PS
+	if( nullptr == vs || nullptr == ps ) {
+		addError(ErrorCode::CIRI_SHADER_INCOMPLETE, getErrorString(ErrorCode::CIRI_SHADER_INCOMPLETE));
+		return ErrorCode::CIRI_SHADER_INCOMPLETE;
+	}
+
+	// files are read so that missing data fails the same way, and loading costs the same reads, as it would on a real device
+	const char* files[] = {vs, gs, ps};
+	for( const char* file : files ) {
+		if( nullptr == file ) {
+			continue;
+		}
+		if( !FileSystem::read(file).isValid() ) {
+			addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + file + std::string(")"));
+			return ErrorCode::CIRI_FILE_NOT_FOUND;
+		}
+	}
+
+	return loadFromMemory(vs, gs, ps);
+}
+
+ErrorCode NullShader::loadFromMemory( const char* vs, const char*, const char* ps ) {
+	if( nullptr == vs || nullptr == ps ) {
+		addError(ErrorCode::CIRI_SHADER_INCOMPLETE, getErrorString(ErrorCode::CIRI_SHADER_INCOMPLETE));
+		return ErrorCode::CIRI_SHADER_INCOMPLETE;
+	}
+	_isValid = true;
+	return ErrorCode::CIRI_OK;
+}
+
+ErrorCode NullShader::addConstants( const std::shared_ptr<IConstantBuffer>& buffer, const char* name, int ) {
+	if( nullptr == buffer || nullptr == name ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+	if( !isValid() ) {
+		return ErrorCode::CIRI_SHADER_INVALID;
+	}
+	_constantBuffers.push_back(std::static_pointer_cast<NullConstantBuffer>(buffer));
+	return ErrorCode::CIRI_OK;
+}
+
+void NullShader::destroy() {
+	_constantBuffers.clear();
+	_isValid = false;
+}
+
+const std::vector<IShader::ShaderError>& NullShader::getErrors() const {
+	return _errors;
+}
+
+bool NullShader::isValid() const {
+	return _isValid;
+}
+
+bool NullShader::isPending() const {
+	return false;
+}
+
+ErrorCode NullShader::wait() {
+	if( !_errors.empty() ) {
+		return _errors[0].code;
+	}
+	return _isValid ? ErrorCode::CIRI_OK : ErrorCode::CIRI_SHADER_INVALID;
+}
+
+const VertexDeclaration& NullShader::getVertexDeclaration() const {
+	return _vertexDeclaration;
+}
+
+const std::vector<std::shared_ptr<NullConstantBuffer>>& NullShader::getConstants() const {
+	return _constantBuffers;
+}
+
+int NullShader::getId() const {
+	return _id;
+}
+
+void NullShader::addError( ErrorCode code, const std::string& msg ) {
+	_errors.push_back(ShaderError(code, msg));
+}
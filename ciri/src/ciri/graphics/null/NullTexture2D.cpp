@@ -0,0 +1,70 @@
+#include <ciri/graphics/null/NullTexture2D.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullTexture2D::NullTexture2D( int id, int flags, const std::shared_ptr<NullGraphicsDevice>& device )
+	: ITexture2D(flags), _device(device), _id(id), _flags(flags), _format(TextureFormat::None), _width(0), _height(0) {
+}
+
+NullTexture2D::~NullTexture2D() {
+	destroy();
+}
+
+void NullTexture2D::destroy() {
+	_width = 0;
+	_height = 0;
+}
+
+ErrorCode NullTexture2D::setData( int xOffset, int yOffset, int width, int height, void* data, TextureFormat::Format format ) {
+	if( _width != 0 ) {
+		// same restrictions as the gl backend when updating
+		if( format != _format ) {
+			return ErrorCode::CIRI_INVALID_ARGUMENT;
+		}
+		if( width != _width || height != _height || xOffset != 0 || yOffset != 0 ) {
+			return ErrorCode::CIRI_NOT_IMPLEMENTED;
+		}
+	} else {
+		if( xOffset != 0 || yOffset != 0 || width <= 0 || height <= 0 ) {
+			return ErrorCode::CIRI_INVALID_ARGUMENT;
+		}
+		_width = width;
+		_height = height;
+		_format = format;
+	}
+
+	// only count actual pixel transfers; allocating an empty texture uploads nothing
+	if( data != nullptr ) {
+		_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadTexture, _id, width * height * NullGraphicsDevice::bytesPerPixel(format)));
+	}
+	return ErrorCode::CIRI_OK;
+}
+
+int NullTexture2D::getWidth() const {
+	return _width;
+}
+
+int NullTexture2D::getHeight() const {
+	return _height;
+}
+
+TextureFormat::Format NullTexture2D::getFormat() const {
+	return _format;
+}
+
+ErrorCode NullTexture2D::writeToTGA( const char* ) {
+	return ErrorCode::CIRI_NOT_IMPLEMENTED;
+}
+
+ErrorCode NullTexture2D::writeToDDS( const char* ) {
+	return ErrorCode::CIRI_NOT_IMPLEMENTED;
+}
+
+std::future<TextureReadback> NullTexture2D::readAsync() {
+	return _device->readTexture(_id, _format, _width, _height);
+}
+
+int NullTexture2D::getId() const {
+	return _id;
+}
@@ -0,0 +1,62 @@
+#include <ciri/graphics/null/NullTexture3D.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullTexture3D::NullTexture3D( int id, int flags, const std::shared_ptr<NullGraphicsDevice>& device )
+	: ITexture3D(flags), _device(device), _id(id), _flags(flags), _format(TextureFormat::None), _width(0), _height(0), _depth(0) {
+}
+
+NullTexture3D::~NullTexture3D() {
+	destroy();
+}
+
+void NullTexture3D::destroy() {
+	_width = 0;
+	_height = 0;
+	_depth = 0;
+}
+
+ErrorCode NullTexture3D::setData( int width, int height, int depth, void* data, TextureFormat::Format format ) {
+	if( width <= 0 || height <= 0 || depth <= 0 ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	_width = width;
+	_height = height;
+	_depth = depth;
+	_format = format;
+
+	if( data != nullptr ) {
+		_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadTexture, _id, width * height * depth * NullGraphicsDevice::bytesPerPixel(format)));
+	}
+	return ErrorCode::CIRI_OK;
+}
+
+int NullTexture3D::getWidth() const {
+	return _width;
+}
+
+int NullTexture3D::getHeight() const {
+	return _height;
+}
+
+int NullTexture3D::getDepth() const {
+	return _depth;
+}
+
+TextureFormat::Format NullTexture3D::getFormat() const {
+	return _format;
+}
+
+ErrorCode NullTexture3D::writeToTGA( const char* ) {
+	return ErrorCode::CIRI_NOT_IMPLEMENTED;
+}
+
+ErrorCode NullTexture3D::writeToDDS( const char* ) {
+	return ErrorCode::CIRI_NOT_IMPLEMENTED;
+}
+
+int NullTexture3D::getId() const {
+	return _id;
+}
@@ -0,0 +1,37 @@
+#include <ciri/graphics/null/NullTextureCube.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullTextureCube::NullTextureCube( int id, const std::shared_ptr<NullGraphicsDevice>& device )
+	: ITextureCube(), _device(device), _id(id), _width(0), _height(0) {
+}
+
+NullTextureCube::~NullTextureCube() {
+	destroy();
+}
+
+ErrorCode NullTextureCube::set( int width, int height, void* posx, void* negx, void* posy, void* negy, void* posz, void* negz ) {
+	if( width <= 0 || height <= 0 ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+	if( nullptr==posx || nullptr==negx || nullptr==posy || nullptr==negy || nullptr==posz || nullptr==negz ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	_width = width;
+	_height = height;
+
+	// six rgba8 faces
+	_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadTexture, _id, width * height * 4 * 6));
+	return ErrorCode::CIRI_OK;
+}
+
+void NullTextureCube::destroy() {
+	_width = 0;
+	_height = 0;
+}
+
+int NullTextureCube::getId() const {
+	return _id;
+}
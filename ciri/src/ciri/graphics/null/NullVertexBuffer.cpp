@@ -0,0 +1,56 @@
+#include <ciri/graphics/null/NullVertexBuffer.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+
+using namespace ciri;
+
+NullVertexBuffer::NullVertexBuffer( int id, const std::shared_ptr<NullGraphicsDevice>& device )
+	: IVertexBuffer(), _device(device), _id(id), _vertexStride(0), _vertexCount(0), _isDynamic(false), _isCreated(false) {
+}
+
+NullVertexBuffer::~NullVertexBuffer() {
+	destroy();
+}
+
+ErrorCode NullVertexBuffer::set( void* vertices, int vertexStride, int vertexCount, bool dynamic ) {
+	if( nullptr == vertices || vertexStride <= 0 || vertexCount <= 0 ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	// same rules as the real backends for updating existing buffers
+	if( _isCreated ) {
+		if( !_isDynamic ) {
+			return ErrorCode::CIRI_STATIC_BUFFER_AS_DYNAMIC;
+		}
+		if( _vertexStride != vertexStride ) {
+			return ErrorCode::CIRI_NOT_IMPLEMENTED;
+		}
+	} else {
+		_isDynamic = dynamic;
+	}
+
+	_vertexStride = vertexStride;
+	_vertexCount = vertexCount;
+	_isCreated = true;
+	_device->getCommandStream().record(GraphicsCommand(GraphicsCommandType::UploadVertexBuffer, _id, vertexStride * vertexCount));
+	return ErrorCode::CIRI_OK;
+}
+
+void NullVertexBuffer::destroy() {
+	_isCreated = false;
+}
+
+int NullVertexBuffer::getStride() const {
+	return _vertexStride;
+}
+
+int NullVertexBuffer::getVertexCount() {
+	return _vertexCount;
+}
+
+int NullVertexBuffer::getId() const {
+	return _id;
+}
+
+bool NullVertexBuffer::isCreated() const {
+	return _isCreated;
+}
@@ -1,10 +1,11 @@
 #include <ciri/graphics/win/dx/DXConstantBuffer.hpp>
+#include <ciri/graphics/win/dx/DXConstantRing.hpp>
 #include <ciri/graphics/win/dx/DXGraphicsDevice.hpp>
 
 using namespace ciri;
 
-DXConstantBuffer::DXConstantBuffer( const std::shared_ptr<DXGraphicsDevice>& device )
-	: IConstantBuffer(), _device(device), _buffer(nullptr), _index(0) {
+DXConstantBuffer::DXConstantBuffer( const std::shared_ptr<DXGraphicsDevice>& device, const std::shared_ptr<DXConstantRing>& ring )
+	: IConstantBuffer(), _device(device), _ring(ring), _buffer(nullptr), _index(0), _inRing(false), _ringEpoch(0), _firstConstant(0), _numConstants(0) {
 }
 
 DXConstantBuffer::~DXConstantBuffer() {
@@ -12,6 +13,85 @@ DXConstantBuffer::~DXConstantBuffer() {
 }
 
 ErrorCode DXConstantBuffer::setData( int dataSize, void* data ) {
+	if( dataSize <= 0 || nullptr == data ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
+	}
+
+	// suballocate from the ring when there is one; the copy is kept so the data can be moved forward when the ring wraps
+	if( _ring != nullptr && _ring->isValid() ) {
+		_shadow.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + dataSize);
+		if( writeRing() ) {
+			_device->invalidateConstants();
+			return ErrorCode::CIRI_OK;
+		}
+	}
+
+	// a new buffer, or one replacing a ring range, has to be bound again
+	const bool rebind = _inRing || nullptr == _buffer;
+	const ErrorCode result = writeOwn(dataSize, data);
+	if( rebind ) {
+		_device->invalidateConstants();
+	}
+	return result;
+}
+
+void DXConstantBuffer::destroy() {
+	if( _buffer != nullptr ) {
+		_buffer->Release();
+		_buffer = nullptr;
+	}
+	_shadow.clear();
+	_inRing = false;
+}
+
+bool DXConstantBuffer::refresh() {
+	if( !_inRing || _ringEpoch == _ring->getEpoch() ) {
+		return false;
+	}
+
+	// the ring wrapped (or was destroyed) after the data was copied
+	if( !_ring->isValid() || !writeRing() ) {
+		writeOwn(static_cast<int>(_shadow.size()), _shadow.data());
+	}
+	return true;
+}
+
+ID3D11Buffer* DXConstantBuffer::getBuffer() const {
+	return _inRing ? _ring->getBuffer() : _buffer;
+}
+
+bool DXConstantBuffer::isInRing() const {
+	return _inRing;
+}
+
+UINT DXConstantBuffer::getFirstConstant() const {
+	return _firstConstant;
+}
+
+UINT DXConstantBuffer::getNumConstants() const {
+	return _numConstants;
+}
+
+void DXConstantBuffer::setIndex( int val ) {
+	_index = val;
+}
+
+int DXConstantBuffer::getIndex() const {
+	return _index;
+}
+
+bool DXConstantBuffer::writeRing() {
+	if( !_ring->allocate(_shadow.data(), static_cast<int>(_shadow.size()), &_firstConstant, &_numConstants) ) {
+		return false;
+	}
+	_inRing = true;
+	_ringEpoch = _ring->getEpoch();
+	return true;
+}
+
+ErrorCode DXConstantBuffer::writeOwn( int dataSize, const void* data ) {
+	_inRing = false;
+
 	D3D11_BUFFER_DESC desc;
 	ZeroMemory(&desc, sizeof(desc));
 	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
@@ -30,7 +110,10 @@ ErrorCode DXConstantBuffer::setData( int dataSize, void* data ) {
 	if( nullptr == _buffer ) {
 		HRESULT hr = _device->getDevice()->CreateBuffer(&desc, &subdata, &_buffer);
 		if( FAILED(hr) ) {
-			destroy();
+			if( _buffer != nullptr ) {
+				_buffer->Release();
+				_buffer = nullptr;
+			}
 
 			if( E_INVALIDARG == hr ) {
 				return ErrorCode::CIRI_UNKNOWN_ERROR;
@@ -47,23 +130,4 @@ ErrorCode DXConstantBuffer::setData( int dataSize, void* data ) {
 	_device->getContext()->Unmap(_buffer, 0);
 
 	return ErrorCode::CIRI_OK;
-}
-
-void DXConstantBuffer::destroy() {
-	if( _buffer != nullptr ) {
-		_buffer->Release();
-		_buffer = nullptr;
-	}
-}
-
-ID3D11Buffer* DXConstantBuffer::getBuffer() const {
-	return _buffer;
-}
-
-void DXConstantBuffer::setIndex( int val ) {
-	_index = val;
-}
-
-int DXConstantBuffer::getIndex() const {
-	return _index;
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <ciri/graphics/win/dx/DXConstantRing.hpp>
+#include <cstring>
+
+using namespace ciri;
+
+DXConstantRing::DXConstantRing()
+	: _buffer(nullptr), _context1(nullptr), _size(0), _head(0), _epoch(0) {
+}
+
+DXConstantRing::~DXConstantRing() {
+	destroy();
+}
+
+bool DXConstantRing::create( ID3D11Device* device, ID3D11DeviceContext* context, int size ) {
+	destroy();
+
+	if( nullptr == device || nullptr == context || size <= 0 ) {
+		return false;
+	}
+
+	// offsets need both the 11.1 binding calls and NO_OVERWRITE maps of constant buffers
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(options));
+	if( FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ) {
+		return false;
+	}
+	if( !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer ) {
+		return false;
+	}
+	if( FAILED(context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&_context1))) ) {
+		_context1 = nullptr;
+		return false;
+	}
+
+	_size = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+
+	D3D11_BUFFER_DESC desc;
+	ZeroMemory(&desc, sizeof(desc));
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.ByteWidth = _size;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	if( FAILED(device->CreateBuffer(&desc, nullptr, &_buffer)) ) {
+		destroy();
+		return false;
+	}
+
+	// start on a wrap so the first allocation discards
+	_head = _size;
+	return true;
+}
+
+void DXConstantRing::destroy() {
+	if( _buffer != nullptr ) {
+		_buffer->Release();
+		_buffer = nullptr;
+	}
+	if( _context1 != nullptr ) {
+		_context1->Release();
+		_context1 = nullptr;
+	}
+	_size = 0;
+	_head = 0;
+	_epoch += 1;
+}
+
+bool DXConstantRing::allocate( const void* data, int dataSize, UINT* outFirstConstant, UINT* outNumConstants ) {
+	if( nullptr == _buffer || dataSize <= 0 ) {
+		return false;
+	}
+
+	const int alignedSize = ((dataSize + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	if( alignedSize > _size ) {
+		return false;
+	}
+
+	D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if( _head + alignedSize > _size ) {
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		_head = 0;
+		_epoch += 1;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE map;
+	if( FAILED(_context1->Map(_buffer, 0, mapType, 0, &map)) ) {
+		return false;
+	}
+	memcpy(static_cast<unsigned char*>(map.pData) + _head, data, dataSize);
+	_context1->Unmap(_buffer, 0);
+
+	*outFirstConstant = static_cast<UINT>(_head / 16);
+	*outNumConstants = static_cast<UINT>(alignedSize / 16);
+	_head += alignedSize;
+	return true;
+}
+
+unsigned int DXConstantRing::getEpoch() const {
+	return _epoch;
+}
+
+ID3D11Buffer* DXConstantRing::getBuffer() const {
+	return _buffer;
+}
+
+ID3D11DeviceContext1* DXConstantRing::getContext1() const {
+	return _context1;
+}
+
+bool DXConstantRing::isValid() const {
+	return _buffer != nullptr;
+}
\ No newline at end of file
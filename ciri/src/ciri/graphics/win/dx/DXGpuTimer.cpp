@@ -0,0 +1,204 @@
+#include <ciri/graphics/win/dx/DXGpuTimer.hpp>
+
+using namespace ciri;
+
+DXGpuTimer::Frame::Frame()
+	: disjoint(nullptr), anchor(nullptr), cpuTime(0), pending(false) {
+}
+
+DXGpuTimer::DXGpuTimer()
+	: _current(0), _droppedFrames(0) {
+}
+
+DXGpuTimer::~DXGpuTimer() {
+	destroy();
+}
+
+void DXGpuTimer::destroy() {
+	for( int i = 0; i < FRAME_LATENCY; ++i ) {
+		Frame& frame = _frames[i];
+		releaseQueries(frame);
+		frame.pending = false;
+		if( frame.disjoint != nullptr ) {
+			frame.disjoint->Release();
+			frame.disjoint = nullptr;
+		}
+	}
+	for( unsigned int i = 0; i < _freeQueries.size(); ++i ) {
+		_freeQueries[i]->Release();
+	}
+	_freeQueries.clear();
+	_open.clear();
+	_current = 0;
+}
+
+void DXGpuTimer::begin( ID3D11Device* device, ID3D11DeviceContext* context, const char* name ) {
+	if( !Profiler::isEnabled() ) {
+		_open.push_back(-1);
+		return;
+	}
+
+	Frame& frame = _frames[_current];
+	if( nullptr == frame.anchor ) {
+		if( nullptr == frame.disjoint ) {
+			D3D11_QUERY_DESC desc;
+			desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+			desc.MiscFlags = 0;
+			if( FAILED(device->CreateQuery(&desc, &frame.disjoint)) ) {
+				frame.disjoint = nullptr;
+			}
+		}
+		frame.anchor = acquireQuery(device);
+		if( nullptr == frame.disjoint || nullptr == frame.anchor ) {
+			releaseQueries(frame);
+			_open.push_back(-1);
+			return;
+		}
+		context->Begin(frame.disjoint);
+		context->End(frame.anchor);
+		frame.cpuTime = Profiler::now();
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.depth = static_cast<int>(_open.size());
+	scope.beginQuery = acquireQuery(device);
+	scope.endQuery = nullptr;
+	if( nullptr == scope.beginQuery ) {
+		_open.push_back(-1);
+		return;
+	}
+	context->End(scope.beginQuery);
+
+	_open.push_back(static_cast<int>(frame.scopes.size()));
+	frame.scopes.push_back(scope);
+}
+
+void DXGpuTimer::end( ID3D11Device* device, ID3D11DeviceContext* context ) {
+	if( _open.empty() ) {
+		return;
+	}
+	const int index = _open.back();
+	_open.pop_back();
+	if( -1 == index ) {
+		return;
+	}
+
+	Scope& scope = _frames[_current].scopes[index];
+	scope.endQuery = acquireQuery(device);
+	if( scope.endQuery != nullptr ) {
+		context->End(scope.endQuery);
+	}
+}
+
+void DXGpuTimer::endFrame( ID3D11DeviceContext* context ) {
+	_open.clear();
+	Frame& current = _frames[_current];
+	if( current.anchor != nullptr ) {
+		context->End(current.disjoint);
+		current.pending = true;
+	}
+	_current = (_current + 1) % FRAME_LATENCY;
+
+	// walk from the oldest frame (the slot about to be reused) to the newest; results finish in order, so stop at the first that is not ready
+	for( int i = 0; i < FRAME_LATENCY; ++i ) {
+		Frame& frame = _frames[(_current + i) % FRAME_LATENCY];
+		if( !frame.pending ) {
+			continue;
+		}
+
+		bool disjoint = false;
+		const bool resolved = tryResolveFrame(context, frame, &disjoint);
+		if( resolved || 0 == i ) {
+			// a slot needed for the next frame is dropped rather than waited on
+			if( !resolved || disjoint ) {
+				_droppedFrames += 1;
+			}
+			releaseQueries(frame);
+			frame.pending = false;
+			continue;
+		}
+		break;
+	}
+}
+
+int DXGpuTimer::getDroppedFrames() const {
+	return _droppedFrames;
+}
+
+ID3D11Query* DXGpuTimer::acquireQuery( ID3D11Device* device ) {
+	if( !_freeQueries.empty() ) {
+		ID3D11Query* query = _freeQueries.back();
+		_freeQueries.pop_back();
+		return query;
+	}
+
+	D3D11_QUERY_DESC desc;
+	desc.Query = D3D11_QUERY_TIMESTAMP;
+	desc.MiscFlags = 0;
+	ID3D11Query* query = nullptr;
+	if( FAILED(device->CreateQuery(&desc, &query)) ) {
+		return nullptr;
+	}
+	return query;
+}
+
+void DXGpuTimer::releaseQueries( Frame& frame ) {
+	for( unsigned int i = 0; i < frame.scopes.size(); ++i ) {
+		const Scope& scope = frame.scopes[i];
+		_freeQueries.push_back(scope.beginQuery);
+		if( scope.endQuery != nullptr ) {
+			_freeQueries.push_back(scope.endQuery);
+		}
+	}
+	frame.scopes.clear();
+	if( frame.anchor != nullptr ) {
+		_freeQueries.push_back(frame.anchor);
+		frame.anchor = nullptr;
+	}
+}
+
+bool DXGpuTimer::tryResolveFrame( ID3D11DeviceContext* context, Frame& frame, bool* outDisjoint ) {
+	*outDisjoint = false;
+
+	// the disjoint query ends after every timestamp in the frame, so once it is done they all are
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	if( context->GetData(frame.disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ) {
+		return false;
+	}
+	if( disjoint.Disjoint || 0 == disjoint.Frequency ) {
+		*outDisjoint = true;
+		return true;
+	}
+
+	UINT64 anchor = 0;
+	if( context->GetData(frame.anchor, &anchor, sizeof(anchor), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ) {
+		return false;
+	}
+	const double nsPerTick = 1000000000.0 / static_cast<double>(disjoint.Frequency);
+
+	_events.clear();
+	for( unsigned int i = 0; i < frame.scopes.size(); ++i ) {
+		const Scope& scope = frame.scopes[i];
+		if( nullptr == scope.endQuery ) {
+			continue; // abandoned at present
+		}
+
+		UINT64 begin = 0;
+		UINT64 end = 0;
+		if( context->GetData(scope.beginQuery, &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+				context->GetData(scope.endQuery, &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ) {
+			continue;
+		}
+
+		ProfileEvent event;
+		event.name = scope.name;
+		event.start = frame.cpuTime + static_cast<long long>(static_cast<double>(static_cast<long long>(begin - anchor)) * nsPerTick);
+		event.end = frame.cpuTime + static_cast<long long>(static_cast<double>(static_cast<long long>(end - anchor)) * nsPerTick);
+		event.depth = scope.depth;
+		event.thread = Profiler::GPU_THREAD;
+		_events.push_back(event);
+	}
+	Profiler::addGpuEvents(_events.data(), static_cast<int>(_events.size()));
+	return true;
+}
\ No newline at end of file
@@ -10,13 +10,25 @@
 #include <ciri/graphics/ClearFlags.hpp>
 #include <ciri/core/StrUtil.hpp>
 #include <ciri/graphics/win/dx/CiriToDx.hpp>
+#include <d3dcompiler.h>
 
 using namespace ciri;
 
+// shader resources and samplers are bound per stage, so each stage gets its own table in the state cache
+static const int STAGE_TABLE_VERTEX = 0;
+static const int STAGE_TABLE_GEOMETRY = 1;
+static const int STAGE_TABLE_PIXEL = 2;
+
 DXGraphicsDevice::DXGraphicsDevice()
 	: IGraphicsDevice(), _isValid(false), _window(nullptr), _swapchain(nullptr), _device(nullptr), _context(nullptr), _backbuffer(nullptr),
 		_defaultWidth(0), _defaultHeight(0),
-		_depthStencil(nullptr), _depthStencilView(nullptr), _shaderExt(".hlsl") {
+		_depthStencil(nullptr), _depthStencilView(nullptr), _constantRing(std::make_shared<DXConstantRing>()), _constantsDirty(false),
+		_shaderExt(".hlsl") {
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		_activeVertexStreams[i] = nullptr;
+	}
+	// bytecode does not depend on the gpu or driver, only on the compiler that made it
+	_shaderCache.setDriver("d3dcompiler " + std::to_string(D3D_COMPILER_VERSION));
 }
 
 DXGraphicsDevice::~DXGraphicsDevice() {
@@ -51,6 +63,9 @@ bool DXGraphicsDevice::create( const std::shared_ptr<IWindow>& window ) {
 
 	_isValid = true;
 
+	// nothing is known to be bound on a fresh context
+	_stateCache.invalidate();
+
 	// set default states
 	restoreDefaultStates();
 
@@ -73,11 +88,18 @@ void DXGraphicsDevice::destroy() {
 	_defaultDepthStencilDefault = nullptr;
 	_defaultDepthStencilDepthRead = nullptr;
 	_defaultDepthStencilNone = nullptr;
+	_pipelineCache.clear();
+	_constantRing->destroy();
+	_readbackRing.destroy();
+	_gpuTimer.destroy();
 
 	if( _depthStencil != nullptr ) { _depthStencil->Release(); _depthStencil = nullptr; }
 	if( _depthStencilView != nullptr ) { _depthStencilView->Release(); _depthStencilView = nullptr; }
 	if( _backbuffer ) { _backbuffer->Release(); _backbuffer = nullptr; }
 	if( _context )    { _context->ClearState(); _context = nullptr; }
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		_activeVertexStreams[i] = nullptr;
+	}
 	if( _swapchain )  { _swapchain->Release(); _swapchain = nullptr; }
 	if( _device )     { _device->Release(); _device = nullptr; }
 
@@ -90,6 +112,10 @@ void DXGraphicsDevice::present() {
 	}
 
 	_swapchain->Present(0, 0);
+
+	_stateCache.endFrame();
+	_readbackRing.poll(_context);
+	_gpuTimer.endFrame(_context);
 }
 
 void DXGraphicsDevice::setViewport( const Viewport& vp ) {
@@ -145,10 +171,31 @@ std::shared_ptr<IConstantBuffer> DXGraphicsDevice::createConstantBuffer() {
 		return nullptr;
 	}
 
-	std::shared_ptr<DXConstantBuffer> buffer = std::make_shared<DXConstantBuffer>(shared_from_this());
+	std::shared_ptr<DXConstantBuffer> buffer = std::make_shared<DXConstantBuffer>(shared_from_this(), _constantRing);
 	return buffer;
 }
 
+void DXGraphicsDevice::setConstantRingSize( int bytesPerFrame ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// buffers notice the ring is gone and fall back before their next draw
+	if( bytesPerFrame <= 0 ) {
+		_constantRing->destroy();
+		return;
+	}
+	// discard on wrap already keeps the gpu's copy alive, so one frame's worth is enough
+	_constantRing->create(_device, _context, bytesPerFrame);
+}
+
+bool DXGraphicsDevice::setShaderCacheDirectory( const char* directory ) {
+	if( !_isValid ) {
+		return false;
+	}
+	return _shaderCache.setDirectory(directory);
+}
+
 std::shared_ptr<ITexture2D> DXGraphicsDevice::createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels ) {
 	if( !_isValid ) {
 		return nullptr;
@@ -225,6 +272,11 @@ std::shared_ptr<IRenderTarget2D> DXGraphicsDevice::createRenderTarget2D( int wid
 		return nullptr;
 	}
 
+	// todo: render targets don't have depth views yet, so there is nothing for a depth-only target to be
+	if( TextureFormat::None == format ) {
+		return nullptr;
+	}
+
 	std::shared_ptr<DXTexture2D> texture = std::static_pointer_cast<DXTexture2D>(this->createTexture2D(width, height, format, TextureFlags::RenderTarget, nullptr));
 	if( nullptr == texture ) {
 		return nullptr;
@@ -282,19 +334,38 @@ std::shared_ptr<IBlendState> DXGraphicsDevice::createBlendState( const BlendDesc
 	return dxState;
 }
 
+std::shared_ptr<IPipelineState> DXGraphicsDevice::createPipelineState( const PipelineDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return _pipelineCache.create(this, desc);
+}
+
+std::shared_ptr<ICommandList> DXGraphicsDevice::createCommandList() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return std::make_shared<CommandList>();
+}
+
 void DXGraphicsDevice::applyShader( const std::shared_ptr<IShader>& shader ) {
 	if( !_isValid ) {
 		return;
 	}
 
 	if( nullptr == shader ) {
-		_context->VSSetShader(nullptr, nullptr, 0);
-		_context->GSSetShader(nullptr, nullptr, 0);
-		_context->PSSetShader(nullptr, nullptr, 0);
+		if( _stateCache.bindShader(shader, 0) ) {
+			_context->VSSetShader(nullptr, nullptr, 0);
+			_context->GSSetShader(nullptr, nullptr, 0);
+			_context->PSSetShader(nullptr, nullptr, 0);
+			_stateCache.invalidateVertexBuffer();
+		}
 		_activeShader.reset();
 		return;
 	}
 
+	// finishes a shader still compiling in the background; only blocks if it has not finished yet
+	shader->wait();
 	if( !shader->isValid() ) {
 		_activeShader.reset();
 		return;
@@ -302,40 +373,73 @@ void DXGraphicsDevice::applyShader( const std::shared_ptr<IShader>& shader ) {
 
 	const std::shared_ptr<DXShader> dxShader = std::static_pointer_cast<DXShader>(shader);
 
+	// shader and its constant buffers are all still bound
+	if( !_stateCache.bindShader(dxShader, reinterpret_cast<uintptr_t>(dxShader->getVertexShader())) ) {
+		_activeShader = dxShader;
+		return;
+	}
+	// input layout is set along with the vertex buffer and depends on the shader
+	_stateCache.invalidateVertexBuffer();
+
 	ID3D11VertexShader* vs = dxShader->getVertexShader();
 	_context->VSSetShader(vs, nullptr, 0);
-	const std::vector<std::shared_ptr<DXConstantBuffer>>& vertexConstants = dxShader->getVertexConstants();
-	for( unsigned int i = 0; i < vertexConstants.size(); ++i ) {
-		ID3D11Buffer* buffer = vertexConstants[i]->getBuffer();
-		const int index = vertexConstants[i]->getIndex();
-		_context->VSSetConstantBuffers(index, 1, &buffer);
-	}
 
 	ID3D11GeometryShader* gs = dxShader->getGeometryShader();
 	if( gs != nullptr ) {
 		_context->GSSetShader(gs, nullptr, 0);
-		const std::vector<std::shared_ptr<DXConstantBuffer>>& geometryConstants = dxShader->getGeometryConstants();
-		for( unsigned int i = 0; i < geometryConstants.size(); ++i ) {
-			ID3D11Buffer* buffer = geometryConstants[i]->getBuffer();
-			const int index = geometryConstants[i]->getIndex();
-			_context->GSSetConstantBuffers(index, 1, &buffer);
-		}
 	} else {
 		_context->GSSetShader(nullptr, nullptr, 0); // disable non-existent gs in case previous shader had it applied
 	}
 
 	ID3D11PixelShader* ps = dxShader->getPixelShader();
 	_context->PSSetShader(ps, nullptr, 0);
-	const std::vector<std::shared_ptr<DXConstantBuffer>>& pixelConstants = dxShader->getPixelConstants();
-	for( unsigned int i = 0; i < pixelConstants.size(); ++i ) {
-		ID3D11Buffer* buffer = pixelConstants[i]->getBuffer();
-		const int index = pixelConstants[i]->getIndex();
-		_context->PSSetConstantBuffers(index, 1, &buffer);
-	}
+
+	bindConstants(*dxShader);
+	_constantsDirty = false;
 
 	_activeShader = dxShader;
 }
 
+void DXGraphicsDevice::applyPipelineState( const std::shared_ptr<IPipelineState>& state ) {
+	if( !_isValid || nullptr == state ) {
+		return;
+	}
+
+	// each part goes through the state cache, so only what differs from the previous pipeline is applied
+	const std::shared_ptr<PipelineState> pipeline = std::static_pointer_cast<PipelineState>(state);
+	applyShader(pipeline->getShader());
+	setBlendState(pipeline->getBlendState());
+	setRasterizerState(pipeline->getRasterizerState());
+	setDepthStencilState(pipeline->getDepthStencilState());
+}
+
+void DXGraphicsDevice::executeCommandLists( ICommandList** lists, int count ) {
+	if( !_isValid || nullptr == lists ) {
+		return;
+	}
+
+	// lists are replayed through the immediate calls, so the state cache still filters what reaches d3d
+	for( int i = 0; i < count; ++i ) {
+		if( lists[i] != nullptr ) {
+			static_cast<CommandList*>(lists[i])->execute(this);
+		}
+	}
+}
+
+void DXGraphicsDevice::beginGpuScope( const char* name ) {
+	if( !_isValid ) {
+		return;
+	}
+	_gpuTimer.begin(_device, _context, name);
+}
+
+void DXGraphicsDevice::endGpuScope() {
+	if( !_isValid ) {
+		return;
+	}
+	_gpuTimer.end(_device, _context);
+}
+
 void DXGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) {
 	if( !_isValid ) {
 		return;
@@ -347,7 +451,9 @@ void DXGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& bu
 	}
 
 	if( nullptr == buffer ) {
-		_context->IASetVertexBuffers(0, 0, nullptr, nullptr, nullptr);
+		if( _stateCache.bindVertexBuffer(buffer, 0) ) {
+			_context->IASetVertexBuffers(0, 0, nullptr, nullptr, nullptr);
+		}
 		return;
 	}
 
@@ -358,22 +464,56 @@ void DXGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& bu
 	if( nullptr == vb ) {
 		return;
 	}
+	if( !_stateCache.bindVertexBuffer(dxBuffer, reinterpret_cast<uintptr_t>(vb)) ) {
+		_activeVertexBuffer = dxBuffer;
+		return;
+	}
 	_context->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
 
 	// set input layout here as current GL solution requires vertex array to be bound when setting vertex attributes (hence cannot set in applyShader)
 	ID3D11InputLayout* il = _activeShader.lock()->getInputLayout();
 	_context->IASetInputLayout(il);
+	_stateCache.countVertexInputBind();
 
 	_activeVertexBuffer = dxBuffer;
 }
 
+void DXGraphicsDevice::setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	if( numBuffers > VertexDeclaration::MAX_STREAMS ) {
+		numBuffers = VertexDeclaration::MAX_STREAMS;
+	}
+
+	setVertexBuffer((numBuffers > 0) ? buffers[0] : nullptr);
+
+	// secondary streams skip the state cache; instance data usually changes every draw anyway
+	for( int i = 1; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		ID3D11Buffer* vb = nullptr;
+		UINT stride = 0;
+		UINT offset = 0;
+		if( i < numBuffers && buffers[i] != nullptr ) {
+			vb = std::static_pointer_cast<DXVertexBuffer>(buffers[i])->getVertexBuffer();
+			stride = buffers[i]->getStride();
+		}
+		if( vb != _activeVertexStreams[i] ) {
+			_context->IASetVertexBuffers(i, 1, &vb, &stride, &offset);
+			_activeVertexStreams[i] = vb;
+		}
+	}
+}
+
 void DXGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) {
 	if( !_isValid ) {
 		return;
 	}
 
 	if( nullptr == buffer ) {
-		_context->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
+		if( _stateCache.bindIndexBuffer(buffer, 0) ) {
+			_context->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
+		}
 		return;
 	}
 
@@ -384,7 +524,9 @@ void DXGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buff
 		//_activeIndexBuffer.reset();
 		return; // todo: error
 	}
-	_context->IASetIndexBuffer(ib, DXGI_FORMAT_R32_UINT, 0);
+	if( _stateCache.bindIndexBuffer(dxBuffer, reinterpret_cast<uintptr_t>(ib)) ) {
+		_context->IASetIndexBuffer(ib, (IndexFormat::UInt16 == dxBuffer->getFormat()) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+	}
 
 	_activeIndexBuffer = dxBuffer;
 }
@@ -403,16 +545,7 @@ void DXGraphicsDevice::setTexture2D( int index, const std::shared_ptr<ITexture2D
 	// has to be an "array" to clear targets (if the input texture is nullptr) or dx shits its pants
 	ID3D11ShaderResourceView* srv[1] = { (texture != nullptr) ? dxTexture->getShaderResourceView() : nullptr };
 
-	const bool all = (shaderStage & ShaderStage::All) != 0;
-	if( all || (shaderStage & ShaderStage::Vertex) ) {
-		_context->VSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Geometry) ) {
-		_context->GSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Pixel) ) {
-		_context->PSSetShaderResources(index, 1, srv);
-	}
+	setShaderResource(index, srv, dxTexture, shaderStage);
 }
 
 void DXGraphicsDevice::setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) {
@@ -429,16 +562,7 @@ void DXGraphicsDevice::setTexture3D( int index, const std::shared_ptr<ITexture3D
 	// has to be an "array" to clear targets (if the input texture is nullptr) or dx shits its pants
 	ID3D11ShaderResourceView* srv[1] = { (texture != nullptr) ? dxTexture->getShaderResourceView() : nullptr };
 
-	const bool all = (shaderStage & ShaderStage::All) != 0;
-	if( all || (shaderStage & ShaderStage::Vertex) ) {
-		_context->VSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Geometry) ) {
-		_context->GSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Pixel) ) {
-		_context->PSSetShaderResources(index, 1, srv);
-	}
+	setShaderResource(index, srv, dxTexture, shaderStage);
 }
 
 void DXGraphicsDevice::setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) {
@@ -450,16 +574,7 @@ void DXGraphicsDevice::setTextureCube( int index, const std::shared_ptr<ITexture
 
 	ID3D11ShaderResourceView* srv[1] = { (texture != nullptr) ? dxTexture->getShaderResourceView() : nullptr };
 
-	const bool all = (shaderStage & ShaderStage::All) != 0;
-	if( all || (shaderStage & ShaderStage::Vertex) ) {
-		_context->VSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Geometry) ) {
-		_context->GSSetShaderResources(index, 1, srv);
-	}
-	if( all || (shaderStage & ShaderStage::Pixel) ) {
-		_context->PSSetShaderResources(index, 1, srv);
-	}
+	setShaderResource(index, srv, dxTexture, shaderStage);
 }
 
 void DXGraphicsDevice::setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) {
@@ -472,14 +587,15 @@ void DXGraphicsDevice::setSamplerState( int index, const std::shared_ptr<ISample
 	// has to be an "array" to clear targets (if the input texture is nullptr) or dx shits its pants
 	ID3D11SamplerState* sampler[1] = { (state != nullptr) ? dxSampler->getSamplerState() : nullptr };
 
+	const uintptr_t handle = reinterpret_cast<uintptr_t>(sampler[0]);
 	const bool all = (shaderStage & ShaderStage::All) != 0;
-	if( all || (shaderStage & ShaderStage::Vertex) ) {
+	if( (all || (shaderStage & ShaderStage::Vertex)) && _stateCache.bindSampler(STAGE_TABLE_VERTEX, index, dxSampler, handle) ) {
 		_context->VSSetSamplers(index, 1, sampler);
 	}
-	if( all || (shaderStage & ShaderStage::Geometry) ) {
+	if( (all || (shaderStage & ShaderStage::Geometry)) && _stateCache.bindSampler(STAGE_TABLE_GEOMETRY, index, dxSampler, handle) ) {
 		_context->GSSetSamplers(index, 1, sampler);
 	}
-	if( all || (shaderStage & ShaderStage::Pixel) ) {
+	if( (all || (shaderStage & ShaderStage::Pixel)) && _stateCache.bindSampler(STAGE_TABLE_PIXEL, index, dxSampler, handle) ) {
 		_context->PSSetSamplers(index, 1, sampler);
 	}
 }
@@ -497,6 +613,9 @@ void DXGraphicsDevice::setBlendState( const std::shared_ptr<IBlendState>& state
 
 	const std::shared_ptr<DXBlendState> dxState = std::static_pointer_cast<DXBlendState>(state);
 	ID3D11BlendState* bs = dxState->getBlendState();
+	if( !_stateCache.bindBlendState(dxState, reinterpret_cast<uintptr_t>(bs)) ) {
+		return;
+	}
 	_context->OMSetBlendState(bs, dxState->getDesc().blendFactor, 0xffffffff); // todo: sample mask support?
 }
 
@@ -525,11 +644,12 @@ void DXGraphicsDevice::drawArrays( PrimitiveTopology topology, int vertexCount,
 		//return;
 	//}
 
+	prepareConstants();
 	_context->IASetPrimitiveTopology(ciriToDxTopology(topology));
 	_context->Draw(vertexCount, startIndex);
 }
 
-void DXGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount ) {
+void DXGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) {
 	if( !_isValid ) {
 		return;
 	}
@@ -545,12 +665,51 @@ void DXGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount )
 	}
 
 	// index count must be greater than 0
-	if( indexCount <= 0 ) {
+	if( indexCount <= 0 || startIndex < 0 ) {
 		return; // todo: error
 	}
 
+	prepareConstants();
+	_context->IASetPrimitiveTopology(ciriToDxTopology(topology));
+	_context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void DXGraphicsDevice::drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// cannot draw with no active shader or vertex buffer
+	if( _activeShader.expired() || _activeVertexBuffer.expired() ) {
+		return;
+	}
+
+	if( vertexCount <= 0 || instanceCount <= 0 ) {
+		return;
+	}
+
+	prepareConstants();
+	_context->IASetPrimitiveTopology(ciriToDxTopology(topology));
+	_context->DrawInstanced(vertexCount, instanceCount, startIndex, 0);
+}
+
+void DXGraphicsDevice::drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// cannot draw with no active shader or without a valid vertex and index buffer
+	if( _activeShader.expired() || _activeVertexBuffer.expired() || _activeIndexBuffer.expired() ) {
+		return;
+	}
+
+	if( indexCount <= 0 || instanceCount <= 0 ) {
+		return;
+	}
+
+	prepareConstants();
 	_context->IASetPrimitiveTopology(ciriToDxTopology(topology));
-	_context->DrawIndexed(indexCount, 0, 0);
+	_context->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
 }
 	
 void DXGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) {
@@ -571,6 +730,9 @@ void DXGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int nu
 	//       as by convention, they should all have the same format depth target
 	_context->OMSetRenderTargets(numRenderTargets, _activeRenderTargets, nullptr);
 
+	// d3d silently unbinds shader resources that alias new outputs and refuses to bind ones that alias current outputs
+	_stateCache.invalidateTextures();
+
 	setViewport(Viewport(0, 0, renderTargets[0]->getTexture()->getWidth(), renderTargets[0]->getTexture()->getHeight()));
 }
 
@@ -583,6 +745,7 @@ void DXGraphicsDevice::restoreDefaultRenderTargets() {
 		_activeRenderTargets[i] = nullptr;
 	}
 	_context->OMSetRenderTargets(1, &_backbuffer, _depthStencilView);
+	_stateCache.invalidateTextures();
 
 	setViewport(Viewport(0, 0, _defaultWidth, _defaultHeight));
 }
@@ -652,6 +815,8 @@ ErrorCode DXGraphicsDevice::resizeTexture2D( const std::shared_ptr<ITexture2D>&
 		return ErrorCode::CIRI_UNKNOWN_ERROR;
 	}
 
+	_stateCache.invalidateTextures();
+
 	dxTexture->destroy();
 	return dxTexture->setData(0, 0, width, height, nullptr, dxTexture->getFormat());
 }
@@ -744,11 +909,10 @@ void DXGraphicsDevice::setRasterizerState( const std::shared_ptr<IRasterizerStat
 	}
 
 	const std::shared_ptr<DXRasterizerState> dxRaster = std::static_pointer_cast<DXRasterizerState>(state);
-	if( !_activeRasterizerState.expired() && (dxRaster == _activeRasterizerState.lock()) ) {
+	ID3D11RasterizerState* dxState = dxRaster->getRasterizerState();
+	if( !_stateCache.bindRasterizerState(dxRaster, reinterpret_cast<uintptr_t>(dxState)) ) {
 		return;
 	}
-	_activeRasterizerState = dxRaster;
-	ID3D11RasterizerState* dxState = dxRaster->getRasterizerState();
 	_context->RSSetState(dxState);
 }
 
@@ -763,11 +927,10 @@ void DXGraphicsDevice::setDepthStencilState( const std::shared_ptr<IDepthStencil
 	}
 
 	const std::shared_ptr<DXDepthStencilState> dxState = std::static_pointer_cast<DXDepthStencilState>(state);
-	if( !_activeDepthStencilState.expired() && (dxState == _activeDepthStencilState.lock()) ) {
+	ID3D11DepthStencilState* dxDepthStencilState = dxState->getState();
+	if( !_stateCache.bindDepthStencilState(dxState, reinterpret_cast<uintptr_t>(dxDepthStencilState)) ) {
 		return;
 	}
-	_activeDepthStencilState = dxState;
-	ID3D11DepthStencilState* dxDepthStencilState = dxState->getState();
 	_context->OMSetDepthStencilState(dxDepthStencilState, dxState->getStencilRef());
 }
 
@@ -795,6 +958,22 @@ GraphicsApiType DXGraphicsDevice::getApiType() const {
 	return GraphicsApiType::DirectX11;
 }
 
+int DXGraphicsDevice::getRedundantCallCount() const {
+	return _stateCache.getRedundantCallCount();
+}
+
+int DXGraphicsDevice::getStateChangeCount() const {
+	return _stateCache.getStateChangeCount();
+}
+
+int DXGraphicsDevice::getVertexAttributeSetupCount() const {
+	return _stateCache.getVertexAttributeSetupCount();
+}
+
+int DXGraphicsDevice::getVertexInputBindCount() const {
+	return _stateCache.getVertexInputBindCount();
+}
+
 ErrorCode DXGraphicsDevice::restoreDefaultStates() {
 	// restore blend state
 	ErrorCode status = restoreDefaultBlendState();
@@ -938,10 +1117,122 @@ ID3D11Device* DXGraphicsDevice::getDevice() const {
 	return _device;
 }
 
+void DXGraphicsDevice::invalidateConstants() {
+	_constantsDirty = true;
+}
+
+DXReadbackRing& DXGraphicsDevice::getReadbackRing() {
+	return _readbackRing;
+}
+
+ShaderCache& DXGraphicsDevice::getShaderCache() {
+	return _shaderCache;
+}
+
 ID3D11DeviceContext* DXGraphicsDevice::getContext() const {
 	return _context;
 }
 
+void DXGraphicsDevice::setShaderResource( int index, ID3D11ShaderResourceView** srv, const std::shared_ptr<void>& texture, ShaderStage::Stage shaderStage ) {
+	const uintptr_t handle = reinterpret_cast<uintptr_t>(srv[0]);
+	const bool all = (shaderStage & ShaderStage::All) != 0;
+	if( (all || (shaderStage & ShaderStage::Vertex)) && _stateCache.bindTexture(STAGE_TABLE_VERTEX, index, texture, handle) ) {
+		_context->VSSetShaderResources(index, 1, srv);
+	}
+	if( (all || (shaderStage & ShaderStage::Geometry)) && _stateCache.bindTexture(STAGE_TABLE_GEOMETRY, index, texture, handle) ) {
+		_context->GSSetShaderResources(index, 1, srv);
+	}
+	if( (all || (shaderStage & ShaderStage::Pixel)) && _stateCache.bindTexture(STAGE_TABLE_PIXEL, index, texture, handle) ) {
+		_context->PSSetShaderResources(index, 1, srv);
+	}
+}
+
+void DXGraphicsDevice::prepareConstants() {
+	const std::shared_ptr<DXShader> shader = _activeShader.lock();
+
+	// moving one buffer forward can wrap the ring under another, so go again if the epoch moved; a second wrap needs more data than the ring holds
+	for( int pass = 0; pass < 2; ++pass ) {
+		const unsigned int epoch = _constantRing->getEpoch();
+		const std::vector<std::shared_ptr<DXConstantBuffer>>* stages[3] = { &shader->getVertexConstants(), &shader->getGeometryConstants(), &shader->getPixelConstants() };
+		for( int stage = 0; stage < 3; ++stage ) {
+			for( unsigned int i = 0; i < stages[stage]->size(); ++i ) {
+				if( (*stages[stage])[i]->refresh() ) {
+					_constantsDirty = true;
+				}
+			}
+		}
+		if( epoch == _constantRing->getEpoch() ) {
+			break;
+		}
+	}
+
+	if( _constantsDirty ) {
+		bindConstants(*shader);
+		_constantsDirty = false;
+	}
+}
+
+void DXGraphicsDevice::bindConstants( const DXShader& shader ) {
+	const std::vector<std::shared_ptr<DXConstantBuffer>>& vertexConstants = shader.getVertexConstants();
+	for( unsigned int i = 0; i < vertexConstants.size(); ++i ) {
+		bindConstantBuffer(ShaderStage::Vertex, *vertexConstants[i]);
+	}
+
+	if( shader.getGeometryShader() != nullptr ) {
+		const std::vector<std::shared_ptr<DXConstantBuffer>>& geometryConstants = shader.getGeometryConstants();
+		for( unsigned int i = 0; i < geometryConstants.size(); ++i ) {
+			bindConstantBuffer(ShaderStage::Geometry, *geometryConstants[i]);
+		}
+	}
+
+	const std::vector<std::shared_ptr<DXConstantBuffer>>& pixelConstants = shader.getPixelConstants();
+	for( unsigned int i = 0; i < pixelConstants.size(); ++i ) {
+		bindConstantBuffer(ShaderStage::Pixel, *pixelConstants[i]);
+	}
+}
+
+void DXGraphicsDevice::bindConstantBuffer( ShaderStage::Stage stage, const DXConstantBuffer& buffer ) {
+	ID3D11Buffer* dxBuffer = buffer.getBuffer();
+	const UINT index = static_cast<UINT>(buffer.getIndex());
+
+	if( !buffer.isInRing() ) {
+		switch( stage ) {
+			case ShaderStage::Vertex: {
+				_context->VSSetConstantBuffers(index, 1, &dxBuffer);
+				break;
+			}
+			case ShaderStage::Geometry: {
+				_context->GSSetConstantBuffers(index, 1, &dxBuffer);
+				break;
+			}
+			default: {
+				_context->PSSetConstantBuffers(index, 1, &dxBuffer);
+				break;
+			}
+		}
+		return;
+	}
+
+	// ring ranges are bound by offset, in units of 16 byte constants
+	ID3D11DeviceContext1* context1 = _constantRing->getContext1();
+	const UINT first = buffer.getFirstConstant();
+	const UINT count = buffer.getNumConstants();
+	switch( stage ) {
+		case ShaderStage::Vertex: {
+			context1->VSSetConstantBuffers1(index, 1, &dxBuffer, &first, &count);
+			break;
+		}
+		case ShaderStage::Geometry: {
+			context1->GSSetConstantBuffers1(index, 1, &dxBuffer, &first, &count);
+			break;
+		}
+		default: {
+			context1->PSSetConstantBuffers1(index, 1, &dxBuffer, &first, &count);
+			break;
+		}
+	}
+}
+
 bool DXGraphicsDevice::initDevice( unsigned int width, unsigned int height, HWND hwnd ) {
 	HRESULT hr = S_OK;
 
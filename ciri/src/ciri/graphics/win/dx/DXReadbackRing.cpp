@@ -0,0 +1,186 @@
+#include <ciri/graphics/win/dx/DXReadbackRing.hpp>
+#include <cstring>
+
+using namespace ciri;
+
+DXReadbackRing::Slot::Slot()
+	: staging(nullptr), busy(false) {
+	ZeroMemory(&desc, sizeof(desc));
+}
+
+DXReadbackRing::DXReadbackRing()
+	: _pending(0) {
+}
+
+DXReadbackRing::~DXReadbackRing() {
+	destroy();
+}
+
+void DXReadbackRing::destroy() {
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		Slot& slot = _slots[i];
+		if( slot.busy ) {
+			slot.busy = false;
+			ReadbackWorker::fail(slot.job, ErrorCode::CIRI_UNKNOWN_ERROR);
+		}
+		if( slot.staging != nullptr ) {
+			slot.staging->Release();
+			slot.staging = nullptr;
+		}
+	}
+	_slots.clear();
+	_pending = 0;
+
+	_worker.stop();
+}
+
+std::future<TextureReadback> DXReadbackRing::read( ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture, TextureFormat::Format format, int width, int height ) {
+	if( nullptr == device || nullptr == context || nullptr == texture || width <= 0 || height <= 0 ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+
+	PixelConversion::Source source = PixelConversion::RGBA8;
+	int shift = 0;
+	if( !getReadFormat(format, &source, &shift) ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_NOT_IMPLEMENTED);
+	}
+
+	// only the top mip is read, so the staging texture has none of the source's mips, binds, or misc flags
+	D3D11_TEXTURE2D_DESC desc;
+	texture->GetDesc(&desc);
+	if( desc.SampleDesc.Count > 1 ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_NOT_IMPLEMENTED);
+	}
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	desc.MiscFlags = 0;
+
+	const int index = acquireSlot(device, desc);
+	if( -1 == index ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_BUFFER_CREATION_FAILED);
+	}
+	Slot& slot = _slots[index];
+	context->CopySubresourceRegion(slot.staging, 0, 0, 0, 0, texture, 0, nullptr);
+
+	slot.busy = true;
+	slot.job = ReadbackJob();
+	slot.job.source = source;
+	slot.job.shift = shift;
+	slot.job.width = width;
+	slot.job.height = height;
+	slot.job.rowPitch = width * PixelConversion::bytesPerTexel(source);
+	slot.job.flip = true; // d3d's rows are top to bottom
+	_pending += 1;
+	return slot.job.promise.get_future();
+}
+
+void DXReadbackRing::poll( ID3D11DeviceContext* context, bool wait ) {
+	if( 0 == _pending || nullptr == context ) {
+		return;
+	}
+
+	const UINT mapFlags = wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT;
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		Slot& slot = _slots[i];
+		if( !slot.busy ) {
+			continue;
+		}
+
+		D3D11_MAPPED_SUBRESOURCE map;
+		const HRESULT hr = context->Map(slot.staging, 0, D3D11_MAP_READ, mapFlags, &map);
+		if( DXGI_ERROR_WAS_STILL_DRAWING == hr ) {
+			continue;
+		}
+		slot.busy = false;
+		_pending -= 1;
+
+		if( FAILED(hr) ) {
+			ReadbackWorker::fail(slot.job, ErrorCode::CIRI_BUFFER_MAP_FAILED);
+			continue;
+		}
+
+		// rows are padded to the driver's pitch; keep them tight so the worker need not know about it
+		const int rowBytes = slot.job.rowPitch;
+		slot.job.data.resize(static_cast<size_t>(rowBytes) * slot.job.height);
+		const unsigned char* src = static_cast<const unsigned char*>(map.pData);
+		for( int row = 0; row < slot.job.height; ++row ) {
+			memcpy(slot.job.data.data() + static_cast<size_t>(row) * rowBytes, src + static_cast<size_t>(row) * map.RowPitch, rowBytes);
+		}
+		context->Unmap(slot.staging, 0);
+		_worker.submit(std::move(slot.job));
+	}
+}
+
+int DXReadbackRing::getPendingCount() const {
+	return _pending;
+}
+
+bool DXReadbackRing::getReadFormat( TextureFormat::Format format, PixelConversion::Source* outSource, int* outShift ) {
+	*outShift = 0;
+
+	switch( format ) {
+		case TextureFormat::RGBA32_UINT: {
+			*outSource = PixelConversion::RGBA8;
+			return true;
+		}
+
+		case TextureFormat::RGBA32_Float: {
+			*outSource = PixelConversion::RGBA32F;
+			return true;
+		}
+
+		case TextureFormat::R32_UINT: {
+			// a real 32 bit integer in d3d; keep the low byte
+			*outSource = PixelConversion::UInt32;
+			return true;
+		}
+
+		case TextureFormat::R32_FLOAT: {
+			*outSource = PixelConversion::R32F;
+			return true;
+		}
+
+		default: {
+			// depth textures are not yet created by the d3d backend
+			return false;
+		}
+	}
+}
+
+int DXReadbackRing::acquireSlot( ID3D11Device* device, const D3D11_TEXTURE2D_DESC& desc ) {
+	// prefer an idle texture of the same size and format, then replace any idle texture, then add one
+	int idle = -1;
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		const Slot& slot = _slots[i];
+		if( slot.busy ) {
+			continue;
+		}
+		if( slot.desc.Width == desc.Width && slot.desc.Height == desc.Height && slot.desc.Format == desc.Format ) {
+			return static_cast<int>(i);
+		}
+		if( -1 == idle ) {
+			idle = static_cast<int>(i);
+		}
+	}
+
+	if( -1 == idle ) {
+		_slots.push_back(Slot());
+		idle = static_cast<int>(_slots.size()) - 1;
+	}
+
+	Slot& slot = _slots[idle];
+	if( slot.staging != nullptr ) {
+		slot.staging->Release();
+		slot.staging = nullptr;
+	}
+	slot.desc = desc;
+	if( FAILED(device->CreateTexture2D(&desc, nullptr, &slot.staging)) ) {
+		slot.staging = nullptr;
+		ZeroMemory(&slot.desc, sizeof(slot.desc));
+		return -1;
+	}
+	return idle;
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <ciri/graphics/win/dx/DXRenderTarget2D.hpp>
 #include <ciri/graphics/win/dx/DXGraphicsDevice.hpp>
 #include <ciri/graphics/win/dx/DXTexture2D.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
 
 using namespace ciri;
 
@@ -56,6 +57,13 @@ std::shared_ptr<ITexture2D> DXRenderTarget2D::getDepth() const {
 	throw;
 }
 
+std::future<TextureReadback> DXRenderTarget2D::readAsync() {
+	if( nullptr == _texture ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+	return _texture->readAsync();
+}
+
 ID3D11RenderTargetView* DXRenderTarget2D::getRenderTargetView() const {
 	return _renderTargetView;
 }
\ No newline at end of file
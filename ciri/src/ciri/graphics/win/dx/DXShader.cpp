@@ -2,13 +2,15 @@
 #include <ciri/graphics/win/dx/DXGraphicsDevice.hpp>
 #include <ciri/graphics/win/dx/DXConstantBuffer.hpp>
 #include <ciri/graphics/win/dx/CiriToDx.hpp>
-#include <ciri/core/File.hpp>
+#include <ciri/core/FileSystem.hpp>
 #include <d3dcompiler.h>
+#include <chrono>
+#include <cstring>
 
 using namespace ciri;
 
 DXShader::DXShader( const std::shared_ptr<DXGraphicsDevice>& device )
-	: IShader(), _device(device), _vertexShader(nullptr), _geometryShader(nullptr), _pixelShader(nullptr), _inputLayout(nullptr) {
+	: IShader(), _device(device), _cacheKey(0), _vertexShader(nullptr), _geometryShader(nullptr), _pixelShader(nullptr), _inputLayout(nullptr) {
 	_dxUsageStrings[VertexUsage::Position] = "POSITION";
 	_dxUsageStrings[VertexUsage::Color] = "COLOR";
 	_dxUsageStrings[VertexUsage::Texcoord] = "TEXCOORD";
@@ -29,6 +31,16 @@ ErrorCode DXShader::addConstants( const std::shared_ptr<IConstantBuffer>& buffer
 		return ErrorCode::CIRI_INVALID_ARGUMENT;
 	}
 
+	// buffer indices are only known once reflected
+	if( _compile.valid() ) {
+		DeferredConstants deferred;
+		deferred.buffer = buffer;
+		deferred.name = name;
+		deferred.shaderTypeFlags = shaderTypeFlags;
+		_deferredConstants.push_back(deferred);
+		return ErrorCode::CIRI_OK;
+	}
+
 	if( !isValid() ) {
 		return ErrorCode::CIRI_SHADER_INVALID;
 	}
@@ -90,8 +102,8 @@ ErrorCode DXShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	}
 
 	// load vs file
-	File vsFile(vs, File::Flags::ReadOnly);
-	if( !vsFile.isOpen() ) {
+	const FileData vsFile = FileSystem::read(vs);
+	if( !vsFile.isValid() ) {
 		addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + vs + std::string(")"));
 		return ErrorCode::CIRI_FILE_NOT_FOUND;
 	}
@@ -100,8 +112,8 @@ ErrorCode DXShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	// load gs file
 	std::string gsStr = ""; // optional shader, so create empty string for it now
 	if( gs != nullptr ) {
-		File gsFile(gs, File::Flags::ReadOnly);
-		if( !gsFile.isOpen() ) {
+		const FileData gsFile = FileSystem::read(gs);
+		if( !gsFile.isValid() ) {
 			addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + gs + std::string(")"));
 			return ErrorCode::CIRI_FILE_NOT_FOUND;
 		}
@@ -109,8 +121,8 @@ ErrorCode DXShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	}
 
 	// load ps file
-	File psFile(ps, File::Flags::ReadOnly);
-	if( !psFile.isOpen() ) {
+	const FileData psFile = FileSystem::read(ps);
+	if( !psFile.isValid() ) {
 		addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + ps + std::string(")"));
 		return ErrorCode::CIRI_FILE_NOT_FOUND;
 	}
@@ -123,6 +135,8 @@ ErrorCode DXShader::loadFromMemory( const char* vs, const char* gs, const char*
 	// todo: if valid, destroy and make new one
 
 	clearErrors();
+	_deferredConstants.clear();
+	_compile = std::shared_future<CompiledStages>();
 
 	// must have at least VS and PS
 	if( nullptr == vs || nullptr == ps ) {
@@ -130,146 +144,34 @@ ErrorCode DXShader::loadFromMemory( const char* vs, const char* gs, const char*
 		return ErrorCode::CIRI_SHADER_INCOMPLETE;
 	}
 
-	HRESULT hr = S_OK;
-
 	UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
 	#if defined(_DEBUG)
 		flags |= D3DCOMPILE_DEBUG;
 	#endif
 
-	ID3DBlob* shaderBlob = nullptr;
-	ID3DBlob* errorBlob = nullptr;
-
-	// todo: change all unknown errors below to proper error codes
-
-	// build the vertex shader
-	{
-		hr = D3DCompile(vs, strlen(vs), NULL, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", "vs_5_0", flags, 0, &shaderBlob, &errorBlob);
-		if( FAILED(hr) ) {
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-		} else {
-			hr = _device->getDevice()->CreateVertexShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &_vertexShader);
-			if( FAILED(hr) ) {
-				addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-			} else {
-				// build the input layout
-				int offset = 0;
-				const std::vector<VertexElement>& elements = _vertexDeclaration.getElements();
-				D3D11_INPUT_ELEMENT_DESC* layout = new D3D11_INPUT_ELEMENT_DESC[elements.size()];
-				for( unsigned int i = 0; i < elements.size(); ++i ) {
-					layout[i].SemanticName = _dxUsageStrings[elements[i].getUsage()].c_str();
-					layout[i].SemanticIndex = elements[i].getUsageIndex();
-					layout[i].Format = ciriToDxVertexFormat(elements[i].getFormat());
-					layout[i].InputSlot = 0;
-					layout[i].AlignedByteOffset = offset;
-					layout[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-					layout[i].InstanceDataStepRate = 0;
-					offset += elements[i].getSize(); // sizeof(datatype) * numberOfThem;
-				}
-				hr = _device->getDevice()->CreateInputLayout(layout, elements.size(), shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), &_inputLayout);
-				delete[] layout; layout = nullptr;
-				if( FAILED(hr) ) {
-					if( errorBlob != nullptr ) {
-						addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-					} else {
-						addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": Unknown error.\n"));
-					}
-				} else {
-					// reflect the constant buffers of the vertex shader
-					ID3D11ShaderReflection* refl = nullptr;
-					D3DReflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), IID_ID3D11ShaderReflection, (void**)&refl);
-					int index = 0;
-					while( true ) {
-						D3D11_SHADER_BUFFER_DESC desc;
-						if( FAILED(refl->GetConstantBufferByIndex(index)->GetDesc(&desc)) ) {
-							break;
-						}
-
-						_vertexConstantBufferIndices[std::string(desc.Name)] = index;
-
-						index += 1;
-					}
-				} // CreateInputLayout success
-			} // CreateVertexShader success
-		} // D3DCompile success
-
-		// release shader and error blobs
-		if( shaderBlob != nullptr ) { shaderBlob->Release(); shaderBlob = nullptr; }
-		if( errorBlob != nullptr ) { errorBlob->Release(); errorBlob = nullptr; }
-	}
-
-	// build the geometry shader
-	if( gs != nullptr ) {
-		hr = D3DCompile(gs, strlen(gs), NULL, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", "gs_5_0", flags, 0, &shaderBlob, &errorBlob);
-		if( FAILED(hr) ) {
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-		} else {
-			hr = _device->getDevice()->CreateGeometryShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &_geometryShader);
-			if( FAILED(hr) ) {
-				addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-			} else {
-				// reflect the constant buffers of the geometry shader
-				ID3D11ShaderReflection* refl = nullptr;
-				D3DReflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), IID_ID3D11ShaderReflection, (void**)&refl);
-				int index = 0;
-				while( true ) {
-					D3D11_SHADER_BUFFER_DESC desc;
-					if( FAILED(refl->GetConstantBufferByIndex(index)->GetDesc(&desc)) ) {
-						break;
-					}
-					_geometryConstantBufferIndices[std::string(desc.Name)] = index;
-
-					index += 1;
-				}
-			} // CreateGeometryShader success
-		} // D3DCompile success
-
-		// release shader and error blobs
-		if( shaderBlob != nullptr ) { shaderBlob->Release(); shaderBlob = nullptr; }
-		if( errorBlob != nullptr ) { errorBlob->Release(); errorBlob = nullptr; }
-	}
-
-	// build the pixel shader
-	{
-		hr = D3DCompile(ps, strlen(ps), NULL, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", "ps_5_0", flags, 0, &shaderBlob, &errorBlob);
-		if( FAILED(hr) ) {
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-		} else {
-			hr = _device->getDevice()->CreatePixelShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &_pixelShader);
-			if( FAILED(hr) ) {
-				addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": ") + std::string((const char*)errorBlob->GetBufferPointer()));
-			} else {
-				// reflect the constant buffers of the pixel shader
-				ID3D11ShaderReflection* refl = nullptr;
-				D3DReflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), IID_ID3D11ShaderReflection, (void**)&refl);
-				int index = 0;
-				while( true ) {
-					D3D11_SHADER_BUFFER_DESC desc;
-					if( FAILED(refl->GetConstantBufferByIndex(index)->GetDesc(&desc)) ) {
-						break;
-					}
-					_pixelConstantBufferIndices[std::string(desc.Name)] = index;
-
-					index += 1;
-				}
-			} // CreatePixelShader success
-		} // D3DCompile success
-
-		// release shader and error blobs
-		if( shaderBlob != nullptr ) { shaderBlob->Release(); shaderBlob = nullptr; }
-		if( errorBlob != nullptr ) { errorBlob->Release(); errorBlob = nullptr; }
-	}
-
-	// if any errors have occurred, clean up and return the first error code
-	if( !_errors.empty() ) {
-		destroy();
-		return _errors[0].code;
+	// bytecode from the cache only needs the shader objects creating
+	ShaderCache& cache = _device->getShaderCache();
+	_cacheKey = cache.makeKey(vs, gs, ps, flags);
+	std::vector<char> data;
+	CompiledStages cached;
+	if( cache.load(_cacheKey, data) && unpackStages(data, cached) ) {
+		if( !failed(createStages(cached)) ) {
+			return ErrorCode::CIRI_OK;
+		}
+		// the runtime rejected it; compile it instead
+		clearErrors();
+		cache.remove(_cacheKey);
 	}
 
+	// the worker gets its own copies of the sources, as the caller's may not outlive this call
+	_compile = std::async(std::launch::async, &DXShader::compileStages, std::string(vs), (gs != nullptr) ? std::string(gs) : std::string(), std::string(ps), flags).share();
 	return ErrorCode::CIRI_OK;
 }
 
 void DXShader::destroy() {
+	// waits for a compile still in progress
+	_compile = std::shared_future<CompiledStages>();
+	_deferredConstants.clear();
 	_vertexConstantBufferIndices.clear();
 	_geometryConstantBufferIndices.clear();
 	_pixelConstantBufferIndices.clear();
@@ -304,9 +206,28 @@ const std::vector<IShader::ShaderError>& DXShader::getErrors() const {
 }
 
 bool DXShader::isValid() const {
+	if( _compile.valid() ) {
+		return (std::future_status::ready == _compile.wait_for(std::chrono::seconds(0))) && _compile.get().errors.empty();
+	}
 	return (_vertexShader != nullptr) && (_pixelShader != nullptr);
 }
 
+bool DXShader::isPending() const {
+	return _compile.valid() && (_compile.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+}
+
+ErrorCode DXShader::wait() {
+	if( _compile.valid() ) {
+		const std::shared_future<CompiledStages> compile = _compile;
+		_compile = std::shared_future<CompiledStages>();
+		finish(compile.get());
+	}
+	if( !_errors.empty() ) {
+		return _errors[0].code;
+	}
+	return isValid() ? ErrorCode::CIRI_OK : ErrorCode::CIRI_SHADER_INVALID;
+}
+
 ID3D11VertexShader* DXShader::getVertexShader() const {
 	return _vertexShader;
 }
@@ -341,4 +262,169 @@ void DXShader::addError( ErrorCode code, const std::string& msg ) {
 
 void DXShader::clearErrors() {
 	_errors.clear();
+}
+
+DXShader::CompiledStages DXShader::compileStages( const std::string& vs, const std::string& gs, const std::string& ps, UINT flags ) {
+	// runs on a worker thread, so it must only touch its arguments
+	CompiledStages stages;
+	compileStage(vs, "vs_5_0", flags, stages.vs, stages.errors);
+	if( !gs.empty() ) {
+		compileStage(gs, "gs_5_0", flags, stages.gs, stages.errors);
+	}
+	compileStage(ps, "ps_5_0", flags, stages.ps, stages.errors);
+	return stages;
+}
+
+bool DXShader::compileStage( const std::string& source, const char* target, UINT flags, std::vector<char>& outBytecode, std::vector<ShaderError>& outErrors ) {
+	ID3DBlob* shaderBlob = nullptr;
+	ID3DBlob* errorBlob = nullptr;
+	const HRESULT hr = D3DCompile(source.c_str(), source.length(), NULL, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", target, flags, 0, &shaderBlob, &errorBlob);
+	if( FAILED(hr) ) {
+		const std::string log = (errorBlob != nullptr) ? std::string((const char*)errorBlob->GetBufferPointer()) : std::string("Unknown error.\n");
+		outErrors.push_back(ShaderError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, log));
+	} else {
+		const char* bytecode = static_cast<const char*>(shaderBlob->GetBufferPointer());
+		outBytecode.assign(bytecode, bytecode + shaderBlob->GetBufferSize());
+	}
+
+	// release shader and error blobs
+	if( shaderBlob != nullptr ) { shaderBlob->Release(); shaderBlob = nullptr; }
+	if( errorBlob != nullptr ) { errorBlob->Release(); errorBlob = nullptr; }
+	return SUCCEEDED(hr);
+}
+
+std::vector<char> DXShader::packStages( const CompiledStages& stages ) {
+	// each stage is its size followed by its bytecode; a missing geometry shader has a size of zero
+	const std::vector<char>* parts[] = {&stages.vs, &stages.gs, &stages.ps};
+	std::vector<char> data;
+	for( const std::vector<char>* part : parts ) {
+		const unsigned int size = static_cast<unsigned int>(part->size());
+		const char* sizeBytes = reinterpret_cast<const char*>(&size);
+		data.insert(data.end(), sizeBytes, sizeBytes + sizeof(size));
+		data.insert(data.end(), part->begin(), part->end());
+	}
+	return data;
+}
+
+bool DXShader::unpackStages( const std::vector<char>& data, CompiledStages& outStages ) {
+	std::vector<char>* parts[] = {&outStages.vs, &outStages.gs, &outStages.ps};
+	size_t offset = 0;
+	for( std::vector<char>* part : parts ) {
+		unsigned int size = 0;
+		if( data.size() - offset < sizeof(size) ) {
+			return false;
+		}
+		memcpy(&size, data.data() + offset, sizeof(size));
+		offset += sizeof(size);
+		if( data.size() - offset < size ) {
+			return false;
+		}
+		part->assign(data.begin() + offset, data.begin() + offset + size);
+		offset += size;
+	}
+	return (offset == data.size()) && !outStages.vs.empty() && !outStages.ps.empty();
+}
+
+ErrorCode DXShader::createStages( const CompiledStages& stages ) {
+	ID3D11Device* device = _device->getDevice();
+	HRESULT hr = S_OK;
+
+	// todo: change all unknown errors below to proper error codes
+
+	// build the vertex shader
+	hr = device->CreateVertexShader(stages.vs.data(), stages.vs.size(), nullptr, &_vertexShader);
+	if( FAILED(hr) ) {
+		addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": Failed to create vertex shader.\n"));
+	} else {
+		// build the input layout
+		const std::vector<VertexElement>& elements = _vertexDeclaration.getElements();
+		D3D11_INPUT_ELEMENT_DESC* layout = new D3D11_INPUT_ELEMENT_DESC[elements.size()];
+		for( unsigned int i = 0; i < elements.size(); ++i ) {
+			layout[i].SemanticName = _dxUsageStrings[elements[i].getUsage()].c_str();
+			layout[i].SemanticIndex = elements[i].getUsageIndex();
+			layout[i].Format = ciriToDxVertexFormat(elements[i].getFormat());
+			layout[i].InputSlot = elements[i].getSlot();
+			layout[i].AlignedByteOffset = _vertexDeclaration.getOffset(i); // packed per slot
+			layout[i].InputSlotClass = (elements[i].getInstanceStepRate() > 0) ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+			layout[i].InstanceDataStepRate = elements[i].getInstanceStepRate();
+		}
+		hr = device->CreateInputLayout(layout, elements.size(), stages.vs.data(), stages.vs.size(), &_inputLayout);
+		delete[] layout; layout = nullptr;
+		if( FAILED(hr) ) {
+			addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": Failed to create input layout.\n"));
+		} else {
+			reflectConstants(stages.vs, _vertexConstantBufferIndices);
+		}
+	}
+
+	// build the geometry shader
+	if( !stages.gs.empty() ) {
+		hr = device->CreateGeometryShader(stages.gs.data(), stages.gs.size(), nullptr, &_geometryShader);
+		if( FAILED(hr) ) {
+			addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": Failed to create geometry shader.\n"));
+		} else {
+			reflectConstants(stages.gs, _geometryConstantBufferIndices);
+		}
+	}
+
+	// build the pixel shader
+	hr = device->CreatePixelShader(stages.ps.data(), stages.ps.size(), nullptr, &_pixelShader);
+	if( FAILED(hr) ) {
+		addError(ErrorCode::CIRI_UNKNOWN_ERROR, getErrorString(ErrorCode::CIRI_UNKNOWN_ERROR) + std::string(": Failed to create pixel shader.\n"));
+	} else {
+		reflectConstants(stages.ps, _pixelConstantBufferIndices);
+	}
+
+	// if any errors have occurred, clean up and return the first error code
+	if( !_errors.empty() ) {
+		destroy();
+		return _errors[0].code;
+	}
+
+	return ErrorCode::CIRI_OK;
+}
+
+void DXShader::reflectConstants( const std::vector<char>& bytecode, std::unordered_map<std::string, int>& outIndices ) {
+	ID3D11ShaderReflection* refl = nullptr;
+	if( FAILED(D3DReflect(bytecode.data(), bytecode.size(), IID_ID3D11ShaderReflection, (void**)&refl)) ) {
+		return;
+	}
+	int index = 0;
+	while( true ) {
+		D3D11_SHADER_BUFFER_DESC desc;
+		if( FAILED(refl->GetConstantBufferByIndex(index)->GetDesc(&desc)) ) {
+			break;
+		}
+		outIndices[std::string(desc.Name)] = index;
+
+		index += 1;
+	}
+	refl->Release();
+}
+
+void DXShader::finish( const CompiledStages& stages ) {
+	if( !stages.errors.empty() ) {
+		for( unsigned int i = 0; i < stages.errors.size(); ++i ) {
+			const ShaderError& error = stages.errors[i];
+			addError(error.code, getErrorString(error.code) + std::string(": ") + error.msg);
+		}
+		destroy();
+		return;
+	}
+
+	if( failed(createStages(stages)) ) {
+		return;
+	}
+	const std::vector<char> data = packStages(stages);
+	_device->getShaderCache().store(_cacheKey, data.data(), data.size());
+
+	// a constant buffer that does not match is reported like any other error, but does not invalidate the shader
+	std::vector<DeferredConstants> deferred;
+	deferred.swap(_deferredConstants);
+	for( unsigned int i = 0; i < deferred.size(); ++i ) {
+		const ErrorCode result = addConstants(deferred[i].buffer, deferred[i].name.c_str(), deferred[i].shaderTypeFlags);
+		if( failed(result) ) {
+			addError(result, getErrorString(result) + std::string(" (constants ") + deferred[i].name + std::string(")"));
+		}
+	}
 }
\ No newline at end of file
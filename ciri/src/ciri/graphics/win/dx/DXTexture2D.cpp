@@ -110,15 +110,14 @@ TextureFormat::Format DXTexture2D::getFormat() const {
 }
 
 ErrorCode DXTexture2D::writeToTGA( const char* file ) {
-	// todo: somehow figure this out!
-	// https://github.com/Microsoft/DirectXTK/blob/master/Src/ScreenGrab.cpp
-	// http://www.gamedev.net/topic/647297-id3d11shaderresourceview-save-to-file/
-	// 1. create stage texture (cpu=read, usage=staging)
-	// 2. copy resource (context->CopyResource(stage, source)
-	// 3. map to get pixels (d3d11_mapped_subresource; context->map(stage, 0, read, 0, map)...)
-	// 4. somehow convert this into TGA
-	// 5. save as TGA
-	return ErrorCode::CIRI_NOT_IMPLEMENTED;
+	if( nullptr == file || nullptr == _texture2D ) {
+		return ErrorCode::CIRI_UNKNOWN_ERROR; // todo
+	}
+
+	// the async readback waited on right away; this stalls until the gpu catches up, readAsync does not
+	std::future<TextureReadback> pending = readAsync();
+	_device->getReadbackRing().poll(_device->getContext(), true);
+	return pending.get().writeToTGA(file);
 }
 
 ErrorCode DXTexture2D::writeToDDS( const char* file ) {
@@ -132,6 +131,10 @@ ErrorCode DXTexture2D::writeToDDS( const char* file ) {
 	return ErrorCode::CIRI_OK;
 }
 
+std::future<TextureReadback> DXTexture2D::readAsync() {
+	return _device->getReadbackRing().read(_device->getDevice(), _device->getContext(), _texture2D, _format, _width, _height);
+}
+
 ID3D11Texture2D* DXTexture2D::getTexture() const {
 	return _texture2D;
 }
@@ -1,9 +1,11 @@
 #include <ciri/graphics/win/gl/GLConstantBuffer.hpp>
+#include <ciri/graphics/win/gl/GLConstantRing.hpp>
+#include <cstring>
 
 using namespace ciri;
 
-GLConstantBuffer::GLConstantBuffer( GLuint index )
-	: IConstantBuffer(), _ubo(0), _index(index) {
+GLConstantBuffer::GLConstantBuffer( GLuint index, const std::shared_ptr<GLConstantRing>& ring )
+	: IConstantBuffer(), _ubo(0), _index(index), _ring(ring), _inRing(false), _ringFrame(0) {
 }
 
 GLConstantBuffer::~GLConstantBuffer() {
@@ -11,21 +13,20 @@ GLConstantBuffer::~GLConstantBuffer() {
 }
 
 ErrorCode GLConstantBuffer::setData( int dataSize, void* data ) {
-	// create and set if the buffer doesn't exist (i think glBufferData must be called before glBufferSubData can be)
-	if( 0 == _ubo ) {
-		glGenBuffers(1, &_ubo);
-		glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
-		glBufferData(GL_UNIFORM_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_UNIFORM_BUFFER, _index, _ubo); // _index is set by the graphics device in the constructor
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
-		return ErrorCode::CIRI_OK;
+	if( dataSize <= 0 || nullptr == data ) {
+		return ErrorCode::CIRI_INVALID_ARGUMENT;
 	}
 
-	glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, dataSize, data);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	// suballocate from the ring when there is one; the copy is kept so the data can be moved into later frames' segments
+	if( _ring != nullptr && _ring->isValid() ) {
+		_shadow.resize(dataSize);
+		memcpy(_shadow.data(), data, dataSize);
+		if( writeRing() ) {
+			return ErrorCode::CIRI_OK;
+		}
+	}
 
-	return ErrorCode::CIRI_OK;
+	return writeOwn(dataSize, data);
 }
 
 void GLConstantBuffer::destroy() {
@@ -33,14 +34,66 @@ void GLConstantBuffer::destroy() {
 		glDeleteBuffers(1, &_ubo);
 		_ubo = 0;
 	}
+	_shadow.clear();
+	_inRing = false;
 	// HACK: Do not reset the index in case the object is reloaded (e.g. reload shaders)
 	//_index = 0; // todo: is there any way to unbind it? according to the docs, using glBindBufferBase w/ 0 is not valid
 }
 
+void GLConstantBuffer::refresh() {
+	if( !_inRing || _ringFrame == _ring->getFrame() ) {
+		return;
+	}
+
+	// the segment holding the old copy is being recycled, or the ring was destroyed
+	if( !_ring->isValid() || !writeRing() ) {
+		writeOwn(static_cast<int>(_shadow.size()), _shadow.data());
+	}
+}
+
 GLuint GLConstantBuffer::getUbo() const {
 	return _ubo;
 }
 
 GLuint GLConstantBuffer::getIndex() const {
 	return _index;
+}
+
+bool GLConstantBuffer::writeRing() {
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+	if( !_ring->allocate(_shadow.data(), static_cast<int>(_shadow.size()), &offset, &size) ) {
+		return false;
+	}
+
+	// the binding point is per-context, so binding the range here is all a draw needs
+	glBindBufferRange(GL_UNIFORM_BUFFER, _index, _ring->getUbo(), offset, size);
+	_inRing = true;
+	_ringFrame = _ring->getFrame();
+	return true;
+}
+
+ErrorCode GLConstantBuffer::writeOwn( int dataSize, const void* data ) {
+	// create and set if the buffer doesn't exist (i think glBufferData must be called before glBufferSubData can be)
+	if( 0 == _ubo ) {
+		glGenBuffers(1, &_ubo);
+		glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+		glBufferData(GL_UNIFORM_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, _index, _ubo); // _index is set by the graphics device in the constructor
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		_inRing = false;
+		return ErrorCode::CIRI_OK;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, dataSize, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// the binding point still refers to a ring range
+	if( _inRing ) {
+		glBindBufferBase(GL_UNIFORM_BUFFER, _index, _ubo);
+		_inRing = false;
+	}
+
+	return ErrorCode::CIRI_OK;
 }
\ No newline at end of file
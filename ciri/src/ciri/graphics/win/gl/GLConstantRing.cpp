@@ -0,0 +1,126 @@
+#include <ciri/graphics/win/gl/GLConstantRing.hpp>
+#include <cstring>
+
+using namespace ciri;
+
+GLConstantRing::GLConstantRing()
+	: _ubo(0), _mapped(nullptr), _alignment(256), _segmentSize(0), _segment(0), _head(0), _frame(0) {
+	for( int i = 0; i < SEGMENT_COUNT; ++i ) {
+		_fences[i] = 0;
+	}
+}
+
+GLConstantRing::~GLConstantRing() {
+	destroy();
+}
+
+bool GLConstantRing::create( int bytesPerFrame ) {
+	destroy();
+
+	if( bytesPerFrame <= 0 || !GLEW_ARB_buffer_storage ) {
+		return false;
+	}
+
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if( alignment > 0 ) {
+		_alignment = alignment;
+	}
+	_segmentSize = ((bytesPerFrame + _alignment - 1) / _alignment) * _alignment;
+
+	// coherent so writes need no explicit flush; the fences keep the cpu from overwriting what the gpu has yet to read
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr totalSize = static_cast<GLsizeiptr>(_segmentSize) * SEGMENT_COUNT;
+	glGenBuffers(1, &_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+	glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+	_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	if( nullptr == _mapped ) {
+		destroy();
+		return false;
+	}
+
+	_segment = 0;
+	_head = 0;
+	return true;
+}
+
+void GLConstantRing::destroy() {
+	for( int i = 0; i < SEGMENT_COUNT; ++i ) {
+		if( _fences[i] != 0 ) {
+			glDeleteSync(_fences[i]);
+			_fences[i] = 0;
+		}
+	}
+
+	if( _ubo != 0 ) {
+		if( _mapped != nullptr ) {
+			glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			_mapped = nullptr;
+		}
+		glDeleteBuffers(1, &_ubo);
+		_ubo = 0;
+	}
+
+	_segmentSize = 0;
+	_head = 0;
+	// anything allocated before is gone
+	_frame += 1;
+}
+
+bool GLConstantRing::allocate( const void* data, int dataSize, GLintptr* outOffset, GLsizeiptr* outSize ) {
+	if( nullptr == _mapped || dataSize <= 0 ) {
+		return false;
+	}
+
+	const int alignedSize = ((dataSize + _alignment - 1) / _alignment) * _alignment;
+	if( _head + alignedSize > _segmentSize ) {
+		return false;
+	}
+
+	const int offset = _segment * _segmentSize + _head;
+	memcpy(_mapped + offset, data, dataSize);
+	_head += alignedSize;
+
+	*outOffset = offset;
+	*outSize = alignedSize;
+	return true;
+}
+
+void GLConstantRing::endFrame() {
+	_frame += 1;
+
+	if( nullptr == _mapped ) {
+		return;
+	}
+
+	_fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_segment = (_segment + 1) % SEGMENT_COUNT;
+	_head = 0;
+
+	// normally signaled long ago; only waits when the cpu is SEGMENT_COUNT frames ahead
+	GLsync& fence = _fences[_segment];
+	if( fence != 0 ) {
+		GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while( GL_TIMEOUT_EXPIRED == result ) {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		}
+		glDeleteSync(fence);
+		fence = 0;
+	}
+}
+
+unsigned int GLConstantRing::getFrame() const {
+	return _frame;
+}
+
+GLuint GLConstantRing::getUbo() const {
+	return _ubo;
+}
+
+bool GLConstantRing::isValid() const {
+	return _mapped != nullptr;
+}
\ No newline at end of file
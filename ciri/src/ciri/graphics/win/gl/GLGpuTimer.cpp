@@ -0,0 +1,160 @@
+#include <ciri/graphics/win/gl/GLGpuTimer.hpp>
+
+using namespace ciri;
+
+GLGpuTimer::Frame::Frame()
+	: cpuTime(0), gpuTime(0), lastQuery(0), pending(false) {
+}
+
+GLGpuTimer::GLGpuTimer()
+	: _current(0), _droppedFrames(0) {
+}
+
+GLGpuTimer::~GLGpuTimer() {
+	destroy();
+}
+
+void GLGpuTimer::destroy() {
+	for( int i = 0; i < FRAME_LATENCY; ++i ) {
+		releaseQueries(_frames[i]);
+		_frames[i].pending = false;
+	}
+	if( !_freeQueries.empty() ) {
+		glDeleteQueries(static_cast<GLsizei>(_freeQueries.size()), _freeQueries.data());
+		_freeQueries.clear();
+	}
+	_open.clear();
+	_current = 0;
+}
+
+void GLGpuTimer::begin( const char* name ) {
+	if( !Profiler::isEnabled() || !GLEW_ARB_timer_query ) {
+		_open.push_back(-1);
+		return;
+	}
+
+	Frame& frame = _frames[_current];
+	if( frame.scopes.empty() ) {
+		// glGetInteger64v(GL_TIMESTAMP) returns once earlier commands reach the server, not once they run, so this does not stall
+		glGetInteger64v(GL_TIMESTAMP, &frame.gpuTime);
+		frame.cpuTime = Profiler::now();
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.depth = static_cast<int>(_open.size());
+	scope.beginQuery = acquireQuery();
+	scope.endQuery = 0;
+	glQueryCounter(scope.beginQuery, GL_TIMESTAMP);
+	frame.lastQuery = scope.beginQuery;
+
+	_open.push_back(static_cast<int>(frame.scopes.size()));
+	frame.scopes.push_back(scope);
+}
+
+void GLGpuTimer::end() {
+	if( _open.empty() ) {
+		return;
+	}
+	const int index = _open.back();
+	_open.pop_back();
+	if( -1 == index ) {
+		return;
+	}
+
+	Frame& frame = _frames[_current];
+	Scope& scope = frame.scopes[index];
+	scope.endQuery = acquireQuery();
+	glQueryCounter(scope.endQuery, GL_TIMESTAMP);
+	frame.lastQuery = scope.endQuery;
+}
+
+void GLGpuTimer::endFrame() {
+	_open.clear();
+	_frames[_current].pending = !_frames[_current].scopes.empty();
+	_current = (_current + 1) % FRAME_LATENCY;
+
+	// walk from the oldest frame (the slot about to be reused) to the newest; results finish in order, so stop at the first that is not ready
+	for( int i = 0; i < FRAME_LATENCY; ++i ) {
+		Frame& frame = _frames[(_current + i) % FRAME_LATENCY];
+		if( !frame.pending ) {
+			continue;
+		}
+		if( isFrameReady(frame) ) {
+			resolveFrame(frame);
+			continue;
+		}
+		if( 0 == i ) {
+			// its slot is needed for the next frame, and waiting would stall the cpu on the gpu
+			releaseQueries(frame);
+			frame.pending = false;
+			_droppedFrames += 1;
+			continue;
+		}
+		break;
+	}
+}
+
+int GLGpuTimer::getDroppedFrames() const {
+	return _droppedFrames;
+}
+
+GLuint GLGpuTimer::acquireQuery() {
+	if( _freeQueries.empty() ) {
+		GLuint queries[16];
+		glGenQueries(16, queries);
+		_freeQueries.insert(_freeQueries.end(), queries, queries + 16);
+	}
+	const GLuint query = _freeQueries.back();
+	_freeQueries.pop_back();
+	return query;
+}
+
+void GLGpuTimer::releaseQueries( Frame& frame ) {
+	for( unsigned int i = 0; i < frame.scopes.size(); ++i ) {
+		const Scope& scope = frame.scopes[i];
+		_freeQueries.push_back(scope.beginQuery);
+		if( scope.endQuery != 0 ) {
+			_freeQueries.push_back(scope.endQuery);
+		}
+	}
+	frame.scopes.clear();
+	frame.lastQuery = 0;
+}
+
+bool GLGpuTimer::isFrameReady( const Frame& frame ) const {
+	if( 0 == frame.lastQuery ) {
+		return true;
+	}
+
+	GLint available = 0;
+	glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	return available != 0;
+}
+
+void GLGpuTimer::resolveFrame( Frame& frame ) {
+	_events.clear();
+	for( unsigned int i = 0; i < frame.scopes.size(); ++i ) {
+		const Scope& scope = frame.scopes[i];
+		if( 0 == scope.endQuery ) {
+			continue; // abandoned at present
+		}
+
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &end);
+
+		ProfileEvent event;
+		event.name = scope.name;
+		event.start = frame.cpuTime + (static_cast<long long>(begin) - frame.gpuTime);
+		event.end = frame.cpuTime + (static_cast<long long>(end) - frame.gpuTime);
+		event.depth = scope.depth;
+		event.thread = Profiler::GPU_THREAD;
+		_events.push_back(event);
+	}
+	Profiler::addGpuEvents(_events.data(), static_cast<int>(_events.size()));
+
+	releaseQueries(frame);
+	frame.pending = false;
+}
\ No newline at end of file
@@ -13,6 +13,11 @@
 
 using namespace ciri;
 
+// a texture unit holds one binding per target, so each target gets its own table in the state cache
+static const int TEXTURE_TABLE_2D = 0;
+static const int TEXTURE_TABLE_3D = 1;
+static const int TEXTURE_TABLE_CUBE = 2;
+
 //static void setVSync(bool sync)
 //{	
 //	// Function pointer for the wgl extention function we need to enable/disable
@@ -37,7 +42,9 @@ using namespace ciri;
 
 GLGraphicsDevice::GLGraphicsDevice()
 	: IGraphicsDevice(), _isValid(false), _window(nullptr), _hdc(0), _hglrc(0), _defaultWidth(0), _defaultHeight(0),
-		_currentFbo(0), _shaderExt(".glsl"), _dummyVao(0), _constantBufferCount(0) {
+		_vertexArrayDirty(true), _activeLayout(0), _currentFbo(0), _shaderExt(".glsl"), _dummyVao(0), _constantBufferCount(0),
+		_constantRing(std::make_shared<GLConstantRing>()), _readbackRing(std::make_shared<GLReadbackRing>()), _shaderCache(std::make_shared<ShaderCache>()),
+		_parallelShaderCompile(false) {
 	// configure mrt draw buffers
 	for( int i = 0; i < MAX_MRTS; ++i ) {
 		_drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
@@ -70,6 +77,9 @@ bool GLGraphicsDevice::create( const std::shared_ptr<IWindow>& window ) {
 
 	_isValid = true;
 
+	// nothing is known to be bound on a fresh context
+	_stateCache.invalidate();
+
 	// apply a fullsize viewport
 	setViewport(Viewport(0, 0, window->getWidth(), window->getHeight(), 0.0f, 1.0f));
 
@@ -95,6 +105,7 @@ void GLGraphicsDevice::destroy() {
 	_defaultDepthStencilDefault = nullptr;
 	_defaultDepthStencilDepthRead = nullptr;
 	_defaultDepthStencilNone = nullptr;
+	_pipelineCache.clear();
 
 	// clean fbo
 	if( 0 != _currentFbo ) {
@@ -102,6 +113,13 @@ void GLGraphicsDevice::destroy() {
 		_currentFbo = 0;
 	}
 
+	// delete cached vaos, the constant ring, readback buffers, and timer queries while the context is still current
+	_vertexArrays.clear();
+	_constantRing->destroy();
+	_readbackRing->destroy();
+	_gpuTimer.destroy();
+	_vertexArrayDirty = true;
+
 	// delete dummy vao
 	if( _dummyVao != 0 ) {
 		glDeleteVertexArrays(1, &_dummyVao);
@@ -126,6 +144,12 @@ void GLGraphicsDevice::present() {
 	}
 
 	SwapBuffers(_hdc);
+
+	_stateCache.endFrame();
+	_vertexArrays.sweep();
+	_constantRing->endFrame();
+	_readbackRing->poll();
+	_gpuTimer.endFrame();
 }
 
 void GLGraphicsDevice::setViewport( const Viewport& vp ) {
@@ -146,7 +170,7 @@ std::shared_ptr<IShader> GLGraphicsDevice::createShader() {
 		return nullptr;
 	}
 
-	std::shared_ptr<GLShader> shader = std::make_shared<GLShader>();
+	std::shared_ptr<GLShader> shader = std::make_shared<GLShader>(_shaderCache, _parallelShaderCompile);
 	return shader;
 }
 
@@ -176,11 +200,31 @@ std::shared_ptr<IConstantBuffer> GLGraphicsDevice::createConstantBuffer() {
 	// todo: implement a better system that allows for reuse of deleted indices
 	//       such as some kind of lookup table to see if a buffer is dead upon request.
 	//       e.g. .....(getNextFreeConstantBufferIndex())...
-	std::shared_ptr<GLConstantBuffer> buffer = std::make_shared<GLConstantBuffer>(_constantBufferCount);
+	std::shared_ptr<GLConstantBuffer> buffer = std::make_shared<GLConstantBuffer>(_constantBufferCount, _constantRing);
 	_constantBufferCount += 1;
 	return buffer;
 }
 
+void GLGraphicsDevice::setConstantRingSize( int bytesPerFrame ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// buffers notice the ring is gone and fall back on their next update
+	if( bytesPerFrame <= 0 ) {
+		_constantRing->destroy();
+		return;
+	}
+	_constantRing->create(bytesPerFrame);
+}
+
+bool GLGraphicsDevice::setShaderCacheDirectory( const char* directory ) {
+	if( !_isValid ) {
+		return false;
+	}
+	return _shaderCache->setDirectory(directory);
+}
+
 std::shared_ptr<ITexture2D> GLGraphicsDevice::createTexture2D( int width, int height, TextureFormat::Format format, int flags, void* pixels ) {
 	if( !_isValid ) {
 		return nullptr;
@@ -190,7 +234,7 @@ std::shared_ptr<ITexture2D> GLGraphicsDevice::createTexture2D( int width, int he
 		return nullptr;
 	}
 
-	std::shared_ptr<GLTexture2D> glTexture = std::make_shared<GLTexture2D>(flags);
+	std::shared_ptr<GLTexture2D> glTexture = std::make_shared<GLTexture2D>(flags, _readbackRing);
 	if( failed(glTexture->setData(0, 0, width, height, pixels, format)) ) {
 		glTexture.reset();
 		glTexture = nullptr;
@@ -258,8 +302,13 @@ std::shared_ptr<IRenderTarget2D> GLGraphicsDevice::createRenderTarget2D( int wid
 		return nullptr;
 	}
 
-	std::shared_ptr<GLTexture2D> texture = std::static_pointer_cast<GLTexture2D>(this->createTexture2D(width, height, format, TextureFlags::RenderTarget, nullptr));
-	if( nullptr == texture ) {
+	// depth-only targets have no color texture, but must have depth
+	if( TextureFormat::None == format && DepthStencilFormat::None == depthFormat ) {
+		return nullptr;
+	}
+
+	std::shared_ptr<GLTexture2D> texture = (TextureFormat::None==format) ? nullptr : std::static_pointer_cast<GLTexture2D>(this->createTexture2D(width, height, format, TextureFlags::RenderTarget, nullptr));
+	if( nullptr == texture && format != TextureFormat::None ) {
 		return nullptr;
 	}
 	std::shared_ptr<GLTexture2D> depthTexture = (DepthStencilFormat::None==depthFormat) ? nullptr : std::static_pointer_cast<GLTexture2D>(this->createTexture2D(width, height, TextureFormat::fromDepthStencilFormat(depthFormat), TextureFlags::RenderTarget, nullptr));
@@ -316,76 +365,129 @@ std::shared_ptr<IBlendState> GLGraphicsDevice::createBlendState( const BlendDesc
 	return glState;
 }
 
+std::shared_ptr<IPipelineState> GLGraphicsDevice::createPipelineState( const PipelineDesc& desc ) {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return _pipelineCache.create(this, desc);
+}
+
+std::shared_ptr<ICommandList> GLGraphicsDevice::createCommandList() {
+	if( !_isValid ) {
+		return nullptr;
+	}
+	return std::make_shared<CommandList>();
+}
+
 void GLGraphicsDevice::applyShader( const std::shared_ptr<IShader>& shader ) {
 	if( !_isValid ) {
 		return;
 	}
 
 	if( nullptr == shader ) {
-		glUseProgram(0);
+		if( _stateCache.bindShader(shader, 0) ) {
+			glUseProgram(0);
+		}
 		_activeShader.reset();
 		return;
 	}
 
+	// finishes a shader still compiling in the background; only blocks if it has not finished yet
+	shader->wait();
 	if( !shader->isValid() ) {
 		_activeShader.reset();
 		return;
 	}
 
 	const std::shared_ptr<GLShader> glShader = std::static_pointer_cast<GLShader>(shader);
-	glUseProgram(glShader->getProgram());
+	if( _stateCache.bindShader(glShader, glShader->getProgram()) ) {
+		glUseProgram(glShader->getProgram());
+		// vertex attributes come from the shader's declaration, so only a different layout needs a different vertex array
+		const size_t layout = glShader->getVertexDeclaration().getHash();
+		if( layout != _activeLayout ) {
+			_activeLayout = layout;
+			_vertexArrayDirty = true;
+		}
+	}
 	_activeShader = glShader;
 }
 
-void GLGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) {
+void GLGraphicsDevice::applyPipelineState( const std::shared_ptr<IPipelineState>& state ) {
+	if( !_isValid || nullptr == state ) {
+		return;
+	}
+
+	// each part goes through the state cache, so only what differs from the previous pipeline is applied
+	const std::shared_ptr<PipelineState> pipeline = std::static_pointer_cast<PipelineState>(state);
+	applyShader(pipeline->getShader());
+	setBlendState(pipeline->getBlendState());
+	setRasterizerState(pipeline->getRasterizerState());
+	setDepthStencilState(pipeline->getDepthStencilState());
+}
+
+void GLGraphicsDevice::executeCommandLists( ICommandList** lists, int count ) {
+	if( !_isValid || nullptr == lists ) {
+		return;
+	}
+
+	// lists are replayed through the immediate calls, so the state cache still filters what reaches gl
+	for( int i = 0; i < count; ++i ) {
+		if( lists[i] != nullptr ) {
+			static_cast<CommandList*>(lists[i])->execute(this);
+		}
+	}
+}
+
+void GLGraphicsDevice::beginGpuScope( const char* name ) {
 	if( !_isValid ) {
 		return;
 	}
+	_gpuTimer.begin(name);
+}
 
-	// todo: see if there's a way to have the vertex attribute values stores separately from the buffers themselves akin
-	//       to directx's input layouts.  maybe through an extension or something core to 4.2+ ?
+void GLGraphicsDevice::endGpuScope() {
+	if( !_isValid ) {
+		return;
+	}
+	_gpuTimer.end();
+}
 
-	// gl needs a bound vertex buffer in order to set vertex attrib pointers, therefore we need a valid shader bound.
-	// i want to change this because it means you can't set a vertex buffer before setting a shader, which is odd...
-	if( _activeShader.expired() ) {
+void GLGraphicsDevice::setVertexBuffer( const std::shared_ptr<IVertexBuffer>& buffer ) {
+	if( !_isValid ) {
 		return;
 	}
 
+	// attribute pointers depend on the shader too, so the vertex array is resolved at draw time instead of here.
+	// this also means vertex buffers can be set before shaders.
 	if( nullptr == buffer ) {
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		_stateCache.bindVertexBuffer(buffer, 0);
+		_activeVertexBuffers[0].reset();
 		return;
 	}
 
 	const std::shared_ptr<GLVertexBuffer> glBuffer = std::static_pointer_cast<GLVertexBuffer>(buffer);
-	const GLuint vbo = glBuffer->getVbo();
-	if( 0 == vbo ) {
+	if( 0 == glBuffer->getVbo() ) {
 		return;
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-	// apply vertex attribute pointers based on the shader's vertex declaration
-	int offset = 0;
-	const std::vector<VertexElement>& elements = _activeShader.lock()->getVertexDeclaration().getElements();
-	for( unsigned int i = 0; i < elements.size(); ++i ) {
-		const VertexElement& currElement = elements[i];
-
-		GLenum type;
-		switch( currElement.getFormat() ) {
-			case VertexFormat::Float:
-			case VertexFormat::Float2:
-			case VertexFormat::Float3:
-			case VertexFormat::Float4: {
-				type = GL_FLOAT;
-			}
-		}
+	if( _stateCache.bindVertexBuffer(glBuffer, glBuffer->getRevision()) ) {
+		_vertexArrayDirty = true;
+	}
+	_activeVertexBuffers[0] = glBuffer;
+}
 
-		glEnableVertexAttribArray(i);
-		glVertexAttribPointer(i, currElement.getMultiplicity(), type, GL_FALSE, _activeShader.lock()->getVertexDeclaration().getStride(), (const void*)offset);
-			
-		offset += currElement.getSize(); // sizeof(datatype) * numberOfThem;
+void GLGraphicsDevice::setVertexBuffers( const std::shared_ptr<IVertexBuffer>* buffers, int numBuffers ) {
+	if( !_isValid ) {
+		return;
 	}
 
-	_activeVertexBuffer = glBuffer;
+	if( numBuffers > VertexDeclaration::MAX_STREAMS ) {
+		numBuffers = VertexDeclaration::MAX_STREAMS;
+	}
+
+	setVertexBuffer((numBuffers > 0) ? buffers[0] : nullptr);
+	for( int i = 1; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		bindVertexStream(i, (i < numBuffers) ? buffers[i] : nullptr);
+	}
 }
 
 void GLGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buffer ) {
@@ -394,7 +496,10 @@ void GLGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buff
 	}
 
 	if( nullptr == buffer ) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		if( _stateCache.bindIndexBuffer(buffer, 0) ) {
+			_vertexArrayDirty = true;
+		}
+		_activeIndexBuffer.reset();
 		return;
 	}
 
@@ -404,7 +509,10 @@ void GLGraphicsDevice::setIndexBuffer( const std::shared_ptr<IIndexBuffer>& buff
 		//_activeIndexBuffer.reset();
 		return; // todo: error
 	}
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, evbo);
+	// the element buffer binding lives in the vertex array
+	if( _stateCache.bindIndexBuffer(glBuffer, glBuffer->getRevision()) ) {
+		_vertexArrayDirty = true;
+	}
 
 	_activeIndexBuffer = glBuffer;
 }
@@ -419,8 +527,12 @@ void GLGraphicsDevice::setTexture2D( int index, const std::shared_ptr<ITexture2D
 	}
 
 	const std::shared_ptr<GLTexture2D> glTexture = std::static_pointer_cast<GLTexture2D>(texture);
+	const GLuint textureId = (texture != nullptr) ? glTexture->getTextureId() : 0;
+	if( !_stateCache.bindTexture(TEXTURE_TABLE_2D, index, glTexture, (glTexture != nullptr) ? glTexture->getRevision() : 0) ) {
+		return;
+	}
 	glActiveTexture(GL_TEXTURE0 + index);
-	glBindTexture(GL_TEXTURE_2D, (texture != nullptr) ? glTexture->getTextureId() : 0);
+	glBindTexture(GL_TEXTURE_2D, textureId);
 }
 
 void GLGraphicsDevice::setTexture3D( int index, const std::shared_ptr<ITexture3D>& texture, ShaderStage::Stage shaderStage ) {
@@ -433,8 +545,12 @@ void GLGraphicsDevice::setTexture3D( int index, const std::shared_ptr<ITexture3D
 	}
 
 	const std::shared_ptr<GLTexture3D> glTexture = std::static_pointer_cast<GLTexture3D>(texture);
+	const GLuint textureId = (texture != nullptr) ? glTexture->getTextureId() : 0;
+	if( !_stateCache.bindTexture(TEXTURE_TABLE_3D, index, glTexture, (glTexture != nullptr) ? glTexture->getRevision() : 0) ) {
+		return;
+	}
 	glActiveTexture(GL_TEXTURE0 + index);
-	glBindTexture(GL_TEXTURE_3D, (texture != nullptr) ? glTexture->getTextureId() : 0);
+	glBindTexture(GL_TEXTURE_3D, textureId);
 }
 
 void GLGraphicsDevice::setTextureCube( int index, const std::shared_ptr<ITextureCube>& texture, ShaderStage::Stage shaderStage ) {
@@ -442,9 +558,17 @@ void GLGraphicsDevice::setTextureCube( int index, const std::shared_ptr<ITexture
 		return;
 	}
 
+	if( index < 0 ) {
+		return;
+	}
+
 	const std::shared_ptr<GLTextureCube> glTexture = std::static_pointer_cast<GLTextureCube>(texture);
+	const GLuint textureId = (glTexture != nullptr) ? glTexture->getTextureId() : 0;
+	if( !_stateCache.bindTexture(TEXTURE_TABLE_CUBE, index, glTexture, (glTexture != nullptr) ? glTexture->getRevision() : 0) ) {
+		return;
+	}
 	glActiveTexture(GL_TEXTURE0 + index);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, (glTexture != nullptr) ? glTexture->getTextureId() : 0);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
 }
 
 void GLGraphicsDevice::setSamplerState( int index, const std::shared_ptr<ISamplerState>& state, ShaderStage::Stage shaderStage ) {
@@ -453,7 +577,11 @@ void GLGraphicsDevice::setSamplerState( int index, const std::shared_ptr<ISample
 	}
 
 	const std::shared_ptr<GLSamplerState> glSampler = std::static_pointer_cast<GLSamplerState>(state);
-	glBindSampler(index, (state != nullptr) ? glSampler->getSamplerId() : 0);
+	const GLuint samplerId = (state != nullptr) ? glSampler->getSamplerId() : 0;
+	// samplers are bound per texture unit and shared by all targets, so they all go in the first table
+	if( _stateCache.bindSampler(0, index, glSampler, samplerId) ) {
+		glBindSampler(index, samplerId);
+	}
 }
 
 void GLGraphicsDevice::setBlendState( const std::shared_ptr<IBlendState>& state ) {
@@ -467,7 +595,10 @@ void GLGraphicsDevice::setBlendState( const std::shared_ptr<IBlendState>& state
 	}
 
 	const std::shared_ptr<GLBlendState> glState = std::static_pointer_cast<GLBlendState>(state);
-	const BlendDesc desc = glState->getDesc();
+	if( !_stateCache.bindBlendState(glState, 0) ) {
+		return;
+	}
+	const BlendDesc& desc = glState->getDesc();
 
 	// enable blending
 	if( desc.blendingEnabled() ) {
@@ -504,7 +635,7 @@ void GLGraphicsDevice::drawArrays( PrimitiveTopology topology, int vertexCount,
 	}
 
 	// cannot draw with no active vertex buffer
-	if( _activeVertexBuffer.expired() ) {
+	if( _activeVertexBuffers[0].expired() ) {
 		return;
 	}
 
@@ -518,10 +649,15 @@ void GLGraphicsDevice::drawArrays( PrimitiveTopology topology, int vertexCount,
 	//	return;
 	//}
 
+	if( !prepareVertexArray() ) {
+		return;
+	}
+	refreshConstants();
+
 	glDrawArrays(ciriToGlTopology(topology), startIndex, vertexCount);
 }
 
-void GLGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount ) {
+void GLGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount, int startIndex, int baseVertex ) {
 	if( !_isValid ) {
 		return;
 	}
@@ -532,16 +668,74 @@ void GLGraphicsDevice::drawIndexed( PrimitiveTopology topology, int indexCount )
 	}
 
 	// cannot draw without a valid vertex and index buffer
-	if( _activeVertexBuffer.expired() || _activeIndexBuffer.expired() ) {
+	if( _activeVertexBuffers[0].expired() || _activeIndexBuffer.expired() ) {
 		return;
 	}
 
 	// index count must be greater than 0
-	if( indexCount <= 0 ) {
+	if( indexCount <= 0 || startIndex < 0 ) {
 		return; // todo: error
 	}
 
-	glDrawElements(ciriToGlTopology(topology), indexCount, GL_UNSIGNED_INT, 0);
+	if( !prepareVertexArray() ) {
+		return;
+	}
+	refreshConstants();
+
+	const IndexFormat::Format format = _activeIndexBuffer.lock()->getFormat();
+	const GLenum type = (IndexFormat::UInt16 == format) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	const void* offset = reinterpret_cast<const void*>(static_cast<intptr_t>(startIndex) * IndexFormat::bytesPerIndex(format));
+	if( 0 == baseVertex ) {
+		glDrawElements(ciriToGlTopology(topology), indexCount, type, offset);
+	} else {
+		glDrawElementsBaseVertex(ciriToGlTopology(topology), indexCount, type, offset, baseVertex);
+	}
+}
+
+void GLGraphicsDevice::drawInstanced( PrimitiveTopology topology, int vertexCount, int instanceCount, int startIndex ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// cannot draw with no active shader or vertex buffer
+	if( _activeShader.expired() || _activeVertexBuffers[0].expired() ) {
+		return;
+	}
+
+	if( vertexCount <= 0 || instanceCount <= 0 ) {
+		return;
+	}
+
+	// also fails if a stream the shader reads from is unbound
+	if( !prepareVertexArray() ) {
+		return;
+	}
+	refreshConstants();
+
+	glDrawArraysInstanced(ciriToGlTopology(topology), startIndex, vertexCount, instanceCount);
+}
+
+void GLGraphicsDevice::drawIndexedInstanced( PrimitiveTopology topology, int indexCount, int instanceCount ) {
+	if( !_isValid ) {
+		return;
+	}
+
+	// cannot draw with no active shader or without a valid vertex and index buffer
+	if( _activeShader.expired() || _activeVertexBuffers[0].expired() || _activeIndexBuffer.expired() ) {
+		return;
+	}
+
+	if( indexCount <= 0 || instanceCount <= 0 ) {
+		return;
+	}
+
+	if( !prepareVertexArray() ) {
+		return;
+	}
+	refreshConstants();
+
+	const GLenum type = (IndexFormat::UInt16 == _activeIndexBuffer.lock()->getFormat()) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	glDrawElementsInstanced(ciriToGlTopology(topology), indexCount, type, 0, instanceCount);
 }
 
 void GLGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int numRenderTargets ) {
@@ -553,11 +747,15 @@ void GLGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int nu
 	if( 0 == _currentFbo ) { glGenFramebuffers(1, &_currentFbo); }
 	glBindFramebuffer(GL_FRAMEBUFFER, _currentFbo);
 
-	// attach all render target textures incl. first occurrence of a depth stencil
+	// attach all render target textures incl. first occurrence of a depth stencil; depth-only targets have no color texture
 	bool isDepthStencilBound = false;
+	int colorCount = 0;
 	for( int i = 0; i < numRenderTargets; ++i ) {
-		const std::shared_ptr<GLTexture2D>& texture = std::static_pointer_cast<GLTexture2D>(renderTargets[i]->getTexture());
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, texture->getTextureId(), 0);
+		const std::shared_ptr<GLTexture2D> texture = std::static_pointer_cast<GLTexture2D>(renderTargets[i]->getTexture());
+		if( texture != nullptr ) {
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + colorCount, GL_TEXTURE_2D, texture->getTextureId(), 0);
+			colorCount += 1;
+		}
 
 		if( !isDepthStencilBound && renderTargets[i]->getDepth() != nullptr ) {
 			isDepthStencilBound = true;
@@ -567,11 +765,22 @@ void GLGraphicsDevice::setRenderTargets( IRenderTarget2D** renderTargets, int nu
 		}
 	}
 
+	// the fbo is shared, so whatever the last targets attached would otherwise still be depth tested against
+	if( !isDepthStencilBound ) {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+	}
+
 	// configure draw buffers
-	glDrawBuffers(numRenderTargets, _drawBuffers);
+	if( colorCount > 0 ) {
+		glDrawBuffers(colorCount, _drawBuffers);
+	} else {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+		glDrawBuffer(GL_NONE);
+	}
 
 	// set viewport (use 0's size)
-	setViewport(Viewport(0, 0, renderTargets[0]->getTexture()->getWidth(), renderTargets[0]->getTexture()->getHeight()));
+	const std::shared_ptr<ITexture2D> sizeTexture = (renderTargets[0]->getTexture() != nullptr) ? renderTargets[0]->getTexture() : renderTargets[0]->getDepth();
+	setViewport(Viewport(0, 0, sizeTexture->getWidth(), sizeTexture->getHeight()));
 }
 
 void GLGraphicsDevice::restoreDefaultRenderTargets() {
@@ -626,6 +835,9 @@ ErrorCode GLGraphicsDevice::resizeTexture2D( const std::shared_ptr<ITexture2D>&
 		return ErrorCode::CIRI_UNKNOWN_ERROR;
 	}
 
+	// deleting the texture unbinds it from every unit
+	_stateCache.invalidateTextures();
+
 	glTexture->destroy();
 	return glTexture->setData(0, 0, width, height, nullptr, glTexture->getFormat());
 }
@@ -642,19 +854,30 @@ ErrorCode GLGraphicsDevice::resizeRenderTarget2D( const std::shared_ptr<IRenderT
 	const std::shared_ptr<GLRenderTarget2D> glTarget = std::static_pointer_cast<GLRenderTarget2D>(target);
 
 	// check for texture that isn't created
-	if( nullptr == glTarget->getTexture() ) {
+	if( nullptr == glTarget->getTexture() && nullptr == glTarget->getDepth() ) {
 		return ErrorCode::CIRI_UNKNOWN_ERROR;
 	}
 
-	// store texture's format for re-creation
-	const TextureFormat::Format textureFormat = glTarget->getTexture()->getFormat();
+	// store the formats for re-creation; depth-only targets have no color texture
+	const TextureFormat::Format textureFormat = (glTarget->getTexture() != nullptr) ? glTarget->getTexture()->getFormat() : TextureFormat::None;
+	const TextureFormat::Format depthFormat = (glTarget->getDepth() != nullptr) ? glTarget->getDepth()->getFormat() : TextureFormat::None;
 
 	glTarget->destroy();
-	const std::shared_ptr<GLTexture2D> glTexture = std::static_pointer_cast<GLTexture2D>(createTexture2D(width, height, textureFormat, TextureFlags::RenderTarget, nullptr));
-	if( nullptr == glTexture ) {
-		return ErrorCode::CIRI_UNKNOWN_ERROR;
+	_stateCache.invalidateTextures();
+	std::shared_ptr<GLTexture2D> glTexture = nullptr;
+	if( textureFormat != TextureFormat::None ) {
+		glTexture = std::static_pointer_cast<GLTexture2D>(createTexture2D(width, height, textureFormat, TextureFlags::RenderTarget, nullptr));
+		if( nullptr == glTexture ) {
+			return ErrorCode::CIRI_UNKNOWN_ERROR;
+		}
+	}
+	std::shared_ptr<GLTexture2D> glDepth = nullptr;
+	if( depthFormat != TextureFormat::None ) {
+		glDepth = std::static_pointer_cast<GLTexture2D>(createTexture2D(width, height, depthFormat, TextureFlags::RenderTarget, nullptr));
+		if( nullptr == glDepth ) {
+			return ErrorCode::CIRI_UNKNOWN_ERROR;
+		}
 	}
-	const std::shared_ptr<GLTexture2D> glDepth = nullptr; // todo
 	return glTarget->create(glTexture, glDepth) ? ErrorCode::CIRI_OK : ErrorCode::CIRI_UNKNOWN_ERROR;
 }
 
@@ -709,10 +932,9 @@ void GLGraphicsDevice::setRasterizerState( const std::shared_ptr<IRasterizerStat
 	}
 
 	const std::shared_ptr<GLRasterizerState> glRaster = std::static_pointer_cast<GLRasterizerState>(state);
-	if( !_activeRasterizerState.expired() && (glRaster == _activeRasterizerState.lock()) ) {
+	if( !_stateCache.bindRasterizerState(glRaster, 0) ) {
 		return;
 	}
-	_activeRasterizerState = glRaster;
 	const RasterizerDesc& desc = glRaster->getDesc();
 
 	// cull mode
@@ -767,10 +989,9 @@ void GLGraphicsDevice::setDepthStencilState( const std::shared_ptr<IDepthStencil
 	}
 
 	const std::shared_ptr<GLDepthStencilState> glState = std::static_pointer_cast<GLDepthStencilState>(state);
-	if( !_activeDepthStencilState.expired() && (glState == _activeDepthStencilState.lock()) ) {
+	if( !_stateCache.bindDepthStencilState(glState, 0) ) {
 		return;
 	}
-	_activeDepthStencilState = glState;
 	const DepthStencilDesc& desc = glState->getDesc();
 
 	// enable depth
@@ -832,6 +1053,22 @@ GraphicsApiType GLGraphicsDevice::getApiType() const {
 	return GraphicsApiType::OpenGL;
 }
 
+int GLGraphicsDevice::getRedundantCallCount() const {
+	return _stateCache.getRedundantCallCount();
+}
+
+int GLGraphicsDevice::getStateChangeCount() const {
+	return _stateCache.getStateChangeCount();
+}
+
+int GLGraphicsDevice::getVertexAttributeSetupCount() const {
+	return _stateCache.getVertexAttributeSetupCount();
+}
+
+int GLGraphicsDevice::getVertexInputBindCount() const {
+	return _stateCache.getVertexInputBindCount();
+}
+
 ErrorCode GLGraphicsDevice::restoreDefaultStates() {
 	// restore blend state
 	ErrorCode status = restoreDefaultBlendState();
@@ -971,6 +1208,42 @@ std::shared_ptr<IDepthStencilState> GLGraphicsDevice::getDefaultDepthStencilNone
 	return _defaultDepthStencilNone;
 }
 
+bool GLGraphicsDevice::prepareVertexArray() {
+	if( !_vertexArrayDirty ) {
+		return true;
+	}
+	std::shared_ptr<GLVertexBuffer> vertexBuffers[VertexDeclaration::MAX_STREAMS];
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		vertexBuffers[i] = _activeVertexBuffers[i].lock();
+	}
+	if( !_vertexArrays.bind(_activeShader.lock()->getVertexDeclaration(), vertexBuffers, _activeIndexBuffer.lock(), _stateCache) ) {
+		return false;
+	}
+	_vertexArrayDirty = false;
+	return true;
+}
+
+void GLGraphicsDevice::refreshConstants() {
+	// cheap for buffers not in the ring; those that are may need moving into this frame's segment
+	const std::vector<std::shared_ptr<GLConstantBuffer>>& constants = _activeShader.lock()->getConstants();
+	for( unsigned int i = 0; i < constants.size(); ++i ) {
+		constants[i]->refresh();
+	}
+}
+
+void GLGraphicsDevice::bindVertexStream( int slot, const std::shared_ptr<IVertexBuffer>& buffer ) {
+	// secondary streams skip the state cache; instance data usually changes every draw anyway
+	const std::shared_ptr<GLVertexBuffer> glBuffer = std::static_pointer_cast<GLVertexBuffer>(buffer);
+	if( glBuffer != nullptr && 0 == glBuffer->getVbo() ) {
+		return;
+	}
+	const std::shared_ptr<GLVertexBuffer> current = _activeVertexBuffers[slot].lock();
+	if( current != glBuffer ) {
+		_activeVertexBuffers[slot] = glBuffer;
+		_vertexArrayDirty = true;
+	}
+}
+
 bool GLGraphicsDevice::configureGl( HWND hwnd ) {
 	// get the window's device context
 	_hdc = GetDC(hwnd);
@@ -1045,6 +1318,10 @@ bool GLGraphicsDevice::configureGl( HWND hwnd ) {
 	const std::string glslVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
 	_apiInfo = "OpenGL " + glVersion + "; GLSL " + glslVersion;
 
+	// program binaries are only valid for the driver that made them
+	_shaderCache->setDriver(_gpuName + "; " + _apiInfo);
+	configureParallelShaderCompile();
+
 	// default clear color
 	glClearColor(0.39f, 0.58f, 0.93f, 1.0f);
 	// default clear values
@@ -1060,6 +1337,27 @@ bool GLGraphicsDevice::configureGl( HWND hwnd ) {
 	return true;
 }
 
+void GLGraphicsDevice::configureParallelShaderCompile() {
+	// the extension postdates the bundled glew, so look for it and fetch its one entry point by hand
+	typedef void (APIENTRY *PFNGLMAXSHADERCOMPILERTHREADSPROC)( GLuint count );
+	PFNGLMAXSHADERCOMPILERTHREADSPROC maxShaderCompilerThreads = nullptr;
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for( GLint i = 0; i < extensionCount && nullptr == maxShaderCompilerThreads; ++i ) {
+		const std::string extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if( "GL_KHR_parallel_shader_compile" == extension ) {
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)wglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		} else if( "GL_ARB_parallel_shader_compile" == extension ) {
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)wglGetProcAddress("glMaxShaderCompilerThreadsARB");
+		}
+	}
+
+	_parallelShaderCompile = (maxShaderCompilerThreads != nullptr);
+	if( _parallelShaderCompile ) {
+		maxShaderCompilerThreads(0xFFFFFFFF); // as many threads as the driver wants
+	}
+}
+
 // i shit you the fuck not, we even need a fake wndproc because of the SetPixelFormat thing mentioned below...
 static LRESULT WINAPI FakeWndProc( HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam ) {
 	return DefWindowProc(hwnd, msg, wparam, lparam);
@@ -1085,7 +1383,8 @@ bool GLGraphicsDevice::configureGlew() {
 	wc.hbrBackground = (HBRUSH)(COLOR_WINDOW+1);
 	wc.lpszMenuName = NULL;
 	wc.lpszClassName = className;
-	if( !RegisterClassEx(&wc) ) {
+	// an earlier device in this process may have registered it already
+	if( !RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS ) {
 		return false;
 	}
 	HINSTANCE inst = GetModuleHandle(NULL);
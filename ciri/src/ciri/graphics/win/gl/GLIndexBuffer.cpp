@@ -1,9 +1,10 @@
 #include <ciri/graphics/win/gl/GLIndexBuffer.hpp>
+#include <vector>
 
 using namespace ciri;
 
 GLIndexBuffer::GLIndexBuffer()
-	: IIndexBuffer(), _evbo(0), _indexCount(0) {
+	: IIndexBuffer(), _evbo(0), _revision(0), _indexCount(0), _format(IndexFormat::UInt32) {
 }
 
 GLIndexBuffer::~GLIndexBuffer() {
@@ -21,11 +22,25 @@ ErrorCode GLIndexBuffer::set( int* indices, int indexCount, bool dynamic ) {
 	}
 
 	_indexCount = indexCount;
+	_format = IndexFormat::fromIndices(indices, indexCount);
 
+	// narrow to 16-bit when every index fits; halves the index bandwidth of almost every mesh
+	std::vector<unsigned short> narrowed;
+	const void* data = indices;
+	if( IndexFormat::UInt16 == _format ) {
+		narrowed.resize(indexCount);
+		for( int i = 0; i < indexCount; ++i ) {
+			narrowed[i] = static_cast<unsigned short>(indices[i]);
+		}
+		data = narrowed.data();
+	}
+
+	// upload through the copy target; the element array binding belongs to the vao and is tracked by the device
 	glGenBuffers(1, &_evbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _evbo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * indexCount, indices, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	_revision += 1;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _evbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, IndexFormat::bytesPerIndex(_format) * indexCount, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
 	// todo: check for fail
 
@@ -43,6 +58,14 @@ int GLIndexBuffer::getIndexCount() const {
 	return _indexCount;
 }
 
+IndexFormat::Format GLIndexBuffer::getFormat() const {
+	return _format;
+}
+
 GLuint GLIndexBuffer::getEvbo() const {
 	return _evbo;
+}
+
+unsigned int GLIndexBuffer::getRevision() const {
+	return _revision;
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <ciri/graphics/win/gl/GLReadbackRing.hpp>
+
+using namespace ciri;
+
+GLReadbackRing::Slot::Slot()
+	: pbo(0), capacity(0), fence(0) {
+}
+
+GLReadbackRing::GLReadbackRing()
+	: _fbo(0), _pending(0) {
+}
+
+GLReadbackRing::~GLReadbackRing() {
+	destroy();
+}
+
+void GLReadbackRing::destroy() {
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		Slot& slot = _slots[i];
+		if( slot.fence != 0 ) {
+			glDeleteSync(slot.fence);
+			slot.fence = 0;
+			ReadbackWorker::fail(slot.job, ErrorCode::CIRI_UNKNOWN_ERROR);
+		}
+		if( slot.pbo != 0 ) {
+			glDeleteBuffers(1, &slot.pbo);
+			slot.pbo = 0;
+		}
+	}
+	_slots.clear();
+	_pending = 0;
+
+	if( _fbo != 0 ) {
+		glDeleteFramebuffers(1, &_fbo);
+		_fbo = 0;
+	}
+
+	_worker.stop();
+}
+
+std::future<TextureReadback> GLReadbackRing::read( GLuint textureId, TextureFormat::Format format, int width, int height ) {
+	if( 0 == textureId || width <= 0 || height <= 0 ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+
+	GLenum pixelFormat = 0;
+	GLenum pixelType = 0;
+	PixelConversion::Source source = PixelConversion::RGBA8;
+	int shift = 0;
+	getReadFormat(format, &pixelFormat, &pixelType, &source, &shift);
+	const int rowPitch = width * PixelConversion::bytesPerTexel(source);
+	const GLsizeiptr size = static_cast<GLsizeiptr>(rowPitch) * height;
+
+	if( 0 == _fbo ) {
+		glGenFramebuffers(1, &_fbo);
+	}
+
+	// only the read binding is touched, and it is put back afterwards, so the device's render targets stay as they were
+	GLint previousFbo = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFbo);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo);
+
+	const bool isDepth = TextureFormat::isDepth(format);
+	const GLenum attachment = isDepth ? (TextureFormat::hasStencil(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT) : GL_COLOR_ATTACHMENT0;
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textureId, 0);
+	glReadBuffer(isDepth ? GL_NONE : GL_COLOR_ATTACHMENT0);
+
+	const int index = acquireSlot(size);
+	Slot& slot = _slots[index];
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+	if( slot.capacity < size ) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		slot.capacity = size;
+	}
+	// with a pack buffer bound, the copy is queued and glReadPixels returns immediately
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, pixelFormat, pixelType, nullptr);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFbo);
+
+	slot.job = ReadbackJob();
+	slot.job.source = source;
+	slot.job.shift = shift;
+	slot.job.width = width;
+	slot.job.height = height;
+	slot.job.rowPitch = rowPitch;
+	slot.job.flip = false; // gl's rows are already bottom to top
+	_pending += 1;
+	return slot.job.promise.get_future();
+}
+
+void GLReadbackRing::poll() {
+	if( 0 == _pending ) {
+		return;
+	}
+
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		Slot& slot = _slots[i];
+		if( 0 == slot.fence ) {
+			continue;
+		}
+
+		const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+		if( GL_TIMEOUT_EXPIRED == status ) {
+			continue;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+		_pending -= 1;
+
+		if( GL_WAIT_FAILED == status ) {
+			ReadbackWorker::fail(slot.job, ErrorCode::CIRI_UNKNOWN_ERROR);
+			continue;
+		}
+
+		// the copy has finished, so mapping does not wait; only the memcpy happens on this thread
+		const GLsizeiptr size = static_cast<GLsizeiptr>(slot.job.rowPitch) * slot.job.height;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		const unsigned char* mapped = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+		if( nullptr == mapped ) {
+			ReadbackWorker::fail(slot.job, ErrorCode::CIRI_BUFFER_MAP_FAILED);
+		} else {
+			slot.job.data.assign(mapped, mapped + size);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			_worker.submit(std::move(slot.job));
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+}
+
+int GLReadbackRing::getPendingCount() const {
+	return _pending;
+}
+
+void GLReadbackRing::getReadFormat( TextureFormat::Format format, GLenum* outPixelFormat, GLenum* outPixelType, PixelConversion::Source* outSource, int* outShift ) {
+	*outShift = 0;
+
+	if( TextureFormat::isDepth(format) ) {
+		*outPixelFormat = GL_DEPTH_COMPONENT;
+		*outPixelType = GL_UNSIGNED_INT;
+		*outSource = PixelConversion::UInt32;
+		*outShift = 24;
+		return;
+	}
+
+	switch( format ) {
+		case TextureFormat::RGBA32_Float: {
+			*outPixelFormat = GL_RGBA;
+			*outPixelType = GL_FLOAT;
+			*outSource = PixelConversion::RGBA32F;
+			break;
+		}
+
+		case TextureFormat::R32_UINT:
+		case TextureFormat::R32_FLOAT: {
+			// R32_UINT is a normalized single channel texture in gl, so both read back as floats
+			*outPixelFormat = GL_RED;
+			*outPixelType = GL_FLOAT;
+			*outSource = PixelConversion::R32F;
+			break;
+		}
+
+		default: {
+			*outPixelFormat = GL_RGBA;
+			*outPixelType = GL_UNSIGNED_BYTE;
+			*outSource = PixelConversion::RGBA8;
+			break;
+		}
+	}
+}
+
+int GLReadbackRing::acquireSlot( GLsizeiptr size ) {
+	// prefer an idle buffer that is already big enough, then any idle buffer, then a new one
+	int idle = -1;
+	for( unsigned int i = 0; i < _slots.size(); ++i ) {
+		if( _slots[i].fence != 0 ) {
+			continue;
+		}
+		if( _slots[i].capacity >= size ) {
+			return static_cast<int>(i);
+		}
+		if( -1 == idle ) {
+			idle = static_cast<int>(i);
+		}
+	}
+	if( idle != -1 ) {
+		return idle;
+	}
+
+	_slots.push_back(Slot());
+	glGenBuffers(1, &_slots.back().pbo);
+	return static_cast<int>(_slots.size()) - 1;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <ciri/graphics/win/gl/GLRenderTarget2D.hpp>
 #include <ciri/graphics/win/gl/GLTexture2D.hpp>
+#include <ciri/graphics/ReadbackWorker.hpp>
 
 using namespace ciri;
 
@@ -26,4 +27,11 @@ std::shared_ptr<ITexture2D> GLRenderTarget2D::getTexture() const {
 
 std::shared_ptr<ITexture2D> GLRenderTarget2D::getDepth() const {
 	return _depth;
+}
+
+std::future<TextureReadback> GLRenderTarget2D::readAsync() {
+	if( nullptr == _texture ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_INVALID_ARGUMENT);
+	}
+	return _texture->readAsync();
 }
\ No newline at end of file
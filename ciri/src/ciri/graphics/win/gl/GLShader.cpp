@@ -1,11 +1,14 @@
 #include <ciri/graphics/win/gl/GLShader.hpp>
 #include <ciri/graphics/win/gl/GLConstantBuffer.hpp>
-#include <ciri/core/File.hpp>
+#include <ciri/core/FileSystem.hpp>
+#include <algorithm>
+#include <cstring>
 
 using namespace ciri;
 
-GLShader::GLShader()
-	: IShader(), _vertexShader(0), _geometryShader(0), _pixelShader(0), _program(0) {
+GLShader::GLShader( const std::shared_ptr<ShaderCache>& cache, bool parallelCompile )
+	: IShader(), _cache(cache), _parallelCompile(parallelCompile), _cacheKey(0), _pending(false), _vertexShader(0), _geometryShader(0),
+		_pixelShader(0), _program(0) {
 }
 
 GLShader::~GLShader() {
@@ -20,6 +23,16 @@ ErrorCode GLShader::addConstants( const std::shared_ptr<IConstantBuffer>& buffer
 		return ErrorCode::CIRI_INVALID_ARGUMENT;
 	}
 
+	// block indices are only known once linked
+	if( _pending ) {
+		DeferredConstants deferred;
+		deferred.buffer = buffer;
+		deferred.name = name;
+		deferred.shaderTypeFlags = shaderTypeFlags;
+		_deferredConstants.push_back(deferred);
+		return ErrorCode::CIRI_OK;
+	}
+
 	if( !isValid() ) {
 		return ErrorCode::CIRI_SHADER_INVALID;
 	}
@@ -43,6 +56,11 @@ ErrorCode GLShader::addConstants( const std::shared_ptr<IConstantBuffer>& buffer
 	glUniformBlockBinding(_program, blockIndex, glBuffer->getIndex());
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+	// kept so the device can move ring-backed data forward before drawing
+	if( std::find(_constantBuffers.begin(), _constantBuffers.end(), glBuffer) == _constantBuffers.end() ) {
+		_constantBuffers.push_back(glBuffer);
+	}
+
 	return ErrorCode::CIRI_OK;
 }
 
@@ -56,8 +74,8 @@ ErrorCode GLShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	}
 
 	// load vs file
-	File vsFile(vs, File::Flags::ReadOnly);
-	if( !vsFile.isOpen() ) {
+	const FileData vsFile = FileSystem::read(vs);
+	if( !vsFile.isValid() ) {
 		addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + vs + std::string(")"));
 		return ErrorCode::CIRI_FILE_NOT_FOUND;
 	}
@@ -66,8 +84,8 @@ ErrorCode GLShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	// load gs file
 	std::string gsStr = ""; // optional shader, so create empty string for it now
 	if( gs != nullptr ) {
-		File gsFile(gs, File::Flags::ReadOnly);
-		if( !gsFile.isOpen() ) {
+		const FileData gsFile = FileSystem::read(gs);
+		if( !gsFile.isValid() ) {
 			addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + gs + std::string(")"));
 			return ErrorCode::CIRI_FILE_NOT_FOUND;
 		}
@@ -75,8 +93,8 @@ ErrorCode GLShader::loadFromFile( const char* vs, const char* gs, const char* ps
 	}
 
 	// load ps file
-	File psFile(ps, File::Flags::ReadOnly);
-	if( !psFile.isOpen() ) {
+	const FileData psFile = FileSystem::read(ps);
+	if( !psFile.isValid() ) {
 		addError(ErrorCode::CIRI_FILE_NOT_FOUND, getErrorString(ErrorCode::CIRI_FILE_NOT_FOUND) + std::string(" (") + ps + std::string(")"));
 		return ErrorCode::CIRI_FILE_NOT_FOUND;
 	}
@@ -89,6 +107,8 @@ ErrorCode GLShader::loadFromMemory( const char* vs, const char* gs, const char*
 	// todo: if valid, destroy and make new one
 
 	clearErrors();
+	_pending = false;
+	_deferredConstants.clear();
 
 	// must have at least VS and PS
 	if( nullptr == vs || nullptr == ps ) {
@@ -96,47 +116,18 @@ ErrorCode GLShader::loadFromMemory( const char* vs, const char* gs, const char*
 		return ErrorCode::CIRI_SHADER_INCOMPLETE;
 	}
 
-	const int ERROR_LOG_SIZE = 1024;
-	GLint status = GL_TRUE;
-
-	// build the vertex shader
-	{
-		_vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(_vertexShader, 1, (const GLchar**)&vs, 0);
-		glCompileShader(_vertexShader);
-		glGetShaderiv(_vertexShader, GL_COMPILE_STATUS, &status);
-		if( status != GL_TRUE ) {
-			GLchar log[ERROR_LOG_SIZE] = "";
-			glGetShaderInfoLog(_vertexShader, ERROR_LOG_SIZE, 0, log);
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string(log));
-		}
+	_cacheKey = (_cache != nullptr) ? _cache->makeKey(vs, gs, ps, 0) : 0;
+	if( loadFromCache() ) {
+		processUniforms();
+		return ErrorCode::CIRI_OK;
 	}
 
-	// build the geometry shader
+	// build the shaders; nothing is queried here so the driver is free to compile them in the background
+	_vertexShader = compileStage(GL_VERTEX_SHADER, vs);
 	if( gs != nullptr ) {
-		_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
-		glShaderSource(_geometryShader, 1, (const GLchar**)&gs, 0);
-		glCompileShader(_geometryShader);
-		glGetShaderiv(_geometryShader, GL_COMPILE_STATUS, &status);
-		if( status != GL_TRUE ) {
-			GLchar log[ERROR_LOG_SIZE] = "";
-			glGetShaderInfoLog(_geometryShader, ERROR_LOG_SIZE, 0, log);
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string(log));
-		}
-	}
-
-	// build the fragment shader
-	{
-		_pixelShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(_pixelShader, 1, (const GLchar**)&ps, 0);
-		glCompileShader(_pixelShader);
-		glGetShaderiv(_pixelShader, GL_COMPILE_STATUS, &status);
-		if( status != GL_TRUE ) {
-			GLchar log[ERROR_LOG_SIZE] = "";
-			glGetShaderInfoLog(_pixelShader, ERROR_LOG_SIZE, 0, log);
-			addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string(log));
-		}
+		_geometryShader = compileStage(GL_GEOMETRY_SHADER, gs);
 	}
+	_pixelShader = compileStage(GL_FRAGMENT_SHADER, ps);
 
 	// create the program and link the shaders
 	_program = glCreateProgram();
@@ -145,23 +136,13 @@ ErrorCode GLShader::loadFromMemory( const char* vs, const char* gs, const char*
 		glAttachShader(_program, _geometryShader);
 	}
 	glAttachShader(_program, _pixelShader);
-	glLinkProgram(_program);
-	glGetProgramiv(_program, GL_LINK_STATUS, &status);
-	if( status != GL_TRUE ) {
-		GLchar log[ERROR_LOG_SIZE] = "";
-		glGetProgramInfoLog(_program, ERROR_LOG_SIZE, 0, log);
-		addError(ErrorCode::CIRI_SHADER_LINK_FAILED, getErrorString(ErrorCode::CIRI_SHADER_LINK_FAILED) + std::string(": ") + std::string(log));
-	}
-
-	// process uniforms
-	processUniforms();
-
-	// if any errors have occurred, clean up and return the first error code
-	if( !_errors.empty() ) {
-		destroy();
-		return _errors[0].code;
+	if( _cache != nullptr && _cache->isEnabled() ) {
+		glProgramParameteri(_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
+	glLinkProgram(_program);
 
+	// statuses are checked once the shader is waited on
+	_pending = true;
 	return ErrorCode::CIRI_OK;
 }
 
@@ -185,6 +166,10 @@ void GLShader::destroy() {
 		glDeleteProgram(_program);
 		_program = 0;
 	}
+
+	_constantBuffers.clear();
+	_deferredConstants.clear();
+	_pending = false;
 }
 
 const std::vector<IShader::ShaderError>& GLShader::getErrors() const {
@@ -192,7 +177,30 @@ const std::vector<IShader::ShaderError>& GLShader::getErrors() const {
 }
 
 bool GLShader::isValid() const {
-	return (_vertexShader != 0) && (_pixelShader != 0);
+	if( _pending ) {
+		// linking fails if any stage failed to compile, so the link status covers them all
+		if( !isCompileFinished() ) {
+			return false;
+		}
+		GLint status = GL_FALSE;
+		glGetProgramiv(_program, GL_LINK_STATUS, &status);
+		return GL_TRUE == status;
+	}
+	return _program != 0;
+}
+
+bool GLShader::isPending() const {
+	return _pending && !isCompileFinished();
+}
+
+ErrorCode GLShader::wait() {
+	if( _pending ) {
+		finish();
+	}
+	if( !_errors.empty() ) {
+		return _errors[0].code;
+	}
+	return isValid() ? ErrorCode::CIRI_OK : ErrorCode::CIRI_SHADER_INVALID;
 }
 
 GLuint GLShader::getVertexShader() const {
@@ -215,6 +223,10 @@ const VertexDeclaration& GLShader::getVertexDeclaration() const {
 	return _vertexDeclaration;
 }
 
+const std::vector<std::shared_ptr<GLConstantBuffer>>& GLShader::getConstants() const {
+	return _constantBuffers;
+}
+
 void GLShader::addError( ErrorCode code, const std::string& msg ) {
 	_errors.push_back(ShaderError(code, msg));
 }
@@ -264,4 +276,115 @@ void GLShader::processUniforms() {
 	//name = nullptr;
 
 	//glUseProgram(0);
+}
+
+GLuint GLShader::compileStage( GLenum type, const char* source ) const {
+	const GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, (const GLchar**)&source, 0);
+	glCompileShader(shader);
+	return shader;
+}
+
+void GLShader::checkStage( GLuint shader ) {
+	if( 0 == shader ) {
+		return;
+	}
+
+	GLint status = GL_TRUE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if( status != GL_TRUE ) {
+		const int ERROR_LOG_SIZE = 1024;
+		GLchar log[ERROR_LOG_SIZE] = "";
+		glGetShaderInfoLog(shader, ERROR_LOG_SIZE, 0, log);
+		addError(ErrorCode::CIRI_SHADER_COMPILE_FAILED, getErrorString(ErrorCode::CIRI_SHADER_COMPILE_FAILED) + std::string(": ") + std::string(log));
+	}
+}
+
+bool GLShader::loadFromCache() {
+	if( nullptr == _cache || !_cache->isEnabled() ) {
+		return false;
+	}
+
+	// entries are the binary format followed by the binary
+	std::vector<char> data;
+	if( !_cache->load(_cacheKey, data) || data.size() <= sizeof(GLenum) ) {
+		return false;
+	}
+	GLenum format = 0;
+	memcpy(&format, data.data(), sizeof(format));
+
+	_program = glCreateProgram();
+	glProgramBinary(_program, format, data.data() + sizeof(format), static_cast<GLsizei>(data.size() - sizeof(format)));
+	GLint status = GL_FALSE;
+	glGetProgramiv(_program, GL_LINK_STATUS, &status);
+	if( status != GL_TRUE ) {
+		// drivers may reject a binary for any reason, such as an update that kept the same version string; compile it instead
+		glDeleteProgram(_program);
+		_program = 0;
+		_cache->remove(_cacheKey);
+		return false;
+	}
+	return true;
+}
+
+void GLShader::storeInCache() {
+	if( nullptr == _cache || !_cache->isEnabled() ) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if( length <= 0 ) {
+		return;
+	}
+	std::vector<char> data(sizeof(GLenum) + static_cast<size_t>(length));
+	GLenum format = 0;
+	glGetProgramBinary(_program, length, nullptr, &format, data.data() + sizeof(format));
+	memcpy(data.data(), &format, sizeof(format));
+	_cache->store(_cacheKey, data.data(), data.size());
+}
+
+void GLShader::finish() {
+	_pending = false;
+
+	checkStage(_vertexShader);
+	checkStage(_geometryShader);
+	checkStage(_pixelShader);
+
+	GLint status = GL_TRUE;
+	glGetProgramiv(_program, GL_LINK_STATUS, &status);
+	if( status != GL_TRUE ) {
+		const int ERROR_LOG_SIZE = 1024;
+		GLchar log[ERROR_LOG_SIZE] = "";
+		glGetProgramInfoLog(_program, ERROR_LOG_SIZE, 0, log);
+		addError(ErrorCode::CIRI_SHADER_LINK_FAILED, getErrorString(ErrorCode::CIRI_SHADER_LINK_FAILED) + std::string(": ") + std::string(log));
+	}
+
+	// if any errors have occurred, clean up
+	if( !_errors.empty() ) {
+		destroy();
+		return;
+	}
+
+	processUniforms();
+	storeInCache();
+
+	// a constant buffer that does not match is reported like any other error, but does not invalidate the shader
+	std::vector<DeferredConstants> deferred;
+	deferred.swap(_deferredConstants);
+	for( unsigned int i = 0; i < deferred.size(); ++i ) {
+		const ErrorCode result = addConstants(deferred[i].buffer, deferred[i].name.c_str(), deferred[i].shaderTypeFlags);
+		if( failed(result) ) {
+			addError(result, getErrorString(result) + std::string(" (constants ") + deferred[i].name + std::string(")"));
+		}
+	}
+}
+
+bool GLShader::isCompileFinished() const {
+	if( !_parallelCompile ) {
+		return true; // no way to ask; querying anything else waits for it
+	}
+	GLint finished = GL_TRUE;
+	glGetProgramiv(_program, GL_COMPLETION_STATUS_KHR, &finished);
+	return finished != GL_FALSE;
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include <ciri/graphics/win/gl/GLTexture2D.hpp>
+#include <ciri/graphics/win/gl/GLUploadUnit.hpp>
 #include <ciri/graphics/win/gl/CiriToGl.hpp>
 #include <ciri/core/TGA.hpp>
 #include <ciri/graphics/win/gl/CheckGLError.hpp>
+#include <ciri/graphics/win/gl/GLReadbackRing.hpp>
 
 using namespace ciri;
 
-GLTexture2D::GLTexture2D( int flags )
-	: ITexture2D(flags), _flags(flags), _format(TextureFormat::RGBA32_UINT), _textureId(0), _internalFormat(0), _pixelFormat(0), _pixelType(0), _width(0), _height(0) {
+GLTexture2D::GLTexture2D( int flags, const std::shared_ptr<GLReadbackRing>& readback )
+	: ITexture2D(flags), _readback(readback), _flags(flags), _format(TextureFormat::RGBA32_UINT), _textureId(0), _revision(0), _internalFormat(0), _pixelFormat(0), _pixelType(0), _width(0), _height(0) {
 }
 
 GLTexture2D::~GLTexture2D() {
@@ -38,6 +40,7 @@ ErrorCode GLTexture2D::setData( int xOffset, int yOffset, int width, int height,
 		//
 
 		const int level = 0; // todo
+		glActiveTexture(GL_TEXTURE0 + CIRI_GL_UPLOAD_TEXTURE_UNIT);
 		glBindTexture(GL_TEXTURE_2D, _textureId);
 		glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::getAlignment(format));
 		glTexSubImage2D(GL_TEXTURE_2D, level, xOffset, yOffset, width, height, _pixelFormat, _pixelType, data);
@@ -68,6 +71,8 @@ ErrorCode GLTexture2D::setData( int xOffset, int yOffset, int width, int height,
 	const int level = 0; // todo
 	// generate and bind the texture
 	glGenTextures(1, &_textureId);
+	_revision += 1;
+	glActiveTexture(GL_TEXTURE0 + CIRI_GL_UPLOAD_TEXTURE_UNIT);
 	glBindTexture(GL_TEXTURE_2D, _textureId);
 	// change the pixel store to match that of the format's bytes per pixel
 	glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::getAlignment(format));
@@ -108,63 +113,38 @@ ErrorCode GLTexture2D::writeToTGA( const char* file ) {
 		return ErrorCode::CIRI_UNKNOWN_ERROR; // todo
 	}
 
+	// note: this reads back synchronously and stalls until the gpu catches up; readAsync does not
+	GLenum pixelFormat = 0;
+	GLenum pixelType = 0;
+	PixelConversion::Source source = PixelConversion::RGBA8;
+	int shift = 0;
+	GLReadbackRing::getReadFormat(_format, &pixelFormat, &pixelType, &source, &shift);
+
 	GLuint tmpFbo;
 	glGenFramebuffers(1, &tmpFbo);
 	glBindFramebuffer(GL_FRAMEBUFFER, tmpFbo);
 
-	std::vector<unsigned char> pixels;
-
 	if( TextureFormat::isDepth(_format) ) {
-		if( TextureFormat::hasStencil(_format) ) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _textureId, 0);
-			std::vector<GLuint> rawPixels(_width * _height);
-			glReadPixels(0, 0, _width, _height, _pixelFormat, _pixelType, rawPixels.data());
-			for( int i = 0; i < _width*_height; ++i ) {
-				const GLuint rawVal = rawPixels[i];
-				const unsigned char newVal = (rawVal >> 8) & 0xFF;
-				pixels.push_back(newVal);//r
-				pixels.push_back(newVal);//g
-				pixels.push_back(newVal);//b
-			}
-			// todo: modify this function to write depth and stencil rather than just depth
-		} else {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _textureId, 0);
-			std::vector<GLuint> rawPixels(_width * _height);
-			// note: using GL_UNSIGNED_INT as GL_DEPTH_COMPONENT24 converts to int anyway.
-			glReadPixels(0, 0, _width, _height, _pixelFormat, GL_UNSIGNED_INT, rawPixels.data());
-			for( int i = 0; i < _width * _height; ++i ) {
-				const GLuint rawVal = rawPixels[i];
-				const unsigned char newVal = (rawVal >> 8) & 0xFF;
-				pixels.push_back(newVal);
-				pixels.push_back(newVal);
-				pixels.push_back(newVal);
-			}
-		}
+		// todo: modify this function to write depth and stencil rather than just depth
+		const GLenum attachment = TextureFormat::hasStencil(_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, _textureId, 0);
 	} else {
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _textureId, 0);
-
-		if( TextureFormat::isFloat(_format) ) {
-			// note: this is separated b/c floating point texture formats will be added at some point.
-			std::vector<float> rawPixels(_width * _height * TextureFormat::bytesPerPixel(_format));
-			glReadPixels(0, 0, _width, _height, _pixelFormat, _pixelType, rawPixels.data());
-			for( int i = 0; i < _width * _height * TextureFormat::bytesPerPixel(_format); i += TextureFormat::bytesPerPixel(_format) ) {
-				for( int j = 0; j < TextureFormat::bytesPerPixel(_format); ++j ) {
-					pixels.push_back(rawPixels[i+j] * 255.0);
-				}
-			}
-		} else {
-			pixels.resize(_width * _height * TextureFormat::bytesPerPixel(_format));
-			glReadPixels(0, 0, _width, _height, _pixelFormat, _pixelType, pixels.data());
-		}
 	}
 
-	glDeleteFramebuffers(1, &tmpFbo);
+	std::vector<unsigned char> rawPixels(_width * _height * PixelConversion::bytesPerTexel(source));
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, _width, _height, pixelFormat, pixelType, rawPixels.data());
 
-	if( !TGA::writeToFile(file, _width, _height, pixels.data(), TextureFormat::hasAlpha(_format)?TGA::RGBA:TGA::RGB, true) ) {
-		return ErrorCode::CIRI_UNKNOWN_ERROR;
-	}
+	glDeleteFramebuffers(1, &tmpFbo);
 
-	return ErrorCode::CIRI_OK;
+	TextureReadback readback;
+	readback.error = ErrorCode::CIRI_OK;
+	readback.width = _width;
+	readback.height = _height;
+	readback.pixels.resize(_width * _height * 4);
+	PixelConversion::toRGBA8(source, shift, rawPixels.data(), readback.pixels.data(), _width * _height);
+	return readback.writeToTGA(file);
 }
 
 ErrorCode GLTexture2D::writeToDDS( const char* file ) {
@@ -172,6 +152,17 @@ ErrorCode GLTexture2D::writeToDDS( const char* file ) {
 	return ErrorCode::CIRI_NOT_IMPLEMENTED;;
 }
 
+std::future<TextureReadback> GLTexture2D::readAsync() {
+	if( nullptr == _readback ) {
+		return ReadbackWorker::makeFailed(ErrorCode::CIRI_UNKNOWN_ERROR);
+	}
+	return _readback->read(_textureId, _format, _width, _height);
+}
+
 GLuint GLTexture2D::getTextureId() const {
 	return _textureId;
 }
+
+unsigned int GLTexture2D::getRevision() const {
+	return _revision;
+}
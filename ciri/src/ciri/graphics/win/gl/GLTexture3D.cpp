@@ -1,10 +1,11 @@
 #include <ciri/graphics/win/gl/GLTexture3D.hpp>
+#include <ciri/graphics/win/gl/GLUploadUnit.hpp>
 #include <ciri/graphics/win/gl/CiriToGl.hpp>
 
 using namespace ciri;
 
 GLTexture3D::GLTexture3D( int flags )
-	: ITexture3D(flags), _flags(flags), _format(TextureFormat::RGBA32_UINT), _textureId(0), _internalFormat(0), _pixelFormat(0), _pixelType(0), _width(0), _height(0), _depth(0) {
+	: ITexture3D(flags), _flags(flags), _format(TextureFormat::RGBA32_UINT), _textureId(0), _revision(0), _internalFormat(0), _pixelFormat(0), _pixelType(0), _width(0), _height(0), _depth(0) {
 }
 
 GLTexture3D::~GLTexture3D() {
@@ -38,6 +39,8 @@ ErrorCode GLTexture3D::setData( int width, int height, int depth, void* data, Te
 
 	// generate and bind the texture
 	glGenTextures(1, &_textureId);
+	_revision += 1;
+	glActiveTexture(GL_TEXTURE0 + CIRI_GL_UPLOAD_TEXTURE_UNIT);
 	glBindTexture(GL_TEXTURE_3D, _textureId);
 	// change the pixel store to match the format's bytes per pixel
 	glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::getAlignment(format));
@@ -83,4 +86,8 @@ ErrorCode GLTexture3D::writeToDDS( const char* file ) {
 	
 GLuint GLTexture3D::getTextureId() const {
 	return _textureId;
+}
+
+unsigned int GLTexture3D::getRevision() const {
+	return _revision;
 }
\ No newline at end of file
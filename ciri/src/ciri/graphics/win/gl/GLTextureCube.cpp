@@ -1,9 +1,10 @@
 #include <ciri/graphics/win/gl/GLTextureCube.hpp>
+#include <ciri/graphics/win/gl/GLUploadUnit.hpp>
 
 using namespace ciri;
 
 GLTextureCube::GLTextureCube()
-	: ITextureCube(), _textureId(0) {
+	: ITextureCube(), _textureId(0), _revision(0) {
 }
 
 GLTextureCube::~GLTextureCube() {
@@ -32,6 +33,8 @@ ErrorCode GLTextureCube::set( int width, int height, void* posx, void* negx, voi
 
 	// generate and bind texture
 	glGenTextures(1, &_textureId);
+	_revision += 1;
+	glActiveTexture(GL_TEXTURE0 + CIRI_GL_UPLOAD_TEXTURE_UNIT);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, _textureId);
 
 	// set the texture data for each face
@@ -57,4 +60,8 @@ void GLTextureCube::destroy() {
 
 GLuint GLTextureCube::getTextureId() const {
 	return _textureId;
+}
+
+unsigned int GLTextureCube::getRevision() const {
+	return _revision;
 }
\ No newline at end of file
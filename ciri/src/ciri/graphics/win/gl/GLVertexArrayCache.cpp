@@ -0,0 +1,156 @@
+#include <ciri/graphics/win/gl/GLVertexArrayCache.hpp>
+#include <ciri/graphics/win/gl/GLVertexBuffer.hpp>
+#include <ciri/graphics/win/gl/GLIndexBuffer.hpp>
+#include <ciri/graphics/win/gl/CiriToGl.hpp>
+
+using namespace ciri;
+
+GLVertexArrayCache::GLVertexArrayCache()
+	: _boundVao(0) {
+}
+
+GLVertexArrayCache::~GLVertexArrayCache() {
+}
+
+bool GLVertexArrayCache::bind( const VertexDeclaration& declaration, const std::shared_ptr<GLVertexBuffer>* vertexBuffers, const std::shared_ptr<GLIndexBuffer>& indexBuffer, GraphicsStateCache& counts ) {
+	// every stream the declaration reads from must be bound; the rest do not take part in the key
+	const int streamCount = (declaration.getStreamCount() > 0) ? declaration.getStreamCount() : 1;
+	Key key;
+	key.layout = declaration.getHash();
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		key.vbos[i] = 0;
+		if( i >= streamCount ) {
+			continue;
+		}
+		if( nullptr == vertexBuffers[i] || 0 == vertexBuffers[i]->getVbo() ) {
+			return false;
+		}
+		key.vbos[i] = vertexBuffers[i]->getVbo();
+	}
+	key.ibo = (indexBuffer != nullptr) ? indexBuffer->getEvbo() : 0;
+
+	auto found = _entries.find(key);
+	if( found == _entries.end() ) {
+		Entry entry;
+		glGenVertexArrays(1, &entry.vao);
+		specify(entry, declaration, vertexBuffers, indexBuffer, counts);
+		_entries[key] = entry;
+		return true;
+	}
+
+	// same names but different objects (or the same objects recreated) means gl recycled a name; build again on the same vao
+	Entry& entry = found->second;
+	bool vertexChanged = false;
+	for( int i = 0; i < streamCount && !vertexChanged; ++i ) {
+		vertexChanged = !isSameObject(entry.vertexBuffers[i], vertexBuffers[i]) || entry.vertexRevisions[i] != vertexBuffers[i]->getRevision();
+	}
+	const bool indexChanged = (indexBuffer != nullptr) && (!isSameObject(entry.indexBuffer, indexBuffer) || entry.indexRevision != indexBuffer->getRevision());
+	if( vertexChanged || indexChanged ) {
+		specify(entry, declaration, vertexBuffers, indexBuffer, counts);
+		return true;
+	}
+
+	if( entry.vao != _boundVao ) {
+		glBindVertexArray(entry.vao);
+		_boundVao = entry.vao;
+		counts.countVertexInputBind();
+	}
+	return true;
+}
+
+void GLVertexArrayCache::sweep() {
+	for( auto it = _entries.begin(); it != _entries.end(); ) {
+		bool released = (it->first.ibo != 0) && it->second.indexBuffer.expired();
+		for( int i = 0; i < it->second.streamCount && !released; ++i ) {
+			released = it->second.vertexBuffers[i].expired();
+		}
+		if( !released ) {
+			++it;
+			continue;
+		}
+		if( it->second.vao == _boundVao ) {
+			_boundVao = 0;
+		}
+		glDeleteVertexArrays(1, &it->second.vao);
+		it = _entries.erase(it);
+	}
+}
+
+void GLVertexArrayCache::clear() {
+	for( auto& entry : _entries ) {
+		glDeleteVertexArrays(1, &entry.second.vao);
+	}
+	_entries.clear();
+	_boundVao = 0;
+}
+
+void GLVertexArrayCache::invalidateBinding() {
+	_boundVao = 0;
+}
+
+int GLVertexArrayCache::getCount() const {
+	return static_cast<int>(_entries.size());
+}
+
+bool GLVertexArrayCache::Key::operator==( const Key& rhs ) const {
+	if( layout != rhs.layout || ibo != rhs.ibo ) {
+		return false;
+	}
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		if( vbos[i] != rhs.vbos[i] ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t GLVertexArrayCache::KeyHash::operator()( const Key& key ) const {
+	size_t hash = key.layout;
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		hash ^= static_cast<size_t>(key.vbos[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+	hash ^= static_cast<size_t>(key.ibo) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+void GLVertexArrayCache::specify( Entry& entry, const VertexDeclaration& declaration, const std::shared_ptr<GLVertexBuffer>* vertexBuffers, const std::shared_ptr<GLIndexBuffer>& indexBuffer, GraphicsStateCache& counts ) {
+	glBindVertexArray(entry.vao);
+	_boundVao = entry.vao;
+	counts.countVertexInputBind();
+
+	// attribute pointers capture whatever is bound to GL_ARRAY_BUFFER at the time they are set
+	const std::vector<VertexElement>& elements = declaration.getElements();
+	for( unsigned int i = 0; i < elements.size(); ++i ) {
+		const VertexElement& currElement = elements[i];
+		const int slot = currElement.getSlot();
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[slot]->getVbo());
+
+		GLint size = 0;
+		GLenum type = GL_FLOAT;
+		GLboolean normalized = GL_FALSE;
+		ciriToGlVertexFormat(currElement.getFormat(), &size, &type, &normalized);
+
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, size, type, normalized, declaration.getStride(slot), reinterpret_cast<const void*>(static_cast<intptr_t>(declaration.getOffset(i))));
+		// divisor state lives in the vao, so it must be written for per-vertex attributes too
+		glVertexAttribDivisor(i, currElement.getInstanceStepRate());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	counts.countVertexAttributeSetups(static_cast<int>(elements.size()));
+
+	// the element buffer binding is part of the vao itself
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (indexBuffer != nullptr) ? indexBuffer->getEvbo() : 0);
+
+	entry.streamCount = (declaration.getStreamCount() > 0) ? declaration.getStreamCount() : 1;
+	for( int i = 0; i < VertexDeclaration::MAX_STREAMS; ++i ) {
+		const bool used = (i < entry.streamCount);
+		entry.vertexBuffers[i] = used ? vertexBuffers[i] : nullptr;
+		entry.vertexRevisions[i] = used ? vertexBuffers[i]->getRevision() : 0;
+	}
+	entry.indexBuffer = indexBuffer;
+	entry.indexRevision = (indexBuffer != nullptr) ? indexBuffer->getRevision() : 0;
+}
+
+bool GLVertexArrayCache::isSameObject( const std::weak_ptr<void>& a, const std::shared_ptr<void>& b ) {
+	return !a.owner_before(b) && !b.owner_before(a);
+}
\ No newline at end of file
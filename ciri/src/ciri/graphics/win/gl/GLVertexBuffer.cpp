@@ -3,7 +3,7 @@
 using namespace ciri;
 
 GLVertexBuffer::GLVertexBuffer()
-	: IVertexBuffer(), _vbo(0), _vertexStride(0), _vertexCount(0), _isDynamic(false) {
+	: IVertexBuffer(), _vbo(0), _revision(0), _vertexStride(0), _vertexCount(0), _isDynamic(false) {
 }
 
 GLVertexBuffer::~GLVertexBuffer() {
@@ -58,9 +58,14 @@ GLuint GLVertexBuffer::getVbo() const {
 	return _vbo;
 }
 
+unsigned int GLVertexBuffer::getRevision() const {
+	return _revision;
+}
+
 ErrorCode GLVertexBuffer::createBuffer( void* vertices, int vertexStride, int vertexCount, bool dynamic ) {
 	// generate a new buffer, bind it, set the data, and unbind it
 	glGenBuffers(1, &_vbo);
+	_revision += 1;
 	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
 	glBufferData(GL_ARRAY_BUFFER, vertexStride * vertexCount, vertices, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
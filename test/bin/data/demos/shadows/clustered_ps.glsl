@@ -0,0 +1,65 @@
+#version 420
+
+// offset and count of each cluster's lights, tilesX wide and tilesY*slices high
+layout(binding=0) uniform sampler2D ClusterGrid;
+// light indices of every cluster, one after another, 1024 to a row
+layout(binding=1) uniform sampler2D ClusterIndices;
+// three texels per light: position and range, color and cos inner, direction and cos outer
+layout(binding=2) uniform sampler2D ClusterLights;
+
+layout(std140) uniform ClusteredConstants {
+	mat4 world;
+	mat4 xform;
+	vec3 campos;
+	float SliceScale;
+	vec3 CameraFront;
+	float SliceBias;
+	vec2 TileScale;
+	int TilesX;
+	int TilesY;
+	int Slices;
+};
+
+in vec3 vo_wpos;
+in vec3 vo_wnrm;
+
+out vec4 out_color;
+
+void main() {
+	// tiles count up from the bottom of the screen, as gl_FragCoord does, and slices are exponential in view depth
+	float depth = dot(vo_wpos - campos, CameraFront);
+	int slice = clamp(int(floor(log(max(depth, 0.0001)) * SliceScale + SliceBias)), 0, Slices - 1);
+	ivec2 tile = clamp(ivec2(gl_FragCoord.xy * TileScale), ivec2(0), ivec2(TilesX - 1, TilesY - 1));
+	vec2 cluster = texelFetch(ClusterGrid, ivec2(tile.x, tile.y + slice * TilesY), 0).xy;
+	int offset = int(cluster.x);
+	int count = int(cluster.y);
+
+	vec3 N = normalize(vo_wnrm);
+	vec3 V = normalize(campos - vo_wpos);
+	float SPECPOW = 48.0;
+	vec3 lighting = vec3(0.0);
+	for( int i = 0; i < count; ++i ) {
+		int entry = offset + i;
+		int light = int(texelFetch(ClusterIndices, ivec2(entry % 1024, entry / 1024), 0).r);
+		vec4 positionRange = texelFetch(ClusterLights, ivec2(0, light), 0);
+		vec4 colorCosInner = texelFetch(ClusterLights, ivec2(1, light), 0);
+		vec4 directionCosOuter = texelFetch(ClusterLights, ivec2(2, light), 0);
+
+		// light vector and distance to light
+		vec3 L = positionRange.xyz - vo_wpos;
+		float distToLight = length(L);
+		L = L / max(distToLight, 0.0001);
+
+		// point lights have cone angles that every direction is inside
+		float spotEffect = smoothstep(directionCosOuter.w, colorCosInner.w, dot(L, -directionCosOuter.xyz));
+		float attenuation = smoothstep(positionRange.w, 0.0, distToLight);
+
+		float diffuseLight = max(dot(N, L), 0.0);
+		vec3 H = normalize(L + V);
+		vec3 R = reflect(-L, N);
+		float specularLight = pow(clamp(dot(R, H), 0.0, 1.0), SPECPOW);
+		lighting += ((diffuseLight + specularLight) * colorCosInner.rgb) * spotEffect * attenuation;
+	}
+
+	out_color = vec4(lighting, 1.0);
+}
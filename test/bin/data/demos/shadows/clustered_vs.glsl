@@ -0,0 +1,28 @@
+#version 420
+
+layout(location=0) in vec3 in_position;
+layout(location=1) in vec3 in_normal;
+layout(location=2) in vec4 in_tangent;
+layout(location=3) in vec2 in_texcoord;
+
+layout(std140) uniform ClusteredConstants {
+	mat4 world;
+	mat4 xform;
+	vec3 campos;
+	float SliceScale;
+	vec3 CameraFront;
+	float SliceBias;
+	vec2 TileScale;
+	int TilesX;
+	int TilesY;
+	int Slices;
+};
+
+out vec3 vo_wpos;
+out vec3 vo_wnrm;
+
+void main() {
+	gl_Position = xform * vec4(in_position, 1.0);
+	vo_wpos = (world * vec4(in_position, 1.0)).xyz;
+	vo_wnrm = (world * vec4(in_normal, 0.0)).xyz;
+}
@@ -2,6 +2,20 @@
 
 uniform sampler2D DepthTexture;
 
+layout(std140) uniform DirectionalConstants {
+	mat4 world;
+	mat4 xform;
+	vec3 campos;
+	float LightIntensity;
+	vec3 LightDirection;
+	int CastShadows;
+	vec3 LightColor;
+	float pad0;
+	mat4 cascadeViewProj[4];
+	vec4 cascadeRects[4];
+	int CascadeCount;
+};
+
 in vec3 vo_wpos;
 in vec3 vo_wnrm;
 in vec3 vo_campos;
@@ -9,7 +23,6 @@ in vec3 vo_LightDirection;
 in vec3 vo_LightColor;
 in float vo_LightIntensity;
 flat in int vo_CastShadows;
-in vec4 vo_wposLightSpace;
 
 out vec4 out_color;
 
@@ -35,17 +48,21 @@ void main() {
 
 	float visibility = 1.0;
 	if( vo_CastShadows != 0 ) {
-		vec3 screenPos = vo_wposLightSpace.xyz / vo_wposLightSpace.w;
-		screenPos = screenPos * 0.5 + 0.5;
-		if( screenPos.z > 1.0 ) {
-			visibility = 1.0;
-		} else {
-			float bias = clamp(0.005 * tan(acos(diffuseLight)), 0.0, 0.006);
-			// float depthSample = texture(DepthTexture, screenPos.xy).x;
-			// visibility = depthSample < (screenPos.z - bias) ? 0.0 : visibility;
+		// cascades go from near to far, so the first whose map covers the point is the sharpest one that does
+		vec2 texelSize = 1.0 / textureSize(DepthTexture, 0);
+		for( int i = 0; i < CascadeCount; ++i ) {
+			vec4 lightSpace = cascadeViewProj[i] * vec4(vo_wpos, 1.0);
+			vec3 screenPos = (lightSpace.xyz / lightSpace.w) * 0.5 + 0.5;
+			// the pcf kernel must stay inside the cascade's own tile of the atlas
+			vec2 rectMin = cascadeRects[i].xy + texelSize * 1.5;
+			vec2 rectMax = cascadeRects[i].zw - texelSize * 1.5;
+			if( any(lessThan(screenPos.xy, rectMin)) || any(greaterThan(screenPos.xy, rectMax)) || screenPos.z > 1.0 ) {
+				continue;
+			}
 
+			// farther cascades cover more per texel and need more bias
+			float bias = clamp(0.005 * tan(acos(diffuseLight)), 0.0, 0.006) * float(i + 1);
 			float shadowFactor = 0.0;
-			vec2 texelSize = 1.0 / textureSize(DepthTexture, 0);
 			for( int y = -1; y <= 1; ++y ) {
 				for( int x = -1; x <= 1; ++x ) {
 					vec2 offset = vec2(x, y) * texelSize;
@@ -54,8 +71,7 @@ void main() {
 			}
 			shadowFactor /= 9.0;
 			visibility = 1.0f-shadowFactor;
-
-			
+			break;
 		}
 	}
 
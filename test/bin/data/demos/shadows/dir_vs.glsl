@@ -14,7 +14,9 @@ layout(std140) uniform DirectionalConstants {
 	int CastShadows;
 	vec3 LightColor;
 	float pad0;
-	mat4 lightViewProj;
+	mat4 cascadeViewProj[4];
+	vec4 cascadeRects[4];
+	int CascadeCount;
 };
 
 out vec3 vo_wpos;
@@ -24,7 +26,6 @@ out vec3 vo_LightDirection;
 out vec3 vo_LightColor;
 out float vo_LightIntensity;
 flat out int vo_CastShadows;
-out vec4 vo_wposLightSpace;
 
 void main() {
 	gl_Position = xform * vec4(in_position, 1.0);
@@ -35,5 +36,4 @@ void main() {
 	vo_LightColor = LightColor;
 	vo_LightIntensity = LightIntensity;
 	vo_CastShadows = CastShadows;
-	vo_wposLightSpace = lightViewProj * vec4(vo_wpos, 1.0);
 }
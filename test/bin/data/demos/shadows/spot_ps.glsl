@@ -14,6 +14,7 @@ in float vo_LightIntensity;
 in float vo_LightRange;
 flat in int vo_CastShadows;
 in vec4 vo_wposLightSpace;
+flat in vec4 vo_ShadowRect;
 
 out vec4 out_color;
 
@@ -54,7 +55,11 @@ void main() {
 	if( vo_CastShadows != 0 ) {
 		vec3 screenPos = vo_wposLightSpace.xyz / vo_wposLightSpace.w;
 		screenPos = screenPos * 0.5 + 0.5;
-		if( screenPos.z > 1.0 ) {
+		// outside of the light's own tile of the atlas is outside of the light
+		vec2 texelSize = 1.0 / textureSize(DepthTexture, 0);
+		vec2 rectMin = vo_ShadowRect.xy + texelSize * 1.5;
+		vec2 rectMax = vo_ShadowRect.zw - texelSize * 1.5;
+		if( screenPos.z > 1.0 || any(lessThan(screenPos.xy, rectMin)) || any(greaterThan(screenPos.xy, rectMax)) ) {
 			visibility = 1.0;
 		} else {
 			float bias = clamp(0.005 * tan(acos(diffuseLight)), 0.0, 0.00005);
@@ -64,7 +69,6 @@ void main() {
 
 			// pcf
 			float shadowFactor = 0.0;
-			vec2 texelSize = 1.0 / textureSize(DepthTexture, 0);
 			for( int y = -1; y <= 1; ++y ) {
 				for( int x = -1; x <= 1; ++x ) {
 					vec2 offset = vec2(x, y) * texelSize;
@@ -18,6 +18,10 @@ layout(std140) uniform SpotlightConstants {
 	float LightRange;
 	mat4 lightViewProj;
 	int CastShadows;
+	int pad0;
+	int pad1;
+	int pad2;
+	vec4 ShadowRect;
 };
 
 out vec3 vo_wpos;
@@ -32,6 +36,7 @@ out float vo_LightIntensity;
 out float vo_LightRange;
 flat out int vo_CastShadows;
 out vec4 vo_wposLightSpace;
+flat out vec4 vo_ShadowRect;
 
 void main() {
 	gl_Position = xform * vec4(in_position, 1.0);
@@ -47,4 +52,5 @@ void main() {
 	vo_LightRange = LightRange;
 	vo_CastShadows = CastShadows;
 	vo_wposLightSpace = lightViewProj * vec4(vo_wpos, 1.0);
+	vo_ShadowRect = ShadowRect;
 }
@@ -41,7 +41,7 @@ Transform& GeometricPlane::getXform() {
 	return _xform;
 }
 
-bool GeometricPlane::build( std::shared_ptr<ciri::IGraphicsDevice>& device ) {
+bool GeometricPlane::build( const std::shared_ptr<ciri::IGraphicsDevice>& device ) {
 	_vb = device->createVertexBuffer();
 	if( ciri::failed(_vb->set(_verts, sizeof(Vertex), 4, false)) ) {
 		_vb->destroy();
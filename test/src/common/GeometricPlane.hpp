@@ -15,7 +15,7 @@ public:
 	float getConstant();
 	Transform& getXform();
 
-	bool build( std::shared_ptr<ciri::IGraphicsDevice>& device );
+	bool build( const std::shared_ptr<ciri::IGraphicsDevice>& device );
 	std::shared_ptr<ciri::IVertexBuffer> getVertexBuffer() const;
 	std::shared_ptr<ciri::IIndexBuffer> getIndexBuffer() const;
 
@@ -1,14 +1,21 @@
 #include "HeightmapTerrain.hpp"
+#include "TerrainPreprocess.hpp"
 
 HeightmapTerrain::HeightmapTerrain()
-	: _generated(false), _heightData(nullptr), _vertices(nullptr), _indices(nullptr), _vertexBuffer(nullptr), _indexBuffer(nullptr),
-		_shader(nullptr), _perFrameConstantBuffer(nullptr), _sampler(nullptr) {
+	: _generated(false), _jobs(nullptr), _heightData(nullptr), _vertices(nullptr), _shader(nullptr), _perFrameConstantBuffer(nullptr), _sampler(nullptr) {
 	_textures[0] = _textures[1] = _textures[2] = _textures[3] = nullptr;
+	for( int lod = 0; lod < TerrainQuadtree::LOD_COUNT; ++lod ) {
+		_lodStartIndex[lod] = _lodIndexCount[lod] = 0;
+	}
 }
 
 HeightmapTerrain::~HeightmapTerrain() {
 }
 
+void HeightmapTerrain::setJobSystem( const std::shared_ptr<ciri::JobSystem>& jobs ) {
+	_jobs = jobs;
+}
+
 bool HeightmapTerrain::generate( const ciri::TGA& heightmap, std::shared_ptr<ciri::IGraphicsDevice> device ) {
 	if( _generated ) {
 		return false;
@@ -30,28 +37,30 @@ bool HeightmapTerrain::generate( const ciri::TGA& heightmap, std::shared_ptr<cir
 	float maxHeight = std::numeric_limits<float>::min();
 	// create height data array
 	const int BPP = (ciri::TGA::RGB == heightmap.getFormat()) ? 3 : 4;
-	_heightData = new float[width * height];
-	for( int x = 0; x < width; ++x ) {
-		for( int y = 0; y < height; ++y ) {
-			// get height value from heightmap image
-			_heightData[y * width + x] = pixels[(y * width + x) * BPP]; // red component
-
-			// update min and max heights
-			minHeight = (_heightData[y * width + x] < minHeight) ? _heightData[y * width + x] : minHeight;
-			maxHeight = (_heightData[y * width + x] > maxHeight) ? _heightData[y * width + x] : maxHeight;
-		}
+	const int texelCount = width * height;
+	_heightData = new float[texelCount];
+	for( int i = 0; i < texelCount; ++i ) {
+		// get height value from heightmap image
+		const float value = pixels[i * BPP]; // red component
+		_heightData[i] = value;
+
+		// update min and max heights
+		minHeight = (value < minHeight) ? value : minHeight;
+		maxHeight = (value > maxHeight) ? value : maxHeight;
 	}
 	// normalize heights
 	const float SCALE = 200.0f;
 	const float INV_SCALE = 1.0f / SCALE;
-	for( int x = 0; x < width; ++x ) {
-		for( int y = 0; y < height; ++y ) {
-			_heightData[y * width + x] = (_heightData[y * width + x] - minHeight) / (maxHeight - minHeight) * SCALE;
-		}
+	const float heightScale = SCALE / (maxHeight - minHeight);
+	for( int i = 0; i < texelCount; ++i ) {
+		_heightData[i] = (_heightData[i] - minHeight) * heightScale;
 	}
 
 	// smooth heightmap
-	boxFilterHeightData(width, height, _heightData, true);
+	float* smoothed = new float[texelCount];
+	terrainprep::boxFilter3x3(_heightData, smoothed, width, height, true, _jobs.get());
+	delete[] _heightData;
+	_heightData = smoothed;
 
 	// create vertices
 	const float halfWidth = static_cast<float>(width) * 0.5f;
@@ -60,102 +69,78 @@ bool HeightmapTerrain::generate( const ciri::TGA& heightmap, std::shared_ptr<cir
 	const float invHeight =  1.0f / static_cast<float>(-height);
 	const int vertexCount = width * height;
 	_vertices = new TerrainVertex[vertexCount];
-	for( int x = 0; x < width; ++x ) {
-		for( int y = 0; y < height; ++y ) {
+	for( int y = 0; y < height; ++y ) {
+		const float fy = static_cast<float>(-y);
+		const float zpos = ((fy * invHeight) * 2.0f - 1.0f) * halfHeight;
+		TerrainVertex* row = _vertices + y * width;
+		for( int x = 0; x < width; ++x ) {
 			const float fx = static_cast<float>(x);
-			const float fy = static_cast<float>(-y);
 
 			// position of vertex w/ the center of the terrain as the origin
 			const float xpos = ((fx * invWidth) * 2.0f - 1.0f) * halfWidth;
-			const float ypos = _heightData[y * width + x];
-			const float zpos = ((fy * invHeight) * 2.0f - 1.0f) * halfHeight;
-			_vertices[y * width + x].position = cc::Vec3f(xpos, ypos, zpos);
+			row[x].position = cc::Vec3f(xpos, _heightData[y * width + x], zpos);
 
 			// texcoords
-			_vertices[y * width + x].texcoord.x = fx * INV_SCALE;
-			_vertices[y * width + x].texcoord.y = fy * INV_SCALE;
-
-			// texture weighting
-			_vertices[y * width + x].texweights.x = cc::math::clamp(1.0f - fabsf(_heightData[y * width + x] - 0.0f) / (SCALE*0.25f), 0.0f, 1.0f);
-			_vertices[y * width + x].texweights.y = cc::math::clamp(1.0f - fabsf(_heightData[y * width + x] - (SCALE*0.33f)) / (SCALE*0.2f), 0.0f, 1.0f);
-			_vertices[y * width + x].texweights.z = cc::math::clamp(1.0f - fabsf(_heightData[y * width + x] - (SCALE*0.66f)) / (SCALE*0.2f), 0.0f, 1.0f);
-			_vertices[y * width + x].texweights.w = cc::math::clamp(1.0f - fabsf(_heightData[y * width + x] - SCALE) / (SCALE*0.2f), 0.0f, 1.0f);
-			float totalWeighting = _vertices[y * width + x].texweights.x;
-			totalWeighting += _vertices[y * width + x].texweights.y;
-			totalWeighting += _vertices[y * width + x].texweights.z;
-			totalWeighting += _vertices[y * width + x].texweights.w;
-			_vertices[y * width + x].texweights.x /= totalWeighting;
-			_vertices[y * width + x].texweights.y /= totalWeighting;
-			_vertices[y * width + x].texweights.z /= totalWeighting;
-			_vertices[y * width + x].texweights.w /= totalWeighting;
-
-			// for a corner as the origin, use:
-			//_vertices[y * width + x].position = cc::Vec3f(static_cast<float>(x), _heightData[y * width + x], static_cast<float>(-y));
-
-			// todo: weights for multitexture
-		}
-	}
-	
-	// create indices
-	const int indexCount = (width-1) * (height-1) * 6;
-	_indices = new int[indexCount];
-	int counter = 0;
-	for( int y = 0; y < (height-1); ++y ) {
-		for( int x = 0; x < (width-1); ++x ) {
-			const int lowerLeft = y * width + x;
-			const int lowerRight = y * width + (x + 1);
-			const int topLeft = (y + 1) * width + x;
-			const int topRight = (y + 1) * width + (x + 1);
-
-			// CCW
-			_indices[counter++] = topLeft;
-			_indices[counter++] = lowerLeft;
-			_indices[counter++] = lowerRight;
-			//
-			_indices[counter++] = topLeft;
-			_indices[counter++] = lowerRight;
-			_indices[counter++] = topRight;
-
-			// CW
-			//_indices[counter++] = topLeft;
-			//_indices[counter++] = lowerRight;
-			//_indices[counter++] = lowerLeft;
-			//
-			//_indices[counter++] = topLeft;
-			//_indices[counter++] = topRight;
-			//_indices[counter++] = lowerRight;
+			row[x].texcoord.x = fx * INV_SCALE;
+			row[x].texcoord.y = fy * INV_SCALE;
 		}
 	}
 
-	// calculate vertex normals
-	for( int i = 0; i < (indexCount / 3); ++i ) {
-		const int index1 = _indices[i * 3];
-		const int index2 = _indices[i * 3 + 1];
-		const int index3 = _indices[i * 3 + 2];
+	// texture weighting by height band, lowest to highest
+	const int vertexStride = sizeof(TerrainVertex) / sizeof(float);
+	const float splatCenters[4] = {0.0f, SCALE*0.33f, SCALE*0.66f, SCALE};
+	const float splatWidths[4] = {SCALE*0.25f, SCALE*0.2f, SCALE*0.2f, SCALE*0.2f};
+	terrainprep::computeSplatWeights(_heightData, vertexCount, splatCenters, splatWidths, &_vertices[0].texweights.x, vertexStride, _jobs.get());
 
-		const cc::Vec3f side1 = _vertices[index1].position - _vertices[index3].position;
-		const cc::Vec3f side2 = _vertices[index1].position - _vertices[index2].position;
+	// normals and tangents; rows run along -z, and the bitangent (increasing texcoord.y) along +z, giving -1 handedness
+	terrainprep::computeNormalsAndTangents(_heightData, width, height, 1.0f, -1.0f, -1.0f, &_vertices[0].normal.x, &_vertices[0].tangent.x, vertexStride, _jobs.get());
 
-		// CCW
-		const cc::Vec3f normal = side2.cross(side1);
+	// split into patches; grid coordinates map to world space the same way as the vertex positions above
+	if( !_quadtree.build(_heightData, width, height, cc::Vec3f(-halfWidth, 0.0f, -halfHeight), 1.0f, -1.0f) ) {
+		clean();
+		return false;
+	}
 
-		// CW
-		//const cc::Vec3f normal = side1.cross(side2);
+	// pack patches into shared page vertex buffers, with skirts lowered below the edges; patch p sits at
+	// slot p % PATCHES_PER_PAGE of page p / PATCHES_PER_PAGE so that its base vertex never needs storing
+	std::vector<int> sourceIndices(TerrainQuadtree::PATCH_VERTEX_COUNT);
+	std::vector<TerrainVertex> pageVertices;
+	const int patchCount = _quadtree.getPatchCount();
+	const int pageCount = (patchCount + PATCHES_PER_PAGE - 1) / PATCHES_PER_PAGE;
+	_pageVertexBuffers.resize(pageCount);
+	_pageDraws.resize(pageCount);
+	for( int page = 0; page < pageCount; ++page ) {
+		const int firstPatch = page * PATCHES_PER_PAGE;
+		const int lastPatch = (firstPatch + PATCHES_PER_PAGE < patchCount) ? firstPatch + PATCHES_PER_PAGE : patchCount;
+		pageVertices.resize((lastPatch - firstPatch) * TerrainQuadtree::PATCH_VERTEX_COUNT);
+		for( int p = firstPatch; p < lastPatch; ++p ) {
+			TerrainVertex* patchVertices = &pageVertices[(p - firstPatch) * TerrainQuadtree::PATCH_VERTEX_COUNT];
+			_quadtree.getPatchSourceIndices(p, sourceIndices.data());
+			for( int i = 0; i < TerrainQuadtree::PATCH_VERTEX_COUNT; ++i ) {
+				patchVertices[i] = _vertices[sourceIndices[i]];
+			}
+			const float skirtDepth = _quadtree.getPatch(p).skirtDepth;
+			for( int i = TerrainQuadtree::PATCH_GRID_VERTICES; i < TerrainQuadtree::PATCH_VERTEX_COUNT; ++i ) {
+				patchVertices[i].position.y -= skirtDepth;
+			}
+		}
 
-		_vertices[index1].normal += normal;
-		_vertices[index2].normal += normal;
-		_vertices[index3].normal += normal;
-	}
-	// normalize vertex normals
-	for( int i = 0; i < vertexCount; ++i ) {
-		_vertices[i].normal.normalize();
+		_pageVertexBuffers[page] = device->createVertexBuffer();
+		_pageVertexBuffers[page]->set(pageVertices.data(), sizeof(TerrainVertex), static_cast<int>(pageVertices.size()), false);
+		_pageDraws[page].reserve(PATCHES_PER_PAGE);
 	}
 
-	// create gpu buffers
-	_vertexBuffer = device->createVertexBuffer();
-	_vertexBuffer->set(_vertices, sizeof(TerrainVertex), vertexCount, false);
-	_indexBuffer = device->createIndexBuffer();
-	_indexBuffer->set(_indices, indexCount, false);
+	// one index buffer holding every lod; indices are patch-local, so they stay 16-bit whatever the page size
+	std::vector<int> allIndices;
+	std::vector<int> lodIndices;
+	for( int lod = 0; lod < TerrainQuadtree::LOD_COUNT; ++lod ) {
+		TerrainQuadtree::buildLodIndices(lod, lodIndices);
+		_lodStartIndex[lod] = static_cast<int>(allIndices.size());
+		_lodIndexCount[lod] = static_cast<int>(lodIndices.size());
+		allIndices.insert(allIndices.end(), lodIndices.begin(), lodIndices.end());
+	}
+	_lodIndexBuffer = device->createIndexBuffer();
+	_lodIndexBuffer->set(allIndices.data(), static_cast<int>(allIndices.size()), false);
 
 
 	// create the shader
@@ -208,13 +193,17 @@ void HeightmapTerrain::setClippingPlaneParams( float height, const cc::Mat4f& vi
 	_perFrameConstants.clippingPlane = cc::Vec4f(plane.getNormal(), plane.getD());
 }
 
-void HeightmapTerrain::draw( const cc::Mat4f& viewProj, std::shared_ptr<ciri::IGraphicsDevice> device ) {
+void HeightmapTerrain::setLodParams( float maxPixelError, float fovDegrees, float viewportHeight ) {
+	_quadtree.setLodParams(maxPixelError, fovDegrees, viewportHeight);
+}
+
+void HeightmapTerrain::draw( const cc::Mat4f& viewProj, const cc::Vec3f& eye, std::shared_ptr<ciri::IGraphicsDevice> device ) {
 	if( !_generated ) {
 		return;
 	}
 
 	// check valid buffers
-	if( nullptr == _vertexBuffer || nullptr == _indexBuffer ) {
+	if( _pageVertexBuffers.empty() || nullptr == _lodIndexBuffer ) {
 		return;
 	}
 
@@ -251,10 +240,34 @@ void HeightmapTerrain::draw( const cc::Mat4f& viewProj, std::shared_ptr<ciri::IG
 	// update constant buffers
 	updateConstants(cc::Mat4f(1.0f), viewProj);
 
-	// set buffers and draw
-	device->setVertexBuffer(_vertexBuffer);
-	device->setIndexBuffer(_indexBuffer);
-	device->drawIndexed(ciri::PrimitiveTopology::TriangleList, _indexBuffer->getIndexCount());
+	// cull patches and pick their lods
+	_quadtree.select(viewProj, eye);
+
+	// bucket visible patches by page so that each page's vertex buffer is bound once
+	for( auto& draws : _pageDraws ) {
+		draws.clear();
+	}
+	for( int lod = 0; lod < TerrainQuadtree::LOD_COUNT; ++lod ) {
+		for( const int patch : _quadtree.getVisiblePatches(lod) ) {
+			PatchDraw draw;
+			draw.startIndex = _lodStartIndex[lod];
+			draw.indexCount = _lodIndexCount[lod];
+			draw.baseVertex = (patch % PATCHES_PER_PAGE) * TerrainQuadtree::PATCH_VERTEX_COUNT;
+			_pageDraws[patch / PATCHES_PER_PAGE].push_back(draw);
+		}
+	}
+
+	// the index buffer is shared by every page and lod
+	device->setIndexBuffer(_lodIndexBuffer);
+	for( int page = 0; page < static_cast<int>(_pageDraws.size()); ++page ) {
+		if( _pageDraws[page].empty() ) {
+			continue;
+		}
+		device->setVertexBuffer(_pageVertexBuffers[page]);
+		for( const PatchDraw& draw : _pageDraws[page] ) {
+			device->drawIndexed(ciri::PrimitiveTopology::TriangleList, draw.indexCount, draw.startIndex, draw.baseVertex);
+		}
+	}
 }
 
 void HeightmapTerrain::clean() {
@@ -262,10 +275,10 @@ void HeightmapTerrain::clean() {
 		return;
 	}
 
-	if( _indices != nullptr ) {
-		delete[] _indices;
-		_indices = nullptr;
-	}
+	_pageVertexBuffers.clear();
+	_pageDraws.clear();
+	_lodIndexBuffer = nullptr;
+	_quadtree.clean();
 
 	if( _vertices != nullptr ) {
 		delete[] _vertices;
@@ -280,123 +293,20 @@ void HeightmapTerrain::clean() {
 	_generated = false;
 }
 
+const TerrainQuadtree& HeightmapTerrain::getQuadtree() const {
+	return _quadtree;
+}
+
+int HeightmapTerrain::getPageCount() const {
+	return static_cast<int>(_pageVertexBuffers.size());
+}
+
 void HeightmapTerrain::updateConstants( const cc::Mat4f& world, const cc::Mat4f& viewProj ) {
 	_perFrameConstants.world = world;
 	_perFrameConstants.xform = viewProj * _perFrameConstants.world;
 	_perFrameConstantBuffer->setData(sizeof(PerFrameConstants), &_perFrameConstants);
 }
 
-void HeightmapTerrain::boxFilterHeightData( unsigned long width, unsigned long height, float*& heightMap, bool smoothEdges ) {
-	// http://archive.gamedev.net/archive/reference/articles/article2164.html
-	// i did not write this, and i do not dare touch it
-
-  // Temporary values for traversing single dimensional arrays
-  long x = 0;
-  long z = 0;
-  
-  long  widthClamp = (smoothEdges) ?  width : width  - 1;
-  long heightClamp = (smoothEdges) ? height : height - 1;
-  
-  // [Optimization] Calculate bounds ahead of time
-  unsigned int bounds = width * height;
-  
-  // Validate requirements
-  if (!heightMap)
-    return;
-  
-  // Allocate the result
-  float* result = new float[bounds];
-  
-  // Make sure memory was allocated
-  if (!result)
-    return;
-  
-  for (z = (smoothEdges) ? 0 : 1; z < heightClamp; ++z)
-  {
-    for (x = (smoothEdges) ? 0 : 1; x < widthClamp; ++x)
-    {
-      // Sample a 3x3 filtering grid based on surrounding neighbors
-      
-      float value = 0.0f;
-      float cellAverage = 1.0f;
-      
-      // Sample top row
-      
-      if (((x - 1) + (z - 1) * width) >= 0 &&
-          ((x - 1) + (z - 1) * width) < bounds)
-      {
-        value += heightMap[(x - 1) + (z - 1) * width];
-        ++cellAverage;
-      }
-      
-      if (((x - 0) + (z - 1) * width) >= 0 &&
-          ((x - 0) + (z - 1) * width) < bounds)
-      {
-        value += heightMap[(x    ) + (z - 1) * width];
-        ++cellAverage;
-      }
-      
-      if (((x + 1) + (z - 1) * width) >= 0 &&
-          ((x + 1) + (z - 1) * width) < bounds)
-      {
-        value += heightMap[(x + 1) + (z - 1) * width];
-        ++cellAverage;
-      }
-      
-      // Sample middle row
-      
-      if (((x - 1) + (z - 0) * width) >= 0 &&
-          ((x - 1) + (z - 0) * width) < bounds)
-      {
-        value += heightMap[(x - 1) + (z    ) * width];
-        ++cellAverage;
-      }
-      
-      // Sample center point (will always be in bounds)
-      value += heightMap[x + z * width];
-      
-      if (((x + 1) + (z - 0) * width) >= 0 &&
-          ((x + 1) + (z - 0) * width) < bounds)
-      {
-        value += heightMap[(x + 1) + (z    ) * width];
-        ++cellAverage;
-      }
-      
-      // Sample bottom row
-      
-      if (((x - 1) + (z + 1) * width) >= 0 &&
-          ((x - 1) + (z + 1) * width) < bounds)
-      {
-        value += heightMap[(x - 1) + (z + 1) * width];
-        ++cellAverage;
-      }
-      
-      if (((x - 0) + (z + 1) * width) >= 0 &&
-          ((x - 0) + (z + 1) * width) < bounds)
-      {
-        value += heightMap[(x    ) + (z + 1) * width];
-        ++cellAverage;
-      }
-      
-      if (((x + 1) + (z + 1) * width) >= 0 &&
-          ((x + 1) + (z + 1) * width) < bounds)
-      {
-        value += heightMap[(x + 1) + (z + 1) * width];
-        ++cellAverage;
-      }
-      
-      // Store the result
-      result[x + z * width] = value / cellAverage;
-    }
-  }
-  
-  // Release the old array
-  delete [] heightMap;
-  
-  // Store the new one
-  heightMap = result;
-}
-
 std::string HeightmapTerrain::getVertexShaderGl() const {
 	return
 		"#version 420\n"
@@ -7,9 +7,24 @@
 #include <cc/Mat4.hpp>
 #include <ciri/Graphics.hpp>
 #include <ciri/core/TGA.hpp>
+#include "TerrainQuadtree.hpp"
+
+namespace ciri {
+	class JobSystem;
+}
 
 class HeightmapTerrain {
+public:
+	static const int PAGE_VERTEX_CAPACITY = 262144; /**< Vertices per shared page buffer; matches MeshPool's default page. */
+	static const int PATCHES_PER_PAGE = PAGE_VERTEX_CAPACITY / TerrainQuadtree::PATCH_VERTEX_COUNT;
+
 private:
+	struct PatchDraw {
+		int startIndex;
+		int indexCount;
+		int baseVertex;
+	};
+
 	struct TerrainVertex {
 		cc::Vec3f position;
 		cc::Vec3f normal;
@@ -18,8 +33,7 @@ private:
 		cc::Vec4f texweights;
 	};
 
-	_declspec(align(16))
-	struct PerFrameConstants {
+	struct alignas(16) PerFrameConstants {
 		cc::Mat4f world;
 		cc::Mat4f xform;
 		cc::Vec4f clippingPlane;
@@ -37,16 +51,23 @@ public:
 	HeightmapTerrain();
 	~HeightmapTerrain();
 
+	/**
+	 * Sets the job system generate spreads heightmap preprocessing over.  Without one, it runs on the calling thread.
+	 */
+	void setJobSystem( const std::shared_ptr<ciri::JobSystem>& jobs );
 	bool generate( const ciri::TGA& heightmap, std::shared_ptr<ciri::IGraphicsDevice> device );
 	void setTextures( const std::shared_ptr<ciri::ITexture2D>& tex0, const std::shared_ptr<ciri::ITexture2D>& tex1, const std::shared_ptr<ciri::ITexture2D>& tex2, const std::shared_ptr<ciri::ITexture2D>& tex3 );
 	void setClippingPlaneActive( bool active );
 	void setClippingPlaneParams( float height, const cc::Mat4f& viewProj, bool flip );
-	void draw( const cc::Mat4f& viewProj, std::shared_ptr<ciri::IGraphicsDevice> device );
+	void setLodParams( float maxPixelError, float fovDegrees, float viewportHeight );
+	void draw( const cc::Mat4f& viewProj, const cc::Vec3f& eye, std::shared_ptr<ciri::IGraphicsDevice> device );
 	void clean();
+
+	const TerrainQuadtree& getQuadtree() const;
+	int getPageCount() const;
 	
 private:
 	void updateConstants( const cc::Mat4f& world, const cc::Mat4f& viewProj );
-	void boxFilterHeightData( unsigned long width, unsigned long height, float*& heightMap, bool smoothEdges );
 	std::string getVertexShaderGl() const;
 	std::string getVertexShaderDx() const;
 	std::string getPixelShaderGl() const;
@@ -55,15 +76,21 @@ private:
 
 private:
 	bool _generated;
+	std::shared_ptr<ciri::JobSystem> _jobs;
 	
 	// raw buffers
 	float* _heightData;
 	TerrainVertex* _vertices;
-	int* _indices;
+
+	// patches and lod selection
+	TerrainQuadtree _quadtree;
 
 	// gpu buffers
-	std::shared_ptr<ciri::IVertexBuffer> _vertexBuffer;
-	std::shared_ptr<ciri::IIndexBuffer> _indexBuffer;
+	std::vector<std::shared_ptr<ciri::IVertexBuffer>> _pageVertexBuffers; /**< Patches with their skirts, PATCHES_PER_PAGE to a page, drawn by base vertex. */
+	std::shared_ptr<ciri::IIndexBuffer> _lodIndexBuffer; /**< Every lod's patch-local indices back to back; shared by all patches. */
+	int _lodStartIndex[TerrainQuadtree::LOD_COUNT];
+	int _lodIndexCount[TerrainQuadtree::LOD_COUNT];
+	std::vector<std::vector<PatchDraw>> _pageDraws; /**< Visible patches bucketed by page, rebuilt every draw. */
 
 	// shader
 	std::shared_ptr<ciri::IShader> _shader;
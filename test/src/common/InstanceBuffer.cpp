@@ -0,0 +1,74 @@
+#include "InstanceBuffer.hpp"
+
+InstanceBuffer::InstanceBuffer()
+	: _device(nullptr), _initialized(false), _vertexBuffer(nullptr), _count(0) {
+}
+
+InstanceBuffer::~InstanceBuffer() {
+}
+
+void InstanceBuffer::addElements( const std::shared_ptr<ciri::IShader>& shader, int slot, int firstUsageIndex ) {
+	for( int i = 0; i < 4; ++i ) {
+		shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float4, ciri::VertexUsage::Texcoord, firstUsageIndex + i, slot, 1));
+	}
+}
+
+bool InstanceBuffer::create( std::shared_ptr<ciri::IGraphicsDevice> device ) {
+	if( _initialized ) {
+		return false;
+	}
+
+	_device = device;
+	_vertexBuffer = _device->createVertexBuffer();
+	if( nullptr == _vertexBuffer ) {
+		clean();
+		return false;
+	}
+
+	_initialized = true;
+
+	return true;
+}
+
+void InstanceBuffer::clean() {
+	if( _vertexBuffer != nullptr ) {
+		_vertexBuffer->destroy();
+		_vertexBuffer = nullptr;
+	}
+	_worlds.clear();
+	_count = 0;
+	_device = nullptr;
+	_initialized = false;
+}
+
+bool InstanceBuffer::isValid() const {
+	return _initialized;
+}
+
+bool InstanceBuffer::update( Transform* transforms, int count ) {
+	if( !_initialized || nullptr == transforms || count <= 0 ) {
+		return false;
+	}
+
+	// the staging array only ever grows so steady-state updates do not allocate
+	if( static_cast<int>(_worlds.size()) < count ) {
+		_worlds.resize(count);
+	}
+	for( int i = 0; i < count; ++i ) {
+		_worlds[i] = transforms[i].getWorld();
+	}
+
+	if( ciri::failed(_vertexBuffer->set(_worlds.data(), sizeof(cc::Mat4f), count, true)) ) {
+		return false;
+	}
+	_count = count;
+	return true;
+}
+
+const std::shared_ptr<ciri::IVertexBuffer>& InstanceBuffer::getVertexBuffer() const {
+	return _vertexBuffer;
+}
+
+int InstanceBuffer::getCount() const {
+	return _count;
+}
\ No newline at end of file
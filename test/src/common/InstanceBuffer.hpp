@@ -0,0 +1,52 @@
+#ifndef __test_instance_buffer__
+#define __test_instance_buffer__
+
+#include <memory>
+#include <vector>
+#include <ciri/Graphics.hpp>
+#include <cc/Mat4.hpp>
+#include "Transform.hpp"
+
+/**
+ * Dynamic per-instance vertex buffer holding one world matrix per instance.
+ * Matrices are packed column by column, so a shader reads them as four Float4 texcoord elements advancing once per instance.
+ */
+class InstanceBuffer {
+public:
+	InstanceBuffer();
+	~InstanceBuffer();
+
+	/**
+	 * Adds the four per-instance Float4 elements of the world matrix to a shader's input layout.
+	 * @param shader          Shader to add the elements to, before it is loaded.
+	 * @param slot            Vertex buffer slot the instance buffer will be bound to.
+	 * @param firstUsageIndex Texcoord usage index of the first column; the rest follow consecutively.
+	 */
+	static void addElements( const std::shared_ptr<ciri::IShader>& shader, int slot, int firstUsageIndex );
+
+	bool create( std::shared_ptr<ciri::IGraphicsDevice> device );
+	void clean();
+	bool isValid() const;
+
+	/**
+	 * Packs and uploads the world matrices of the given transforms.
+	 * @param transforms Transforms to pack, in instance order.
+	 * @param count      Number of transforms.
+	 * @returns True on success; false otherwise.
+	 */
+	bool update( Transform* transforms, int count );
+
+	const std::shared_ptr<ciri::IVertexBuffer>& getVertexBuffer() const;
+	int getCount() const;
+
+private:
+	std::shared_ptr<ciri::IGraphicsDevice> _device;
+	//
+	bool _initialized;
+	//
+	std::shared_ptr<ciri::IVertexBuffer> _vertexBuffer;
+	std::vector<cc::Mat4f> _worlds;
+	int _count;
+};
+
+#endif /* __test_instance_buffer__ */
\ No newline at end of file
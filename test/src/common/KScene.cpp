@@ -1,6 +1,7 @@
 #include "KScene.hpp"
 #include <cc/MatrixFunc.hpp>
-#include <fstream>
+#include <ciri/core/FileSystem.hpp>
+#include <cstring>
 #include "Leb128.hpp"
 
 KScene::Mesh::Mesh()
@@ -160,6 +161,21 @@ float KScene::Light::getOuterConeAngle() const
 	return _outerConeAngle;
 }
 
+cc::Vec3f KScene::Light::getPosition() const
+{
+	return (_parent != nullptr) ? _parent->getPosition(true) : cc::Vec3f(0.0f, 0.0f, 0.0f);
+}
+
+cc::Vec3f KScene::Light::getDirection() const
+{
+	if( nullptr == _parent )
+	{
+		return cc::Vec3f(0.0f, 0.0f, -1.0f);
+	}
+	const cc::Vec4f dir = _parent->getMatrix(true) * cc::Vec4f(0.0f, 0.0f, -1.0f, 0.0f);
+	return cc::Vec3f(dir.x, dir.y, dir.z).normalized();
+}
+
 KScene::KScene()
 {
 	_meshes = std::vector<Mesh*>();
@@ -218,19 +234,38 @@ KScene::Mesh* KScene::getMeshByName( const std::string& name )
 	return nullptr;
 }
 
+void KScene::addLightsToClusters( ciri::LightClusters& clusters, std::vector<const Light*>& binned ) const
+{
+	for( const Light* light : _lights )
+	{
+		if( Light::kLightTypePoint == light->getType() )
+		{
+			clusters.addPointLight(light->getPosition(), light->getRange());
+		}
+		else if( Light::kLightTypeSpot == light->getType() )
+		{
+			clusters.addSpotLight(light->getPosition(), light->getDirection(), light->getRange(), light->getOuterConeAngle());
+		}
+		else
+		{
+			continue;
+		}
+		binned.push_back(light);
+	}
+}
+
 bool KScene::readBinaryFile( const char* file )
 {
 	clean();
 
-	std::ifstream in(file, std::ios::in | std::ios::binary);
-	if( !in.is_open() )
+	ciri::FileDataStream in(ciri::FileSystem::read(file));
+	if( !in )
 	{
 		return false;
 	}
 	readModelData(in);
 	readXformData(in);
 	readLightData(in);
-	in.close();
 
 	if( _xforms.size() > 0 )
 	{
@@ -355,7 +390,7 @@ void KScene::clean()
 	_root = nullptr;
 }
 
-void KScene::readModelData( std::ifstream& is )
+void KScene::readModelData( std::istream& is )
 {
 	// Number of meshes.
 	int meshCount = 0;
@@ -422,7 +457,7 @@ void KScene::readModelData( std::ifstream& is )
 	}
 }
 
-void KScene::readXformData( std::ifstream& is )
+void KScene::readXformData( std::istream& is )
 {
 	// Read xform count.
 	int xformCount = 0;
@@ -497,7 +532,7 @@ void KScene::readXformData( std::ifstream& is )
 	}
 }
 
-void KScene::readLightData( std::ifstream& is )
+void KScene::readLightData( std::istream& is )
 {
 	int lightCount = 0;
 	is.read(reinterpret_cast<char*>(&lightCount), sizeof(int));
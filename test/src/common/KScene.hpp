@@ -1,12 +1,14 @@
 #ifndef __kscene__
 #define __kscene__
 
+#include <istream>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include "Vertex.hpp"
 #include <cc/Quaternion.hpp>
 #include <cc/Mat4.hpp>
+#include <ciri/graphics/LightClusters.hpp>
 
 class KScene
 {
@@ -84,6 +86,8 @@ public:
 		float getRange() const;
 		float getInnerConeAngle() const;
 		float getOuterConeAngle() const;
+		cc::Vec3f getPosition() const; /**< World position of the parent, or the origin without one. */
+		cc::Vec3f getDirection() const; /**< World -z of the parent, which is where maya points spot lights. */
 
 	private:
 		std::string _name;
@@ -107,14 +111,21 @@ public:
 	Xform* getXformByName( const std::string& name );
 	Mesh* getMeshByName( const std::string& name );
 
+	/**
+	 * Adds the point and spot lights to clusters.
+	 * @param clusters Clusters to add to.
+	 * @param binned   Filled with the light behind each index the clusters list, from the first index added.
+	 */
+	void addLightsToClusters( ciri::LightClusters& clusters, std::vector<const Light*>& binned ) const;
+
 	bool readBinaryFile( const char* file );
 	void printDebugInfo( bool verbose );
 	void clean();
 
 private:
-	void readModelData( std::ifstream& is );
-	void readXformData( std::ifstream& is );
-	void readLightData( std::ifstream& is );
+	void readModelData( std::istream& is );
+	void readXformData( std::istream& is );
+	void readLightData( std::istream& is );
 	void buildTree();
 	void printXform( Xform* xform, int spacing, bool verbose );
 
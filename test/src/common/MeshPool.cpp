@@ -0,0 +1,126 @@
+#include "MeshPool.hpp"
+
+MeshPool::MeshPool( int verticesPerPage )
+	: _initialized(false), _verticesPerPage(verticesPerPage) {
+}
+
+MeshPool::~MeshPool() {
+}
+
+int MeshPool::add( Model& model ) {
+	if( _initialized ) {
+		return -1;
+	}
+
+	const std::vector<Vertex>& vertices = model.getVertices();
+	const std::vector<int>& indices = model.getIndices();
+	const int vertexCount = static_cast<int>(vertices.size());
+	if( 0 == vertexCount ) {
+		return -1;
+	}
+
+	// start a new page when the mesh does not fit in the current one
+	if( _pages.empty() || (!_pages.back().vertices.empty() && static_cast<int>(_pages.back().vertices.size()) + vertexCount > _verticesPerPage) ) {
+		_pages.push_back(Page());
+	}
+	Page& page = _pages.back();
+
+	Mesh mesh;
+	mesh.page = static_cast<int>(_pages.size()) - 1;
+	mesh.startIndex = static_cast<int>(page.indices.size());
+	mesh.indexCount = static_cast<int>(indices.size());
+	mesh.baseVertex = static_cast<int>(page.vertices.size());
+	mesh.vertexCount = vertexCount;
+
+	// indices stay local to the mesh; the base vertex offsets them at draw time
+	page.vertices.insert(page.vertices.end(), vertices.begin(), vertices.end());
+	page.indices.insert(page.indices.end(), indices.begin(), indices.end());
+
+	_meshes.push_back(mesh);
+	return static_cast<int>(_meshes.size()) - 1;
+}
+
+bool MeshPool::build( std::shared_ptr<ciri::IGraphicsDevice> device ) {
+	if( _initialized || _pages.empty() ) {
+		return false;
+	}
+
+	for( auto& page : _pages ) {
+		page.vertexBuffer = device->createVertexBuffer();
+		if( ciri::failed(page.vertexBuffer->set(page.vertices.data(), sizeof(Vertex), static_cast<int>(page.vertices.size()), false)) ) {
+			clean();
+			return false;
+		}
+
+		if( !page.indices.empty() ) {
+			page.indexBuffer = device->createIndexBuffer();
+			if( ciri::failed(page.indexBuffer->set(page.indices.data(), static_cast<int>(page.indices.size()), false)) ) {
+				clean();
+				return false;
+			}
+		}
+
+		// the gpu copies are all that is needed from here on
+		std::vector<Vertex>().swap(page.vertices);
+		std::vector<int>().swap(page.indices);
+	}
+
+	_initialized = true;
+
+	return true;
+}
+
+void MeshPool::clean() {
+	for( auto& page : _pages ) {
+		if( page.vertexBuffer != nullptr ) {
+			page.vertexBuffer->destroy();
+		}
+		if( page.indexBuffer != nullptr ) {
+			page.indexBuffer->destroy();
+		}
+	}
+	_pages.clear();
+	_meshes.clear();
+	_initialized = false;
+}
+
+bool MeshPool::isValid() const {
+	return _initialized;
+}
+
+void MeshPool::draw( const std::shared_ptr<ciri::IGraphicsDevice>& device, int mesh ) const {
+	if( !_initialized || mesh < 0 || mesh >= static_cast<int>(_meshes.size()) ) {
+		return;
+	}
+
+	// consecutive meshes from the same page rebind nothing; the device drops the redundant sets
+	const Mesh& curr = _meshes[mesh];
+	const Page& page = _pages[curr.page];
+	device->setVertexBuffer(page.vertexBuffer);
+	if( curr.indexCount > 0 ) {
+		device->setIndexBuffer(page.indexBuffer);
+		device->drawIndexed(ciri::PrimitiveTopology::TriangleList, curr.indexCount, curr.startIndex, curr.baseVertex);
+	} else {
+		device->drawArrays(ciri::PrimitiveTopology::TriangleList, curr.vertexCount, curr.baseVertex);
+	}
+}
+
+const MeshPool::Mesh& MeshPool::getMesh( int mesh ) const {
+	return _meshes[mesh];
+}
+
+int MeshPool::getMeshCount() const {
+	return static_cast<int>(_meshes.size());
+}
+
+int MeshPool::getPageCount() const {
+	return static_cast<int>(_pages.size());
+}
+
+const std::shared_ptr<ciri::IVertexBuffer>& MeshPool::getVertexBuffer( int page ) const {
+	return _pages[page].vertexBuffer;
+}
+
+const std::shared_ptr<ciri::IIndexBuffer>& MeshPool::getIndexBuffer( int page ) const {
+	return _pages[page].indexBuffer;
+}
\ No newline at end of file
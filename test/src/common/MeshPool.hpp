@@ -0,0 +1,68 @@
+#ifndef __test_mesh_pool__
+#define __test_mesh_pool__
+
+#include <memory>
+#include <vector>
+#include <ciri/Graphics.hpp>
+#include "Vertex.hpp"
+#include "Model.hpp"
+
+/**
+ * Packs the geometry of many models into a few large shared vertex and index buffers.
+ * Each mesh keeps its own local indices and is drawn with a start index and base vertex, so pages stay 16-bit indexed
+ * unless a single mesh needs more than 65536 vertices.  Meshes are added first and uploaded together by build.
+ */
+class MeshPool {
+public:
+	struct Mesh {
+		int page;        /**< Index of the page holding the mesh. */
+		int startIndex;  /**< First index of the mesh within the page's index buffer. */
+		int indexCount;  /**< Number of indices; 0 for non-indexed meshes. */
+		int baseVertex;  /**< First vertex of the mesh within the page's vertex buffer. */
+		int vertexCount; /**< Number of vertices. */
+	};
+
+public:
+	/**
+	 * @param verticesPerPage Vertex capacity of a page; meshes larger than this get a page to themselves.
+	 */
+	MeshPool( int verticesPerPage=262144 );
+	~MeshPool();
+
+	/**
+	 * Copies a model's vertices and indices into the pool.  Only valid before build.
+	 * @returns Handle of the mesh, or -1 if the model is empty or the pool is already built.
+	 */
+	int add( Model& model );
+
+	bool build( std::shared_ptr<ciri::IGraphicsDevice> device );
+	void clean();
+	bool isValid() const;
+
+	/**
+	 * Binds the mesh's page and draws it.
+	 */
+	void draw( const std::shared_ptr<ciri::IGraphicsDevice>& device, int mesh ) const;
+
+	const Mesh& getMesh( int mesh ) const;
+	int getMeshCount() const;
+	int getPageCount() const;
+	const std::shared_ptr<ciri::IVertexBuffer>& getVertexBuffer( int page ) const;
+	const std::shared_ptr<ciri::IIndexBuffer>& getIndexBuffer( int page ) const;
+
+private:
+	struct Page {
+		std::vector<Vertex> vertices;
+		std::vector<int> indices;
+		std::shared_ptr<ciri::IVertexBuffer> vertexBuffer;
+		std::shared_ptr<ciri::IIndexBuffer> indexBuffer;
+	};
+
+private:
+	bool _initialized;
+	int _verticesPerPage;
+	std::vector<Page> _pages;
+	std::vector<Mesh> _meshes;
+};
+
+#endif /* __test_mesh_pool__ */
\ No newline at end of file
@@ -2,9 +2,15 @@
 #include <map>
 #include <cc/TriMath.hpp>
 #include <fstream>
+#include <cmath>
+#include <ciri/graphics/VertexPacking.hpp>
 
 Model::Model()
-	: _vertexBuffer(nullptr), _indexBuffer(nullptr), _shader(nullptr), _dynamicVertex(false), _dynamicIndex(false) {
+	: _vertexBuffer(nullptr), _indexBuffer(nullptr), _shader(nullptr), _dynamicVertex(false), _dynamicIndex(false), _compact(false) {
+}
+
+Model::CompactReport::CompactReport()
+	: fullBytes(0), compactBytes(0), maxNormalError(0.0f), maxTangentError(0.0f), maxTexcoordError(0.0f) {
 }
 
 Model::~Model() {
@@ -19,6 +25,7 @@ Model::Model( const Model& rhs ) {
 	this->_shader = rhs._shader;
 	this->_dynamicVertex = rhs._dynamicVertex;
 	this->_dynamicIndex = rhs._dynamicIndex;
+	this->_compact = rhs._compact;
 	this->_triangles = rhs._triangles;
 	this->_edges = rhs._edges;
 }
@@ -32,6 +39,7 @@ Model Model::operator=( const Model& rhs ) {
 	this->_shader = rhs._shader;
 	this->_dynamicVertex = rhs._dynamicVertex;
 	this->_dynamicIndex = rhs._dynamicIndex;
+	this->_compact = rhs._compact;
 	this->_triangles = rhs._triangles;
 	this->_edges = rhs._edges;
 	return *this;
@@ -214,7 +222,7 @@ bool Model::build( std::shared_ptr<ciri::IGraphicsDevice> device ) {
 	}
 
 	_vertexBuffer = device->createVertexBuffer();
-	if( ciri::failed(_vertexBuffer->set(_vertices.data(), sizeof(Vertex), _vertices.size(), _dynamicVertex)) ) {
+	if( !uploadVertices(_dynamicVertex) ) {
 		_vertexBuffer->destroy();
 		_vertexBuffer.reset();
 		_vertexBuffer = nullptr;
@@ -249,7 +257,7 @@ bool Model::updateBuffers( bool vertex, bool index ) {
 		if( !_dynamicVertex ) {
 			success = false;
 		} else {
-			if( ciri::failed(_vertexBuffer->set(_vertices.data(), sizeof(Vertex), _vertices.size(), true)) ) {
+			if( !uploadVertices(true) ) {
 				success = false;
 			}
 		}
@@ -315,6 +323,106 @@ void Model::setDynamicity( bool vertex, bool index ) {
 	_dynamicIndex = index;
 }
 
+void Model::setCompact( bool val ) {
+	if( isValid() ) {
+		return;
+	}
+
+	_compact = val;
+}
+
+bool Model::isCompact() const {
+	return _compact;
+}
+
+Model::CompactReport Model::measureCompactError() {
+	CompactReport report;
+	report.fullBytes = static_cast<int>(sizeof(Vertex) * _vertices.size());
+	report.compactBytes = static_cast<int>(sizeof(CompactVertex) * _vertices.size());
+
+	std::vector<CompactVertex> packed;
+	packCompact(packed);
+	for( size_t i = 0; i < _vertices.size(); ++i ) {
+		const Vertex& full = _vertices[i];
+		const CompactVertex& small = packed[i];
+
+		const cc::Vec2f octahedral(ciri::VertexPacking::snorm16ToFloat(small.normal[0]), ciri::VertexPacking::snorm16ToFloat(small.normal[1]));
+		const cc::Vec3f normal = ciri::VertexPacking::decodeOctahedral(octahedral);
+		const float normalDot = std::fmin(1.0f, std::fmax(-1.0f, normal.dot(full.normal.normalized())));
+		report.maxNormalError = std::fmax(report.maxNormalError, acosf(normalDot) * 57.2957795f);
+
+		const cc::Vec3f tangent(ciri::VertexPacking::snorm16ToFloat(small.tangent[0]), ciri::VertexPacking::snorm16ToFloat(small.tangent[1]), ciri::VertexPacking::snorm16ToFloat(small.tangent[2]));
+		const cc::Vec3f fullTangent(full.tangent.x, full.tangent.y, full.tangent.z);
+		if( fullTangent.magnitude() > 0.0f ) {
+			const float tangentDot = std::fmin(1.0f, std::fmax(-1.0f, tangent.normalized().dot(fullTangent.normalized())));
+			report.maxTangentError = std::fmax(report.maxTangentError, acosf(tangentDot) * 57.2957795f);
+		}
+
+		const float du = fabsf(ciri::VertexPacking::halfToFloat(small.texcoord[0]) - full.texcoord.x);
+		const float dv = fabsf(ciri::VertexPacking::halfToFloat(small.texcoord[1]) - full.texcoord.y);
+		report.maxTexcoordError = std::fmax(report.maxTexcoordError, std::fmax(du, dv));
+	}
+	return report;
+}
+
+void Model::addInputElements( const std::shared_ptr<ciri::IShader>& shader, bool compact ) {
+	shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
+	shader->addInputElement(ciri::VertexElement(compact ? ciri::VertexFormat::SNorm16x2 : ciri::VertexFormat::Float3, ciri::VertexUsage::Normal, 0));
+	shader->addInputElement(ciri::VertexElement(compact ? ciri::VertexFormat::SNorm16x4 : ciri::VertexFormat::Float4, ciri::VertexUsage::Tangent, 0));
+	shader->addInputElement(ciri::VertexElement(compact ? ciri::VertexFormat::Half2 : ciri::VertexFormat::Float2, ciri::VertexUsage::Texcoord, 0));
+}
+
+void Model::packCompact( std::vector<CompactVertex>& out ) const {
+	const int count = static_cast<int>(_vertices.size());
+	out.resize(count);
+
+	// gather each attribute into its own stream so the packers can run four values at a time
+	std::vector<float> normals(count * 2);
+	std::vector<float> tangents(count * 4);
+	std::vector<float> texcoords(count * 2);
+	for( int i = 0; i < count; ++i ) {
+		const Vertex& v = _vertices[i];
+		const cc::Vec2f octahedral = ciri::VertexPacking::encodeOctahedral(v.normal);
+		normals[i*2+0] = octahedral.x;
+		normals[i*2+1] = octahedral.y;
+		tangents[i*4+0] = v.tangent.x;
+		tangents[i*4+1] = v.tangent.y;
+		tangents[i*4+2] = v.tangent.z;
+		tangents[i*4+3] = v.tangent.w;
+		texcoords[i*2+0] = v.texcoord.x;
+		texcoords[i*2+1] = v.texcoord.y;
+	}
+
+	std::vector<short> packedNormals(count * 2);
+	std::vector<short> packedTangents(count * 4);
+	std::vector<unsigned short> packedTexcoords(count * 2);
+	ciri::VertexPacking::floatToSNorm16(normals.data(), packedNormals.data(), count * 2);
+	ciri::VertexPacking::floatToSNorm16(tangents.data(), packedTangents.data(), count * 4);
+	ciri::VertexPacking::floatToHalf(texcoords.data(), packedTexcoords.data(), count * 2);
+
+	for( int i = 0; i < count; ++i ) {
+		CompactVertex& cv = out[i];
+		cv.position = _vertices[i].position;
+		cv.normal[0] = packedNormals[i*2+0];
+		cv.normal[1] = packedNormals[i*2+1];
+		for( int j = 0; j < 4; ++j ) {
+			cv.tangent[j] = packedTangents[i*4+j];
+		}
+		cv.texcoord[0] = packedTexcoords[i*2+0];
+		cv.texcoord[1] = packedTexcoords[i*2+1];
+	}
+}
+
+bool Model::uploadVertices( bool dynamic ) {
+	if( !_compact ) {
+		return ciri::success(_vertexBuffer->set(_vertices.data(), sizeof(Vertex), _vertices.size(), dynamic));
+	}
+
+	std::vector<CompactVertex> packed;
+	packCompact(packed);
+	return ciri::success(_vertexBuffer->set(packed.data(), sizeof(CompactVertex), packed.size(), dynamic));
+}
+
 bool Model::isValid() const {
 	return _vertexBuffer != nullptr;
 }
@@ -351,6 +459,7 @@ Model Model::copy() const {
 	mdl._shader = _shader;
 	mdl._dynamicVertex = _dynamicVertex;
 	mdl._dynamicIndex = _dynamicIndex;
+	mdl._compact = _compact;
 	return mdl;
 }
 
@@ -23,6 +23,19 @@ public:
 		std::vector<int> edges;
 	};
 
+	/**
+	 * Largest differences between the full and compact layout of a model's vertices.
+	 */
+	struct CompactReport {
+		int fullBytes;
+		int compactBytes;
+		float maxNormalError;   // degrees
+		float maxTangentError;  // degrees
+		float maxTexcoordError; // absolute
+
+		CompactReport();
+	};
+
 public:
 	Model();
 	~Model();
@@ -45,6 +58,14 @@ public:
 	const std::shared_ptr<ciri::IShader>& getShader() const;
 	void setShader( const std::shared_ptr<ciri::IShader>& val );
 	void setDynamicity( bool vertex, bool index ); // only call before build
+	void setCompact( bool val ); // only call before build; uploads CompactVertex instead of Vertex
+	bool isCompact() const;
+	CompactReport measureCompactError();
+
+	/**
+	 * Adds the input elements matching the vertex layout to a shader.
+	 */
+	static void addInputElements( const std::shared_ptr<ciri::IShader>& shader, bool compact );
 
 	bool isValid() const;
 
@@ -59,6 +80,10 @@ public:
 
 	bool exportToObj( const char* file );
 
+private:
+	void packCompact( std::vector<CompactVertex>& out ) const;
+	bool uploadVertices( bool dynamic );
+
 private:
 	std::vector<Vertex> _vertices;
 	std::vector<int> _indices;
@@ -68,6 +93,7 @@ private:
 	std::shared_ptr<ciri::IShader> _shader;
 	bool _dynamicVertex;
 	bool _dynamicIndex;
+	bool _compact;
 	
 	// extended:
 	std::vector<Triangle> _triangles;
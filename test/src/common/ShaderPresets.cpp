@@ -1,4 +1,5 @@
 #include "ShaderPresets.hpp"
+#include <xmmintrin.h>
 
 SimpleShader::SimpleShader()
 	: _shader(nullptr), _constantBuffer(nullptr), _materialConstantsBuffer(nullptr) {
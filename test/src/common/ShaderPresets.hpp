@@ -7,14 +7,12 @@
 
 class SimpleShader {
 public:
-	__declspec(align(16))
-	struct Constants {
+	struct alignas(16) Constants {
 		cc::Mat4f world;
 		cc::Mat4f xform;
 	};
 
-	__declspec(align(16))
-	struct MaterialConstants {
+	struct alignas(16) MaterialConstants {
 		cc::Vec3f diffuseColor;
 		int hasDiffuseTexture;
 
@@ -0,0 +1,74 @@
+#include "SyntheticLoadApp.hpp"
+#include <algorithm>
+#include <cc/MatrixFunc.hpp>
+
+namespace {
+	const int TRANSFORMS_PER_FRAME = 1024;
+	const int SPRITES_PER_FRAME = 256;
+	const int LIGHTS_PER_FRAME = 16;
+
+	void spinFor( double milliseconds ) {
+		const long long end = ciri::Profiler::now() + static_cast<long long>(milliseconds * 1000000.0);
+		while( ciri::Profiler::now() < end ) {
+		}
+	}
+}
+
+SyntheticLoadApp::SyntheticLoadApp( double updateMs, double drawMs, bool pipelined )
+	: App(), _updateMs(updateMs), _drawMs(drawMs), _drawnFrames(0), _lastDrawnFrame(-1), _outOfOrderFrames(0), _maxAlpha(0.0) {
+	_config.pipelined = pipelined;
+	_config.title = "synthetic load";
+}
+
+SyntheticLoadApp::~SyntheticLoadApp() {
+}
+
+int SyntheticLoadApp::getDrawnFrames() const {
+	return _drawnFrames;
+}
+
+int SyntheticLoadApp::getOutOfOrderFrames() const {
+	return _outOfOrderFrames;
+}
+
+double SyntheticLoadApp::getMaxAlpha() const {
+	return _maxAlpha;
+}
+
+void SyntheticLoadApp::onUpdate( const double, const double elapsedTime ) {
+	spinFor(_updateMs);
+
+	ciri::RenderSnapshot& snapshot = updateSnapshot();
+	const float offset = static_cast<float>(elapsedTime);
+	for( int i = 0; i < TRANSFORMS_PER_FRAME; ++i ) {
+		snapshot.transforms.push_back(cc::math::translate<float>(cc::Vec3f(static_cast<float>(i) + offset, 0.0f, 0.0f)));
+	}
+	for( int i = 0; i < SPRITES_PER_FRAME; ++i ) {
+		ciri::SnapshotSprite sprite;
+		sprite.position = cc::Vec2f(static_cast<float>(i), offset);
+		snapshot.sprites.push_back(sprite);
+	}
+	for( int i = 0; i < LIGHTS_PER_FRAME; ++i ) {
+		ciri::SnapshotLight light;
+		light.position = cc::Vec3f(static_cast<float>(i), offset, 0.0f);
+		snapshot.lights.push_back(light);
+	}
+}
+
+void SyntheticLoadApp::onDraw() {
+	const ciri::RenderSnapshot& snapshot = drawSnapshot();
+	// a torn or repeated snapshot would show up as a frame out of step or a list that was not filled
+	if( snapshot.frame != _lastDrawnFrame + 1 || static_cast<int>(snapshot.transforms.size()) != TRANSFORMS_PER_FRAME ||
+			static_cast<int>(snapshot.sprites.size()) != SPRITES_PER_FRAME || static_cast<int>(snapshot.lights.size()) != LIGHTS_PER_FRAME ) {
+		_outOfOrderFrames += 1;
+	}
+	_lastDrawnFrame = snapshot.frame;
+	_maxAlpha = std::max(_maxAlpha, snapshot.alpha);
+	_drawnFrames += 1;
+
+	spinFor(_drawMs);
+
+	const std::shared_ptr<ciri::IGraphicsDevice> device = graphicsDevice();
+	device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
+	device->present();
+}
\ No newline at end of file
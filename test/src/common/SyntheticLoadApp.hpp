@@ -0,0 +1,38 @@
+#ifndef __test_SyntheticLoadApp__
+#define __test_SyntheticLoadApp__
+
+#include <ciri/game/App.hpp>
+
+/**
+ * An app whose update and draw only spin for set times, standing in for a cpu bound game when timing the frame loop itself.
+ * Update fills the render snapshot with transforms, sprites and lights; draw reads them back, clears and presents.
+ * Draw counts the frames it sees out of order, which a correct handoff never gives.
+ */
+class SyntheticLoadApp : public ciri::App {
+public:
+	/**
+	 * @param updateMs Milliseconds each onUpdate spins for.
+	 * @param drawMs   Milliseconds each onDraw spins for.
+	 * @param pipelined Runs the frame loop pipelined.
+	 */
+	SyntheticLoadApp( double updateMs, double drawMs, bool pipelined );
+	virtual ~SyntheticLoadApp();
+
+	int getDrawnFrames() const;
+	int getOutOfOrderFrames() const;
+	double getMaxAlpha() const;
+
+protected:
+	virtual void onUpdate( const double deltaTime, const double elapsedTime ) override;
+	virtual void onDraw() override;
+
+private:
+	double _updateMs;
+	double _drawMs;
+	int _drawnFrames;
+	int _lastDrawnFrame;
+	int _outOfOrderFrames;
+	double _maxAlpha;
+};
+
+#endif
\ No newline at end of file
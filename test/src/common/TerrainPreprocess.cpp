@@ -0,0 +1,275 @@
+#include "TerrainPreprocess.hpp"
+#include <cmath>
+#include <vector>
+#include <xmmintrin.h>
+#include <ciri/core/JobSystem.hpp>
+
+namespace {
+	const int MIN_ROWS_PER_BAND = 16; // fewer rows than this per band isn't worth the restart of the row window
+	const int MIN_TEXELS_PER_BAND = 16384;
+	const int BANDS_PER_THREAD = 4; // a few bands per thread so that stealing evens out uneven threads
+
+	/**
+	 * Splits [0, count) into contiguous bands of at least minPerBand and runs fn(begin, end) on each over the job system.
+	 */
+	template<typename Fn>
+	void parallelRanges( int count, int minPerBand, ciri::JobSystem* jobs, const Fn& fn ) {
+		const int maxBands = (count + minPerBand - 1) / minPerBand;
+		const int threads = (jobs != nullptr) ? jobs->getThreadCount() : 1;
+		const int bands = (threads * BANDS_PER_THREAD < maxBands) ? threads * BANDS_PER_THREAD : maxBands;
+		if( threads <= 1 || bands <= 1 ) {
+			fn(0, count);
+			return;
+		}
+
+		jobs->parallelFor(0, count, (count + bands - 1) / bands, [&fn]( int begin, int end ) {
+			fn(begin, end);
+		});
+	}
+
+	/**
+	 * Sums each texel of a row with its left and right neighbours (where present).
+	 */
+	void sumRow3( const float* row, float* out, int width ) {
+		if( 1 == width ) {
+			out[0] = row[0];
+			return;
+		}
+
+		out[0] = row[0] + row[1];
+		int x = 1;
+		for( ; x + 4 <= width - 1; x += 4 ) {
+			const __m128 left = _mm_loadu_ps(row + x - 1);
+			const __m128 center = _mm_loadu_ps(row + x);
+			const __m128 right = _mm_loadu_ps(row + x + 1);
+			_mm_storeu_ps(out + x, _mm_add_ps(_mm_add_ps(left, center), right));
+		}
+		for( ; x < width - 1; ++x ) {
+			out[x] = (row[x - 1] + row[x]) + row[x + 1];
+		}
+		out[width - 1] = row[width - 2] + row[width - 1];
+	}
+
+	void writeNormalAndTangent( float dhdcol, float dhdrow, float invSpacingX, float invSpacingZ, float spacingX, float tangentW, float* normal, float* tangent ) {
+		const float dhdx = dhdcol * invSpacingX;
+		const float dhdz = dhdrow * invSpacingZ;
+		const float invLength = 1.0f / sqrtf(dhdx * dhdx + 1.0f + dhdz * dhdz);
+		normal[0] = (0.0f - dhdx) * invLength;
+		normal[1] = invLength;
+		normal[2] = (0.0f - dhdz) * invLength;
+
+		const float invTangentLength = 1.0f / sqrtf(spacingX * spacingX + dhdcol * dhdcol);
+		tangent[0] = spacingX * invTangentLength;
+		tangent[1] = dhdcol * invTangentLength;
+		tangent[2] = 0.0f;
+		tangent[3] = tangentW;
+	}
+}
+
+void terrainprep::boxFilter3x3( const float* src, float* dst, int width, int height, bool smoothEdges, ciri::JobSystem* jobs ) {
+	if( nullptr == src || nullptr == dst || width <= 0 || height <= 0 ) {
+		return;
+	}
+
+	// per column and per row sample counts; with the window clamped to the heightmap these are separable
+	const float edgeCountX = (width > 1) ? 2.0f : 1.0f;
+
+	parallelRanges(height, MIN_ROWS_PER_BAND, jobs, [&]( int rowBegin, int rowEnd ) {
+		// sliding window of horizontal sums for the rows above, at and below the current row; missing rows are zero
+		std::vector<float> window(width * 4, 0.0f);
+		float* prev = window.data();
+		float* curr = prev + width;
+		float* next = curr + width;
+		const float* zeros = next + width;
+
+		if( rowBegin > 0 ) {
+			sumRow3(src + (rowBegin - 1) * width, prev, width);
+		}
+		sumRow3(src + rowBegin * width, curr, width);
+		if( rowBegin + 1 < height ) {
+			sumRow3(src + (rowBegin + 1) * width, next, width);
+		}
+
+		for( int y = rowBegin; y < rowEnd; ++y ) {
+			const float* srcRow = src + y * width;
+			float* dstRow = dst + y * width;
+			const bool hasPrev = (y > 0);
+			const bool hasNext = (y + 1 < height);
+
+			if( !smoothEdges && (!hasPrev || !hasNext) ) {
+				for( int x = 0; x < width; ++x ) {
+					dstRow[x] = srcRow[x];
+				}
+			} else {
+				const float* above = hasPrev ? prev : zeros;
+				const float* below = hasNext ? next : zeros;
+				const float countY = 1.0f + (hasPrev ? 1.0f : 0.0f) + (hasNext ? 1.0f : 0.0f);
+				const float innerScale = 1.0f / (3.0f * countY);
+				const float edgeScale = 1.0f / (edgeCountX * countY);
+
+				const __m128 scale = _mm_set1_ps(innerScale);
+				int x = 1;
+				for( ; x + 4 <= width - 1; x += 4 ) {
+					const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(above + x), _mm_loadu_ps(curr + x)), _mm_loadu_ps(below + x));
+					_mm_storeu_ps(dstRow + x, _mm_mul_ps(sum, scale));
+				}
+				for( ; x < width - 1; ++x ) {
+					dstRow[x] = ((above[x] + curr[x]) + below[x]) * innerScale;
+				}
+
+				if( smoothEdges ) {
+					dstRow[0] = ((above[0] + curr[0]) + below[0]) * edgeScale;
+					if( width > 1 ) {
+						dstRow[width - 1] = ((above[width - 1] + curr[width - 1]) + below[width - 1]) * edgeScale;
+					}
+				} else {
+					dstRow[0] = srcRow[0];
+					dstRow[width - 1] = srcRow[width - 1];
+				}
+			}
+
+			// slide the window down a row
+			float* recycled = prev;
+			prev = curr;
+			curr = next;
+			next = recycled;
+			if( y + 2 < height && y + 1 < rowEnd ) {
+				sumRow3(src + (y + 2) * width, next, width);
+			}
+		}
+	});
+}
+
+void terrainprep::computeNormalsAndTangents( const float* heights, int width, int height, float spacingX, float spacingZ, float tangentW, float* normals, float* tangents, int strideFloats, ciri::JobSystem* jobs ) {
+	if( nullptr == heights || nullptr == normals || nullptr == tangents || width <= 0 || height <= 0 ) {
+		return;
+	}
+
+	const float invSpacingX = 1.0f / spacingX;
+	const float invSpacingZ = 1.0f / spacingZ;
+
+	parallelRanges(height, MIN_ROWS_PER_BAND, jobs, [&]( int rowBegin, int rowEnd ) {
+		alignas(16) float nx[4], ny[4], nz[4], tx[4], ty[4];
+
+		for( int y = rowBegin; y < rowEnd; ++y ) {
+			const int prevY = (y > 0) ? y - 1 : y;
+			const int nextY = (y + 1 < height) ? y + 1 : y;
+			const float invSpanY = (nextY > prevY) ? 1.0f / static_cast<float>(nextY - prevY) : 0.0f;
+			const float* row = heights + y * width;
+			const float* rowPrev = heights + prevY * width;
+			const float* rowNext = heights + nextY * width;
+			float* normalRow = normals + static_cast<size_t>(y) * width * strideFloats;
+			float* tangentRow = tangents + static_cast<size_t>(y) * width * strideFloats;
+
+			// borders use one-sided differences
+			const auto writeEdge = [&]( int x ) {
+				const int prevX = (x > 0) ? x - 1 : x;
+				const int nextX = (x + 1 < width) ? x + 1 : x;
+				const float invSpanX = (nextX > prevX) ? 1.0f / static_cast<float>(nextX - prevX) : 0.0f;
+				const float dhdcol = (row[nextX] - row[prevX]) * invSpanX;
+				const float dhdrow = (rowNext[x] - rowPrev[x]) * invSpanY;
+				writeNormalAndTangent(dhdcol, dhdrow, invSpacingX, invSpacingZ, spacingX, tangentW, normalRow + x * strideFloats, tangentRow + x * strideFloats);
+			};
+
+			writeEdge(0);
+
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 spanY = _mm_set1_ps(invSpanY);
+			const __m128 scaleX = _mm_set1_ps(invSpacingX);
+			const __m128 scaleZ = _mm_set1_ps(invSpacingZ);
+			const __m128 tangentX = _mm_set1_ps(spacingX);
+			const __m128 tangentX2 = _mm_mul_ps(tangentX, tangentX);
+			int x = 1;
+			for( ; x + 4 <= width - 1; x += 4 ) {
+				const __m128 dhdcol = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + x + 1), _mm_loadu_ps(row + x - 1)), half);
+				const __m128 dhdrow = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(rowNext + x), _mm_loadu_ps(rowPrev + x)), spanY);
+				const __m128 dhdx = _mm_mul_ps(dhdcol, scaleX);
+				const __m128 dhdz = _mm_mul_ps(dhdrow, scaleZ);
+				const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dhdx, dhdx), one), _mm_mul_ps(dhdz, dhdz))));
+				_mm_store_ps(nx, _mm_mul_ps(_mm_sub_ps(zero, dhdx), invLength));
+				_mm_store_ps(ny, invLength);
+				_mm_store_ps(nz, _mm_mul_ps(_mm_sub_ps(zero, dhdz), invLength));
+
+				const __m128 invTangentLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(tangentX2, _mm_mul_ps(dhdcol, dhdcol))));
+				_mm_store_ps(tx, _mm_mul_ps(tangentX, invTangentLength));
+				_mm_store_ps(ty, _mm_mul_ps(dhdcol, invTangentLength));
+
+				for( int i = 0; i < 4; ++i ) {
+					float* normal = normalRow + (x + i) * strideFloats;
+					normal[0] = nx[i];
+					normal[1] = ny[i];
+					normal[2] = nz[i];
+					float* tangent = tangentRow + (x + i) * strideFloats;
+					tangent[0] = tx[i];
+					tangent[1] = ty[i];
+					tangent[2] = 0.0f;
+					tangent[3] = tangentW;
+				}
+			}
+			for( ; x < width - 1; ++x ) {
+				const float dhdcol = (row[x + 1] - row[x - 1]) * 0.5f;
+				const float dhdrow = (rowNext[x] - rowPrev[x]) * invSpanY;
+				writeNormalAndTangent(dhdcol, dhdrow, invSpacingX, invSpacingZ, spacingX, tangentW, normalRow + x * strideFloats, tangentRow + x * strideFloats);
+			}
+
+			if( width > 1 ) {
+				writeEdge(width - 1);
+			}
+		}
+	});
+}
+
+void terrainprep::computeSplatWeights( const float* heights, int count, const float centers[4], const float widths[4], float* weights, int strideFloats, ciri::JobSystem* jobs ) {
+	if( nullptr == heights || nullptr == weights || count <= 0 ) {
+		return;
+	}
+
+	const float invWidths[4] = {1.0f / widths[0], 1.0f / widths[1], 1.0f / widths[2], 1.0f / widths[3]};
+	const float MIN_TOTAL = 1e-6f;
+
+	parallelRanges(count, MIN_TEXELS_PER_BAND, jobs, [&]( int begin, int end ) {
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 minTotal = _mm_set1_ps(MIN_TOTAL);
+
+		int i = begin;
+		for( ; i + 4 <= end; i += 4 ) {
+			const __m128 h = _mm_loadu_ps(heights + i);
+
+			// one register per layer, holding that layer's weight for four texels
+			__m128 layer[4];
+			for( int l = 0; l < 4; ++l ) {
+				const __m128 offset = _mm_sub_ps(h, _mm_set1_ps(centers[l]));
+				const __m128 distance = _mm_max_ps(offset, _mm_sub_ps(zero, offset));
+				layer[l] = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(distance, _mm_set1_ps(invWidths[l]))));
+			}
+			const __m128 total = _mm_max_ps(_mm_add_ps(_mm_add_ps(layer[0], layer[1]), _mm_add_ps(layer[2], layer[3])), minTotal);
+			const __m128 invTotal = _mm_div_ps(one, total);
+			for( int l = 0; l < 4; ++l ) {
+				layer[l] = _mm_mul_ps(layer[l], invTotal);
+			}
+
+			// transpose so each register holds the four weights of one texel
+			_MM_TRANSPOSE4_PS(layer[0], layer[1], layer[2], layer[3]);
+			for( int t = 0; t < 4; ++t ) {
+				_mm_storeu_ps(weights + static_cast<size_t>(i + t) * strideFloats, layer[t]);
+			}
+		}
+		for( ; i < end; ++i ) {
+			float w[4];
+			for( int l = 0; l < 4; ++l ) {
+				const float weight = 1.0f - fabsf(heights[i] - centers[l]) * invWidths[l];
+				w[l] = (weight > 0.0f) ? weight : 0.0f;
+			}
+			float total = (w[0] + w[1]) + (w[2] + w[3]);
+			total = (total > MIN_TOTAL) ? total : MIN_TOTAL;
+			const float invTotal = 1.0f / total;
+			float* out = weights + static_cast<size_t>(i) * strideFloats;
+			for( int l = 0; l < 4; ++l ) {
+				out[l] = w[l] * invTotal;
+			}
+		}
+	});
+}
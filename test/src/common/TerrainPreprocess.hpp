@@ -0,0 +1,56 @@
+#ifndef __test_terrain_preprocess__
+#define __test_terrain_preprocess__
+
+namespace ciri {
+	class JobSystem;
+}
+
+/**
+ * Heightmap preprocessing used when generating terrain.
+ * All passes walk the heightmap in row-major order, are vectorized with SSE, and split rows into bands spread over a job system.
+ * Outputs can be written straight into interleaved vertices by passing a pointer to the first vertex's field and a stride.
+ */
+namespace terrainprep {
+	/**
+	 * Averages each texel with its 3x3 neighbourhood, ignoring samples outside of the heightmap.
+	 * Done as a horizontal then vertical pass over a sliding window of three rows, so no full size temporary is needed.
+	 * @param src         Source heights.
+	 * @param dst         Destination heights; must not overlap src.
+	 * @param width       Heightmap columns.
+	 * @param height      Heightmap rows.
+	 * @param smoothEdges If false, the outermost texels are copied unfiltered.
+	 * @param jobs        Job system to split rows across; null runs on the calling thread.
+	 */
+	void boxFilter3x3( const float* src, float* dst, int width, int height, bool smoothEdges, ciri::JobSystem* jobs );
+
+	/**
+	 * Computes normals and tangents from central differences of the heights (one-sided at the borders).
+	 * A texel at column x and row y is at (x * spacingX, height, y * spacingZ); tangents follow increasing columns.
+	 * @param heights       Source heights.
+	 * @param width         Heightmap columns.
+	 * @param height        Heightmap rows.
+	 * @param spacingX      World distance between columns.
+	 * @param spacingZ      World distance between rows.
+	 * @param tangentW      Handedness written to the w component of each tangent.
+	 * @param normals       First normal (3 floats).
+	 * @param tangents      First tangent (4 floats).
+	 * @param strideFloats  Distance between consecutive normals (and tangents) in floats.
+	 * @param jobs          Job system to split rows across; null runs on the calling thread.
+	 */
+	void computeNormalsAndTangents( const float* heights, int width, int height, float spacingX, float spacingZ, float tangentW, float* normals, float* tangents, int strideFloats, ciri::JobSystem* jobs );
+
+	/**
+	 * Computes four normalized texture blend weights per texel from height bands.
+	 * Each weight is max(0, 1 - |height - center| / width), after which the four are divided by their sum.
+	 * @param heights      Source heights.
+	 * @param count        Number of texels.
+	 * @param centers      Height at which each layer is strongest.
+	 * @param widths       Distance from the center at which each layer fades out.
+	 * @param weights      First weight set (4 floats).
+	 * @param strideFloats Distance between consecutive weight sets in floats.
+	 * @param jobs         Job system to split texels across; null runs on the calling thread.
+	 */
+	void computeSplatWeights( const float* heights, int count, const float centers[4], const float widths[4], float* weights, int strideFloats, ciri::JobSystem* jobs );
+}
+
+#endif /* __test_terrain_preprocess__ */
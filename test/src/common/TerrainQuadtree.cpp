@@ -0,0 +1,389 @@
+#include "TerrainQuadtree.hpp"
+#include <ciri/graphics/BoundingFrustum.hpp>
+#include <cmath>
+#include <limits>
+
+TerrainQuadtree::TerrainQuadtree()
+	: _heights(nullptr), _width(0), _height(0), _origin(), _spacingX(1.0f), _spacingZ(1.0f), _patchesX(0), _patchesY(0), _root(-1),
+		_maxPixelError(2.0f), _lodScale(0.0f), _eye() {
+	setLodParams(2.0f, 45.0f, 720.0f);
+}
+
+TerrainQuadtree::~TerrainQuadtree() {
+}
+
+bool TerrainQuadtree::build( const float* heights, int width, int height, const cc::Vec3f& origin, float spacingX, float spacingZ ) {
+	clean();
+
+	if( nullptr == heights || width < 2 || height < 2 ) {
+		return false;
+	}
+
+	_heights = heights;
+	_width = width;
+	_height = height;
+	_origin = origin;
+	_spacingX = spacingX;
+	_spacingZ = spacingZ;
+
+	// patches share their edge texels; the last row and column of patches may hang over the heightmap, in which case texels are clamped
+	_patchesX = (width - 1 + PATCH_SIZE - 1) / PATCH_SIZE;
+	_patchesY = (height - 1 + PATCH_SIZE - 1) / PATCH_SIZE;
+	_patches.resize(_patchesX * _patchesY);
+	for( int py = 0; py < _patchesY; ++py ) {
+		for( int px = 0; px < _patchesX; ++px ) {
+			Patch& patch = _patches[py * _patchesX + px];
+			patch.originX = px * PATCH_SIZE;
+			patch.originY = py * PATCH_SIZE;
+			patch.lodError[0] = 0.0f;
+			for( int lod = 1; lod < LOD_COUNT; ++lod ) {
+				const float error = computeLodError(patch, lod);
+				patch.lodError[lod] = (error > patch.lodError[lod-1]) ? error : patch.lodError[lod-1];
+			}
+		}
+	}
+
+	// the gap between two neighbours can be as large as both of their errors combined
+	const float skirtMargin = (fabsf(spacingX) > fabsf(spacingZ)) ? fabsf(spacingX) : fabsf(spacingZ);
+	for( int py = 0; py < _patchesY; ++py ) {
+		for( int px = 0; px < _patchesX; ++px ) {
+			Patch& patch = _patches[py * _patchesX + px];
+			float neighbourError = 0.0f;
+			const int nx[4] = {px-1, px+1, px, px};
+			const int ny[4] = {py, py, py-1, py+1};
+			for( int i = 0; i < 4; ++i ) {
+				if( nx[i] < 0 || nx[i] >= _patchesX || ny[i] < 0 || ny[i] >= _patchesY ) {
+					continue;
+				}
+				const float error = _patches[ny[i] * _patchesX + nx[i]].lodError[LOD_COUNT-1];
+				neighbourError = (error > neighbourError) ? error : neighbourError;
+			}
+			patch.skirtDepth = patch.lodError[LOD_COUNT-1] + neighbourError + skirtMargin;
+			computeBounds(patch);
+		}
+	}
+
+	_nodes.reserve(_patches.size() * 2);
+	_root = buildNode(0, 0, _patchesX, _patchesY);
+
+	for( int lod = 0; lod < LOD_COUNT; ++lod ) {
+		_visible[lod].reserve(_patches.size());
+	}
+
+	return true;
+}
+
+void TerrainQuadtree::clean() {
+	_heights = nullptr;
+	_width = _height = 0;
+	_patchesX = _patchesY = 0;
+	_patches.clear();
+	_nodes.clear();
+	_root = -1;
+	for( int lod = 0; lod < LOD_COUNT; ++lod ) {
+		_visible[lod].clear();
+	}
+}
+
+void TerrainQuadtree::setLodParams( float maxPixelError, float fovDegrees, float viewportHeight ) {
+	_maxPixelError = maxPixelError;
+	const float halfFov = fovDegrees * 0.5f * 0.0174532925f;
+	_lodScale = viewportHeight / (2.0f * tanf(halfFov));
+}
+
+void TerrainQuadtree::select( const cc::Mat4f& viewProj, const cc::Vec3f& eye ) {
+	for( int lod = 0; lod < LOD_COUNT; ++lod ) {
+		_visible[lod].clear();
+	}
+	if( -1 == _root ) {
+		return;
+	}
+
+	const ciri::BoundingFrustum frustum(viewProj);
+	for( int i = 0; i < 6; ++i ) {
+		const ciri::Plane& plane = frustum.planes()[i];
+		_planes[i] = cc::Vec4f(plane.getNormal().x, plane.getNormal().y, plane.getNormal().z, plane.getD());
+	}
+	_eye = eye;
+
+	selectNode(_root, 0x3F);
+}
+
+const std::vector<int>& TerrainQuadtree::getVisiblePatches( int lod ) const {
+	return _visible[lod];
+}
+
+int TerrainQuadtree::getVisiblePatchCount() const {
+	int count = 0;
+	for( int lod = 0; lod < LOD_COUNT; ++lod ) {
+		count += static_cast<int>(_visible[lod].size());
+	}
+	return count;
+}
+
+int TerrainQuadtree::getVisibleTriangleCount() const {
+	int count = 0;
+	for( int lod = 0; lod < LOD_COUNT; ++lod ) {
+		count += static_cast<int>(_visible[lod].size()) * (getLodIndexCount(lod) / 3);
+	}
+	return count;
+}
+
+int TerrainQuadtree::getPatchCount() const {
+	return static_cast<int>(_patches.size());
+}
+
+const TerrainQuadtree::Patch& TerrainQuadtree::getPatch( int index ) const {
+	return _patches[index];
+}
+
+float TerrainQuadtree::getHeight( int x, int y ) const {
+	return sampleHeight(x, y);
+}
+
+void TerrainQuadtree::getPatchSourceIndices( int patch, int* indices ) const {
+	const Patch& p = _patches[patch];
+	const auto texel = [&]( int gx, int gy ) {
+		int x = p.originX + gx;
+		int y = p.originY + gy;
+		x = (x < _width) ? x : _width - 1;
+		y = (y < _height) ? y : _height - 1;
+		return y * _width + x;
+	};
+
+	for( int gy = 0; gy <= PATCH_SIZE; ++gy ) {
+		for( int gx = 0; gx <= PATCH_SIZE; ++gx ) {
+			indices[gy * (PATCH_SIZE + 1) + gx] = texel(gx, gy);
+		}
+	}
+
+	// skirts in the order bottom (first row), top (last row), left (first column), right (last column)
+	int* skirt = indices + PATCH_GRID_VERTICES;
+	for( int k = 0; k <= PATCH_SIZE; ++k ) {
+		skirt[0 * (PATCH_SIZE + 1) + k] = texel(k, 0);
+		skirt[1 * (PATCH_SIZE + 1) + k] = texel(k, PATCH_SIZE);
+		skirt[2 * (PATCH_SIZE + 1) + k] = texel(0, k);
+		skirt[3 * (PATCH_SIZE + 1) + k] = texel(PATCH_SIZE, k);
+	}
+}
+
+void TerrainQuadtree::buildLodIndices( int lod, std::vector<int>& indices ) {
+	indices.clear();
+	indices.reserve(getLodIndexCount(lod));
+
+	const int step = 1 << lod;
+	const int stride = PATCH_SIZE + 1;
+
+	// grid; same winding as the original monolithic terrain (CCW from above)
+	for( int y = 0; y < PATCH_SIZE; y += step ) {
+		for( int x = 0; x < PATCH_SIZE; x += step ) {
+			const int lowerLeft = y * stride + x;
+			const int lowerRight = y * stride + (x + step);
+			const int topLeft = (y + step) * stride + x;
+			const int topRight = (y + step) * stride + (x + step);
+
+			indices.push_back(topLeft);
+			indices.push_back(lowerLeft);
+			indices.push_back(lowerRight);
+			//
+			indices.push_back(topLeft);
+			indices.push_back(lowerRight);
+			indices.push_back(topRight);
+		}
+	}
+
+	// skirts; wound to face away from the patch, measured in the same space as the grid (rows run along -z)
+	const cc::Vec3f outward[4] = {cc::Vec3f(0.0f, 0.0f, 1.0f), cc::Vec3f(0.0f, 0.0f, -1.0f), cc::Vec3f(-1.0f, 0.0f, 0.0f), cc::Vec3f(1.0f, 0.0f, 0.0f)};
+	for( int edge = 0; edge < 4; ++edge ) {
+		const auto edgeVertex = [&]( int k ) {
+			switch( edge ) {
+				case 0: return k;
+				case 1: return PATCH_SIZE * stride + k;
+				case 2: return k * stride;
+				default: return k * stride + PATCH_SIZE;
+			}
+		};
+		const auto edgePosition = [&]( int k ) {
+			switch( edge ) {
+				case 0: return cc::Vec3f(static_cast<float>(k), 0.0f, 0.0f);
+				case 1: return cc::Vec3f(static_cast<float>(k), 0.0f, static_cast<float>(-PATCH_SIZE));
+				case 2: return cc::Vec3f(0.0f, 0.0f, static_cast<float>(-k));
+				default: return cc::Vec3f(static_cast<float>(PATCH_SIZE), 0.0f, static_cast<float>(-k));
+			}
+		};
+		const int skirtBase = PATCH_GRID_VERTICES + edge * (PATCH_SIZE + 1);
+
+		// same normal convention as the terrain's normal generation
+		const cc::Vec3f a = edgePosition(0);
+		const cc::Vec3f b = edgePosition(step);
+		const cc::Vec3f skirtA = a - cc::Vec3f(0.0f, 1.0f, 0.0f);
+		const cc::Vec3f normal = (a - skirtA).cross(a - b);
+		const bool flip = normal.dot(outward[edge]) < 0.0f;
+
+		for( int k = 0; k < PATCH_SIZE; k += step ) {
+			const int edgeA = edgeVertex(k);
+			const int edgeB = edgeVertex(k + step);
+			const int lowA = skirtBase + k;
+			const int lowB = skirtBase + k + step;
+			if( !flip ) {
+				indices.push_back(edgeA); indices.push_back(lowA); indices.push_back(edgeB);
+				indices.push_back(edgeB); indices.push_back(lowA); indices.push_back(lowB);
+			} else {
+				indices.push_back(edgeA); indices.push_back(edgeB); indices.push_back(lowA);
+				indices.push_back(edgeB); indices.push_back(lowB); indices.push_back(lowA);
+			}
+		}
+	}
+}
+
+int TerrainQuadtree::getLodIndexCount( int lod ) {
+	const int quads = PATCH_SIZE >> lod;
+	return (quads * quads * 6) + (4 * quads * 6);
+}
+
+int TerrainQuadtree::buildNode( int x0, int y0, int x1, int y1 ) {
+	const int index = static_cast<int>(_nodes.size());
+	_nodes.push_back(Node());
+	_nodes[index].children[0] = _nodes[index].children[1] = _nodes[index].children[2] = _nodes[index].children[3] = -1;
+	_nodes[index].patch = -1;
+
+	if( 1 == (x1 - x0) && 1 == (y1 - y0) ) {
+		const int patch = y0 * _patchesX + x0;
+		_nodes[index].patch = patch;
+		_nodes[index].boundsMin = _patches[patch].boundsMin;
+		_nodes[index].boundsMax = _patches[patch].boundsMax;
+		return index;
+	}
+
+	const int midX = (x1 - x0 > 1) ? x0 + (x1 - x0 + 1) / 2 : x1;
+	const int midY = (y1 - y0 > 1) ? y0 + (y1 - y0 + 1) / 2 : y1;
+	const int rects[4][4] = {{x0, y0, midX, midY}, {midX, y0, x1, midY}, {x0, midY, midX, y1}, {midX, midY, x1, y1}};
+
+	cc::Vec3f boundsMin(std::numeric_limits<float>::max());
+	cc::Vec3f boundsMax(-std::numeric_limits<float>::max());
+	for( int i = 0; i < 4; ++i ) {
+		if( rects[i][0] >= rects[i][2] || rects[i][1] >= rects[i][3] ) {
+			continue;
+		}
+		const int child = buildNode(rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+		_nodes[index].children[i] = child;
+		const Node& node = _nodes[child];
+		boundsMin.x = (node.boundsMin.x < boundsMin.x) ? node.boundsMin.x : boundsMin.x;
+		boundsMin.y = (node.boundsMin.y < boundsMin.y) ? node.boundsMin.y : boundsMin.y;
+		boundsMin.z = (node.boundsMin.z < boundsMin.z) ? node.boundsMin.z : boundsMin.z;
+		boundsMax.x = (node.boundsMax.x > boundsMax.x) ? node.boundsMax.x : boundsMax.x;
+		boundsMax.y = (node.boundsMax.y > boundsMax.y) ? node.boundsMax.y : boundsMax.y;
+		boundsMax.z = (node.boundsMax.z > boundsMax.z) ? node.boundsMax.z : boundsMax.z;
+	}
+	_nodes[index].boundsMin = boundsMin;
+	_nodes[index].boundsMax = boundsMax;
+	return index;
+}
+
+void TerrainQuadtree::selectNode( int index, unsigned int planeMask ) {
+	const Node& node = _nodes[index];
+
+	// planes the node is entirely inside of are dropped from the mask so that children skip them
+	for( int i = 0; i < 6; ++i ) {
+		if( 0 == (planeMask & (1 << i)) ) {
+			continue;
+		}
+		const cc::Vec4f& plane = _planes[i];
+		const float px = (plane.x >= 0.0f) ? node.boundsMax.x : node.boundsMin.x;
+		const float py = (plane.y >= 0.0f) ? node.boundsMax.y : node.boundsMin.y;
+		const float pz = (plane.z >= 0.0f) ? node.boundsMax.z : node.boundsMin.z;
+		if( plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f ) {
+			return;
+		}
+		const float nx = (plane.x >= 0.0f) ? node.boundsMin.x : node.boundsMax.x;
+		const float ny = (plane.y >= 0.0f) ? node.boundsMin.y : node.boundsMax.y;
+		const float nz = (plane.z >= 0.0f) ? node.boundsMin.z : node.boundsMax.z;
+		if( plane.x * nx + plane.y * ny + plane.z * nz + plane.w >= 0.0f ) {
+			planeMask &= ~(1 << i);
+		}
+	}
+
+	if( node.patch != -1 ) {
+		const Patch& patch = _patches[node.patch];
+
+		// distance from the eye to the closest point of the patch's bounds
+		const float dx = (_eye.x < patch.boundsMin.x) ? patch.boundsMin.x - _eye.x : ((_eye.x > patch.boundsMax.x) ? _eye.x - patch.boundsMax.x : 0.0f);
+		const float dy = (_eye.y < patch.boundsMin.y) ? patch.boundsMin.y - _eye.y : ((_eye.y > patch.boundsMax.y) ? _eye.y - patch.boundsMax.y : 0.0f);
+		const float dz = (_eye.z < patch.boundsMin.z) ? patch.boundsMin.z - _eye.z : ((_eye.z > patch.boundsMax.z) ? _eye.z - patch.boundsMax.z : 0.0f);
+		const float distance = sqrtf(dx*dx + dy*dy + dz*dz);
+
+		// coarsest level whose projected error is within tolerance
+		int lod = LOD_COUNT - 1;
+		while( lod > 0 && (patch.lodError[lod] * _lodScale) > (_maxPixelError * distance) ) {
+			--lod;
+		}
+		_visible[lod].push_back(node.patch);
+		return;
+	}
+
+	for( int i = 0; i < 4; ++i ) {
+		if( node.children[i] != -1 ) {
+			selectNode(node.children[i], planeMask);
+		}
+	}
+}
+
+float TerrainQuadtree::sampleHeight( int x, int y ) const {
+	x = (x < _width) ? x : _width - 1;
+	y = (y < _height) ? y : _height - 1;
+	return _heights[y * _width + x];
+}
+
+float TerrainQuadtree::computeLodError( const Patch& patch, int lod ) const {
+	const int step = 1 << lod;
+	const float invStep = 1.0f / static_cast<float>(step);
+	float maxError = 0.0f;
+
+	for( int cy = 0; cy < PATCH_SIZE; cy += step ) {
+		for( int cx = 0; cx < PATCH_SIZE; cx += step ) {
+			const int x = patch.originX + cx;
+			const int y = patch.originY + cy;
+			const float lowerLeft = sampleHeight(x, y);
+			const float lowerRight = sampleHeight(x + step, y);
+			const float topLeft = sampleHeight(x, y + step);
+			const float topRight = sampleHeight(x + step, y + step);
+
+			// interpolate over the same two triangles the coarse cell is drawn with (split from top left to lower right)
+			for( int j = 0; j <= step; ++j ) {
+				for( int i = 0; i <= step; ++i ) {
+					const float u = static_cast<float>(i) * invStep;
+					const float v = static_cast<float>(j) * invStep;
+					const float coarse = ((u + v) <= 1.0f)
+						? lowerLeft + u * (lowerRight - lowerLeft) + v * (topLeft - lowerLeft)
+						: topRight + (1.0f - u) * (topLeft - topRight) + (1.0f - v) * (lowerRight - topRight);
+					const float error = fabsf(sampleHeight(x + i, y + j) - coarse);
+					maxError = (error > maxError) ? error : maxError;
+				}
+			}
+		}
+	}
+
+	return maxError;
+}
+
+void TerrainQuadtree::computeBounds( Patch& patch ) const {
+	float minHeight = std::numeric_limits<float>::max();
+	float maxHeight = -std::numeric_limits<float>::max();
+	for( int gy = 0; gy <= PATCH_SIZE; ++gy ) {
+		for( int gx = 0; gx <= PATCH_SIZE; ++gx ) {
+			const float h = sampleHeight(patch.originX + gx, patch.originY + gy);
+			minHeight = (h < minHeight) ? h : minHeight;
+			maxHeight = (h > maxHeight) ? h : maxHeight;
+		}
+	}
+
+	const int lastX = (patch.originX + PATCH_SIZE < _width) ? patch.originX + PATCH_SIZE : _width - 1;
+	const int lastY = (patch.originY + PATCH_SIZE < _height) ? patch.originY + PATCH_SIZE : _height - 1;
+	const float x0 = _origin.x + static_cast<float>(patch.originX) * _spacingX;
+	const float x1 = _origin.x + static_cast<float>(lastX) * _spacingX;
+	const float z0 = _origin.z + static_cast<float>(patch.originY) * _spacingZ;
+	const float z1 = _origin.z + static_cast<float>(lastY) * _spacingZ;
+
+	patch.boundsMin = cc::Vec3f((x0 < x1) ? x0 : x1, _origin.y + minHeight - patch.skirtDepth, (z0 < z1) ? z0 : z1);
+	patch.boundsMax = cc::Vec3f((x0 > x1) ? x0 : x1, _origin.y + maxHeight, (z0 > z1) ? z0 : z1);
+}
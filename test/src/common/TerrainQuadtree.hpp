@@ -0,0 +1,134 @@
+#ifndef __test_terrain_quadtree__
+#define __test_terrain_quadtree__
+
+#include <vector>
+#include <cc/Vec3.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Mat4.hpp>
+
+/**
+ * CPU side of the chunked heightmap terrain.
+ * Splits a heightmap into fixed-size patches, each of which can be drawn at one of several power-of-two detail levels.
+ * Patches are stored in a quadtree with precomputed bounds so that frustum culling and LOD selection are hierarchical.
+ * Cracks between neighbouring patches at different levels are hidden with skirts hanging from each patch's edges.
+ * Knows nothing about the graphics device so that it can be used headless.
+ */
+class TerrainQuadtree {
+public:
+	static const int PATCH_SIZE = 32; /**< Quads along each side of a patch at full detail. */
+	static const int LOD_COUNT = 6; /**< Detail levels; level n steps over 2^n heightmap texels. */
+	static const int PATCH_GRID_VERTICES = (PATCH_SIZE + 1) * (PATCH_SIZE + 1); /**< Grid vertices in a patch. */
+	static const int PATCH_VERTEX_COUNT = PATCH_GRID_VERTICES + 4 * (PATCH_SIZE + 1); /**< Grid plus skirt vertices. */
+
+	struct Patch {
+		int originX; /**< First heightmap column covered. */
+		int originY; /**< First heightmap row covered. */
+		cc::Vec3f boundsMin;
+		cc::Vec3f boundsMax;
+		float lodError[LOD_COUNT]; /**< Maximum height deviation from full detail per level; never decreases with level. */
+		float skirtDepth; /**< How far the skirts hang below the edges. */
+	};
+
+public:
+	TerrainQuadtree();
+	~TerrainQuadtree();
+
+	/**
+	 * Builds patches and the quadtree from a heightmap.
+	 * World positions are origin + (x * spacingX, height, y * spacingZ) for heightmap column x and row y.
+	 * @param heights  Row-major heights; must outlive the quadtree.
+	 * @param width    Heightmap columns.
+	 * @param height   Heightmap rows.
+	 * @param origin   World position of the first texel, ignoring its height.
+	 * @param spacingX World distance between columns.
+	 * @param spacingZ World distance between rows.
+	 * @returns True if built; false otherwise.
+	 */
+	bool build( const float* heights, int width, int height, const cc::Vec3f& origin, float spacingX, float spacingZ );
+	void clean();
+
+	/**
+	 * Configures screen-space error based LOD selection.
+	 * @param maxPixelError  Largest allowed height error on screen, in pixels.
+	 * @param fovDegrees     Vertical field of view of the camera.
+	 * @param viewportHeight Height of the viewport in pixels.
+	 */
+	void setLodParams( float maxPixelError, float fovDegrees, float viewportHeight );
+
+	/**
+	 * Culls patches against a view frustum and picks a detail level for each visible patch.
+	 * Results are available from getVisiblePatches until the next call.
+	 * @param viewProj View projection matrix to extract the frustum from.
+	 * @param eye      World position of the camera.
+	 */
+	void select( const cc::Mat4f& viewProj, const cc::Vec3f& eye );
+
+	/**
+	 * Gets the patches selected at a given level by the last select call.
+	 */
+	const std::vector<int>& getVisiblePatches( int lod ) const;
+	int getVisiblePatchCount() const;
+	int getVisibleTriangleCount() const;
+
+	int getPatchCount() const;
+	const Patch& getPatch( int index ) const;
+
+	/**
+	 * Gets the height of a heightmap texel, clamped to the heightmap the same way patch vertices are.
+	 */
+	float getHeight( int x, int y ) const;
+
+	/**
+	 * Gets the heightmap texel each vertex of a patch is built from.
+	 * The first PATCH_GRID_VERTICES entries are the patch grid in row-major order; the rest are skirt vertices,
+	 * which share the texel of the edge vertex they hang from and should be lowered by the patch's skirtDepth.
+	 * @param patch   Patch index.
+	 * @param indices Output of PATCH_VERTEX_COUNT texel indices (row * width + column).
+	 */
+	void getPatchSourceIndices( int patch, int* indices ) const;
+
+	/**
+	 * Builds the patch-local index list for a detail level, including skirts.
+	 * The same list is shared by every patch.
+	 */
+	static void buildLodIndices( int lod, std::vector<int>& indices );
+	static int getLodIndexCount( int lod );
+
+private:
+	struct Node {
+		cc::Vec3f boundsMin;
+		cc::Vec3f boundsMax;
+		int children[4]; /**< Child nodes, or -1 if absent. */
+		int patch; /**< Patch index for leaves; -1 otherwise. */
+	};
+
+	int buildNode( int x0, int y0, int x1, int y1 );
+	void selectNode( int node, unsigned int planeMask );
+	float sampleHeight( int x, int y ) const;
+	float computeLodError( const Patch& patch, int lod ) const;
+	void computeBounds( Patch& patch ) const;
+
+private:
+	const float* _heights;
+	int _width;
+	int _height;
+	cc::Vec3f _origin;
+	float _spacingX;
+	float _spacingZ;
+
+	int _patchesX;
+	int _patchesY;
+	std::vector<Patch> _patches;
+	std::vector<Node> _nodes;
+	int _root;
+
+	float _maxPixelError;
+	float _lodScale; /**< Converts world error over distance into pixels. */
+
+	// per-select state
+	cc::Vec4f _planes[6];
+	cc::Vec3f _eye;
+	std::vector<int> _visible[LOD_COUNT];
+};
+
+#endif /* __test_terrain_quadtree__ */
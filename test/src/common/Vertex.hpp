@@ -24,4 +24,15 @@ struct Vertex {
 	}
 };
 
+/**
+ * 28 byte version of Vertex used by Model's compact layout.
+ * The normal is octahedral encoded (see VertexPacking::encodeOctahedral) so shaders must decode it; the rest read as floats.
+ */
+struct CompactVertex {
+	cc::Vec3f position;         // Float3
+	short normal[2];            // SNorm16x2, octahedral
+	short tangent[4];           // SNorm16x4; w is handedness
+	unsigned short texcoord[2]; // Half2
+};
+
 #endif /* __test_vertex__ */
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "ClipMesh.hpp"
 #include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <cc/TriMath.hpp>
 
 ClipMesh::CEdgePlus::CEdgePlus( int e, const CEdge& edge ) {
@@ -1,6 +1,7 @@
 #ifndef __ClipPlane__
 #define __ClipPlane__
 
+#include <cstdio>
 #include <vector>
 #include <cc/Vec3.hpp>
 #include <cc/Vec4.hpp>
@@ -3,6 +3,7 @@
 #include <cc/MatrixFunc.hpp>
 #include "ClipMesh.hpp"
 #include "../../common/KScene.hpp"
+#include <xmmintrin.h>
 
 ClippingDemo::ClippingDemo()
 	: App(), _model(nullptr) {
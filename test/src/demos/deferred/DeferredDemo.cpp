@@ -1,6 +1,10 @@
 #include "DeferredDemo.hpp"
 
-DeferredDemo::DeferredDemo() {
+DeferredDemo::DeferredDemo( bool useRenderGraph )
+	: App(), _useRenderGraph(useRenderGraph), _debugView(false) {
+	_config.width = 1280;
+	_config.height = 720;
+	_config.title = "ciri : Deferred Demo";
 }
 
 DeferredDemo::~DeferredDemo() {
@@ -8,18 +12,54 @@ DeferredDemo::~DeferredDemo() {
 
 void DeferredDemo::onInitialize() {
 	App::onInitialize();
+
+	printf("Device: %s\n", graphicsDevice()->getGpuName());
+	printf("API: %s\n", graphicsDevice()->getApiInfo());
+
+	if( !_spritebatch.create(graphicsDevice()) ) {
+		printf("Failed to initialize SpriteBatch.\n");
+	}
+	_samplerState = graphicsDevice()->createSamplerState(ciri::SamplerDesc());
 }
 
 void DeferredDemo::onLoadContent() {
 	App::onLoadContent();
+
+	if( !_renderer.initialize(graphicsDevice(), window()->getWidth(), window()->getHeight(), _useRenderGraph) ) {
+		printf("Failed to initialize the light prepass renderer.\n");
+		return;
+	}
+	_renderer.setDebugView(_debugView);
+	setStages();
 }
 
 void DeferredDemo::onEvent(const ciri::WindowEvent& evt) {
 	App::onEvent(evt);
+
+	switch( evt.type ) {
+		case ciri::WindowEvent::Resized: {
+			graphicsDevice()->resize();
+			_renderer.resize(window()->getWidth(), window()->getHeight());
+			break;
+		}
+	}
 }
 
 void DeferredDemo::onUpdate(const double deltaTime, const double elapsedTime) {
 	App::onUpdate(deltaTime, elapsedTime);
+
+	if( !window()->hasFocus() ) {
+		return;
+	}
+
+	if( input()->isKeyDown(ciri::Key::Escape) ) {
+		this->gtfo();
+		return;
+	}
+
+	if( input()->isKeyDown(ciri::Key::Tab) && input()->wasKeyUp(ciri::Key::Tab) ) {
+		setDebugView(!_debugView);
+	}
 }
 
 void DeferredDemo::onFixedUpdate(const double deltaTime, const double elapsedTime) {
@@ -28,8 +68,67 @@ void DeferredDemo::onFixedUpdate(const double deltaTime, const double elapsedTim
 
 void DeferredDemo::onDraw() {
 	App::onDraw();
+
+	_renderer.render();
+
+	graphicsDevice()->present();
 }
 
 void DeferredDemo::onUnloadContent() {
 	App::onUnloadContent();
+
+	_renderer.clean();
+	_spritebatch.clean();
+	_samplerState = nullptr;
+}
+
+void DeferredDemo::setDebugView( bool enabled ) {
+	_debugView = enabled;
+	_renderer.setDebugView(enabled);
+}
+
+void DeferredDemo::setStages() {
+	const std::shared_ptr<ciri::IGraphicsDevice> device = graphicsDevice();
+
+	// there are no light prepass shaders yet, so the geometry, light and scene stages only clear what they own
+	_renderer.setStage(LppRenderer::Stage::Geometry, [device]( const LppRenderer& ) {
+		device->setClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
+	});
+	_renderer.setStage(LppRenderer::Stage::DirectionalLights, [device]( const LppRenderer& ) {
+		device->setClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		device->clear(ciri::ClearFlags::Color);
+	});
+	_renderer.setStage(LppRenderer::Stage::Scene, [device]( const LppRenderer& ) {
+		device->setClearColor(0.39f, 0.58f, 0.93f, 1.0f);
+		device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
+	});
+
+	_renderer.setStage(LppRenderer::Stage::Composite, [this]( const LppRenderer& renderer ) {
+		const float width = static_cast<float>(window()->getWidth());
+		const float height = static_cast<float>(window()->getHeight());
+		drawTexture(renderer.getTexture(LppRenderer::Buffer::Scene), cc::Vec4f(0.0f, 0.0f, width, height));
+	});
+
+	// the position, normal, depth and light buffers along the bottom
+	_renderer.setStage(LppRenderer::Stage::Debug, [this]( const LppRenderer& renderer ) {
+		const LppRenderer::Buffer buffers[] = {LppRenderer::Buffer::Position, LppRenderer::Buffer::Normal, LppRenderer::Buffer::Depth, LppRenderer::Buffer::Light};
+		const float width = static_cast<float>(window()->getWidth()) * 0.25f;
+		const float height = static_cast<float>(window()->getHeight()) * 0.25f;
+		for( int i = 0; i < 4; ++i ) {
+			drawTexture(renderer.getTexture(buffers[i]), cc::Vec4f(width * static_cast<float>(i), 0.0f, width, height));
+		}
+	});
+}
+
+void DeferredDemo::drawTexture( const std::shared_ptr<ciri::ITexture2D>& texture, const cc::Vec4f& dstRect ) {
+	if( nullptr == texture ) {
+		return;
+	}
+	const std::shared_ptr<ciri::IGraphicsDevice> device = graphicsDevice();
+	if( !_spritebatch.begin(device->getDefaultBlendOpaque(), _samplerState, device->getDefaultDepthStencilNone(), device->getDefaultRasterNone(), ciri::SpriteSortMode::Deferred, nullptr) ) {
+		return;
+	}
+	_spritebatch.draw(texture, dstRect, 0.0f, cc::Vec2f(0.0f, 0.0f), 1.0f);
+	_spritebatch.end();
 }
\ No newline at end of file
@@ -2,10 +2,14 @@
 #define __deferred_demo__
 
 #include <ciri/Game.hpp>
+#include "LppRenderer.hpp"
 
 class DeferredDemo : public ciri::App {
 public:
-	DeferredDemo();
+	/**
+		* @param useRenderGraph True to have the renderer share targets through a render graph; false to give every buffer its own.
+		*/
+	DeferredDemo( bool useRenderGraph=true );
 	virtual ~DeferredDemo();
 
 	virtual void onInitialize();
@@ -15,6 +19,19 @@ public:
 	virtual void onFixedUpdate(const double deltaTime, const double elapsedTime);
 	virtual void onDraw();
 	virtual void onUnloadContent();
+
+	void setDebugView( bool enabled );
+
+private:
+	void setStages();
+	void drawTexture( const std::shared_ptr<ciri::ITexture2D>& texture, const cc::Vec4f& dstRect );
+
+private:
+	LppRenderer _renderer;
+	bool _useRenderGraph;
+	bool _debugView;
+	ciri::SpriteBatch _spritebatch;
+	std::shared_ptr<ciri::ISamplerState> _samplerState;
 };
 
 
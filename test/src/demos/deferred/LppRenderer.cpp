@@ -2,21 +2,30 @@
 #include <cassert>
 
 LppRenderer::LppRenderer()
-	: _initialized(false) {
+	: _initialized(false), _width(0), _height(0), _useGraph(false), _debugView(false) {
+	for( int i = 0; i < static_cast<int>(Buffer::Count); ++i ) {
+		_handles[i] = ciri::RenderGraph::INVALID_HANDLE;
+	}
 }
 
 LppRenderer::~LppRenderer() {
+	clean();
 }
 
-bool LppRenderer::initialize( int width, int height ) {
+bool LppRenderer::initialize( const std::shared_ptr<ciri::IGraphicsDevice>& device, int width, int height, bool useGraph ) {
 	assert(!_initialized && width>0 && height>0);
 
+	_device = device;
 	_width = width;
 	_height = height;
+	_useGraph = useGraph;
 
-	bool success = true;
+	bool success = (device != nullptr);
 
-	if( !createBuffers() ) {
+	if( success && _useGraph ) {
+		// targets come from the graph's pool as frames need them
+		success = _graph.create(device);
+	} else if( success && !createBuffers() ) {
 		success = false;
 	}
 
@@ -24,6 +33,216 @@ bool LppRenderer::initialize( int width, int height ) {
 	return success;
 }
 
+void LppRenderer::clean() {
+	_positionTarget = nullptr;
+	_normalTarget = nullptr;
+	_depthTarget = nullptr;
+	_lightTarget = nullptr;
+	_sceneTarget = nullptr;
+	_sceneDepthTarget = nullptr;
+	_graph.destroy();
+	_device = nullptr;
+	_initialized = false;
+}
+
+bool LppRenderer::resize( int width, int height ) {
+	if( !_initialized || width <= 0 || height <= 0 ) {
+		return false;
+	}
+	_width = width;
+	_height = height;
+	if( _useGraph ) {
+		// new sizes are new descriptions; targets of the old size leave the pool once unused
+		return true;
+	}
+
+	const std::shared_ptr<ciri::IRenderTarget2D> targets[] = {_positionTarget, _normalTarget, _depthTarget, _lightTarget, _sceneTarget, _sceneDepthTarget};
+	for( const auto& target : targets ) {
+		if( ciri::failed(_device->resizeRenderTarget2D(target, width, height)) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void LppRenderer::setStage( Stage stage, const StageFunc& func ) {
+	_stages[static_cast<int>(stage)] = func;
+}
+
+void LppRenderer::setDebugView( bool enabled ) {
+	_debugView = enabled;
+}
+
+bool LppRenderer::isDebugView() const {
+	return _debugView;
+}
+
+bool LppRenderer::isUsingGraph() const {
+	return _useGraph;
+}
+
+void LppRenderer::render() {
+	if( !_initialized ) {
+		return;
+	}
+	if( _useGraph ) {
+		renderGraph();
+	} else {
+		renderFixed();
+	}
+}
+
+std::shared_ptr<ciri::ITexture2D> LppRenderer::getTexture( Buffer buffer ) const {
+	std::shared_ptr<ciri::IRenderTarget2D> target;
+	if( _useGraph ) {
+		target = _graph.getTarget(_handles[static_cast<int>(buffer)]);
+	} else {
+		switch( buffer ) {
+			case Buffer::Position: {
+				target = _positionTarget;
+				break;
+			}
+			case Buffer::Normal: {
+				target = _normalTarget;
+				break;
+			}
+			case Buffer::Depth: {
+				target = _depthTarget;
+				break;
+			}
+			case Buffer::Light: {
+				target = _lightTarget;
+				break;
+			}
+			case Buffer::Scene: {
+				target = _sceneTarget;
+				break;
+			}
+			case Buffer::SceneDepth: {
+				target = _sceneDepthTarget;
+				break;
+			}
+			default: {
+				break;
+			}
+		}
+	}
+	return (target != nullptr) ? target->getTexture() : nullptr;
+}
+
+const ciri::RenderGraph& LppRenderer::getGraph() const {
+	return _graph;
+}
+
 bool LppRenderer::createBuffers() {
-	throw;
+	std::shared_ptr<ciri::IRenderTarget2D>* targets[] = {&_positionTarget, &_normalTarget, &_depthTarget, &_lightTarget, &_sceneTarget, &_sceneDepthTarget};
+	for( int i = 0; i < static_cast<int>(Buffer::Count); ++i ) {
+		const ciri::RenderGraphTargetDesc desc = getDesc(static_cast<Buffer>(i));
+		*targets[i] = _device->createRenderTarget2D(desc.width, desc.height, desc.format, desc.depthFormat);
+		if( nullptr == *targets[i] ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void LppRenderer::renderFixed() {
+	// every stage binds what it writes, as each would on its own
+	ciri::IRenderTarget2D* gbuffer[] = {_positionTarget.get(), _normalTarget.get(), _depthTarget.get()};
+	ciri::IRenderTarget2D* light[] = {_lightTarget.get()};
+	ciri::IRenderTarget2D* scene[] = {_sceneTarget.get(), _sceneDepthTarget.get()};
+
+	_device->setRenderTargets(gbuffer, 3);
+	runStage(Stage::Geometry);
+	_device->setRenderTargets(light, 1);
+	runStage(Stage::DirectionalLights);
+	_device->setRenderTargets(light, 1);
+	runStage(Stage::PointLights);
+	_device->setRenderTargets(scene, 2);
+	runStage(Stage::Scene);
+	_device->setRenderTargets(scene, 2);
+	runStage(Stage::Forward);
+	_device->restoreDefaultRenderTargets();
+	runStage(Stage::Composite);
+	if( _debugView ) {
+		_device->restoreDefaultRenderTargets();
+		runStage(Stage::Debug);
+	}
+}
+
+void LppRenderer::renderGraph() {
+	static const char* BUFFER_NAMES[] = {"position", "normal", "depth", "light", "scene", "scene depth"};
+
+	_graph.reset();
+	for( int i = 0; i < static_cast<int>(Buffer::Count); ++i ) {
+		_handles[i] = _graph.createTarget(BUFFER_NAMES[i], getDesc(static_cast<Buffer>(i)));
+	}
+	const int position = _handles[static_cast<int>(Buffer::Position)];
+	const int normal = _handles[static_cast<int>(Buffer::Normal)];
+	const int depth = _handles[static_cast<int>(Buffer::Depth)];
+	const int light = _handles[static_cast<int>(Buffer::Light)];
+	const int scene = _handles[static_cast<int>(Buffer::Scene)];
+	const int sceneDepth = _handles[static_cast<int>(Buffer::SceneDepth)];
+	const int backbuffer = _graph.importTarget("backbuffer", nullptr);
+
+	const int geometry = _graph.addPass("geometry", [this]( const ciri::RenderGraph& ) { runStage(Stage::Geometry); });
+	_graph.write(geometry, position);
+	_graph.write(geometry, normal);
+	_graph.write(geometry, depth);
+
+	const Stage lightStages[] = {Stage::DirectionalLights, Stage::PointLights};
+	for( const Stage stage : lightStages ) {
+		const int lights = _graph.addPass("lights", [this, stage]( const ciri::RenderGraph& ) { runStage(stage); });
+		_graph.read(lights, position);
+		_graph.read(lights, normal);
+		_graph.read(lights, depth);
+		_graph.write(lights, light);
+	}
+
+	const Stage sceneStages[] = {Stage::Scene, Stage::Forward};
+	for( const Stage stage : sceneStages ) {
+		const int pass = _graph.addPass("scene", [this, stage]( const ciri::RenderGraph& ) { runStage(stage); });
+		_graph.read(pass, light);
+		_graph.write(pass, scene);
+		_graph.write(pass, sceneDepth);
+	}
+
+	const int composite = _graph.addPass("composite", [this]( const ciri::RenderGraph& ) { runStage(Stage::Composite); });
+	_graph.read(composite, scene);
+	_graph.write(composite, backbuffer);
+
+	// reading the g-buffer here keeps it alive to the end of the frame, so the debug view costs the memory it would without the graph
+	if( _debugView ) {
+		const int debug = _graph.addPass("debug", [this]( const ciri::RenderGraph& ) { runStage(Stage::Debug); });
+		_graph.read(debug, position);
+		_graph.read(debug, normal);
+		_graph.read(debug, depth);
+		_graph.read(debug, light);
+		_graph.write(debug, backbuffer);
+	}
+
+	if( ciri::failed(_graph.compile()) ) {
+		return;
+	}
+	_graph.execute();
+}
+
+void LppRenderer::runStage( Stage stage ) const {
+	const StageFunc& func = _stages[static_cast<int>(stage)];
+	if( func ) {
+		func(*this);
+	}
+}
+
+ciri::RenderGraphTargetDesc LppRenderer::getDesc( Buffer buffer ) const {
+	switch( buffer ) {
+		case Buffer::Depth:
+		case Buffer::SceneDepth: {
+			// linear depth, carrying the pass's depth-stencil buffer; gl binds the first one it finds
+			return ciri::RenderGraphTargetDesc(_width, _height, ciri::TextureFormat::R32_FLOAT, ciri::DepthStencilFormat::Depth24Stencil8);
+		}
+		default: {
+			return ciri::RenderGraphTargetDesc(_width, _height, ciri::TextureFormat::RGBA32_Float);
+		}
+	}
 }
\ No newline at end of file
@@ -1,31 +1,96 @@
 #ifndef __deferred_demo_LppRenderer__
 #define __deferred_demo_LppRenderer__
 
+#include <functional>
 #include <ciri/Graphics.hpp>
 
 /* Light Prepass Deferred Renderer */
 class LppRenderer {
+public:
+	enum class Buffer {
+		Position,
+		Normal,
+		Depth,
+		Light,
+		Scene,
+		SceneDepth,
+		Count
+	};
+
+	/**
+	 * Stages in the order they run.  Each renders to the buffers it owns; stages without a function still bind their targets.
+	 */
+	enum class Stage {
+		Geometry,          /**< Writes position, normal and depth. */
+		DirectionalLights, /**< Reads the g-buffer; writes light. */
+		PointLights,       /**< Reads the g-buffer; adds to light. */
+		Scene,             /**< Reads light; writes scene and scene depth. */
+		Forward,           /**< Adds to scene and scene depth. */
+		Composite,         /**< Reads scene; writes the default render targets. */
+		Debug,             /**< Reads the g-buffer and light; draws over the composite.  Only runs with the debug view on. */
+		Count
+	};
+
+	typedef std::function<void( const LppRenderer& renderer )> StageFunc;
+
 public:
 	LppRenderer();
 	~LppRenderer();
 
-	bool initialize( int width, int height );
+	/**
+		* @param device   Device to render with.
+		* @param width    Width of every buffer.
+		* @param height   Height of every buffer.
+		* @param useGraph True to declare the frame to a render graph, which shares targets between buffers whose lifetimes do not overlap;
+		*                 false to keep one target per buffer for the life of the renderer and bind each stage's targets as it runs.
+		*/
+	bool initialize( const std::shared_ptr<ciri::IGraphicsDevice>& device, int width, int height, bool useGraph );
+	void clean();
+	bool resize( int width, int height );
+
+	void setStage( Stage stage, const StageFunc& func );
+	void setDebugView( bool enabled );
+	bool isDebugView() const;
+	bool isUsingGraph() const;
+
+	/**
+		* Runs every stage.  Leaves the default render targets bound.
+		*/
+	void render();
+
+	/**
+		* Gets the texture behind a buffer.  Only valid inside stage functions, since with the graph buffers share targets.
+		*/
+	std::shared_ptr<ciri::ITexture2D> getTexture( Buffer buffer ) const;
+
+	const ciri::RenderGraph& getGraph() const;
 
 private:
 	bool createBuffers();
-	
+	void renderFixed();
+	void renderGraph();
+	void runStage( Stage stage ) const;
+	ciri::RenderGraphTargetDesc getDesc( Buffer buffer ) const;
+
 private:
 	bool _initialized;
 	int _width;
 	int _height;
+	bool _useGraph;
+	bool _debugView;
+	std::shared_ptr<ciri::IGraphicsDevice> _device;
+	StageFunc _stages[static_cast<int>(Stage::Count)];
 
+	// fixed targets; unused with the graph
 	std::shared_ptr<ciri::IRenderTarget2D> _positionTarget;
 	std::shared_ptr<ciri::IRenderTarget2D> _normalTarget;
 	std::shared_ptr<ciri::IRenderTarget2D> _depthTarget;
 	std::shared_ptr<ciri::IRenderTarget2D> _lightTarget;
 	std::shared_ptr<ciri::IRenderTarget2D> _sceneTarget;
 	std::shared_ptr<ciri::IRenderTarget2D> _sceneDepthTarget;
-	
+
+	ciri::RenderGraph _graph;
+	int _handles[static_cast<int>(Buffer::Count)]; /**< Graph handles for this frame's buffers. */
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "DynamicVertexBufferDemo.hpp"
 #include <ciri/core/Log.hpp>
 #include <cc/MatrixFunc.hpp>
+#include <xmmintrin.h>
 
 DynamicVertexBufferDemo::DynamicVertexBufferDemo()
 	: App(), _depthStencilState(nullptr), _rasterizerState(nullptr),
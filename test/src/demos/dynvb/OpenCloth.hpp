@@ -18,8 +18,7 @@ private:
 	};
 
 public:
-	_declspec(align(16))
-	struct Constants {
+	struct alignas(16) Constants {
 		cc::Mat4f world;
 		cc::Mat4f xform;
 		cc::Vec3f camdir;
@@ -57,7 +56,7 @@ private:
 	void provotDynamicInverse();
 	void computeNormals();
 	void addSpring( int* idx, int a, int b, float ks, float kd );
-	__forceinline cc::Vec3f getVerletVelocity( const cc::Vec3f& pos, const cc::Vec3f& lastPos, float deltaTime );
+	inline cc::Vec3f getVerletVelocity( const cc::Vec3f& pos, const cc::Vec3f& lastPos, float deltaTime );
 	
 
 private:
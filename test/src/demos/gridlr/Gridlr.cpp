@@ -9,6 +9,8 @@ Gridlr::Gridlr()
 	_config.width = 1280;
 	_config.height = 720;
 	_config.title = "ciri : Gridlr";
+	// drawing only reads the snapshot and the input, so the grid can be simulated while the frame before is drawn
+	_config.pipelined = true;
 }
 
 Gridlr::~Gridlr() {
@@ -127,6 +129,30 @@ void Gridlr::onUpdate(const double deltaTime, const double elapsedTime) {
 		printf("Complete!\n");
 	}
 
+	// hand the cells to drawing as sprites
+	ciri::RenderSnapshot& snapshot = updateSnapshot();
+	for( int y = 0; y < _grid->height(); ++y ) {
+		for( int x = 0; x < _grid->width(); ++x ) {
+			ciri::SnapshotSprite sprite;
+			sprite.texture = _cellTexture;
+			sprite.position = cc::Vec2f(
+				_gridOffset.x + static_cast<float>(_cellTexture->getWidth() * x),
+				_gridOffset.y + static_cast<float>(_cellTexture->getHeight() * y)
+			);
+
+			// pick color based on state
+			switch( _grid->get(x, y)->state() ) {
+				case gridlr::BlockState::Empty: { sprite.color = cc::Vec4f(1.0f, 1.0f, 1.0f, 1.0); break; }
+				case gridlr::BlockState::One: { sprite.color = cc::Vec4f(1.0f, 0.0f, 0.0f, 1.0); break; }
+				case gridlr::BlockState::Two: { sprite.color = cc::Vec4f(0.0f, 1.0f, 0.0f, 1.0); break; }
+				case gridlr::BlockState::Three: { sprite.color = cc::Vec4f(0.0f, 0.0f, 1.0f, 1.0); break; }
+				default: { sprite.color = cc::Vec4f(1.0f, 0.0f, 1.0f, 1.0f); break; }
+			}
+
+			snapshot.sprites.push_back(sprite);
+		}
+	}
+
 
 
 
@@ -148,35 +174,9 @@ void Gridlr::onDraw() {
 	device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
 
 	_spriteBatch.begin(_blendState, _samplerState, _depthStencilState, _rasterizerState, ciri::SpriteSortMode::Deferred, nullptr);
-	// draw grid
-	for( int y = 0; y < _grid->height(); ++y ) {
-		for( int x = 0; x < _grid->width(); ++x ) {
-			auto block = _grid->get(x, y);
-
-			// vp to invert positions
-			auto& vp = device->getViewport();
-
-			// offset and inverted positions
-			cc::Vec2f position = {
-				_gridOffset.x + static_cast<float>(_cellTexture->getWidth() * x),
-				_gridOffset.y + static_cast<float>(_cellTexture->getHeight() * y)
-			};
-
-			// pick color based on state
-			cc::Vec4f color;
-			switch( block->state() ) {
-				case gridlr::BlockState::Empty: { color = cc::Vec4f(1.0f, 1.0f, 1.0f, 1.0); break; }
-				case gridlr::BlockState::One: { color = cc::Vec4f(1.0f, 0.0f, 0.0f, 1.0); break; }
-				case gridlr::BlockState::Two: { color = cc::Vec4f(0.0f, 1.0f, 0.0f, 1.0); break; }
-				case gridlr::BlockState::Three: { color = cc::Vec4f(0.0f, 0.0f, 1.0f, 1.0); break; }
-				default: { color = cc::Vec4f(1.0f, 0.0f, 1.0f, 1.0f); break; }
-			}
-
-			// draw
-			const cc::Vec2f origin(0.0f, 0.0f);
-			const cc::Vec2f scale(1.0f, 1.0f);
-			_spriteBatch.draw(_cellTexture, position, 0.0f, origin, scale, 0.0f, color);
-		}
+	// draw grid from the snapshot, as the grid itself may be mid update
+	for( const auto& sprite : drawSnapshot().sprites ) {
+		_spriteBatch.draw(sprite.texture, sprite.position, sprite.rotation, sprite.origin, sprite.scale, sprite.depth, sprite.color);
 	}
 
 	const std::string str1 = "Hello, ";
@@ -1,5 +1,6 @@
 #include "ParallaxDemo.hpp"
 #include "../../common/ModelGen.hpp"
+#include <xmmintrin.h>
 
 ParallaxDemo::ParallaxDemo()
 	: App(), _depthStencilState(nullptr), _rasterizerState(nullptr), _model(nullptr), _parallaxShader(nullptr),
@@ -11,8 +11,7 @@
 #include "../../common/AxisWidget.hpp"
 #include "../../common/Model.hpp"
 
-__declspec(align(16))
-struct ParallaxVertexConstants {
+struct alignas(16) ParallaxVertexConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	cc::Vec3f campos;
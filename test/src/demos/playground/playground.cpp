@@ -141,10 +141,19 @@ void Playground::onUpdate(const double deltaTime, const double elapsedTime) {
 	//	_camera.rotateYaw(-(input()->lastMouseX() - input()->mouseX()) * deltaTime);
 	//}
 
-	if( input()->isKeyDown(ciri::Key::F11) && input()->wasKeyUp(ciri::Key::F11) ) {
-		printf("Writing textures...");
-		_renderTarget->getTexture()->writeToTGA("C:\\Users\\daniel\\Desktop\\test.tga");
-		printf("done!\n");
+	// the readback resolves a frame or two later, so the capture never stalls the frame
+	if( input()->isKeyDown(ciri::Key::F11) && input()->wasKeyUp(ciri::Key::F11) && !_capture.valid() ) {
+		printf("Reading render target...\n");
+		_capture = _renderTarget->readAsync();
+	}
+	if( _capture.valid() && std::future_status::ready == _capture.wait_for(std::chrono::seconds(0)) ) {
+		const ciri::TextureReadback capture = _capture.get();
+		const ciri::ErrorCode result = capture.writeToTGA("C:\\Users\\daniel\\Desktop\\test.tga");
+		if( ciri::failed(result) ) {
+			printf("Failed to write render target: %s\n", ciri::getErrorString(result));
+		} else {
+			printf("Wrote render target (%dx%d)\n", capture.width, capture.height);
+		}
 	}
 }
 
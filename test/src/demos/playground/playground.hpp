@@ -8,24 +8,21 @@
 #include "PlayerPlaneController.hpp"
 #include <cc/Quaternion.hpp>
 
-__declspec(align(16))
-struct PGWaterConstants {
+struct alignas(16) PGWaterConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	float ElapsedTime;
 	cc::Vec3f CamPos;
 };
 
-__declspec(align(16))
-struct BasicConstants {
+struct alignas(16) BasicConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	cc::Mat4f lightViewProj;
 	cc::Vec3f campos; // this fucker caused alignment issues.
 };
 
-__declspec(align(16))
-struct PGDepthConstants {
+struct alignas(16) PGDepthConstants {
 	cc::Mat4f xform;
 };
 
@@ -62,6 +59,7 @@ private:
 	cc::Quatf _cameraOrientation;
 
 	std::shared_ptr<ciri::IRenderTarget2D> _renderTarget;
+	std::future<ciri::TextureReadback> _capture; /**< Pending F11 capture; written once resolved. */
 	std::shared_ptr<ciri::IDepthStencilState> _depthStencilState;
 	std::shared_ptr<ciri::SpriteBatch> _spriteBatch;
 	std::shared_ptr<ciri::ISamplerState> _samplerState;
@@ -1,4 +1,5 @@
 #include "RefractDemo.hpp"
+#include <xmmintrin.h>
 
 RefractDemo::RefractDemo()
 	: App(), _model(nullptr) {
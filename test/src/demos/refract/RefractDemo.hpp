@@ -8,15 +8,13 @@
 #include "../../common/Model.hpp"
 #include "../../common/ModelGen.hpp"
 
-__declspec(align(16))
-struct RefractVertexConstants {
+struct alignas(16) RefractVertexConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	cc::Vec3f campos;
 };
 
-__declspec(align(16))
-struct SkyboxConstants {
+struct alignas(16) SkyboxConstants {
 	cc::Mat4f view;
 	cc::Mat4f proj;
 };
@@ -1,6 +1,5 @@
 #include "Light.hpp"
 #include <cc/MatrixFunc.hpp>
-#include "BoundingBox.hpp"
 
 Light::Light( Type type )
 	: _diffuseColor(1.0f), _diffuseIntensity(1.0f), _specularColor(1.0f), _specularIntensity(1.0f),
@@ -134,112 +133,33 @@ void Light::setCastShadows( bool val ) {
 	_castShadows = val;
 }
 
-void Light::computeViewProjFromFrustum( const BoundingFrustum& frustum ) {
-	std::vector<cc::Vec3f> corners;
-	for( const auto& p : frustum.corners() ) {
-		corners.push_back(p);
-	}
-
+cc::Mat4f Light::computeCascadeViewProj( const std::array<cc::Vec3f, 8>& corners, int resolution, float casterDistance ) const {
+	// bounding sphere of the corners
 	cc::Vec3f center(0.0f, 0.0f, 0.0f);
 	for( const auto& c : corners ) {
 		center += c;
 	}
 	center /= static_cast<float>(corners.size());
-
-	const float nearClipOffset = 0.0f;
-	const float distFromCentroid = _range + nearClipOffset;
-	const cc::Mat4f viewMatrix = cc::math::lookAtRH(center - (_direction * distFromCentroid), center, cc::Vec3f::up());
-
-	for( auto& c : corners ) {
-		c = (cc::Vec4f(c, 1.0f) * viewMatrix).truncated();
-	}
-
-	cc::Vec3f mins(std::numeric_limits<float>::max());
-	cc::Vec3f maxs(std::numeric_limits<float>::min());
+	float radius = 0.0f;
 	for( const auto& c : corners ) {
-		mins.x = (c.x < mins.x) ? c.x : mins.x;
-		mins.y = (c.y < mins.y) ? c.y : mins.y;
-		mins.z = (c.z < mins.z) ? c.z : mins.z;
-		maxs.x = (c.x > maxs.x) ? c.x : maxs.x;
-		maxs.y = (c.y > maxs.y) ? c.y : maxs.y;
-		maxs.z = (c.z > maxs.z) ? c.z : maxs.z;
-	}
-
-	_proj = cc::math::orthographic<float>(-100.0f, 100.0f, -100.0f, 100.0f, -20.0f, 100.0f);
-	//_proj = cc::math::orthographic<float>(mins.x, maxs.x, mins.y, maxs.y, -maxs.z - nearClipOffset, -mins.z);
-	_view = cc::math::lookAtRH(cc::Vec3f::zero(), _direction, cc::Vec3f::up());
-	//_proj = cc::math::orthographic<float>(-100.0f, 100.0f, -100.0f, 100.0f, -10.0f, 100.0f);
-	//_view = viewMatrix;
-
-	//// matrix that rotates points in direction of light
-	//cc::Mat4f lightRotation = cc::math::lookAtRH(cc::Vec3f::zero(), -_direction, cc::Vec3f::up());
-	//// corners of frustum
-	//std::vector<cc::Vec3f> frustumCorners;
-	//for( const auto& p : frustum.corners() ) {
-	//	frustumCorners.push_back(p);
-	//}
-	//// transform corner positions into the direction of the light
-	//for( auto& corner : frustumCorners ) {
-	//	corner = (cc::Vec4f(corner, 1.0f) * lightRotation).truncated();
-	//}
-	//// find smallest bounding box around the points
-	//BoundingBox lightBox = BoundingBox::createFromPoints(frustumCorners);
-	//const cc::Vec3f boxSize = lightBox.Max - lightBox.Min;
-	//const cc::Vec3f halfBoxSize = boxSize * 0.5f;
-	//// position of light should be center of back panel of the box
-	//cc::Vec3f lightPosition = lightBox.Min + halfBoxSize;
-	//lightPosition.z = lightBox.Min.z;
-	//// position back in world coordinates
-	//lightRotation.invert();
-	//lightPosition = (cc::Vec4f(lightPosition, 1.0f) * lightRotation).truncated();
-
-	//// create view matrix
-	////_view = cc::math::lookAtRH(lightPosition, lightPosition - _direction, cc::Vec3f::up());
-	////_view = cc::math::lookAtRH(cc::Vec3f::zero(), _direction, cc::Vec3f::up());
-	//// create projection matrix
-	//const float near = -lightBox.Max.z;
-	//const float far = -lightBox.Min.z;
-	//_proj = cc::math::orthographic<float>(lightBox.Min.x, lightBox.Max.x, lightBox.Min.y, lightBox.Max.y, near, far);
-	////_proj = cc::math::orthographic<float>(-100.0f, 100.0f, -100.0f, 100.0f, -10.0f, 100.0f);
-}
-
-void Light::computeViewProjOrtho( cc::Mat4f cameraView, float fov, float aspect, float nearP, float farP ) {
-	cameraView.invert();
-	const cc::Mat4f lightView = cc::math::lookAtRH(cc::Vec3f::zero(), _direction, cc::Vec3f::up());
-
-	const float tanHalfHFov = tanf(cc::math::DEG_TO_RAD * (fov * 0.5f));
-	const float tanHalfVFov = tanf(cc::math::DEG_TO_RAD * ((fov * aspect) * 0.5f));
-
-	const float xn = nearP * tanHalfHFov;
-	const float xf = farP * tanHalfHFov;
-	const float yn = nearP * tanHalfVFov;
-	const float yf = farP * tanHalfVFov;
-	cc::Vec4f frustumCorners[8] = {
-		cc::Vec4f( xn,  yn, nearP, 1.0f),
-		cc::Vec4f(-xn,  yn, nearP, 1.0f),
-		cc::Vec4f( xn, -yn, nearP, 1.0f),
-		cc::Vec4f(-xn, -yn, nearP, 1.0f),
-		cc::Vec4f( xf,  yf, farP, 1.0f),
-		cc::Vec4f(-xf,  yf, farP, 1.0f),
-		cc::Vec4f( xf, -yf, farP, 1.0f),
-		cc::Vec4f(-xf, -yf, farP, 1.0f)
-	};
-
-	cc::Vec4f frustomCornersLocal[8];
-	cc::Vec3f minimum(std::numeric_limits<float>::max());
-	cc::Vec3f maximum(std::numeric_limits<float>::min());
-	for( int i = 0; i < 8; ++i ) {
-		const cc::Vec4f vW = frustumCorners[i] * cameraView;
-		frustomCornersLocal[i] = vW * lightView;
-
-		minimum.x = cc::math::minimum(minimum.x, frustomCornersLocal[i].x);
-		minimum.y = cc::math::minimum(minimum.y, frustomCornersLocal[i].y);
-		minimum.z = cc::math::minimum(minimum.z, frustomCornersLocal[i].z);
-		maximum.x = cc::math::maximum(maximum.x, frustomCornersLocal[i].x);
-		maximum.y = cc::math::maximum(maximum.y, frustomCornersLocal[i].y);
-		maximum.z = cc::math::maximum(maximum.z, frustomCornersLocal[i].z);
+		radius = cc::math::maximum(radius, (c - center).magnitude());
 	}
-
-	_proj = cc::math::orthographic<float>(minimum.x, maximum.x, minimum.y, maximum.y, minimum.z, maximum.z);
-	_view = cc::math::lookAtRH(cc::Vec3f::zero(), _direction, cc::Vec3f::up());
-}
+	// rounding up keeps float noise in the corners from changing the size between frames
+	radius = ceilf(radius * 16.0f) / 16.0f;
+
+	// the view only rotates, so a center snapped in its space stays snapped as the camera moves
+	const cc::Vec3f up = (fabsf(_direction.y) > 0.99f) ? cc::Vec3f(0.0f, 0.0f, 1.0f) : cc::Vec3f::up();
+	const cc::Mat4f view = cc::math::lookAtRH(cc::Vec3f::zero(), _direction, up);
+	cc::Vec3f lightCenter = (view * cc::Vec4f(center, 1.0f)).truncated();
+	const float texel = (radius * 2.0f) / static_cast<float>(resolution);
+	lightCenter.x = floorf(lightCenter.x / texel) * texel;
+	lightCenter.y = floorf(lightCenter.y / texel) * texel;
+	// depth too; it doesn't crawl, but snapping it means the whole matrix holds still and the map can be kept
+	lightCenter.z = floorf(lightCenter.z / texel) * texel;
+
+	// the view looks down -z; the near plane is pulled back toward the light for casters outside of the sphere
+	const float nearP = -lightCenter.z - radius - casterDistance;
+	const float farP = -lightCenter.z + radius;
+	const cc::Mat4f proj = cc::math::orthographic<float>(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius, nearP, farP);
+	return proj * view;
+}
\ No newline at end of file
@@ -1,9 +1,9 @@
 #ifndef __ShadowsDemo_Light__
 #define __ShadowsDemo_Light__
 
+#include <array>
 #include <cc/Vec3.hpp>
 #include <cc/Mat4.hpp>
-#include "BoundingFrustum.hpp"
 
 class Light {
 public:
@@ -44,8 +44,16 @@ public:
 	void setConeInnerAngle( float val );
 	void setConeOuterAngle( float val );
 	void setCastShadows( bool val );
-	void computeViewProjFromFrustum( const BoundingFrustum& frustum );
-	void computeViewProjOrtho( cc::Mat4f cameraView, float fov, float aspect, float nearP, float farP );
+
+	/**
+	 * Fits an orthographic view-projection of a directional light around part of the view volume.
+	 * The part is bounded by a sphere so that the size does not change as the camera turns, and the sphere's center is snapped
+	 * to whole texels of the map so that shadow edges do not crawl as the camera moves.
+	 * @param corners        Corners of the part of the view volume to cover.
+	 * @param resolution     Texels along each side of the map.
+	 * @param casterDistance How far past the volume, toward the light, casters are still caught.
+	 */
+	cc::Mat4f computeCascadeViewProj( const std::array<cc::Vec3f, 8>& corners, int resolution, float casterDistance ) const;
 
 private:
 	// colors
@@ -0,0 +1,87 @@
+#include "ShadowAtlas.hpp"
+#include <cc/MatrixFunc.hpp>
+
+ShadowAtlas::ShadowAtlas()
+	: _target(nullptr), _size(0), _tileSize(0), _tilesPerSide(0), _allocated(0) {
+}
+
+ShadowAtlas::~ShadowAtlas() {
+	destroy();
+}
+
+bool ShadowAtlas::create( const std::shared_ptr<ciri::IGraphicsDevice>& device, int size, int tileSize, ciri::DepthStencilFormat format ) {
+	if( nullptr == device || tileSize <= 0 || size < tileSize || (size % tileSize) != 0 || ciri::DepthStencilFormat::None == format ) {
+		return false;
+	}
+
+	// maps only need depth, so there is no color texture to write or to pay for
+	_target = device->createRenderTarget2D(size, size, ciri::TextureFormat::None, format);
+	if( nullptr == _target ) {
+		return false;
+	}
+	_size = size;
+	_tileSize = tileSize;
+	_tilesPerSide = size / tileSize;
+	_allocated = 0;
+	return true;
+}
+
+void ShadowAtlas::destroy() {
+	_target = nullptr;
+	_size = 0;
+	_tileSize = 0;
+	_tilesPerSide = 0;
+	_allocated = 0;
+}
+
+int ShadowAtlas::allocate() {
+	if( _allocated >= getCapacity() ) {
+		return -1;
+	}
+	_allocated += 1;
+	return _allocated - 1;
+}
+
+void ShadowAtlas::releaseAll() {
+	_allocated = 0;
+}
+
+int ShadowAtlas::getSize() const {
+	return _size;
+}
+
+int ShadowAtlas::getTileSize() const {
+	return _tileSize;
+}
+
+int ShadowAtlas::getCapacity() const {
+	return _tilesPerSide * _tilesPerSide;
+}
+
+int ShadowAtlas::getAllocatedCount() const {
+	return _allocated;
+}
+
+ciri::Viewport ShadowAtlas::getViewport( int tile ) const {
+	const int x = (tile % _tilesPerSide) * _tileSize;
+	const int y = (tile / _tilesPerSide) * _tileSize;
+	return ciri::Viewport(x, y, _tileSize, _tileSize);
+}
+
+cc::Vec4f ShadowAtlas::getRect( int tile ) const {
+	const ciri::Viewport vp = getViewport(tile);
+	const float invSize = 1.0f / static_cast<float>(_size);
+	return cc::Vec4f(vp.x() * invSize, vp.y() * invSize, (vp.x() + vp.width()) * invSize, (vp.y() + vp.height()) * invSize);
+}
+
+cc::Mat4f ShadowAtlas::toAtlas( int tile, const cc::Mat4f& viewProj ) const {
+	// squeeze the map's -1..1 into the tile's part of the atlas's -1..1; depth is left alone
+	const cc::Vec4f rect = getRect(tile);
+	const cc::Vec3f scale(rect.z - rect.x, rect.w - rect.y, 1.0f);
+	const cc::Vec3f offset(rect.x + rect.z - 1.0f, rect.y + rect.w - 1.0f, 0.0f);
+	return cc::math::translate<float>(offset) * cc::math::scale<float>(scale) * viewProj;
+}
+
+const std::shared_ptr<ciri::IRenderTarget2D>& ShadowAtlas::getTarget() const {
+	return _target;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef __ShadowsDemo_ShadowAtlas__
+#define __ShadowsDemo_ShadowAtlas__
+
+#include <memory>
+#include <cc/Vec4.hpp>
+#include <cc/Mat4.hpp>
+#include <ciri/Graphics.hpp>
+
+/**
+ * One depth-only render target split into a grid of equal square tiles, each holding one shadow map.
+ * Shadow maps render into their tile through its viewport, so every map in a frame shares a single target and a single bind.
+ */
+class ShadowAtlas {
+public:
+	ShadowAtlas();
+	~ShadowAtlas();
+
+	/**
+		* @param device   Device to create the target with.
+		* @param size     Texels along each side of the atlas.
+		* @param tileSize Texels along each side of a tile.  Must divide size.
+		* @param format   Depth format of the atlas.
+		*/
+	bool create( const std::shared_ptr<ciri::IGraphicsDevice>& device, int size, int tileSize, ciri::DepthStencilFormat format );
+	void destroy();
+
+	/**
+		* Takes the next free tile.
+		* @returns Index of the tile, or -1 if every tile is taken.
+		*/
+	int allocate();
+
+	/**
+		* Frees every tile.
+		*/
+	void releaseAll();
+
+	int getSize() const;
+	int getTileSize() const;
+	int getCapacity() const;
+	int getAllocatedCount() const;
+
+	/**
+		* Gets the viewport that renders to a tile.
+		*/
+	ciri::Viewport getViewport( int tile ) const;
+
+	/**
+		* Gets the texture coordinates a tile covers, as min x, min y, max x, max y.
+		*/
+	cc::Vec4f getRect( int tile ) const;
+
+	/**
+		* Maps a view-projection that renders a whole map into one that lands in a tile of the whole atlas, for sampling.
+		*/
+	cc::Mat4f toAtlas( int tile, const cc::Mat4f& viewProj ) const;
+
+	const std::shared_ptr<ciri::IRenderTarget2D>& getTarget() const;
+
+private:
+	std::shared_ptr<ciri::IRenderTarget2D> _target;
+	int _size;
+	int _tileSize;
+	int _tilesPerSide;
+	int _allocated;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "ShadowMapper.hpp"
+#include <cmath>
+#include <cstring>
+#include <ciri/core/Profiler.hpp>
+
+ShadowMapper::Stats::Stats()
+	: frames(0), setupNanoseconds(0), views(0), drawnViews(0), casterDraws(0) {
+}
+
+ShadowMapper::ShadowMapper()
+	: _cascadeCount(0), _splitLambda(0.75f), _casterDistance(100.0f), _caching(true), _dirtyViews(0) {
+}
+
+ShadowMapper::~ShadowMapper() {
+	destroy();
+}
+
+bool ShadowMapper::create( const std::shared_ptr<ciri::IGraphicsDevice>& device, int atlasSize, int tileSize, int cascadeCount ) {
+	if( cascadeCount <= 0 || cascadeCount > MAX_CASCADES ) {
+		return false;
+	}
+	if( !_atlas.create(device, atlasSize, tileSize, ciri::DepthStencilFormat::Depth32F) ) {
+		return false;
+	}
+	_cascadeCount = cascadeCount;
+	_views.clear();
+	_layout.clear();
+	_stats = Stats();
+	return true;
+}
+
+void ShadowMapper::destroy() {
+	_atlas.destroy();
+	_views.clear();
+	_firstView.clear();
+	_viewCount.clear();
+	_layout.clear();
+	_dirtyViews = 0;
+}
+
+void ShadowMapper::setSplitLambda( float lambda ) {
+	_splitLambda = lambda;
+}
+
+void ShadowMapper::setCasterDistance( float distance ) {
+	_casterDistance = distance;
+}
+
+void ShadowMapper::setCaching( bool enabled ) {
+	_caching = enabled;
+}
+
+void ShadowMapper::invalidate() {
+	for( auto& view : _views ) {
+		view.drawn = false;
+	}
+}
+
+void ShadowMapper::update( std::vector<Light>& lights, const CameraInfo& camera, const ciri::BoundingBoxArray& bounds, const std::vector<cc::Mat4f>& worlds ) {
+	CIRI_PROFILE_SCOPE("Shadow setup");
+	const long long start = ciri::Profiler::now();
+
+	_dirtyViews = 0;
+	if( nullptr == _atlas.getTarget() ) {
+		return;
+	}
+
+	buildViews(lights);
+
+	float splits[MAX_CASCADES];
+	computeSplits(camera.nearPlane, camera.farPlane, splits);
+
+	for( auto& view : _views ) {
+		Light& light = lights[view.light];
+		if( Light::Type::Directional == light.type() ) {
+			const float sliceNear = (0 == view.cascade) ? camera.nearPlane : splits[view.cascade - 1];
+			const float sliceFar = splits[view.cascade];
+			const ciri::BoundingFrustum slice(camera.fov, camera.aspect, sliceNear, sliceFar, camera.position, camera.position + camera.front, camera.up);
+			view.viewProj = light.computeCascadeViewProj(slice.corners(), _atlas.getTileSize(), _casterDistance);
+		} else {
+			view.viewProj = light.proj() * light.view();
+		}
+		view.atlasViewProj = _atlas.toAtlas(view.tile, view.viewProj);
+
+		// only casters in this map's own volume; far cascades are large, near ones are not
+		_culler.setFrustum(ciri::BoundingFrustum(view.viewProj));
+		_culler.cull(bounds, view.casters);
+
+		view.dirty = !_caching || !isUnchanged(view, worlds);
+		if( view.dirty ) {
+			view.drawn = true;
+			view.drawnViewProj = view.viewProj;
+			view.drawnCasters = view.casters;
+			view.drawnWorlds.clear();
+			for( const int idx : view.casters ) {
+				view.drawnWorlds.push_back(worlds[idx]);
+			}
+			_dirtyViews += 1;
+			_stats.drawnViews += 1;
+			_stats.casterDraws += static_cast<int>(view.casters.size());
+		}
+	}
+
+	_stats.frames += 1;
+	_stats.views += static_cast<int>(_views.size());
+	_stats.setupNanoseconds += ciri::Profiler::now() - start;
+}
+
+const std::vector<ShadowMapper::View>& ShadowMapper::getViews() const {
+	return _views;
+}
+
+int ShadowMapper::getFirstView( int light ) const {
+	return (light >= 0 && light < static_cast<int>(_firstView.size())) ? _firstView[light] : -1;
+}
+
+int ShadowMapper::getViewCount( int light ) const {
+	return (light >= 0 && light < static_cast<int>(_viewCount.size())) ? _viewCount[light] : 0;
+}
+
+bool ShadowMapper::needsDraw() const {
+	return _dirtyViews > 0;
+}
+
+bool ShadowMapper::needsFullDraw() const {
+	return !_views.empty() && _dirtyViews == static_cast<int>(_views.size());
+}
+
+const ShadowAtlas& ShadowMapper::getAtlas() const {
+	return _atlas;
+}
+
+const ShadowMapper::Stats& ShadowMapper::getStats() const {
+	return _stats;
+}
+
+void ShadowMapper::buildViews( const std::vector<Light>& lights ) {
+	// views and their tiles only change with the lights, so what the tiles hold survives from frame to frame
+	std::vector<int> layout;
+	for( const auto& light : lights ) {
+		layout.push_back((static_cast<int>(light.type()) << 1) | (light.castShadows() ? 1 : 0));
+	}
+	if( layout == _layout ) {
+		return;
+	}
+	_layout = layout;
+
+	_views.clear();
+	_firstView.assign(lights.size(), -1);
+	_viewCount.assign(lights.size(), 0);
+	_atlas.releaseAll();
+	for( unsigned int i = 0; i < lights.size(); ++i ) {
+		const Light& light = lights[i];
+		if( !light.castShadows() || Light::Type::Point == light.type() ) {
+			continue; // todo: point lights need six maps
+		}
+		const int count = (Light::Type::Directional == light.type()) ? _cascadeCount : 1;
+		if( _atlas.getAllocatedCount() + count > _atlas.getCapacity() ) {
+			break;
+		}
+		_firstView[i] = static_cast<int>(_views.size());
+		_viewCount[i] = count;
+		for( int c = 0; c < count; ++c ) {
+			View view;
+			view.light = static_cast<int>(i);
+			view.cascade = c;
+			view.tile = _atlas.allocate();
+			view.rect = _atlas.getRect(view.tile);
+			view.dirty = true;
+			view.drawn = false;
+			_views.push_back(view);
+		}
+	}
+}
+
+void ShadowMapper::computeSplits( float nearPlane, float farPlane, float* outSplits ) const {
+	// practical split scheme: a blend of logarithmic splits, which match perspective texel density, and even ones, which keep near cascades from being tiny
+	for( int i = 0; i < _cascadeCount; ++i ) {
+		const float f = static_cast<float>(i + 1) / static_cast<float>(_cascadeCount);
+		const float logSplit = nearPlane * powf(farPlane / nearPlane, f);
+		const float evenSplit = nearPlane + (farPlane - nearPlane) * f;
+		outSplits[i] = _splitLambda * logSplit + (1.0f - _splitLambda) * evenSplit;
+	}
+}
+
+bool ShadowMapper::isUnchanged( const View& view, const std::vector<cc::Mat4f>& worlds ) const {
+	if( !view.drawn || view.casters != view.drawnCasters ) {
+		return false;
+	}
+	// exact compares; snapping is what keeps a cascade's matrix identical while the camera moves within a texel
+	if( memcmp(&view.viewProj, &view.drawnViewProj, sizeof(cc::Mat4f)) != 0 ) {
+		return false;
+	}
+	for( unsigned int i = 0; i < view.casters.size(); ++i ) {
+		if( memcmp(&worlds[view.casters[i]], &view.drawnWorlds[i], sizeof(cc::Mat4f)) != 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
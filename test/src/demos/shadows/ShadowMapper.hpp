@@ -0,0 +1,145 @@
+#ifndef __ShadowsDemo_ShadowMapper__
+#define __ShadowsDemo_ShadowMapper__
+
+#include <vector>
+#include <cc/Vec3.hpp>
+#include <cc/Vec4.hpp>
+#include <cc/Mat4.hpp>
+#include <ciri/Graphics.hpp>
+#include "Light.hpp"
+#include "ShadowAtlas.hpp"
+
+/**
+ * Plans each frame's shadow maps.  Directional lights get cascades that split the view volume from near to far, spot lights get one map,
+ * and every map is a tile of one ShadowAtlas.  Each map keeps only the casters inside its own light-space volume, and remembers the matrix
+ * and caster transforms it was last drawn with so that maps of a still scene stay in the atlas instead of being drawn again.
+ */
+class ShadowMapper {
+public:
+	static const int MAX_CASCADES = 4; /**< Matches the directional light shader. */
+
+	struct CameraInfo {
+		float fov; /**< Vertical field of view in degrees. */
+		float aspect;
+		float nearPlane;
+		float farPlane;
+		cc::Vec3f position;
+		cc::Vec3f front;
+		cc::Vec3f up;
+	};
+
+	struct View {
+		int light;
+		int cascade;              /**< Cascade of a directional light; 0 for spot lights. */
+		int tile;
+		cc::Mat4f viewProj;       /**< Renders the map through the tile's viewport. */
+		cc::Mat4f atlasViewProj;  /**< Takes world space to the tile's part of the atlas, for sampling. */
+		cc::Vec4f rect;           /**< Texture coordinates of the tile. */
+		std::vector<int> casters; /**< Indices of the bounds inside the map's volume. */
+		bool dirty;               /**< The map must be drawn this frame. */
+
+		// what the tile holds
+		bool drawn;
+		cc::Mat4f drawnViewProj;
+		std::vector<int> drawnCasters;
+		std::vector<cc::Mat4f> drawnWorlds;
+	};
+
+	/**
+	 * Totals since the mapper was created.
+	 */
+	struct Stats {
+		int frames;
+		long long setupNanoseconds; /**< Time spent in update. */
+		int views;                  /**< Maps planned, drawn or not. */
+		int drawnViews;             /**< Maps that had to be drawn. */
+		int casterDraws;            /**< Casters drawn into maps. */
+
+		Stats();
+	};
+
+public:
+	ShadowMapper();
+	~ShadowMapper();
+
+	/**
+	 * @param device       Device to create the atlas with.
+	 * @param atlasSize    Texels along each side of the atlas.
+	 * @param tileSize     Texels along each side of each map.
+	 * @param cascadeCount Cascades per directional light, up to MAX_CASCADES.
+	 */
+	bool create( const std::shared_ptr<ciri::IGraphicsDevice>& device, int atlasSize, int tileSize, int cascadeCount );
+	void destroy();
+
+	/**
+	 * Sets how cascades are split, from 0 for even splits to 1 for logarithmic ones.
+	 */
+	void setSplitLambda( float lambda );
+
+	/**
+	 * Sets how far toward a directional light, past a cascade's volume, casters are still caught.
+	 */
+	void setCasterDistance( float distance );
+
+	/**
+	 * Enables or disables keeping maps whose matrix and casters have not changed.  Disabled, every map is drawn every frame.
+	 */
+	void setCaching( bool enabled );
+
+	/**
+	 * Forgets what every tile holds, so that every map is drawn next frame.
+	 */
+	void invalidate();
+
+	/**
+	 * Plans the maps of a frame.  Lights that cast shadows get views in order; if the atlas fills, the remaining lights get none.
+	 * @param lights Lights of the scene.
+	 * @param camera Camera the cascades split.
+	 * @param bounds World bounds of every caster.
+	 * @param worlds World matrix of every caster, parallel to bounds.
+	 */
+	void update( std::vector<Light>& lights, const CameraInfo& camera, const ciri::BoundingBoxArray& bounds, const std::vector<cc::Mat4f>& worlds );
+
+	const std::vector<View>& getViews() const;
+
+	/**
+	 * Gets the views of a light, which are consecutive.
+	 * @returns Index of the light's first view, or -1 if it has none.
+	 */
+	int getFirstView( int light ) const;
+	int getViewCount( int light ) const;
+
+	/**
+	 * Gets whether any view is dirty this frame.
+	 */
+	bool needsDraw() const;
+
+	/**
+	 * Gets whether every view is dirty this frame, in which case the whole atlas can be cleared at once.
+	 */
+	bool needsFullDraw() const;
+
+	const ShadowAtlas& getAtlas() const;
+	const Stats& getStats() const;
+
+private:
+	void buildViews( const std::vector<Light>& lights );
+	void computeSplits( float nearPlane, float farPlane, float* outSplits ) const;
+	bool isUnchanged( const View& view, const std::vector<cc::Mat4f>& worlds ) const;
+
+private:
+	ShadowAtlas _atlas;
+	int _cascadeCount;
+	float _splitLambda;
+	float _casterDistance;
+	bool _caching;
+	std::vector<View> _views;
+	std::vector<int> _firstView; /**< Per light. */
+	std::vector<int> _viewCount; /**< Per light. */
+	std::vector<int> _layout;    /**< Type and shadow flag of each light the views were built for; a change rebuilds them. */
+	ciri::FrustumCuller _culler;
+	int _dirtyViews;
+	Stats _stats;
+};
+
+#endif
\ No newline at end of file
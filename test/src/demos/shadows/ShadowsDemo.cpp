@@ -1,10 +1,9 @@
 #include "ShadowsDemo.hpp"
 #include <cc/MatrixFunc.hpp>
-#include "BoundingFrustum.hpp"
-#include "BoundingBox.hpp"
+#include <cc/Random.hpp>
 
-ShadowsDemo::ShadowsDemo()
-	: App(), _animateObjects(true) {
+ShadowsDemo::ShadowsDemo( bool cacheShadows, int extraLights )
+	: App(), _cameraLight(nullptr), _lightFollowCamera(false), _captureShadow(false), _animateObjects(true), _cacheShadows(cacheShadows), _extraLights(extraLights) {
 }
 
 ShadowsDemo::~ShadowsDemo() {
@@ -24,24 +23,40 @@ void ShadowsDemo::onInitialize() {
 void ShadowsDemo::onLoadContent() {
 	App::onLoadContent();
 
-	// load shaders
+	// load shaders and the pipelines that use them
 	loadShaders();
+	createPipelines();
 
-	// load states
-	ciri::RasterizerDesc rasterDesc;
-	rasterDesc.cullMode = ciri::CullMode::Clockwise;
-	//rasterDesc.fillMode = ciri::FillMode::Wireframe;
-	_rasterState = graphicsDevice()->createRasterizerState(rasterDesc);
-	_additiveBlendState = graphicsDevice()->getDefaultBlendAdditive();
-
-	// create shadow map stuff
-	_shadowTarget = graphicsDevice()->createRenderTarget2D(2048, 2048, ciri::TextureFormat::RGBA32_Float, ciri::DepthStencilFormat::Depth24);
+	// create shadow map stuff; every map is a 2048 tile of one atlas, which fits three cascades and a spotlight
+	_graph.create(graphicsDevice());
+	if( !_shadows.create(graphicsDevice(), 4096, 2048, 3) ) {
+		printf("Failed to create shadow atlas.\n");
+	}
+	_shadows.setCaching(_cacheShadows);
+	const Vertex clearVertices[3] = {
+		Vertex(cc::Vec3f(-1.0f, -1.0f, 1.0f), cc::Vec3f(0.0f, 0.0f, 1.0f), cc::Vec2f(0.0f, 0.0f)),
+		Vertex(cc::Vec3f( 3.0f, -1.0f, 1.0f), cc::Vec3f(0.0f, 0.0f, 1.0f), cc::Vec2f(2.0f, 0.0f)),
+		Vertex(cc::Vec3f(-1.0f,  3.0f, 1.0f), cc::Vec3f(0.0f, 0.0f, 1.0f), cc::Vec2f(0.0f, 2.0f))
+	};
+	_clearTriangle = graphicsDevice()->createVertexBuffer();
+	if( ciri::failed(_clearTriangle->set((void*)clearVertices, sizeof(Vertex), 3, false)) ) {
+		printf("Failed to create shadow clear triangle.\n");
+	}
 	ciri::SamplerDesc shadowSamplerDesc;
 	shadowSamplerDesc.filter = ciri::SamplerFilter::Point;
 	shadowSamplerDesc.wrapU=shadowSamplerDesc.wrapV=shadowSamplerDesc.wrapW = ciri::SamplerWrap::Border;
 	shadowSamplerDesc.borderColor[0]=shadowSamplerDesc.borderColor[1]=shadowSamplerDesc.borderColor[2]=shadowSamplerDesc.borderColor[3] = 1.0f;
 	_shadowSampler = graphicsDevice()->createSamplerState(shadowSamplerDesc);
 
+	// lights without shadows are binned into clusters and shaded together; the cluster textures are only ever fetched from
+	_clusters.create(16, 9, 24);
+	_clusters.setJobSystem(jobSystem());
+	ciri::SamplerDesc clusterSamplerDesc;
+	clusterSamplerDesc.filter = ciri::SamplerFilter::Point;
+	clusterSamplerDesc.wrapU=clusterSamplerDesc.wrapV=clusterSamplerDesc.wrapW = ciri::SamplerWrap::Clamp;
+	clusterSamplerDesc.useMipmaps = false;
+	_clusterSampler = graphicsDevice()->createSamplerState(clusterSamplerDesc);
+
 	// load some models
 	_ground = std::make_shared<Model>();
 	_ground->addFromObj("data/demos/shadows/ground.obj");
@@ -60,7 +75,20 @@ void ShadowsDemo::onLoadContent() {
 	_helicopterTail->build(graphicsDevice());
 	if(_helicopterTail->isValid()){_models.push_back(_helicopterTail);}
 
-	// add some lights
+	// local bounds of each model; transformed into world space every frame for culling
+	std::vector<cc::Vec3f> positions;
+	for( auto& mdl : _models ) {
+		positions.clear();
+		for( const auto& vtx : mdl->getVertices() ) {
+			positions.push_back(vtx.position);
+		}
+		_modelBounds.push_back(ciri::BoundingBox::createFromPoints(positions));
+	}
+	_worldBounds.reserve(static_cast<int>(_models.size()));
+	_worlds.resize(_models.size());
+
+	// add some lights; the camera light points into the vector, so it must not grow afterward
+	_lights.reserve(2 + _extraLights);
 	Light light0(Light::Type::Directional);
 	light0.setDirection(cc::Vec3f(0.75f, -0.8f, 0.72f));
 	light0.setCastShadows(true);
@@ -72,8 +100,16 @@ void ShadowsDemo::onLoadContent() {
 	light1.setConeOuterAngle(12.0f);
 	light1.setCastShadows(true);
 	light1.setDiffuseIntensity(1.0f);//0.25f);
-	//_lights.push_back(light1);
+	_lights.push_back(light1);
 	_cameraLight = &_lights.back();
+	for( int i = 0; i < _extraLights; ++i ) {
+		Light extra(Light::Type::Point);
+		extra.setPosition(cc::Vec3f(cc::math::Random<float, int>::rangedReal(-60.0f, 60.0f), cc::math::Random<float, int>::rangedReal(1.0f, 6.0f), cc::math::Random<float, int>::rangedReal(-60.0f, 60.0f)));
+		extra.setRange(cc::math::Random<float, int>::rangedReal(6.0f, 14.0f));
+		extra.setDiffuseColor(cc::Vec3f(cc::math::Random<float, int>::rangedReal(0.2f, 1.0f), cc::math::Random<float, int>::rangedReal(0.2f, 1.0f), cc::math::Random<float, int>::rangedReal(0.2f, 1.0f)));
+		extra.setDiffuseIntensity(0.5f);
+		_lights.push_back(extra);
+	}
 }
 
 void ShadowsDemo::onEvent(const ciri::WindowEvent& evt) {
@@ -91,8 +127,10 @@ void ShadowsDemo::onUpdate(const double deltaTime, const double elapsedTime) {
 		_spotlightShader->destroy();
 		_directionalShader->destroy();
 		_depthShader->destroy();
+		_clusteredShader->destroy();
 		printf("Reloading shaders...");
 		loadShaders();
+		createPipelines();
 		printf("done\n");
 	}
 
@@ -135,10 +173,19 @@ void ShadowsDemo::onUpdate(const double deltaTime, const double elapsedTime) {
 		_cameraLight->setDirection(_camera.getFpsFront());
 	}
 
-	if( input()->isKeyDown(ciri::Key::F11) && input()->wasKeyUp(ciri::Key::F11) ) {
-		printf("Writing textures...");
-		_shadowTarget->getDepth()->writeToTGA("C:\\Users\\daniel\\Desktop\\test.tga");
-		printf("done!\n");
+	// the readback resolves a frame or two later, so the capture never stalls the frame
+	if( input()->isKeyDown(ciri::Key::F11) && input()->wasKeyUp(ciri::Key::F11) && !_capture.valid() ) {
+		printf("Reading shadow depth...\n");
+		_captureShadow = true; // read after the next frame's passes
+	}
+	if( _capture.valid() && std::future_status::ready == _capture.wait_for(std::chrono::seconds(0)) ) {
+		const ciri::TextureReadback capture = _capture.get();
+		const ciri::ErrorCode result = capture.writeToTGA("C:\\Users\\daniel\\Desktop\\test.tga");
+		if( ciri::failed(result) ) {
+			printf("Failed to write shadow depth: %s\n", ciri::getErrorString(result));
+		} else {
+			printf("Wrote shadow depth (%dx%d)\n", capture.width, capture.height);
+		}
 	}
 }
 
@@ -151,137 +198,332 @@ void ShadowsDemo::onDraw() {
 
 	const auto device = graphicsDevice();
 
-	device->setClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-	device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
-
-	device->setRasterizerState(_rasterState);
-	device->restoreDefaultBlendState();
-
-	if( _spotlightShader->isValid() && _directionalShader->isValid() ) {
-		const cc::Mat4f& cameraViewProj = _camera.getProj() * _camera.getView();
+	_graph.reset();
+	const int backbuffer = _graph.importTarget("backbuffer", nullptr);
+	const int clearPass = _graph.addPass("clear", [&device]( const ciri::RenderGraph& ) {
+		device->setClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
+	});
+	_graph.write(clearPass, backbuffer);
+
+	// passes run after this block, so everything they refer to lives out here
+	const cc::Mat4f cameraViewProj = _camera.getProj() * _camera.getView();
+	Light::Type boundLightType = Light::Type::Invalid;
+
+	if( _spotlightShader->isValid() && _directionalShader->isValid() && _depthPipeline != nullptr && _shadows.getAtlas().getTarget() != nullptr ) {
+		// world bounds are shared by the camera and every shadow map
+		_worldBounds.clear();
+		for( size_t i = 0; i < _models.size(); ++i ) {
+			_worlds[i] = _models[i]->getXform().getWorld();
+			_worldBounds.add(_modelBounds[i].transformed(_worlds[i]));
+		}
+		_cameraCuller.setFrustum(ciri::BoundingFrustum(cameraViewProj));
+		_cameraCuller.cull(_worldBounds, _cameraVisible);
+
+		ShadowMapper::CameraInfo cameraInfo;
+		cameraInfo.fov = _camera.getFov();
+		cameraInfo.aspect = _camera.getAspect();
+		cameraInfo.nearPlane = _camera.getNearPlane();
+		cameraInfo.farPlane = _camera.getFarPlane();
+		cameraInfo.position = _camera.getPosition();
+		cameraInfo.front = _camera.getFpsFront();
+		cameraInfo.up = _camera.getUp();
+		_shadows.update(_lights, cameraInfo, _worldBounds, _worlds);
+
+		// the atlas outlives the frame, since maps that did not change are kept in it; with nothing to draw it is not even bound
+		const int atlas = _graph.importTarget("shadow atlas", _shadows.getAtlas().getTarget());
+		if( _shadows.needsDraw() ) {
+			const int shadowPass = _graph.addPass("shadows", [this]( const ciri::RenderGraph& ) {
+				drawShadowMaps();
+			});
+			_graph.write(shadowPass, atlas);
+		}
 
 		bool firstLight = true;
-		Light::Type boundLightType = Light::Type::Invalid;
-		for( auto& light : _lights ) {
-			// compute light matrices
-			//const cc::Mat4f& lightView = light.view();
-			//const cc::Mat4f& lightProj = light.proj();//cc::math::perspectiveRH(45.0f, 1.0f, 0.1f, light.range());//light.proj();
-			//const cc::Mat4f lightViewProj = lightProj * lightView;
-			if( light.type() == Light::Type::Directional ) {
-				//light.computeViewProjFromFrustum(BoundingFrustum(cameraViewProj));
-				light.computeViewProjFromFrustum(BoundingFrustum(_camera.getFov(), _camera.getAspect(), _camera.getNearPlane(), _camera.getFarPlane(), _camera.getPosition(), _camera.getFpsFront(), _camera.getUp()));
-				//light.computeViewProjOrtho(_camera.getView(), _camera.getFov(), _camera.getAspect(), _camera.getNearPlane(), _camera.getFarPlane());
+		for( size_t lightIndex = 0; lightIndex < _lights.size(); ++lightIndex ) {
+			if( isClustered(_lights[lightIndex]) ) {
+				continue;
 			}
-			const cc::Mat4f lightViewProj = light.proj() * light.view();
-
-			if( light.castShadows() ) {
-				device->setDepthStencilState(device->getDefaultDepthStencilDefault());
-				// set and clear render target
-				ciri::IRenderTarget2D* depthTarget = _shadowTarget.get();
-				device->setRenderTargets(&depthTarget, 1);
-				device->setClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-				device->clear(ciri::ClearFlags::Color | ciri::ClearFlags::Depth);
-				// apply depth shader
-				device->applyShader(_depthShader);
-				// set viewport to depth size
-				device->setViewport(ciri::Viewport(0, 0, _shadowTarget->getDepth()->getWidth(), _shadowTarget->getDepth()->getHeight()));
-				// render all models
-				for( auto& mdl : _models ) {
-					_depthConstants.xform = lightViewProj * mdl->getXform().getWorld();
-					_depthConstantsBuffer->setData(sizeof(DepthConstants), &_depthConstants);
-					device->setVertexBuffer(mdl->getVertexBuffer());
-					if( mdl->getIndexBuffer() != nullptr ) {
-						device->setIndexBuffer(mdl->getIndexBuffer());
-						device->drawIndexed(ciri::PrimitiveTopology::TriangleList, mdl->getIndexBuffer()->getIndexCount());
-					} else {
-						device->drawArrays(ciri::PrimitiveTopology::TriangleList, mdl->getVertexBuffer()->getVertexCount(), 0);
-					}
-				}
-
-				// reser viewport to screen
-				device->setViewport(ciri::Viewport(0, 0, window()->getWidth(), window()->getHeight()));
-				// restore default render targets
-				device->restoreDefaultRenderTargets();
-			}
-			switch( light.type() ) {
-				case Light::Type::Directional: {
-					if( boundLightType != Light::Type::Directional || light.castShadows() ) {
-						boundLightType = Light::Type::Directional;
-						device->applyShader(_directionalShader);
-						device->setTexture2D(0, _shadowTarget->getDepth(), ciri::ShaderStage::Pixel);
-						device->setSamplerState(0, _shadowSampler, ciri::ShaderStage::Pixel);
-					}
-					_directionalConstants.LightDirection = light.direction();
-					_directionalConstants.LightColor = light.diffuseColor();
-					_directionalConstants.LightIntensity = light.diffuseIntensity();
-					_directionalConstants.campos = _camera.getPosition();
-					_directionalConstants.CastShadows = light.castShadows();
-					_directionalConstants.lightViewProj = lightViewProj;
-					for( auto& mdl : _models ) {
-						if( !mdl->isValid() ) {
-							continue;
+			const int firstView = _shadows.getFirstView(static_cast<int>(lightIndex));
+			const int lightPass = _graph.addPass("light", [&, lightIndex, firstView, firstLight]( const ciri::RenderGraph& ) {
+				const Light& light = _lights[lightIndex];
+				const bool castShadows = light.castShadows() && (firstView != -1);
+				const std::vector<ShadowMapper::View>& views = _shadows.getViews();
+				switch( light.type() ) {
+					case Light::Type::Directional: {
+						device->applyPipelineState(firstLight ? _directionalPipeline : _directionalAdditivePipeline);
+						if( boundLightType != Light::Type::Directional ) {
+							boundLightType = Light::Type::Directional;
+							device->setTexture2D(0, _shadows.getAtlas().getTarget()->getDepth(), ciri::ShaderStage::Pixel);
+							device->setSamplerState(0, _shadowSampler, ciri::ShaderStage::Pixel);
 						}
-						_directionalConstants.world = mdl->getXform().getWorld();
-						_directionalConstants.xform = cameraViewProj * _directionalConstants.world;
-						_directionalConstantsBuffer->setData(sizeof(DirectionalConstants), &_directionalConstants);
-						device->setVertexBuffer(mdl->getVertexBuffer());
-						if( mdl->getIndexBuffer() != nullptr ) {
-							device->setIndexBuffer(mdl->getIndexBuffer());
-							device->drawIndexed(ciri::PrimitiveTopology::TriangleList, mdl->getIndexBuffer()->getIndexCount());
-						} else {
-							device->drawArrays(ciri::PrimitiveTopology::TriangleList, mdl->getVertexBuffer()->getVertexCount(), 0);
+						_directionalConstants.LightDirection = light.direction();
+						_directionalConstants.LightColor = light.diffuseColor();
+						_directionalConstants.LightIntensity = light.diffuseIntensity();
+						_directionalConstants.campos = _camera.getPosition();
+						_directionalConstants.CastShadows = castShadows;
+						_directionalConstants.CascadeCount = castShadows ? _shadows.getViewCount(static_cast<int>(lightIndex)) : 0;
+						for( int c = 0; c < _directionalConstants.CascadeCount; ++c ) {
+							_directionalConstants.cascadeViewProj[c] = views[firstView + c].atlasViewProj;
+							_directionalConstants.cascadeRects[c] = views[firstView + c].rect;
 						}
+						for( const int idx : _cameraVisible ) {
+							const auto& mdl = _models[idx];
+							if( !mdl->isValid() ) {
+								continue;
+							}
+							_directionalConstants.world = _worlds[idx];
+							_directionalConstants.xform = cameraViewProj * _directionalConstants.world;
+							_directionalConstantsBuffer->setData(sizeof(DirectionalConstants), &_directionalConstants);
+							drawModel(*mdl);
+						}
+						break;
 					}
-					break;
-				}
-				case Light::Type::Spot: {
-					if( boundLightType != Light::Type::Spot || light.castShadows() ) {
-						boundLightType = Light::Type::Spot;
-						device->applyShader(_spotlightShader);
-						device->setTexture2D(0, _shadowTarget->getDepth(), ciri::ShaderStage::Pixel);
-						device->setSamplerState(0, _shadowSampler, ciri::ShaderStage::Pixel);
-					}
-					_spotlightConstants.LightPosition = light.position();
-					_spotlightConstants.LightDirection = light.direction();
-					_spotlightConstants.LightColor = light.diffuseColor();
-					_spotlightConstants.LightCosInner = light.cosConeInnerAngle(true);
-					_spotlightConstants.LightCosOuter = light.cosConeOuterAngle(true);
-					_spotlightConstants.LightIntensity = light.diffuseIntensity();
-					_spotlightConstants.LightRange = light.range();
-					_spotlightConstants.CastShadows = light.castShadows();
-					_spotlightConstants.lightViewProj = lightViewProj;
-					for( auto& mdl : _models ) {
-						_spotlightConstants.world = mdl->getXform().getWorld();
-						_spotlightConstants.xform = cameraViewProj * _spotlightConstants.world;
-						_spotlightConstantsBuffer->setData(sizeof(SpotlightConstants), &_spotlightConstants);
-						device->setVertexBuffer(mdl->getVertexBuffer());
-						if( mdl->getIndexBuffer() != nullptr ) {
-							device->setIndexBuffer(mdl->getIndexBuffer());
-							device->drawIndexed(ciri::PrimitiveTopology::TriangleList, mdl->getIndexBuffer()->getIndexCount());
-						} else {
-							device->drawArrays(ciri::PrimitiveTopology::TriangleList, mdl->getVertexBuffer()->getVertexCount(), 0);
+					case Light::Type::Spot: {
+						device->applyPipelineState(firstLight ? _spotlightPipeline : _spotlightAdditivePipeline);
+						if( boundLightType != Light::Type::Spot ) {
+							boundLightType = Light::Type::Spot;
+							device->setTexture2D(0, _shadows.getAtlas().getTarget()->getDepth(), ciri::ShaderStage::Pixel);
+							device->setSamplerState(0, _shadowSampler, ciri::ShaderStage::Pixel);
 						}
+						_spotlightConstants.LightPosition = light.position();
+						_spotlightConstants.LightDirection = light.direction();
+						_spotlightConstants.LightColor = light.diffuseColor();
+						_spotlightConstants.LightCosInner = light.cosConeInnerAngle(true);
+						_spotlightConstants.LightCosOuter = light.cosConeOuterAngle(true);
+						_spotlightConstants.LightIntensity = light.diffuseIntensity();
+						_spotlightConstants.LightRange = light.range();
+						_spotlightConstants.CastShadows = castShadows;
+						if( castShadows ) {
+							_spotlightConstants.lightViewProj = views[firstView].atlasViewProj;
+							_spotlightConstants.ShadowRect = views[firstView].rect;
+						}
+						for( const int idx : _cameraVisible ) {
+							const auto& mdl = _models[idx];
+							_spotlightConstants.world = _worlds[idx];
+							_spotlightConstants.xform = cameraViewProj * _spotlightConstants.world;
+							_spotlightConstantsBuffer->setData(sizeof(SpotlightConstants), &_spotlightConstants);
+							drawModel(*mdl);
+						}
+						break;
+					}
+					default: {
+						break;
 					}
-					break;
 				}
+			});
+			if( firstView != -1 ) {
+				_graph.read(lightPass, atlas);
 			}
+			_graph.write(lightPass, backbuffer);
 
-			if( firstLight ) {
-				firstLight = false;
-				device->setBlendState(_additiveBlendState);
-			}
+			firstLight = false;
+		}
+
+		// every other light in one pass; it adds onto whatever the shadowed lights drew, or onto the clear color without any
+		updateClusters();
+		if( _clusteredShader->isValid() && _clusteredPipeline != nullptr && !_clusteredLights.empty() ) {
+			const int clusteredPass = _graph.addPass("clustered lights", [&]( const ciri::RenderGraph& ) {
+				CIRI_PROFILE_GPU(device.get(), "Clustered lights");
+				device->applyPipelineState(_clusteredPipeline);
+				device->setTexture2D(0, _clusters.getGridTexture(), ciri::ShaderStage::Pixel);
+				device->setTexture2D(1, _clusters.getIndexTexture(), ciri::ShaderStage::Pixel);
+				device->setTexture2D(2, _clusteredLightTexture, ciri::ShaderStage::Pixel);
+				for( int slot = 0; slot < 3; ++slot ) {
+					device->setSamplerState(slot, _clusterSampler, ciri::ShaderStage::Pixel);
+				}
+				boundLightType = Light::Type::Invalid; // slot 0 no longer holds the atlas
+
+				_clusteredConstants.campos = _camera.getPosition();
+				_clusteredConstants.CameraFront = _camera.getFpsFront();
+				_clusteredConstants.SliceScale = _clusters.getSliceScale();
+				_clusteredConstants.SliceBias = _clusters.getSliceBias();
+				_clusteredConstants.TileScale = cc::Vec2f(static_cast<float>(_clusters.getTilesX()) / static_cast<float>(window()->getWidth()), static_cast<float>(_clusters.getTilesY()) / static_cast<float>(window()->getHeight()));
+				_clusteredConstants.TilesX = _clusters.getTilesX();
+				_clusteredConstants.TilesY = _clusters.getTilesY();
+				_clusteredConstants.Slices = _clusters.getSlices();
+				for( const int idx : _cameraVisible ) {
+					_clusteredConstants.world = _worlds[idx];
+					_clusteredConstants.xform = cameraViewProj * _clusteredConstants.world;
+					_clusteredConstantsBuffer->setData(sizeof(ClusteredConstants), &_clusteredConstants);
+					drawModel(*_models[idx]);
+				}
+			});
+			_graph.write(clusteredPass, backbuffer);
+		}
+	}
+
+	// the passes only run here, so this is where the scene's gpu time goes
+	{
+		CIRI_PROFILE_GPU(device.get(), "Scene");
+		if( ciri::success(_graph.compile()) ) {
+			_graph.execute();
 		}
 	}
 
+	// the readback resolves a frame or two later, so the capture never stalls the frame
+	if( _captureShadow && _shadows.getAtlas().getTarget() != nullptr ) {
+		_captureShadow = false;
+		_capture = _shadows.getAtlas().getTarget()->getDepth()->readAsync();
+	}
+
 	device->present();
 }
 
 void ShadowsDemo::onUnloadContent() {
 	App::onUnloadContent();
+
+	_graph.destroy();
+	_shadows.destroy();
+	_clusters.destroy();
+}
+
+const ShadowMapper::Stats& ShadowsDemo::getShadowStats() const {
+	return _shadows.getStats();
+}
+
+void ShadowsDemo::setAnimateObjects( bool animate ) {
+	_animateObjects = animate;
+}
+
+void ShadowsDemo::drawShadowMaps() {
+	CIRI_PROFILE_SCOPE("Shadow pass");
+	CIRI_PROFILE_GPU(graphicsDevice().get(), "Shadow pass");
+
+	const auto device = graphicsDevice();
+	const ShadowAtlas& atlas = _shadows.getAtlas();
+
+	// a clear covers the whole atlas whatever the viewport, so tiles being kept are cleared by drawing far depth over just the others
+	const bool clearAll = _shadows.needsFullDraw();
+	if( clearAll ) {
+		device->setClearDepth(1.0f);
+		device->clear(ciri::ClearFlags::Depth);
+	}
+
+	for( const auto& view : _shadows.getViews() ) {
+		if( !view.dirty ) {
+			continue;
+		}
+		device->setViewport(atlas.getViewport(view.tile));
+
+		if( !clearAll ) {
+			device->applyPipelineState(_depthClearPipeline);
+			_depthConstants.xform = cc::Mat4f(1.0f);
+			_depthConstantsBuffer->setData(sizeof(DepthConstants), &_depthConstants);
+			device->setVertexBuffer(_clearTriangle);
+			device->drawArrays(ciri::PrimitiveTopology::TriangleList, 3, 0);
+		}
+
+		device->applyPipelineState(_depthPipeline);
+		for( const int idx : view.casters ) {
+			_depthConstants.xform = view.viewProj * _worlds[idx];
+			_depthConstantsBuffer->setData(sizeof(DepthConstants), &_depthConstants);
+			drawModel(*_models[idx]);
+		}
+	}
+}
+
+void ShadowsDemo::updateClusters() {
+	CIRI_PROFILE_SCOPE("Light clusters");
+
+	_clusters.setProjection(_camera.getFov(), _camera.getAspect(), _camera.getNearPlane(), _camera.getFarPlane());
+	_clusters.clearLights();
+	_clusteredLights.clear();
+	for( size_t i = 0; i < _lights.size(); ++i ) {
+		const Light& light = _lights[i];
+		if( !isClustered(light) ) {
+			continue;
+		}
+		if( Light::Type::Spot == light.type() ) {
+			_clusters.addSpotLight(light.position(), light.direction(), light.range(), light.coneOuterAngle());
+		} else {
+			_clusters.addPointLight(light.position(), light.range());
+		}
+		_clusteredLights.push_back(static_cast<int>(i));
+	}
+	if( _clusteredLights.empty() ) {
+		return;
+	}
+	_clusters.build(_camera.getView());
+	if( ciri::failed(_clusters.upload(graphicsDevice())) ) {
+		_clusteredLights.clear();
+		return;
+	}
+
+	// light rows double like the index texture's, so the texture is only made again when the light count outgrows it
+	int rows = (_clusteredLightTexture != nullptr) ? _clusteredLightTexture->getHeight() : 1;
+	while( rows < static_cast<int>(_clusteredLights.size()) ) {
+		rows *= 2;
+	}
+	_clusteredLightData.assign(3 * 4 * rows, 0.0f);
+	for( size_t i = 0; i < _clusteredLights.size(); ++i ) {
+		const Light& light = _lights[_clusteredLights[i]];
+		const bool spot = Light::Type::Spot == light.type();
+		const cc::Vec3f color = light.diffuseColor() * light.diffuseIntensity();
+		float* texels = &_clusteredLightData[i * 12];
+		texels[0] = light.position().x; texels[1] = light.position().y; texels[2] = light.position().z; texels[3] = light.range();
+		texels[4] = color.x; texels[5] = color.y; texels[6] = color.z; texels[7] = spot ? light.cosConeInnerAngle(true) : -1.0f;
+		texels[8] = light.direction().x; texels[9] = light.direction().y; texels[10] = light.direction().z; texels[11] = spot ? light.cosConeOuterAngle(true) : -2.0f;
+	}
+	if( nullptr == _clusteredLightTexture || _clusteredLightTexture->getHeight() != rows ) {
+		_clusteredLightTexture = graphicsDevice()->createTexture2D(3, rows, ciri::TextureFormat::RGBA32_Float, 0, _clusteredLightData.data());
+	} else if( ciri::failed(_clusteredLightTexture->setData(0, 0, 3, rows, _clusteredLightData.data(), ciri::TextureFormat::RGBA32_Float)) ) {
+		_clusteredLightTexture = nullptr;
+	}
+	if( nullptr == _clusteredLightTexture ) {
+		_clusteredLights.clear();
+	}
+}
+
+bool ShadowsDemo::isClustered( const Light& light ) const {
+	// point lights have no shadows yet, so they always go through the clusters
+	return (Light::Type::Point == light.type()) || (Light::Type::Spot == light.type() && !light.castShadows());
+}
+
+void ShadowsDemo::drawModel( const Model& model ) {
+	const auto device = graphicsDevice();
+	device->setVertexBuffer(model.getVertexBuffer());
+	if( model.getIndexBuffer() != nullptr ) {
+		device->setIndexBuffer(model.getIndexBuffer());
+		device->drawIndexed(ciri::PrimitiveTopology::TriangleList, model.getIndexBuffer()->getIndexCount());
+	} else {
+		device->drawArrays(ciri::PrimitiveTopology::TriangleList, model.getVertexBuffer()->getVertexCount(), 0);
+	}
+}
+
+void ShadowsDemo::createPipelines() {
+	ciri::PipelineDesc desc;
+	desc.rasterizer.cullMode = ciri::CullMode::Clockwise;
+	//desc.rasterizer.fillMode = ciri::FillMode::Wireframe;
+
+	desc.shader = _depthShader;
+	_depthPipeline = graphicsDevice()->createPipelineState(desc);
+	ciri::PipelineDesc clearDesc = desc;
+	clearDesc.rasterizer.cullMode = ciri::CullMode::None;
+	clearDesc.depthStencil.depthFunc = ciri::CompareFunction::Always;
+	_depthClearPipeline = graphicsDevice()->createPipelineState(clearDesc);
+
+	desc.shader = _directionalShader;
+	_directionalPipeline = graphicsDevice()->createPipelineState(desc);
+	desc.shader = _spotlightShader;
+	_spotlightPipeline = graphicsDevice()->createPipelineState(desc);
+
+	// lights after the first add onto the scene
+	desc.blend.srcColorBlend = ciri::BlendMode::SourceAlpha;
+	desc.blend.srcAlphaBlend = ciri::BlendMode::SourceAlpha;
+	desc.blend.dstColorBlend = ciri::BlendMode::One;
+	desc.blend.dstAlphaBlend = ciri::BlendMode::One;
+	desc.shader = _directionalShader;
+	_directionalAdditivePipeline = graphicsDevice()->createPipelineState(desc);
+	desc.shader = _spotlightShader;
+	_spotlightAdditivePipeline = graphicsDevice()->createPipelineState(desc);
+	desc.shader = _clusteredShader;
+	_clusteredPipeline = graphicsDevice()->createPipelineState(desc);
 }
 
 void ShadowsDemo::loadShaders() {
-	const std::string shaderExt = graphicsDevice()->getShaderExt();
+	// only glsl sources ship with this demo; the null device just needs them to exist
+	const std::string shaderExt = ".glsl";
 
 	//
 	// spotlight
@@ -363,4 +605,31 @@ void ShadowsDemo::loadShaders() {
 			printf("Failed to assign depth constants.\n");
 		}
 	}
+
+	//
+	// clustered
+	//
+	if( nullptr == _clusteredShader ) {
+		_clusteredShader = graphicsDevice()->createShader();
+		_clusteredShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
+		_clusteredShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Normal, 0));
+		_clusteredShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float4, ciri::VertexUsage::Tangent, 0));
+		_clusteredShader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float2, ciri::VertexUsage::Texcoord, 0));
+	}
+	const std::string clusteredVS = "data/demos/shadows/clustered_vs" + shaderExt;
+	const std::string clusteredPS = "data/demos/shadows/clustered_ps" + shaderExt;
+	if( ciri::failed(_clusteredShader->loadFromFile(clusteredVS.c_str(), nullptr, clusteredPS.c_str())) ) {
+		printf("Failed to load clustered light shader:\n");
+		std::for_each(_clusteredShader->getErrors().begin(), _clusteredShader->getErrors().end(), [](auto err){printf("%s\n", err.msg.c_str());});
+	}
+	if( nullptr == _clusteredConstantsBuffer ) {
+		_clusteredConstantsBuffer = graphicsDevice()->createConstantBuffer();
+	}
+	if( ciri::failed(_clusteredConstantsBuffer->setData(sizeof(ClusteredConstants), &_clusteredConstants)) ) {
+		printf("Failed to set clustered light constants.\n");
+	} else {
+		if( ciri::failed(_clusteredShader->addConstants(_clusteredConstantsBuffer, "ClusteredConstants", ciri::ShaderStage::Vertex)) ) {
+			printf("Failed to assign clustered light constants.\n");
+		}
+	}
 }
\ No newline at end of file
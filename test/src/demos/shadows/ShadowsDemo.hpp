@@ -5,9 +5,9 @@
 #include <ciri/Game.hpp>
 #include "../../common/Model.hpp"
 #include "Light.hpp"
+#include "ShadowMapper.hpp"
 
-__declspec(align(16))
-struct SpotlightConstants {
+struct alignas(16) SpotlightConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	cc::Vec3f campos;
@@ -18,12 +18,13 @@ struct SpotlightConstants {
 	float LightIntensity;
 	cc::Vec3f LightColor;
 	float LightRange;
-	cc::Mat4f lightViewProj;
+	cc::Mat4f lightViewProj; /**< World to atlas space. */
 	int CastShadows;
+	int pad0[3];
+	cc::Vec4f ShadowRect;    /**< Atlas coordinates of the light's map, as min x, min y, max x, max y. */
 };
 
-__declspec(align(16))
-struct DirectionalConstants {
+struct alignas(16) DirectionalConstants {
 	cc::Mat4f world;
 	cc::Mat4f xform;
 	cc::Vec3f campos;
@@ -32,17 +33,35 @@ struct DirectionalConstants {
 	int CastShadows;
 	cc::Vec3f LightColor;
 	float pad0;
-	cc::Mat4f lightViewProj;
+	cc::Mat4f cascadeViewProj[ShadowMapper::MAX_CASCADES]; /**< World to atlas space, per cascade. */
+	cc::Vec4f cascadeRects[ShadowMapper::MAX_CASCADES];    /**< Atlas coordinates of each cascade's map, as min x, min y, max x, max y. */
+	int CascadeCount;
 };
 
-__declspec(align(16))
-struct DepthConstants {
+struct alignas(16) ClusteredConstants {
+	cc::Mat4f world;
+	cc::Mat4f xform;
+	cc::Vec3f campos;
+	float SliceScale;
+	cc::Vec3f CameraFront;
+	float SliceBias;
+	cc::Vec2f TileScale; /**< Tiles per pixel. */
+	int TilesX;
+	int TilesY;
+	int Slices;
+};
+
+struct alignas(16) DepthConstants {
 	cc::Mat4f xform;
 };
 
 class ShadowsDemo : public ciri::App {
 public:
-	ShadowsDemo();
+	/**
+	 * @param cacheShadows True to leave shadow maps whose matrix and casters have not changed in the atlas; false to draw every map every frame.
+	 * @param extraLights  Point lights without shadows to scatter over the ground; they are all shaded in one clustered pass.
+	 */
+	ShadowsDemo( bool cacheShadows=true, int extraLights=64 );
 	virtual ~ShadowsDemo();
 
 	virtual void onInitialize() override;
@@ -53,8 +72,20 @@ public:
 	virtual void onDraw() override;
 	virtual void onUnloadContent() override;
 
+	const ShadowMapper::Stats& getShadowStats() const;
+
+	/**
+	 * Starts or stops the helicopter's animation, as P does.  Stopped, the scene is still and cached shadow maps are kept.
+	 */
+	void setAnimateObjects( bool animate );
+
 private:
 	void loadShaders();
+	void createPipelines();
+	void drawShadowMaps();
+	void drawModel( const Model& model );
+	void updateClusters();
+	bool isClustered( const Light& light ) const;
 
 private:
 	ciri::FPSCamera _camera;
@@ -66,20 +97,44 @@ private:
 	std::shared_ptr<ciri::IConstantBuffer> _directionalConstantsBuffer;
 	DirectionalConstants _directionalConstants;
 	SpotlightConstants _spotlightConstants;
-	std::shared_ptr<ciri::IRasterizerState> _rasterState;
 	std::shared_ptr<Model> _ground;
 	std::shared_ptr<Model> _helicopterBody;
 	std::shared_ptr<Model> _helicopterBlades;
 	std::shared_ptr<Model> _helicopterTail;
 	Light* _cameraLight;
 	bool _lightFollowCamera;
-	std::shared_ptr<ciri::IBlendState> _additiveBlendState;
-	std::shared_ptr<ciri::IRenderTarget2D> _shadowTarget;
+	ciri::RenderGraph _graph;
+	bool _captureShadow; /**< F11 was pressed; the atlas is read back after the next frame's passes. */
+	std::future<ciri::TextureReadback> _capture; /**< Pending F11 capture; written once resolved. */
 	std::shared_ptr<ciri::ISamplerState> _shadowSampler;
 	std::shared_ptr<ciri::IShader> _depthShader;
 	std::shared_ptr<ciri::IConstantBuffer> _depthConstantsBuffer;
 	DepthConstants _depthConstants;
+	std::shared_ptr<ciri::IPipelineState> _depthPipeline;
+	std::shared_ptr<ciri::IPipelineState> _depthClearPipeline; /**< Writes far depth everywhere, to clear one tile of the atlas. */
+	std::shared_ptr<ciri::IVertexBuffer> _clearTriangle;       /**< Covers the viewport in clip space. */
+	std::shared_ptr<ciri::IPipelineState> _directionalPipeline;         /**< First light; writes over the scene. */
+	std::shared_ptr<ciri::IPipelineState> _directionalAdditivePipeline; /**< Later lights; add to the scene. */
+	std::shared_ptr<ciri::IPipelineState> _spotlightPipeline;
+	std::shared_ptr<ciri::IPipelineState> _spotlightAdditivePipeline;
 	bool _animateObjects;
+	std::vector<ciri::BoundingBox> _modelBounds; /**< Local bounds, parallel to _models. */
+	ciri::BoundingBoxArray _worldBounds;
+	std::vector<cc::Mat4f> _worlds; /**< World matrix of each model, parallel to _models. */
+	ciri::FrustumCuller _cameraCuller;
+	std::vector<int> _cameraVisible;
+	ShadowMapper _shadows;
+	bool _cacheShadows;
+	int _extraLights;
+	std::shared_ptr<ciri::IShader> _clusteredShader;
+	std::shared_ptr<ciri::IConstantBuffer> _clusteredConstantsBuffer;
+	ClusteredConstants _clusteredConstants;
+	std::shared_ptr<ciri::IPipelineState> _clusteredPipeline;   /**< Adds every light without shadows to the scene in one draw per model. */
+	ciri::LightClusters _clusters;
+	std::vector<int> _clusteredLights;                          /**< Index into _lights of each light the clusters list. */
+	std::vector<float> _clusteredLightData;
+	std::shared_ptr<ciri::ITexture2D> _clusteredLightTexture;   /**< Three texels per light: position and range, color and cos inner, direction and cos outer. */
+	std::shared_ptr<ciri::ISamplerState> _clusterSampler;
 };
 
 #endif
\ No newline at end of file
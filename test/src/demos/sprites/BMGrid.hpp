@@ -31,7 +31,7 @@ public:
 
 private:
 	void drawLine( ciri::SpriteBatch& spriteBatch, const cc::Vec2f& start, const cc::Vec2f& end, const cc::Vec4f& color, float thickness=2.0f );
-	__forceinline int getIndex( const int x, const int y ) const;
+	inline int getIndex( const int x, const int y ) const;
 
 private:
 	GridPoint* _grid;
@@ -1,7 +0,0 @@
-#include "IParticleSystem.hpp"
-
-IParticleSystem::IParticleSystem() {
-}
-
-IParticleSystem::~IParticleSystem() {
-}
\ No newline at end of file
@@ -5,9 +5,10 @@
 #include <cc/Quaternion.hpp>
 #include "MathHelper.hpp"
 #include <cc/Random.hpp>
+#include <xmmintrin.h>
 
 SpritesDemo::SpritesDemo()
-	: App(), _enemiesKilled(0) {
+	: App(), _enemiesKilled(0), _showProfiler(false) {
 	_config.width = 1280;
 	_config.height = 720;
 	_config.title = "ciri : Sprites Demo";
@@ -61,6 +62,27 @@ void SpritesDemo::onInitialize() {
 
 	_enemySpawnDelay = 1.0f;
 	_enemySpawnTimer = _enemySpawnDelay;
+
+	// configure collision broadphase; cells are about twice an entity's collision radius
+	if( !_broadphase.create(40.0f, 256) ) {
+		printf("Failed to create collision broadphase.\n");
+	}
+	_bulletProxies.fill(-1);
+	_enemyProxies.fill(-1);
+
+	// configure player exhaust particles
+	if( !_psys.create(4096) ) {
+		printf("Failed to create particle system.\n");
+	}
+	_psys.setJobSystem(jobSystem());
+	ciri::ParticleEmitter& emitter = _psys.getEmitter();
+	emitter.lifetime.minLifetime = 0.25f;
+	emitter.lifetime.maxLifetime = 1.0f;
+	emitter.velocity.spread = static_cast<float>(cc::math::PI) * 0.5f;
+	emitter.velocity.minSpeed = 45.0f;
+	emitter.velocity.maxSpeed = 120.0f;
+	emitter.colorOverLife.addKey(0.0f, cc::Vec4f(1.0f, 1.0f, 1.0f, 1.0f));
+	emitter.colorOverLife.addKey(1.0f, cc::Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
 }
 
 void SpritesDemo::onLoadContent() {
@@ -115,6 +137,17 @@ void SpritesDemo::onLoadContent() {
 	}
 	_font->setSize(30);
 	_font->setLineSpacing(30);
+
+	// profiler overlay, toggled with F3
+	_profilerFont = std::make_shared<ciri::FreeTypeSpriteFont>(graphicsDevice());
+	if( ciri::failed(_profilerFont->loadFromFile("data/fonts/Gravity-Bold.ttf")) ) {
+		printf("Failed to load profiler font.\n");
+	}
+	_profilerFont->setSize(14);
+	_profilerFont->setLineSpacing(16);
+	if( !_profilerOverlay.create(graphicsDevice(), _profilerFont) ) {
+		printf("Failed to create profiler overlay.\n");
+	}
 }
 
 void SpritesDemo::onEvent( const ciri::WindowEvent& evt ) {
@@ -146,6 +179,12 @@ void SpritesDemo::onUpdate( const double deltaTime, const double elapsedTime ) {
 		return;
 	}
 
+	// toggle the profiler and its overlay
+	if( input()->isKeyDown(ciri::Key::F3) && input()->wasKeyUp(ciri::Key::F3) ) {
+		_showProfiler = !_showProfiler;
+		ciri::Profiler::setEnabled(_showProfiler);
+	}
+
 	// spawn new enemies
 	if( _enemySpawnTimer < 0.0f ) {
 		if( spawnEnemy() ) {
@@ -220,25 +259,19 @@ void SpritesDemo::onUpdate( const double deltaTime, const double elapsedTime ) {
 	}
 
 	// check collision of bullets and enemies
-	for( int i = 0; i < static_cast<int>(_bullets.size()); ++i ) {
-		if( !_bullets[i].isAlive() ) {
+	_broadphase.findPairs(BULLET_LAYER, ENEMY_LAYER, _collisionPairs);
+	for( const auto& pair : _collisionPairs ) {
+		// a bullet only takes out one enemy and vice versa
+		if( !_bullets[pair.a].isAlive() || !_enemies[pair.b].isAlive() ) {
 			continue;
 		}
 
-		for( int j = 0; j < static_cast<int>(_enemies.size()); ++j ) {
-			if( !_enemies[j].isAlive() ) {
-				continue;
-			}
-
-			if( isColliding(_bullets[i], _enemies[j]) ) {
-				_bullets[i].setIsAlive(false);
-				_enemies[j].setIsAlive(false);
-
-				_enemiesKilled += 1;
+		_bullets[pair.a].setIsAlive(false);
+		_enemies[pair.b].setIsAlive(false);
+		syncProxy(_bulletProxies[pair.a], _bullets[pair.a], pair.a, BULLET_LAYER);
+		syncProxy(_enemyProxies[pair.b], _enemies[pair.b], pair.b, ENEMY_LAYER);
 
-				break;
-			}
-		}
+		_enemiesKilled += 1;
 	}
 }
 
@@ -249,25 +282,27 @@ void SpritesDemo::onFixedUpdate( const double deltaTime, const double elapsedTim
 
 	const ciri::Viewport& vp = graphicsDevice()->getViewport();
 	const cc::Vec4f bounds(static_cast<float>(vp.x()), static_cast<float>(vp.y()), static_cast<float>(vp.width()), static_cast<float>(vp.height()));
-	for( auto& curr : _bullets ) {
-		if( !curr.isAlive() ) {
-			continue;
+	for( int i = 0; i < static_cast<int>(_bullets.size()); ++i ) {
+		Bullet& curr = _bullets[i];
+		if( curr.isAlive() ) {
+			curr.update(bounds);
+			_grid->pull(static_cast<int>(curr.getPosition().x), static_cast<int>(curr.getPosition().y), 2, 4);
 		}
-		curr.update(bounds);
-		_grid->pull(static_cast<int>(curr.getPosition().x), static_cast<int>(curr.getPosition().y), 2, 4);
+		syncProxy(_bulletProxies[i], curr, i, BULLET_LAYER);
 	}
 
 	const cc::Vec2f screenSize = cc::Vec2f(static_cast<float>(vp.width()), static_cast<float>(vp.height()));
-	for( auto& curr : _enemies ) {
-		if( !curr.isAlive() ) {
-			continue;
+	for( int i = 0; i < static_cast<int>(_enemies.size()); ++i ) {
+		Enemy& curr = _enemies[i];
+		if( curr.isAlive() ) {
+			curr.update(screenSize);
 		}
-		curr.update(screenSize);
+		syncProxy(_enemyProxies[i], curr, i, ENEMY_LAYER);
 	}
 
 	if( _player->getVelocity().sqrMagnitude() > 10.0f ) {
-		_psys.setEmitterPosition(_player->getPosition());
-		_psys.setEmitDirection(-_player->getVelocity().normalized());
+		_psys.getEmitter().position = _player->getPosition();
+		_psys.getEmitter().velocity.direction = -_player->getVelocity().normalized();
 		_psys.emitParticles(1);
 	}
 	_psys.update(static_cast<float>(deltaTime));
@@ -308,8 +343,8 @@ void SpritesDemo::onDraw() {
 		_spritebatch.draw(bullet.getTexture(), bullet.getPosition(), bullet.getOrientation(), bullet.getOrigin(), 1.0f, 1.0f);
 	}
 
-	// test particle system
-	_psys.draw(_spritebatch);
+	// player exhaust particles
+	_psys.draw(_spritebatch, 1.0f);
 	
 	// cursor
 	if( _cursorTexture != nullptr ) {
@@ -321,6 +356,10 @@ void SpritesDemo::onDraw() {
 	const cc::Vec4f scoreColor = cc::Vec4f(1.0f, 1.0f, 1.0f, 1.0f);
 	_spritebatch.drawString(_font, "Score: " + std::to_string(_enemiesKilled), scorePosition, scoreColor, 1.0f, 0.0f, 1.0f);
 
+	if( _showProfiler ) {
+		_profilerOverlay.draw(_spritebatch, cc::Vec2f(20.0f, 20.0f));
+	}
+
 	_spritebatch.end();
 
 	device->present();
@@ -330,6 +369,8 @@ void SpritesDemo::onUnloadContent() {
 	App::onUnloadContent();
 
 	_spritebatch.clean();
+	_psys.clean();
+	_profilerOverlay.clean();
 	if( _grid != nullptr ) {
 		delete _grid;
 		_grid = nullptr;
@@ -337,7 +378,8 @@ void SpritesDemo::onUnloadContent() {
 }
 
 void SpritesDemo::addBullet( const cc::Vec2f& position, const cc::Vec2f& velocity ) {
-	for( auto& curr : _bullets ) {
+	for( int i = 0; i < static_cast<int>(_bullets.size()); ++i ) {
+		Bullet& curr = _bullets[i];
 		if( curr.isAlive() ) {
 			continue;
 		}
@@ -345,17 +387,14 @@ void SpritesDemo::addBullet( const cc::Vec2f& position, const cc::Vec2f& velocit
 		curr.setIsAlive(true);
 		curr.setPosition(position);
 		curr.setVelocity(velocity);
+		syncProxy(_bulletProxies[i], curr, i, BULLET_LAYER);
 		break;
 	}
 }
 
-bool SpritesDemo::isColliding( const Entity& a, const Entity& b ) const {
-	const float radius = a.getCollisionRadius() + b.getCollisionRadius();
-	return a.getPosition().sqrDistance(b.getPosition()) < (radius * radius);
-}
-
 bool SpritesDemo::spawnEnemy() {
-	for( auto& curr : _enemies ) {
+	for( int i = 0; i < static_cast<int>(_enemies.size()); ++i ) {
+		Enemy& curr = _enemies[i];
 		if( curr.isAlive() ) {
 			continue;
 		}
@@ -365,7 +404,24 @@ bool SpritesDemo::spawnEnemy() {
 		curr.setTexture(_enemySeekerTexture);
 		curr.setIsAlive(true);
 		curr.setTarget(_player);
+		syncProxy(_enemyProxies[i], curr, i, ENEMY_LAYER);
 		return true;
 	}
 	return false;
+}
+
+void SpritesDemo::syncProxy( int& proxy, const Entity& entity, int index, unsigned int layer ) {
+	if( !entity.isAlive() ) {
+		if( proxy != -1 ) {
+			_broadphase.remove(proxy);
+			proxy = -1;
+		}
+		return;
+	}
+
+	if( -1 == proxy ) {
+		proxy = _broadphase.insert(entity.getPosition(), entity.getCollisionRadius(), index, layer);
+	} else {
+		_broadphase.move(proxy, entity.getPosition());
+	}
 }
\ No newline at end of file
@@ -2,13 +2,13 @@
 #define __spritesdemo__
 
 #include <array>
+#include <vector>
 #include <memory>
 #include <ciri/Game.hpp>
 #include "PlayerShip.hpp"
 #include "Bullet.hpp"
 #include <cc/Quaternion.hpp>
 #include "Enemy.hpp"
-#include "TestParticleSystem.hpp"
 
 #include "BMGrid.hpp"
 
@@ -29,8 +29,8 @@ public:
 
 private:
 	void addBullet( const cc::Vec2f& position, const cc::Vec2f& velocity );
-	bool isColliding( const Entity& a, const Entity& b ) const;
 	bool spawnEnemy();
+	void syncProxy( int& proxy, const Entity& entity, int index, unsigned int layer );
 
 private:
 	ciri::SpriteBatch _spritebatch;
@@ -46,13 +46,16 @@ private:
 	std::shared_ptr<PlayerShip> _player;
 	cc::Vec2f _playerMovement;
 
+	static const int MAX_BULLETS = 100;
+	static const int MAX_ENEMIES = 10;
+
 	std::shared_ptr<ciri::ITexture2D> _bulletTexture;
-	std::array<Bullet, 100> _bullets;
+	std::array<Bullet, MAX_BULLETS> _bullets;
 	float _fireTimer = {0.0f};
 	const float FIRE_DELAY = {0.1f};
 
 	std::shared_ptr<ciri::ITexture2D> _enemySeekerTexture;
-	std::array<Enemy, 10> _enemies;
+	std::array<Enemy, MAX_ENEMIES> _enemies;
 	float _enemySpawnDelay;
 	float _enemySpawnTimer;
 
@@ -60,11 +63,22 @@ private:
 	cc::Vec2f _cursorPos;
 	cc::Vec2f _cursorOrigin;
 
-	TestParticleSystem _psys;
+	ciri::ParticleSystem _psys;
 	std::shared_ptr<ciri::ITexture2D> _testPsysTexture;
 
+	static const unsigned int BULLET_LAYER = 1 << 0;
+	static const unsigned int ENEMY_LAYER = 1 << 1;
+	ciri::SpatialHash2D _broadphase;
+	std::array<int, MAX_BULLETS> _bulletProxies;
+	std::array<int, MAX_ENEMIES> _enemyProxies;
+	std::vector<ciri::SpatialHashPair> _collisionPairs;
+
 	std::shared_ptr<ciri::ISpriteFont> _font;
 	int _enemiesKilled;
+
+	std::shared_ptr<ciri::ISpriteFont> _profilerFont;
+	ciri::ProfilerOverlay _profilerOverlay;
+	bool _showProfiler;
 };
 
 #endif /* __spritesdemo__ */
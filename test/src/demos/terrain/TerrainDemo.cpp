@@ -54,9 +54,11 @@ void TerrainDemo::onLoadContent() {
 	// create heightmap terrain
 	ciri::TGA heightmap;
 	heightmap.loadFromFile("terrain/heightmap.tga", false);
+	_terrain.setJobSystem(jobSystem());
 	if( !_terrain.generate(heightmap, graphicsDevice()) ) {
 		printf("Failed to generate heightmap terrain.\n");
 	}
+	_terrain.setLodParams(2.0f, _camera.getFov(), static_cast<float>(window()->getHeight()));
 	// load a bunch of terrain textures and set them
 	ciri::TGA grassTga; grassTga.loadFromFile("terrain/grass.tga", true);
 	ciri::TGA rockTga; rockTga.loadFromFile("terrain/rock.tga", true);
@@ -315,7 +317,7 @@ void TerrainDemo::onDraw() {
 		drawSkybox(viewMatrix, projMatrix);
 		_terrain.setClippingPlaneActive(true);
 		_terrain.setClippingPlaneParams(WATER_HEIGHT - 0.5f, viewProjMatrix, true);
-		_terrain.draw(viewProjMatrix, device);
+		_terrain.draw(viewProjMatrix, pos, device);
 		_waterConstants.reflectedViewProj = viewProjMatrix;
 
 		// refractions
@@ -325,7 +327,7 @@ void TerrainDemo::onDraw() {
 		device->clear(ciri::ClearFlags::Color);
 		_terrain.setClippingPlaneActive(true);
 		_terrain.setClippingPlaneParams(WATER_HEIGHT + 1.5f, standardViewProj, false);
-		_terrain.draw(standardViewProj, device);
+		_terrain.draw(standardViewProj, _camera.getPosition(), device);
 	}
 
 	// set and clear default render target
@@ -349,7 +351,7 @@ void TerrainDemo::onDraw() {
 	enableTerrain = input()->isKeyDown(ciri::Key::Space);
 	if( !enableTerrain ) {
 		_terrain.setClippingPlaneActive(false);
-		_terrain.draw(viewProj, graphicsDevice());
+		_terrain.draw(viewProj, _camera.getPosition(), graphicsDevice());
 	}
 
 	// render water plane
@@ -7,11 +7,11 @@
 #include "../../common/Model.hpp"
 #include "../../common/ShaderPresets.hpp"
 #include "../../common/HeightmapTerrain.hpp"
+#include <xmmintrin.h>
 
 class TerrainDemo : public ciri::App {
 private:
-	_declspec(align(16))
-	struct WaterConstants {
+	struct alignas(16) WaterConstants {
 		cc::Mat4f world;
 		cc::Mat4f xform;
 		cc::Mat4f reflectedViewProj;
@@ -19,8 +19,7 @@ private:
 		float time;
 	};
 
-	_declspec(align(16))
-	struct SkyboxConstants {
+	struct alignas(16) SkyboxConstants {
 		cc::Mat4f view;
 		cc::Mat4f proj;
 	};
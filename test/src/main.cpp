@@ -1,17 +1,46 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#ifdef _WIN32
 #include <crtdbg.h>
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include <ciri/Core.hpp>
 #include <ciri/Graphics.hpp>
+#include <cc/MatrixFunc.hpp>
 #include "demos/dynvb/DynamicVertexBufferDemo.hpp"
 #include "demos/terrain/TerrainDemo.hpp"
 #include "demos/sprites/SpritesDemo.hpp"
 #include "demos/refract/RefractDemo.hpp"
 #include "demos/clipping/ClippingDemo.hpp"
 #include "demos/parallax/ParallaxDemo.hpp"
-#include "demos\gridlr\Gridlr.hpp"
+#include "demos/gridlr/Gridlr.hpp"
 #include "demos/playground/playground.hpp"
 #include "demos/shadows/ShadowsDemo.hpp"
+#include "demos/deferred/DeferredDemo.hpp"
 #include <ciri/Game.hpp>
+#include <ciri/graphics/null/GraphicsCommandStream.hpp>
+#include <ciri/graphics/null/NullGraphicsDevice.hpp>
+#include <ciri/core/window/null/NullWindow.hpp>
+#include "common/Model.hpp"
+#include "common/MeshPool.hpp"
+#include "common/ShaderPresets.hpp"
+#include "common/HeightmapTerrain.hpp"
+#include "common/TerrainPreprocess.hpp"
+#include "common/SyntheticLoadApp.hpp"
 
 enum class Demo {
 	Dynvb,
@@ -22,7 +51,13 @@ enum class Demo {
 	Parallax,
 	Gridlr,
 	Playground,
-	Shadows
+	Shadows,
+	Deferred,
+	Count
+};
+
+static const char* DEMO_NAMES[] = {
+	"dynvb", "terrain", "sprites", "refract", "clipping", "parallax", "gridlr", "playground", "shadows", "deferred"
 };
 
 std::unique_ptr<ciri::App> createGame( Demo type ) {
@@ -63,24 +98,1821 @@ std::unique_ptr<ciri::App> createGame( Demo type ) {
 			return std::unique_ptr<ciri::App>(new ShadowsDemo());
 		}
 
+		case Demo::Deferred: {
+			return std::unique_ptr<ciri::App>(new DeferredDemo());
+		}
+
 		default: {
 			return nullptr;
 		}
 	}
 }
 
-int main() {
+// sends stdout to a temporary file while alive, so what a demo prints can be checked; output() puts it back and returns the text
+class StdoutCapture {
+public:
+	StdoutCapture()
+		: _file(tmpfile()), _saved(-1) {
+		fflush(stdout);
+		if( _file != nullptr ) {
+			_saved = dup(fileno(stdout));
+			dup2(fileno(_file), fileno(stdout));
+		}
+	}
+
+	~StdoutCapture() {
+		output();
+	}
+
+	std::string output() {
+		std::string text;
+		if( nullptr == _file ) {
+			return text;
+		}
+		fflush(stdout);
+		dup2(_saved, fileno(stdout));
+		close(_saved);
+		rewind(_file);
+		char chunk[4096];
+		for( size_t got = fread(chunk, 1, sizeof(chunk), _file); got > 0; got = fread(chunk, 1, sizeof(chunk), _file) ) {
+			text.append(chunk, got);
+		}
+		fclose(_file);
+		_file = nullptr;
+		return text;
+	}
+
+private:
+	FILE* _file;
+	int _saved;
+};
+
+// counts the lines of a demo's output that report something failing to load or not being found
+static int countLoadFailures( const std::string& output ) {
+	int failures = 0;
+	size_t start = 0;
+	while( start < output.size() ) {
+		size_t end = output.find('\n', start);
+		end = (std::string::npos == end) ? output.size() : end;
+		const std::string line = output.substr(start, end - start);
+		if( line.find("Failed") != std::string::npos || line.find("failed") != std::string::npos || line.find("not found") != std::string::npos ) {
+			failures += 1;
+		}
+		start = end + 1;
+	}
+	return failures;
+}
+
+static void printCounters( const ciri::GraphicsCounters& counters ) {
+	printf("frames: %d\n", counters.frames);
+	printf("draw calls: %d\n", counters.drawCalls);
+	printf("vertices submitted: %lld\n", counters.verticesSubmitted);
+	printf("state changes: %d\n", counters.stateChanges);
+	printf("redundant binds: %d\n", counters.redundantBinds);
+	printf("render target changes: %d\n", counters.renderTargetChanges);
+	printf("clears: %d\n", counters.clears);
+	printf("bytes uploaded (vb/ib/cb/tex): %lld/%lld/%lld/%lld\n", counters.vertexBytesUploaded, counters.indexBytesUploaded, counters.constantBytesUploaded, counters.textureBytesUploaded);
+	printf("constant updates (own buffer/ring): %d/%d\n", counters.constantUpdates, counters.constantRangeBinds);
+}
+
+// times a loop with a profile scope in it against the same loop without, and returns nanoseconds per iteration
+static double timeProfileLoop( int iterations, bool scoped ) {
+	volatile int sink = 0;
+	const long long start = ciri::Profiler::now();
+	for( int i = 0; i < iterations; ++i ) {
+		if( scoped ) {
+			CIRI_PROFILE_SCOPE("bench");
+			sink = sink + i;
+		} else {
+			sink = sink + i;
+		}
+		// drain well before a thread's ring fills so nothing is dropped
+		if( (i & 1023) == 1023 ) {
+			ciri::Profiler::endFrame();
+		}
+	}
+	const long long end = ciri::Profiler::now();
+	return static_cast<double>(end - start) / static_cast<double>(iterations > 0 ? iterations : 1);
+}
+
+// scatters point and spot lights through and around a 500 unit view volume, a quarter of them spot lights, the same every run
+static void addTestLights( ciri::LightClusters& clusters, int count ) {
+	unsigned int seed = 1;
+	const auto next = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return static_cast<float>(seed >> 8) / 16777216.0f;
+	};
+	for( int i = 0; i < count; ++i ) {
+		const cc::Vec3f position(next() * 600.0f - 300.0f, next() * 200.0f - 100.0f, next() * 600.0f - 300.0f);
+		const float range = 2.0f + next() * 18.0f;
+		if( 0 == (i & 3) ) {
+			const cc::Vec3f direction(next() * 2.0f - 1.0f, next() * 2.0f - 1.0f, next() * 2.0f - 1.0f);
+			clusters.addSpotLight(position, direction, range, 5.0f + next() * 55.0f);
+		} else {
+			clusters.addPointLight(position, range);
+		}
+	}
+}
+
+// returns how many clusters list different lights in two builds of the same lights and view
+static int countClusterMismatches( const ciri::LightClusters& lhs, const ciri::LightClusters& rhs ) {
+	int mismatches = 0;
+	for( int c = 0; c < lhs.getClusterCount(); ++c ) {
+		const int count = lhs.getClusterLightCount(c);
+		if( count != rhs.getClusterLightCount(c) ) {
+			mismatches += 1;
+			continue;
+		}
+		const int* lhsLights = lhs.getLightIndices().data() + lhs.getClusterOffset(c);
+		const int* rhsLights = rhs.getLightIndices().data() + rhs.getClusterOffset(c);
+		if( count > 0 && memcmp(lhsLights, rhsLights, sizeof(int) * count) != 0 ) {
+			mismatches += 1;
+		}
+	}
+	return mismatches;
+}
+
+// fills data with a little math per element, spread over a job system of the given threads, and returns milliseconds per pass
+static double timeParallelFor( int threads, std::vector<float>& data, int grain ) {
+	ciri::JobSystem jobs;
+	jobs.create(threads);
+	const int passes = 10;
+	const long long start = ciri::Profiler::now();
+	for( int pass = 0; pass < passes; ++pass ) {
+		jobs.parallelFor(0, static_cast<int>(data.size()), grain, [&data, pass]( int begin, int end ) {
+			for( int i = begin; i < end; ++i ) {
+				const float x = static_cast<float>(i + pass);
+				data[i] = sqrtf(x) * 0.5f + x * 0.25f;
+			}
+		});
+	}
+	return static_cast<double>(ciri::Profiler::now() - start) / (passes * 1000000.0);
+}
+
+// runs layers of small jobs where every job of a layer waits on the whole layer before it, and returns milliseconds for the lot
+static double timeJobGraph( int threads, int layers, int jobsPerLayer, std::vector<unsigned int>& results ) {
+	ciri::JobSystem jobs;
+	jobs.create(threads);
+	results.assign(jobsPerLayer, 0);
+	std::unique_ptr<ciri::JobCounter[]> counters(new ciri::JobCounter[layers]);
+	const long long start = ciri::Profiler::now();
+	for( int layer = 0; layer < layers; ++layer ) {
+		for( int j = 0; j < jobsPerLayer; ++j ) {
+			jobs.run([&results, j]() {
+				unsigned int value = results[j];
+				for( int k = 0; k < 64; ++k ) {
+					value = value * 1664525u + 1013904223u;
+				}
+				results[j] = value;
+			}, &counters[layer], (layer > 0) ? &counters[layer - 1] : nullptr);
+		}
+	}
+	jobs.wait(counters[layers - 1]);
+	return static_cast<double>(ciri::Profiler::now() - start) / 1000000.0;
+}
+
+// spawns two jobs per level down to depth and waits on them from inside the job, counting the leaves
+static void spawnJobTree( ciri::JobSystem& jobs, int depth, std::atomic<int>& leaves ) {
+	if( 0 == depth ) {
+		leaves.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ciri::JobCounter children;
+	for( int i = 0; i < 2; ++i ) {
+		jobs.run([&jobs, depth, &leaves]() {
+			spawnJobTree(jobs, depth - 1, leaves);
+		}, &children);
+	}
+	jobs.wait(children);
+}
+
+// runs one round of every job system check on the given threads, and returns how many failed
+static int runJobStressRound( int threads, unsigned int seed ) {
+	ciri::JobSystem jobs;
+	jobs.create(threads);
+	int failures = 0;
+
+	// every index is visited exactly once whatever the grain
+	const int count = 100000;
+	std::vector<int> visits(count, 0);
+	const int grain = 1 + static_cast<int>(seed % 997u);
+	jobs.parallelFor(0, count, grain, [&visits, grain]( int begin, int end ) {
+		if( end - begin > grain ) {
+			visits[begin] += 1000; // flags a range over the grain
+		}
+		for( int i = begin; i < end; ++i ) {
+			visits[i] += 1;
+		}
+	});
+	failures += (std::count(visits.begin(), visits.end(), 1) == count) ? 0 : 1;
+
+	// parallelFor inside parallelFor
+	std::vector<std::vector<int>> nested(64, std::vector<int>(1000, 0));
+	jobs.parallelFor(0, 64, 1, [&jobs, &nested]( int begin, int end ) {
+		for( int outer = begin; outer < end; ++outer ) {
+			std::vector<int>& inner = nested[outer];
+			jobs.parallelFor(0, static_cast<int>(inner.size()), 16, [&inner, outer]( int innerBegin, int innerEnd ) {
+				for( int i = innerBegin; i < innerEnd; ++i ) {
+					inner[i] = outer * 1000 + i;
+				}
+			});
+		}
+	});
+	for( int outer = 0; outer < 64; ++outer ) {
+		for( int i = 0; i < 1000; ++i ) {
+			failures += (nested[outer][i] == outer * 1000 + i) ? 0 : 1;
+		}
+	}
+
+	// a chain where each job runs after the last; the order is only kept by the counters
+	const int chainLength = 256;
+	std::unique_ptr<ciri::JobCounter[]> chain(new ciri::JobCounter[chainLength]);
+	std::vector<int> order;
+	for( int i = 0; i < chainLength; ++i ) {
+		jobs.run([&order, i]() {
+			order.push_back(i);
+		}, &chain[i], (i > 0) ? &chain[i - 1] : nullptr);
+	}
+	jobs.wait(chain[chainLength - 1]);
+	for( int i = 0; i < chainLength; ++i ) {
+		failures += (static_cast<int>(order.size()) > i && order[i] == i) ? 0 : 1;
+	}
+
+	// jobs that run and wait on jobs of their own
+	std::atomic<int> leaves(0);
+	spawnJobTree(jobs, 10, leaves);
+	failures += (1024 == leaves.load()) ? 0 : 1;
+
+	// threads outside the system running and waiting on jobs at the same time
+	std::atomic<int> outside(0);
+	std::vector<std::future<void>> submitters;
+	for( int t = 0; t < 4; ++t ) {
+		submitters.push_back(std::async(std::launch::async, [&jobs, &outside]() {
+			ciri::JobCounter counter;
+			for( int i = 0; i < 1000; ++i ) {
+				jobs.run([&outside]() {
+					outside.fetch_add(1, std::memory_order_relaxed);
+				}, &counter);
+			}
+			jobs.wait(counter);
+		}));
+	}
+	for( auto& submitter : submitters ) {
+		submitter.get();
+	}
+	failures += (4000 == outside.load()) ? 0 : 1;
+
+	jobs.destroy();
+	return failures;
+}
+
+// what the command list benchmark draws: a few meshes and one constant buffer, updated per draw as a world matrix would be
+struct DrawBenchScene {
+	std::shared_ptr<ciri::IShader> shader;
+	std::shared_ptr<ciri::IConstantBuffer> constants;
+	std::vector<std::shared_ptr<ciri::IVertexBuffer>> vertexBuffers;
+	std::vector<std::shared_ptr<ciri::IIndexBuffer>> indexBuffers;
+};
+
+// updates constants the way each target can: a device writes the buffer now, a list copies the data to write when executed
+static void setBenchConstants( const std::shared_ptr<ciri::NullGraphicsDevice>&, const std::shared_ptr<ciri::IConstantBuffer>& buffer, int dataSize, float* data ) {
+	buffer->setData(dataSize, data);
+}
+static void setBenchConstants( const std::shared_ptr<ciri::ICommandList>& list, const std::shared_ptr<ciri::IConstantBuffer>& buffer, int dataSize, float* data ) {
+	list->setConstants(buffer, dataSize, data);
+}
+
+// issues draws [begin, end) to a device or a command list; runs of sixteen draws share a mesh, as sorted draws would
+template<typename Target>
+static void issueBenchDraws( Target& target, const DrawBenchScene& scene, int begin, int end ) {
+	float world[16] = {0.0f};
+	for( int i = begin; i < end; ++i ) {
+		const int mesh = (i / 16) % static_cast<int>(scene.vertexBuffers.size());
+		if( i == begin || 0 == (i % 16) ) {
+			target->setVertexBuffer(scene.vertexBuffers[mesh]);
+			target->setIndexBuffer(scene.indexBuffers[mesh]);
+		}
+		world[0] = world[5] = world[10] = world[15] = 1.0f;
+		world[12] = static_cast<float>(i);
+		setBenchConstants(target, scene.constants, sizeof(world), world);
+		target->drawIndexed(ciri::PrimitiveTopology::TriangleList, scene.indexBuffers[mesh]->getIndexCount(), 0, 0);
+	}
+}
+
+// tests one box against each plane of a frustum the plain way, centre distance against the extents projected onto the normal; returns
+// that margin for the plane the box is furthest behind, so negative means culled
+static float boxFrustumMargin( const ciri::BoundingFrustum& frustum, const cc::Vec3f& center, const cc::Vec3f& extents ) {
+	float margin = std::numeric_limits<float>::max();
+	for( const ciri::Plane& plane : frustum.planes() ) {
+		const cc::Vec3f& n = plane.getNormal();
+		const float dist = (n.x * center.x + n.y * center.y) + (n.z * center.z + plane.getD());
+		const float radius = (fabsf(n.x) * extents.x + fabsf(n.y) * extents.y) + fabsf(n.z) * extents.z;
+		margin = std::min(margin, dist + radius);
+	}
+	return margin;
+}
+
+// rolling hills with a little noise, heights within 0 to 200 like the demo's normalized heightmap, the same every run
+static void makeTestHeights( std::vector<float>& heights, int size ) {
+	unsigned int seed = 1;
+	heights.resize(static_cast<size_t>(size) * size);
+	for( int y = 0; y < size; ++y ) {
+		for( int x = 0; x < size; ++x ) {
+			seed = seed * 1664525u + 1013904223u;
+			const float noise = static_cast<float>(seed >> 8) / 16777216.0f;
+			heights[static_cast<size_t>(y) * size + x] = 100.0f + 80.0f * sinf(static_cast<float>(x) * 0.011f) * cosf(static_cast<float>(y) * 0.007f) + noise * 8.0f;
+		}
+	}
+}
+
+// the 3x3 box filter terrain generation used before terrainprep, with edges smoothed; bounds are only checked on the linear index,
+// so the first and last columns take texels from the neighbouring rows
+static void referenceBoxFilter( const float* src, float* dst, int width, int height ) {
+	const long long bounds = static_cast<long long>(width) * height;
+	for( long long z = 0; z < height; ++z ) {
+		for( long long x = 0; x < width; ++x ) {
+			float value = src[x + z * width];
+			float cellAverage = 1.0f;
+			for( long long dz = -1; dz <= 1; ++dz ) {
+				for( long long dx = -1; dx <= 1; ++dx ) {
+					const long long index = (x + dx) + (z + dz) * width;
+					if( (dx != 0 || dz != 0) && index >= 0 && index < bounds ) {
+						value += src[index];
+						++cellAverage;
+					}
+				}
+			}
+			dst[x + z * width] = value / cellAverage;
+		}
+	}
+}
+
+// the normals terrain generation used before terrainprep: every vertex sums the unnormalized normals of the full resolution triangles
+// around it, with columns along +x and rows along -z
+static void referenceTriangleNormals( const float* heights, int width, int height, std::vector<cc::Vec3f>& normals ) {
+	normals.assign(static_cast<size_t>(width) * height, cc::Vec3f(0.0f, 0.0f, 0.0f));
+	const auto position = [heights, width]( int x, int y ) {
+		return cc::Vec3f(static_cast<float>(x), heights[static_cast<size_t>(y) * width + x], static_cast<float>(-y));
+	};
+	for( int y = 0; y < (height - 1); ++y ) {
+		for( int x = 0; x < (width - 1); ++x ) {
+			const int corners[2][3][2] = {{{x, y+1}, {x, y}, {x+1, y}}, {{x, y+1}, {x+1, y}, {x+1, y+1}}};
+			for( int t = 0; t < 2; ++t ) {
+				const cc::Vec3f p1 = position(corners[t][0][0], corners[t][0][1]);
+				const cc::Vec3f p2 = position(corners[t][1][0], corners[t][1][1]);
+				const cc::Vec3f p3 = position(corners[t][2][0], corners[t][2][1]);
+				const cc::Vec3f normal = (p1 - p2).cross(p1 - p3);
+				for( int v = 0; v < 3; ++v ) {
+					normals[static_cast<size_t>(corners[t][v][1]) * width + corners[t][v][0]] += normal;
+				}
+			}
+		}
+	}
+	for( auto& normal : normals ) {
+		normal.normalize();
+	}
+}
+
+// scalar reference for terrainprep::computeNormalsAndTangents at one texel: central differences, one-sided at the borders, in double precision
+static void referenceNormalAndTangent( const float* heights, int width, int height, int x, int y, float spacingX, float spacingZ, float tangentW, float* normal, float* tangent ) {
+	const int prevX = (x > 0) ? x - 1 : x;
+	const int nextX = (x + 1 < width) ? x + 1 : x;
+	const int prevY = (y > 0) ? y - 1 : y;
+	const int nextY = (y + 1 < height) ? y + 1 : y;
+	const double dhdcol = (nextX > prevX) ? (static_cast<double>(heights[static_cast<size_t>(y) * width + nextX]) - heights[static_cast<size_t>(y) * width + prevX]) / (nextX - prevX) : 0.0;
+	const double dhdrow = (nextY > prevY) ? (static_cast<double>(heights[static_cast<size_t>(nextY) * width + x]) - heights[static_cast<size_t>(prevY) * width + x]) / (nextY - prevY) : 0.0;
+	const double dhdx = dhdcol / spacingX;
+	const double dhdz = dhdrow / spacingZ;
+	const double length = sqrt(dhdx * dhdx + 1.0 + dhdz * dhdz);
+	normal[0] = static_cast<float>(-dhdx / length);
+	normal[1] = static_cast<float>(1.0 / length);
+	normal[2] = static_cast<float>(-dhdz / length);
+	const double tangentLength = sqrt(static_cast<double>(spacingX) * spacingX + dhdcol * dhdcol);
+	tangent[0] = static_cast<float>(spacingX / tangentLength);
+	tangent[1] = static_cast<float>(dhdcol / tangentLength);
+	tangent[2] = 0.0f;
+	tangent[3] = tangentW;
+}
+
+// scalar reference for terrainprep::computeSplatWeights at one texel, in double precision
+static void referenceSplatWeights( float height, const float centers[4], const float widths[4], float* weights ) {
+	double w[4];
+	double total = 0.0;
+	for( int l = 0; l < 4; ++l ) {
+		w[l] = std::max(0.0, 1.0 - fabs(static_cast<double>(height) - centers[l]) / widths[l]);
+		total += w[l];
+	}
+	total = std::max(total, 1e-6);
+	for( int l = 0; l < 4; ++l ) {
+		weights[l] = static_cast<float>(w[l] / total);
+	}
+}
+
+// FNV-1a over the bits of a float buffer, to tell whether two runs wrote exactly the same results without keeping both
+static unsigned long long hashFloats( const std::vector<float>& values ) {
+	unsigned long long hash = 14695981039346656037ULL;
+	for( const float value : values ) {
+		unsigned int bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		hash = (hash ^ bits) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+// height along a patch edge at a detail level, which linearly interpolates the level's edge vertices; k runs from 0 to PATCH_SIZE along the edge
+static float terrainEdgeHeight( const TerrainQuadtree& quadtree, int x, int y, bool alongX, int k, int lod ) {
+	const int step = 1 << lod;
+	const int k0 = (k / step) * step;
+	const int k1 = std::min(k0 + step, static_cast<int>(TerrainQuadtree::PATCH_SIZE));
+	const float h0 = alongX ? quadtree.getHeight(x + k0, y) : quadtree.getHeight(x, y + k0);
+	const float h1 = alongX ? quadtree.getHeight(x + k1, y) : quadtree.getHeight(x, y + k1);
+	const float t = (k1 > k0) ? static_cast<float>(k - k0) / static_cast<float>(k1 - k0) : 0.0f;
+	return h0 + (h1 - h0) * t;
+}
+
+// counts points on edges shared by two selected patches where the gap between their levels is deeper than the higher patch's skirt hangs
+static int countTerrainCracks( const TerrainQuadtree& quadtree ) {
+	const int size = TerrainQuadtree::PATCH_SIZE;
+	std::vector<int> lodOf(quadtree.getPatchCount(), -1);
+	for( int lod = 0; lod < TerrainQuadtree::LOD_COUNT; ++lod ) {
+		for( const int patch : quadtree.getVisiblePatches(lod) ) {
+			lodOf[patch] = lod;
+		}
+	}
+	int patchesX = 0;
+	int patchesY = 0;
+	for( int p = 0; p < quadtree.getPatchCount(); ++p ) {
+		patchesX = std::max(patchesX, quadtree.getPatch(p).originX / size + 1);
+		patchesY = std::max(patchesY, quadtree.getPatch(p).originY / size + 1);
+	}
+	std::vector<int> grid(patchesX * patchesY, -1);
+	for( int p = 0; p < quadtree.getPatchCount(); ++p ) {
+		grid[(quadtree.getPatch(p).originY / size) * patchesX + quadtree.getPatch(p).originX / size] = p;
+	}
+
+	int cracks = 0;
+	for( int py = 0; py < patchesY; ++py ) {
+		for( int px = 0; px < patchesX; ++px ) {
+			const int a = grid[py * patchesX + px];
+			if( -1 == a || -1 == lodOf[a] ) {
+				continue;
+			}
+			const TerrainQuadtree::Patch& patchA = quadtree.getPatch(a);
+			// the neighbour along +x shares a's last column, and the neighbour along +y its last row
+			const int neighbours[2] = { (px + 1 < patchesX) ? grid[py * patchesX + px + 1] : -1, (py + 1 < patchesY) ? grid[(py + 1) * patchesX + px] : -1 };
+			for( int n = 0; n < 2; ++n ) {
+				const int b = neighbours[n];
+				if( -1 == b || -1 == lodOf[b] ) {
+					continue;
+				}
+				const TerrainQuadtree::Patch& patchB = quadtree.getPatch(b);
+				const bool alongX = (1 == n);
+				for( int k = 0; k <= size; ++k ) {
+					const float heightA = terrainEdgeHeight(quadtree, alongX ? patchA.originX : patchA.originX + size, alongX ? patchA.originY + size : patchA.originY, alongX, k, lodOf[a]);
+					const float heightB = terrainEdgeHeight(quadtree, patchB.originX, patchB.originY, alongX, k, lodOf[b]);
+					const float skirt = (heightA > heightB) ? patchA.skirtDepth : patchB.skirtDepth;
+					cracks += (fabsf(heightA - heightB) > skirt + 0.001f) ? 1 : 0;
+				}
+			}
+		}
+	}
+	return cracks;
+}
+
+// welds identical vertices of a non-indexed model (as loaded from OBJ) and indexes it, as an asset pipeline would before packing
+static void indexModel( Model& model ) {
+	std::vector<Vertex>& vertices = model.getVertices();
+	std::vector<int>& indices = model.getIndices();
+	if( !indices.empty() ) {
+		return;
+	}
+	std::map<std::string, int> welded;
+	std::vector<Vertex> unique;
+	for( const Vertex& vertex : vertices ) {
+		const std::string key(reinterpret_cast<const char*>(&vertex), sizeof(Vertex));
+		auto found = welded.find(key);
+		if( found == welded.end() ) {
+			found = welded.insert(std::make_pair(key, static_cast<int>(unique.size()))).first;
+			unique.push_back(vertex);
+		}
+		indices.push_back(found->second);
+	}
+	vertices.swap(unique);
+}
+
+// circles drifting through a square world that wraps at its edges, the same every run
+struct HashTestCircle {
+	cc::Vec2f position;
+	cc::Vec2f velocity;
+	float radius;
+	unsigned int layer;
+};
+
+// scatters count circles of the given radius and layer through a world of the given size
+static void addHashTestCircles( std::vector<HashTestCircle>& circles, int count, float radius, unsigned int layer, float worldSize, unsigned int& seed ) {
+	const auto next = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return static_cast<float>(seed >> 8) / 16777216.0f;
+	};
+	for( int i = 0; i < count; ++i ) {
+		HashTestCircle circle;
+		circle.position = cc::Vec2f(next() * worldSize, next() * worldSize);
+		circle.velocity = cc::Vec2f(next() * 400.0f - 200.0f, next() * 400.0f - 200.0f);
+		circle.radius = radius;
+		circle.layer = layer;
+		circles.push_back(circle);
+	}
+}
+
+// tests every circle of layerMaskA against every circle of layerMaskB and returns the pairs sorted; a pair of circles both in both masks is
+// reported once, lowest index first
+static std::vector<std::pair<int, int>> findPairsBruteForce( const std::vector<HashTestCircle>& circles, unsigned int layerMaskA, unsigned int layerMaskB ) {
+	std::vector<int> inA;
+	std::vector<int> inB;
+	for( int i = 0; i < static_cast<int>(circles.size()); ++i ) {
+		if( circles[i].layer & layerMaskA ) {
+			inA.push_back(i);
+		}
+		if( circles[i].layer & layerMaskB ) {
+			inB.push_back(i);
+		}
+	}
+	std::vector<std::pair<int, int>> pairs;
+	for( const int i : inA ) {
+		const bool aInB = (circles[i].layer & layerMaskB) != 0;
+		for( const int j : inB ) {
+			if( j == i || (aInB && (circles[j].layer & layerMaskA) && j < i) ) {
+				continue;
+			}
+			const float dx = circles[j].position.x - circles[i].position.x;
+			const float dy = circles[j].position.y - circles[i].position.y;
+			const float r = circles[i].radius + circles[j].radius;
+			if( (dx*dx + dy*dy) <= (r*r) ) {
+				pairs.push_back(std::make_pair(i, j));
+			}
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+	return pairs;
+}
+
+// sorts the hash's pairs so they can be compared against brute force; the hash orders pairs of circles both in both masks by handle,
+// so those are put lowest index first
+static std::vector<std::pair<int, int>> sortHashPairs( const std::vector<ciri::SpatialHashPair>& found, const std::vector<HashTestCircle>& circles, unsigned int layerMaskA, unsigned int layerMaskB ) {
+	std::vector<std::pair<int, int>> pairs;
+	pairs.reserve(found.size());
+	for( const auto& pair : found ) {
+		const bool swappable = (circles[pair.a].layer & layerMaskB) && (circles[pair.b].layer & layerMaskA);
+		if( swappable && pair.b < pair.a ) {
+			pairs.push_back(std::make_pair(pair.b, pair.a));
+		} else {
+			pairs.push_back(std::make_pair(pair.a, pair.b));
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+	return pairs;
+}
+
+// runs a full pool of particles through update on the given job system (or the calling thread alone), returning milliseconds per update;
+// alive is the count left after the timed updates, which outlive them, and survivors the count left once short lived particles have all expired
+static double timeParticleUpdate( const std::shared_ptr<ciri::JobSystem>& jobs, int particles, int& alive, int& survivors ) {
+	ciri::ParticleSystem psys;
+	psys.create(particles);
+	psys.setJobSystem(jobs);
+	ciri::ParticleEmitter& emitter = psys.getEmitter();
+	emitter.velocity.minSpeed = 10.0f;
+	emitter.velocity.maxSpeed = 100.0f;
+	emitter.lifetime.minLifetime = 1000.0f;
+	emitter.lifetime.maxLifetime = 1000.0f;
+	psys.emitParticles(particles);
+
+	const int updates = 100;
+	const long long start = ciri::Profiler::now();
+	for( int i = 0; i < updates; ++i ) {
+		psys.update(1.0f / 60.0f);
+	}
+	const double milliseconds = static_cast<double>(ciri::Profiler::now() - start) / (updates * 1000000.0);
+	alive = psys.getCount();
+
+	// every particle dies within two seconds, which exercises the per chunk dead lists and the swap-remove
+	psys.clear();
+	emitter.lifetime.minLifetime = 0.5f;
+	emitter.lifetime.maxLifetime = 1.5f;
+	psys.emitParticles(particles);
+	for( int i = 0; i < 120; ++i ) {
+		psys.update(1.0f / 60.0f);
+	}
+	survivors = psys.getCount();
+	return milliseconds;
+}
+
+int main( int argc, char** argv ) {
 	// enable memory leak checking
-#ifdef _DEBUG
+#if defined(_WIN32) && defined(_DEBUG)
 	int debugFlag = _CrtSetDbgFlag(_CRTDBG_REPORT_FLAG);
 	debugFlag|= _CRTDBG_LEAK_CHECK_DF;
 	debugFlag |= _CRTDBG_CHECK_ALWAYS_DF;
 	_CrtSetDbgFlag(debugFlag);
 #endif
 
+	// --headless-all <frames> runs every demo on the null device and prints binds issued vs. binds a backend would forward;
+	// a demo fails if it can't run or prints that something failed to load, and the demo's own output is echoed above its row
+	if( argc >= 3 && 0 == strcmp(argv[1], "--headless-all") ) {
+		printf("%-12s %10s %10s %10s %14s\n", "demo", "issued", "forwarded", "skipped", "load failures");
+		int failedDemos = 0;
+		for( int i = 0; i < static_cast<int>(Demo::Count); ++i ) {
+			ciri::GraphicsCommandStream stream;
+			bool ran = false;
+			std::string output;
+			{
+				StdoutCapture capture;
+				std::unique_ptr<ciri::App> demo = createGame(static_cast<Demo>(i));
+				ran = demo->runHeadless(atoi(argv[2]), &stream);
+				demo.reset();
+				output = capture.output();
+			}
+			printf("%s", output.c_str());
+			const int loadFailures = countLoadFailures(output);
+			failedDemos += (!ran || loadFailures > 0) ? 1 : 0;
+			if( !ran ) {
+				printf("%-12s failed to run headless\n", DEMO_NAMES[i]);
+				continue;
+			}
+			const ciri::GraphicsCounters& counters = stream.getCounters();
+			printf("%-12s %10d %10d %10d %14d\n", DEMO_NAMES[i], counters.stateChanges + counters.redundantBinds, counters.stateChanges, counters.redundantBinds, loadFailures);
+		}
+		printf("demos failing: %d\n", failedDemos);
+		return (0 == failedDemos) ? 0 : 1;
+	}
+
+	// --constant-ring-bench <frames> runs every demo on the null device with and without the constant ring and prints the constant work per draw
+	if( argc >= 3 && 0 == strcmp(argv[1], "--constant-ring-bench") ) {
+		printf("%-12s %8s %16s %16s %12s %12s\n", "demo", "draws", "updates/draw", "ring updates/draw", "ring binds", "ring bytes");
+		for( int i = 0; i < static_cast<int>(Demo::Count); ++i ) {
+			ciri::GraphicsCounters runs[2];
+			bool ok = true;
+			for( int ring = 0; ring < 2 && ok; ++ring ) {
+				ciri::GraphicsCommandStream stream;
+				std::unique_ptr<ciri::App> demo = createGame(static_cast<Demo>(i));
+				demo->getConfig().constantRingSize = ring ? 1024 * 1024 : 0;
+				ok = demo->runHeadless(atoi(argv[2]), &stream);
+				runs[ring] = stream.getCounters();
+			}
+			if( !ok ) {
+				printf("%-12s failed to run headless\n", DEMO_NAMES[i]);
+				continue;
+			}
+			// updates are buffers the driver must rename or stall on; ring binds are suballocations bound by offset
+			const double draws = (runs[0].drawCalls > 0) ? static_cast<double>(runs[0].drawCalls) : 1.0;
+			printf("%-12s %8d %16.2f %16.2f %12d %12lld\n", DEMO_NAMES[i], runs[0].drawCalls, runs[0].constantUpdates / draws,
+				runs[1].constantUpdates / draws, runs[1].constantRangeBinds, runs[1].constantRingBytes);
+		}
+		return 0;
+	}
+
+	// --vertex-report <obj> prints the size and precision of the compact vertex layout for a model
+	if( argc >= 3 && 0 == strcmp(argv[1], "--vertex-report") ) {
+		Model model;
+		if( !model.addFromObj(argv[2], true) || !model.computeNormals() || !model.computeTangents() ) {
+			printf("ciri error: Failed to load %s\n", argv[2]);
+			return 1;
+		}
+		const Model::CompactReport report = model.measureCompactError();
+		printf("vertex bytes (full/compact): %d/%d\n", report.fullBytes, report.compactBytes);
+		printf("max normal error: %f deg\n", report.maxNormalError);
+		printf("max tangent error: %f deg\n", report.maxTangentError);
+		printf("max texcoord error: %f\n", report.maxTexcoordError);
+		return 0;
+	}
+
+	// --profiler-bench <iterations> prints the cost of a profile scope while the profiler is disabled and enabled
+	if( argc >= 3 && 0 == strcmp(argv[1], "--profiler-bench") ) {
+		const int iterations = atoi(argv[2]);
+		ciri::Profiler::setEnabled(false);
+		const double empty = timeProfileLoop(iterations, false);
+		const double disabled = timeProfileLoop(iterations, true);
+		ciri::Profiler::setEnabled(true);
+		const double enabled = timeProfileLoop(iterations, true);
+		ciri::Profiler::setEnabled(false);
+		ciri::Profiler::reset();
+		printf("ns per iteration (no scope/disabled/enabled): %.2f/%.2f/%.2f\n", empty, disabled, enabled);
+		printf("scope overhead disabled: %.2f ns, enabled: %.2f ns\n", disabled - empty, enabled - empty);
+		return 0;
+	}
+
+	// --profile-trace <frames> <file> runs the shadows demo on the null device with the profiler on and writes a chrome trace of every frame
+	if( argc >= 4 && 0 == strcmp(argv[1], "--profile-trace") ) {
+		const int frames = atoi(argv[2]);
+		ciri::Profiler::setTraceFrames(frames);
+		std::unique_ptr<ciri::App> demo = createGame(Demo::Shadows);
+		demo->getConfig().profile = true;
+		if( !demo->runHeadless(frames) ) {
+			printf("ciri error: Game failed to run headless!\n");
+			return 1;
+		}
+		if( !ciri::Profiler::writeChromeTrace(argv[3]) ) {
+			printf("ciri error: Failed to write trace to %s\n", argv[3]);
+			return 1;
+		}
+		return 0;
+	}
+
+	// --shader-cache-bench <directory> starts every demo on the real device without a shader cache, then twice with one in the given directory,
+	// and prints the time to the first frame with the cache cold and warm.  Drivers keep caches of their own, so cold is only cold on a fresh driver cache.
+	if( argc >= 3 && 0 == strcmp(argv[1], "--shader-cache-bench") ) {
+		printf("%-12s %10s %10s %8s\n", "demo", "cold ms", "warm ms", "speedup");
+		for( int i = 0; i < static_cast<int>(Demo::Count); ++i ) {
+			// the first run compiles everything, the second stores it, and the third should compile nothing
+			double seconds[3] = {0.0, 0.0, 0.0};
+			bool ok = true;
+			for( int run = 0; run < 3 && ok; ++run ) {
+				std::unique_ptr<ciri::App> demo = createGame(static_cast<Demo>(i));
+				demo->getConfig().shaderCacheDirectory = (0 == run) ? "" : argv[2];
+				demo->getConfig().frameLimit = 1;
+				ok = demo->run();
+				seconds[run] = demo->getStartupSeconds();
+			}
+			if( !ok ) {
+				printf("%-12s failed to run\n", DEMO_NAMES[i]);
+				continue;
+			}
+			const double warm = (seconds[2] > 0.0) ? seconds[2] : 1.0;
+			printf("%-12s %10.1f %10.1f %7.2fx\n", DEMO_NAMES[i], seconds[0] * 1000.0, seconds[2] * 1000.0, seconds[0] / warm);
+		}
+		return 0;
+	}
+
+	// --render-graph-report <frames> runs the deferred demo on the null device with a target per buffer and with the render graph, with and without
+	// its debug view, and prints the most render target memory allocated at once and the render target binds per frame
+	if( argc >= 3 && 0 == strcmp(argv[1], "--render-graph-report") ) {
+		printf("%-8s %-6s %10s %12s\n", "targets", "debug", "peak MB", "binds/frame");
+		for( int debug = 0; debug < 2; ++debug ) {
+			for( int graph = 0; graph < 2; ++graph ) {
+				ciri::GraphicsCommandStream stream;
+				std::unique_ptr<DeferredDemo> demo(new DeferredDemo(graph != 0));
+				demo->setDebugView(debug != 0);
+				if( !demo->runHeadless(atoi(argv[2]), &stream) ) {
+					printf("%-8s %-6s failed to run headless\n", graph ? "graph" : "fixed", debug ? "on" : "off");
+					continue;
+				}
+				const ciri::GraphicsCounters& counters = stream.getCounters();
+				const double frames = (counters.frames > 0) ? static_cast<double>(counters.frames) : 1.0;
+				printf("%-8s %-6s %10.2f %12.2f\n", graph ? "graph" : "fixed", debug ? "on" : "off", static_cast<double>(counters.peakRenderTargetBytes) / (1024.0 * 1024.0),
+					counters.renderTargetChanges / frames);
+			}
+		}
+		return 0;
+	}
+
+	// --shadow-bench <frames> runs the shadows demo on the null device, animated and still, drawing every shadow map every frame and keeping maps
+	// that did not change, and prints the cpu time spent planning the maps, the maps and casters drawn, and the draws and render target binds per frame.
+	// It fails unless caching a still scene draws fewer maps than it plans
+	if( argc >= 3 && 0 == strcmp(argv[1], "--shadow-bench") ) {
+		printf("%-8s %-8s %10s %8s %8s %12s %12s %12s %10s\n", "scene", "maps", "setup us", "planned", "drawn", "casters", "draws/frame", "binds/frame", "peak MB");
+		int failures = 0;
+		for( int animate = 1; animate >= 0; --animate ) {
+			for( int cache = 0; cache < 2; ++cache ) {
+				ciri::GraphicsCommandStream stream;
+				std::unique_ptr<ShadowsDemo> demo(new ShadowsDemo(cache != 0));
+				demo->setAnimateObjects(animate != 0);
+				if( !demo->runHeadless(atoi(argv[2]), &stream) ) {
+					printf("%-8s %-8s failed to run headless\n", animate ? "animated" : "still", cache ? "cached" : "redrawn");
+					failures += 1;
+					continue;
+				}
+				const ShadowMapper::Stats& shadows = demo->getShadowStats();
+				const ciri::GraphicsCounters& counters = stream.getCounters();
+				const double frames = (shadows.frames > 0) ? static_cast<double>(shadows.frames) : 1.0;
+				printf("%-8s %-8s %10.2f %8.2f %8.2f %12.2f %12.2f %12.2f %10.2f\n", animate ? "animated" : "still", cache ? "cached" : "redrawn",
+					static_cast<double>(shadows.setupNanoseconds) / (frames * 1000.0), shadows.views / frames, shadows.drawnViews / frames, shadows.casterDraws / frames,
+					counters.drawCalls / frames, counters.renderTargetChanges / frames, static_cast<double>(counters.peakRenderTargetBytes) / (1024.0 * 1024.0));
+				if( !animate && cache && shadows.drawnViews >= shadows.views ) {
+					failures += 1;
+				}
+			}
+		}
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --light-cluster-test <lights> bins lights from a few views and checks every cluster against testing every light one at a time,
+	// both on the calling thread and on a job system, then prints the time to bin them each way
+	if( argc >= 3 && 0 == strcmp(argv[1], "--light-cluster-test") ) {
+		const int lightCount = atoi(argv[2]);
+		ciri::LightClusters clusters;
+		ciri::LightClusters reference;
+		clusters.create(16, 9, 24);
+		reference.create(16, 9, 24);
+		clusters.setProjection(60.0f, 16.0f / 9.0f, 0.5f, 500.0f);
+		reference.setProjection(60.0f, 16.0f / 9.0f, 0.5f, 500.0f);
+		addTestLights(clusters, lightCount);
+		addTestLights(reference, lightCount);
+
+		const cc::Mat4f views[] = {
+			cc::math::lookAtRH(cc::Vec3f(0.0f, 0.0f, 0.0f), cc::Vec3f(0.0f, 0.0f, -1.0f), cc::Vec3f(0.0f, 1.0f, 0.0f)),
+			cc::math::lookAtRH(cc::Vec3f(40.0f, 20.0f, 100.0f), cc::Vec3f(-30.0f, 0.0f, -50.0f), cc::Vec3f(0.0f, 1.0f, 0.0f)),
+			cc::math::lookAtRH(cc::Vec3f(-150.0f, 60.0f, -20.0f), cc::Vec3f(100.0f, -40.0f, 30.0f), cc::Vec3f(0.0f, 1.0f, 0.0f))
+		};
+		// at least four threads so the threaded build is checked on small machines too
+		std::shared_ptr<ciri::JobSystem> jobs = std::make_shared<ciri::JobSystem>();
+		jobs->create(std::max(4, static_cast<int>(std::thread::hardware_concurrency())));
+		int mismatches = 0;
+		for( const auto& view : views ) {
+			for( int threads = 0; threads < 2; ++threads ) {
+				clusters.setJobSystem((0 == threads) ? jobs : nullptr); // job system, then calling thread
+				clusters.build(view);
+				reference.buildReference(view);
+				mismatches += countClusterMismatches(clusters, reference);
+			}
+		}
+
+		const int iterations = 100;
+		double milliseconds[2] = {0.0, 0.0};
+		for( int threads = 0; threads < 2; ++threads ) {
+			clusters.setJobSystem((0 == threads) ? nullptr : jobs);
+			const long long start = ciri::Profiler::now();
+			for( int i = 0; i < iterations; ++i ) {
+				clusters.build(views[i % 3]);
+			}
+			milliseconds[threads] = static_cast<double>(ciri::Profiler::now() - start) / (iterations * 1000000.0);
+		}
+
+		int maxPerCluster = 0;
+		for( int c = 0; c < clusters.getClusterCount(); ++c ) {
+			maxPerCluster = std::max(maxPerCluster, clusters.getClusterLightCount(c));
+		}
+		printf("lights: %d, clusters: %d\n", lightCount, clusters.getClusterCount());
+		printf("lights per cluster (mean/max): %.2f/%d\n", static_cast<double>(clusters.getLightIndices().size()) / clusters.getClusterCount(), maxPerCluster);
+		printf("ms per build (one thread/%d job threads): %.3f/%.3f\n", jobs->getThreadCount(), milliseconds[0], milliseconds[1]);
+		printf("clusters differing from brute force: %d\n", mismatches);
+		clusters.setJobSystem(nullptr);
+		jobs->destroy();
+		return (0 == mismatches) ? 0 : 1;
+	}
+
+	// --job-bench <max threads> times parallelFor over 10M elements and a graph of small dependent jobs on 1, 2, 4... threads
+	if( argc >= 3 && 0 == strcmp(argv[1], "--job-bench") ) {
+		const int maxThreads = std::max(1, atoi(argv[2]));
+		std::vector<float> data(10000000);
+		std::vector<unsigned int> results;
+		const int layers = 64;
+		const int jobsPerLayer = 1024;
+		double baseFor = 0.0;
+		double baseGraph = 0.0;
+		unsigned int baseChecksum = 0;
+		bool matches = true;
+		printf("threads  parallelFor ms (speedup)  job graph ms (speedup, us per job)\n");
+		std::vector<int> threadCounts;
+		for( int threads = 1; threads < maxThreads; threads *= 2 ) {
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+		for( const int threads : threadCounts ) {
+			const double forMs = timeParallelFor(threads, data, 0);
+			const double graphMs = timeJobGraph(threads, layers, jobsPerLayer, results);
+			unsigned int checksum = 0;
+			for( const unsigned int value : results ) {
+				checksum = checksum * 31u + value;
+			}
+			if( 1 == threads ) {
+				baseFor = forMs;
+				baseGraph = graphMs;
+				baseChecksum = checksum;
+			}
+			matches = matches && (checksum == baseChecksum);
+			printf("%7d  %14.3f (%.2fx)  %12.3f (%.2fx, %.3f)\n", threads, forMs, baseFor / forMs, graphMs, baseGraph / graphMs, graphMs * 1000.0 / (layers * jobsPerLayer));
+		}
+		printf("job graph results match one thread: %s\n", matches ? "yes" : "no");
+		return matches ? 0 : 1;
+	}
+
+	// --job-stress <rounds> runs parallelFor, nesting, dependency chains, jobs waiting on jobs and outside submitters on several thread counts
+	if( argc >= 3 && 0 == strcmp(argv[1], "--job-stress") ) {
+		const int rounds = atoi(argv[2]);
+		const int threadCounts[] = { 1, 2, 3, 8, static_cast<int>(std::thread::hardware_concurrency()) + 1 };
+		int failures = 0;
+		for( int round = 0; round < rounds; ++round ) {
+			for( const int threads : threadCounts ) {
+				failures += runJobStressRound(threads, static_cast<unsigned int>(round * 7919 + threads));
+			}
+		}
+		printf("rounds: %d, failures: %d\n", rounds, failures);
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --command-list-bench <draws> records the draws into command lists on 1, 2, 4 and 8 threads and executes them on the null device,
+	// timing recording and execution against issuing the same draws directly, and checking every run issues exactly what direct calls would
+	if( argc >= 3 && 0 == strcmp(argv[1], "--command-list-bench") ) {
+		const int draws = std::max(1, atoi(argv[2]));
+		std::shared_ptr<ciri::NullWindow> window = std::make_shared<ciri::NullWindow>();
+		window->create(1280, 720);
+		std::shared_ptr<ciri::NullGraphicsDevice> device = std::make_shared<ciri::NullGraphicsDevice>();
+		if( !device->create(window) ) {
+			printf("failed to create the null device\n");
+			return 1;
+		}
+		DrawBenchScene scene;
+		scene.shader = device->createShader();
+		scene.shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
+		scene.shader->loadFromMemory("", nullptr, "");
+		scene.constants = device->createConstantBuffer();
+		float world[16] = {0.0f};
+		scene.constants->setData(sizeof(world), world);
+		scene.shader->addConstants(scene.constants, "PerObject", ciri::ShaderStage::Vertex);
+		std::vector<float> positions(3 * 24, 0.0f);
+		std::vector<int> indices(36);
+		for( int i = 0; i < 36; ++i ) {
+			indices[i] = i % 24;
+		}
+		for( int m = 0; m < 64; ++m ) {
+			scene.vertexBuffers.push_back(device->createVertexBuffer());
+			scene.vertexBuffers.back()->set(positions.data(), sizeof(float) * 3, 24, false);
+			scene.indexBuffers.push_back(device->createIndexBuffer());
+			scene.indexBuffers.back()->set(indices.data(), 36, false);
+		}
+
+		const int frames = 20;
+		ciri::GraphicsCommandStream& stream = device->getCommandStream();
+		long long start = ciri::Profiler::now();
+		for( int frame = 0; frame < frames; ++frame ) {
+			stream.clear();
+			device->applyShader(scene.shader);
+			issueBenchDraws(device, scene, 0, draws);
+		}
+		const double directMs = static_cast<double>(ciri::Profiler::now() - start) / (frames * 1000000.0);
+		const int commandsPerFrame = static_cast<int>(stream.getCommands().size());
+
+		int failures = 0;
+		printf("draws: %d, commands per frame: %d\n", draws, commandsPerFrame);
+		printf("direct: %.3f ms\n", directMs);
+		printf("%7s %10s %10s %10s %9s\n", "threads", "record ms", "execute ms", "total ms", "matches");
+		const int threadCounts[] = { 1, 2, 4, 8 };
+		for( const int threads : threadCounts ) {
+			ciri::JobSystem jobs;
+			jobs.create(threads);
+			std::vector<std::shared_ptr<ciri::ICommandList>> lists(threads);
+			std::vector<ciri::ICommandList*> listPointers(threads);
+			for( int t = 0; t < threads; ++t ) {
+				lists[t] = device->createCommandList();
+				listPointers[t] = lists[t].get();
+			}
+			long long recordNanoseconds = 0;
+			long long executeNanoseconds = 0;
+			for( int frame = 0; frame < frames; ++frame ) {
+				// each list takes a contiguous slice so executing them in order issues the draws in their original order
+				start = ciri::Profiler::now();
+				jobs.parallelFor(0, threads, 1, [&lists, &scene, draws, threads]( int begin, int end ) {
+					for( int t = begin; t < end; ++t ) {
+						lists[t]->reset();
+						issueBenchDraws(lists[t], scene, static_cast<int>(static_cast<long long>(draws) * t / threads), static_cast<int>(static_cast<long long>(draws) * (t + 1) / threads));
+					}
+				});
+				const long long recorded = ciri::Profiler::now();
+				stream.clear();
+				device->applyShader(scene.shader);
+				device->executeCommandLists(listPointers.data(), threads);
+				executeNanoseconds += ciri::Profiler::now() - recorded;
+				recordNanoseconds += recorded - start;
+			}
+			// a list can't rely on what the list before it bound, so compare against direct calls issued in the same slices
+			const ciri::GraphicsCommandStream executed = stream;
+			stream.clear();
+			device->applyShader(scene.shader);
+			for( int t = 0; t < threads; ++t ) {
+				issueBenchDraws(device, scene, static_cast<int>(static_cast<long long>(draws) * t / threads), static_cast<int>(static_cast<long long>(draws) * (t + 1) / threads));
+			}
+			const bool matches = (-1 == ciri::GraphicsCommandStream::findFirstDifference(stream, executed));
+			failures += matches ? 0 : 1;
+			const double recordMs = static_cast<double>(recordNanoseconds) / (frames * 1000000.0);
+			const double executeMs = static_cast<double>(executeNanoseconds) / (frames * 1000000.0);
+			printf("%7d %10.3f %10.3f %10.3f %9s\n", threads, recordMs, executeMs, recordMs + executeMs, matches ? "yes" : "no");
+			jobs.destroy();
+		}
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --cull-bench <boxes> culls boxes scattered around a turning camera with FrustumCuller and box by box against the BoundingFrustum planes,
+	// timing both and checking that they agree on every box not within rounding of a plane
+	if( argc >= 3 && 0 == strcmp(argv[1], "--cull-bench") ) {
+		const int count = std::max(1, atoi(argv[2]));
+		unsigned int seed = 1;
+		const auto next = [&seed]() {
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<float>(seed >> 8) / 16777216.0f;
+		};
+		std::vector<cc::Vec3f> centers(count);
+		std::vector<cc::Vec3f> extents(count);
+		ciri::BoundingBoxArray boxes;
+		boxes.reserve(count);
+		for( int i = 0; i < count; ++i ) {
+			centers[i] = cc::Vec3f(next() * 2000.0f - 1000.0f, next() * 400.0f - 200.0f, next() * 2000.0f - 1000.0f);
+			extents[i] = cc::Vec3f(0.5f + next() * 4.5f, 0.5f + next() * 4.5f, 0.5f + next() * 4.5f);
+			boxes.add(ciri::BoundingBox(centers[i] - extents[i], centers[i] + extents[i]));
+		}
+
+		const int frames = 32;
+		const cc::Mat4f proj = cc::math::perspectiveRH(60.0f, 16.0f / 9.0f, 0.5f, 1000.0f);
+		ciri::FrustumCuller culler;
+		std::vector<int> visible;
+		std::vector<int> expected;
+		long long soaNanoseconds = 0;
+		long long scalarNanoseconds = 0;
+		long long visibleTotal = 0;
+		int mismatches = 0;
+		for( int frame = 0; frame < frames; ++frame ) {
+			// a slow turn, so that most groups keep the plane that rejected them last frame
+			const float angle = static_cast<float>(frame) * 0.02f;
+			const cc::Vec3f eye(0.0f, 20.0f, 0.0f);
+			const cc::Mat4f viewProj = proj * cc::math::lookAtRH(eye, eye + cc::Vec3f(sinf(angle), -0.1f, -cosf(angle)), cc::Vec3f(0.0f, 1.0f, 0.0f));
+			const ciri::BoundingFrustum frustum(viewProj);
+
+			long long start = ciri::Profiler::now();
+			culler.setFrustum(frustum);
+			culler.cull(boxes, visible);
+			soaNanoseconds += ciri::Profiler::now() - start;
+
+			start = ciri::Profiler::now();
+			expected.clear();
+			for( int i = 0; i < count; ++i ) {
+				if( boxFrustumMargin(frustum, centers[i], extents[i]) >= 0.0f ) {
+					expected.push_back(i);
+				}
+			}
+			scalarNanoseconds += ciri::Profiler::now() - start;
+			visibleTotal += static_cast<long long>(visible.size());
+
+			// both lists are ascending, so walk them together; disagreements within rounding of a plane are allowed
+			size_t a = 0;
+			size_t b = 0;
+			while( a < visible.size() || b < expected.size() ) {
+				const int lhs = (a < visible.size()) ? visible[a] : count;
+				const int rhs = (b < expected.size()) ? expected[b] : count;
+				if( lhs == rhs ) {
+					++a;
+					++b;
+					continue;
+				}
+				const int index = std::min(lhs, rhs);
+				mismatches += (fabsf(boxFrustumMargin(frustum, centers[index], extents[index])) > 0.001f) ? 1 : 0;
+				a += (lhs == index) ? 1 : 0;
+				b += (rhs == index) ? 1 : 0;
+			}
+		}
+
+		printf("boxes: %d, frames: %d, visible per frame: %.1f\n", count, frames, static_cast<double>(visibleTotal) / frames);
+		printf("ms per cull (FrustumCuller/box by box): %.3f/%.3f\n", static_cast<double>(soaNanoseconds) / (frames * 1000000.0),
+			static_cast<double>(scalarNanoseconds) / (frames * 1000000.0));
+		printf("boxes differing from box by box: %d\n", mismatches);
+		return (0 == mismatches) ? 0 : 1;
+	}
+
+	// --vao-bench <meshes> [frames] draws thousands of small meshes, each with its own buffers, on the platform's device and prints per frame
+	// how many vertex attributes were specified against how many vertex inputs were bound; only the first frame should specify attributes
+	if( argc >= 3 && 0 == strcmp(argv[1], "--vao-bench") ) {
+		const int meshCount = std::max(1, atoi(argv[2]));
+		const int frames = (argc >= 4) ? std::max(2, atoi(argv[3])) : 5;
+		std::shared_ptr<ciri::IWindow> window = ciri::createWindow();
+		if( !window->create(1280, 720) ) {
+			printf("failed to create the window\n");
+			return 1;
+		}
+		std::shared_ptr<ciri::IGraphicsDevice> device = ciri::createGraphicsDevice();
+		if( !device->create(window) ) {
+			printf("failed to create the graphics device\n");
+			return 1;
+		}
+		std::unique_ptr<SimpleShader> shader(new SimpleShader());
+		if( !shader->create(device) ) {
+			printf("failed to create the shader\n");
+			return 1;
+		}
+		// position, normal, tangent and texcoord to match the simple shader's four attributes
+		std::vector<float> vertices(3 * 12, 0.0f);
+		int indices[3] = { 0, 1, 2 };
+		std::vector<std::shared_ptr<ciri::IVertexBuffer>> vertexBuffers(meshCount);
+		std::vector<std::shared_ptr<ciri::IIndexBuffer>> indexBuffers(meshCount);
+		for( int i = 0; i < meshCount; ++i ) {
+			vertexBuffers[i] = device->createVertexBuffer();
+			vertexBuffers[i]->set(vertices.data(), sizeof(float) * 12, 3, false);
+			indexBuffers[i] = device->createIndexBuffer();
+			indexBuffers[i]->set(indices, 3, false);
+		}
+
+		printf("device: %s, meshes: %d\n", device->getApiInfo(), meshCount);
+		printf("%5s %16s %19s %8s\n", "frame", "attribute setups", "vertex input binds", "cpu ms");
+		int failures = 0;
+		for( int frame = 0; frame < frames; ++frame ) {
+			const long long start = ciri::Profiler::now();
+			device->applyShader(shader->getShader());
+			for( int i = 0; i < meshCount; ++i ) {
+				device->setVertexBuffer(vertexBuffers[i]);
+				device->setIndexBuffer(indexBuffers[i]);
+				device->drawIndexed(ciri::PrimitiveTopology::TriangleList, 3);
+			}
+			const double cpuMs = static_cast<double>(ciri::Profiler::now() - start) / 1000000.0;
+			device->present();
+			const int setups = device->getVertexAttributeSetupCount();
+			printf("%5d %16d %19d %8.3f\n", frame, setups, device->getVertexInputBindCount(), cpuMs);
+			failures += (frame > 0 && setups != 0) ? 1 : 0;
+		}
+		device->destroy();
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --mesh-pool-test packs the demo models and one mesh too big for 16-bit indices into mesh pools on the null device, draws every mesh,
+	// and checks the index bytes uploaded per page, that each draw lands on its own range, and that ranges outside a page are rejected
+	if( argc >= 2 && 0 == strcmp(argv[1], "--mesh-pool-test") ) {
+		std::shared_ptr<ciri::NullWindow> window = std::make_shared<ciri::NullWindow>();
+		window->create(1280, 720);
+		std::shared_ptr<ciri::NullGraphicsDevice> device = std::make_shared<ciri::NullGraphicsDevice>();
+		if( !device->create(window) ) {
+			printf("failed to create the null device\n");
+			return 1;
+		}
+		std::shared_ptr<ciri::IShader> shader = device->createShader();
+		shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Position, 0));
+		shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float3, ciri::VertexUsage::Normal, 0));
+		shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float4, ciri::VertexUsage::Tangent, 0));
+		shader->addInputElement(ciri::VertexElement(ciri::VertexFormat::Float2, ciri::VertexUsage::Texcoord, 0));
+		shader->loadFromMemory("", nullptr, "");
+
+		const char* files[] = {
+			"dynvb/flag-pole.obj",
+			"data/demos/shadows/ground.obj",
+			"data/demos/shadows/helicopter_body.obj",
+			"data/demos/shadows/helicopter_blades.obj",
+			"data/demos/shadows/helicopter_tail.obj",
+			"data/demos/shadows/sphere.obj",
+			"data/demos/playground/frigate.obj"
+		};
+		std::vector<Model> models;
+		for( const char* file : files ) {
+			models.push_back(Model());
+			if( !models.back().addFromObj(file) ) {
+				printf("failed to load %s\n", file);
+				return 1;
+			}
+			indexModel(models.back());
+		}
+		// a strip of quads with more vertices than 16-bit indices can reach
+		models.push_back(Model());
+		Model& big = models.back();
+		const int bigQuads = 20000;
+		for( int i = 0; i <= bigQuads; ++i ) {
+			for( int j = 0; j < 4; ++j ) {
+				big.getVertices().push_back(Vertex(cc::Vec3f(static_cast<float>(i), static_cast<float>(j), 0.0f), cc::Vec3f(0.0f, 0.0f, 1.0f), cc::Vec2f(0.0f, 0.0f)));
+			}
+		}
+		for( int i = 0; i < bigQuads; ++i ) {
+			const int quad[6] = { i * 4, i * 4 + 1, i * 4 + 4, i * 4 + 1, i * 4 + 5, i * 4 + 4 };
+			big.getIndices().insert(big.getIndices().end(), quad, quad + 6);
+		}
+
+		// the demo models share pages and stay 16-bit; the big mesh gets a pool of its own so only its page needs 32-bit indices
+		int failures = 0;
+		const int bigModel = static_cast<int>(models.size()) - 1;
+		for( int pass = 0; pass < 2; ++pass ) {
+			const int first = (0 == pass) ? 0 : bigModel;
+			const int last = (0 == pass) ? bigModel : bigModel + 1;
+			MeshPool pool;
+			std::vector<int> meshes;
+			std::vector<int> pageIndices;
+			std::vector<int> pageMaxIndex;
+			long long indexTotal = 0;
+			for( int m = first; m < last; ++m ) {
+				meshes.push_back(pool.add(models[m]));
+				const MeshPool::Mesh& mesh = pool.getMesh(meshes.back());
+				if( mesh.page >= static_cast<int>(pageIndices.size()) ) {
+					pageIndices.push_back(0);
+					pageMaxIndex.push_back(0);
+				}
+				pageIndices[mesh.page] += mesh.indexCount;
+				for( const int index : models[m].getIndices() ) {
+					pageMaxIndex[mesh.page] = std::max(pageMaxIndex[mesh.page], index);
+				}
+				indexTotal += mesh.indexCount;
+			}
+
+			ciri::GraphicsCommandStream& stream = device->getCommandStream();
+			stream.clear();
+			if( !pool.build(device) ) {
+				printf("failed to build the mesh pool\n");
+				return 1;
+			}
+			long long expectedBytes = 0;
+			int widePages = 0;
+			for( unsigned int page = 0; page < pageIndices.size(); ++page ) {
+				const bool wide = pageMaxIndex[page] > 65535;
+				expectedBytes += static_cast<long long>(pageIndices[page]) * (wide ? 4 : 2);
+				widePages += wide ? 1 : 0;
+			}
+			const long long uploadedBytes = stream.getCounters().indexBytesUploaded;
+			failures += (uploadedBytes != expectedBytes || widePages != pass) ? 1 : 0;
+			printf("%s: meshes: %d, pages: %d (%d 32-bit), indices: %lld\n", (0 == pass) ? "demo models" : "big mesh", pool.getMeshCount(), pool.getPageCount(), widePages, indexTotal);
+			printf("  index bytes uploaded: %lld, expected: %lld, as 32-bit: %lld\n", uploadedBytes, expectedBytes, indexTotal * 4);
+
+			// every mesh draws its own range of its page
+			stream.clear();
+			device->applyShader(shader);
+			int misplaced = 0;
+			for( const int handle : meshes ) {
+				const MeshPool::Mesh& mesh = pool.getMesh(handle);
+				pool.draw(device, handle);
+				const ciri::GraphicsCommand& command = stream.getCommands().back();
+				const bool placed = (ciri::GraphicsCommandType::DrawIndexed == command.type) && command.args[1] == mesh.indexCount && command.args[2] == mesh.startIndex && command.args[3] == mesh.baseVertex;
+				misplaced += placed ? 0 : 1;
+			}
+			const int drawCalls = stream.getCounters().drawCalls;
+			failures += (drawCalls != static_cast<int>(meshes.size()) || misplaced != 0) ? 1 : 0;
+			printf("  draws: %d of %d, misplaced: %d\n", drawCalls, static_cast<int>(meshes.size()), misplaced);
+
+			// ranges running past the end of the page's index or vertex buffer must be dropped
+			const MeshPool::Mesh& lastMesh = pool.getMesh(meshes.back());
+			const int pageVertices = pool.getVertexBuffer(lastMesh.page)->getVertexCount();
+			device->setVertexBuffer(pool.getVertexBuffer(lastMesh.page));
+			device->setIndexBuffer(pool.getIndexBuffer(lastMesh.page));
+			device->drawIndexed(ciri::PrimitiveTopology::TriangleList, lastMesh.indexCount + 3, lastMesh.startIndex, lastMesh.baseVertex);
+			device->drawIndexed(ciri::PrimitiveTopology::TriangleList, 3, pageIndices[lastMesh.page], lastMesh.baseVertex);
+			device->drawIndexed(ciri::PrimitiveTopology::TriangleList, lastMesh.indexCount, lastMesh.startIndex, pageVertices);
+			device->drawIndexed(ciri::PrimitiveTopology::TriangleList, lastMesh.indexCount, -3, lastMesh.baseVertex);
+			const int accepted = stream.getCounters().drawCalls - drawCalls;
+			failures += (accepted != 0) ? 1 : 0;
+			printf("  out of range draws accepted: %d of 4\n", accepted);
+			pool.clean();
+		}
+		device->destroy();
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --terrain-prep-bench <size> [threads] runs the terrain preprocessing on a size x size heightmap the old way (2D box filter, normals summed
+	// from triangles) and through terrainprep on the calling thread and on a job system, printing the timings and how far the results differ.
+	// It fails unless the job system matches one thread exactly and every pass is within tolerance of a scalar reference of the same math
+	if( argc >= 3 && 0 == strcmp(argv[1], "--terrain-prep-bench") ) {
+		const int size = std::max(3, atoi(argv[2]));
+		ciri::JobSystem jobs;
+		jobs.create((argc >= 4) ? atoi(argv[3]) : 0);
+		const auto milliseconds = []( long long start ) {
+			return static_cast<double>(ciri::Profiler::now() - start) / 1000000.0;
+		};
+		std::vector<float> heights;
+		makeTestHeights(heights, size);
+		const size_t texels = heights.size();
+
+		// box filter; the old filter is only expected to match away from the first and last columns
+		std::vector<float> reference(texels);
+		long long start = ciri::Profiler::now();
+		referenceBoxFilter(heights.data(), reference.data(), size, size);
+		const double oldFilterMs = milliseconds(start);
+		std::vector<float> filtered(texels);
+		start = ciri::Profiler::now();
+		terrainprep::boxFilter3x3(heights.data(), filtered.data(), size, size, true, nullptr);
+		const double serialFilterMs = milliseconds(start);
+		const unsigned long long serialFilterHash = hashFloats(filtered);
+		start = ciri::Profiler::now();
+		terrainprep::boxFilter3x3(heights.data(), filtered.data(), size, size, true, &jobs);
+		const double jobsFilterMs = milliseconds(start);
+		const bool filterMatches = (hashFloats(filtered) == serialFilterHash);
+		float filterError = 0.0f;
+		for( int y = 0; y < size; ++y ) {
+			for( int x = 1; x < size - 1; ++x ) {
+				const size_t i = static_cast<size_t>(y) * size + x;
+				filterError = std::max(filterError, fabsf(filtered[i] - reference[i]));
+			}
+		}
+		std::vector<float>().swap(reference);
+		std::vector<float>().swap(heights);
+
+		// normals; the old ones average the triangles around a vertex, so they differ from central differences by the terrain's roughness
+		std::vector<cc::Vec3f> referenceNormals;
+		start = ciri::Profiler::now();
+		referenceTriangleNormals(filtered.data(), size, size, referenceNormals);
+		const double oldNormalsMs = milliseconds(start);
+		const int stride = 7; // normal then tangent, as interleaved in a vertex
+		std::vector<float> frames(texels * stride);
+		start = ciri::Profiler::now();
+		terrainprep::computeNormalsAndTangents(filtered.data(), size, size, 1.0f, -1.0f, -1.0f, &frames[0], &frames[3], stride, nullptr);
+		const double serialNormalsMs = milliseconds(start);
+		const unsigned long long serialNormalsHash = hashFloats(frames);
+		start = ciri::Profiler::now();
+		terrainprep::computeNormalsAndTangents(filtered.data(), size, size, 1.0f, -1.0f, -1.0f, &frames[0], &frames[3], stride, &jobs);
+		const double jobsNormalsMs = milliseconds(start);
+		const bool normalsMatch = (hashFloats(frames) == serialNormalsHash);
+		double maxAngle = 0.0;
+		double sumAngle = 0.0;
+		float normalError = 0.0f;
+		float tangentError = 0.0f;
+		for( int y = 0; y < size; ++y ) {
+			for( int x = 0; x < size; ++x ) {
+				const size_t i = static_cast<size_t>(y) * size + x;
+				const cc::Vec3f normal(frames[i * stride], frames[i * stride + 1], frames[i * stride + 2]);
+				const float cosine = std::min(1.0f, std::max(-1.0f, normal.dot(referenceNormals[i])));
+				const double angle = acos(static_cast<double>(cosine)) * 180.0 / 3.14159265358979;
+				maxAngle = std::max(maxAngle, angle);
+				sumAngle += angle;
+
+				float expectedNormal[3];
+				float expectedTangent[4];
+				referenceNormalAndTangent(filtered.data(), size, size, x, y, 1.0f, -1.0f, -1.0f, expectedNormal, expectedTangent);
+				for( int c = 0; c < 3; ++c ) {
+					normalError = std::max(normalError, fabsf(frames[i * stride + c] - expectedNormal[c]));
+				}
+				for( int c = 0; c < 4; ++c ) {
+					tangentError = std::max(tangentError, fabsf(frames[i * stride + 3 + c] - expectedTangent[c]));
+				}
+			}
+		}
+		std::vector<cc::Vec3f>().swap(referenceNormals);
+		std::vector<float>().swap(frames);
+
+		// splat weights over bands spanning the test heights, which run from about 12 to 188
+		const float splatCenters[4] = {20.0f, 80.0f, 140.0f, 190.0f};
+		const float splatWidths[4] = {50.0f, 40.0f, 40.0f, 40.0f};
+		std::vector<float> weights(texels * 4);
+		start = ciri::Profiler::now();
+		terrainprep::computeSplatWeights(filtered.data(), static_cast<int>(texels), splatCenters, splatWidths, weights.data(), 4, nullptr);
+		const double serialSplatMs = milliseconds(start);
+		const unsigned long long serialSplatHash = hashFloats(weights);
+		start = ciri::Profiler::now();
+		terrainprep::computeSplatWeights(filtered.data(), static_cast<int>(texels), splatCenters, splatWidths, weights.data(), 4, &jobs);
+		const double jobsSplatMs = milliseconds(start);
+		const bool splatMatches = (hashFloats(weights) == serialSplatHash);
+		float splatError = 0.0f;
+		for( size_t i = 0; i < texels; ++i ) {
+			float expected[4];
+			referenceSplatWeights(filtered[i], splatCenters, splatWidths, expected);
+			for( int l = 0; l < 4; ++l ) {
+				splatError = std::max(splatError, fabsf(weights[i * 4 + l] - expected[l]));
+			}
+		}
+
+		// float results against double precision references of the same math; a few ulps of a unit value
+		const float TOLERANCE = 1e-5f;
+		const bool withinTolerance = filterError < 0.001f && normalError < TOLERANCE && tangentError < TOLERANCE && splatError < TOLERANCE;
+
+		printf("heightmap: %dx%d, job threads: %d\n", size, size, jobs.getThreadCount());
+		printf("%-12s %10s %12s %10s  %s\n", "pass", "old ms", "1 thread ms", "jobs ms", "difference from old");
+		printf("%-12s %10.1f %12.1f %10.1f  %.6f max, inner columns\n", "box filter", oldFilterMs, serialFilterMs, jobsFilterMs, filterError);
+		printf("%-12s %10.1f %12.1f %10.1f  %.3f/%.3f degrees mean/max\n", "normals", oldNormalsMs, serialNormalsMs, jobsNormalsMs, sumAngle / static_cast<double>(texels), maxAngle);
+		printf("%-12s %10s %12.1f %10.1f\n", "splat", "-", serialSplatMs, jobsSplatMs);
+		printf("max difference from scalar reference (tolerance %g): normals %g, tangents %g, splat weights %g\n", TOLERANCE, normalError, tangentError, splatError);
+		printf("job system results match one thread: %s\n", (filterMatches && normalsMatch && splatMatches) ? "yes" : "no");
+		jobs.destroy();
+		return (filterMatches && normalsMatch && splatMatches && withinTolerance) ? 0 : 1;
+	}
+
+	// --terrain-test draws the heightmap terrain on the null device from fixed cameras, checking the drawn triangles against the quadtree's
+	// selection, that each page's vertex buffer is bound at most once, and that skirts cover every gap between neighbouring levels
+	if( argc >= 2 && 0 == strcmp(argv[1], "--terrain-test") ) {
+		std::shared_ptr<ciri::NullWindow> window = std::make_shared<ciri::NullWindow>();
+		window->create(1280, 720);
+		std::shared_ptr<ciri::NullGraphicsDevice> device = std::make_shared<ciri::NullGraphicsDevice>();
+		ciri::TGA heightmap;
+		if( !device->create(window) || !heightmap.loadFromFile("terrain/heightmap.tga", false) ) {
+			printf("failed to create the null device or load terrain/heightmap.tga; run from test/bin\n");
+			return 1;
+		}
+		HeightmapTerrain terrain;
+		if( !terrain.generate(heightmap, device) ) {
+			printf("failed to generate the terrain\n");
+			return 1;
+		}
+		std::shared_ptr<ciri::ITexture2D> texture = device->createTexture2D(1, 1, ciri::TextureFormat::RGBA32_UINT, 0);
+		terrain.setTextures(texture, texture, texture, texture);
+		terrain.setLodParams(2.0f, 60.0f, 720.0f);
+
+		const cc::Vec3f cameras[][2] = {
+			{ cc::Vec3f(0.0f, 600.0f, 600.0f), cc::Vec3f(0.0f, 0.0f, 0.0f) },
+			{ cc::Vec3f(-400.0f, 120.0f, 300.0f), cc::Vec3f(300.0f, 50.0f, -300.0f) },
+			{ cc::Vec3f(0.0f, 220.0f, 0.0f), cc::Vec3f(200.0f, 100.0f, -200.0f) },
+			{ cc::Vec3f(500.0f, 150.0f, -500.0f), cc::Vec3f(0.0f, 0.0f, 0.0f) }
+		};
+		const cc::Mat4f proj = cc::math::perspectiveRH(60.0f, 1280.0f / 720.0f, 0.5f, 5000.0f);
+		const TerrainQuadtree& quadtree = terrain.getQuadtree();
+		int failures = 0;
+		printf("patches: %d, pages: %d\n", quadtree.getPatchCount(), terrain.getPageCount());
+		printf("%6s %8s %10s %8s %8s %8s\n", "camera", "patches", "triangles", "draws", "vb binds", "cracks");
+		for( int c = 0; c < 4; ++c ) {
+			const cc::Mat4f viewProj = proj * cc::math::lookAtRH(cameras[c][0], cameras[c][1], cc::Vec3f(0.0f, 1.0f, 0.0f));
+			device->getCommandStream().clear();
+			terrain.draw(viewProj, cameras[c][0], device);
+			const ciri::GraphicsCounters& counters = device->getCommandStream().getCounters();
+			int vertexBufferBinds = 0;
+			for( const ciri::GraphicsCommand& command : device->getCommandStream().getCommands() ) {
+				vertexBufferBinds += (ciri::GraphicsCommandType::SetVertexBuffer == command.type) ? 1 : 0;
+			}
+			const int cracks = countTerrainCracks(quadtree);
+			printf("%6d %8d %10d %8d %8d %8d\n", c, quadtree.getVisiblePatchCount(), quadtree.getVisibleTriangleCount(), counters.drawCalls, vertexBufferBinds, cracks);
+			failures += (counters.drawCalls == quadtree.getVisiblePatchCount()) ? 0 : 1;
+			failures += (counters.verticesSubmitted == 3LL * quadtree.getVisibleTriangleCount()) ? 0 : 1;
+			failures += (vertexBufferBinds <= terrain.getPageCount()) ? 0 : 1;
+			failures += (0 == cracks && quadtree.getVisiblePatchCount() > 0) ? 0 : 1;
+		}
+		terrain.clean();
+		printf("failures: %d\n", failures);
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --spatial-hash-bench <frames> moves 10k bullets and 2k enemies through a SpatialHash2D each frame, timing the moves and pair search against
+	// brute force, then checks the pairs of every frame, and of a world where some circles sit in both layers, against brute force
+	if( argc >= 3 && 0 == strcmp(argv[1], "--spatial-hash-bench") ) {
+		const int frames = std::max(1, atoi(argv[2]));
+		const unsigned int BULLET = 1;
+		const unsigned int ENEMY = 2;
+		const float worldSize = 4096.0f;
+		const float deltaTime = 1.0f / 60.0f;
+		unsigned int seed = 1;
+		std::vector<HashTestCircle> circles;
+		addHashTestCircles(circles, 10000, 4.0f, BULLET, worldSize, seed);
+		addHashTestCircles(circles, 2000, 16.0f, ENEMY, worldSize, seed);
+
+		ciri::SpatialHash2D hash;
+		hash.create(32.0f, 16384);
+		std::vector<int> handles;
+		for( int i = 0; i < static_cast<int>(circles.size()); ++i ) {
+			handles.push_back(hash.insert(circles[i].position, circles[i].radius, i, circles[i].layer));
+		}
+
+		std::vector<ciri::SpatialHashPair> found;
+		long long hashNanoseconds = 0;
+		long long bruteNanoseconds = 0;
+		long long pairCount = 0;
+		int mismatchedFrames = 0;
+		for( int frame = 0; frame < frames; ++frame ) {
+			long long start = ciri::Profiler::now();
+			for( int i = 0; i < static_cast<int>(circles.size()); ++i ) {
+				HashTestCircle& circle = circles[i];
+				circle.position.x = fmodf(circle.position.x + circle.velocity.x * deltaTime + worldSize, worldSize);
+				circle.position.y = fmodf(circle.position.y + circle.velocity.y * deltaTime + worldSize, worldSize);
+				hash.move(handles[i], circle.position);
+			}
+			hash.findPairs(BULLET, ENEMY, found);
+			hashNanoseconds += ciri::Profiler::now() - start;
+
+			start = ciri::Profiler::now();
+			const std::vector<std::pair<int, int>> expected = findPairsBruteForce(circles, BULLET, ENEMY);
+			bruteNanoseconds += ciri::Profiler::now() - start;
+			pairCount += static_cast<long long>(expected.size());
+			mismatchedFrames += (sortHashPairs(found, circles, BULLET, ENEMY) == expected) ? 0 : 1;
+		}
+
+		// a layer shared with both masks must not pair circles with themselves nor report a pair twice; removing and reinserting reuses handles
+		ciri::SpatialHash2D mixed;
+		mixed.create(32.0f, 1024);
+		std::vector<HashTestCircle> mixedCircles;
+		addHashTestCircles(mixedCircles, 1000, 12.0f, BULLET, 512.0f, seed);
+		addHashTestCircles(mixedCircles, 1000, 6.0f, BULLET | ENEMY, 512.0f, seed);
+		addHashTestCircles(mixedCircles, 1000, 20.0f, ENEMY, 512.0f, seed);
+		std::vector<int> mixedHandles;
+		for( int i = 0; i < static_cast<int>(mixedCircles.size()); ++i ) {
+			mixedHandles.push_back(mixed.insert(mixedCircles[i].position, mixedCircles[i].radius, i, mixedCircles[i].layer));
+		}
+		for( int i = 0; i < static_cast<int>(mixedCircles.size()); i += 3 ) {
+			mixed.remove(mixedHandles[i]);
+		}
+		for( int i = 0; i < static_cast<int>(mixedCircles.size()); i += 3 ) {
+			mixedHandles[i] = mixed.insert(mixedCircles[i].position, mixedCircles[i].radius, i, mixedCircles[i].layer);
+		}
+		int mismatchedMasks = 0;
+		const unsigned int masks[][2] = { { BULLET, ENEMY }, { BULLET, BULLET }, { BULLET | ENEMY, BULLET | ENEMY }, { ENEMY, BULLET | ENEMY } };
+		for( const auto& mask : masks ) {
+			mixed.findPairs(mask[0], mask[1], found);
+			mismatchedMasks += (sortHashPairs(found, mixedCircles, mask[0], mask[1]) == findPairsBruteForce(mixedCircles, mask[0], mask[1])) ? 0 : 1;
+		}
+
+		printf("bullets: 10000, enemies: 2000, frames: %d, pairs per frame: %.1f\n", frames, static_cast<double>(pairCount) / frames);
+		printf("ms per frame (hash move + pairs/brute force): %.3f/%.3f\n", static_cast<double>(hashNanoseconds) / (frames * 1000000.0),
+			static_cast<double>(bruteNanoseconds) / (frames * 1000000.0));
+		printf("frames differing from brute force: %d\n", mismatchedFrames);
+		printf("mixed layer masks differing from brute force: %d\n", mismatchedMasks);
+		return (0 == mismatchedFrames && 0 == mismatchedMasks) ? 0 : 1;
+	}
+
+	// --particle-bench <particles> [threads] times ParticleSystem::update over a full pool on the calling thread and on a job system of the given
+	// threads, every hardware thread by default (the target is 1M in under 4 ms)
+	if( argc >= 3 && 0 == strcmp(argv[1], "--particle-bench") ) {
+		const int particles = std::max(1, atoi(argv[2]));
+		std::shared_ptr<ciri::JobSystem> jobs = std::make_shared<ciri::JobSystem>();
+		jobs->create((argc >= 4) ? atoi(argv[3]) : 0);
+		bool passed = true;
+		printf("particles: %d\n", particles);
+		printf("%-10s %8s %10s %8s %10s\n", "path", "threads", "ms/update", "alive", "survivors");
+		for( int pass = 0; pass < 2; ++pass ) {
+			int alive = 0;
+			int survivors = 0;
+			const double milliseconds = timeParticleUpdate((0 == pass) ? nullptr : jobs, particles, alive, survivors);
+			printf("%-10s %8d %10.3f %8d %10d\n", (0 == pass) ? "serial" : "jobs", (0 == pass) ? 1 : jobs->getThreadCount(), milliseconds, alive, survivors);
+			passed = passed && (particles == alive) && (0 == survivors);
+		}
+		jobs->destroy();
+		printf("particle counts: %s\n", passed ? "ok" : "wrong");
+		return passed ? 0 : 1;
+	}
+
+	// --pipeline-bench <frames> [update ms] [draw ms] runs apps that only spin in update and draw on the null device, with the frame loop
+	// sequential and pipelined, and prints the frame time of each; without loads it tries an even, an update heavy and a draw heavy mix.
+	// Frames step 1/45s, which is not a whole number of fixed updates, so that the alpha handed to drawing moves between them.  It fails
+	// when a frame is drawn out of order, when either loop draws fewer frames than it ran, or when the alpha never leaves 0
+	if( argc >= 3 && 0 == strcmp(argv[1], "--pipeline-bench") ) {
+		const int frames = atoi(argv[2]);
+		std::vector<std::pair<double, double>> loads;
+		if( argc >= 5 ) {
+			loads.push_back(std::make_pair(atof(argv[3]), atof(argv[4])));
+		} else {
+			loads.push_back(std::make_pair(4.0, 4.0));
+			loads.push_back(std::make_pair(6.0, 2.0));
+			loads.push_back(std::make_pair(2.0, 6.0));
+		}
+		int outOfOrder = 0;
+		int undrawn = 0;
+		double maxAlpha = 0.0;
+		printf("%9s %9s %14s %14s %9s %9s\n", "update ms", "draw ms", "sequential ms", "pipelined ms", "speedup", "max alpha");
+		for( const auto& load : loads ) {
+			double milliseconds[2] = {0.0, 0.0};
+			double loadAlpha = 0.0;
+			for( int pipelined = 0; pipelined < 2; ++pipelined ) {
+				std::unique_ptr<SyntheticLoadApp> app(new SyntheticLoadApp(load.first, load.second, pipelined != 0));
+				app->getConfig().benchmarkDelta = 1.0 / 45.0;
+				const long long start = ciri::Profiler::now();
+				if( !app->runHeadless(frames) ) {
+					printf("ciri error: Failed to run headless\n");
+					return 1;
+				}
+				milliseconds[pipelined] = static_cast<double>(ciri::Profiler::now() - start) / (std::max(1, app->getDrawnFrames()) * 1000000.0);
+				outOfOrder += app->getOutOfOrderFrames();
+				undrawn += std::max(0, frames - app->getDrawnFrames());
+				loadAlpha = std::max(loadAlpha, app->getMaxAlpha());
+			}
+			maxAlpha = std::max(maxAlpha, loadAlpha);
+			printf("%9.2f %9.2f %14.3f %14.3f %8.2fx %9.3f\n", load.first, load.second, milliseconds[0], milliseconds[1], milliseconds[0] / milliseconds[1], loadAlpha);
+		}
+		printf("frames drawn out of order: %d\n", outOfOrder);
+		printf("frames run but not drawn: %d\n", undrawn);
+		return (0 == outOfOrder && 0 == undrawn && (frames <= 0 || maxAlpha > 0.0)) ? 0 : 1;
+	}
+
+	// --pacer-test <fps> <frames> [update ms] [draw ms] paces a headless app that spins for the given loads (1ms each by default) to a target
+	// rate and prints the rate it held, how late frames were let go, and how the waits split between sleeping and spinning
+	if( argc >= 4 && 0 == strcmp(argv[1], "--pacer-test") ) {
+		const double fps = atof(argv[2]);
+		const int frames = atoi(argv[3]);
+		const double updateMs = (argc >= 6) ? atof(argv[4]) : 1.0;
+		const double drawMs = (argc >= 6) ? atof(argv[5]) : 1.0;
+		std::unique_ptr<SyntheticLoadApp> app(new SyntheticLoadApp(updateMs, drawMs, false));
+		app->getConfig().targetFrameRate = fps;
+		const long long start = ciri::Profiler::now();
+		if( !app->runHeadless(frames) ) {
+			printf("ciri error: Failed to run headless\n");
+			return 1;
+		}
+		const double seconds = static_cast<double>(ciri::Profiler::now() - start) * 0.000000001;
+		const ciri::FramePacer::Stats& stats = app->framePacer().getStats();
+		const double waits = static_cast<double>(std::max(1, stats.frames));
+		printf("target fps: %.2f\n", fps);
+		printf("held fps: %.2f\n", static_cast<double>(std::max(0, frames - 1)) / seconds);
+		printf("mean late: %.3f ms\n", static_cast<double>(stats.lateNanosecs) / waits * 0.000001);
+		printf("max late: %.3f ms\n", static_cast<double>(stats.maxLateNanosecs) * 0.000001);
+		printf("missed: %d of %d\n", stats.missed, stats.frames);
+		printf("sleep per frame: %.3f ms\n", static_cast<double>(stats.sleepNanosecs) / waits * 0.000001);
+		printf("spin per frame: %.3f ms\n", static_cast<double>(stats.spinNanosecs) / waits * 0.000001);
+		printf("spin margin: %.3f ms\n", static_cast<double>(app->framePacer().getSpinMarginNanosecs()) * 0.000001);
+		return 0;
+	}
+
+	// --benchmark-clock <demo> <frames> runs a demo on the real device with every frame advancing 1/60s whatever the timer says, so that
+	// runs simulate the same frames and their times can be compared, and prints the frame time
+	if( argc >= 4 && 0 == strcmp(argv[1], "--benchmark-clock") ) {
+		int index = -1;
+		for( int i = 0; i < static_cast<int>(Demo::Count); ++i ) {
+			if( 0 == strcmp(argv[2], DEMO_NAMES[i]) ) {
+				index = i;
+			}
+		}
+		if( index < 0 ) {
+			printf("ciri error: No demo named %s\n", argv[2]);
+			return 1;
+		}
+		const int frames = atoi(argv[3]);
+		std::unique_ptr<ciri::App> demo = createGame(static_cast<Demo>(index));
+		demo->getConfig().benchmarkDelta = 1.0 / 60.0;
+		demo->getConfig().frameLimit = frames;
+		const long long start = ciri::Profiler::now();
+		if( !demo->run() ) {
+			printf("ciri error: Game failed to run!\n");
+			return 1;
+		}
+		const double seconds = static_cast<double>(ciri::Profiler::now() - start) * 0.000000001 - demo->getStartupSeconds();
+		printf("%s: %d frames, %.3f ms per frame after startup\n", DEMO_NAMES[index], frames, seconds * 1000.0 / std::max(1, frames - 1));
+		return 0;
+	}
+
+	// --log-bench <threads> <messages> logs the given messages from each of 1, 2, 4... up to the given threads into a file, first dropping and
+	// then blocking when rings fill, and prints what a call costs the logging thread and how many messages a second reach the file
+	if( argc >= 4 && 0 == strcmp(argv[1], "--log-bench") ) {
+		const int maxThreads = std::max(1, atoi(argv[2]));
+		const int messages = atoi(argv[3]);
+		ciri::Log log;
+		log.setLogToStd(false);
+		if( !log.setFile("log_bench.txt") ) {
+			printf("ciri error: Failed to open log_bench.txt\n");
+			return 1;
+		}
+		printf("%8s %8s %12s %14s %10s\n", "overflow", "threads", "ns per call", "messages/s", "dropped");
+		for( int overflow = 0; overflow < 2; ++overflow ) {
+			ciri::Logs::setOverflow((0 == overflow) ? ciri::Logs::Drop : ciri::Logs::Block);
+			for( int threads = 1; threads <= maxThreads; threads *= 2 ) {
+				const long long droppedBefore = ciri::Logs::getDroppedCount();
+				const long long start = ciri::Profiler::now();
+				std::vector<std::future<long long>> workers;
+				for( int t = 0; t < threads; ++t ) {
+					workers.push_back(std::async(std::launch::async, [&log, messages, t]{
+						const long long begin = ciri::Profiler::now();
+						for( int i = 0; i < messages; ++i ) {
+							log.printFormatted(ciri::Log::Info, "thread {} message {} of {}: {} ms", t, i, messages, i * 0.25);
+						}
+						return ciri::Profiler::now() - begin;
+					}));
+				}
+				long long callNanoseconds = 0;
+				for( auto& worker : workers ) {
+					callNanoseconds += worker.get();
+				}
+				ciri::Logs::flush();
+				const double seconds = static_cast<double>(ciri::Profiler::now() - start) * 0.000000001;
+				const long long total = static_cast<long long>(threads) * messages;
+				const long long dropped = ciri::Logs::getDroppedCount() - droppedBefore;
+				printf("%8s %8d %12.1f %14.0f %10lld\n", (0 == overflow) ? "drop" : "block", threads, static_cast<double>(callNanoseconds) / std::max(1LL, total),
+					static_cast<double>(total - dropped) / seconds, dropped);
+			}
+		}
+		log.closeFile();
+		return 0;
+	}
+
+	// --pack <directory> <pack file> [level] packs every file under a directory, named as loaders ask for them from the working directory;
+	// level is zlib's, and 0 stores every file so that all of them are read straight out of the mapping.  Corrupted copies of the pack are then
+	// opened to check that each is refused
+	if( argc >= 4 && 0 == strcmp(argv[1], "--pack") ) {
+		const int level = (argc >= 5) ? atoi(argv[4]) : 6;
+		ciri::PackArchive::BuildStats stats;
+		if( !ciri::PackArchive::build(argv[2], argv[3], level, &stats) ) {
+			printf("ciri error: Failed to pack %s into %s\n", argv[2], argv[3]);
+			return 1;
+		}
+		printf("%s: %d files, %d compressed, %llu bytes packed into %llu\n", argv[3], stats.files, stats.compressed, stats.bytes, stats.packedBytes);
+
+		// corrupt copies of the pack must all be refused by open; offsets follow PackArchive's header (tocOffset at 16) and entries
+		// (offset, storedSize, size, then flags at 32, where 1 is compressed)
+		std::vector<unsigned char> bytes;
+		if( FILE* in = fopen(argv[3], "rb") ) {
+			unsigned char chunk[65536];
+			for( size_t got = fread(chunk, 1, sizeof(chunk), in); got > 0; got = fread(chunk, 1, sizeof(chunk), in) ) {
+				bytes.insert(bytes.end(), chunk, chunk + got);
+			}
+			fclose(in);
+		}
+		unsigned long long tocOffset = 0;
+		if( bytes.size() >= 24 ) {
+			memcpy(&tocOffset, bytes.data() + 16, sizeof(tocOffset));
+		}
+		if( 0 == stats.files || tocOffset + 40 > bytes.size() ) {
+			printf("ciri error: Nothing to corrupt in %s\n", argv[3]);
+			return 1;
+		}
+		const std::string corruptFile = std::string(argv[3]) + ".corrupt";
+		const auto opensCorrupted = [&bytes, &corruptFile]( size_t offset, unsigned long long value, size_t truncate ) {
+			std::vector<unsigned char> corrupt(bytes.begin(), bytes.begin() + std::min(truncate, bytes.size()));
+			if( offset + sizeof(value) <= corrupt.size() ) {
+				memcpy(corrupt.data() + offset, &value, sizeof(value));
+			}
+			FILE* out = fopen(corruptFile.c_str(), "wb");
+			if( nullptr == out ) {
+				return true;
+			}
+			fwrite(corrupt.data(), 1, corrupt.size(), out);
+			fclose(out);
+			ciri::PackArchive archive;
+			return archive.open(corruptFile.c_str());
+		};
+		unsigned long long entryOffset = 0;
+		unsigned long long entryStoredSize = 0;
+		unsigned int entryFlags = 0;
+		memcpy(&entryOffset, bytes.data() + tocOffset, sizeof(entryOffset));
+		memcpy(&entryStoredSize, bytes.data() + tocOffset + 8, sizeof(entryStoredSize));
+		memcpy(&entryFlags, bytes.data() + tocOffset + 32, sizeof(entryFlags));
+		unsigned int entryCount = 0;
+		unsigned int namesSize = 0;
+		memcpy(&entryCount, bytes.data() + 8, sizeof(entryCount));
+		memcpy(&namesSize, bytes.data() + 12, sizeof(namesSize));
+		// offsets that make an unchecked offset plus size wrap around to just past zero
+		const unsigned long long tocTail = static_cast<unsigned long long>(entryCount) * 40 + namesSize;
+		const unsigned long long wrappingTocOffset = (0ULL - tocTail + 8) & ~7ULL;
+		const unsigned long long wrappingEntryOffset = 0ULL - entryStoredSize + 1;
+		const struct {
+			const char* name;
+			size_t offset;
+			unsigned long long value;
+			size_t truncate;
+			bool applies;
+		} cases[] = {
+			{"truncated table of contents", bytes.size(), 0, static_cast<size_t>(tocOffset) + 1, true},
+			{"table of contents wrapping", 16, wrappingTocOffset, bytes.size(), true},
+			{"entry wrapping", static_cast<size_t>(tocOffset), wrappingEntryOffset, bytes.size(), true},
+			{"entry past the table of contents", static_cast<size_t>(tocOffset) + 8, tocOffset - entryOffset + 1, bytes.size(), true},
+			// a compressed entry's size is checked when it is inflated; a stored one is handed out as a span, so it must be refused up front
+			{"stored entry larger than its bytes", static_cast<size_t>(tocOffset) + 16, entryStoredSize + 1, bytes.size(), 0 == (entryFlags & 1u)},
+			{"compressed entry marked stored", static_cast<size_t>(tocOffset) + 32, entryFlags & ~1u, bytes.size(), 0 != (entryFlags & 1u)}
+		};
+		int failures = 0;
+		for( const auto& test : cases ) {
+			if( !test.applies ) {
+				continue;
+			}
+			const bool opened = opensCorrupted(test.offset, test.value, test.truncate);
+			failures += opened ? 1 : 0;
+			printf("%-36s %s\n", test.name, opened ? "opened" : "refused");
+		}
+		std::remove(corruptFile.c_str());
+		return (0 == failures) ? 0 : 1;
+	}
+
+	// --vfs-bench <directory> packs a directory twice, compressed and stored, then reads every file in it and starts every demo headless,
+	// with content loose and out of each archive, and prints the times.  Reads are the best of five, so they show a warm OS file cache
+	if( argc >= 3 && 0 == strcmp(argv[1], "--vfs-bench") ) {
+		const char* packs[] = {"vfs_bench.pak", "vfs_bench_stored.pak"};
+		const int levels[] = {6, 0};
+		for( int i = 0; i < 2; ++i ) {
+			ciri::PackArchive::BuildStats stats;
+			if( !ciri::PackArchive::build(argv[2], packs[i], levels[i], &stats) ) {
+				printf("ciri error: Failed to pack %s into %s\n", argv[2], packs[i]);
+				return 1;
+			}
+			printf("%s: %d files, %d compressed, %llu bytes packed into %llu\n", packs[i], stats.files, stats.compressed, stats.bytes, stats.packedBytes);
+		}
+
+		std::vector<std::string> names;
+		{
+			ciri::PackArchive archive;
+			if( !archive.open(packs[1]) ) {
+				printf("ciri error: Failed to open %s\n", packs[1]);
+				return 1;
+			}
+			for( int i = 0; i < archive.getEntryCount(); ++i ) {
+				names.push_back(archive.getEntryName(i));
+			}
+		}
+
+		const char* sources[] = {nullptr, packs[0], packs[1]};
+		const char* labels[] = {"loose", "compressed pack", "stored pack"};
+		printf("%-16s %8s %10s %10s %10s %12s\n", "source", "files", "no copy", "read ms", "MB/s", "startup ms");
+		for( int source = 0; source < 3; ++source ) {
+			if( sources[source] != nullptr && !ciri::FileSystem::mount(sources[source]) ) {
+				printf("ciri error: Failed to mount %s\n", sources[source]);
+				return 1;
+			}
+			double readSeconds = 0.0;
+			ciri::FileSystem::Stats stats;
+			for( int run = 0; run < 5; ++run ) {
+				ciri::FileSystem::resetStats();
+				const long long start = ciri::Profiler::now();
+				for( const auto& name : names ) {
+					ciri::FileSystem::read(name.c_str());
+				}
+				const double seconds = static_cast<double>(ciri::Profiler::now() - start) * 0.000000001;
+				readSeconds = (0 == run) ? seconds : std::min(readSeconds, seconds);
+				stats = ciri::FileSystem::getStats();
+			}
+			if( sources[source] != nullptr ) {
+				ciri::FileSystem::unmount(sources[source]);
+			}
+
+			double startupSeconds = 0.0;
+			for( int i = 0; i < static_cast<int>(Demo::Count); ++i ) {
+				std::unique_ptr<ciri::App> demo = createGame(static_cast<Demo>(i));
+				demo->getConfig().packFile = (sources[source] != nullptr) ? sources[source] : "";
+				if( demo->runHeadless(1) ) {
+					startupSeconds += demo->getStartupSeconds();
+				}
+			}
+			printf("%-16s %8lld %10lld %10.3f %10.1f %12.1f\n", labels[source], stats.looseFiles + stats.packedFiles, stats.mappedFiles, readSeconds * 1000.0,
+				static_cast<double>(stats.bytes) / (1024.0 * 1024.0) / std::max(readSeconds, 0.000000001), startupSeconds * 1000.0);
+		}
+		return 0;
+	}
+
 	// create the game
 	std::unique_ptr<ciri::App> game = createGame(Demo::Playground);
-	if( !game->run() ) {
+
+	// --headless <frames> [capture file] runs on the null device and prints what was issued
+	if( argc >= 3 && 0 == strcmp(argv[1], "--headless") ) {
+		ciri::GraphicsCommandStream stream;
+		if( !game->runHeadless(atoi(argv[2]), &stream) ) {
+			printf("ciri error: Game failed to run headless!\n");
+		} else {
+			printCounters(stream.getCounters());
+			if( argc >= 4 && !stream.save(argv[3]) ) {
+				printf("ciri error: Failed to save command stream to %s\n", argv[3]);
+			}
+		}
+	} else if( !game->run() ) {
 		printf("ciri error: Game failed to run!\n");
 	}
 